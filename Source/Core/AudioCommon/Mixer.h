@@ -34,6 +34,10 @@ public:
   void PushSkylanderPortalSamples(const u8* samples, unsigned int num_samples);
   void PushGBASamples(int device_number, const short* samples, unsigned int num_samples);
 
+  // While set, pushed samples are dropped, e.g. while NetPlay re-simulates frames that were
+  // already heard
+  void SetSamplesDiscarded(bool discarded) { m_discard_samples = discarded; }
+
   unsigned int GetSampleRate() const { return m_sampleRate; }
 
   void SetDMAInputSampleRateDivisor(unsigned int rate_divisor);
@@ -117,6 +121,8 @@ private:
   bool m_log_dtk_audio = false;
   bool m_log_dsp_audio = false;
 
+  std::atomic<bool> m_discard_samples{false};
+
   float m_config_emulation_speed;
   int m_config_timing_variance;
   bool m_config_audio_stretch;
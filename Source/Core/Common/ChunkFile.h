@@ -50,6 +50,7 @@ private:
   u8** m_ptr_current;
   u8* m_ptr_end;
   Mode m_mode;
+  bool m_memory_excluded = false;
 
 public:
   PointerWrap(u8** ptr, size_t size, Mode mode)
@@ -64,6 +65,10 @@ public:
   bool IsMeasureMode() const { return m_mode == Mode::Measure; }
   bool IsVerifyMode() const { return m_mode == Mode::Verify; }
 
+  // For states that keep emulated RAM and ARAM separately, see State::IncrementalStates
+  void SetMemoryExcluded() { m_memory_excluded = true; }
+  bool IsMemoryExcluded() const { return m_memory_excluded; }
+
   template <typename K, class V>
   void Do(std::map<K, V>& x)
   {
@@ -20,7 +20,8 @@ using ENetHostPtr = std::unique_ptr<ENetHost, ENetHostDeleter>;
 
 void WakeupThread(ENetHost* host);
 int ENET_CALLBACK InterceptCallback(ENetHost* host, ENetEvent* event);
-bool SendPacket(ENetPeer* socket, const sf::Packet& packet, u8 channel_id);
+bool SendPacket(ENetPeer* socket, const sf::Packet& packet, u8 channel_id,
+                u32 flags = ENET_PACKET_FLAG_RELIABLE);
 
 // used for traversal packets and wake-up packets
 constexpr int SKIPPABLE_EVENT = 42;
@@ -0,0 +1,172 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Common/JsonWriter.h"
+
+namespace Common
+{
+JsonWriter::JsonWriter(size_t reserve)
+{
+  m_buffer.reserve(reserve);
+}
+
+void JsonWriter::Clear(int element_depth)
+{
+  m_buffer.clear();
+  m_depth = element_depth;
+  m_has_elements = false;
+}
+
+void JsonWriter::BeginObject()
+{
+  BeginElement();
+  Open('{');
+}
+
+void JsonWriter::BeginObject(std::string_view key)
+{
+  WriteKey(key);
+  Open('{');
+}
+
+void JsonWriter::EndObject()
+{
+  Close('}');
+}
+
+void JsonWriter::BeginArray()
+{
+  BeginElement();
+  Open('[');
+}
+
+void JsonWriter::BeginArray(std::string_view key)
+{
+  WriteKey(key);
+  Open('[');
+}
+
+void JsonWriter::EndArray()
+{
+  Close(']');
+}
+
+void JsonWriter::Null(std::string_view key)
+{
+  WriteKey(key);
+  m_buffer.append("null");
+}
+
+void JsonWriter::Bool(std::string_view key, bool value)
+{
+  WriteKey(key);
+  m_buffer.append(value ? "true" : "false");
+}
+
+void JsonWriter::String(std::string_view key, std::string_view value)
+{
+  WriteKey(key);
+  m_buffer.push_back('"');
+  WriteEscaped(value);
+  m_buffer.push_back('"');
+}
+
+void JsonWriter::RawValue(std::string_view key, std::string_view json)
+{
+  WriteKey(key);
+  m_buffer.append(json);
+}
+
+void JsonWriter::Number(std::string_view key, float value)
+{
+  WriteKey(key);
+  fmt::format_to(std::back_inserter(m_buffer), "{:g}", value);
+}
+
+void JsonWriter::AppendElements(const JsonWriter& elements)
+{
+  if (elements.IsEmpty())
+    return;
+
+  // Every element in the list starts with its own line break, only the separator is missing
+  if (m_has_elements)
+    m_buffer.push_back(',');
+  m_buffer.append(elements.m_buffer);
+  m_has_elements = true;
+}
+
+void JsonWriter::WriteKey(std::string_view key)
+{
+  BeginElement();
+  m_buffer.push_back('"');
+  WriteEscaped(key);
+  m_buffer.append("\": ");
+}
+
+void JsonWriter::BeginElement()
+{
+  if (m_depth == 0)
+    return;
+
+  if (m_has_elements)
+    m_buffer.push_back(',');
+  m_buffer.push_back('\n');
+  Indent();
+  m_has_elements = true;
+}
+
+void JsonWriter::WriteEscaped(std::string_view value)
+{
+  for (const char c : value)
+  {
+    switch (c)
+    {
+    case '"':
+      m_buffer.append("\\\"");
+      break;
+    case '\\':
+      m_buffer.append("\\\\");
+      break;
+    case '\n':
+      m_buffer.append("\\n");
+      break;
+    case '\r':
+      m_buffer.append("\\r");
+      break;
+    case '\t':
+      m_buffer.append("\\t");
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20)
+        fmt::format_to(std::back_inserter(m_buffer), "\\u{:04x}", static_cast<unsigned char>(c));
+      else
+        m_buffer.push_back(c);
+      break;
+    }
+  }
+}
+
+void JsonWriter::Indent()
+{
+  m_buffer.append(static_cast<size_t>(m_depth) * 2, ' ');
+}
+
+void JsonWriter::Open(char bracket)
+{
+  m_buffer.push_back(bracket);
+  ++m_depth;
+  m_has_elements = false;
+}
+
+void JsonWriter::Close(char bracket)
+{
+  --m_depth;
+  if (m_has_elements)
+  {
+    m_buffer.push_back('\n');
+    Indent();
+  }
+  m_buffer.push_back(bracket);
+  m_has_elements = m_depth > 0;
+}
+}  // namespace Common
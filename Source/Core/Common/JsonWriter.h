@@ -0,0 +1,102 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+// Streams pretty-printed JSON into a single reusable buffer.
+//
+// Unlike building a picojson::value or going through std::stringstream, nothing is allocated per
+// key or per value: keys are string_views, numbers are formatted in place and the buffer keeps its
+// capacity across Clear() calls, so serializing the same shape of document again is allocation
+// free once the buffer has grown to size.
+class JsonWriter
+{
+public:
+  explicit JsonWriter(size_t reserve = 0);
+
+  // Starts over, keeping the capacity of the buffer. A non-zero element_depth makes the output a
+  // run of array elements at that nesting depth, for documents that are assembled from
+  // pre-serialized pieces with AppendElements().
+  void Clear(int element_depth = 0);
+  void Reserve(size_t size) { m_buffer.reserve(size); }
+
+  void BeginObject();
+  void BeginObject(std::string_view key);
+  void EndObject();
+  void BeginArray();
+  void BeginArray(std::string_view key);
+  void EndArray();
+
+  void Null(std::string_view key);
+  void Bool(std::string_view key, bool value);
+  void String(std::string_view key, std::string_view value);
+  // Writes pre-serialized JSON as the value of key.
+  void RawValue(std::string_view key, std::string_view json);
+
+  template <typename T>
+  requires std::integral<T>
+  void Number(std::string_view key, T value)
+  {
+    WriteKey(key);
+    FormatInteger(value);
+  }
+
+  // Floats use the same "%g" formatting std::ostream applies by default.
+  void Number(std::string_view key, float value);
+
+  // Some consumers expect numbers wrapped in quotes. Keep those working.
+  template <typename T>
+  requires std::integral<T>
+  void QuotedNumber(std::string_view key, T value)
+  {
+    WriteKey(key);
+    m_buffer.push_back('"');
+    FormatInteger(value);
+    m_buffer.push_back('"');
+  }
+
+  // Appends the elements written by a writer cleared to the matching element depth to the array that is
+  // currently open.
+  void AppendElements(const JsonWriter& elements);
+
+  std::string_view GetView() const { return m_buffer; }
+  const std::string& GetString() const { return m_buffer; }
+  size_t GetSize() const { return m_buffer.size(); }
+  bool IsEmpty() const { return m_buffer.empty(); }
+
+private:
+  template <typename T>
+  void FormatInteger(T value)
+  {
+    if constexpr (std::is_signed_v<T>)
+      fmt::format_to(std::back_inserter(m_buffer), "{}", static_cast<s64>(value));
+    else
+      fmt::format_to(std::back_inserter(m_buffer), "{}", static_cast<u64>(value));
+  }
+
+  void WriteKey(std::string_view key);
+  void BeginElement();
+  void WriteEscaped(std::string_view value);
+  void Indent();
+  void Open(char bracket);
+  void Close(char bracket);
+
+  std::string m_buffer;
+  int m_depth = 0;
+  // Whether the innermost open container already holds an element. The enclosing containers
+  // always do, since the innermost one is one of their elements.
+  bool m_has_elements = false;
+};
+}  // namespace Common
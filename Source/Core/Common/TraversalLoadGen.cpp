@@ -0,0 +1,367 @@
+// SPDX-License-Identifier: CC0-1.0
+
+// Synthetic load for the traversal server: hosts that register and keep themselves alive, and
+// clients that ask to connect to random hosts at a fixed rate. Reports the packets per second the
+// server handled and the latency of the connect handshake, from ConnectPlease to ConnectReady.
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "Common/TraversalProto.h"
+
+#define PORT 6262
+
+// Times are in microseconds
+constexpr u64 PING_INTERVAL = 5 * 1000000;
+constexpr u64 HELLO_INTERVAL = 500000;
+constexpr size_t CLIENT_SOCKETS_PER_THREAD = 8;
+
+static u64 GetCurrentTime()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+struct Options
+{
+  std::string server = "127.0.0.1";
+  size_t hosts = 512;
+  double rate = 20000;
+  double seconds = 10;
+  size_t threads = 4;
+};
+
+struct Results
+{
+  u64 sent = 0;
+  u64 received = 0;
+  u64 connects = 0;
+  u64 ready = 0;
+  u64 failed = 0;
+  std::vector<u64> latencies;
+};
+
+static sockaddr_in6 s_server;
+static std::atomic<size_t> s_registered_hosts{0};
+static std::atomic<bool> s_load_started{false};
+static std::atomic<bool> s_load_stopped{false};
+static std::atomic<bool> s_done{false};
+static std::mutex s_host_ids_lock;
+static std::vector<Common::TraversalHostId> s_host_ids;
+
+class Worker
+{
+public:
+  Worker(size_t index, size_t hosts, double rate) : m_index(index), m_rate(rate), m_rng(index)
+  {
+    m_epoll = epoll_create1(0);
+    for (size_t i = 0; i < hosts + CLIENT_SOCKETS_PER_THREAD; ++i)
+    {
+      const int sock = socket(PF_INET6, SOCK_DGRAM, 0);
+      int no = 0;
+      setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &no, sizeof(no));
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.u64 = i;
+      epoll_ctl(m_epoll, EPOLL_CTL_ADD, sock, &event);
+      if (i < hosts)
+        m_hosts.push_back({sock, {}, false, 0});
+      else
+        m_clients.push_back(sock);
+    }
+  }
+
+  void Run();
+
+  Results results;
+
+private:
+  struct Host
+  {
+    int sock;
+    Common::TraversalHostId id;
+    bool registered;
+    u64 lastPing;
+  };
+
+  void Send(int sock, const Common::TraversalPacket& packet)
+  {
+    const ssize_t rv =
+        sendto(sock, &packet, sizeof(packet), 0, (const sockaddr*)&s_server, sizeof(s_server));
+    if (rv == sizeof(packet) && s_load_started)
+      ++results.sent;
+  }
+
+  void Ack(int sock, Common::TraversalRequestId requestId)
+  {
+    Common::TraversalPacket ack{};
+    ack.type = Common::TraversalPacketType::Ack;
+    ack.requestId = requestId;
+    ack.ack.ok = true;
+    Send(sock, ack);
+  }
+
+  Common::TraversalRequestId NextRequestId() { return (u64(m_index) << 48) | ++m_requests; }
+
+  void Receive(size_t socketIndex, u64 now);
+  void SendConnects(u64 now);
+
+  size_t m_index;
+  double m_rate;
+  int m_epoll;
+  std::mt19937_64 m_rng;
+  std::vector<Host> m_hosts;
+  std::vector<int> m_clients;
+  std::unordered_map<Common::TraversalRequestId, u64> m_pending;
+  u64 m_requests = 0;
+  u64 m_start = 0;
+};
+
+void Worker::Receive(size_t socketIndex, u64 now)
+{
+  const bool isHost = socketIndex < m_hosts.size();
+  const int sock = isHost ? m_hosts[socketIndex].sock :
+                             m_clients[socketIndex - m_hosts.size()];
+  Common::TraversalPacket packet;
+  while (recv(sock, &packet, sizeof(packet), MSG_DONTWAIT) == sizeof(packet))
+  {
+    if (s_load_started)
+      ++results.received;
+    switch (packet.type)
+    {
+    case Common::TraversalPacketType::HelloFromServer:
+    {
+      Ack(sock, packet.requestId);
+      Host& host = m_hosts[socketIndex];
+      if (!host.registered && packet.helloFromServer.ok)
+      {
+        host.registered = true;
+        host.id = packet.helloFromServer.yourHostId;
+        host.lastPing = now;
+        {
+          std::lock_guard lk(s_host_ids_lock);
+          s_host_ids.push_back(host.id);
+        }
+        ++s_registered_hosts;
+      }
+      break;
+    }
+    case Common::TraversalPacketType::PleaseSendPacket:
+      Ack(sock, packet.requestId);
+      break;
+    case Common::TraversalPacketType::ConnectReady:
+    case Common::TraversalPacketType::ConnectFailed:
+    {
+      Ack(sock, packet.requestId);
+      const bool ready = packet.type == Common::TraversalPacketType::ConnectReady;
+      const auto it =
+          m_pending.find(ready ? packet.connectReady.requestId : packet.connectFailed.requestId);
+      if (it == m_pending.end())
+        break;
+      if (ready)
+      {
+        ++results.ready;
+        results.latencies.push_back(now - it->second);
+      }
+      else
+      {
+        ++results.failed;
+      }
+      m_pending.erase(it);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+}
+
+void Worker::SendConnects(u64 now)
+{
+  const u64 target = static_cast<u64>((now - m_start) * m_rate / 1000000);
+  while (results.connects < target)
+  {
+    Common::TraversalPacket please{};
+    please.type = Common::TraversalPacketType::ConnectPlease;
+    please.requestId = NextRequestId();
+    please.connectPlease.hostId = s_host_ids[m_rng() % s_host_ids.size()];
+    m_pending.emplace(please.requestId, now);
+    Send(m_clients[results.connects % m_clients.size()], please);
+    ++results.connects;
+  }
+}
+
+void Worker::Run()
+{
+  std::vector<epoll_event> events(256);
+  while (!s_done)
+  {
+    const int count = epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), 1);
+    const u64 now = GetCurrentTime();
+    for (int i = 0; i < count; ++i)
+      Receive(events[i].data.u64, now);
+
+    for (Host& host : m_hosts)
+    {
+      // Hellos may be dropped when all hosts say hello at once
+      if (!host.registered && now - host.lastPing >= HELLO_INTERVAL)
+      {
+        Common::TraversalPacket hello{};
+        hello.type = Common::TraversalPacketType::HelloFromClient;
+        hello.requestId = NextRequestId();
+        hello.helloFromClient.protoVersion = Common::TraversalProtoVersion;
+        Send(host.sock, hello);
+        host.lastPing = now;
+      }
+      else if (host.registered && now - host.lastPing >= PING_INTERVAL)
+      {
+        Common::TraversalPacket ping{};
+        ping.type = Common::TraversalPacketType::Ping;
+        ping.requestId = NextRequestId();
+        ping.ping.hostId = host.id;
+        Send(host.sock, ping);
+        host.lastPing = now;
+      }
+    }
+
+    if (s_load_started && !s_load_stopped)
+    {
+      if (m_start == 0)
+        m_start = now;
+      SendConnects(now);
+    }
+  }
+}
+
+static bool ParseOptions(int argc, char** argv, Options* options)
+{
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    const std::string arg = argv[i];
+    const char* value = argv[i + 1];
+    if (arg == "--server")
+      options->server = value;
+    else if (arg == "--hosts")
+      options->hosts = std::max(std::atoi(value), 1);
+    else if (arg == "--rate")
+      options->rate = std::atof(value);
+    else if (arg == "--seconds")
+      options->seconds = std::atof(value);
+    else if (arg == "--threads")
+      options->threads = std::max(std::atoi(value), 1);
+    else
+      return false;
+  }
+  return argc % 2 == 1;
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if (!ParseOptions(argc, argv, &options))
+  {
+    fmt::print(stderr,
+               "usage: {} [--server address] [--hosts count] [--rate connects per second] "
+               "[--seconds duration] [--threads count]\n",
+               argv[0]);
+    return 1;
+  }
+
+  addrinfo hints{};
+  hints.ai_family = AF_INET6;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = AI_V4MAPPED;
+  addrinfo* info;
+  if (getaddrinfo(options.server.c_str(), nullptr, &hints, &info) != 0)
+  {
+    fmt::print(stderr, "could not resolve {}\n", options.server);
+    return 1;
+  }
+  memcpy(&s_server, info->ai_addr, sizeof(s_server));
+  s_server.sin6_port = htons(PORT);
+  freeaddrinfo(info);
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < options.threads; ++i)
+  {
+    const size_t hosts = options.hosts / options.threads + (i < options.hosts % options.threads);
+    workers.push_back(std::make_unique<Worker>(i, hosts, options.rate / options.threads));
+  }
+  for (auto& worker : workers)
+    threads.emplace_back(&Worker::Run, worker.get());
+
+  const auto waitStart = std::chrono::steady_clock::now();
+  while (s_registered_hosts < options.hosts)
+  {
+    if (std::chrono::steady_clock::now() - waitStart > std::chrono::seconds(5))
+    {
+      fmt::print(stderr, "only {} of {} hosts registered\n", s_registered_hosts.load(),
+                 options.hosts);
+      s_done = true;
+      for (std::thread& thread : threads)
+        thread.join();
+      return 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  s_load_started = true;
+  std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+  s_load_stopped = true;
+  // Time for the last handshakes to finish
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  s_done = true;
+  for (std::thread& thread : threads)
+    thread.join();
+
+  Results total;
+  for (auto& worker : workers)
+  {
+    total.sent += worker->results.sent;
+    total.received += worker->results.received;
+    total.connects += worker->results.connects;
+    total.ready += worker->results.ready;
+    total.failed += worker->results.failed;
+    total.latencies.insert(total.latencies.end(), worker->results.latencies.begin(),
+                           worker->results.latencies.end());
+  }
+  std::sort(total.latencies.begin(), total.latencies.end());
+  const auto percentile = [&total](double p) -> double {
+    if (total.latencies.empty())
+      return 0;
+    return total.latencies[static_cast<size_t>(p * (total.latencies.size() - 1))] / 1000.0;
+  };
+
+  // Registering the hosts is left out, the pings and the last handshakes are not
+  const double seconds = options.seconds;
+  fmt::print("{} connects in {:.1f}s: {} ready, {} failed, {} lost\n", total.connects, seconds,
+             total.ready, total.failed, total.connects - total.ready - total.failed);
+  fmt::print("server handled {:.0f} packets/s ({:.0f} in, {:.0f} out)\n",
+             (total.sent + total.received) / seconds, total.sent / seconds,
+             total.received / seconds);
+  fmt::print("handshake latency: p50 {:.2f}ms p99 {:.2f}ms max {:.2f}ms\n", percentile(0.5),
+             percentile(0.99), percentile(1.0));
+  return 0;
+}
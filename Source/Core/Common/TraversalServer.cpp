@@ -1,18 +1,32 @@
 // SPDX-License-Identifier: CC0-1.0
 
 // The central server implementation.
+//
+// Every thread has its own pair of sockets bound with SO_REUSEPORT, so the kernel spreads the
+// clients over the threads by their address, and reads and writes packets in batches. A connection
+// involves two clients that are likely served by different threads, so the hosts and the packets
+// waiting for an ack are in tables shared by all threads, split into stripes that are locked on
+// their own. Resends and expired hosts are found by a timer wheel per thread rather than by
+// scanning the tables.
+#include <algorithm>
 #include <arpa/inet.h>
+#include <array>
+#include <atomic>
 #include <cerrno>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
+#include <memory>
+#include <mutex>
 #include <netinet/in.h>
-#include <sys/select.h>
+#include <optional>
+#include <poll.h>
+#include <string>
 #include <sys/socket.h>
 #include <sys/types.h>
-#include <tuple>
+#include <thread>
 #include <unistd.h>
 #include <unordered_map>
 #include <utility>
@@ -32,7 +46,25 @@
 #define PORT 6262
 #define PORT_ALT 6226
 
-static u64 currentTime;
+// Times are in microseconds
+constexpr u64 RESEND_INTERVAL = 300000;  // 300ms, times the number of tries so far
+constexpr u64 HOST_EXPIRY_TIME = 30 * 1000000;  // 30s
+constexpr size_t BATCH_SIZE = 64;
+constexpr size_t STRIPES = 64;
+
+// Only Linux spreads the packets of a port over the sockets bound to it with SO_REUSEPORT
+#ifdef __linux__
+#define BATCHED_IO 1
+#else
+#define BATCHED_IO 0
+#endif
+
+static u64 GetCurrentTime()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
 
 struct OutgoingPacketInfo
 {
@@ -41,93 +73,133 @@ struct OutgoingPacketInfo
   bool fromAlt;
   sockaddr_in6 dest;
   int tries;
-  u64 sendTime;
 };
 
-template <typename T>
-struct EvictEntry
+struct HostInfo
 {
+  Common::TraversalInetAddress address;
   u64 updateTime;
-  T value;
 };
 
-template <typename V>
-struct EvictFindResult
+namespace std
+{
+template <>
+struct hash<Common::TraversalHostId>
 {
-  bool found;
-  V* value;
+  size_t operator()(const Common::TraversalHostId& id) const noexcept
+  {
+    auto p = (u32*)id.data();
+    return p[0] ^ ((p[1] << 13) | (p[1] >> 19));
+  }
 };
+}  // namespace std
 
 template <typename K, typename V>
-EvictFindResult<V> EvictFind(std::unordered_map<K, EvictEntry<V>>& map, const K& key,
-                             bool refresh = false)
+class StripedMap
 {
-retry:
-  const u64 expiryTime = 30 * 1000000;  // 30s
-  EvictFindResult<V> result;
-  if (map.bucket_count())
-  {
-    auto bucket = map.bucket(key);
-    auto it = map.begin(bucket);
-    for (; it != map.end(bucket); ++it)
+public:
+  // Calls f with the part of the map that holds the key, locked
+  template <typename F>
+  auto With(const K& key, F&& f)
+  {
+    Stripe& stripe = m_stripes[std::hash<K>{}(key) % STRIPES];
+    std::lock_guard lk(stripe.mutex);
+    return f(stripe.map);
+  }
+
+  size_t Size()
+  {
+    size_t size = 0;
+    for (Stripe& stripe : m_stripes)
     {
-      if (currentTime - it->second.updateTime > expiryTime)
-      {
-        map.erase(it->first);
-        goto retry;
-      }
-      if (it->first == key)
-      {
-        if (refresh)
-          it->second.updateTime = currentTime;
-        result.found = true;
-        result.value = &it->second.value;
-        return result;
-      }
+      std::lock_guard lk(stripe.mutex);
+      size += stripe.map.size();
     }
+    return size;
   }
-#if DEBUG
-  fmt::print("failed to find key '");
-  for (size_t i = 0; i < sizeof(key); i++)
+
+private:
+  struct alignas(64) Stripe
   {
-    fmt::print("{:02x}", ((u8*)&key)[i]);
-  }
-  fmt::print("'\n");
-#endif
-  result.found = false;
-  return result;
-}
+    std::mutex mutex;
+    std::unordered_map<K, V> map;
+  };
 
-template <typename K, typename V>
-V* EvictSet(std::unordered_map<K, EvictEntry<V>>& map, const K& key)
-{
-  // can't use a local_iterator to emplace...
-  auto& result = map[key];
-  result.updateTime = currentTime;
-  return &result.value;
-}
+  std::array<Stripe, STRIPES> m_stripes;
+};
 
-namespace std
+static StripedMap<Common::TraversalRequestId, OutgoingPacketInfo> outgoingPackets;
+static StripedMap<Common::TraversalHostId, HostInfo> connectedClients;
+
+struct Timer
 {
-template <>
-struct hash<Common::TraversalHostId>
+  u64 due;
+  bool isHost;
+  Common::TraversalRequestId requestId;
+  Common::TraversalHostId hostId;
+};
+
+// A timer fires within a tick after it is due
+class TimerWheel
 {
-  size_t operator()(const Common::TraversalHostId& id) const noexcept
+public:
+  static constexpr u64 TICK = 10000;  // 10ms
+  static constexpr size_t SLOTS = 512;
+
+  explicit TimerWheel(u64 now) : m_tick(now / TICK) {}
+
+  void Add(const Timer& timer)
   {
-    auto p = (u32*)id.data();
-    return p[0] ^ ((p[1] << 13) | (p[1] >> 19));
+    m_slots[std::max(timer.due / TICK, m_tick) % SLOTS].push_back(timer);
   }
-};
-}  // namespace std
 
-using ConnectedClients =
-    std::unordered_map<Common::TraversalHostId, EvictEntry<Common::TraversalInetAddress>>;
-using OutgoingPackets = std::unordered_map<Common::TraversalRequestId, OutgoingPacketInfo>;
+  // Calls f with every timer that is due, which may add timers
+  template <typename F>
+  void Advance(u64 now, F&& f)
+  {
+    const u64 target = now / TICK;
+    // Every slot is looked at once when more than a turn was missed
+    if (target >= m_tick + SLOTS)
+      m_tick = target + 1 - SLOTS;
+
+    while (m_tick <= target)
+    {
+      const u64 tick = m_tick++;
+      std::vector<Timer>& slot = m_slots[tick % SLOTS];
+
+      // Timers more than a turn away stay for a later turn
+      m_fired.clear();
+      std::erase_if(slot, [this, tick](const Timer& timer) {
+        if (timer.due / TICK > tick)
+          return false;
+        m_fired.push_back(timer);
+        return true;
+      });
+
+      for (const Timer& timer : m_fired)
+        f(timer);
+    }
+  }
+
+private:
+  std::array<std::vector<Timer>, SLOTS> m_slots;
+  std::vector<Timer> m_fired;
+  // The next tick to look at
+  u64 m_tick;
+};
 
-static int sock;
-static int sockAlt;
-static OutgoingPackets outgoingPackets;
-static ConnectedClients connectedClients;
+struct alignas(64) Counters
+{
+  std::atomic<u64> received{0};
+  std::atomic<u64> sent{0};
+  std::atomic<u64> receiveCalls{0};
+  std::atomic<u64> sendCalls{0};
+  std::atomic<u64> resent{0};
+  std::atomic<u64> connectsReady{0};
+  std::atomic<u64> connectsFailed{0};
+  // When the thread last went through its loop
+  std::atomic<u64> lastLoopTime{0};
+};
 
 static Common::TraversalInetAddress MakeInetAddress(const sockaddr_in6& addr)
 {
@@ -185,248 +257,456 @@ static void GetRandomHostId(Common::TraversalHostId* hostId)
   memcpy(hostId->data(), buf, 8);
 }
 
-static const char* SenderName(sockaddr_in6* addr)
+static std::string SenderName(const sockaddr_in6* addr)
 {
-  static char buf[INET6_ADDRSTRLEN + 10]{};
+  char buf[INET6_ADDRSTRLEN]{};
   inet_ntop(PF_INET6, &addr->sin6_addr, buf, sizeof(buf));
-  fmt::format_to(buf + strlen(buf), ":{}", ntohs(addr->sin6_port));
-  return buf;
+  return fmt::format("{}:{}", buf, ntohs(addr->sin6_port));
 }
 
-static void TrySend(const void* buffer, size_t size, sockaddr_in6* addr, bool fromAlt)
+static std::optional<Common::TraversalInetAddress>
+FindHost(const Common::TraversalHostId& hostId, u64 now, bool refresh = false)
 {
+  return connectedClients.With(
+      hostId, [&](auto& map) -> std::optional<Common::TraversalInetAddress> {
+        auto it = map.find(hostId);
+        if (it == map.end())
+          return std::nullopt;
+        if (now - it->second.updateTime >= HOST_EXPIRY_TIME)
+        {
+          map.erase(it);
+          return std::nullopt;
+        }
+        if (refresh)
+          it->second.updateTime = now;
+        return it->second.address;
+      });
+}
+
+// Packets to send from one socket, sent together once the received ones were handled
+class SendQueue
+{
+public:
+  SendQueue(int sock, Counters& counters) : m_sock(sock), m_counters(counters) {}
+
+  void Push(const Common::TraversalPacket& packet, const sockaddr_in6& dest)
+  {
 #if DEBUG
-  const auto* packet = static_cast<const Common::TraversalPacket*>(buffer);
-  fmt::print("{}-> {} {} {}\n", fromAlt ? "alt " : "", static_cast<int>(packet->type),
-             static_cast<long long>(packet->requestId), SenderName(addr));
+    fmt::print("{}-> {} {} {}\n", m_sock, static_cast<int>(packet.type),
+               static_cast<long long>(packet.requestId), SenderName(&dest));
 #endif
-  if ((size_t)sendto(fromAlt ? sockAlt : sock, buffer, size, 0, (sockaddr*)addr, sizeof(*addr)) !=
-      size)
+    m_packets[m_count] = packet;
+    m_dests[m_count] = dest;
+    if (++m_count == BATCH_SIZE)
+      Flush();
+  }
+
+  void Flush()
   {
-    perror("sendto");
+    size_t index = 0;
+    while (index < m_count)
+    {
+#if BATCHED_IO
+      std::array<iovec, BATCH_SIZE> iovecs;
+      std::array<mmsghdr, BATCH_SIZE> messages{};
+      const size_t count = m_count - index;
+      for (size_t i = 0; i < count; ++i)
+      {
+        iovecs[i] = {&m_packets[index + i], sizeof(Common::TraversalPacket)};
+        messages[i].msg_hdr.msg_name = &m_dests[index + i];
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in6);
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+      }
+      const int rv = sendmmsg(m_sock, messages.data(), static_cast<unsigned int>(count), 0);
+#else
+      const int rv = sendto(m_sock, &m_packets[index], sizeof(Common::TraversalPacket), 0,
+                            (sockaddr*)&m_dests[index], sizeof(sockaddr_in6)) ==
+                             sizeof(Common::TraversalPacket) ?
+                         1 :
+                         -1;
+#endif
+      m_counters.sendCalls.fetch_add(1, std::memory_order_relaxed);
+      if (rv < 0)
+      {
+        // Skip the packet that could not be sent
+        perror("sendto");
+        ++index;
+        continue;
+      }
+      m_counters.sent.fetch_add(rv, std::memory_order_relaxed);
+      index += rv;
+    }
+    m_count = 0;
   }
-}
 
-static Common::TraversalPacket* AllocPacket(const sockaddr_in6& dest, bool fromAlt,
-                                            Common::TraversalRequestId misc = 0)
+private:
+  int m_sock;
+  Counters& m_counters;
+  std::array<Common::TraversalPacket, BATCH_SIZE> m_packets;
+  std::array<sockaddr_in6, BATCH_SIZE> m_dests;
+  size_t m_count = 0;
+};
+
+class ServerThread
 {
-  Common::TraversalRequestId requestId{};
-  Common::Random::Generate(&requestId, sizeof(requestId));
-  OutgoingPacketInfo* info = &outgoingPackets[requestId];
-  info->fromAlt = fromAlt;
-  info->dest = dest;
-  info->misc = misc;
-  info->tries = 0;
-  info->sendTime = currentTime;
-  Common::TraversalPacket* result = &info->packet;
-  memset(result, 0, sizeof(*result));
-  result->requestId = requestId;
-  return result;
-}
+public:
+  ServerThread(int sock, int sockAlt)
+      : m_sock(sock), m_sockAlt(sockAlt), m_send{SendQueue(sock, counters),
+                                                 SendQueue(sockAlt, counters)},
+        m_timers(GetCurrentTime())
+  {
+  }
+
+  void Run();
 
-static void SendPacket(OutgoingPacketInfo* info)
+  Counters counters;
+
+private:
+  void Receive(int sock, bool toAlt);
+  void HandlePacket(const Common::TraversalPacket& packet, const sockaddr_in6& addr, bool toAlt);
+  void HandleTimer(const Timer& timer);
+
+  void Send(const Common::TraversalPacket& packet, const sockaddr_in6& dest, bool fromAlt)
+  {
+    m_send[fromAlt].Push(packet, dest);
+  }
+  // Resent until it is acked
+  void SendReliable(Common::TraversalPacket packet, const sockaddr_in6& dest, bool fromAlt,
+                    Common::TraversalRequestId misc = 0);
+
+  int m_sock;
+  int m_sockAlt;
+  std::array<SendQueue, 2> m_send;
+  TimerWheel m_timers;
+  u64 m_now = 0;
+};
+
+void ServerThread::SendReliable(Common::TraversalPacket packet, const sockaddr_in6& dest,
+                                bool fromAlt, Common::TraversalRequestId misc)
 {
-  info->tries++;
-  info->sendTime = currentTime;
-  TrySend(&info->packet, sizeof(info->packet), &info->dest, info->fromAlt);
+  Common::Random::Generate(&packet.requestId, sizeof(packet.requestId));
+  outgoingPackets.With(packet.requestId, [&](auto& map) {
+    map.insert_or_assign(packet.requestId, OutgoingPacketInfo{packet, misc, fromAlt, dest, 1});
+  });
+  Send(packet, dest, fromAlt);
+  m_timers.Add({m_now + RESEND_INTERVAL, false, packet.requestId, {}});
 }
 
-static void ResendPackets()
+void ServerThread::HandleTimer(const Timer& timer)
 {
-  std::vector<std::tuple<Common::TraversalInetAddress, bool, Common::TraversalRequestId>>
-      todoFailures;
-  todoFailures.clear();
-  for (auto it = outgoingPackets.begin(); it != outgoingPackets.end();)
+  if (timer.isHost)
   {
-    OutgoingPacketInfo* info = &it->second;
-    if (currentTime - info->sendTime >= (u64)(300000 * info->tries))
+    const std::optional<u64> due =
+        connectedClients.With(timer.hostId, [&](auto& map) -> std::optional<u64> {
+          auto it = map.find(timer.hostId);
+          if (it == map.end())
+            return std::nullopt;
+          if (m_now - it->second.updateTime >= HOST_EXPIRY_TIME)
+          {
+            map.erase(it);
+            return std::nullopt;
+          }
+          return it->second.updateTime + HOST_EXPIRY_TIME;
+        });
+    if (due)
+      m_timers.Add({*due, true, 0, timer.hostId});
+    return;
+  }
+
+  std::optional<OutgoingPacketInfo> resend;
+  std::optional<OutgoingPacketInfo> failure;
+  outgoingPackets.With(timer.requestId, [&](auto& map) {
+    auto it = map.find(timer.requestId);
+    if (it == map.end())
+      return;
+    if (it->second.tries >= NUMBER_OF_TRIES)
     {
-      if (info->tries >= NUMBER_OF_TRIES)
-      {
-        if (info->packet.type == Common::TraversalPacketType::PleaseSendPacket)
-        {
-          todoFailures.push_back(
-              std::make_tuple(info->packet.pleaseSendPacket.address, info->fromAlt, info->misc));
-        }
-        it = outgoingPackets.erase(it);
-        continue;
-      }
-      else
-      {
-        SendPacket(info);
-      }
+      failure = it->second;
+      map.erase(it);
+      return;
     }
-    ++it;
-  }
+    it->second.tries++;
+    resend = it->second;
+  });
 
-  for (const auto& p : todoFailures)
+  if (resend)
   {
-    Common::TraversalPacket* fail = AllocPacket(MakeSinAddr(std::get<0>(p)), std::get<1>(p));
-    fail->type = Common::TraversalPacketType::ConnectFailed;
-    fail->connectFailed.requestId = std::get<2>(p);
-    fail->connectFailed.reason = Common::TraversalConnectFailedReason::ClientDidntRespond;
+    counters.resent.fetch_add(1, std::memory_order_relaxed);
+    Send(resend->packet, resend->dest, resend->fromAlt);
+    m_timers.Add({m_now + RESEND_INTERVAL * resend->tries, false, timer.requestId, {}});
+  }
+  else if (failure && failure->packet.type == Common::TraversalPacketType::PleaseSendPacket)
+  {
+    counters.connectsFailed.fetch_add(1, std::memory_order_relaxed);
+    Common::TraversalPacket fail{};
+    fail.type = Common::TraversalPacketType::ConnectFailed;
+    fail.connectFailed.requestId = failure->misc;
+    fail.connectFailed.reason = Common::TraversalConnectFailedReason::ClientDidntRespond;
+    SendReliable(fail, MakeSinAddr(failure->packet.pleaseSendPacket.address), failure->fromAlt);
   }
 }
 
-static void HandlePacket(Common::TraversalPacket* packet, sockaddr_in6* addr, bool toAlt)
+void ServerThread::HandlePacket(const Common::TraversalPacket& packet, const sockaddr_in6& addr,
+                                bool toAlt)
 {
 #if DEBUG
-  fmt::print("<- {} {} {}\n", static_cast<int>(packet->type),
-             static_cast<long long>(packet->requestId), SenderName(addr));
+  fmt::print("<- {} {} {}\n", static_cast<int>(packet.type),
+             static_cast<long long>(packet.requestId), SenderName(&addr));
 #endif
   bool packetOk = true;
-  switch (packet->type)
+  switch (packet.type)
   {
   case Common::TraversalPacketType::Ack:
   {
-    auto it = outgoingPackets.find(packet->requestId);
-    if (it == outgoingPackets.end())
+    const std::optional<OutgoingPacketInfo> info =
+        outgoingPackets.With(packet.requestId, [&](auto& map) -> std::optional<OutgoingPacketInfo> {
+          auto it = map.find(packet.requestId);
+          if (it == map.end())
+            return std::nullopt;
+          OutgoingPacketInfo result = it->second;
+          map.erase(it);
+          return result;
+        });
+    if (!info)
       break;
 
-    OutgoingPacketInfo* info = &it->second;
-
     if (info->packet.type == Common::TraversalPacketType::PleaseSendPacket)
     {
-      auto* ready = AllocPacket(MakeSinAddr(info->packet.pleaseSendPacket.address), toAlt);
-      if (packet->ack.ok)
+      Common::TraversalPacket ready{};
+      if (packet.ack.ok)
       {
-        ready->type = Common::TraversalPacketType::ConnectReady;
-        ready->connectReady.requestId = info->misc;
-        ready->connectReady.address = MakeInetAddress(info->dest);
+        counters.connectsReady.fetch_add(1, std::memory_order_relaxed);
+        ready.type = Common::TraversalPacketType::ConnectReady;
+        ready.connectReady.requestId = info->misc;
+        ready.connectReady.address = MakeInetAddress(info->dest);
       }
       else
       {
-        ready->type = Common::TraversalPacketType::ConnectFailed;
-        ready->connectFailed.requestId = info->misc;
-        ready->connectFailed.reason = Common::TraversalConnectFailedReason::ClientFailure;
+        counters.connectsFailed.fetch_add(1, std::memory_order_relaxed);
+        ready.type = Common::TraversalPacketType::ConnectFailed;
+        ready.connectFailed.requestId = info->misc;
+        ready.connectFailed.reason = Common::TraversalConnectFailedReason::ClientFailure;
       }
+      SendReliable(ready, MakeSinAddr(info->packet.pleaseSendPacket.address), toAlt);
     }
-
-    outgoingPackets.erase(it);
     break;
   }
   case Common::TraversalPacketType::Ping:
   {
-    auto r = EvictFind(connectedClients, packet->ping.hostId, true);
-    packetOk = r.found;
+    packetOk = FindHost(packet.ping.hostId, m_now, true).has_value();
     break;
   }
   case Common::TraversalPacketType::HelloFromClient:
   {
-    u8 ok = packet->helloFromClient.protoVersion <= Common::TraversalProtoVersion;
-    Common::TraversalPacket* reply = AllocPacket(*addr, toAlt);
-    reply->type = Common::TraversalPacketType::HelloFromServer;
-    reply->helloFromServer.ok = ok;
+    u8 ok = packet.helloFromClient.protoVersion <= Common::TraversalProtoVersion;
+    Common::TraversalPacket reply{};
+    reply.type = Common::TraversalPacketType::HelloFromServer;
+    reply.helloFromServer.ok = ok;
     if (ok)
     {
+      const Common::TraversalInetAddress iaddr = MakeInetAddress(addr);
       Common::TraversalHostId hostId{};
-      Common::TraversalInetAddress* iaddr{};
       // not that there is any significant change of
       // duplication, but...
       while (true)
       {
         GetRandomHostId(&hostId);
-        auto r = EvictFind(connectedClients, hostId);
-        if (!r.found)
-        {
-          iaddr = EvictSet(connectedClients, hostId);
+        const bool added = connectedClients.With(hostId, [&](auto& map) {
+          auto it = map.find(hostId);
+          if (it != map.end() && m_now - it->second.updateTime < HOST_EXPIRY_TIME)
+            return false;
+          map.insert_or_assign(hostId, HostInfo{iaddr, m_now});
+          return true;
+        });
+        if (added)
           break;
-        }
       }
+      m_timers.Add({m_now + HOST_EXPIRY_TIME, true, 0, hostId});
 
-      *iaddr = MakeInetAddress(*addr);
-
-      reply->helloFromServer.yourAddress = *iaddr;
-      reply->helloFromServer.yourHostId = hostId;
+      reply.helloFromServer.yourAddress = iaddr;
+      reply.helloFromServer.yourHostId = hostId;
     }
+    SendReliable(reply, addr, toAlt);
     break;
   }
   case Common::TraversalPacketType::ConnectPlease:
   {
-    Common::TraversalHostId& hostId = packet->connectPlease.hostId;
-    auto r = EvictFind(connectedClients, hostId);
-    if (!r.found)
+    const Common::TraversalHostId& hostId = packet.connectPlease.hostId;
+    const std::optional<Common::TraversalInetAddress> hostAddr = FindHost(hostId, m_now);
+    if (!hostAddr)
     {
-      Common::TraversalPacket* reply = AllocPacket(*addr, toAlt);
-      reply->type = Common::TraversalPacketType::ConnectFailed;
-      reply->connectFailed.requestId = packet->requestId;
-      reply->connectFailed.reason = Common::TraversalConnectFailedReason::NoSuchClient;
+      Common::TraversalPacket reply{};
+      reply.type = Common::TraversalPacketType::ConnectFailed;
+      reply.connectFailed.requestId = packet.requestId;
+      reply.connectFailed.reason = Common::TraversalConnectFailedReason::NoSuchClient;
+      SendReliable(reply, addr, toAlt);
     }
     else
     {
-      Common::TraversalPacket* please =
-          AllocPacket(MakeSinAddr(*r.value), toAlt, packet->requestId);
-      please->type = Common::TraversalPacketType::PleaseSendPacket;
-      please->pleaseSendPacket.address = MakeInetAddress(*addr);
+      Common::TraversalPacket please{};
+      please.type = Common::TraversalPacketType::PleaseSendPacket;
+      please.pleaseSendPacket.address = MakeInetAddress(addr);
+      SendReliable(please, MakeSinAddr(*hostAddr), toAlt, packet.requestId);
     }
     break;
   }
   case Common::TraversalPacketType::TestPlease:
   {
-    Common::TraversalHostId& hostId = packet->testPlease.hostId;
-    auto r = EvictFind(connectedClients, hostId);
-    if (r.found)
+    const std::optional<Common::TraversalInetAddress> hostAddr =
+        FindHost(packet.testPlease.hostId, m_now);
+    if (hostAddr)
     {
       Common::TraversalPacket ack = {};
       ack.type = Common::TraversalPacketType::Ack;
-      ack.requestId = packet->requestId;
+      ack.requestId = packet.requestId;
       ack.ack.ok = true;
-      sockaddr_in6 mainAddr = MakeSinAddr(*r.value);
-      TrySend(&ack, sizeof(ack), &mainAddr, toAlt);
+      Send(ack, MakeSinAddr(*hostAddr), toAlt);
     }
     break;
   }
   default:
-    fmt::print(stderr, "received unknown packet type {} from {}\n", static_cast<int>(packet->type),
-               SenderName(addr));
+    fmt::print(stderr, "received unknown packet type {} from {}\n", static_cast<int>(packet.type),
+               SenderName(&addr));
     break;
   }
-  if (packet->type != Common::TraversalPacketType::Ack)
+  if (packet.type != Common::TraversalPacketType::Ack)
   {
     Common::TraversalPacket ack = {};
     ack.type = Common::TraversalPacketType::Ack;
-    ack.requestId = packet->requestId;
+    ack.requestId = packet.requestId;
     ack.ack.ok = packetOk;
-    TrySend(&ack, sizeof(ack), addr,
-            packet->type != Common::TraversalPacketType::TestPlease ? toAlt : !toAlt);
+    Send(ack, addr, packet.type != Common::TraversalPacketType::TestPlease ? toAlt : !toAlt);
   }
 }
 
-int main()
+void ServerThread::Receive(int sock, bool toAlt)
 {
-  int rv;
-  sock = socket(PF_INET6, SOCK_DGRAM, 0);
-  if (sock == -1)
+  std::array<Common::TraversalPacket, BATCH_SIZE> packets;
+  std::array<sockaddr_in6, BATCH_SIZE> addrs;
+  std::array<size_t, BATCH_SIZE> sizes;
+  size_t count = 0;
+
+#if BATCHED_IO
+  std::array<iovec, BATCH_SIZE> iovecs;
+  std::array<mmsghdr, BATCH_SIZE> messages{};
+  for (size_t i = 0; i < BATCH_SIZE; ++i)
+  {
+    iovecs[i] = {&packets[i], sizeof(Common::TraversalPacket)};
+    messages[i].msg_hdr.msg_name = &addrs[i];
+    messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in6);
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+  const int rv = recvmmsg(sock, messages.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+  counters.receiveCalls.fetch_add(1, std::memory_order_relaxed);
+  if (rv < 0)
+  {
+    if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)
+      perror("recvmmsg");
+    return;
+  }
+  count = rv;
+  for (size_t i = 0; i < count; ++i)
+    sizes[i] = messages[i].msg_len;
+#else
+  for (; count < BATCH_SIZE; ++count)
+  {
+    socklen_t addrLen = sizeof(sockaddr_in6);
+    const ssize_t rv = recvfrom(sock, &packets[count], sizeof(Common::TraversalPacket),
+                                MSG_DONTWAIT, (sockaddr*)&addrs[count], &addrLen);
+    counters.receiveCalls.fetch_add(1, std::memory_order_relaxed);
+    if (rv < 0)
+    {
+      if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)
+        perror("recvfrom");
+      break;
+    }
+    sizes[count] = rv;
+  }
+#endif
+
+  counters.received.fetch_add(count, std::memory_order_relaxed);
+  m_now = GetCurrentTime();
+  for (size_t i = 0; i < count; ++i)
   {
-    perror("socket");
-    return 1;
+    if (sizes[i] < sizeof(Common::TraversalPacket))
+      fmt::print(stderr, "received short packet from {}\n", SenderName(&addrs[i]));
+    else
+      HandlePacket(packets[i], addrs[i], toAlt);
   }
-  sockAlt = socket(PF_INET6, SOCK_DGRAM, 0);
-  if (sockAlt == -1)
+}
+
+void ServerThread::Run()
+{
+  std::array<pollfd, 2> fds{};
+  fds[0].fd = m_sock;
+  fds[0].events = POLLIN;
+  fds[1].fd = m_sockAlt;
+  fds[1].events = POLLIN;
+
+  while (true)
   {
-    perror("socket alt");
-    return 1;
+    const int rv = poll(fds.data(), fds.size(), TimerWheel::TICK / 1000);
+    if (rv < 0 && errno != EINTR && errno != EAGAIN)
+    {
+      perror("poll");
+      exit(1);
+    }
+
+    if (rv > 0)
+    {
+      if (fds[0].revents & POLLIN)
+        Receive(m_sock, false);
+      if (fds[1].revents & POLLIN)
+        Receive(m_sockAlt, true);
+    }
+
+    m_now = GetCurrentTime();
+    m_timers.Advance(m_now, [this](const Timer& timer) { HandleTimer(timer); });
+
+    for (SendQueue& queue : m_send)
+      queue.Flush();
+    counters.lastLoopTime.store(m_now, std::memory_order_relaxed);
+  }
+}
+
+static int OpenSocket(u16 port, bool reusePort, const char* name)
+{
+  int sock = socket(PF_INET6, SOCK_DGRAM, 0);
+  if (sock == -1)
+  {
+    perror(fmt::format("socket {}", name).c_str());
+    return -1;
   }
   int no = 0;
-  rv = setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &no, sizeof(no));
+  int rv = setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &no, sizeof(no));
   if (rv < 0)
   {
-    perror("setsockopt IPV6_V6ONLY");
-    return 1;
+    perror(fmt::format("setsockopt IPV6_V6ONLY {}", name).c_str());
+    return -1;
   }
-  rv = setsockopt(sockAlt, IPPROTO_IPV6, IPV6_V6ONLY, &no, sizeof(no));
-  if (rv < 0)
+  if (reusePort)
   {
-    perror("setsockopt IPV6_V6ONLY alt");
-    return 1;
+    int yes = 1;
+    rv = setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes));
+    if (rv < 0)
+    {
+      perror(fmt::format("setsockopt SO_REUSEPORT {}", name).c_str());
+      return -1;
+    }
   }
+  // Room for bursts while the thread is busy with a batch
+  int bufferSize = 4 * 1024 * 1024;
+  setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
   in6_addr any = IN6ADDR_ANY_INIT;
   sockaddr_in6 addr;
 #ifdef SIN6_LEN
   addr.sin6_len = sizeof(addr);
 #endif
   addr.sin6_family = AF_INET6;
-  addr.sin6_port = htons(PORT);
+  addr.sin6_port = htons(port);
   addr.sin6_flowinfo = 0;
   addr.sin6_addr = any;
   addr.sin6_scope_id = 0;
@@ -434,97 +714,102 @@ int main()
   rv = bind(sock, (sockaddr*)&addr, sizeof(addr));
   if (rv < 0)
   {
-    perror("bind");
-    return 1;
-  }
-  addr.sin6_port = htons(PORT_ALT);
-  rv = bind(sockAlt, (sockaddr*)&addr, sizeof(addr));
-  if (rv < 0)
-  {
-    perror("bind alt");
-    return 1;
+    perror(fmt::format("bind {}", name).c_str());
+    return -1;
   }
+  return sock;
+}
 
-  timeval tv;
-  tv.tv_sec = 0;
-  tv.tv_usec = 300000;
-  rv = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-  if (rv < 0)
+int main(int argc, char** argv)
+{
+#if BATCHED_IO
+  size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+#else
+  size_t threadCount = 1;
+#endif
+  bool printStats = false;
+  for (int i = 1; i < argc; ++i)
   {
-    perror("setsockopt SO_RCVTIMEO");
-    return 1;
+    const std::string arg = argv[i];
+    if (arg == "--threads" && i + 1 < argc && BATCHED_IO)
+    {
+      threadCount = std::max(std::atoi(argv[++i]), 1);
+    }
+    else if (arg == "--stats")
+    {
+      printStats = true;
+    }
+    else
+    {
+      fmt::print(stderr, "usage: {} [--threads count] [--stats]\n", argv[0]);
+      return 1;
+    }
   }
-  rv = setsockopt(sockAlt, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-  if (rv < 0)
+
+  std::vector<std::unique_ptr<ServerThread>> threads;
+  for (size_t i = 0; i < threadCount; ++i)
   {
-    perror("setsockopt SO_RCVTIMEO alt");
-    return 1;
+    const int sock = OpenSocket(PORT, threadCount > 1, "main");
+    const int sockAlt = OpenSocket(PORT_ALT, threadCount > 1, "alt");
+    if (sock == -1 || sockAlt == -1)
+      return 1;
+    threads.push_back(std::make_unique<ServerThread>(sock, sockAlt));
   }
+  for (auto& thread : threads)
+    std::thread(&ServerThread::Run, thread.get()).detach();
 
 #ifdef HAVE_LIBSYSTEMD
   sd_notifyf(0, "READY=1\nSTATUS=Listening on port %d (alt port: %d)", PORT, PORT_ALT);
 #endif
 
+  // Per second counters, reported to systemd and on request printed
+  struct Totals
+  {
+    u64 received = 0, sent = 0, receiveCalls = 0, sendCalls = 0, resent = 0;
+    u64 connectsReady = 0, connectsFailed = 0;
+  };
+  Totals last;
   while (true)
   {
-    tv.tv_sec = 0;
-    tv.tv_usec = 300000;
-    fd_set readSet;
-    FD_ZERO(&readSet);
-    FD_SET(sock, &readSet);
-    FD_SET(sockAlt, &readSet);
-    rv = select(std::max(sock, sockAlt) + 1, &readSet, nullptr, nullptr, &tv);
-    if (rv < 0)
-    {
-      if (errno != EINTR && errno != EAGAIN)
-      {
-        perror("recvfrom");
-        return 1;
-      }
-    }
+    std::this_thread::sleep_for(std::chrono::seconds(1));
 
-    int recvsock;
-    if (FD_ISSET(sock, &readSet))
-    {
-      recvsock = sock;
-    }
-    else if (FD_ISSET(sockAlt, &readSet))
-    {
-      recvsock = sockAlt;
-    }
-    else
+    const u64 now = GetCurrentTime();
+    Totals totals;
+    bool alive = true;
+    for (auto& thread : threads)
     {
-      ResendPackets();
-      continue;
+      const Counters& c = thread->counters;
+      totals.received += c.received.load(std::memory_order_relaxed);
+      totals.sent += c.sent.load(std::memory_order_relaxed);
+      totals.receiveCalls += c.receiveCalls.load(std::memory_order_relaxed);
+      totals.sendCalls += c.sendCalls.load(std::memory_order_relaxed);
+      totals.resent += c.resent.load(std::memory_order_relaxed);
+      totals.connectsReady += c.connectsReady.load(std::memory_order_relaxed);
+      totals.connectsFailed += c.connectsFailed.load(std::memory_order_relaxed);
+      alive &= now - c.lastLoopTime.load(std::memory_order_relaxed) < 5 * 1000000;
     }
-    sockaddr_in6 raddr;
-    socklen_t addrLen = sizeof(raddr);
-    Common::TraversalPacket packet{};
-    // note: switch to recvmmsg (yes, mmsg) if this becomes
-    // expensive
-    rv = recvfrom(recvsock, &packet, sizeof(packet), 0, (sockaddr*)&raddr, &addrLen);
-    currentTime = std::chrono::duration_cast<std::chrono::microseconds>(
-                      std::chrono::system_clock::now().time_since_epoch())
-                      .count();
-    if (rv < 0)
-    {
-      if (errno != EINTR && errno != EAGAIN)
-      {
-        perror("recvfrom");
-        return 1;
-      }
-    }
-    else if ((size_t)rv < sizeof(packet))
-    {
-      fmt::print(stderr, "received short packet from {}\n", SenderName(&raddr));
-    }
-    else
+
+    const std::string stats = fmt::format(
+        "rx {}/s ({} calls) tx {}/s ({} calls) resent {}/s connects {}/s failed {}/s hosts {} "
+        "pending {}",
+        totals.received - last.received, totals.receiveCalls - last.receiveCalls,
+        totals.sent - last.sent, totals.sendCalls - last.sendCalls, totals.resent - last.resent,
+        totals.connectsReady - last.connectsReady, totals.connectsFailed - last.connectsFailed,
+        connectedClients.Size(), outgoingPackets.Size());
+    last = totals;
+
+    if (printStats)
     {
-      HandlePacket(&packet, &raddr, recvsock == sockAlt);
+      fmt::print("{}\n", stats);
+      fflush(stdout);
     }
-    ResendPackets();
 #ifdef HAVE_LIBSYSTEMD
-    sd_notify(0, "WATCHDOG=1");
+    sd_notifyf(0, "STATUS=%s", stats.c_str());
+    // A stuck thread stops the watchdog from being fed
+    if (alive)
+      sd_notify(0, "WATCHDOG=1");
+#else
+    (void)alive;
 #endif
   }
 }
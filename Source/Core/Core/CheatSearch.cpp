@@ -3,10 +3,14 @@
 
 #include "Core/CheatSearch.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <variant>
 #include <vector>
@@ -15,6 +19,7 @@
 #include "Common/Assert.h"
 #include "Common/BitUtils.h"
 #include "Common/StringUtil.h"
+#include "Common/Swap.h"
 
 #include "Core/Config/AchievementSettings.h"
 #include "Core/Core.h"
@@ -23,6 +28,10 @@
 #include "Core/PowerPC/PowerPC.h"
 #include "Core/System.h"
 
+#ifdef _M_X86_64
+#include <immintrin.h>
+#endif
+
 Cheats::DataType Cheats::GetDataType(const Cheats::SearchValue& value)
 {
   // sanity checks that our enum matches with our std::variant
@@ -198,20 +207,338 @@ TryReadValueFromEmulatedMemory(const Core::CPUThreadGuard& guard, u32 addr,
 {
   return PowerPC::MMU::HostTryReadF64(guard, addr, space);
 }
-}  // namespace
+
+// Memory is copied in chunks that never cross a page, so each chunk is translated only once
+constexpr u32 COPY_CHUNK_SIZE = 0x1000;
+// Words of 64 positions a worker thread gets at least, fewer are not worth starting a thread for
+constexpr size_t MIN_WORDS_PER_THREAD = 0x2000;
+// Bytes after the copy that kernels may load past the last position
+constexpr size_t MEMORY_PADDING = 32;
+
+template <typename Func>
+void ParallelForWords(size_t word_count, const Func& func)
+{
+  const size_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  const size_t thread_count =
+      std::clamp<size_t>(word_count / MIN_WORDS_PER_THREAD, 1, max_threads);
+  const size_t words_per_thread = (word_count + thread_count - 1) / thread_count;
+
+  std::vector<std::thread> workers;
+  workers.reserve(thread_count - 1);
+  for (size_t begin = words_per_thread; begin < word_count; begin += words_per_thread)
+  {
+    const size_t end = std::min(begin + words_per_thread, word_count);
+    workers.emplace_back([&func, begin, end] { func(begin, end); });
+  }
+  func(0, std::min(words_per_thread, word_count));
+
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+// Bits of a word that are aligned positions for values of the given size
+constexpr u64 AlignedPositions(u32 value_size)
+{
+  switch (value_size)
+  {
+  case 2:
+    return 0x5555555555555555;
+  case 4:
+    return 0x1111111111111111;
+  case 8:
+    return 0x0101010101010101;
+  default:
+    return ~u64(0);
+  }
+}
+
+const u8* GetRAMPointer(Memory::MemoryManager& memory, u32 physical_address, u32 size)
+{
+  const u32 offset = physical_address & 0x0FFFFFFF;
+  switch (physical_address >> 28)
+  {
+  case 0x0:
+    if (memory.GetRAM() && offset < memory.GetRamSizeReal() &&
+        size <= memory.GetRamSizeReal() - offset)
+    {
+      return memory.GetRAM() + offset;
+    }
+    break;
+  case 0x1:
+    if (memory.GetEXRAM() && offset < memory.GetExRamSizeReal() &&
+        size <= memory.GetExRamSizeReal() - offset)
+    {
+      return memory.GetEXRAM() + offset;
+    }
+    break;
+  }
+  return nullptr;
+}
+
+template <typename Func>
+void DispatchCompareType(Cheats::CompareType compare_type, const Func& func)
+{
+  using Cheats::CompareType;
+  switch (compare_type)
+  {
+  case CompareType::Equal:
+    func(std::integral_constant<CompareType, CompareType::Equal>());
+    break;
+  case CompareType::NotEqual:
+    func(std::integral_constant<CompareType, CompareType::NotEqual>());
+    break;
+  case CompareType::Less:
+    func(std::integral_constant<CompareType, CompareType::Less>());
+    break;
+  case CompareType::LessOrEqual:
+    func(std::integral_constant<CompareType, CompareType::LessOrEqual>());
+    break;
+  case CompareType::Greater:
+    func(std::integral_constant<CompareType, CompareType::Greater>());
+    break;
+  case CompareType::GreaterOrEqual:
+    func(std::integral_constant<CompareType, CompareType::GreaterOrEqual>());
+    break;
+  default:
+    DEBUG_ASSERT(false);
+    break;
+  }
+}
+
+template <Cheats::CompareType compare_type, typename T>
+bool Compare(const T& new_value, const T& old_value)
+{
+  if constexpr (compare_type == Cheats::CompareType::Equal)
+    return new_value == old_value;
+  else if constexpr (compare_type == Cheats::CompareType::NotEqual)
+    return new_value != old_value;
+  else if constexpr (compare_type == Cheats::CompareType::Less)
+    return new_value < old_value;
+  else if constexpr (compare_type == Cheats::CompareType::LessOrEqual)
+    return new_value <= old_value;
+  else if constexpr (compare_type == Cheats::CompareType::Greater)
+    return new_value > old_value;
+  else
+    return new_value >= old_value;
+}
 
 template <typename T>
-Common::Result<Cheats::SearchErrorCode, std::vector<Cheats::SearchResult<T>>>
-Cheats::NewSearch(const Core::CPUThreadGuard& guard,
-                  const std::vector<Cheats::MemoryRange>& memory_ranges,
-                  PowerPC::RequestedAddressSpace address_space, bool aligned,
-                  const std::function<bool(const T& value)>& validator)
+T LoadValue(const u8* memory)
+{
+  T value;
+  std::memcpy(&value, memory, sizeof(T));
+  return Common::FromBigEndian(value);
+}
+
+template <typename T, Cheats::CompareType compare_type, bool against_previous>
+u64 CompareWordScalar(const u8* memory, const u8* previous_memory, const T& value, bool aligned)
+{
+  const u32 step = aligned ? sizeof(T) : 1;
+  u64 matches = 0;
+  for (u32 i = 0; i < 64; i += step)
+  {
+    const T reference = against_previous ? LoadValue<T>(previous_memory + i) : value;
+    matches |= u64(Compare<compare_type>(LoadValue<T>(memory + i), reference)) << i;
+  }
+  return matches;
+}
+
+#ifdef _M_X86_64
+template <size_t size>
+__m128i SwapBytes(__m128i vector)
+{
+  if constexpr (size == 1)
+    return vector;
+
+  vector = _mm_or_si128(_mm_slli_epi16(vector, 8), _mm_srli_epi16(vector, 8));
+  if constexpr (size == 4)
+  {
+    vector = _mm_shufflelo_epi16(vector, _MM_SHUFFLE(2, 3, 0, 1));
+    vector = _mm_shufflehi_epi16(vector, _MM_SHUFFLE(2, 3, 0, 1));
+  }
+  else if constexpr (size == 8)
+  {
+    vector = _mm_shufflelo_epi16(vector, _MM_SHUFFLE(0, 1, 2, 3));
+    vector = _mm_shufflehi_epi16(vector, _MM_SHUFFLE(0, 1, 2, 3));
+  }
+  return vector;
+}
+
+template <typename T>
+__m128i Broadcast(const T& value)
+{
+  if constexpr (sizeof(T) == 1)
+    return _mm_set1_epi8(static_cast<char>(Common::BitCast<u8>(value)));
+  else if constexpr (sizeof(T) == 2)
+    return _mm_set1_epi16(static_cast<short>(Common::BitCast<u16>(value)));
+  else if constexpr (sizeof(T) == 4)
+    return _mm_set1_epi32(static_cast<int>(Common::BitCast<u32>(value)));
+  else
+    return _mm_set1_epi64x(static_cast<long long>(Common::BitCast<u64>(value)));
+}
+
+template <typename T>
+__m128i CompareEqual(__m128i a, __m128i b)
+{
+  if constexpr (sizeof(T) == 1)
+    return _mm_cmpeq_epi8(a, b);
+  else if constexpr (sizeof(T) == 2)
+    return _mm_cmpeq_epi16(a, b);
+  else
+    return _mm_cmpeq_epi32(a, b);
+}
+
+template <typename T>
+__m128i CompareGreater(__m128i a, __m128i b)
+{
+  // SSE2 only compares signed integers, unsigned ones are flipped into signed order first
+  if constexpr (std::is_unsigned_v<T>)
+  {
+    const __m128i sign = Broadcast<T>(T(1) << (sizeof(T) * 8 - 1));
+    a = _mm_xor_si128(a, sign);
+    b = _mm_xor_si128(b, sign);
+  }
+
+  if constexpr (sizeof(T) == 1)
+    return _mm_cmpgt_epi8(a, b);
+  else if constexpr (sizeof(T) == 2)
+    return _mm_cmpgt_epi16(a, b);
+  else
+    return _mm_cmpgt_epi32(a, b);
+}
+
+template <typename T, Cheats::CompareType compare_type>
+__m128i CompareVector(__m128i new_values, __m128i old_values)
+{
+  using Cheats::CompareType;
+  if constexpr (std::is_same_v<T, float>)
+  {
+    const __m128 a = _mm_castsi128_ps(new_values);
+    const __m128 b = _mm_castsi128_ps(old_values);
+    if constexpr (compare_type == CompareType::Equal)
+      return _mm_castps_si128(_mm_cmpeq_ps(a, b));
+    else if constexpr (compare_type == CompareType::NotEqual)
+      return _mm_castps_si128(_mm_cmpneq_ps(a, b));
+    else if constexpr (compare_type == CompareType::Less)
+      return _mm_castps_si128(_mm_cmplt_ps(a, b));
+    else if constexpr (compare_type == CompareType::LessOrEqual)
+      return _mm_castps_si128(_mm_cmple_ps(a, b));
+    else if constexpr (compare_type == CompareType::Greater)
+      return _mm_castps_si128(_mm_cmpgt_ps(a, b));
+    else
+      return _mm_castps_si128(_mm_cmpge_ps(a, b));
+  }
+  else if constexpr (std::is_same_v<T, double>)
+  {
+    const __m128d a = _mm_castsi128_pd(new_values);
+    const __m128d b = _mm_castsi128_pd(old_values);
+    if constexpr (compare_type == CompareType::Equal)
+      return _mm_castpd_si128(_mm_cmpeq_pd(a, b));
+    else if constexpr (compare_type == CompareType::NotEqual)
+      return _mm_castpd_si128(_mm_cmpneq_pd(a, b));
+    else if constexpr (compare_type == CompareType::Less)
+      return _mm_castpd_si128(_mm_cmplt_pd(a, b));
+    else if constexpr (compare_type == CompareType::LessOrEqual)
+      return _mm_castpd_si128(_mm_cmple_pd(a, b));
+    else if constexpr (compare_type == CompareType::Greater)
+      return _mm_castpd_si128(_mm_cmpgt_pd(a, b));
+    else
+      return _mm_castpd_si128(_mm_cmpge_pd(a, b));
+  }
+  else
+  {
+    const __m128i all_ones = _mm_set1_epi32(-1);
+    if constexpr (compare_type == CompareType::Equal)
+      return CompareEqual<T>(new_values, old_values);
+    else if constexpr (compare_type == CompareType::NotEqual)
+      return _mm_xor_si128(CompareEqual<T>(new_values, old_values), all_ones);
+    else if constexpr (compare_type == CompareType::Less)
+      return CompareGreater<T>(old_values, new_values);
+    else if constexpr (compare_type == CompareType::LessOrEqual)
+      return _mm_xor_si128(CompareGreater<T>(new_values, old_values), all_ones);
+    else if constexpr (compare_type == CompareType::Greater)
+      return CompareGreater<T>(new_values, old_values);
+    else
+      return _mm_xor_si128(CompareGreater<T>(old_values, new_values), all_ones);
+  }
+}
+
+// Compares 16 positions per step. A vector holds 16 / sizeof(T) values, one every sizeof(T)
+// positions, so an unaligned search loads sizeof(T) overlapping vectors that are each shifted by
+// one byte. movemask yields a bit per byte of which the lowest of each value is kept.
+template <typename T, Cheats::CompareType compare_type, bool against_previous>
+u64 CompareWordSSE(const u8* memory, const u8* previous_memory, __m128i value, bool aligned)
+{
+  constexpr u32 lowest_byte_of_value = static_cast<u32>(AlignedPositions(sizeof(T)) & 0xFFFF);
+  const u32 phases = aligned ? 1 : sizeof(T);
+
+  u64 matches = 0;
+  for (u32 block = 0; block < 64; block += 16)
+  {
+    u32 block_matches = 0;
+    for (u32 phase = 0; phase < phases; ++phase)
+    {
+      const u32 offset = block + phase;
+      const __m128i new_values = SwapBytes<sizeof(T)>(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(memory + offset)));
+      const __m128i old_values =
+          against_previous ?
+              SwapBytes<sizeof(T)>(
+                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous_memory + offset))) :
+              value;
+      const __m128i result = CompareVector<T, compare_type>(new_values, old_values);
+      const u32 mask = static_cast<u32>(_mm_movemask_epi8(result));
+      block_matches |= (mask & lowest_byte_of_value) << phase;
+    }
+    matches |= u64(block_matches) << block;
+  }
+  return matches;
+}
+#endif
+
+// Returns a bit for each of the 64 positions starting at memory that holds a matching value.
+// Bits of positions that can not hold a value are undefined.
+template <typename T, Cheats::CompareType compare_type, bool against_previous>
+class WordComparer
+{
+public:
+  WordComparer(const T& value, bool aligned) : m_value(value), m_aligned(aligned)
+  {
+#ifdef _M_X86_64
+    m_vector = Broadcast(value);
+#endif
+  }
+
+  u64 operator()(const u8* memory, const u8* previous_memory) const
+  {
+#ifdef _M_X86_64
+    // SSE2 has no 64-bit integer comparisons
+    if constexpr (!std::is_integral_v<T> || sizeof(T) <= 4)
+    {
+      return CompareWordSSE<T, compare_type, against_previous>(memory, previous_memory, m_vector,
+                                                                m_aligned);
+    }
+#endif
+    return CompareWordScalar<T, compare_type, against_previous>(memory, previous_memory, m_value,
+                                                                m_aligned);
+  }
+
+private:
+  T m_value;
+  bool m_aligned;
+#ifdef _M_X86_64
+  __m128i m_vector;
+#endif
+};
+}  // namespace
+
+static Cheats::SearchErrorCode CheckSearchPossible(const Core::CPUThreadGuard& guard,
+                                                   PowerPC::RequestedAddressSpace address_space)
 {
 #ifdef USE_RETRO_ACHIEVEMENTS
   if (Config::Get(Config::RA_HARDCORE_ENABLED))
     return Cheats::SearchErrorCode::DisabledInHardcoreMode;
 #endif  // USE_RETRO_ACHIEVEMENTS
-  std::vector<Cheats::SearchResult<T>> results;
   const Core::State core_state = Core::GetState();
   if (core_state != Core::State::Running && core_state != Core::State::Paused)
     return Cheats::SearchErrorCode::NoEmulationActive;
@@ -220,37 +547,352 @@ Cheats::NewSearch(const Core::CPUThreadGuard& guard,
   if (address_space == PowerPC::RequestedAddressSpace::Virtual && !ppc_state.msr.DR)
     return Cheats::SearchErrorCode::VirtualAddressesCurrentlyNotAccessible;
 
-  for (const Cheats::MemoryRange& range : memory_ranges)
+  return Cheats::SearchErrorCode::Success;
+}
+
+template <typename ReadChunk>
+void Cheats::SearchResultBitmap::CaptureRanges(const std::vector<MemoryRange>& memory_ranges,
+                                               u32 value_size, bool aligned, ReadChunk read_chunk)
+{
+  m_ranges.clear();
+  m_results.clear();
+  m_result_rank.clear();
+  m_result_count = 0;
+  m_valid_count = 0;
+  m_value_size = value_size;
+  m_aligned = aligned;
+
+  size_t size = 0;
+  for (const MemoryRange& range : memory_ranges)
   {
-    if (range.m_length < sizeof(T))
+    const u32 length = static_cast<u32>(std::min<u64>(range.m_length, 0x100000000 - range.m_start));
+    if (length < value_size)
       continue;
 
-    const u32 increment_per_loop = aligned ? sizeof(T) : 1;
-    const u32 start_address = aligned ? Common::AlignUp(range.m_start, sizeof(T)) : range.m_start;
-    const u64 aligned_length = range.m_length - (start_address - range.m_start);
+    // Keep the address alignment, so aligned positions can be found with a fixed bit pattern
+    const size_t position = Common::AlignUp(size, 8) + (range.m_start & 7);
+    m_ranges.push_back({range.m_start, length, position});
+    size = position + length;
+  }
 
-    if (aligned_length < sizeof(T))
-      continue;
+  const size_t word_count = Common::AlignUp(size, 64) / 64;
+  m_memory.assign(word_count * 64 + MEMORY_PADDING, 0);
+  m_readable.assign(word_count, 0);
+
+  for (const Range& range : m_ranges)
+  {
+    // Contiguous readable chunks
+    size_t run_begin = range.m_position;
+    size_t run_end = range.m_position;
 
-    const u64 length = aligned_length - (sizeof(T) - 1);
-    for (u64 i = 0; i < length; i += increment_per_loop)
+    const u64 end_address = u64(range.m_start) + range.m_length;
+    for (u64 address = range.m_start; address < end_address;)
     {
-      const u32 addr = start_address + i;
-      const auto current_value = TryReadValueFromEmulatedMemory<T>(guard, addr, address_space);
-      if (!current_value)
+      const u64 chunk_end = std::min(Common::AlignDown(address, COPY_CHUNK_SIZE) + COPY_CHUNK_SIZE,
+                                     end_address);
+      const u32 chunk_size = static_cast<u32>(chunk_end - address);
+      const size_t position = range.m_position + (address - range.m_start);
+
+      if (read_chunk(static_cast<u32>(address), &m_memory[position], chunk_size))
+      {
+        run_end = position + chunk_size;
+      }
+      else
+      {
+        SetReadable(run_begin, run_end, value_size, aligned);
+        run_begin = run_end = position + chunk_size;
+      }
+      address = chunk_end;
+    }
+    SetReadable(run_begin, run_end, value_size, aligned);
+  }
+}
+
+void Cheats::SearchResultBitmap::SetReadable(size_t begin, size_t end, u32 value_size,
+                                             bool aligned)
+{
+  if (end - begin < value_size)
+    return;
+
+  const size_t last = end - value_size;
+  const u64 positions = aligned ? AlignedPositions(value_size) : ~u64(0);
+  for (size_t word = begin / 64; word <= last / 64; ++word)
+  {
+    u64 bits = positions;
+    if (word == begin / 64)
+      bits &= ~u64(0) << (begin % 64);
+    if (word == last / 64)
+      bits &= ~u64(0) >> (63 - last % 64);
+    m_readable[word] |= bits;
+  }
+}
+
+Cheats::SearchErrorCode
+Cheats::SearchResultBitmap::Capture(const Core::CPUThreadGuard& guard,
+                                    const std::vector<MemoryRange>& memory_ranges,
+                                    PowerPC::RequestedAddressSpace address_space, u32 value_size,
+                                    bool aligned)
+{
+  const SearchErrorCode error = CheckSearchPossible(guard, address_space);
+  if (error != SearchErrorCode::Success)
+    return error;
+
+  auto& system = guard.GetSystem();
+  auto& memory = system.GetMemory();
+  auto& mmu = system.GetMMU();
+  m_translated = address_space == PowerPC::RequestedAddressSpace::Virtual ||
+                 (address_space == PowerPC::RequestedAddressSpace::Effective &&
+                  system.GetPPCState().msr.DR);
+
+  CaptureRanges(memory_ranges, value_size, aligned, [&](u32 address, u8* dest, u32 size) {
+    if (!PowerPC::MMU::HostIsRAMAddress(guard, address, address_space))
+      return false;
+
+    std::optional<u32> physical_address = address;
+    if (m_translated)
+      physical_address = mmu.GetTranslatedAddress(address);
+    if (physical_address)
+    {
+      if (const u8* source = GetRAMPointer(memory, *physical_address, size))
+      {
+        std::memcpy(dest, source, size);
+        return true;
+      }
+    }
+
+    // The locked L1 cache and fake VMEM are rare enough to go through the MMU
+    for (u32 i = 0; i < size; ++i)
+    {
+      const auto value = PowerPC::MMU::HostTryReadU8(guard, address + i, address_space);
+      if (!value)
+        return false;
+      dest[i] = value->value;
+    }
+    return true;
+  });
+  return SearchErrorCode::Success;
+}
+
+void Cheats::SearchResultBitmap::Capture(const std::vector<MemoryRange>& memory_ranges,
+                                         const u8* memory, u32 memory_base, u32 memory_size,
+                                         u32 value_size, bool aligned)
+{
+  m_translated = false;
+  CaptureRanges(memory_ranges, value_size, aligned, [&](u32 address, u8* dest, u32 size) {
+    if (address < memory_base || address - memory_base >= memory_size ||
+        size > memory_size - (address - memory_base))
+    {
+      return false;
+    }
+    std::memcpy(dest, memory + (address - memory_base), size);
+    return true;
+  });
+}
+
+
+template <typename T>
+void Cheats::SearchResultBitmap::Filter(const SearchResultBitmap* previous,
+                                        std::optional<CompareType> compare_type,
+                                        const std::optional<T>& value)
+{
+  DEBUG_ASSERT(sizeof(T) == m_value_size);
+  DEBUG_ASSERT(!previous || previous->m_readable.size() == m_readable.size());
+  const std::vector<u64>& candidates = previous ? previous->m_results : m_readable;
+  if (!compare_type)
+  {
+    m_results = candidates;
+    CountResults();
+    return;
+  }
+
+  DEBUG_ASSERT(value || previous);
+  m_results.resize(m_readable.size());
+  DispatchCompareType(*compare_type, [&](auto compare_constant) {
+    constexpr CompareType compare = decltype(compare_constant)::value;
+    if (value)
+      FilterWords<T, compare, false>(previous, *value, m_aligned);
+    else
+      FilterWords<T, compare, true>(previous, T(0), m_aligned);
+  });
+  CountResults();
+}
+
+template <typename T, Cheats::CompareType compare_type, bool against_previous>
+void Cheats::SearchResultBitmap::FilterWords(const SearchResultBitmap* previous, const T& value,
+                                             bool aligned)
+{
+  const WordComparer<T, compare_type, against_previous> compare(value, aligned);
+  const u8* const previous_memory = previous ? previous->m_memory.data() : nullptr;
+  ParallelForWords(m_results.size(), [&](size_t begin, size_t end) {
+    for (size_t word = begin; word < end; ++word)
+    {
+      const u64 candidates = previous ? previous->m_results[word] : m_readable[word];
+      if (candidates == 0)
+      {
+        m_results[word] = 0;
         continue;
+      }
 
-      if (validator(current_value->value))
+      const size_t position = word * 64;
+      const u64 matches = compare(&m_memory[position],
+                                  previous_memory ? previous_memory + position : nullptr);
+      if (previous)
+      {
+        // Like NextSearch, results that can not be compared are kept. They show up as
+        // inaccessible, or get a fresh value that the next search can compare against.
+        const u64 comparable = m_readable[word] & previous->m_readable[word];
+        m_results[word] = candidates & (~comparable | matches);
+      }
+      else
       {
-        auto& r = results.emplace_back();
-        r.m_value = current_value->value;
-        r.m_value_state = current_value->translated ?
-                              Cheats::SearchResultValueState::ValueFromVirtualMemory :
-                              Cheats::SearchResultValueState::ValueFromPhysicalMemory;
-        r.m_address = addr;
+        m_results[word] = candidates & matches;
       }
     }
+  });
+}
+
+void Cheats::SearchResultBitmap::CountResults()
+{
+  m_result_rank.resize(m_results.size());
+  size_t result_count = 0;
+  size_t valid_count = 0;
+  for (size_t word = 0; word < m_results.size(); ++word)
+  {
+    m_result_rank[word] = static_cast<u32>(result_count);
+    result_count += std::popcount(m_results[word]);
+    valid_count += std::popcount(m_results[word] & m_readable[word]);
   }
+  m_result_count = result_count;
+  m_valid_count = valid_count;
+}
+
+size_t Cheats::SearchResultBitmap::GetMemoryUsage() const
+{
+  return m_memory.size() + (m_readable.size() + m_results.size()) * sizeof(u64) +
+         m_result_rank.size() * sizeof(u32) + m_ranges.size() * sizeof(Range);
+}
+
+size_t Cheats::SearchResultBitmap::GetResultPosition(size_t index) const
+{
+  DEBUG_ASSERT(index < m_result_count);
+  const size_t word =
+      std::upper_bound(m_result_rank.begin(), m_result_rank.end(), index) - m_result_rank.begin() -
+      1;
+  u64 bits = m_results[word];
+  for (size_t i = m_result_rank[word]; i < index; ++i)
+    bits &= bits - 1;
+  return word * 64 + std::countr_zero(bits);
+}
+
+u32 Cheats::SearchResultBitmap::GetAddress(size_t position) const
+{
+  const auto range =
+      std::upper_bound(m_ranges.begin(), m_ranges.end(), position,
+                       [](size_t p, const Range& r) { return p < r.m_position; }) -
+      1;
+  return range->m_start + static_cast<u32>(position - range->m_position);
+}
+
+Cheats::SearchResultValueState Cheats::SearchResultBitmap::GetValueState(size_t position) const
+{
+  if (!((m_readable[position / 64] >> (position % 64)) & 1))
+    return SearchResultValueState::AddressNotAccessible;
+  return m_translated ? SearchResultValueState::ValueFromVirtualMemory :
+                        SearchResultValueState::ValueFromPhysicalMemory;
+}
+
+template <typename T>
+std::vector<Cheats::SearchResult<T>> Cheats::SearchResultBitmap::ToList(size_t begin_index,
+                                                                        size_t end_index) const
+{
+  std::vector<SearchResult<T>> results;
+  results.reserve(end_index - begin_index);
+  ForEachResult(begin_index, end_index, [&](size_t position) {
+    auto& r = results.emplace_back();
+    r.m_address = GetAddress(position);
+    r.m_value_state = GetValueState(position);
+    if (r.IsValueValid())
+      r.m_value = GetValue<T>(position);
+  });
+  return results;
+}
+
+template void Cheats::SearchResultBitmap::Filter<u8>(const SearchResultBitmap*,
+                                                      std::optional<CompareType>,
+                                                      const std::optional<u8>&);
+template void Cheats::SearchResultBitmap::Filter<u16>(const SearchResultBitmap*,
+                                                      std::optional<CompareType>,
+                                                      const std::optional<u16>&);
+template void Cheats::SearchResultBitmap::Filter<u32>(const SearchResultBitmap*,
+                                                      std::optional<CompareType>,
+                                                      const std::optional<u32>&);
+template void Cheats::SearchResultBitmap::Filter<u64>(const SearchResultBitmap*,
+                                                      std::optional<CompareType>,
+                                                      const std::optional<u64>&);
+template void Cheats::SearchResultBitmap::Filter<s8>(const SearchResultBitmap*,
+                                                      std::optional<CompareType>,
+                                                      const std::optional<s8>&);
+template void Cheats::SearchResultBitmap::Filter<s16>(const SearchResultBitmap*,
+                                                      std::optional<CompareType>,
+                                                      const std::optional<s16>&);
+template void Cheats::SearchResultBitmap::Filter<s32>(const SearchResultBitmap*,
+                                                      std::optional<CompareType>,
+                                                      const std::optional<s32>&);
+template void Cheats::SearchResultBitmap::Filter<s64>(const SearchResultBitmap*,
+                                                      std::optional<CompareType>,
+                                                      const std::optional<s64>&);
+template void Cheats::SearchResultBitmap::Filter<float>(const SearchResultBitmap*,
+                                                      std::optional<CompareType>,
+                                                      const std::optional<float>&);
+template void Cheats::SearchResultBitmap::Filter<double>(const SearchResultBitmap*,
+                                                      std::optional<CompareType>,
+                                                      const std::optional<double>&);
+template std::vector<Cheats::SearchResult<u8>>
+Cheats::SearchResultBitmap::ToList<u8>(size_t, size_t) const;
+template std::vector<Cheats::SearchResult<u16>>
+Cheats::SearchResultBitmap::ToList<u16>(size_t, size_t) const;
+template std::vector<Cheats::SearchResult<u32>>
+Cheats::SearchResultBitmap::ToList<u32>(size_t, size_t) const;
+template std::vector<Cheats::SearchResult<u64>>
+Cheats::SearchResultBitmap::ToList<u64>(size_t, size_t) const;
+template std::vector<Cheats::SearchResult<s8>>
+Cheats::SearchResultBitmap::ToList<s8>(size_t, size_t) const;
+template std::vector<Cheats::SearchResult<s16>>
+Cheats::SearchResultBitmap::ToList<s16>(size_t, size_t) const;
+template std::vector<Cheats::SearchResult<s32>>
+Cheats::SearchResultBitmap::ToList<s32>(size_t, size_t) const;
+template std::vector<Cheats::SearchResult<s64>>
+Cheats::SearchResultBitmap::ToList<s64>(size_t, size_t) const;
+template std::vector<Cheats::SearchResult<float>>
+Cheats::SearchResultBitmap::ToList<float>(size_t, size_t) const;
+template std::vector<Cheats::SearchResult<double>>
+Cheats::SearchResultBitmap::ToList<double>(size_t, size_t) const;
+
+template <typename T>
+Common::Result<Cheats::SearchErrorCode, std::vector<Cheats::SearchResult<T>>>
+Cheats::NewSearch(const Core::CPUThreadGuard& guard,
+                  const std::vector<Cheats::MemoryRange>& memory_ranges,
+                  PowerPC::RequestedAddressSpace address_space, bool aligned,
+                  const std::function<bool(const T& value)>& validator)
+{
+  Cheats::SearchResultBitmap bitmap;
+  const Cheats::SearchErrorCode error =
+      bitmap.Capture(guard, memory_ranges, address_space, sizeof(T), aligned);
+  if (error != Cheats::SearchErrorCode::Success)
+    return error;
+  bitmap.Filter<T>(nullptr, std::nullopt, std::nullopt);
+
+  std::vector<Cheats::SearchResult<T>> results;
+  bitmap.ForEachResult(0, bitmap.GetResultCount(), [&](size_t position) {
+    const T value = bitmap.GetValue<T>(position);
+    if (validator(value))
+    {
+      auto& r = results.emplace_back();
+      r.m_value = value;
+      r.m_value_state = bitmap.GetValueState(position);
+      r.m_address = bitmap.GetAddress(position);
+    }
+  });
   return results;
 }
 
@@ -261,18 +903,11 @@ Cheats::NextSearch(const Core::CPUThreadGuard& guard,
                    PowerPC::RequestedAddressSpace address_space,
                    const std::function<bool(const T& new_value, const T& old_value)>& validator)
 {
-#ifdef USE_RETRO_ACHIEVEMENTS
-  if (Config::Get(Config::RA_HARDCORE_ENABLED))
-    return Cheats::SearchErrorCode::DisabledInHardcoreMode;
-#endif  // USE_RETRO_ACHIEVEMENTS
-  std::vector<Cheats::SearchResult<T>> results;
-  const Core::State core_state = Core::GetState();
-  if (core_state != Core::State::Running && core_state != Core::State::Paused)
-    return Cheats::SearchErrorCode::NoEmulationActive;
+  const Cheats::SearchErrorCode error = CheckSearchPossible(guard, address_space);
+  if (error != Cheats::SearchErrorCode::Success)
+    return error;
 
-  const auto& ppc_state = guard.GetSystem().GetPPCState();
-  if (address_space == PowerPC::RequestedAddressSpace::Virtual && !ppc_state.msr.DR)
-    return Cheats::SearchErrorCode::VirtualAddressesCurrentlyNotAccessible;
+  std::vector<Cheats::SearchResult<T>> results;
 
   for (const auto& previous_result : previous_results)
   {
@@ -373,6 +1008,7 @@ template <typename T>
 void Cheats::CheatSearchSession<T>::ResetResults()
 {
   m_first_search_done = false;
+  m_result_bitmap.reset();
   m_search_results.clear();
 }
 
@@ -431,55 +1067,66 @@ Cheats::SearchErrorCode Cheats::CheatSearchSession<T>::RunSearch(const Core::CPU
   if (Config::Get(Config::RA_HARDCORE_ENABLED))
     return Cheats::SearchErrorCode::DisabledInHardcoreMode;
 #endif  // USE_RETRO_ACHIEVEMENTS
-  Common::Result<SearchErrorCode, std::vector<SearchResult<T>>> result =
-      Cheats::SearchErrorCode::InvalidParameters;
-  if (m_filter_type == FilterType::CompareAgainstSpecificValue)
-  {
-    if (!m_value)
-      return Cheats::SearchErrorCode::InvalidParameters;
+  if (m_filter_type == FilterType::CompareAgainstSpecificValue && !m_value)
+    return Cheats::SearchErrorCode::InvalidParameters;
+  if (m_filter_type == FilterType::CompareAgainstLastValue && !m_first_search_done)
+    return Cheats::SearchErrorCode::InvalidParameters;
 
-    auto func = MakeCompareFunctionForSpecificValue<T>(m_compare_type, *m_value);
-    if (m_first_search_done)
+  if (m_first_search_done && !m_result_bitmap)
+  {
+    // Few enough results are left that reading them one by one beats copying all ranges
+    Common::Result<SearchErrorCode, std::vector<SearchResult<T>>> result =
+        Cheats::SearchErrorCode::InvalidParameters;
+    if (m_filter_type == FilterType::CompareAgainstSpecificValue)
     {
+      auto func = MakeCompareFunctionForSpecificValue<T>(m_compare_type, *m_value);
       result = Cheats::NextSearch<T>(
           guard, m_search_results, m_address_space,
           [&func](const T& new_value, const T& old_value) { return func(new_value); });
     }
-    else
+    else if (m_filter_type == FilterType::CompareAgainstLastValue)
     {
-      result = Cheats::NewSearch<T>(guard, m_memory_ranges, m_address_space, m_aligned, func);
+      result = Cheats::NextSearch<T>(guard, m_search_results, m_address_space,
+                                     MakeCompareFunctionForLastValue<T>(m_compare_type));
     }
-  }
-  else if (m_filter_type == FilterType::CompareAgainstLastValue)
-  {
-    if (!m_first_search_done)
-      return Cheats::SearchErrorCode::InvalidParameters;
-
-    result = Cheats::NextSearch<T>(guard, m_search_results, m_address_space,
-                                   MakeCompareFunctionForLastValue<T>(m_compare_type));
-  }
-  else if (m_filter_type == FilterType::DoNotFilter)
-  {
-    if (m_first_search_done)
+    else if (m_filter_type == FilterType::DoNotFilter)
     {
       result = Cheats::NextSearch<T>(guard, m_search_results, m_address_space,
                                      [](const T& v1, const T& v2) { return true; });
     }
-    else
-    {
-      result = Cheats::NewSearch<T>(guard, m_memory_ranges, m_address_space, m_aligned,
-                                    [](const T& v) { return true; });
-    }
-  }
 
-  if (result.Succeeded())
-  {
+    if (!result.Succeeded())
+      return result.Error();
     m_search_results = std::move(*result);
-    m_first_search_done = true;
     return Cheats::SearchErrorCode::Success;
   }
 
-  return result.Error();
+  SearchResultBitmap bitmap;
+  const SearchErrorCode error =
+      bitmap.Capture(guard, m_memory_ranges, m_address_space, sizeof(T), m_aligned);
+  if (error != Cheats::SearchErrorCode::Success)
+    return error;
+
+  std::optional<CompareType> compare_type;
+  if (m_filter_type != FilterType::DoNotFilter)
+    compare_type = m_compare_type;
+  std::optional<T> value;
+  if (m_filter_type == FilterType::CompareAgainstSpecificValue)
+    value = m_value;
+  bitmap.Filter<T>(m_result_bitmap ? &*m_result_bitmap : nullptr, compare_type, value);
+  m_first_search_done = true;
+
+  if (bitmap.GetResultCount() * sizeof(SearchResult<T>) < bitmap.GetMemoryUsage())
+  {
+    m_search_results = bitmap.ToList<T>(0, bitmap.GetResultCount());
+    m_result_bitmap.reset();
+  }
+  else
+  {
+    m_search_results.clear();
+    m_result_bitmap = std::move(bitmap);
+  }
+  return Cheats::SearchErrorCode::Success;
 }
 
 template <typename T>
@@ -527,12 +1174,17 @@ bool Cheats::CheatSearchSession<T>::IsFloatingType() const
 template <typename T>
 size_t Cheats::CheatSearchSession<T>::GetResultCount() const
 {
+  if (m_result_bitmap)
+    return m_result_bitmap->GetResultCount();
   return m_search_results.size();
 }
 
 template <typename T>
 size_t Cheats::CheatSearchSession<T>::GetValidValueCount() const
 {
+  if (m_result_bitmap)
+    return m_result_bitmap->GetValidValueCount();
+
   const auto& results = m_search_results;
   size_t count = 0;
   for (const auto& r : results)
@@ -546,19 +1198,31 @@ size_t Cheats::CheatSearchSession<T>::GetValidValueCount() const
 template <typename T>
 u32 Cheats::CheatSearchSession<T>::GetResultAddress(size_t index) const
 {
+  if (m_result_bitmap)
+    return m_result_bitmap->GetAddress(m_result_bitmap->GetResultPosition(index));
   return m_search_results[index].m_address;
 }
 
 template <typename T>
 T Cheats::CheatSearchSession<T>::GetResultValue(size_t index) const
 {
+  if (m_result_bitmap)
+  {
+    const size_t position = m_result_bitmap->GetResultPosition(index);
+    if (m_result_bitmap->GetValueState(position) ==
+        Cheats::SearchResultValueState::AddressNotAccessible)
+    {
+      return T();
+    }
+    return m_result_bitmap->GetValue<T>(position);
+  }
   return m_search_results[index].m_value;
 }
 
 template <typename T>
 Cheats::SearchValue Cheats::CheatSearchSession<T>::GetResultValueAsSearchValue(size_t index) const
 {
-  return Cheats::SearchValue{m_search_results[index].m_value};
+  return Cheats::SearchValue{GetResultValue(index)};
 }
 
 template <typename T>
@@ -567,23 +1231,26 @@ std::string Cheats::CheatSearchSession<T>::GetResultValueAsString(size_t index,
   if (GetResultValueState(index) == Cheats::SearchResultValueState::AddressNotAccessible)
     return "(inaccessible)";
 
+  const T value = GetResultValue(index);
   if (hex)
   {
     if constexpr (std::is_same_v<T, float>)
-      return fmt::format("0x{0:08x}", Common::BitCast<u32>(m_search_results[index].m_value));
+      return fmt::format("0x{0:08x}", Common::BitCast<u32>(value));
     else if constexpr (std::is_same_v<T, double>)
-      return fmt::format("0x{0:016x}", Common::BitCast<u64>(m_search_results[index].m_value));
+      return fmt::format("0x{0:016x}", Common::BitCast<u64>(value));
     else
-      return fmt::format("0x{0:0{1}x}", m_search_results[index].m_value, sizeof(T) * 2);
+      return fmt::format("0x{0:0{1}x}", value, sizeof(T) * 2);
   }
 
-  return fmt::format("{}", m_search_results[index].m_value);
+  return fmt::format("{}", value);
 }
 
 template <typename T>
 Cheats::SearchResultValueState
 Cheats::CheatSearchSession<T>::GetResultValueState(size_t index) const
 {
+  if (m_result_bitmap)
+    return m_result_bitmap->GetValueState(m_result_bitmap->GetResultPosition(index));
   return m_search_results[index].m_value_state;
 }
 
@@ -603,13 +1270,20 @@ template <typename T>
 std::unique_ptr<Cheats::CheatSearchSessionBase>
 Cheats::CheatSearchSession<T>::ClonePartial(const size_t begin_index, const size_t end_index) const
 {
-  if (begin_index == 0 && end_index >= m_search_results.size())
+  if (begin_index == 0 && end_index >= GetResultCount())
     return Clone();
 
   auto c =
       std::make_unique<Cheats::CheatSearchSession<T>>(m_memory_ranges, m_address_space, m_aligned);
-  c->m_search_results.assign(m_search_results.begin() + begin_index,
-                             m_search_results.begin() + end_index);
+  if (m_result_bitmap)
+  {
+    c->m_search_results = m_result_bitmap->ToList<T>(begin_index, end_index);
+  }
+  else
+  {
+    c->m_search_results.assign(m_search_results.begin() + begin_index,
+                               m_search_results.begin() + end_index);
+  }
   c->m_compare_type = this->m_compare_type;
   c->m_filter_type = this->m_filter_type;
   c->m_value = this->m_value;
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <bit>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -12,6 +14,7 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/Result.h"
+#include "Common/Swap.h"
 #include "Core/PowerPC/MMU.h"
 
 namespace Core
@@ -106,6 +109,106 @@ enum class SearchErrorCode
 #endif  // USE_RETRO_ACHIEVEMENTS
 };
 
+// Results of a search, kept as a bitmap over a copy of the searched memory.
+//
+// The searched ranges are copied out of emulated memory once per search, on the CPU thread. The
+// values are then compared on worker threads with SIMD kernels, straight from the copy. Every
+// byte of the copy has a bit that is set if a value starting there is a result, and another
+// that is set if a value starting there could be read. Values are read back from the copy, so
+// the size of the results does not depend on how many there are.
+class SearchResultBitmap
+{
+public:
+  // Copies the given ranges out of emulated memory. A position is readable if a value_size byte
+  // value starting there lies in RAM (and is aligned to value_size if aligned is set).
+  SearchErrorCode Capture(const Core::CPUThreadGuard& guard,
+                          const std::vector<MemoryRange>& memory_ranges,
+                          PowerPC::RequestedAddressSpace address_space, u32 value_size,
+                          bool aligned);
+  // Same as above, but copies from host memory that is mapped at memory_base.
+  void Capture(const std::vector<MemoryRange>& memory_ranges, const u8* memory, u32 memory_base,
+               u32 memory_size, u32 value_size, bool aligned);
+
+  // Flags the results of a search on the captured memory. Without previous results every
+  // readable position is a candidate, otherwise only the previous results are, and those that
+  // are not readable in either copy are kept as they are. Candidates are compared against value,
+  // or against their previous value if value is not set. Without a compare type every candidate
+  // is a result.
+  template <typename T>
+  void Filter(const SearchResultBitmap* previous, std::optional<CompareType> compare_type,
+              const std::optional<T>& value);
+
+  size_t GetResultCount() const { return m_result_count; }
+  size_t GetValidValueCount() const { return m_valid_count; }
+  // Bytes held by the copy and the bitmaps
+  size_t GetMemoryUsage() const;
+
+  // Position in the copy of the result with the given index
+  size_t GetResultPosition(size_t index) const;
+  u32 GetAddress(size_t position) const;
+  SearchResultValueState GetValueState(size_t position) const;
+  template <typename T>
+  T GetValue(size_t position) const
+  {
+    T value;
+    std::memcpy(&value, &m_memory[position], sizeof(T));
+    return Common::FromBigEndian(value);
+  }
+
+  // Calls func with the position of each result with an index in [begin_index, end_index)
+  template <typename Func>
+  void ForEachResult(size_t begin_index, size_t end_index, Func func) const
+  {
+    if (begin_index >= end_index)
+      return;
+
+    size_t position = GetResultPosition(begin_index);
+    size_t word = position / 64;
+    u64 bits = m_results[word] & (~u64(0) << (position % 64));
+    for (size_t index = begin_index; index < end_index; ++index)
+    {
+      while (bits == 0)
+        bits = m_results[++word];
+      func(word * 64 + std::countr_zero(bits));
+      bits &= bits - 1;
+    }
+  }
+
+  // Results with an index in [begin_index, end_index) as a plain list
+  template <typename T>
+  std::vector<SearchResult<T>> ToList(size_t begin_index, size_t end_index) const;
+
+private:
+  struct Range
+  {
+    u32 m_start;
+    u32 m_length;
+    size_t m_position;
+  };
+
+  template <typename ReadChunk>
+  void CaptureRanges(const std::vector<MemoryRange>& memory_ranges, u32 value_size, bool aligned,
+                     ReadChunk read_chunk);
+  void SetReadable(size_t begin, size_t end, u32 value_size, bool aligned);
+  template <typename T, CompareType compare_type, bool against_previous>
+  void FilterWords(const SearchResultBitmap* previous, const T& value, bool aligned);
+  void CountResults();
+
+  std::vector<Range> m_ranges;
+  // Captured memory in big endian byte order, one range after the other. Every range starts at
+  // a position with the same alignment as its address
+  std::vector<u8> m_memory;
+  std::vector<u64> m_readable;
+  std::vector<u64> m_results;
+  // Number of results before each word of m_results
+  std::vector<u32> m_result_rank;
+  size_t m_result_count = 0;
+  size_t m_valid_count = 0;
+  u32 m_value_size = 1;
+  bool m_aligned = false;
+  bool m_translated = false;
+};
+
 // Returns the corresponding DataType enum for the value currently held by the given SearchValue.
 DataType GetDataType(const SearchValue& value);
 
@@ -219,6 +322,9 @@ public:
                                                        size_t end_index) const override;
 
 private:
+  // Once there are few enough results for a list of them to be smaller than the bitmap, the
+  // bitmap is dropped and m_search_results is used instead
+  std::optional<SearchResultBitmap> m_result_bitmap;
   std::vector<SearchResult<T>> m_search_results;
   std::vector<MemoryRange> m_memory_ranges;
   PowerPC::RequestedAddressSpace m_address_space;
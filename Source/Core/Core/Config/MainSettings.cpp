@@ -242,6 +242,11 @@ const Info<DiscIO::Region> MAIN_FALLBACK_REGION{{System::Main, "Core", "Fallback
 const Info<bool> MAIN_AUTO_DISC_CHANGE{{System::Main, "Core", "AutoDiscChange"}, false};
 const Info<bool> MAIN_ALLOW_SD_WRITES{{System::Main, "Core", "WiiSDCardAllowWrites"}, true};
 const Info<bool> MAIN_ENABLE_SAVESTATES{{System::Main, "Core", "EnableSaveStates"}, false};
+// Only run the stat tracker when one of the values it waits on changes, instead of every frame
+const Info<bool> MAIN_STAT_TRACKER_EVENT_DRIVEN{{System::Main, "Core", "StatTrackerEventDriven"},
+                                                false};
+// Also rewrite decoded.hud.json on every HUD update, for overlays that don't read hud.stream yet
+const Info<bool> MAIN_STAT_TRACKER_HUD_FILE{{System::Main, "Core", "StatTrackerHUDFile"}, false};
 const Info<bool> MAIN_REAL_WII_REMOTE_REPEAT_REPORTS{
     {System::Main, "Core", "RealWiiRemoteRepeatReports"}, true};
 const Info<bool> MAIN_WII_WIILINK_ENABLE{{System::Main, "Core", "EnableWiiLink"}, false};
@@ -45,6 +45,21 @@ const Info<u32> NETPLAY_CHUNKED_UPLOAD_LIMIT{{System::Main, "NetPlay", "ChunkedU
 
 const Info<u32> NETPLAY_BUFFER_SIZE{{System::Main, "NetPlay", "BufferSize"}, 8};
 const Info<u32> NETPLAY_CLIENT_BUFFER_SIZE{{System::Main, "NetPlay", "BufferSizeClient"}, 8};
+const Info<bool> NETPLAY_AUTO_BUFFER{{System::Main, "NetPlay", "AutoBuffer"}, false};
+const Info<u32> NETPLAY_ROLLBACK_FRAMES{{System::Main, "NetPlay", "RollbackFrames"}, 8};
+const Info<u32> NETPLAY_ROLLBACK_BUDGET_US{{System::Main, "NetPlay", "RollbackBudgetUs"}, 4000};
+const Info<bool> NETPLAY_REDUNDANT_INPUTS{{System::Main, "NetPlay", "RedundantInputs"}, false};
+// Where Mario Superstar Baseball keeps the game, the players and the ball
+const Info<std::string> NETPLAY_DESYNC_REGIONS{{System::Main, "NetPlay", "DesyncRegions"},
+                                               "802E0000-80400000,804E0000-80500000,"
+                                               "80870000-808A0000"};
+const Info<std::string> NETPLAY_BROADCAST_RELAY{{System::Main, "NetPlay", "BroadcastRelay"}, ""};
+const Info<std::string> NETPLAY_BROADCAST_KEY{{System::Main, "NetPlay", "BroadcastKey"}, ""};
+const Info<std::string> NETPLAY_BROADCAST_SPECTATOR_KEY{
+    {System::Main, "NetPlay", "BroadcastSpectatorKey"}, ""};
+const Info<u32> NETPLAY_BROADCAST_DELAY{{System::Main, "NetPlay", "BroadcastDelay"}, 0};
+const Info<u32> NETPLAY_BROADCAST_KEYFRAME_INTERVAL{
+    {System::Main, "NetPlay", "BroadcastKeyframeInterval"}, 20};
 
 const Info<bool> NETPLAY_SAVEDATA_LOAD{{System::Main, "NetPlay", "SyncSaves"}, true};
 const Info<bool> NETPLAY_SAVEDATA_WRITE{{System::Main, "NetPlay", "WriteSaveData"}, true};
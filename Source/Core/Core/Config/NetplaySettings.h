@@ -41,6 +41,27 @@ extern const Info<u32> NETPLAY_CHUNKED_UPLOAD_LIMIT;
 
 extern const Info<u32> NETPLAY_BUFFER_SIZE;
 extern const Info<u32> NETPLAY_CLIENT_BUFFER_SIZE;
+// Whether the host picks the buffer from the pings of the players during games
+extern const Info<bool> NETPLAY_AUTO_BUFFER;
+// How many frames of remote inputs rollback may predict, sent by the host
+extern const Info<u32> NETPLAY_ROLLBACK_FRAMES;
+// Time per frame that rollback may spend saving and loading states, local to each player
+extern const Info<u32> NETPLAY_ROLLBACK_BUDGET_US;
+// Whether every input packet repeats the inputs that were not acknowledged, sent by the host
+extern const Info<bool> NETPLAY_REDUNDANT_INPUTS;
+// Ranges of memory hashed for finding desyncs, sent by the host
+extern const Info<std::string> NETPLAY_DESYNC_REGIONS;
+// Relay that hosts broadcast their games to, as "host:port". Off if empty.
+extern const Info<std::string> NETPLAY_BROADCAST_RELAY;
+// The key the relay was started with, which it needs from the host
+extern const Info<std::string> NETPLAY_BROADCAST_KEY;
+// On the host, what spectators need to watch its broadcast, anyone may if empty. On a spectator,
+// what it sends the relay.
+extern const Info<std::string> NETPLAY_BROADCAST_SPECTATOR_KEY;
+// Seconds that spectators of a broadcast are behind the players
+extern const Info<u32> NETPLAY_BROADCAST_DELAY;
+// Least seconds between two keyframes for spectators that join during a game
+extern const Info<u32> NETPLAY_BROADCAST_KEYFRAME_INTERVAL;
 
 extern const Info<bool> NETPLAY_SAVEDATA_LOAD;
 extern const Info<bool> NETPLAY_SAVEDATA_WRITE;
@@ -17,4 +17,5 @@ const Info<bool> SESSION_CODE_SYNC_OVERRIDE{{System::Session, "Core", "CheatSync
 const Info<bool> SESSION_SAVE_DATA_WRITABLE{{System::Session, "Core", "SaveDataWritable"}, true};
 const Info<bool> SESSION_SHOULD_FAKE_ERROR_001{{System::Session, "Core", "ShouldFakeError001"},
                                                false};
+const Info<bool> SESSION_INCREMENTAL_STATES{{System::Session, "Core", "IncrementalStates"}, false};
 }  // namespace Config
@@ -14,4 +14,6 @@ extern const Info<bool> SESSION_GCI_FOLDER_CURRENT_GAME_ONLY;
 extern const Info<bool> SESSION_CODE_SYNC_OVERRIDE;
 extern const Info<bool> SESSION_SAVE_DATA_WRITABLE;
 extern const Info<bool> SESSION_SHOULD_FAKE_ERROR_001;
+// Puts GameCube ARAM in the memory segment, so that State::IncrementalStates can track it
+extern const Info<bool> SESSION_INCREMENTAL_STATES;
 }  // namespace Config
@@ -42,6 +42,7 @@ public:
       layer->Set(Config::GetInfoForEXIDevice(slot), m_settings.exi_device[slot]);
     layer->Set(Config::MAIN_MEMORY_CARD_SIZE, m_settings.memcard_size_override);
     layer->Set(Config::SESSION_SAVE_DATA_WRITABLE, m_settings.savedata_write);
+    layer->Set(Config::SESSION_INCREMENTAL_STATES, m_settings.rollback_frames != 0);
     layer->Set(Config::MAIN_RAM_OVERRIDE_ENABLE, m_settings.ram_override_enable);
     layer->Set(Config::MAIN_MEM1_SIZE, m_settings.mem1_size);
     layer->Set(Config::MAIN_MEM2_SIZE, m_settings.mem2_size);
@@ -142,6 +142,39 @@ static std::unique_ptr<MemoryWatcher> s_memory_watcher;
 #endif
 
 static std::unique_ptr<StatTracker> s_stat_tracker;
+static StatTracker::Mode s_stat_tracker_mode = StatTracker::Mode::Online;
+
+static StatTracker::Mode GetStatTrackerMode()
+{
+  // A game replayed from a movie was submitted when it was played, so only its files are written.
+  // Neither are the games of a rollback session, whose stats include mispredicted frames.
+  const bool replay = System::GetInstance().GetMovie().IsPlayingInput();
+  return replay || NetPlay::IsRollbackEnabled() ? StatTracker::Mode::NoSubmit :
+                                                  StatTracker::Mode::Online;
+}
+
+static void CreateStatTracker()
+{
+  s_stat_tracker_mode = GetStatTrackerMode();
+  s_stat_tracker = std::make_unique<StatTracker>(s_stat_tracker_mode);
+  s_stat_tracker->init();
+}
+
+// Replays and live games can follow each other in one session, so the mode is checked on every
+// boot. A new tracker gets what was set on the old one before the game started.
+static void UpdateStatTracker()
+{
+  if (s_stat_tracker && s_stat_tracker_mode == GetStatTrackerMode())
+    return;
+
+  CreateStatTracker();
+  if (tagset_local)
+    s_stat_tracker->setTagSetId(*tagset_local, false);
+  if (tagset_netplay)
+    s_stat_tracker->setTagSetId(*tagset_netplay, true);
+  if (NetPlay::IsNetPlayRunning())
+    s_stat_tracker->setNetplayerUserInfo(NetPlay::NetPlayClient::getNetplayerUserInfo());
+}
 
 struct HostJob
 {
@@ -226,6 +259,17 @@ void RunRioFunctions(const Core::CPUThreadGuard& guard)
   auto& system = Core::System::GetInstance();
   u64 frame = system.GetMovie().GetCurrentFrame();
 
+  // Hash a slice of the game state for desync detection. Frames a rollback simulates again are
+  // hashed again, replacing what was read on the mispredicted ones.
+  if (mGameBeingPlayed == GameName::MarioBaseball && NetPlay::IsNetPlayRunning())
+    NetPlay::NetPlayClient::HashDesyncState(guard, frame);
+
+  // The stats, timers and overlays have already seen the frames a rollback simulates again.
+  // Running them again would count those frames twice. As the stats keep what they saw on
+  // mispredicted frames, rollback games are never submitted.
+  if (NetPlay::IsResimulating())
+    return;
+
   if (mGameBeingPlayed == GameName::MarioBaseball)
   {
     s_stat_tracker->Run(guard);
@@ -237,13 +281,6 @@ void RunRioFunctions(const Core::CPUThreadGuard& guard)
 
     if (NetPlay::IsNetPlayRunning())
     {
-      // send checksum for desync detection
-      if (frame % 60)
-      {
-        u8 checksumId = (frame / 60) & 0xF;
-        u32 checksum = PowerPC::MMU::HostRead_U32(guard, 0x802EBFB8);
-        NetPlay::NetPlayClient::SendChecksum(checksumId, frame, checksum);
-      }
       if (runNetplayGameFunctions)
       {
         SetNetplayerUserInfo();
@@ -779,8 +816,7 @@ void SetNetplayerUserInfo()
     s_stat_tracker->setNetplayerUserInfo(NetPlay::NetPlayClient::getNetplayerUserInfo());
   }
   else {
-    s_stat_tracker = std::make_unique<StatTracker>();
-    s_stat_tracker->init();
+    CreateStatTracker();
     s_stat_tracker->setNetplayerUserInfo(NetPlay::NetPlayClient::getNetplayerUserInfo());
   }
 }
@@ -1018,11 +1054,7 @@ static void CpuThread(Core::System& system, const std::optional<std::string>& sa
   s_memory_watcher = std::make_unique<MemoryWatcher>();
 #endif
 
-  if (!s_stat_tracker) {
-    s_stat_tracker = std::make_unique<StatTracker>();
-    s_stat_tracker->init();
-    std::cout << "Init stat tracker" << std::endl;
-  }
+  UpdateStatTracker();
 
   if (savestate_path)
   {
@@ -1753,8 +1785,7 @@ void SetGameID(u32 gameID)
 {
   if (!s_stat_tracker)
   {
-    s_stat_tracker = std::make_unique<StatTracker>();
-    s_stat_tracker->init();
+    CreateStatTracker();
   }
 
   s_stat_tracker->setGameID(gameID);
@@ -1774,8 +1805,7 @@ void SetTagSet(std::optional<TagSet> tagset, bool netplay)
 
   if (!s_stat_tracker)
   {
-    s_stat_tracker = std::make_unique<StatTracker>();
-    s_stat_tracker->init();
+    CreateStatTracker();
   }
 
   if (tagset.has_value())
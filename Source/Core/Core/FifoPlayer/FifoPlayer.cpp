@@ -231,6 +231,7 @@ public:
     m_parent->m_system.GetCPU().EnableStepping(false);
 
     m_parent->m_CurrentFrame = m_parent->m_FrameRangeStart;
+    m_parent->m_LoopsPlayed = 0;
     m_parent->LoadMemory();
   }
 
@@ -279,7 +280,8 @@ CPU::State FifoPlayer::AdvanceFrame()
 {
   if (m_CurrentFrame > m_FrameRangeEnd)
   {
-    if (!m_Loop)
+    ++m_LoopsPlayed;
+    if (m_LoopCount != 0 ? m_LoopsPlayed >= m_LoopCount : !m_Loop)
       return CPU::State::PowerDown;
 
     // When looping, reload the contents of all the BP/CP/CF registers.
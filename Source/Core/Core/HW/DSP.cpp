@@ -29,7 +29,6 @@
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
-#include "Common/MemoryUtil.h"
 
 #include "Core/CoreTiming.h"
 #include "Core/DSPEmulator.h"
@@ -78,7 +77,7 @@ constexpr int DSP_MAIL_SLICE = 72;
 
 void DSPManager::DoState(PointerWrap& p)
 {
-  if (!m_aram.wii_mode)
+  if (!m_aram.wii_mode && !p.IsMemoryExcluded())
     p.DoArray(m_aram.ptr, m_aram.size);
   p.Do(m_dsp_control);
   p.Do(m_audio_dma);
@@ -135,7 +134,7 @@ void DSPManager::Reinit(bool hle)
     m_aram.wii_mode = false;
     m_aram.size = ARAM_SIZE;
     m_aram.mask = ARAM_MASK;
-    m_aram.ptr = static_cast<u8*>(Common::AllocateMemoryPages(m_aram.size));
+    m_aram.ptr = m_system.GetMemory().GetARAM();
   }
 
   m_audio_dma = {};
@@ -151,11 +150,7 @@ void DSPManager::Reinit(bool hle)
 
 void DSPManager::Shutdown()
 {
-  if (!m_aram.wii_mode)
-  {
-    Common::FreeMemoryPages(m_aram.ptr, m_aram.size);
-    m_aram.ptr = nullptr;
-  }
+  m_aram.ptr = nullptr;
 
   m_dsp_emulator->Shutdown();
   m_dsp_emulator.reset();
@@ -0,0 +1,266 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/HW/DirtyPageTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "Core/MemTools.h"
+
+namespace Memory
+{
+namespace
+{
+std::atomic<DirtyPageTracker*> s_active_tracker = nullptr;
+
+// Unlike Common::WriteProtectMemory this does not show a panic alert on failure, which can not be
+// done from a fault handler
+bool SetProtection(u8* pointer, size_t size, bool writable)
+{
+#ifdef _WIN32
+  DWORD old_protection;
+  return VirtualProtect(pointer, size, writable ? PAGE_READWRITE : PAGE_READONLY,
+                        &old_protection) != 0;
+#else
+  return mprotect(pointer, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ) == 0;
+#endif
+}
+
+// Sorts views by pointer, and merges adjacent views of adjacent pages. Fastmem maps memory in
+// blocks of 128 KiB, which are mostly contiguous.
+std::vector<DirtyPageTracker::View> MergeViews(std::vector<DirtyPageTracker::View> views)
+{
+  using View = DirtyPageTracker::View;
+  std::sort(views.begin(), views.end(),
+            [](const View& a, const View& b) { return a.pointer < b.pointer; });
+
+  const u32 page_size = DirtyPageTracker::GetPageSize();
+  std::vector<View> merged;
+  for (const View& view : views)
+  {
+    if (view.page_count == 0)
+      continue;
+    if (!merged.empty())
+    {
+      View& last = merged.back();
+      if (last.pointer + size_t(last.page_count) * page_size == view.pointer &&
+          last.first_page + last.page_count == view.first_page)
+      {
+        last.page_count += view.page_count;
+        continue;
+      }
+    }
+    merged.push_back(view);
+  }
+  return merged;
+}
+}  // namespace
+
+DirtyPageTracker::DirtyPageTracker() = default;
+
+DirtyPageTracker::~DirtyPageTracker()
+{
+  if (m_active)
+    Stop();
+}
+
+bool DirtyPageTracker::IsSupported()
+{
+#ifdef __APPLE__
+  // The Mach exception handler only catches faults on the CPU thread, and pages that can be
+  // executed can not be write protected on ARM
+  return false;
+#else
+  return EMM::IsExceptionHandlerSupported();
+#endif
+}
+
+u32 DirtyPageTracker::GetPageSize()
+{
+  static const u32 page_size = [] {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const u32 host_page_size = info.dwPageSize;
+#else
+    const u32 host_page_size = static_cast<u32>(sysconf(_SC_PAGESIZE));
+#endif
+    return std::max<u32>(host_page_size, 0x1000);
+  }();
+  return page_size;
+}
+
+bool DirtyPageTracker::HandleFault(uintptr_t address)
+{
+  DirtyPageTracker* tracker = s_active_tracker.load(std::memory_order_acquire);
+  return tracker && tracker->OnFault(address);
+}
+
+bool DirtyPageTracker::OnFault(uintptr_t address)
+{
+  // Runs in a signal handler or a vectored exception handler, which may have interrupted a thread
+  // that holds m_mutex. Views and bits are only freed once no fault is being handled.
+  m_faults_in_flight.fetch_add(1);
+  const bool handled = MarkDirty(reinterpret_cast<const u8*>(address));
+  m_faults_in_flight.fetch_sub(1);
+  return handled;
+}
+
+bool DirtyPageTracker::MarkDirty(const u8* pointer)
+{
+  const std::vector<View>* views = m_fault_views.load();
+  if (!views)
+    return false;
+
+  auto it = std::upper_bound(views->begin(), views->end(), pointer,
+                             [](const u8* p, const View& view) { return p < view.pointer; });
+  if (it == views->begin())
+    return false;
+  --it;
+
+  const u32 page_size = GetPageSize();
+  const size_t offset = pointer - it->pointer;
+  if (offset >= size_t(it->page_count) * page_size)
+    return false;
+
+  // Stop keeps the views, so that a write which faulted just before the pages were unprotected
+  // is retried instead of reaching the JIT
+  if (!m_active.load())
+    return true;
+
+  // The other views of the page stay protected until they are written to as well
+  const u32 page_in_view = static_cast<u32>(offset / page_size);
+  const u32 page = it->first_page + page_in_view;
+  if (!SetProtection(it->pointer + size_t(page_in_view) * page_size, page_size, true))
+    return false;
+  m_dirty[page / 64].fetch_or(u64(1) << (page % 64), std::memory_order_relaxed);
+  return true;
+}
+
+void DirtyPageTracker::WaitForFaults() const
+{
+  while (m_faults_in_flight.load() != 0)
+    std::this_thread::yield();
+}
+
+void DirtyPageTracker::ReplaceViews(std::vector<View> views)
+{
+  auto merged = std::make_unique<const std::vector<View>>(MergeViews(std::move(views)));
+  m_fault_views.store(merged.get());
+  WaitForFaults();
+  m_views = std::move(merged);
+}
+
+void DirtyPageTracker::Start(u32 page_count, std::vector<View> views)
+{
+  if (m_active)
+    Stop();
+
+  std::lock_guard lk(m_mutex);
+  m_dirty_words = (page_count + 63) / 64;
+  m_dirty = std::make_unique<std::atomic<u64>[]>(m_dirty_words);
+  ReplaceViews(std::move(views));
+  m_active.store(true);
+  s_active_tracker.store(this, std::memory_order_release);
+  ProtectAll();
+}
+
+void DirtyPageTracker::Stop()
+{
+  {
+    std::lock_guard lk(m_mutex);
+    UnprotectAll();
+    m_active.store(false);
+    WaitForFaults();
+    m_dirty.reset();
+    m_dirty_words = 0;
+  }
+  s_active_tracker.store(nullptr, std::memory_order_release);
+}
+
+void DirtyPageTracker::SetViews(std::vector<View> views)
+{
+  std::lock_guard lk(m_mutex);
+  if (!m_active)
+    return;
+
+  // New mappings are writable. Dirty pages are protected again too, their next write only sets
+  // the bit that is already set.
+  ReplaceViews(std::move(views));
+  ProtectAll();
+}
+
+void DirtyPageTracker::TakeDirtyPages(std::vector<u32>* pages)
+{
+  std::lock_guard lk(m_mutex);
+  // A page is taken before it is protected again, so a write in between is in the copy of the
+  // page that is made after this returns, and a write after that faults and sets the bit again
+  u32 run_start = 0;
+  u32 run_length = 0;
+  for (size_t i = 0; i < m_dirty_words; ++i)
+  {
+    u64 bits = m_dirty[i].exchange(0, std::memory_order_relaxed);
+    while (bits != 0)
+    {
+      const u32 page = static_cast<u32>(i * 64 + std::countr_zero(bits));
+      bits &= bits - 1;
+      pages->push_back(page);
+
+      if (run_length != 0 && run_start + run_length == page)
+      {
+        ++run_length;
+        continue;
+      }
+      if (run_length != 0)
+        Protect(run_start, run_length);
+      run_start = page;
+      run_length = 1;
+    }
+  }
+  if (run_length != 0)
+    Protect(run_start, run_length);
+}
+
+void DirtyPageTracker::ProtectAll()
+{
+  const u32 page_size = GetPageSize();
+  for (const View& view : *m_views)
+    SetProtection(view.pointer, size_t(view.page_count) * page_size, false);
+}
+
+void DirtyPageTracker::UnprotectAll()
+{
+  const u32 page_size = GetPageSize();
+  if (!m_views)
+    return;
+  for (const View& view : *m_views)
+    SetProtection(view.pointer, size_t(view.page_count) * page_size, true);
+}
+
+void DirtyPageTracker::Protect(u32 first_page, u32 page_count)
+{
+  const u32 page_size = GetPageSize();
+  const u32 end_page = first_page + page_count;
+  for (const View& view : *m_views)
+  {
+    const u32 start = std::max(first_page, view.first_page);
+    const u32 end = std::min(end_page, view.first_page + view.page_count);
+    if (start < end)
+    {
+      SetProtection(view.pointer + size_t(start - view.first_page) * page_size,
+                    size_t(end - start) * page_size, false);
+    }
+  }
+}
+}  // namespace Memory
@@ -0,0 +1,81 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace Memory
+{
+// Finds the pages of emulated memory written since they were last taken, by write protecting
+// them and catching the first write to each page in the fault handler of MemTools. The same
+// memory can be mapped at several host addresses, so a page can have several views, all of which
+// are protected.
+//
+// Writes done by the kernel, e.g. a read() straight into emulated memory, fail instead of
+// faulting while a page is protected.
+class DirtyPageTracker final
+{
+public:
+  struct View
+  {
+    u8* pointer;
+    u32 first_page;
+    u32 page_count;
+  };
+
+  DirtyPageTracker();
+  ~DirtyPageTracker();
+  DirtyPageTracker(const DirtyPageTracker&) = delete;
+  DirtyPageTracker& operator=(const DirtyPageTracker&) = delete;
+
+  // Whether faults can be caught on every thread that writes to emulated memory
+  static bool IsSupported();
+  // A multiple of the host page size
+  static u32 GetPageSize();
+
+  // Called by the fault handler of MemTools, from any thread. Only protects the page again and
+  // sets its bit, without taking locks or allocating.
+  static bool HandleFault(uintptr_t address);
+
+  // Starts with every page clean. Views are write protected until Stop.
+  void Start(u32 page_count, std::vector<View> views);
+  void Stop();
+  bool IsActive() const { return m_active; }
+
+  // Replaces the views, e.g. when the fastmem mappings changed. Views that are about to be
+  // unmapped have to be removed first.
+  void SetViews(std::vector<View> views);
+
+  // Appends the pages written since the last call in ascending order, and protects them again
+  void TakeDirtyPages(std::vector<u32>* pages);
+
+private:
+  bool OnFault(uintptr_t address);
+  bool MarkDirty(const u8* pointer);
+  // Waits for the fault handlers that might still use views or bits that are about to be freed
+  void WaitForFaults() const;
+  void ReplaceViews(std::vector<View> views);
+  void ProtectAll();
+  void UnprotectAll();
+  void Protect(u32 first_page, u32 page_count);
+
+  // Held by everything but the fault handler
+  std::mutex m_mutex;
+  std::atomic<bool> m_active = false;
+  std::atomic<u32> m_faults_in_flight = 0;
+  // Sorted by pointer, adjacent views of adjacent pages are merged. Replaced as a whole, the fault
+  // handler reads the list m_fault_views points to.
+  std::unique_ptr<const std::vector<View>> m_views;
+  std::atomic<const std::vector<View>*> m_fault_views = nullptr;
+  // A bit per page, set from the fault handler
+  std::unique_ptr<std::atomic<u64>[]> m_dirty;
+  size_t m_dirty_words = 0;
+};
+}  // namespace Memory
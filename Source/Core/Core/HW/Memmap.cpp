@@ -18,9 +18,11 @@
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
 #include "Core/Config/MainSettings.h"
+#include "Core/Config/SessionSettings.h"
 #include "Core/Core.h"
 #include "Core/HW/AudioInterface.h"
 #include "Core/HW/DSP.h"
@@ -101,9 +103,13 @@ void MemoryManager::Init()
       &m_fake_vmem, 0x7E000000, GetFakeVMemSize(), PhysicalMemoryRegion::FAKE_VMEM, 0, false};
   m_physical_regions[3] = PhysicalMemoryRegion{
       &m_exram, 0x10000000, GetExRamSize(), PhysicalMemoryRegion::WII_ONLY, 0, false};
+  m_physical_regions[4] = PhysicalMemoryRegion{
+      &m_aram, 0x00000000, DSP::ARAM_SIZE, PhysicalMemoryRegion::ARAM, 0, false};
 
   const bool wii = m_system.IsWii();
   const bool mmu = m_system.IsMMUMode();
+  // ARAM only needs to be in the segment when incremental savestates track writes to it
+  const bool aram_in_segment = !wii && Config::Get(Config::SESSION_INCREMENTAL_STATES);
 
   // If MMU is turned off in GameCube mode, turn on fake VMEM hack.
   const bool fake_vmem = !wii && !mmu;
@@ -115,6 +121,8 @@ void MemoryManager::Init()
       continue;
     if (!fake_vmem && (region.flags & PhysicalMemoryRegion::FAKE_VMEM))
       continue;
+    if (!aram_in_segment && (region.flags & PhysicalMemoryRegion::ARAM))
+      continue;
 
     region.shm_position = mem_size;
     region.active = true;
@@ -140,6 +148,9 @@ void MemoryManager::Init()
       exit(0);
     }
 
+    if (region.flags & PhysicalMemoryRegion::ARAM)
+      continue;
+
     for (u32 i = 0; i < region.size; i += PowerPC::BAT_PAGE_SIZE)
     {
       const size_t index = (i + region.physical_address) >> PowerPC::BAT_INDEX_SHIFT;
@@ -147,6 +158,9 @@ void MemoryManager::Init()
     }
   }
 
+  if (!wii && !aram_in_segment)
+    m_aram = static_cast<u8*>(Common::AllocateMemoryPages(DSP::ARAM_SIZE));
+
   m_physical_page_mappings_base = reinterpret_cast<u8*>(m_physical_page_mappings.data());
   m_logical_page_mappings_base = reinterpret_cast<u8*>(m_logical_page_mappings.data());
 
@@ -212,7 +226,7 @@ bool MemoryManager::InitFastmemArena()
 
   for (const PhysicalMemoryRegion& region : m_physical_regions)
   {
-    if (!region.active)
+    if (!region.active || (region.flags & PhysicalMemoryRegion::ARAM))
       continue;
 
     u8* base = m_physical_base + region.physical_address;
@@ -229,16 +243,20 @@ bool MemoryManager::InitFastmemArena()
 
   m_is_fastmem_arena_initialized = true;
   m_fastmem_arena_size = memory_size;
+  UpdateDirtyPageViews();
   return true;
 }
 
 void MemoryManager::UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
 {
-  for (auto& entry : m_logical_mapped_entries)
+  // The tracker must not handle faults in views that are unmapped
+  std::vector<LogicalMemoryView> old_entries = std::move(m_logical_mapped_entries);
+  m_logical_mapped_entries.clear();
+  UpdateDirtyPageViews();
+  for (auto& entry : old_entries)
   {
     m_arena.UnmapFromMemoryRegion(entry.mapped_pointer, entry.mapped_size);
   }
-  m_logical_mapped_entries.clear();
 
   m_logical_page_mappings.fill(nullptr);
 
@@ -252,7 +270,7 @@ void MemoryManager::UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
       u32 translated_address = dbat_table[i] & PowerPC::BAT_RESULT_MASK;
       for (const auto& physical_region : m_physical_regions)
       {
-        if (!physical_region.active)
+        if (!physical_region.active || (physical_region.flags & PhysicalMemoryRegion::ARAM))
           continue;
 
         u32 mapping_address = physical_region.physical_address;
@@ -278,7 +296,7 @@ void MemoryManager::UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
                   intersection_start, mapped_size, logical_address);
               exit(0);
             }
-            m_logical_mapped_entries.push_back({mapped_pointer, mapped_size});
+            m_logical_mapped_entries.push_back({mapped_pointer, mapped_size, position});
           }
 
           m_logical_page_mappings[i] =
@@ -287,6 +305,8 @@ void MemoryManager::UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
       }
     }
   }
+
+  UpdateDirtyPageViews();
 }
 
 void MemoryManager::DoState(PointerWrap& p)
@@ -327,6 +347,9 @@ void MemoryManager::DoState(PointerWrap& p)
     return;
   }
 
+  if (p.IsMemoryExcluded())
+    return;
+
   p.DoArray(m_ram, current_ram_size);
   p.DoArray(m_l1_cache, current_l1_cache_size);
   p.DoMarker("Memory RAM");
@@ -338,8 +361,72 @@ void MemoryManager::DoState(PointerWrap& p)
   p.DoMarker("Memory EXRAM");
 }
 
+bool MemoryManager::IsARAMInSegment() const
+{
+  return std::any_of(m_physical_regions.begin(), m_physical_regions.end(),
+                     [](const PhysicalMemoryRegion& region) {
+                       return region.active && (region.flags & PhysicalMemoryRegion::ARAM);
+                     });
+}
+
+u32 MemoryManager::GetDirtyPageCount() const
+{
+  u32 size = 0;
+  for (const PhysicalMemoryRegion& region : m_physical_regions)
+  {
+    if (region.active)
+      size = std::max(size, region.shm_position + region.size);
+  }
+  return size / DirtyPageTracker::GetPageSize();
+}
+
+std::vector<DirtyPageTracker::View> MemoryManager::GetDirtyPageViews(bool include_fastmem) const
+{
+  const u32 page_size = DirtyPageTracker::GetPageSize();
+  std::vector<DirtyPageTracker::View> views;
+  for (const PhysicalMemoryRegion& region : m_physical_regions)
+  {
+    if (!region.active)
+      continue;
+
+    const u32 first_page = region.shm_position / page_size;
+    const u32 page_count = region.size / page_size;
+    views.push_back({*region.out_pointer, first_page, page_count});
+    if (include_fastmem && m_is_fastmem_arena_initialized &&
+        !(region.flags & PhysicalMemoryRegion::ARAM))
+      views.push_back({m_physical_base + region.physical_address, first_page, page_count});
+  }
+
+  if (include_fastmem)
+  {
+    for (const LogicalMemoryView& entry : m_logical_mapped_entries)
+    {
+      views.push_back({static_cast<u8*>(entry.mapped_pointer), entry.shm_position / page_size,
+                       entry.mapped_size / page_size});
+    }
+  }
+  return views;
+}
+
+u8* MemoryManager::GetUntrackedView()
+{
+  if (!m_untracked_view)
+  {
+    m_untracked_view = static_cast<u8*>(
+        m_arena.CreateView(0, size_t(GetDirtyPageCount()) * DirtyPageTracker::GetPageSize()));
+  }
+  return m_untracked_view;
+}
+
+void MemoryManager::UpdateDirtyPageViews()
+{
+  if (m_dirty_page_tracker.IsActive())
+    m_dirty_page_tracker.SetViews(GetDirtyPageViews(true));
+}
+
 void MemoryManager::Shutdown()
 {
+  m_dirty_page_tracker.Stop();
   ShutdownFastmemArena();
 
   m_is_initialized = false;
@@ -351,6 +438,18 @@ void MemoryManager::Shutdown()
     m_arena.ReleaseView(*region.out_pointer, region.size);
     *region.out_pointer = nullptr;
   }
+  // Only still set if ARAM was allocated on its own
+  if (m_aram)
+  {
+    Common::FreeMemoryPages(m_aram, DSP::ARAM_SIZE);
+    m_aram = nullptr;
+  }
+  if (m_untracked_view)
+  {
+    m_arena.ReleaseView(m_untracked_view,
+                        size_t(GetDirtyPageCount()) * DirtyPageTracker::GetPageSize());
+    m_untracked_view = nullptr;
+  }
   m_arena.ReleaseSHMSegment();
   m_mmio_mapping.reset();
   INFO_LOG_FMT(MEMMAP, "Memory system shut down.");
@@ -361,20 +460,25 @@ void MemoryManager::ShutdownFastmemArena()
   if (!m_is_fastmem_arena_initialized)
     return;
 
+  // The tracker must not handle faults in views that are unmapped
+  std::vector<LogicalMemoryView> logical_entries = std::move(m_logical_mapped_entries);
+  m_logical_mapped_entries.clear();
+  m_is_fastmem_arena_initialized = false;
+  UpdateDirtyPageViews();
+
   for (const PhysicalMemoryRegion& region : m_physical_regions)
   {
-    if (!region.active)
+    if (!region.active || (region.flags & PhysicalMemoryRegion::ARAM))
       continue;
 
     u8* base = m_physical_base + region.physical_address;
     m_arena.UnmapFromMemoryRegion(base, region.size);
   }
 
-  for (auto& entry : m_logical_mapped_entries)
+  for (auto& entry : logical_entries)
   {
     m_arena.UnmapFromMemoryRegion(entry.mapped_pointer, entry.mapped_size);
   }
-  m_logical_mapped_entries.clear();
 
   m_arena.ReleaseMemoryRegion();
 
@@ -382,8 +486,6 @@ void MemoryManager::ShutdownFastmemArena()
   m_fastmem_arena_size = 0;
   m_physical_base = nullptr;
   m_logical_base = nullptr;
-
-  m_is_fastmem_arena_initialized = false;
 }
 
 void MemoryManager::Clear()
@@ -396,6 +498,8 @@ void MemoryManager::Clear()
     memset(m_fake_vmem, 0, GetFakeVMemSize());
   if (m_exram)
     memset(m_exram, 0, GetExRamSize());
+  if (m_aram)
+    memset(m_aram, 0, DSP::ARAM_SIZE);
 }
 
 u8* MemoryManager::GetPointerForRange(u32 address, size_t size) const
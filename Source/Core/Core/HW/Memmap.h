@@ -12,6 +12,7 @@
 #include "Common/MathUtil.h"
 #include "Common/MemArena.h"
 #include "Common/Swap.h"
+#include "Core/HW/DirtyPageTracker.h"
 #include "Core/PowerPC/MMU.h"
 
 // Global declarations
@@ -44,6 +45,8 @@ struct PhysicalMemoryRegion
     ALWAYS = 0,
     FAKE_VMEM = 1,
     WII_ONLY = 2,
+    // GameCube only, and only accessible through the DSP
+    ARAM = 4,
   } flags;
   u32 shm_position;
   bool active;
@@ -53,6 +56,7 @@ struct LogicalMemoryView
 {
   void* mapped_pointer;
   u32 mapped_size;
+  u32 shm_position;
 };
 
 class MemoryManager
@@ -87,6 +91,8 @@ public:
   u8*& GetEXRAM() { return m_exram; }
   u8* GetL1Cache() { return m_l1_cache; }
   u8*& GetFakeVMEM() { return m_fake_vmem; }
+  u8* GetARAM() const { return m_aram; }
+  bool IsARAMInSegment() const;
 
   MMIO::Mapping* GetMMIOMapping() const { return m_mmio_mapping.get(); }
 
@@ -98,6 +104,16 @@ public:
   void ShutdownFastmemArena();
   void DoState(PointerWrap& p);
 
+  // Tracks writes to the pages of the shared memory segment, numbered from its start. Once
+  // started with GetDirtyPageViews(true), the views are kept up to date when mappings change.
+  DirtyPageTracker& GetDirtyPageTracker() { return m_dirty_page_tracker; }
+  u32 GetDirtyPageCount() const;
+  // The views of the pages of the segment. Without fastmem, only the ones GetPointer returns.
+  std::vector<DirtyPageTracker::View> GetDirtyPageViews(bool include_fastmem) const;
+  // A view of the whole segment that is not tracked, for restoring pages without faulting.
+  // Created on first use.
+  u8* GetUntrackedView();
+
   void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table);
 
   void Clear();
@@ -166,6 +182,7 @@ private:
   u8* m_exram = nullptr;
   u8* m_l1_cache = nullptr;
   u8* m_fake_vmem = nullptr;
+  u8* m_aram = nullptr;
 
   // m_ram_size is the amount allocated by the emulator, whereas m_ram_size_real
   // is what will be reported in lowmem, and thus used by emulated software.
@@ -236,15 +253,23 @@ private:
   //
   // TODO: The actual size of RAM is 24MB; the other 8MB shouldn't be backed by actual memory.
   // TODO: Do we want to handle the mirrors of the GC RAM?
-  std::array<PhysicalMemoryRegion, 4> m_physical_regions{};
+  //
+  // When incremental savestates are enabled, the 16MB of GameCube ARAM are in the same segment,
+  // so that writes to it can be tracked like writes to RAM, but are not mapped for the CPU.
+  // Otherwise ARAM is allocated on its own.
+  std::array<PhysicalMemoryRegion, 5> m_physical_regions{};
 
   std::vector<LogicalMemoryView> m_logical_mapped_entries;
 
   std::array<void*, PowerPC::BAT_PAGE_COUNT> m_physical_page_mappings{};
   std::array<void*, PowerPC::BAT_PAGE_COUNT> m_logical_page_mappings{};
 
+  DirtyPageTracker m_dirty_page_tracker;
+  u8* m_untracked_view = nullptr;
+
   Core::System& m_system;
 
   void InitMMIO(bool is_wii);
+  void UpdateDirtyPageViews();
 };
 }  // namespace Memory
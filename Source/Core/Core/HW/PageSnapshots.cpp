@@ -0,0 +1,156 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/HW/PageSnapshots.h"
+
+#include <cstring>
+
+#include "Common/Assert.h"
+
+namespace Memory
+{
+PageSnapshots::PageSnapshots(DirtyPageTracker& tracker, u32 page_count,
+                             const std::vector<DirtyPageTracker::View>& blocks)
+    : m_tracker(tracker), m_page_size(DirtyPageTracker::GetPageSize()), m_pages(page_count)
+{
+  for (const DirtyPageTracker::View& block : blocks)
+  {
+    for (u32 i = 0; i < block.page_count; ++i)
+      m_pages[block.first_page + i] = block.pointer + size_t(i) * m_page_size;
+  }
+}
+
+PageSnapshots::~PageSnapshots() = default;
+
+PageSnapshots::Id PageSnapshots::Take()
+{
+  m_dirty_pages.clear();
+  m_tracker.TakeDirtyPages(&m_dirty_pages);
+
+  if (m_current.empty())
+  {
+    m_current.resize(m_pages.size());
+    m_dirty_pages.resize(m_pages.size());
+    for (u32 page = 0; page < m_pages.size(); ++page)
+    {
+      m_current[page] = AllocateSlot();
+      AddReference(m_current[page]);
+      m_dirty_pages[page] = page;
+    }
+  }
+  else
+  {
+    // The slots of the previous snapshots still hold the old contents
+    for (u32 page : m_dirty_pages)
+    {
+      RemoveReference(m_current[page]);
+      m_current[page] = AllocateSlot();
+      AddReference(m_current[page]);
+    }
+  }
+
+  for (u32 page : m_dirty_pages)
+    std::memcpy(GetSlot(m_current[page]), m_pages[page], m_page_size);
+  m_last_copied_pages = static_cast<u32>(m_dirty_pages.size());
+
+  Id id;
+  if (!m_free_ids.empty())
+  {
+    id = m_free_ids.back();
+    m_free_ids.pop_back();
+  }
+  else
+  {
+    id = static_cast<Id>(m_snapshots.size());
+    m_snapshots.emplace_back();
+  }
+  m_snapshots[id] = m_current;
+  for (u32 slot : m_current)
+    AddReference(slot);
+  return id;
+}
+
+void PageSnapshots::Restore(Id id)
+{
+  ASSERT(IsValid(id));
+  const std::vector<u32>& target = m_snapshots[id];
+
+  m_dirty_pages.clear();
+  m_tracker.TakeDirtyPages(&m_dirty_pages);
+
+  m_copy_pages.clear();
+  auto dirty = m_dirty_pages.begin();
+  for (u32 page = 0; page < m_pages.size(); ++page)
+  {
+    const bool written = dirty != m_dirty_pages.end() && *dirty == page;
+    if (written)
+      ++dirty;
+    if (written || target[page] != m_current[page])
+      m_copy_pages.push_back(page);
+  }
+
+  // The tracked views stay protected, taking the dirty pages protected the written ones again
+  for (u32 page : m_copy_pages)
+  {
+    std::memcpy(m_pages[page], GetSlot(target[page]), m_page_size);
+    if (target[page] != m_current[page])
+    {
+      AddReference(target[page]);
+      RemoveReference(m_current[page]);
+      m_current[page] = target[page];
+    }
+  }
+  m_last_copied_pages = static_cast<u32>(m_copy_pages.size());
+}
+
+void PageSnapshots::Release(Id id)
+{
+  ASSERT(IsValid(id));
+  for (u32 slot : m_snapshots[id])
+    RemoveReference(slot);
+  m_snapshots[id] = {};
+  m_free_ids.push_back(id);
+}
+
+bool PageSnapshots::IsValid(Id id) const
+{
+  return id < m_snapshots.size() && !m_snapshots[id].empty();
+}
+
+PageSnapshots::Stats PageSnapshots::GetStats() const
+{
+  Stats stats;
+  stats.last_copied_pages = m_last_copied_pages;
+  stats.snapshots = static_cast<u32>(m_snapshots.size() - m_free_ids.size());
+  stats.pool_pages = m_references.size();
+  stats.free_pool_pages = m_free_slots.size();
+  return stats;
+}
+
+u32 PageSnapshots::AllocateSlot()
+{
+  if (!m_free_slots.empty())
+  {
+    const u32 slot = m_free_slots.back();
+    m_free_slots.pop_back();
+    return slot;
+  }
+
+  const u32 slot = static_cast<u32>(m_references.size());
+  if (slot % PAGES_PER_CHUNK == 0)
+    m_chunks.push_back(std::make_unique<u8[]>(size_t(PAGES_PER_CHUNK) * m_page_size));
+  m_references.push_back(0);
+  return slot;
+}
+
+void PageSnapshots::RemoveReference(u32 slot)
+{
+  if (--m_references[slot] == 0)
+    m_free_slots.push_back(slot);
+}
+
+u8* PageSnapshots::GetSlot(u32 slot) const
+{
+  return m_chunks[slot / PAGES_PER_CHUNK].get() + size_t(slot % PAGES_PER_CHUNK) * m_page_size;
+}
+}  // namespace Memory
@@ -0,0 +1,82 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DirtyPageTracker.h"
+
+namespace Memory
+{
+// Copies of emulated memory that only copy the pages written since the previous Take or Restore,
+// and share the others with the snapshots before. Copies of pages are kept in a pool and counted
+// by the snapshots that use them, so a page written once is copied once however many snapshots
+// are kept.
+//
+// The tracker has to cover the same pages for as long as this is used. Only callable from the
+// CPU thread.
+class PageSnapshots final
+{
+public:
+  using Id = u32;
+
+  struct Stats
+  {
+    // Pages copied by the last Take or Restore
+    u32 last_copied_pages = 0;
+    u32 snapshots = 0;
+    size_t pool_pages = 0;
+    size_t free_pool_pages = 0;
+  };
+
+  // blocks are where pages are copied from and restored to, a pointer for each range of pages.
+  // They must not be views of the tracker, so that restoring pages does not fault.
+  PageSnapshots(DirtyPageTracker& tracker, u32 page_count,
+                const std::vector<DirtyPageTracker::View>& blocks);
+  ~PageSnapshots();
+  PageSnapshots(const PageSnapshots&) = delete;
+  PageSnapshots& operator=(const PageSnapshots&) = delete;
+
+  // The first snapshot copies every page
+  Id Take();
+  // Copies the pages that differ from the snapshot back, which are the ones written since the
+  // last Take or Restore and the ones that differ between the snapshot and the one memory
+  // matched then
+  void Restore(Id id);
+  void Release(Id id);
+  bool IsValid(Id id) const;
+
+  Stats GetStats() const;
+
+private:
+  static constexpr u32 PAGES_PER_CHUNK = 64;
+
+  u32 AllocateSlot();
+  void AddReference(u32 slot) { ++m_references[slot]; }
+  void RemoveReference(u32 slot);
+  u8* GetSlot(u32 slot) const;
+
+  DirtyPageTracker& m_tracker;
+  const u32 m_page_size;
+  // Where each page of emulated memory is
+  std::vector<u8*> m_pages;
+
+  std::vector<std::unique_ptr<u8[]>> m_chunks;
+  std::vector<u32> m_references;
+  std::vector<u32> m_free_slots;
+
+  // The slot of each page, empty for released snapshots
+  std::vector<std::vector<u32>> m_snapshots;
+  std::vector<Id> m_free_ids;
+  // The slots memory matched at the last Take or Restore, apart from the pages written since.
+  // Holds a reference to each.
+  std::vector<u32> m_current;
+
+  std::vector<u32> m_dirty_pages;
+  std::vector<u32> m_copy_pages;
+  u32 m_last_copied_pages = 0;
+};
+}  // namespace Memory
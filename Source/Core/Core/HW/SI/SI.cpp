@@ -87,6 +87,12 @@ void SerialInterfaceManager::ChangeDeviceCallback(Core::System& system, u64 user
   si.m_channel[user_data].has_recent_device_change = false;
 }
 
+void SerialInterfaceManager::NetPlayPollEndCallback(Core::System& system, u64 user_data,
+                                                    s64 cycles_late)
+{
+  NetPlay::OnPollEnd();
+}
+
 void SerialInterfaceManager::UpdateInterrupts()
 {
   // check if we have to update the RDSTINT flag
@@ -228,6 +234,8 @@ void SerialInterfaceManager::RegisterEvents()
   auto& core_timing = m_system.GetCoreTiming();
   m_event_type_change_device = core_timing.RegisterEvent("ChangeSIDevice", ChangeDeviceCallback);
   m_event_type_tranfer_pending = core_timing.RegisterEvent("SITransferPending", GlobalRunSIBuffer);
+  m_event_type_netplay_poll_end =
+      core_timing.RegisterEvent("NetPlayPollEnd", NetPlayPollEndCallback);
 
   constexpr std::array<CoreTiming::TimedCallback, MAX_SI_CHANNELS> event_callbacks = {
       DeviceEventCallback<0>,
@@ -567,6 +575,11 @@ void SerialInterfaceManager::UpdateDevices()
 
   // Polling finished
   NetPlay::SetSIPollBatching(false);
+
+  // NetPlay saves and loads states in an event of its own, right after the poll. That way they
+  // are all taken at the same point of the CoreTiming loop, with nothing of the poll left to run.
+  if (NetPlay::IsPollEndEventNeeded())
+    m_system.GetCoreTiming().ScheduleEvent(0, m_event_type_netplay_poll_end);
 }
 
 SIDevices SerialInterfaceManager::GetDeviceType(int channel) const
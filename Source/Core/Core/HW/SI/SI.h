@@ -85,6 +85,7 @@ private:
   void RunSIBuffer(u64 user_data, s64 cycles_late);
   static void GlobalRunSIBuffer(Core::System& system, u64 user_data, s64 cycles_late);
   static void ChangeDeviceCallback(Core::System& system, u64 user_data, s64 cycles_late);
+  static void NetPlayPollEndCallback(Core::System& system, u64 user_data, s64 cycles_late);
   template <int device_number>
   static void DeviceEventCallback(Core::System& system, u64 userdata, s64 cyclesLate);
 
@@ -230,6 +231,7 @@ private:
 
   CoreTiming::EventType* m_event_type_change_device = nullptr;
   CoreTiming::EventType* m_event_type_tranfer_pending = nullptr;
+  CoreTiming::EventType* m_event_type_netplay_poll_end = nullptr;
   std::array<CoreTiming::EventType*, MAX_SI_CHANNELS> m_event_types_device{};
 
   // User-configured device type. possibly overridden by TAS/Netplay
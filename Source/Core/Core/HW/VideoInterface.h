@@ -396,6 +396,10 @@ public:
   // Create a fake VI mode for a fifolog
   void FakeVIUpdate(u32 xfb_address, u32 fb_width, u32 fb_stride, u32 fb_height);
 
+  // While set, fields are emulated as usual but not presented, e.g. while NetPlay re-simulates
+  // frames that were already shown. Not part of the savestate.
+  void SetOutputSuppressed(bool suppressed) { m_output_suppressed = suppressed; }
+
 private:
   u32 GetHalfLinesPerEvenField() const;
   u32 GetHalfLinesPerOddField() const;
@@ -447,6 +451,8 @@ private:
   u32 m_even_field_last_hl = 0;   // index last halfline of the even field
   u32 m_odd_field_last_hl = 0;    // index last halfline of the odd field
 
+  bool m_output_suppressed = false;
+
   Core::System& m_system;
 };
 }  // namespace VideoInterface
@@ -0,0 +1,511 @@
+#include "Core/MSB_StatFile.h"
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+#include "Common/FileUtil.h"
+
+namespace StatFile {
+
+namespace {
+
+constexpr char cMagic[4] = {'R', 'I', 'O', 'S'};
+
+enum Table : size_t {
+    EventTable,
+    RunnerTable,
+    PitchTable,
+    ContactTable,
+    FielderTable,
+};
+
+//Presence flags of the optional parts of an event
+enum EventParts : u8 {
+    RunnerBatter = 1 << 0,
+    Runner1 = 1 << 1,
+    Runner2 = 1 << 2,
+    Runner3 = 1 << 3,
+    HasPitch = 1 << 4,
+    HasContact = 1 << 5,
+    FirstFielder = 1 << 6,
+    CollectFielder = 1 << 7,
+};
+
+class Encoder{
+public:
+    explicit Encoder(std::vector<u8>& out) : m_out(out) {}
+
+    void varint(u64 value){
+        while (value >= 0x80){
+            m_out.push_back(static_cast<u8>(value | 0x80));
+            value >>= 7;
+        }
+        m_out.push_back(static_cast<u8>(value));
+    }
+
+    template <typename T>
+    void value(const T& value){
+        if constexpr (std::is_signed_v<T>){
+            const s64 wide = value;
+            varint((static_cast<u64>(wide) << 1) ^ static_cast<u64>(wide >> 63));
+        }
+        else{
+            varint(value);
+        }
+    }
+
+    void string(const std::string& value){
+        varint(value.size());
+        m_out.insert(m_out.end(), value.begin(), value.end());
+    }
+
+    void optional(const std::optional<int>& value){
+        this->value(value.has_value());
+        if (value.has_value()){
+            this->value(value.value());
+        }
+    }
+
+private:
+    std::vector<u8>& m_out;
+};
+
+class Decoder{
+public:
+    Decoder(const u8* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+    u64 varint(){
+        u64 result = 0;
+        for (int shift = 0; shift < 64; shift += 7){
+            if (m_pos == m_end){
+                m_ok = false;
+                return 0;
+            }
+            const u8 byte = *m_pos++;
+            result |= static_cast<u64>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)){
+                return result;
+            }
+        }
+        m_ok = false;
+        return 0;
+    }
+
+    template <typename T>
+    void value(T& value){
+        const u64 raw = varint();
+        if constexpr (std::is_signed_v<T>){
+            value = static_cast<T>(static_cast<s64>(raw >> 1) ^ -static_cast<s64>(raw & 1));
+        }
+        else{
+            value = static_cast<T>(raw);
+        }
+    }
+
+    void string(std::string& value){
+        const u64 size = varint();
+        if (size > static_cast<u64>(m_end - m_pos)){
+            m_ok = false;
+            return;
+        }
+        value.assign(reinterpret_cast<const char*>(m_pos), size);
+        m_pos += size;
+    }
+
+    void optional(std::optional<int>& value){
+        bool has_value = false;
+        this->value(has_value);
+        if (has_value){
+            this->value(value.emplace());
+        }
+        else{
+            value.reset();
+        }
+    }
+
+    bool bytes(void* out, size_t size){
+        if (size > static_cast<size_t>(m_end - m_pos)){
+            m_ok = false;
+            return false;
+        }
+        std::memcpy(out, m_pos, size);
+        m_pos += size;
+        return true;
+    }
+
+    const u8* position() const { return m_pos; }
+    size_t remaining() const { return m_end - m_pos; }
+    void skip(size_t size) { m_pos += size; }
+    bool ok() const { return m_ok; }
+
+private:
+    const u8* m_pos;
+    const u8* m_end;
+    bool m_ok = true;
+};
+
+//Walks every GameInfo field, so writing and reading can never disagree on the layout
+template <typename Archive, typename Tracker>
+void visitGameInfo(Archive& ar, Tracker& tracker){
+    auto& game = tracker.m_game_info;
+    ar.value(game.game_id);
+    ar.string(game.rio_version);
+    ar.string(game.start_unix_date_time);
+    ar.string(game.start_local_date_time);
+    ar.string(game.end_unix_date_time);
+    ar.string(game.end_local_date_time);
+
+    ar.value(game.team0_port);
+    ar.value(game.team1_port);
+    ar.value(game.away_port);
+    ar.value(game.home_port);
+    ar.value(game.team0_captain_roster_loc);
+    ar.value(game.team1_captain_roster_loc);
+    ar.string(game.team0_player.username);
+    ar.string(game.team0_player.userid);
+    ar.string(game.team1_player.username);
+    ar.string(game.team1_player.userid);
+    ar.value(game.avg_ping);
+    ar.value(game.lag_spikes);
+
+    ar.value(game.away_score);
+    ar.value(game.home_score);
+    ar.value(game.stadium);
+    ar.value(game.innings_selected);
+    ar.value(game.innings_played);
+    ar.value(game.netplay);
+    ar.string(game.netplay_opponent_alias);
+    ar.optional(game.tag_set_id);
+    ar.value(game.quitter_team);
+
+    for (auto& team : game.character_summaries){
+        for (auto& summary : team){
+            ar.value(summary.team_id);
+            ar.value(summary.roster_id);
+            ar.value(summary.char_id);
+            ar.value(summary.is_starred);
+            ar.value(summary.fielding_hand);
+            ar.value(summary.batting_hand);
+
+            auto& def = summary.end_game_defensive_stats;
+            ar.value(def.batters_faced);
+            ar.value(def.runs_allowed);
+            ar.value(def.earned_runs);
+            ar.value(def.batters_walked);
+            ar.value(def.batters_hit);
+            ar.value(def.hits_allowed);
+            ar.value(def.homeruns_allowed);
+            ar.value(def.pitches_thrown);
+            ar.value(def.stamina);
+            ar.value(def.was_pitcher);
+            ar.value(def.outs_pitched);
+            ar.value(def.batter_outs);
+            ar.value(def.strike_outs);
+            ar.value(def.star_pitches_thrown);
+            ar.value(def.big_plays);
+
+            auto& off = summary.end_game_offensive_stats;
+            ar.value(off.game_id);
+            ar.value(off.team_id);
+            ar.value(off.roster_id);
+            ar.value(off.at_bats);
+            ar.value(off.hits);
+            ar.value(off.singles);
+            ar.value(off.doubles);
+            ar.value(off.triples);
+            ar.value(off.homeruns);
+            ar.value(off.sac_flys);
+            ar.value(off.successful_bunts);
+            ar.value(off.strikouts);
+            ar.value(off.walks_4balls);
+            ar.value(off.walks_hit);
+            ar.value(off.rbi);
+            ar.value(off.bases_stolen);
+            ar.value(off.star_hits);
+        }
+    }
+
+    for (auto& fielder_tracker : tracker.m_fielder_tracker){
+        for (u8 roster = 0; roster < cRosterSize; ++roster){
+            auto& info = fielder_tracker.fielder_map.at(roster);
+            for (auto* counts : {&info.pitch_count_by_position, &info.batter_count_by_position,
+                                 &info.out_count_by_position, &info.batter_outs_by_position}){
+                for (auto& count : *counts){
+                    ar.value(count);
+                }
+            }
+        }
+    }
+}
+
+template <typename Record>
+void encodeRecord(Encoder& enc, std::span<const typename TrackerColumnTable<Record>::Field> schema,
+                  const Record& record, std::vector<u32>& previous){
+    previous.resize(schema.size());
+    for (size_t field = 0; field < schema.size(); ++field){
+        const u32 value = schema[field].get(record);
+        enc.value(static_cast<s32>(value - previous[field]));
+        previous[field] = value;
+    }
+}
+
+template <typename Record>
+void decodeRecord(Decoder& dec, std::span<const typename TrackerColumnTable<Record>::Field> schema,
+                  Record& record, std::vector<u32>& previous){
+    previous.resize(schema.size());
+    for (size_t field = 0; field < schema.size(); ++field){
+        s32 delta = 0;
+        dec.value(delta);
+        previous[field] += static_cast<u32>(delta);
+        schema[field].set(record, previous[field]);
+    }
+}
+
+template <typename Record>
+void decodeOptional(Decoder& dec, std::span<const typename TrackerColumnTable<Record>::Field> schema,
+                    bool present, std::optional<Record>& record, std::vector<u32>& previous){
+    if (!present){
+        record.reset();
+        return;
+    }
+    if (!record.has_value()){
+        record.emplace();
+    }
+    decodeRecord(dec, schema, record.value(), previous);
+}
+
+std::array<std::vector<u8>, 5> getSchemaWidths(){
+    const StatTracker::EventSchema& schema = StatTracker::getEventSchema();
+    std::array<std::vector<u8>, 5> widths;
+    const auto add = [](std::vector<u8>& out, const auto& fields) {
+        for (const auto& field : fields){
+            out.push_back(field.width);
+        }
+    };
+    add(widths[EventTable], schema.event);
+    add(widths[RunnerTable], schema.runner);
+    add(widths[PitchTable], schema.pitch);
+    add(widths[ContactTable], schema.contact);
+    add(widths[FielderTable], schema.fielder);
+    return widths;
+}
+
+//Takes a GameInfo chunk before it reaches the tracker, so a damaged one never leaves half of its fields applied
+struct GameInfoCheck{
+    StatTracker::GameInfo m_game_info;
+    std::array<StatTracker::FielderTracker, cNumOfTeams> m_fielder_tracker;
+};
+
+bool decodeEvent(Decoder& dec, StatTracker::Event& event, DeltaState& previous){
+    const StatTracker::EventSchema& schema = StatTracker::getEventSchema();
+
+    u8 parts = 0;
+    dec.value(parts);
+    decodeRecord(dec, schema.event, event, previous[EventTable]);
+
+    const std::array<std::optional<StatTracker::Runner>*, cNumOfBases> runners = {
+        &event.runner_batter, &event.runner_1, &event.runner_2, &event.runner_3};
+    for (int base = 0; base < cNumOfBases; ++base){
+        decodeOptional(dec, schema.runner, (parts & (RunnerBatter << base)) != 0, *runners[base], previous[RunnerTable]);
+    }
+
+    decodeOptional(dec, schema.pitch, (parts & HasPitch) != 0, event.pitch, previous[PitchTable]);
+    if (event.pitch.has_value()){
+        StatTracker::Pitch& pitch = event.pitch.value();
+        decodeOptional(dec, schema.contact, (parts & HasContact) != 0, pitch.contact, previous[ContactTable]);
+        if (pitch.contact.has_value()){
+            StatTracker::Contact& contact = pitch.contact.value();
+            decodeOptional(dec, schema.fielder, (parts & FirstFielder) != 0, contact.first_fielder, previous[FielderTable]);
+            decodeOptional(dec, schema.fielder, (parts & CollectFielder) != 0, contact.collect_fielder, previous[FielderTable]);
+        }
+    }
+    return dec.ok();
+}
+
+}
+
+bool Writer::open(const std::string& path){
+    if (!m_file.Open(path, "wb")){
+        return false;
+    }
+
+    m_payload.clear();
+    m_payload.insert(m_payload.end(), std::begin(cMagic), std::end(cMagic));
+    m_payload.push_back(cVersion);
+    Encoder enc(m_payload);
+    for (const std::vector<u8>& widths : getSchemaWidths()){
+        enc.varint(widths.size());
+        m_payload.insert(m_payload.end(), widths.begin(), widths.end());
+    }
+
+    for (std::vector<u32>& previous : m_previous){
+        previous.clear();
+    }
+    return m_file.WriteBytes(m_payload.data(), m_payload.size()) && m_file.Flush();
+}
+
+void Writer::writeGameInfo(const StatTracker& tracker){
+    if (!isOpen()){
+        return;
+    }
+
+    m_payload.clear();
+    Encoder enc(m_payload);
+    visitGameInfo(enc, tracker);
+    writeChunk(ChunkType::GameInfo);
+}
+
+void Writer::writeEvent(const StatTracker::Event& event){
+    if (!isOpen()){
+        return;
+    }
+
+    const StatTracker::EventSchema& schema = StatTracker::getEventSchema();
+    const std::array<const std::optional<StatTracker::Runner>*, cNumOfBases> runners = {
+        &event.runner_batter, &event.runner_1, &event.runner_2, &event.runner_3};
+    const StatTracker::Contact* contact =
+        (event.pitch.has_value() && event.pitch->contact.has_value()) ? &event.pitch->contact.value() : nullptr;
+
+    u8 parts = 0;
+    for (int base = 0; base < cNumOfBases; ++base){
+        if (runners[base]->has_value()){
+            parts |= RunnerBatter << base;
+        }
+    }
+    if (event.pitch.has_value()){
+        parts |= HasPitch;
+    }
+    if (contact){
+        parts |= HasContact;
+        if (contact->first_fielder.has_value()){
+            parts |= FirstFielder;
+        }
+        if (contact->collect_fielder.has_value()){
+            parts |= CollectFielder;
+        }
+    }
+
+    m_payload.clear();
+    Encoder enc(m_payload);
+    enc.value(parts);
+    encodeRecord(enc, schema.event, event, m_previous[EventTable]);
+    for (int base = 0; base < cNumOfBases; ++base){
+        if (runners[base]->has_value()){
+            encodeRecord(enc, schema.runner, runners[base]->value(), m_previous[RunnerTable]);
+        }
+    }
+    if (event.pitch.has_value()){
+        encodeRecord(enc, schema.pitch, event.pitch.value(), m_previous[PitchTable]);
+    }
+    if (contact){
+        encodeRecord(enc, schema.contact, *contact, m_previous[ContactTable]);
+        if (contact->first_fielder.has_value()){
+            encodeRecord(enc, schema.fielder, contact->first_fielder.value(), m_previous[FielderTable]);
+        }
+        if (contact->collect_fielder.has_value()){
+            encodeRecord(enc, schema.fielder, contact->collect_fielder.value(), m_previous[FielderTable]);
+        }
+    }
+    writeChunk(ChunkType::Event);
+}
+
+void Writer::close(){
+    if (!isOpen()){
+        return;
+    }
+
+    m_payload.clear();
+    writeChunk(ChunkType::End);
+    m_file.Close();
+}
+
+void Writer::writeChunk(ChunkType type){
+    m_chunk.clear();
+    m_chunk.push_back(static_cast<u8>(type));
+    Encoder(m_chunk).varint(m_payload.size());
+    m_chunk.insert(m_chunk.end(), m_payload.begin(), m_payload.end());
+
+    //Flushed right away so a crash never takes a finished event with it
+    m_file.WriteBytes(m_chunk.data(), m_chunk.size());
+    m_file.Flush();
+}
+
+ReadResult read(const std::string& path, StatTracker& tracker){
+    std::string data;
+    if (!File::ReadFileToString(path, data)){
+        return ReadResult::Invalid;
+    }
+
+    Decoder file(reinterpret_cast<const u8*>(data.data()), data.size());
+    char magic[sizeof(cMagic)];
+    u8 version = 0;
+    if (!file.bytes(magic, sizeof(magic)) || std::memcmp(magic, cMagic, sizeof(cMagic)) != 0 ||
+        !file.bytes(&version, sizeof(version)) || version != cVersion){
+        return ReadResult::Invalid;
+    }
+
+    //Fields are only ever coded with the layout this build was compiled with
+    for (const std::vector<u8>& widths : getSchemaWidths()){
+        const u64 count = file.varint();
+        if (!file.ok() || count > file.remaining()){
+            return ReadResult::Invalid;
+        }
+        std::vector<u8> file_widths(count);
+        if (!file.bytes(file_widths.data(), file_widths.size()) || file_widths != widths){
+            return ReadResult::Invalid;
+        }
+    }
+
+    tracker.init();
+    StatTracker::GameInfo& game = tracker.m_game_info;
+    DeltaState previous;
+    StatTracker::Event event;
+    const auto check = std::make_unique<GameInfoCheck>();
+    bool complete = false;
+    while (file.remaining() > 0 && !complete){
+        u8 type = 0;
+        file.bytes(&type, sizeof(type));
+        const u64 size = file.varint();
+        if (!file.ok() || size > file.remaining()){
+            break;
+        }
+
+        Decoder chunk(file.position(), size);
+        file.skip(size);
+        switch (static_cast<ChunkType>(type)){
+            case ChunkType::GameInfo:{
+                Decoder check_chunk = chunk;
+                visitGameInfo(check_chunk, *check);
+                if (!check_chunk.ok()){
+                    return ReadResult::Invalid;
+                }
+                visitGameInfo(chunk, tracker);
+                break;
+            }
+            case ChunkType::Event:
+                if (decodeEvent(chunk, event, previous)){
+                    game.events.append(event);
+                }
+                break;
+            case ChunkType::End:
+                complete = true;
+                break;
+            default:
+                //Unknown chunks are skipped so older builds can still read newer files
+                break;
+        }
+    }
+
+    if (!complete){
+        //Same as a game dumped on stop
+        game.quitter_team = 2;
+        return ReadResult::Truncated;
+    }
+    return ReadResult::Complete;
+}
+
+}
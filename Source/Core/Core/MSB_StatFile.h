@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/IOFile.h"
+#include "Core/MSB_StatTracker.h"
+
+//Compact binary record of a game, written while the game is being played.
+//
+//Integers are LEB128 varints unless noted, signed ones zigzag coded first. Strings are a length
+//followed by the bytes.
+//
+//  Header:  "RIOS", u8 version, then the event schema: for each record table (event, runner,
+//           pitch, contact, fielder) the number of fields followed by one width byte per field
+//  Chunks:  u8 type, payload size, payload
+//    GameInfo  Everything about the game that is not an event: players, scores, character
+//              summaries and fielder position counts. Written when the game starts, once the
+//              players are known and when it ends. The last one wins
+//    Event     One finished event: a byte of presence flags for its optional parts, then every
+//              field of every present record, coded as the difference to the same field of
+//              the previous record of that table
+//    End       The game was closed normally (finished, quit or dumped on stop)
+//
+//Every chunk is flushed as soon as it is written, so a file cut short by a crash still holds all
+//events up to the last one that finished.
+namespace StatFile {
+
+static constexpr u8 cVersion = 1;
+static constexpr char cExtension[] = ".riostats";
+
+enum class ChunkType : u8 {
+    GameInfo = 1,
+    Event = 2,
+    End = 3,
+};
+
+//Previous value of every field of every record table, the base the next record is coded against
+using DeltaState = std::array<std::vector<u32>, 5>;
+
+class Writer{
+public:
+    bool open(const std::string& path);
+    bool isOpen() const { return m_file.IsOpen(); }
+
+    void writeGameInfo(const StatTracker& tracker);
+    void writeEvent(const StatTracker::Event& event);
+    //Marks the game as complete and closes the file
+    void close();
+
+private:
+    void writeChunk(ChunkType type);
+
+    File::IOFile m_file;
+    //Payload of the chunk being written, reused across chunks
+    std::vector<u8> m_payload;
+    std::vector<u8> m_chunk;
+    DeltaState m_previous;
+};
+
+enum class ReadResult {
+    Complete,
+    //No End chunk, the game was cut short. Everything up to the cut was loaded
+    Truncated,
+    Invalid,
+};
+
+//Loads a stat file into an offline tracker, ready to be written out as JSON
+ReadResult read(const std::string& path, StatTracker& tracker);
+
+}
@@ -0,0 +1,272 @@
+#include "Core/MSB_StatSubmitter.h"
+
+#include <algorithm>
+#include <ctime>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Common/HttpRequest.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+
+StatSubmitter::StatSubmitter(Settings settings, SendFunction send, GameCallback on_game)
+    : m_settings(std::move(settings)), m_send(std::move(send)), m_on_game(std::move(on_game))
+{
+  if (!m_send)
+  {
+    // Only ever used from the worker thread. The progress callback lets Shutdown() abort a
+    // request that is stuck on a slow or unreachable server instead of waiting for the timeout.
+    auto http = std::make_shared<Common::HttpRequest>(
+        std::chrono::minutes{3}, [this](s64, s64, s64, s64) { return !m_shutdown.IsSet(); });
+    m_send = [http](const std::string& url, const std::string& payload) {
+      return http->Post(url, payload, {{"Content-Type", "application/json"}}).has_value();
+    };
+  }
+
+  LoadSpool();
+  m_thread = std::thread(&StatSubmitter::ThreadLoop, this);
+}
+
+StatSubmitter::~StatSubmitter()
+{
+  Shutdown();
+}
+
+void StatSubmitter::SubmitGame(u32 game_id, std::string payload)
+{
+  Enqueue({Kind::Game, game_id, std::move(payload)});
+}
+
+void StatSubmitter::PostOngoingGame(u32 game_id, std::string payload)
+{
+  Enqueue({Kind::OngoingGamePost, game_id, std::move(payload)});
+}
+
+void StatSubmitter::UpdateOngoingGame(u32 game_id, std::string payload)
+{
+  Enqueue({Kind::OngoingGameUpdate, game_id, std::move(payload)});
+}
+
+void StatSubmitter::Enqueue(Item item)
+{
+  std::lock_guard lk(m_lock);
+  if (m_shutdown.IsSet())
+    return;
+
+  // A pending refresh of the same game has not been sent yet, so only the newest one matters.
+  if (item.kind == Kind::OngoingGameUpdate)
+  {
+    const auto it = std::find_if(m_items.rbegin(), m_items.rend(), [&](const Item& pending) {
+      return pending.kind == Kind::OngoingGameUpdate && pending.game_id == item.game_id;
+    });
+    if (it != m_items.rend())
+    {
+      it->payload = std::move(item.payload);
+      it->attempts = 0;
+      return;
+    }
+  }
+
+  // Make room by dropping ongoing-game traffic. Games are never dropped here; they are rare and
+  // losing one would mean losing the record of a whole match.
+  if (m_items.size() >= m_settings.max_queue_size)
+  {
+    const auto it = std::find_if(m_items.begin(), m_items.end(),
+                                 [](const Item& pending) { return pending.kind != Kind::Game; });
+    if (it != m_items.end())
+    {
+      WARN_LOG_FMT(CORE, "StatSubmitter: queue full, dropping ongoing game update for {}",
+                   it->game_id);
+      m_items.erase(it);
+    }
+  }
+
+  m_items.push_back(std::move(item));
+  m_worker_cv.notify_one();
+}
+
+bool StatSubmitter::WaitForIdle(std::chrono::milliseconds timeout)
+{
+  std::unique_lock lk(m_lock);
+  return m_idle_cv.wait_for(lk, timeout, [this] { return m_items.empty() && !m_busy; });
+}
+
+void StatSubmitter::Shutdown()
+{
+  {
+    std::lock_guard lk(m_lock);
+    m_shutdown.Set();
+    m_worker_cv.notify_one();
+  }
+
+  if (m_thread.joinable())
+    m_thread.join();
+
+  std::lock_guard lk(m_lock);
+  // Games the worker didn't get to yet would otherwise be lost
+  for (Item& item : m_items)
+  {
+    if (item.kind == Kind::Game && item.spool_path.empty() && !m_settings.spool_dir.empty())
+      item.spool_path = WriteSpoolFile(item);
+  }
+  m_items.clear();
+  m_idle_cv.notify_all();
+}
+
+size_t StatSubmitter::GetPendingCount() const
+{
+  std::lock_guard lk(m_lock);
+  return m_items.size() + (m_busy ? 1 : 0);
+}
+
+void StatSubmitter::LoadSpool()
+{
+  if (m_settings.spool_dir.empty())
+    return;
+
+  File::CreateFullPath(m_settings.spool_dir);
+
+  for (const std::string& path : Common::DoFileSearch({m_settings.spool_dir}, {".json"}))
+  {
+    Item item{Kind::Game};
+    if (!File::ReadFileToString(path, item.payload))
+      continue;
+
+    std::string file_name;
+    SplitPath(path, nullptr, &file_name, nullptr);
+    TryParse(file_name.substr(0, file_name.find('_')), &item.game_id);
+
+    item.spool_path = path;
+    INFO_LOG_FMT(CORE, "StatSubmitter: resubmitting spooled game {}", path);
+    m_items.push_back(std::move(item));
+  }
+}
+
+std::string StatSubmitter::WriteSpoolFile(const Item& item)
+{
+  const std::string path =
+      fmt::format("{}{}_{}_{}.json", m_settings.spool_dir, item.game_id, std::time(nullptr),
+                  m_spool_counter++);
+  const std::string temp_path = path + ".tmp";
+
+  // Write then rename so a crash mid-write never leaves a truncated game in the spool
+  if (!File::WriteStringToFile(temp_path, item.payload) || !File::Rename(temp_path, path))
+  {
+    ERROR_LOG_FMT(CORE, "StatSubmitter: failed to spool game {} to {}", item.game_id, path);
+    File::Delete(temp_path, File::IfAbsentBehavior::NoConsoleWarning);
+    return {};
+  }
+  return path;
+}
+
+void StatSubmitter::ThreadLoop()
+{
+  Common::SetCurrentThreadName("Stat Submitter");
+
+  std::unique_lock lk(m_lock);
+  while (!m_shutdown.IsSet())
+  {
+    if (m_items.empty())
+    {
+      m_idle_cv.notify_all();
+      m_worker_cv.wait(lk, [this] { return !m_items.empty() || m_shutdown.IsSet(); });
+      continue;
+    }
+
+    // Items of the same game are sent in order, so an ongoing game post always reaches the
+    // server before its updates. Other games don't wait for a game that is backing off.
+    const Clock::time_point now = Clock::now();
+    Clock::time_point next_retry = Clock::time_point::max();
+    std::vector<u32> earlier_games;
+    auto ready = m_items.end();
+    for (auto it = m_items.begin(); it != m_items.end(); ++it)
+    {
+      if (std::find(earlier_games.begin(), earlier_games.end(), it->game_id) !=
+          earlier_games.end())
+      {
+        continue;
+      }
+      if (it->not_before <= now)
+      {
+        ready = it;
+        break;
+      }
+      earlier_games.push_back(it->game_id);
+      next_retry = std::min(next_retry, it->not_before);
+    }
+
+    if (ready == m_items.end())
+    {
+      m_worker_cv.wait_until(lk, next_retry);
+      continue;
+    }
+
+    Item item = std::move(*ready);
+    m_items.erase(ready);
+    m_busy = true;
+
+    lk.unlock();
+    const bool finished = Process(item);
+    lk.lock();
+
+    m_busy = false;
+    if (finished)
+      continue;
+
+    // A failed refresh that has since been superseded is not worth retrying
+    const bool superseded =
+        item.kind == Kind::OngoingGameUpdate &&
+        std::any_of(m_items.begin(), m_items.end(), [&](const Item& pending) {
+          return pending.kind == Kind::OngoingGameUpdate && pending.game_id == item.game_id;
+        });
+    if (superseded)
+      continue;
+
+    // Retry behind the other games, but ahead of the items queued for the same game meanwhile
+    const auto next_of_game = std::find_if(m_items.begin(), m_items.end(), [&](const Item& pending) {
+      return pending.game_id == item.game_id;
+    });
+    m_items.insert(next_of_game, std::move(item));
+  }
+}
+
+bool StatSubmitter::Process(Item& item)
+{
+  if (item.kind == Kind::Game && item.spool_path.empty() && !m_settings.spool_dir.empty())
+    item.spool_path = WriteSpoolFile(item);
+
+  const std::string url =
+      item.kind == Kind::Game ? m_settings.api_url : m_settings.api_url + "ongoing_game/";
+  if (m_send(url, item.payload))
+  {
+    if (!item.spool_path.empty())
+      File::Delete(item.spool_path);
+    if (item.kind == Kind::Game && m_on_game)
+      m_on_game(item.game_id, true);
+    return true;
+  }
+
+  ++item.attempts;
+  if (item.attempts >= m_settings.max_attempts || m_shutdown.IsSet())
+  {
+    if (item.kind == Kind::Game)
+    {
+      WARN_LOG_FMT(CORE, "StatSubmitter: giving up on game {} after {} attempts{}", item.game_id,
+                   item.attempts, item.spool_path.empty() ? "" : ", kept in spool");
+      if (m_on_game)
+        m_on_game(item.game_id, false);
+    }
+    return true;
+  }
+
+  const auto backoff = std::min(
+      m_settings.initial_backoff * (1u << std::min(item.attempts - 1, 16u)), m_settings.max_backoff);
+  item.not_before = Clock::now() + backoff;
+  return false;
+}
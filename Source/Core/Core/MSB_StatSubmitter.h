@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Common/CommonTypes.h"
+#include "Common/Flag.h"
+
+// Sends stat tracker payloads to the Rio API from a dedicated worker thread.
+//
+// The CPU thread only hands over finished JSON strings. Everything that can block (spooling to
+// disk, network round trips, retries) happens on the worker. Finished games are written to a spool
+// directory before they are sent and only removed once the server accepted them, so games survive
+// crashes and offline sessions and are resent the next time a submitter is created.
+class StatSubmitter
+{
+public:
+  enum class Kind : u8
+  {
+    // Final game record. Spooled to disk, retried until accepted.
+    Game,
+    // First OngoingGame post for a game. Retried in memory only.
+    OngoingGamePost,
+    // OngoingGame refresh. Superseded by newer refreshes of the same game.
+    OngoingGameUpdate,
+  };
+
+  // Returns true if the server accepted the payload.
+  using SendFunction = std::function<bool(const std::string& url, const std::string& payload)>;
+  // Called from the worker thread whenever a Game submission finished (successfully or not).
+  using GameCallback = std::function<void(u32 game_id, bool accepted)>;
+
+  struct Settings
+  {
+    // populate_db endpoint. OngoingGame traffic goes to its ongoing_game/ sub-path.
+    std::string api_url = "https://api.projectrio.app/populate_db/";
+    // Directory used to persist Game submissions. Empty disables spooling.
+    std::string spool_dir;
+    // Pending items beyond this are dropped, oldest ongoing-game traffic first.
+    size_t max_queue_size = 64;
+    // Attempts per item before giving up (a spooled game stays on disk for the next session).
+    u32 max_attempts = 5;
+    std::chrono::milliseconds initial_backoff{1000};
+    std::chrono::milliseconds max_backoff{60000};
+  };
+
+  // An empty send function posts to the configured API with Common::HttpRequest.
+  explicit StatSubmitter(Settings settings, SendFunction send = {}, GameCallback on_game = {});
+  ~StatSubmitter();
+
+  StatSubmitter(const StatSubmitter&) = delete;
+  StatSubmitter& operator=(const StatSubmitter&) = delete;
+
+  // All of these are cheap and never block on I/O. Safe to call from the CPU thread.
+  void SubmitGame(u32 game_id, std::string payload);
+  void PostOngoingGame(u32 game_id, std::string payload);
+  void UpdateOngoingGame(u32 game_id, std::string payload);
+
+  // Blocks until the queue is empty (items that are waiting for a retry count as pending).
+  // Returns false if the timeout expired first.
+  bool WaitForIdle(std::chrono::milliseconds timeout);
+
+  // Stops the worker. Queued games are written to the spool for the next session; ongoing game
+  // traffic that is still queued is dropped.
+  void Shutdown();
+
+  size_t GetPendingCount() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Item
+  {
+    Kind kind;
+    u32 game_id = 0;
+    std::string payload;
+    std::string spool_path;
+    u32 attempts = 0;
+    Clock::time_point not_before{};
+  };
+
+  void Enqueue(Item item);
+  void LoadSpool();
+  void ThreadLoop();
+  // Returns true when the item is finished with (sent or given up on).
+  bool Process(Item& item);
+  // Worker thread only, or once the worker has stopped
+  std::string WriteSpoolFile(const Item& item);
+
+  Settings m_settings;
+  SendFunction m_send;
+  GameCallback m_on_game;
+
+  mutable std::mutex m_lock;
+  std::condition_variable m_worker_cv;
+  std::condition_variable m_idle_cv;
+  std::deque<Item> m_items;
+  bool m_busy = false;
+
+  // Worker thread only, or once the worker has stopped
+  u32 m_spool_counter = 0;
+
+  Common::Flag m_shutdown;
+  std::thread m_thread;
+};
@@ -1,6 +1,8 @@
 
 #include "Core/MSB_StatTracker.h"
+#include "Core/MSB_StatFile.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <fstream>
 #include <ctime>
@@ -23,9 +25,383 @@
 
 #include "Common/TagSet.h"
 
+namespace {
+using EventTable = TrackerColumnTable<StatTracker::Event>;
+using RunnerTable = TrackerColumnTable<StatTracker::Runner>;
+using PitchTable = TrackerColumnTable<StatTracker::Pitch>;
+using ContactTable = TrackerColumnTable<StatTracker::Contact>;
+using FielderTable = TrackerColumnTable<StatTracker::Fielder>;
+
+//Column layouts of the event log. EventLog::getEventNum/getInning depend on the first two entries
+constexpr std::array cEventSchema = {
+    EventTable::column<&StatTracker::Event::event_num>(),
+    EventTable::column<&StatTracker::Event::inning>(),
+    EventTable::column<&StatTracker::Event::pick_off_attempt>(),
+    EventTable::column<&StatTracker::Event::half_inning>(),
+    EventTable::column<&StatTracker::Event::away_score>(),
+    EventTable::column<&StatTracker::Event::home_score>(),
+    EventTable::column<&StatTracker::Event::is_star_chance>(),
+    EventTable::column<&StatTracker::Event::away_stars>(),
+    EventTable::column<&StatTracker::Event::home_stars>(),
+    EventTable::column<&StatTracker::Event::chem_links_ob>(),
+    EventTable::column<&StatTracker::Event::pitcher_stamina>(),
+    EventTable::column<&StatTracker::Event::pitcher_roster_loc>(),
+    EventTable::column<&StatTracker::Event::batter_roster_loc>(),
+    EventTable::column<&StatTracker::Event::catcher_roster_loc>(),
+    EventTable::column<&StatTracker::Event::balls>(),
+    EventTable::column<&StatTracker::Event::strikes>(),
+    EventTable::column<&StatTracker::Event::outs>(),
+    EventTable::column<&StatTracker::Event::num_outs_during_play>(),
+    EventTable::column<&StatTracker::Event::rbi>(),
+    EventTable::column<&StatTracker::Event::result_of_atbat>(),
+};
+
+constexpr std::array cRunnerSchema = {
+    RunnerTable::column<&StatTracker::Runner::roster_loc>(),
+    RunnerTable::column<&StatTracker::Runner::char_id>(),
+    RunnerTable::column<&StatTracker::Runner::initial_base>(),
+    RunnerTable::column<&StatTracker::Runner::out_type>(),
+    RunnerTable::column<&StatTracker::Runner::out_location>(),
+    RunnerTable::column<&StatTracker::Runner::result_base>(),
+    RunnerTable::column<&StatTracker::Runner::steal>(),
+    RunnerTable::column<&StatTracker::Runner::basepath_location>(),
+};
+
+constexpr std::array cPitchSchema = {
+    PitchTable::column<&StatTracker::Pitch::logged>(),
+    PitchTable::column<&StatTracker::Pitch::pitcher_team_id>(),
+    PitchTable::column<&StatTracker::Pitch::pitcher_char_id>(),
+    PitchTable::column<&StatTracker::Pitch::pitch_type>(),
+    PitchTable::column<&StatTracker::Pitch::charge_type>(),
+    PitchTable::column<&StatTracker::Pitch::star_pitch>(),
+    PitchTable::column<&StatTracker::Pitch::pitch_speed>(),
+    PitchTable::column<&StatTracker::Pitch::batter_roster_loc>(),
+    PitchTable::column<&StatTracker::Pitch::batter_id>(),
+    PitchTable::column<&StatTracker::Pitch::ball_z_strike_vs_ball>(),
+    PitchTable::column<&StatTracker::Pitch::ball_in_strikezone>(),
+    PitchTable::column<&StatTracker::Pitch::bat_contact_x_pos>(),
+    PitchTable::column<&StatTracker::Pitch::bat_contact_z_pos>(),
+    PitchTable::column<&StatTracker::Pitch::db>(),
+    PitchTable::column<&StatTracker::Pitch::potential_db>(),
+    PitchTable::column<&StatTracker::Pitch::pitch_result>(),
+    PitchTable::column<&StatTracker::Pitch::type_of_swing>(),
+};
+
+constexpr std::array cContactSchema = {
+    ContactTable::column<&StatTracker::Contact::power>(),
+    ContactTable::column<&StatTracker::Contact::vert_angle>(),
+    ContactTable::column<&StatTracker::Contact::horiz_angle>(),
+    ContactTable::column<&StatTracker::Contact::ball_x_velo>(),
+    ContactTable::column<&StatTracker::Contact::ball_y_velo>(),
+    ContactTable::column<&StatTracker::Contact::ball_z_velo>(),
+    ContactTable::column<&StatTracker::Contact::ball_contact_x_pos>(),
+    ContactTable::column<&StatTracker::Contact::ball_contact_z_pos>(),
+    ContactTable::column<&StatTracker::Contact::contact_absolute>(),
+    ContactTable::column<&StatTracker::Contact::contact_quality>(),
+    ContactTable::column<&StatTracker::Contact::rng1>(),
+    ContactTable::column<&StatTracker::Contact::rng2>(),
+    ContactTable::column<&StatTracker::Contact::rng3>(),
+    ContactTable::column<&StatTracker::Contact::type_of_contact>(),
+    ContactTable::column<&StatTracker::Contact::moon_shot>(),
+    ContactTable::column<&StatTracker::Contact::charge_power_up>(),
+    ContactTable::column<&StatTracker::Contact::charge_power_down>(),
+    ContactTable::column<&StatTracker::Contact::input_direction_stick>(),
+    ContactTable::column<&StatTracker::Contact::input_direction_push_pull>(),
+    ContactTable::column<&StatTracker::Contact::frame_of_swing>(),
+    ContactTable::column<&StatTracker::Contact::ball_x_pos>(),
+    ContactTable::column<&StatTracker::Contact::ball_y_pos>(),
+    ContactTable::column<&StatTracker::Contact::ball_z_pos>(),
+    ContactTable::column<&StatTracker::Contact::ball_max_height>(),
+    ContactTable::column<&StatTracker::Contact::ball_hang_time>(),
+    ContactTable::column<&StatTracker::Contact::primary_contact_result>(),
+    ContactTable::column<&StatTracker::Contact::secondary_contact_result>(),
+};
+
+constexpr std::array cFielderSchema = {
+    FielderTable::column<&StatTracker::Fielder::fielder_roster_loc>(),
+    FielderTable::column<&StatTracker::Fielder::fielder_pos>(),
+    FielderTable::column<&StatTracker::Fielder::fielder_char_id>(),
+    FielderTable::column<&StatTracker::Fielder::fielder_swapped_for_batter>(),
+    FielderTable::column<&StatTracker::Fielder::fielder_action>(),
+    FielderTable::column<&StatTracker::Fielder::fielder_jump>(),
+    FielderTable::column<&StatTracker::Fielder::fielder_manual_select_arg>(),
+    FielderTable::column<&StatTracker::Fielder::fielder_x_pos>(),
+    FielderTable::column<&StatTracker::Fielder::fielder_y_pos>(),
+    FielderTable::column<&StatTracker::Fielder::fielder_z_pos>(),
+    FielderTable::column<&StatTracker::Fielder::bobble>(),
+};
+
+//Loads row into part, or clears part if there is no row
+template <typename Table, typename T>
+void loadOptional(const Table& table, u32 row, u32 no_row, std::optional<T>& part){
+    if (row == no_row){
+        part.reset();
+        return;
+    }
+    if (!part.has_value()){
+        part.emplace();
+    }
+    table.load(row, part.value());
+}
+}
+
+const StatTracker::EventSchema& StatTracker::getEventSchema(){
+    static const EventSchema schema = {cEventSchema, cRunnerSchema, cPitchSchema, cContactSchema, cFielderSchema};
+    return schema;
+}
+
+StatTracker::EventLog::EventLog() :
+    m_events(cEventSchema), m_runners(cRunnerSchema), m_pitches(cPitchSchema),
+    m_contacts(cContactSchema), m_fielders(cFielderSchema)
+{
+}
+
+void StatTracker::EventLog::append(const Event& event){
+    const auto append_fielder = [this](const std::optional<Fielder>& fielder) {
+        return fielder.has_value() ? m_fielders.append(fielder.value()) : cNoRow;
+    };
+
+    std::array<u32, cNumOfBases> runner_rows;
+    const std::array<const std::optional<Runner>*, cNumOfBases> runners = {
+        &event.runner_batter, &event.runner_1, &event.runner_2, &event.runner_3};
+    for (int base = 0; base < cNumOfBases; ++base){
+        runner_rows[base] = runners[base]->has_value() ? m_runners.append(runners[base]->value()) : cNoRow;
+    }
+
+    u32 pitch_row = cNoRow;
+    if (event.pitch.has_value()){
+        const Pitch& pitch = event.pitch.value();
+        pitch_row = m_pitches.append(pitch);
+
+        u32 contact_row = cNoRow;
+        if (pitch.contact.has_value()){
+            const Contact& contact = pitch.contact.value();
+            contact_row = m_contacts.append(contact);
+            m_contact_fielders.push_back({append_fielder(contact.first_fielder), append_fielder(contact.collect_fielder)});
+        }
+        m_pitch_contact.push_back(contact_row);
+    }
+
+    m_events.append(event);
+    m_event_runners.push_back(runner_rows);
+    m_event_pitch.push_back(pitch_row);
+}
+
+void StatTracker::EventLog::load(u32 row, Event& out) const{
+    m_events.load(row, out);
+
+    const std::array<std::optional<Runner>*, cNumOfBases> runners = {
+        &out.runner_batter, &out.runner_1, &out.runner_2, &out.runner_3};
+    for (int base = 0; base < cNumOfBases; ++base){
+        loadOptional(m_runners, m_event_runners[row][base], cNoRow, *runners[base]);
+    }
+
+    const u32 pitch_row = m_event_pitch[row];
+    loadOptional(m_pitches, pitch_row, cNoRow, out.pitch);
+    if (pitch_row == cNoRow){
+        return;
+    }
+
+    const u32 contact_row = m_pitch_contact[pitch_row];
+    loadOptional(m_contacts, contact_row, cNoRow, out.pitch->contact);
+    if (contact_row == cNoRow){
+        return;
+    }
+
+    loadOptional(m_fielders, m_contact_fielders[contact_row][0], cNoRow, out.pitch->contact->first_fielder);
+    loadOptional(m_fielders, m_contact_fielders[contact_row][1], cNoRow, out.pitch->contact->collect_fielder);
+}
+
+u16 StatTracker::EventLog::getEventNum(u32 row) const{
+    return static_cast<u16>(m_events.get(row, 0));
+}
+
+u8 StatTracker::EventLog::getInning(u32 row) const{
+    return static_cast<u8>(m_events.get(row, 1));
+}
+
+void StatTracker::EventLog::clear(){
+    m_events.clear();
+    m_runners.clear();
+    m_pitches.clear();
+    m_contacts.clear();
+    m_fielders.clear();
+    m_event_runners.clear();
+    m_event_pitch.clear();
+    m_pitch_contact.clear();
+    m_contact_fielders.clear();
+}
+
+size_t StatTracker::EventLog::memoryUsage() const{
+    return sizeof(*this) - sizeof(m_events) - sizeof(m_runners) - sizeof(m_pitches) -
+           sizeof(m_contacts) - sizeof(m_fielders) +
+           m_events.memoryUsage() + m_runners.memoryUsage() + m_pitches.memoryUsage() +
+           m_contacts.memoryUsage() + m_fielders.memoryUsage() +
+           m_event_runners.capacity() * sizeof(m_event_runners[0]) +
+           m_event_pitch.capacity() * sizeof(u32) + m_pitch_contact.capacity() * sizeof(u32) +
+           m_contact_fielders.capacity() * sizeof(m_contact_fielders[0]);
+}
+
+StatTracker::StatTracker(Mode mode) : m_offline(mode == Mode::Offline)
+{
+    buildReadPlan();
+
+    //Only games played live are submitted
+    if (mode != Mode::Online) {
+        return;
+    }
+
+    StatSubmitter::Settings settings;
+    settings.spool_dir = File::GetUserPath(D_MSSBFILES_IDX) + "Spool" DIR_SEP;
+
+    m_submitter = std::make_unique<StatSubmitter>(std::move(settings), StatSubmitter::SendFunction(),
+        [](u32 game_id, bool accepted) {
+            if (accepted) {
+                OSD::AddTypedMessage(OSD::MessageType::GameStateInfo, "Done submitting game",
+                                     5000, OSD::Color::GREEN);
+            }
+            else {
+                OSD::AddTypedMessage(OSD::MessageType::GameStateInfo,
+                                     "Could not submit game. It will be retried next time Rio starts",
+                                     5000, OSD::Color::RED);
+            }
+        }
+    );
+}
+
+StatTracker::~StatTracker() = default;
+
 void StatTracker::Run(const Core::CPUThreadGuard& guard)
 {
+    //Most frames are spent waiting for the next pitch or at-bat. In event driven mode those frames
+    //only compare a few trigger bytes. The debug overlay is redrawn every frame, so it always polls
+    if (Config::Get(Config::MAIN_STAT_TRACKER_EVENT_DRIVEN) && !Config::Get(Config::MAIN_ENABLE_DEBUGGING)){
+        if (!triggersChanged(guard)) { return; }
+    }
+    const std::pair<GAME_STATE, EVENT_STATE> states = {m_game_state, m_event_state};
+
+    //Snapshot everything the tracker looks at once, instead of translating every field through the MMU
+    m_read_plan.capture(guard);
     lookForTriggerEvents(guard);
+    //Anything called outside of Run (quit, crash dump) reads live memory
+    m_read_plan.invalidate();
+
+    //A run that did not move either state machine will do the same until a trigger changes
+    if (states == std::pair{m_game_state, m_event_state} && isWaitingOnTriggers()){
+        m_waiting_states = states;
+    }
+    else{
+        m_waiting_states.reset();
+    }
+}
+
+bool StatTracker::triggersChanged(const Core::CPUThreadGuard& guard)
+{
+    if (!m_trigger_plan.capture(guard)){
+        m_trigger_values.clear();
+        return true;
+    }
+
+    const std::span<const u8> values = m_trigger_plan.getSnapshot();
+    if (!std::equal(values.begin(), values.end(), m_trigger_values.begin(), m_trigger_values.end())){
+        m_trigger_values.assign(values.begin(), values.end());
+        return true;
+    }
+    //The states can also be changed from outside of Run (init, dumpGame)
+    return m_waiting_states != std::pair{m_game_state, m_event_state};
+}
+
+bool StatTracker::isWaitingOnTriggers() const
+{
+    if (m_game_state == GAME_STATE::PREGAME) { return true; }
+    if (m_game_state != GAME_STATE::INGAME) { return false; }
+
+    //The other event states sample the ball, fielders and runners every frame of a play
+    switch (m_event_state){
+        case EVENT_STATE::INIT_EVENT:
+        case EVENT_STATE::WAITING_FOR_EVENT:
+        case EVENT_STATE::PLAY_OVER:
+        case EVENT_STATE::FINAL_RESULT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void StatTracker::buildReadPlan()
+{
+    const u32 cNumOfPorts = 4;
+
+    //Game and at-bat state, checked every frame
+    for (u32 adr : {aEndOfGameFlag, aWhoQuit, aGameControlStateCurr, aGameControlStatePrev,
+                    aAB_PitchThrown, aAB_ContactResult, aAB_ContactMade, aAB_PickoffAttempt,
+                    aStadiumId, aTeam0_Captain_Roster_Loc, aTeam1_Captain_Roster_Loc, aInningsSelected,
+                    aAB_BatterPort, aAB_PitcherPort, aAB_BatterRosterID, aAB_Inning, aAB_HalfInning,
+                    aAB_Balls, aAB_Strikes, aAB_Outs, aAB_P1_Stars, aAB_P2_Stars, aAB_IsStarChance,
+                    aAB_ChemLinksOnBase, aAB_PitcherRosterID, aAB_PitcherID, aAB_PitcherHandedness,
+                    aAB_PitchType, aAB_ChargePitchType, aAB_StarPitch_Captain, aAB_StarPitch_NonCaptain,
+                    aAB_PitchSpeed, aAB_PitcherHasCtrlofPitch, aAB_TypeOfSwing, aAB_BatterHand,
+                    aAB_StarSwing, aAB_MissedBall, aAB_Miss_SwingOrBunt, aAB_Miss_AnyStrike, aAB_AnySwing,
+                    aAB_HitByPitch, aAB_FinalResult, aAB_RBI, aFielder_ManualSelectArg,
+                    0x800e874c, 0x800e874d}){
+        m_read_plan.add(adr, sizeof(u8));
+    }
+    for (u32 adr : {aAwayTeam_Score, aHomeTeam_Score}){
+        m_read_plan.add(adr, sizeof(u16));
+    }
+    for (u32 adr : {aGameId, aAB_PitchCurveInput, aAB_PitchBallPosZStrikezone, aAB_PitchStrikezoneEdgeLeft,
+                    aAB_PitchStrikezoneEdgeRight, 0x80892990u, 0x80892994u}){
+        m_read_plan.add(adr, sizeof(u32));
+    }
+    m_read_plan.addTable(aAB_ControlStickInput, sizeof(u16), cControl_Offset, cNumOfPorts);
+
+    //Fielder and runner tables, scanned every frame while the ball is in play
+    for (u32 adr : {aFielder_ControlStatus, aFielder_CharId, aFielder_RosterLoc, aFielder_AnyJump,
+                    aFielder_Action, aFielder_Bobble, aFielder_Knockout}){
+        m_read_plan.addTable(adr, sizeof(u8), cFielder_Offset, u32{cRosterSize});
+    }
+    for (u32 adr : {aFielder_Pos_X, aFielder_Pos_Y, aFielder_Pos_Z}){
+        m_read_plan.addTable(adr, sizeof(u32), cFielder_Offset, u32{cRosterSize});
+    }
+    for (u32 adr : {aRunner_RosterLoc, aRunner_CharId, aRunner_OutType, aRunner_OutLoc,
+                    aRunner_CurrentBase, aRunner_Stealing}){
+        m_read_plan.addTable(adr, sizeof(u8), cRunner_Offset, u32{cNumOfBases});
+    }
+    m_read_plan.addTable(aRunner_BasepathPercentage, sizeof(u32), cRunner_Offset, u32{cNumOfBases});
+
+    //Everything read through TrackerAdr
+    Event event;
+    event.num_outs_during_play.add_to(m_read_plan);
+    Pitch pitch;
+    pitch.bat_contact_x_pos.add_to(m_read_plan);
+    pitch.bat_contact_z_pos.add_to(m_read_plan);
+    Contact contact;
+    for (const auto* field : {&contact.power, &contact.vert_angle, &contact.horiz_angle,
+                              &contact.rng1, &contact.rng2, &contact.rng3, &contact.frame_of_swing,
+                              &contact.ball_hang_time}){
+        field->add_to(m_read_plan);
+    }
+    for (const auto* field : {&contact.ball_x_velo, &contact.ball_y_velo, &contact.ball_z_velo,
+                              &contact.ball_contact_x_pos, &contact.ball_contact_z_pos,
+                              &contact.contact_absolute, &contact.contact_quality,
+                              &contact.charge_power_up, &contact.charge_power_down,
+                              &contact.ball_x_pos, &contact.ball_y_pos, &contact.ball_z_pos,
+                              &contact.ball_max_height}){
+        field->add_to(m_read_plan);
+    }
+    for (const auto* field : {&contact.type_of_contact, &contact.moon_shot, &contact.input_direction_push_pull}){
+        field->add_to(m_read_plan);
+    }
+
+    m_read_plan.build();
+
+    //Everything the waiting states of the state machines branch on
+    m_trigger_plan.add(aGameId, sizeof(u32));
+    for (u32 adr : {aGameControlStateCurr, aGameControlStatePrev, aEndOfGameFlag, aAB_PitchThrown,
+                    aAB_PickoffAttempt}){
+        m_trigger_plan.add(adr, sizeof(u8));
+    }
+    m_trigger_plan.build();
 }
 
 void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
@@ -168,11 +544,11 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
                 //Create new event, collect runner data
 
                 //Capture the rising edge of the AtBat Scene
-        if (PowerPC::MMU::HostRead_U8(guard, aGameControlStateCurr) == 0x1 &&
-            PowerPC::MMU::HostRead_U8(guard, aGameControlStatePrev) != 0x1)
+        if (m_read_plan.read<u8>(guard, aGameControlStateCurr) == 0x1 &&
+            m_read_plan.read<u8>(guard, aGameControlStatePrev) != 0x1)
         {
 
-                    m_game_info.events[m_game_info.event_num] = Event();
+                    m_game_info.current_event.emplace();
                     m_game_info.getCurrentEvent().event_num = m_game_info.event_num;
 
                     logEventState(guard, m_game_info.getCurrentEvent());
@@ -192,19 +568,18 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
 
                     if (!m_fielder_tracker[!m_game_info.getCurrentEvent().half_inning].initialized){
                         std::cout << " Initializing fielders for team: " << std::to_string(!m_game_info.getCurrentEvent().half_inning) << "\n";
-                        m_fielder_tracker[!m_game_info.getCurrentEvent().half_inning].initTracker(guard, !m_game_info.getCurrentEvent().half_inning);
+                        m_fielder_tracker[!m_game_info.getCurrentEvent().half_inning].initTracker(guard, m_read_plan, !m_game_info.getCurrentEvent().half_inning);
                     }
 
                     m_event_state = EVENT_STATE::WAITING_FOR_EVENT;
 
                     std::cout << "Init event " << std::to_string(m_game_info.event_num) << "\n";
                 }
-                else if (PowerPC::MMU::HostRead_U32(guard, aGameId) == 0){
+                else if (m_read_plan.read<u32>(guard, aGameId) == 0){
                     onGameQuit(guard);
 
                     //Remove current event, wasn't finished
-                    auto it = m_game_info.events.find(m_game_info.event_num);
-                    m_game_info.events.erase(it);
+                    m_game_info.current_event.reset();
 
                     m_event_state = EVENT_STATE::GAME_OVER;
                 }
@@ -212,12 +587,11 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
             //Look for Pitch
             case (EVENT_STATE::WAITING_FOR_EVENT):
                 //Handle quit to main menu
-                if (PowerPC::MMU::HostRead_U32(guard, aGameId) == 0){
+                if (m_read_plan.read<u32>(guard, aGameId) == 0){
                     onGameQuit(guard);
 
                     //Remove current event, wasn't finished
-                    auto it = m_game_info.events.find(m_game_info.event_num);
-                    m_game_info.events.erase(it);
+                    m_game_info.current_event.reset();
 
                     m_event_state = EVENT_STATE::GAME_OVER;
                     break;
@@ -233,37 +607,34 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
                 //1. Are runners stealing and pitcher stepped off the mound
                 //2. Has pitch started?
                 //3. Has game been paused, reinit 
-                if (PowerPC::MMU::HostRead_U8(guard, aGameControlStateCurr) == 0xb){
+                if (m_read_plan.read<u8>(guard, aGameControlStateCurr) == 0xb){
                     std::cout << "Game paused, need to re-init event " << std::to_string(m_game_info.event_num) << "\n";
                     logGameInfo(guard);
                     updateOngoingGame(m_game_info.getCurrentEvent());
                     m_event_state = EVENT_STATE::INIT_EVENT;
                 }
                 //Watch for Runners Stealing
-                if (PowerPC::MMU::HostRead_U8(guard, aAB_PitchThrown) || PowerPC::MMU::HostRead_U8(guard, aAB_PickoffAttempt)){
+                if (m_read_plan.read<u8>(guard, aAB_PitchThrown) || m_read_plan.read<u8>(guard, aAB_PickoffAttempt)){
                     //If HUD not produced for this event, produce HUD JSON
                     logGameInfo(guard);
 
                     if (m_game_info.getCurrentEvent().write_hud_ab.first) {
-                        std::string hud_file_path = File::GetUserPath(D_HUDFILES_IDX) + "decoded.hud.json";
-                        std::string json = getHUDJSON(std::to_string(m_game_info.event_num) + "a", m_game_info.getCurrentEvent(), m_game_info.previous_state, true);
-                        File::Delete(hud_file_path);
-                        File::WriteStringToFile(hud_file_path, json);
+                        publishHUD(false);
                         //No longer need to write HUD B
                         m_game_info.getCurrentEvent().write_hud_ab.first = false;
                     }
 
-                    if(PowerPC::MMU::HostRead_U8(guard, aAB_PitchThrown)){
+                    if(m_read_plan.read<u8>(guard, aAB_PitchThrown)){
                         std::cout << "Pitch detected!\n";
 
                         //Check for fielder swaps
                         std::cout << " Evaluating fielders for team: " << std::to_string(!m_game_info.getCurrentEvent().half_inning) << "\n";
-                        m_fielder_tracker[!m_game_info.getCurrentEvent().half_inning].evaluateFielders(guard);
+                        m_fielder_tracker[!m_game_info.getCurrentEvent().half_inning].evaluateFielders(guard, m_read_plan);
 
                         m_game_info.getCurrentEvent().pitch = std::make_optional(Pitch());
 
                         //Check if pitcher was at center of mound, if so this is a potential DB
-                        if (PowerPC::MMU::HostRead_U8(guard, aFielder_Pos_X) == 0){
+                        if (m_read_plan.read<u8>(guard, aFielder_Pos_X) == 0){
                             m_game_info.getCurrentEvent().pitch->potential_db = true;
                             std::cout << "Potential DB!\n";
                         }
@@ -271,7 +642,7 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
                         //Pitch has started
                         m_event_state = EVENT_STATE::PITCH_RESULT;
                     }
-                    else if(PowerPC::MMU::HostRead_U8(guard, aAB_PickoffAttempt)) {
+                    else if(m_read_plan.read<u8>(guard, aAB_PickoffAttempt)) {
                         std::cout << "Pick of attempt detected!\n";
                         m_event_state = EVENT_STATE::MONITOR_RUNNERS;
                         m_game_info.getCurrentEvent().pick_off_attempt = true;
@@ -284,8 +655,8 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
                 //DBs
                 //If the pitcher started in the center of the mound this is a potential DB
                 //If the ball curves at any point it is no longer a DB
-                if (m_game_info.getCurrentEvent().pitch->potential_db && (PowerPC::MMU::HostRead_U8(guard, aAB_PitcherHasCtrlofPitch) == 1)) {
-                    if (floatConverter(PowerPC::MMU::HostRead_U32(guard, aAB_PitchCurveInput)) != 0) {
+                if (m_game_info.getCurrentEvent().pitch->potential_db && (m_read_plan.read<u8>(guard, aAB_PitcherHasCtrlofPitch) == 1)) {
+                    if (floatConverter(m_read_plan.read<u32>(guard, aAB_PitchCurveInput)) != 0) {
                         std::cout << "No longer potential DB!\n";
                         m_game_info.getCurrentEvent().pitch->potential_db = false;
                     }
@@ -306,28 +677,28 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
 
                 //Conditions to leave the state: Contact, Ball beyond batter, HBP
                 //Contact
-                if (PowerPC::MMU::HostRead_U8(guard, aAB_ContactMade)){
+                if (m_read_plan.read<u8>(guard, aAB_ContactMade)){
                     logPitch(guard, m_game_info.getCurrentEvent());
                     logContact(guard, m_game_info.getCurrentEvent());
                     m_event_state = EVENT_STATE::CONTACT_RESULT;
                 }
                 //If the ball gets behind the batter while mid pitch OR play flag is false (safety incase we miss the first cond), record miss
-                else if (PowerPC::MMU::HostRead_U8(guard, aAB_MissedBall)){
+                else if (m_read_plan.read<u8>(guard, aAB_MissedBall)){
                     logPitch(guard, m_game_info.getCurrentEvent());
                     m_event_state = EVENT_STATE::MONITOR_RUNNERS;
                 }
-                else if (PowerPC::MMU::HostRead_U8(guard, aAB_HitByPitch) == 1){
+                else if (m_read_plan.read<u8>(guard, aAB_HitByPitch) == 1){
                     //Log HBP
                     logPitch(guard, m_game_info.getCurrentEvent());
-                    if (!PowerPC::MMU::HostRead_U8(guard, aAB_PitchThrown)) {
-                        m_game_info.getCurrentEvent().result_of_atbat = PowerPC::MMU::HostRead_U8(guard, aAB_FinalResult);
+                    if (!m_read_plan.read<u8>(guard, aAB_PitchThrown)) {
+                        m_game_info.getCurrentEvent().result_of_atbat = m_read_plan.read<u8>(guard, aAB_FinalResult);
                         m_event_state = EVENT_STATE::PLAY_OVER;
                     }
                 }
 
                 break;
             case (EVENT_STATE::CONTACT_RESULT):                
-                if (PowerPC::MMU::HostRead_U8(guard, aAB_ContactResult) != 0){
+                if (m_read_plan.read<u8>(guard, aAB_ContactResult) != 0){
                     //Indicate that pitch resulted in contact and log contact details
                     m_game_info.getCurrentEvent().pitch->pitch_result = 6;
                     logContactResult(guard, &m_game_info.getCurrentEvent().pitch->contact.value()); //Land vs Caught vs Foul, Landing POS.
@@ -343,9 +714,9 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
                 else{
                     Contact* contact = &m_game_info.getCurrentEvent().pitch->contact.value();
                     //Final Result Ball
-                    contact->ball_x_pos.read_value(guard);
-                    contact->ball_y_pos.read_value(guard);
-                    contact->ball_z_pos.read_value(guard);
+                    contact->ball_x_pos.read_value(guard, m_read_plan);
+                    contact->ball_y_pos.read_value(guard, m_read_plan);
+                    contact->ball_z_pos.read_value(guard, m_read_plan);
                 }
                 //Could bobble before the ball hits the ground.
                 //Search for bobble if we haven't recorded one yet and the ball hasn't been collected yet
@@ -376,14 +747,14 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
                 }
 
                 //Break out if play ends without fielding the ball (HR or other play ending hit)
-                if (!PowerPC::MMU::HostRead_U8(guard, aAB_PitchThrown)) {
-                    m_game_info.getCurrentEvent().result_of_atbat = PowerPC::MMU::HostRead_U8(guard, aAB_FinalResult);
+                if (!m_read_plan.read<u8>(guard, aAB_PitchThrown)) {
+                    m_game_info.getCurrentEvent().result_of_atbat = m_read_plan.read<u8>(guard, aAB_FinalResult);
                     m_event_state = EVENT_STATE::PLAY_OVER;
                 }
                 break;
             case (EVENT_STATE::MONITOR_RUNNERS):
-                if (!PowerPC::MMU::HostRead_U8(guard, aAB_PitchThrown) && !PowerPC::MMU::HostRead_U8(guard, aAB_PickoffAttempt)){
-                    m_game_info.getCurrentEvent().result_of_atbat = PowerPC::MMU::HostRead_U8(guard, aAB_FinalResult);
+                if (!m_read_plan.read<u8>(guard, aAB_PitchThrown) && !m_read_plan.read<u8>(guard, aAB_PickoffAttempt)){
+                    m_game_info.getCurrentEvent().result_of_atbat = m_read_plan.read<u8>(guard, aAB_FinalResult);
                     m_event_state = EVENT_STATE::PLAY_OVER;
                 }
                 else {
@@ -400,8 +771,8 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
                 }
                 break;
             case (EVENT_STATE::PLAY_OVER):
-                if (!PowerPC::MMU::HostRead_U8(guard, aAB_PitchThrown)){
-                    m_game_info.getCurrentEvent().rbi = PowerPC::MMU::HostRead_U8(guard, aAB_RBI);
+                if (!m_read_plan.read<u8>(guard, aAB_PitchThrown)){
+                    m_game_info.getCurrentEvent().rbi = m_read_plan.read<u8>(guard, aAB_RBI);
 
                     //runner_batter out, contact_secondary
                     logFinalResults(guard, m_game_info.getCurrentEvent());
@@ -436,10 +807,7 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
                     //Store current state as previous state
                     m_game_info.previous_state = m_game_info.getCurrentEvent();
 
-                    std::string hud_file_path = File::GetUserPath(D_HUDFILES_IDX) + "decoded.hud.json";
-                    std::string json = getHUDJSON(std::to_string(m_game_info.event_num) + "b", m_game_info.getCurrentEvent(), m_game_info.previous_state, true);
-                    File::Delete(hud_file_path);
-                    File::WriteStringToFile(hud_file_path, json);
+                    publishHUD(true);
 
                     //No longer need to write HUD B
                     m_game_info.getCurrentEvent().write_hud_ab.second = false;
@@ -447,8 +815,9 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
 
                 // === Transitions ===
 
-                if (PowerPC::MMU::HostRead_U8(guard, aGameControlStateCurr) == 0x7){
-                    //Increment event count
+                if (m_read_plan.read<u8>(guard, aGameControlStateCurr) == 0x7){
+                    //Store the finished event and increment event count
+                    finishCurrentEvent();
                     ++m_game_info.event_num;
                     //Save position as prev position
                     u8 fielding_team_id = (m_game_info.previous_state.value().half_inning == 1) ? 0 : 1;
@@ -458,18 +827,20 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
                     m_game_info.update_ongoing_game = true;
                     std::cout << "Logging Final Result\n" << "Starting next AB\n\n";
                 }
-                else if (PowerPC::MMU::HostRead_U8(guard, aGameControlStateCurr) == 0x1 && !m_game_info.previous_state.value().pitch.has_value()){
-                    //Increment event count
+                else if (m_read_plan.read<u8>(guard, aGameControlStateCurr) == 0x1 && !m_game_info.previous_state.value().pitch.has_value()){
+                    //Store the finished event and increment event count
+                    finishCurrentEvent();
                     ++m_game_info.event_num;
                     m_event_state = EVENT_STATE::INIT_EVENT;
                     std::cout << "Logging Final Result\n" << "Pickoff over\n\n";
                 }
-                else if ((PowerPC::MMU::HostRead_U8(guard, aGameControlStateCurr) == 0xE) || (PowerPC::MMU::HostRead_U8(guard, aEndOfGameFlag) == 1)){ //MVP screen
+                else if ((m_read_plan.read<u8>(guard, aGameControlStateCurr) == 0xE) || (m_read_plan.read<u8>(guard, aEndOfGameFlag) == 1)){ //MVP screen
                     //Increment event count
                     m_event_state = EVENT_STATE::GAME_OVER;
                     std::cout << "Logging Final Result\n" << "Game Over\n\n";
                 }
                 else if ((m_game_info.previous_state.value().balls < 4 || m_game_info.previous_state.value().strikes < 3) && m_game_info.getCurrentEvent().result_of_atbat == 0) {
+                    finishCurrentEvent();
                     ++m_game_info.event_num;
                     m_event_state = EVENT_STATE::INIT_EVENT;
                     std::cout << "Logging Final Result\n" << "Starting next pitch of AB\n\n";
@@ -493,14 +864,16 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
     switch (m_game_state){ // crashed here in debugging "Access violation reading location 0xFFFFFFFFFFFFFFFF"
         case (GAME_STATE::PREGAME):
             //Start recording when GameId is set AND record button is pressed AND game has started
-            //std::cout << std::hex << "GameId=" << PowerPC::MMU::HostRead_U32(guard, aGameId) << "GameState=" <<  PowerPC::MMU::HostRead_U8(aGameControlStateCurr) << '\n';
-            if ((PowerPC::MMU::HostRead_U32(guard, aGameId) != 0) && (PowerPC::MMU::HostRead_U8(guard, aGameControlStateCurr) == 0x5) ) {
-                m_game_info.game_id = PowerPC::MMU::HostRead_U32(guard, aGameId);
+            //std::cout << std::hex << "GameId=" << m_read_plan.read<u32>(guard, aGameId) << "GameState=" <<  PowerPC::MMU::HostRead_U8(aGameControlStateCurr) << '\n';
+            if ((m_read_plan.read<u32>(guard, aGameId) != 0) && (m_read_plan.read<u8>(guard, aGameControlStateCurr) == 0x5) ) {
+                m_game_info.game_id = m_read_plan.read<u32>(guard, aGameId);
                 //Sample settings
                 m_game_info.netplay = m_state.m_netplay_session;
                 m_game_info.netplay_opponent_alias = m_state.m_netplay_opponent_alias;
                 m_game_info.tag_set_id =
                     m_state.m_netplay_session ? m_state.tag_set_id_netplay : m_state.tag_set_id_local;
+                m_game_info.rio_version = Common::GetRioRevStr();
+                openStatFile();
 
 
                 m_game_state = GAME_STATE::INGAME;
@@ -518,41 +891,18 @@ void StatTracker::lookForTriggerEvents(const Core::CPUThreadGuard& guard)
                 logGameInfo(guard);
                 std::cout << "Logging Character Stats\n";
 
-                std::string jsonPath = getStatJsonPath("decoded.");
-                std::string json = getStatJSON(true);
-                    
-                File::WriteStringToFile(jsonPath, json);
-
-                jsonPath = getStatJsonPath("");
-                json = getStatJSON(false, true);
                 //TODO: See if user has signed up for beta test features in future
-                File::WriteStringToFile(jsonPath, json);
+                const bool submit = shouldSubmitGame();
+                writeGameFiles("decoded.", "", submit);
+                closeStatFile(true);
 
-                //File::WriteStringToFile(jsonPath, json);
                 //https://api.projectrio.app/populate_db
-
-                //Print server warning message
-                OSD::AddTypedMessage(OSD::MessageType::GameStateInfo, fmt::format(
-                    "Submitting game to server \n",
-                    "DO NOT LEAVE THE GAME OR CLOSE RIO"           
-                ), 500, OSD::Color::RED);
-                
-                json = getStatJSON(false, false);
-                if (shouldSubmitGame()) {
-                    const Common::HttpRequest::Response response =
-                    m_http.Post("https://api.projectrio.app/populate_db/", json,
-                        {
-                            {"Content-Type", "application/json"},
-                        }
-                    );
-
-                    // Print server warning message
-                    OSD::AddTypedMessage(OSD::MessageType::GameStateInfo,
-                                         fmt::format("Done submitting game \n", "SAFE TO QUIT"),
-                                         5000, OSD::Color::GREEN);
+                if (submit) {
+                    OSD::AddTypedMessage(OSD::MessageType::GameStateInfo, "Submitting game to server",
+                                         2000, OSD::Color::YELLOW);
                 }
 
-                std::cout << "Logging to " << jsonPath << "\n";
+                std::cout << "Logging to " << getStatJsonPath("") << "\n";
                 std::cout << "INGAME->ENDGAME\n";
 
 
@@ -583,10 +933,10 @@ void StatTracker::logGameInfo(const Core::CPUThreadGuard& guard){
     m_game_info.end_local_date_time = std::asctime(std::localtime(&unix_time));
     m_game_info.end_local_date_time.pop_back();
 
-    m_game_info.stadium = PowerPC::MMU::HostRead_U8(guard, aStadiumId);
+    m_game_info.stadium = m_read_plan.read<u8>(guard, aStadiumId);
 
-    m_game_info.innings_selected = PowerPC::MMU::HostRead_U8(guard, aInningsSelected);
-    m_game_info.innings_played = PowerPC::MMU::HostRead_U8(guard, aAB_Inning);
+    m_game_info.innings_selected = m_read_plan.read<u8>(guard, aInningsSelected);
+    m_game_info.innings_played = m_read_plan.read<u8>(guard, aAB_Inning);
 
     ////Captains
     //if (m_game_info.away_port == m_game_info.team0_port){
@@ -598,8 +948,8 @@ void StatTracker::logGameInfo(const Core::CPUThreadGuard& guard){
     //    m_game_info.home_captain = PowerPC::MMU::HostRead_U8(aTeam0_Captain);
     //}
 
-    m_game_info.away_score = PowerPC::MMU::HostRead_U16(guard, aAwayTeam_Score);
-    m_game_info.home_score = PowerPC::MMU::HostRead_U16(guard, aHomeTeam_Score);
+    m_game_info.away_score = m_read_plan.read<u16>(guard, aAwayTeam_Score);
+    m_game_info.home_score = m_read_plan.read<u16>(guard, aHomeTeam_Score);
 
     for (int team=0; team < cNumOfTeams; ++team){
         for (int roster=0; roster < cRosterSize; ++roster){
@@ -621,27 +971,27 @@ void StatTracker::logDefensiveStats(const Core::CPUThreadGuard& guard, int in_te
     
     auto& stat = m_game_info.character_summaries[idx][roster_id].end_game_defensive_stats;
 
-    m_game_info.character_summaries[idx][roster_id].is_starred = PowerPC::MMU::HostRead_U8(guard, aPitcher_IsStarred + is_starred_offset);
-
-    stat.batters_faced       = PowerPC::MMU::HostRead_U8(guard, aPitcher_BattersFaced + offset);
-    stat.runs_allowed        = PowerPC::MMU::HostRead_U16(guard, aPitcher_RunsAllowed + offset);
-    stat.earned_runs         = PowerPC::MMU::HostRead_U16(guard, aPitcher_RunsAllowed + offset);
-    stat.batters_walked      = PowerPC::MMU::HostRead_U16(guard, aPitcher_BattersWalked + offset);
-    stat.batters_hit         = PowerPC::MMU::HostRead_U16(guard, aPitcher_BattersHit + offset);
-    stat.hits_allowed        = PowerPC::MMU::HostRead_U16(guard, aPitcher_HitsAllowed + offset);
-    stat.homeruns_allowed    = PowerPC::MMU::HostRead_U16(guard, aPitcher_HRsAllowed + offset);
-    stat.pitches_thrown      = PowerPC::MMU::HostRead_U16(guard, aPitcher_PitchesThrown + offset);
-    stat.stamina             = PowerPC::MMU::HostRead_U16(guard, aPitcher_Stamina + offset);
-    stat.was_pitcher         = PowerPC::MMU::HostRead_U8(guard, aPitcher_WasPitcher + offset);
-    stat.batter_outs         = PowerPC::MMU::HostRead_U8(guard, aPitcher_BatterOuts + offset);
-    stat.outs_pitched        = PowerPC::MMU::HostRead_U8(guard, aPitcher_OutsPitched + offset);
-    stat.strike_outs         = PowerPC::MMU::HostRead_U8(guard, aPitcher_StrikeOuts + offset);
-    stat.star_pitches_thrown = PowerPC::MMU::HostRead_U8(guard, aPitcher_StarPitchesThrown + offset);
+    m_game_info.character_summaries[idx][roster_id].is_starred = m_read_plan.read<u8>(guard, aPitcher_IsStarred + is_starred_offset);
+
+    stat.batters_faced       = m_read_plan.read<u8>(guard, aPitcher_BattersFaced + offset);
+    stat.runs_allowed        = m_read_plan.read<u16>(guard, aPitcher_RunsAllowed + offset);
+    stat.earned_runs         = m_read_plan.read<u16>(guard, aPitcher_RunsAllowed + offset);
+    stat.batters_walked      = m_read_plan.read<u16>(guard, aPitcher_BattersWalked + offset);
+    stat.batters_hit         = m_read_plan.read<u16>(guard, aPitcher_BattersHit + offset);
+    stat.hits_allowed        = m_read_plan.read<u16>(guard, aPitcher_HitsAllowed + offset);
+    stat.homeruns_allowed    = m_read_plan.read<u16>(guard, aPitcher_HRsAllowed + offset);
+    stat.pitches_thrown      = m_read_plan.read<u16>(guard, aPitcher_PitchesThrown + offset);
+    stat.stamina             = m_read_plan.read<u16>(guard, aPitcher_Stamina + offset);
+    stat.was_pitcher         = m_read_plan.read<u8>(guard, aPitcher_WasPitcher + offset);
+    stat.batter_outs         = m_read_plan.read<u8>(guard, aPitcher_BatterOuts + offset);
+    stat.outs_pitched        = m_read_plan.read<u8>(guard, aPitcher_OutsPitched + offset);
+    stat.strike_outs         = m_read_plan.read<u8>(guard, aPitcher_StrikeOuts + offset);
+    stat.star_pitches_thrown = m_read_plan.read<u8>(guard, aPitcher_StarPitchesThrown + offset);
 
     //Get inherent values. Doesn't strictly belong here but we need the adjusted_team_id
-    m_game_info.character_summaries[idx][roster_id].char_id = PowerPC::MMU::HostRead_U8(guard, aInGame_CharAttributes_CharId + ingame_attribute_table_offset);
-    m_game_info.character_summaries[idx][roster_id].fielding_hand = PowerPC::MMU::HostRead_U8(guard, aInGame_CharAttributes_FieldingHand + ingame_attribute_table_offset);
-    m_game_info.character_summaries[idx][roster_id].batting_hand = PowerPC::MMU::HostRead_U8(guard, aInGame_CharAttributes_BattingHand + ingame_attribute_table_offset);
+    m_game_info.character_summaries[idx][roster_id].char_id = m_read_plan.read<u8>(guard, aInGame_CharAttributes_CharId + ingame_attribute_table_offset);
+    m_game_info.character_summaries[idx][roster_id].fielding_hand = m_read_plan.read<u8>(guard, aInGame_CharAttributes_FieldingHand + ingame_attribute_table_offset);
+    m_game_info.character_summaries[idx][roster_id].batting_hand = m_read_plan.read<u8>(guard, aInGame_CharAttributes_BattingHand + ingame_attribute_table_offset);
 
 }
 
@@ -653,62 +1003,62 @@ void StatTracker::logOffensiveStats(const Core::CPUThreadGuard& guard, int in_te
 
     auto& stat = m_game_info.character_summaries[idx][roster_id].end_game_offensive_stats;
 
-    stat.at_bats          = PowerPC::MMU::HostRead_U8(guard, aBatter_AtBats + offset);
-    stat.hits             = PowerPC::MMU::HostRead_U8(guard, aBatter_Hits + offset);
-    stat.singles          = PowerPC::MMU::HostRead_U8(guard, aBatter_Singles + offset);
-    stat.doubles          = PowerPC::MMU::HostRead_U8(guard, aBatter_Doubles + offset);
-    stat.triples          = PowerPC::MMU::HostRead_U8(guard, aBatter_Triples + offset);
-    stat.homeruns         = PowerPC::MMU::HostRead_U8(guard, aBatter_Homeruns + offset);
-    stat.successful_bunts = PowerPC::MMU::HostRead_U8(guard, aBatter_BuntSuccess + offset);
-    stat.sac_flys         = PowerPC::MMU::HostRead_U8(guard, aBatter_SacFlys + offset);
-    stat.strikouts        = PowerPC::MMU::HostRead_U8(guard, aBatter_Strikeouts + offset);
-    stat.walks_4balls     = PowerPC::MMU::HostRead_U8(guard, aBatter_Walks_4Balls + offset);
-    stat.walks_hit        = PowerPC::MMU::HostRead_U8(guard, aBatter_Walks_Hit + offset);
-    stat.rbi              = PowerPC::MMU::HostRead_U8(guard, aBatter_RBI + offset);
-    stat.bases_stolen     = PowerPC::MMU::HostRead_U8(guard, aBatter_BasesStolen + offset);
-    stat.star_hits        = PowerPC::MMU::HostRead_U8(guard, aBatter_StarHits + offset);
-
-    m_game_info.character_summaries[idx][roster_id].end_game_defensive_stats.big_plays = PowerPC::MMU::HostRead_U8(guard, aBatter_BigPlays + offset);
+    stat.at_bats          = m_read_plan.read<u8>(guard, aBatter_AtBats + offset);
+    stat.hits             = m_read_plan.read<u8>(guard, aBatter_Hits + offset);
+    stat.singles          = m_read_plan.read<u8>(guard, aBatter_Singles + offset);
+    stat.doubles          = m_read_plan.read<u8>(guard, aBatter_Doubles + offset);
+    stat.triples          = m_read_plan.read<u8>(guard, aBatter_Triples + offset);
+    stat.homeruns         = m_read_plan.read<u8>(guard, aBatter_Homeruns + offset);
+    stat.successful_bunts = m_read_plan.read<u8>(guard, aBatter_BuntSuccess + offset);
+    stat.sac_flys         = m_read_plan.read<u8>(guard, aBatter_SacFlys + offset);
+    stat.strikouts        = m_read_plan.read<u8>(guard, aBatter_Strikeouts + offset);
+    stat.walks_4balls     = m_read_plan.read<u8>(guard, aBatter_Walks_4Balls + offset);
+    stat.walks_hit        = m_read_plan.read<u8>(guard, aBatter_Walks_Hit + offset);
+    stat.rbi              = m_read_plan.read<u8>(guard, aBatter_RBI + offset);
+    stat.bases_stolen     = m_read_plan.read<u8>(guard, aBatter_BasesStolen + offset);
+    stat.star_hits        = m_read_plan.read<u8>(guard, aBatter_StarHits + offset);
+
+    m_game_info.character_summaries[idx][roster_id].end_game_defensive_stats.big_plays = m_read_plan.read<u8>(guard, aBatter_BigPlays + offset);
 }
 
 void StatTracker::logEventState(const Core::CPUThreadGuard& guard, Event& in_event){
-    in_event.inning          = PowerPC::MMU::HostRead_U8(guard, aAB_Inning);
-    in_event.half_inning     = PowerPC::MMU::HostRead_U8(guard, aAB_HalfInning);
+    in_event.inning          = m_read_plan.read<u8>(guard, aAB_Inning);
+    in_event.half_inning     = m_read_plan.read<u8>(guard, aAB_HalfInning);
 
     //Figure out scores
-    in_event.away_score = PowerPC::MMU::HostRead_U16(guard, aAwayTeam_Score);
-    in_event.home_score = PowerPC::MMU::HostRead_U16(guard, aHomeTeam_Score);
+    in_event.away_score = m_read_plan.read<u16>(guard, aAwayTeam_Score);
+    in_event.home_score = m_read_plan.read<u16>(guard, aHomeTeam_Score);
 
-    in_event.balls           = PowerPC::MMU::HostRead_U8(guard, aAB_Balls);
-    in_event.strikes         = PowerPC::MMU::HostRead_U8(guard, aAB_Strikes);
-    in_event.outs            = PowerPC::MMU::HostRead_U8(guard, aAB_Outs);
+    in_event.balls           = m_read_plan.read<u8>(guard, aAB_Balls);
+    in_event.strikes         = m_read_plan.read<u8>(guard, aAB_Strikes);
+    in_event.outs            = m_read_plan.read<u8>(guard, aAB_Outs);
     
     //Figure out star ownership
     if (m_game_info.team0_port == m_game_info.away_port){
-        in_event.away_stars = PowerPC::MMU::HostRead_U8(guard, aAB_P1_Stars);
-        in_event.home_stars = PowerPC::MMU::HostRead_U8(guard, aAB_P2_Stars);
+        in_event.away_stars = m_read_plan.read<u8>(guard, aAB_P1_Stars);
+        in_event.home_stars = m_read_plan.read<u8>(guard, aAB_P2_Stars);
     }
     else {
-        in_event.away_stars = PowerPC::MMU::HostRead_U8(guard, aAB_P2_Stars);
-        in_event.home_stars = PowerPC::MMU::HostRead_U8(guard, aAB_P1_Stars);
+        in_event.away_stars = m_read_plan.read<u8>(guard, aAB_P2_Stars);
+        in_event.home_stars = m_read_plan.read<u8>(guard, aAB_P1_Stars);
     }
     
-    in_event.is_star_chance  = PowerPC::MMU::HostRead_U8(guard, aAB_IsStarChance);
-    in_event.chem_links_ob   = PowerPC::MMU::HostRead_U8(guard, aAB_ChemLinksOnBase);
+    in_event.is_star_chance  = m_read_plan.read<u8>(guard, aAB_IsStarChance);
+    in_event.chem_links_ob   = m_read_plan.read<u8>(guard, aAB_ChemLinksOnBase);
 
     //The following stamina lookup requires team_id to be in teams of team0 or team1
 
     auto batter_fielder_ports = getBatterFielderPorts(guard);
     u8 pitching_team = (batter_fielder_ports.second == m_game_info.team1_port); //1 if the pitching team is team1
-    u8 pitcher_roster_loc = PowerPC::MMU::HostRead_U8(guard, aAB_PitcherRosterID);
+    u8 pitcher_roster_loc = m_read_plan.read<u8>(guard, aAB_PitcherRosterID);
     
     //Calc the pitcher stamina offset and add it to the base stamina addr - TODO move to EventSummary
     u32 pitcherStaminaOffset = ((pitching_team * cRosterSize * c_defensive_stat_offset) + (pitcher_roster_loc * c_defensive_stat_offset));
-    in_event.pitcher_stamina = PowerPC::MMU::HostRead_U16(guard, aPitcher_Stamina + pitcherStaminaOffset);
+    in_event.pitcher_stamina = m_read_plan.read<u16>(guard, aPitcher_Stamina + pitcherStaminaOffset);
 
-    in_event.pitcher_roster_loc = PowerPC::MMU::HostRead_U8(guard, aAB_PitcherRosterID);
-    in_event.batter_roster_loc  = PowerPC::MMU::HostRead_U8(guard, aAB_BatterRosterID);
-    in_event.catcher_roster_loc = PowerPC::MMU::HostRead_U8(guard, aFielder_RosterLoc + (1 * cFielder_Offset));
+    in_event.pitcher_roster_loc = m_read_plan.read<u8>(guard, aAB_PitcherRosterID);
+    in_event.batter_roster_loc  = m_read_plan.read<u8>(guard, aAB_BatterRosterID);
+    in_event.catcher_roster_loc = m_read_plan.read<u8>(guard, aFielder_RosterLoc + (1 * cFielder_Offset));
 }
 
 void StatTracker::logContact(const Core::CPUThreadGuard& guard, Event& in_event){
@@ -720,33 +1070,33 @@ void StatTracker::logContact(const Core::CPUThreadGuard& guard, Event& in_event)
     std::cout << "  Pitch Type: " << std::to_string(in_event.pitch->pitch_type) << "\n";
     Contact* contact = &in_event.pitch->contact.value();
 
-    contact->power.read_value(guard);
-    contact->vert_angle.read_value(guard);
-    contact->horiz_angle.read_value(guard);
-    contact->ball_x_velo.read_value(guard);
-    contact->ball_y_velo.read_value(guard);
-    contact->ball_z_velo.read_value(guard);
-    contact->ball_contact_x_pos.read_value(guard);
-    contact->ball_contact_z_pos.read_value(guard);
-    contact->contact_absolute.read_value(guard);
-    contact->contact_quality.read_value(guard);
-    contact->rng1.read_value(guard);
-    contact->rng2.read_value(guard);
-    contact->rng3.read_value(guard);
-    contact->type_of_contact.read_value(guard);
-    contact->moon_shot.read_value(guard);
-    contact->charge_power_up.read_value(guard);
-    contact->charge_power_down.read_value(guard);
-    contact->input_direction_push_pull.read_value(guard);
-    contact->frame_of_swing.read_value(guard);
+    contact->power.read_value(guard, m_read_plan);
+    contact->vert_angle.read_value(guard, m_read_plan);
+    contact->horiz_angle.read_value(guard, m_read_plan);
+    contact->ball_x_velo.read_value(guard, m_read_plan);
+    contact->ball_y_velo.read_value(guard, m_read_plan);
+    contact->ball_z_velo.read_value(guard, m_read_plan);
+    contact->ball_contact_x_pos.read_value(guard, m_read_plan);
+    contact->ball_contact_z_pos.read_value(guard, m_read_plan);
+    contact->contact_absolute.read_value(guard, m_read_plan);
+    contact->contact_quality.read_value(guard, m_read_plan);
+    contact->rng1.read_value(guard, m_read_plan);
+    contact->rng2.read_value(guard, m_read_plan);
+    contact->rng3.read_value(guard, m_read_plan);
+    contact->type_of_contact.read_value(guard, m_read_plan);
+    contact->moon_shot.read_value(guard, m_read_plan);
+    contact->charge_power_up.read_value(guard, m_read_plan);
+    contact->charge_power_down.read_value(guard, m_read_plan);
+    contact->input_direction_push_pull.read_value(guard, m_read_plan);
+    contact->frame_of_swing.read_value(guard, m_read_plan);
 
     //More ball flight info
-    contact->ball_max_height.read_value(guard);
-    contact->ball_hang_time.read_value(guard);
+    contact->ball_max_height.read_value(guard, m_read_plan);
+    contact->ball_hang_time.read_value(guard, m_read_plan);
 
     u32 aStickInput = aAB_ControlStickInput + (getBatterFielderPorts(guard).first * cControl_Offset);
-    //std::cout << "Batter Port=" << std::to_string(getBatterFielderPorts().first) << " Stick Addr=" << std::hex << aStickInput << " Stick Value=" << (PowerPC::MMU::HostRead_U16(guard, aStickInput) & 0xF) << "\n";
-    contact->input_direction_stick.set_value(PowerPC::MMU::HostRead_U16(guard, aStickInput) & 0xF); //Mask off the lower 4 bits which are the control stick directions
+    //std::cout << "Batter Port=" << std::to_string(getBatterFielderPorts().first) << " Stick Addr=" << std::hex << aStickInput << " Stick Value=" << (m_read_plan.read<u16>(guard, aStickInput) & 0xF) << "\n";
+    contact->input_direction_stick.set_value(m_read_plan.read<u16>(guard, aStickInput) & 0xF); //Mask off the lower 4 bits which are the control stick directions
     //std::cout << "  Stick Value Decoded=" << decode("StickVec", contact->input_direction_stick.get_value(), true) << "\n";
     std::cout << "SWING: " << contact->frame_of_swing.get_key_value_string().first << "=" << contact->frame_of_swing.get_key_value_string().second << "\n";
     std::cout << "\n";
@@ -757,26 +1107,26 @@ void StatTracker::logPitch(const Core::CPUThreadGuard& guard, Event& in_event){
 
     in_event.pitch->logged = true;
     in_event.pitch->pitcher_team_id    = !in_event.half_inning;
-    in_event.pitch->pitcher_char_id    = PowerPC::MMU::HostRead_U8(guard, aAB_PitcherID);
-    in_event.pitch->pitch_type         = PowerPC::MMU::HostRead_U8(guard, aAB_PitchType);
-    in_event.pitch->charge_type        = PowerPC::MMU::HostRead_U8(guard, aAB_ChargePitchType);
-    in_event.pitch->star_pitch         = ((PowerPC::MMU::HostRead_U8(guard, aAB_StarPitch_NonCaptain) > 0) || (PowerPC::MMU::HostRead_U8(guard, aAB_StarPitch_Captain) > 0));
-    in_event.pitch->pitch_speed        = PowerPC::MMU::HostRead_U8(guard, aAB_PitchSpeed);
+    in_event.pitch->pitcher_char_id    = m_read_plan.read<u8>(guard, aAB_PitcherID);
+    in_event.pitch->pitch_type         = m_read_plan.read<u8>(guard, aAB_PitchType);
+    in_event.pitch->charge_type        = m_read_plan.read<u8>(guard, aAB_ChargePitchType);
+    in_event.pitch->star_pitch         = ((m_read_plan.read<u8>(guard, aAB_StarPitch_NonCaptain) > 0) || (m_read_plan.read<u8>(guard, aAB_StarPitch_Captain) > 0));
+    in_event.pitch->pitch_speed        = m_read_plan.read<u8>(guard, aAB_PitchSpeed);
 
-    in_event.pitch->ball_z_strike_vs_ball = PowerPC::MMU::HostRead_U32(guard, aAB_PitchBallPosZStrikezone);
-    in_event.pitch->bat_contact_x_pos.read_value(guard);
-    in_event.pitch->bat_contact_z_pos.read_value(guard);
+    in_event.pitch->ball_z_strike_vs_ball = m_read_plan.read<u32>(guard, aAB_PitchBallPosZStrikezone);
+    in_event.pitch->bat_contact_x_pos.read_value(guard, m_read_plan);
+    in_event.pitch->bat_contact_z_pos.read_value(guard, m_read_plan);
 
     float ballposz_strikezone = floatConverter(in_event.pitch->ball_z_strike_vs_ball);
-    float strikezone_left = floatConverter(PowerPC::MMU::HostRead_U32(guard, aAB_PitchStrikezoneEdgeLeft));
-    float strikezone_right = floatConverter(PowerPC::MMU::HostRead_U32(guard, aAB_PitchStrikezoneEdgeRight));
+    float strikezone_left = floatConverter(m_read_plan.read<u32>(guard, aAB_PitchStrikezoneEdgeLeft));
+    float strikezone_right = floatConverter(m_read_plan.read<u32>(guard, aAB_PitchStrikezoneEdgeRight));
     in_event.pitch->ball_in_strikezone = (strikezone_left < ballposz_strikezone && ballposz_strikezone < strikezone_right) ? 1 : 0;
     
     // === Batter info ===
 
     //First slap,charge,star,bunt
-    u8 swing_type = PowerPC::MMU::HostRead_U8(guard, aAB_TypeOfSwing);  // 0=Slap, 1=charge, 3=bunt
-    u8 star_swing = PowerPC::MMU::HostRead_U8(guard, aAB_StarSwing);
+    u8 swing_type = m_read_plan.read<u8>(guard, aAB_TypeOfSwing);  // 0=Slap, 1=charge, 3=bunt
+    u8 star_swing = m_read_plan.read<u8>(guard, aAB_StarSwing);
     u8 adjusted_swing = 0; //0=miss, 1=slap, 2=charge, 3=star, 4=bunt
     //Adjust swing to definition
     if (star_swing != 0){
@@ -787,7 +1137,7 @@ void StatTracker::logPitch(const Core::CPUThreadGuard& guard, Event& in_event){
     }
 
     //Use adjusted swing if swing and miss, else 0 (or 4 for bunt)
-    u8 any_swing = PowerPC::MMU::HostRead_U8(guard, aAB_AnySwing);  // 0=No swing, 1=swing
+    u8 any_swing = m_read_plan.read<u8>(guard, aAB_AnySwing);  // 0=No swing, 1=swing
     if (any_swing == 0) {
         in_event.pitch->type_of_swing = 0;
     }
@@ -796,21 +1146,21 @@ void StatTracker::logPitch(const Core::CPUThreadGuard& guard, Event& in_event){
     }
 
     std::cout << "SWING: Swing Type=" << std::to_string(swing_type) << " Star Swing=" << std::to_string(star_swing) 
-              << " AnySwing=" << std::to_string(PowerPC::MMU::HostRead_U8(guard, aAB_AnySwing)) << " Final=" << std::to_string(in_event.pitch->type_of_swing) << "\n";
+              << " AnySwing=" << std::to_string(m_read_plan.read<u8>(guard, aAB_AnySwing)) << " Final=" << std::to_string(in_event.pitch->type_of_swing) << "\n";
 }
 
 void StatTracker::logContactResult(const Core::CPUThreadGuard& guard, Contact* in_contact){
     std::cout << "Logging Contact Result\n";
 
-    u8 result = PowerPC::MMU::HostRead_U8(guard, aAB_ContactResult);
+    u8 result = m_read_plan.read<u8>(guard, aAB_ContactResult);
 
     //Log primary contact result (and secondary if possible)
     if (result == 1 || result == 2){
         in_contact->primary_contact_result = result+1; //Landed Fair
         m_event_state = EVENT_STATE::LOG_FIELDER;
-        in_contact->ball_x_pos.read_value(guard);
-        in_contact->ball_y_pos.read_value(guard);
-        in_contact->ball_z_pos.read_value(guard);
+        in_contact->ball_x_pos.read_value(guard, m_read_plan);
+        in_contact->ball_y_pos.read_value(guard, m_read_plan);
+        in_contact->ball_z_pos.read_value(guard, m_read_plan);
 
         //If 2, ball has been caught. Log this as final fielder. If ball has been bobbled they will be logged as bobble
         in_contact->collect_fielder = logFielderWithBall(guard);
@@ -841,16 +1191,16 @@ void StatTracker::logContactResult(const Core::CPUThreadGuard& guard, Contact* i
     else if (result == 0xFF){ // Known bug: this will be true for foul or HR. Correct when adjusting secondary contact later
         in_contact->primary_contact_result = 1; //Foul
         in_contact->secondary_contact_result = 3; //Foul
-        in_contact->ball_x_pos.read_value(guard);
-        in_contact->ball_y_pos.read_value(guard);
-        in_contact->ball_z_pos.read_value(guard);
+        in_contact->ball_x_pos.read_value(guard, m_read_plan);
+        in_contact->ball_y_pos.read_value(guard, m_read_plan);
+        in_contact->ball_z_pos.read_value(guard, m_read_plan);
     }
     else{
         in_contact->primary_contact_result = result;
         in_contact->secondary_contact_result = 0xFF; //???
-        in_contact->ball_x_pos.read_value(guard);
-        in_contact->ball_y_pos.read_value(guard);
-        in_contact->ball_z_pos.read_value(guard);
+        in_contact->ball_x_pos.read_value(guard, m_read_plan);
+        in_contact->ball_y_pos.read_value(guard, m_read_plan);
+        in_contact->ball_z_pos.read_value(guard, m_read_plan);
     }
 }
 
@@ -879,7 +1229,7 @@ void StatTracker::logFinalResults(const Core::CPUThreadGuard& guard, Event& in_e
     }
 
     //num_outs_during_play
-    auto num_outs = in_event.num_outs_during_play.read_value(guard);
+    auto num_outs = in_event.num_outs_during_play.read_value(guard, m_read_plan);
     std::cout << "Num outs for play=" << std::to_string(num_outs) << "\n";
     m_fielder_tracker[!m_game_info.getCurrentEvent().half_inning].incrementBatterOutForPosition(num_outs);
 
@@ -896,6 +1246,57 @@ void StatTracker::logFinalResults(const Core::CPUThreadGuard& guard, Event& in_e
     }
 }
 
+void StatTracker::openStatFile(){
+    if (m_offline) {
+        return;
+    }
+
+    std::time_t unix_time = std::time(nullptr);
+    char datetime_c[256];
+    std::strftime(datetime_c, sizeof(datetime_c), "%Y%m%dT%H%M%S", std::localtime(&unix_time));
+    const std::string path = File::GetUserPath(D_MSSBFILES_IDX) + datetime_c + "_" +
+                             std::to_string(m_game_info.game_id) + StatFile::cExtension;
+
+    m_stat_file = std::make_unique<StatFile::Writer>();
+    if (!m_stat_file->open(path)) {
+        std::cout << "Could not create stat file " << path << "\n";
+        m_stat_file.reset();
+        return;
+    }
+    m_stat_file->writeGameInfo(*this);
+}
+
+void StatTracker::writeStatFileGameInfo(){
+    if (m_stat_file) {
+        m_stat_file->writeGameInfo(*this);
+    }
+}
+
+void StatTracker::closeStatFile(bool include_current_event){
+    if (!m_stat_file) {
+        return;
+    }
+
+    if (include_current_event && m_game_info.currentEventVld()) {
+        m_stat_file->writeEvent(m_game_info.getCurrentEvent());
+    }
+    m_stat_file->writeGameInfo(*this);
+    m_stat_file->close();
+    m_stat_file.reset();
+}
+
+void StatTracker::finishCurrentEvent(){
+    if (!m_game_info.currentEventVld()) {
+        return;
+    }
+
+    if (m_stat_file) {
+        m_stat_file->writeEvent(m_game_info.getCurrentEvent());
+    }
+    m_game_info.events.append(m_game_info.getCurrentEvent());
+    m_game_info.current_event.reset();
+}
+
 std::string StatTracker::getStatJsonPath(std::string prefix){
     std::string away_player_name;
     std::string home_player_name;
@@ -921,45 +1322,62 @@ std::string StatTracker::getStatJsonPath(std::string prefix){
     return full_file_path;
 }
 
-std::string StatTracker::getStatJSON(bool inDecode, bool hide_riokey){
+void StatTracker::writeGameFiles(const std::string& decoded_prefix, const std::string& raw_prefix, bool submit){
+    writeJSONFiles(getStatJsonPath(decoded_prefix), getStatJsonPath(raw_prefix));
+
+    if (submit && m_submitter) {
+        writeStatJSON(m_json_writer, false, false);
+        //Hand the game to the submitter. It is spooled to disk and sent off the CPU thread
+        m_submitter->SubmitGame(m_game_info.game_id, m_json_writer.GetString());
+    }
+}
+
+bool StatTracker::writeJSONFiles(const std::string& decoded_path, const std::string& raw_path){
+    //Events are serialized once per variant and spliced into every document that needs them
+    writeEventsJSON(m_events_writer[0], false);
+    writeEventsJSON(m_events_writer[1], true);
+
+    writeStatJSON(m_json_writer, true, true);
+    bool success = File::WriteStringToFile(decoded_path, m_json_writer.GetView());
+
+    writeStatJSON(m_json_writer, false, true);
+    success &= File::WriteStringToFile(raw_path, m_json_writer.GetView());
+    return success;
+}
+
+void StatTracker::writeStatJSON(Common::JsonWriter& writer, bool inDecode, bool hide_riokey){
     //TODO switch to IDs when submitting game
     std::string away_player_info = (inDecode || hide_riokey) ? m_game_info.getAwayTeamPlayer().GetUsername() : m_game_info.getAwayTeamPlayer().GetUserID();
     std::string home_player_info = (inDecode || hide_riokey) ? m_game_info.getHomeTeamPlayer().GetUsername() : m_game_info.getHomeTeamPlayer().GetUserID();
 
-    std::stringstream json_stream;
-
-    json_stream << "{\n";
-    std::string stadium = (inDecode) ? "\"" + cStadiumIdToStadiumName.at(m_game_info.stadium) + "\"" : std::to_string(m_game_info.stadium);
-    std::string start_date_time = (inDecode) ? m_game_info.start_local_date_time : m_game_info.start_unix_date_time;
-    std::string end_date_time = (inDecode) ? m_game_info.end_local_date_time : m_game_info.end_unix_date_time;
-    json_stream << "  \"GameID\": \"" << m_game_info.game_id << "\",\n";
-    json_stream << "  \"Date - Start\": \"" << start_date_time << "\",\n";
-    json_stream << "  \"Date - End\": \"" << end_date_time << "\",\n";
-    
-    std::string tag_set_id_str = "\"\"";
+    writer.Clear();
+    writer.BeginObject();
+    writer.QuotedNumber("GameID", m_game_info.game_id);
+    writer.String("Date - Start", (inDecode) ? m_game_info.start_local_date_time : m_game_info.start_unix_date_time);
+    writer.String("Date - End", (inDecode) ? m_game_info.end_local_date_time : m_game_info.end_unix_date_time);
     if (m_game_info.tag_set_id.has_value()){
-        tag_set_id_str = std::to_string(m_game_info.tag_set_id.value());
+        writer.Number("TagSetID", m_game_info.tag_set_id.value());
     }
-    json_stream << "  \"TagSetID\": " << tag_set_id_str << ",\n";
-    json_stream << "  \"Netplay\": " << std::to_string(m_game_info.netplay) << ",\n";
-    json_stream << "  \"StadiumID\": " << decode("Stadium", m_game_info.stadium, inDecode) << ",\n";
-    json_stream << "  \"Away Player\": \"" << away_player_info << "\",\n"; //TODO MAKE THIS AN ID
-    json_stream << "  \"Home Player\": \"" << home_player_info << "\",\n";
-
-    json_stream << "  \"Away Score\": " << std::dec << m_game_info.away_score << ",\n";
-    json_stream << "  \"Home Score\": " << std::dec << m_game_info.home_score << ",\n";
+    else {
+        writer.String("TagSetID", "");
+    }
+    writer.Number("Netplay", static_cast<u8>(m_game_info.netplay));
+    writeDecoded(writer, "StadiumID", DecodeType::Stadium, m_game_info.stadium, inDecode);
+    writer.String("Away Player", away_player_info); //TODO MAKE THIS AN ID
+    writer.String("Home Player", home_player_info);
 
-    json_stream << "  \"Innings Selected\": " << std::to_string(m_game_info.innings_selected) << ",\n";
-    json_stream << "  \"Innings Played\": " << std::to_string(m_game_info.innings_played) << ",\n";
-    json_stream << "  \"Quitter Team\": " << decode("QuitterTeam", m_game_info.quitter_team, inDecode) << ",\n";
+    writer.Number("Away Score", m_game_info.away_score);
+    writer.Number("Home Score", m_game_info.home_score);
 
-    json_stream << "  \"Average Ping\": " << std::to_string(m_game_info.avg_ping) << ",\n";
-    json_stream << "  \"Lag Spikes\": " << std::to_string(m_game_info.lag_spikes) << ",\n";
-    json_stream << "  \"Version\": \"" << Common::GetRioRevStr() << "\",\n";
+    writer.Number("Innings Selected", m_game_info.innings_selected);
+    writer.Number("Innings Played", m_game_info.innings_played);
+    writeDecoded(writer, "Quitter Team", DecodeType::QuitterTeam, m_game_info.quitter_team, inDecode);
 
-    json_stream << "  \"Character Game Stats\": {\n";
+    writer.Number("Average Ping", m_game_info.avg_ping);
+    writer.Number("Lag Spikes", m_game_info.lag_spikes);
+    writer.String("Version", m_game_info.rio_version);
 
-    //Defensive Stats
+    writer.BeginObject("Character Game Stats");
     for (int team=0; team < cNumOfTeams; ++team){
         u8 captain_roster_loc;
         if (team == 0){
@@ -969,573 +1387,368 @@ std::string StatTracker::getStatJSON(bool inDecode, bool hide_riokey){
             captain_roster_loc = (m_game_info.home_port == m_game_info.team0_port) ? m_game_info.team0_captain_roster_loc : m_game_info.team1_captain_roster_loc;
         }
 
-        std::string team_string = (team == 0) ? "Away" : "Home";
-
         for (int roster=0; roster < cRosterSize; ++roster){
-            CharacterSummary& char_summary = m_game_info.character_summaries[team][roster];
-            
-            // team integer home or away
-            std::string label = "\"" + team_string + " Roster " + std::to_string(roster) + "\": ";
-            json_stream << "    " << label << "{\n";
-            json_stream << "      \"Team\": \""        << std::to_string(team) << "\",\n";
-            json_stream << "      \"RosterID\": "      << std::to_string(roster) << ",\n";
-            json_stream << "      \"CharID\": "        << decode("Character", char_summary.char_id, inDecode) << ",\n";
-            json_stream << "      \"Superstar\": "     << std::to_string(char_summary.is_starred) << ",\n";
-            json_stream << "      \"Captain\": "       << std::to_string(roster == captain_roster_loc) << ",\n";
-            json_stream << "      \"Fielding Hand\": " << decode("Hand", char_summary.fielding_hand, inDecode) << ",\n";
-            json_stream << "      \"Batting Hand\": "  << decode("Hand", char_summary.batting_hand, inDecode) << ",\n";
-
-            //=== Defensive Stats ===
-            EndGameRosterDefensiveStats& def_stat = char_summary.end_game_defensive_stats;
-            json_stream << "      \"Defensive Stats\": {\n";
-            json_stream << "        \"Batters Faced\": "       << std::to_string(def_stat.batters_faced) << ",\n";
-            json_stream << "        \"Runs Allowed\": "        << std::dec << def_stat.runs_allowed << ",\n";
-            json_stream << "        \"Earned Runs\": "        << std::dec << def_stat.earned_runs << ",\n";
-            json_stream << "        \"Batters Walked\": "      << def_stat.batters_walked << ",\n";
-            json_stream << "        \"Batters Hit\": "         << def_stat.batters_hit << ",\n";
-            json_stream << "        \"Hits Allowed\": "        << def_stat.hits_allowed << ",\n";
-            json_stream << "        \"HRs Allowed\": "         << def_stat.homeruns_allowed << ",\n";
-            json_stream << "        \"Pitches Thrown\": "      << def_stat.pitches_thrown << ",\n";
-            json_stream << "        \"Stamina\": "             << def_stat.stamina << ",\n";
-            json_stream << "        \"Was Pitcher\": "         << std::to_string(def_stat.was_pitcher) << ",\n";
-            json_stream << "        \"Strikeouts\": "          << std::to_string(def_stat.strike_outs) << ",\n";
-            json_stream << "        \"Star Pitches Thrown\": " << std::to_string(def_stat.star_pitches_thrown) << ",\n";
-            json_stream << "        \"Big Plays\": "           << std::to_string(def_stat.big_plays) << ",\n";
-            json_stream << "        \"Outs Pitched\": "        << std::to_string(def_stat.outs_pitched) << ",\n";
-            json_stream << "        \"Batters Per Position\": [\n";
-
-            if (m_fielder_tracker[team].battersAtAnyPosition(roster, 0)){
-                json_stream << "          {\n";
-                for (int pos = 0; pos < cNumOfPositions; ++pos) {
-                    if (m_fielder_tracker[team].fielder_map[roster].batter_count_by_position[pos] > 0){
-                        std::string comma = (m_fielder_tracker[team].battersAtAnyPosition(roster, pos+1)) ? "," : "";
-                        json_stream << "            \"" << cPosition.at(pos) << "\": " << std::to_string(m_fielder_tracker[team].fielder_map[roster].batter_count_by_position[pos]) << comma << "\n";
-                    }
-                }
-                json_stream << "          }\n";
-            }
-            json_stream << "        ],\n";
-
-            json_stream << "        \"Batter Outs Per Position\": [\n";
-            if (m_fielder_tracker[team].batterOutsAtAnyPosition(roster, 0)){
-                json_stream << "          {\n";
-                for (int pos = 0; pos < cNumOfPositions; ++pos) {
-                    if (m_fielder_tracker[team].fielder_map[roster].batter_outs_by_position[pos] > 0){
-                        std::string comma = (m_fielder_tracker[team].batterOutsAtAnyPosition(roster, pos+1)) ? "," : "";
-                        json_stream << "            \"" << cPosition.at(pos) << "\": " << std::to_string(m_fielder_tracker[team].fielder_map[roster].batter_outs_by_position[pos]) << comma << "\n";
-                    }
-                }
-                json_stream << "          }\n";
-            }
-            json_stream << "        ],\n";
-
-            json_stream << "        \"Outs Per Position\": [\n";
-            if (m_fielder_tracker[team].outsAtAnyPosition(roster, 0)){
-                json_stream << "          {\n";
-                for (int pos = 0; pos < cNumOfPositions; ++pos) {
-                    if (m_fielder_tracker[team].fielder_map[roster].out_count_by_position[pos] > 0){
-                        std::string comma = (m_fielder_tracker[team].outsAtAnyPosition(roster, pos+1)) ? "," : "";
-                        json_stream << "            \"" << cPosition.at(pos) << "\": " << std::to_string(m_fielder_tracker[team].fielder_map[roster].out_count_by_position[pos]) << comma << "\n";
-                    }
+            writeRosterJSON(writer, team, roster, captain_roster_loc, inDecode);
+        }
+    }
+    writer.EndObject();
+
+    //=== Events ===
+    writer.BeginArray("Events");
+    writer.AppendElements(m_events_writer[inDecode]);
+    writer.EndArray();
+
+    writer.EndObject();
+}
+
+void StatTracker::writeRosterJSON(Common::JsonWriter& writer, int team, int roster, u8 captain_roster_loc, bool inDecode){
+    CharacterSummary& char_summary = m_game_info.character_summaries[team][roster];
+    FielderTracker& fielder_tracker = m_fielder_tracker[team];
+
+    writer.BeginObject(cRosterKeys[team][roster]);
+    writer.QuotedNumber("Team", team);
+    writer.Number("RosterID", roster);
+    writeDecoded(writer, "CharID", DecodeType::Character, char_summary.char_id, inDecode);
+    writer.Number("Superstar", char_summary.is_starred);
+    writer.Number("Captain", static_cast<u8>(roster == captain_roster_loc));
+    writeDecoded(writer, "Fielding Hand", DecodeType::Hand, char_summary.fielding_hand, inDecode);
+    writeDecoded(writer, "Batting Hand", DecodeType::Hand, char_summary.batting_hand, inDecode);
+
+    //=== Defensive Stats ===
+    EndGameRosterDefensiveStats& def_stat = char_summary.end_game_defensive_stats;
+    writer.BeginObject("Defensive Stats");
+    writer.Number("Batters Faced", def_stat.batters_faced);
+    writer.Number("Runs Allowed", def_stat.runs_allowed);
+    writer.Number("Earned Runs", def_stat.earned_runs);
+    writer.Number("Batters Walked", def_stat.batters_walked);
+    writer.Number("Batters Hit", def_stat.batters_hit);
+    writer.Number("Hits Allowed", def_stat.hits_allowed);
+    writer.Number("HRs Allowed", def_stat.homeruns_allowed);
+    writer.Number("Pitches Thrown", def_stat.pitches_thrown);
+    writer.Number("Stamina", def_stat.stamina);
+    writer.Number("Was Pitcher", def_stat.was_pitcher);
+    writer.Number("Strikeouts", def_stat.strike_outs);
+    writer.Number("Star Pitches Thrown", def_stat.star_pitches_thrown);
+    writer.Number("Big Plays", def_stat.big_plays);
+    writer.Number("Outs Pitched", def_stat.outs_pitched);
+
+    //Each of these is an array holding a single object with an entry per position that saw a count
+    const auto write_counts_by_position = [&writer](std::string_view key, const std::array<int, cNumOfPositions>& counts) {
+        writer.BeginArray(key);
+        if (std::any_of(counts.begin(), counts.end(), [](int count) { return count > 0; })){
+            writer.BeginObject();
+            for (int pos = 0; pos < cNumOfPositions; ++pos) {
+                if (counts[pos] > 0){
+                    writer.Number(cPosition.at(pos), counts[pos]);
                 }
-                json_stream << "          }\n";
             }
-            json_stream << "        ]\n";
-            json_stream << "      },\n";
-
-            //=== Offensive Stats ===
-            EndGameRosterOffensiveStats& of_stat = char_summary.end_game_offensive_stats;
-            json_stream << "      \"Offensive Stats\": {\n";
-            json_stream << "        \"At Bats\": "          << std::to_string(of_stat.at_bats) << ",\n";
-            json_stream << "        \"Hits\": "             << std::to_string(of_stat.hits) << ",\n";
-            json_stream << "        \"Singles\": "          << std::to_string(of_stat.singles) << ",\n";
-            json_stream << "        \"Doubles\": "          << std::to_string(of_stat.doubles) << ",\n";
-            json_stream << "        \"Triples\": "          << std::to_string(of_stat.triples) << ",\n";
-            json_stream << "        \"Homeruns\": "         << std::to_string(of_stat.homeruns) << ",\n";
-            json_stream << "        \"Successful Bunts\": " << std::to_string(of_stat.successful_bunts) << ",\n";
-            json_stream << "        \"Sac Flys\": "         << std::to_string(of_stat.sac_flys) << ",\n";
-            json_stream << "        \"Strikeouts\": "       << std::to_string(of_stat.strikouts) << ",\n";
-            json_stream << "        \"Walks (4 Balls)\": "  << std::to_string(of_stat.walks_4balls) << ",\n";
-            json_stream << "        \"Walks (Hit)\": "      << std::to_string(of_stat.walks_hit) << ",\n";
-            json_stream << "        \"RBI\": "              << std::to_string(of_stat.rbi) << ",\n";
-            json_stream << "        \"Bases Stolen\": "     << std::to_string(of_stat.bases_stolen) << ",\n";
-            json_stream << "        \"Star Hits\": "        << std::to_string(of_stat.star_hits) << "\n";
-            json_stream << "      }\n";
-            std::string commas = ((roster == 8) && (team ==1)) ? "" : ",";
-            json_stream << "    }" << commas << "\n";
+            writer.EndObject();
         }
-    }
-    json_stream << "  },\n";
-    //=== Events === 
-    json_stream << "  \"Events\": [\n";
-    for (auto event_map_iter = m_game_info.events.begin(); event_map_iter != m_game_info.events.end(); event_map_iter++) {
-        u8 event_num = event_map_iter->first;
-        Event& event = event_map_iter->second;
+        writer.EndArray();
+    };
+    write_counts_by_position("Batters Per Position", fielder_tracker.fielder_map[roster].batter_count_by_position);
+    write_counts_by_position("Batter Outs Per Position", fielder_tracker.fielder_map[roster].batter_outs_by_position);
+    write_counts_by_position("Outs Per Position", fielder_tracker.fielder_map[roster].out_count_by_position);
+    writer.EndObject();
+
+    //=== Offensive Stats ===
+    EndGameRosterOffensiveStats& of_stat = char_summary.end_game_offensive_stats;
+    writer.BeginObject("Offensive Stats");
+    writer.Number("At Bats", of_stat.at_bats);
+    writer.Number("Hits", of_stat.hits);
+    writer.Number("Singles", of_stat.singles);
+    writer.Number("Doubles", of_stat.doubles);
+    writer.Number("Triples", of_stat.triples);
+    writer.Number("Homeruns", of_stat.homeruns);
+    writer.Number("Successful Bunts", of_stat.successful_bunts);
+    writer.Number("Sac Flys", of_stat.sac_flys);
+    writer.Number("Strikeouts", of_stat.strikouts);
+    writer.Number("Walks (4 Balls)", of_stat.walks_4balls);
+    writer.Number("Walks (Hit)", of_stat.walks_hit);
+    writer.Number("RBI", of_stat.rbi);
+    writer.Number("Bases Stolen", of_stat.bases_stolen);
+    writer.Number("Star Hits", of_stat.star_hits);
+    writer.EndObject();
+
+    writer.EndObject();
+}
 
+void StatTracker::writeEventsJSON(Common::JsonWriter& events, bool inDecode){
+    //Elements of the "Events" array, which sits two levels deep in the stat document
+    events.Clear(2);
+    Event event;
+    for (u32 row = 0; row < m_game_info.events.size(); ++row) {
         //Don't log events with inning == 0. Means game has crashed/quit and this is an empty event
-        if (event.inning == 0) {
+        if (m_game_info.events.getInning(row) == 0) {
             continue;
         }
+        m_game_info.events.load(row, event);
+        writeEventJSON(events, event.event_num, event, inDecode);
+    }
+    //Event that was still being logged when the game ended
+    if (m_game_info.currentEventVld() && m_game_info.getCurrentEvent().inning != 0) {
+        writeEventJSON(events, m_game_info.getCurrentEvent().event_num, m_game_info.getCurrentEvent(), inDecode);
+    }
+}
 
-        json_stream << "    {\n";
-        json_stream << "      \"Event Num\": "               << std::to_string(event_num) << ",\n";
-        json_stream << "      \"Inning\": "                  << std::to_string(event.inning) << ",\n";
-        json_stream << "      \"Half Inning\": "             << std::to_string(event.half_inning) << ",\n";
-        json_stream << "      \"Away Score\": "              << std::dec << event.away_score << ",\n";
-        json_stream << "      \"Home Score\": "              << std::dec << event.home_score << ",\n";
-        json_stream << "      \"Balls\": "                   << std::to_string(event.balls) << ",\n";
-        json_stream << "      \"Strikes\": "                 << std::to_string(event.strikes) << ",\n";
-        json_stream << "      \"Outs\": "                    << std::to_string(event.outs) << ",\n";
-        json_stream << "      \"Star Chance\": "             << std::to_string(event.is_star_chance) << ",\n";
-        json_stream << "      \"Away Stars\": "              << std::to_string(event.away_stars) << ",\n";
-        json_stream << "      \"Home Stars\": "              << std::to_string(event.home_stars) << ",\n";
-        json_stream << "      \"Pitcher Stamina\": "         << std::to_string(event.pitcher_stamina) << ",\n";
-        json_stream << "      \"Chemistry Links on Base\": " << std::to_string(event.chem_links_ob) << ",\n";
-        json_stream << "      \"Pitcher Roster Loc\": "      << std::to_string(event.pitcher_roster_loc) << ",\n";
-        json_stream << "      \"Batter Roster Loc\": "       << std::to_string(event.batter_roster_loc) << ",\n";
-        json_stream << "      \"Catcher Roster Loc\": "       << std::to_string(event.catcher_roster_loc) << ",\n";
-        json_stream << "      \"RBI\": "                     << std::to_string(event.rbi) << ",\n";
-        json_stream << "      \"" << event.num_outs_during_play.name << "\": " << event.num_outs_during_play.get_key_value_string().second << ",\n";
-        json_stream << "      \"Result of AB\": "            << decode("AtBatResult", event.result_of_atbat, inDecode) << ",\n";
-
-        //=== Runners ===
-        //Build vector of <Runner*, Label/Name>
-        std::vector<std::pair<Runner*, std::string>> runners;
-        if (event.runner_batter) {
-            runners.push_back({&event.runner_batter.value(), "Batter"});
-        }
-        if (event.runner_1) {
-            runners.push_back({&event.runner_1.value(), "1B"});
+void StatTracker::writeEventJSON(Common::JsonWriter& writer, u16 in_event_num, Event& event, bool inDecode){
+    writer.BeginObject();
+    writer.Number("Event Num", in_event_num);
+    writer.Number("Inning", event.inning);
+    writer.Number("Half Inning", event.half_inning);
+    writer.Number("Away Score", event.away_score);
+    writer.Number("Home Score", event.home_score);
+    writer.Number("Balls", event.balls);
+    writer.Number("Strikes", event.strikes);
+    writer.Number("Outs", event.outs);
+    writer.Number("Star Chance", event.is_star_chance);
+    writer.Number("Away Stars", event.away_stars);
+    writer.Number("Home Stars", event.home_stars);
+    writer.Number("Pitcher Stamina", event.pitcher_stamina);
+    writer.Number("Chemistry Links on Base", event.chem_links_ob);
+    writer.Number("Pitcher Roster Loc", event.pitcher_roster_loc);
+    writer.Number("Batter Roster Loc", event.batter_roster_loc);
+    writer.Number("Catcher Roster Loc", event.catcher_roster_loc);
+    writer.Number("RBI", event.rbi);
+    writer.Number(event.num_outs_during_play.name, event.num_outs_during_play.get_value());
+    writeDecoded(writer, "Result of AB", DecodeType::AtBatResult, event.result_of_atbat, inDecode);
+
+    writeRunnersJSON(writer, event, inDecode);
+
+    if (event.pitch.has_value()){
+        writePitchJSON(writer, event.pitch.value(), inDecode, true);
+    }
+    writer.EndObject();
+}
+
+void StatTracker::writeRunnersJSON(Common::JsonWriter& writer, Event& in_event, bool inDecode){
+    const std::array<Runner*, cNumOfBases> runners = {
+        in_event.runner_batter ? &in_event.runner_batter.value() : nullptr,
+        in_event.runner_1 ? &in_event.runner_1.value() : nullptr,
+        in_event.runner_2 ? &in_event.runner_2.value() : nullptr,
+        in_event.runner_3 ? &in_event.runner_3.value() : nullptr,
+    };
+
+    for (int base = 0; base < cNumOfBases; ++base){
+        Runner* runner_info = runners[base];
+        if (!runner_info) {
+            continue;
         }
-        if (event.runner_2) {
-            runners.push_back({&event.runner_2.value(), "2B"});
+
+        writer.BeginObject(cRunnerKeys[base]);
+        writer.Number("Runner Roster Loc", runner_info->roster_loc);
+        writeDecoded(writer, "Runner Char Id", DecodeType::Character, runner_info->char_id, inDecode);
+        writer.Number("Runner Initial Base", runner_info->initial_base);
+        writeDecoded(writer, "Out Type", DecodeType::Out, runner_info->out_type, inDecode);
+        writer.Number("Out Location", runner_info->out_location);
+        //writer.Number("Runner Basepath Location", runner_info->basepath_location);
+        writeDecoded(writer, "Steal", DecodeType::Steal, runner_info->steal, inDecode);
+        writer.Number("Runner Result Base", runner_info->result_base);
+        writer.EndObject();
+    }
+}
+
+void StatTracker::writePitchJSON(Common::JsonWriter& writer, Pitch& pitch, bool inDecode, bool hang_time_as_string){
+    writer.BeginObject("Pitch");
+    writer.Number("Pitcher Team Id", pitch.pitcher_team_id);
+    writeDecoded(writer, "Pitcher Char Id", DecodeType::Character, pitch.pitcher_char_id, inDecode);
+    writeDecoded(writer, "Pitch Type", DecodeType::Pitch, pitch.pitch_type, inDecode);
+    writeDecoded(writer, "Charge Type", DecodeType::ChargePitch, pitch.charge_type, inDecode);
+    writer.Number("Star Pitch", pitch.star_pitch);
+    writer.Number("Pitch Speed", pitch.pitch_speed);
+    writer.Number("Ball Position - Strikezone", floatConverter(pitch.ball_z_strike_vs_ball));
+    writer.Number("In Strikezone", pitch.ball_in_strikezone);
+    writer.Number(pitch.bat_contact_x_pos.name, floatConverter(pitch.bat_contact_x_pos.get_value()));
+    writer.Number(pitch.bat_contact_z_pos.name, floatConverter(pitch.bat_contact_z_pos.get_value()));
+    writer.Number("DB", pitch.db);
+    writeDecoded(writer, "Type of Swing", DecodeType::Swing, pitch.type_of_swing, inDecode);
+
+    //=== Contact ===
+    if (pitch.contact.has_value() && pitch.contact->type_of_contact.get_value() != 0xFF){
+        Contact* contact = &pitch.contact.value();
+        writer.BeginObject("Contact");
+        writeDecoded(writer, contact->type_of_contact.name, DecodeType::Contact, contact->type_of_contact.get_value(), inDecode);
+        writer.Number(contact->charge_power_up.name, floatConverter(contact->charge_power_up.get_value()));
+        writer.Number(contact->charge_power_down.name, floatConverter(contact->charge_power_down.get_value()));
+        writer.Number(contact->moon_shot.name, contact->moon_shot.get_value());
+        writeDecoded(writer, contact->input_direction_push_pull.name, DecodeType::Stick, contact->input_direction_push_pull.get_value(), inDecode);
+        writeDecoded(writer, contact->input_direction_stick.name, DecodeType::StickVec, contact->input_direction_stick.get_value(), inDecode);
+        writer.QuotedNumber(contact->frame_of_swing.name, contact->frame_of_swing.get_value());
+
+        writer.QuotedNumber(contact->power.name, contact->power.get_value());
+        writer.QuotedNumber(contact->vert_angle.name, contact->vert_angle.get_value());
+        writer.QuotedNumber(contact->horiz_angle.name, contact->horiz_angle.get_value());
+
+        writer.Number(contact->contact_absolute.name, floatConverter(contact->contact_absolute.get_value()));
+        writer.Number(contact->contact_quality.name, floatConverter(contact->contact_quality.get_value()));
+
+        writer.QuotedNumber(contact->rng1.name, contact->rng1.get_value());
+        writer.QuotedNumber(contact->rng2.name, contact->rng2.get_value());
+        writer.QuotedNumber(contact->rng3.name, contact->rng3.get_value());
+
+        writer.Number(contact->ball_x_velo.name, floatConverter(contact->ball_x_velo.get_value()));
+        writer.Number(contact->ball_y_velo.name, floatConverter(contact->ball_y_velo.get_value()));
+        writer.Number(contact->ball_z_velo.name, floatConverter(contact->ball_z_velo.get_value()));
+
+        writer.Number(contact->ball_contact_x_pos.name, floatConverter(contact->ball_contact_x_pos.get_value()));
+        writer.Number(contact->ball_contact_z_pos.name, floatConverter(contact->ball_contact_z_pos.get_value()));
+
+        writer.Number(contact->ball_x_pos.name, floatConverter(contact->ball_x_pos.get_value()));
+        writer.Number(contact->ball_y_pos.name, floatConverter(contact->ball_y_pos.get_value()));
+        writer.Number(contact->ball_z_pos.name, floatConverter(contact->ball_z_pos.get_value()));
+
+        //The stat file has always quoted the hang time, the HUD has not
+        if (!hang_time_as_string) {
+            writer.Number(contact->ball_hang_time.name, contact->ball_hang_time.get_value());
         }
-        if (event.runner_3) {
-            runners.push_back({&event.runner_3.value(), "3B"});
+        writer.Number(contact->ball_max_height.name, floatConverter(contact->ball_max_height.get_value()));
+        if (hang_time_as_string) {
+            writer.QuotedNumber(contact->ball_hang_time.name, contact->ball_hang_time.get_value());
         }
-
-        for (auto runner = runners.begin(); runner != runners.end(); runner++){
-            Runner* runner_info = runner->first;
-            std::string& label = runner->second;
-
-            json_stream << "      \"Runner " << label << "\": {\n";
-            json_stream << "        \"Runner Roster Loc\": "   << std::to_string(runner_info->roster_loc) << ",\n";
-            json_stream << "        \"Runner Char Id\": "      << decode("Character", runner_info->char_id, inDecode) << ",\n";
-            json_stream << "        \"Runner Initial Base\": " << std::to_string(runner_info->initial_base) << ",\n";
-            json_stream << "        \"Out Type\": "            << decode("Out", runner_info->out_type, inDecode) << ",\n";
-            json_stream << "        \"Out Location\": "        << std::to_string(runner_info->out_location) << ",\n";
-            //json_stream << "        \"Runner Basepath Location\": "  << std::to_string(runner_info->basepath_location) << ",\n";
-            json_stream << "        \"Steal\": "               << decode("Steal", runner_info->steal, inDecode) << ",\n";
-            json_stream << "        \"Runner Result Base\": "  << std::to_string(runner_info->result_base) << "\n";
-            std::string comma = (std::next(runner) == runners.end() && !event.pitch.has_value()) ? "" : ",";
-            json_stream << "      }" << comma << "\n";
+        writeDecoded(writer, "Contact Result - Primary", DecodeType::PrimaryContactResult, contact->primary_contact_result, inDecode);
+        writeDecoded(writer, "Contact Result - Secondary", DecodeType::SecondaryContactResult, contact->secondary_contact_result, inDecode);
+
+        //=== Fielder ===
+        //TODO could be reworked
+        if (contact->first_fielder.has_value() || contact->collect_fielder.has_value()){
+            //First fielder to touch the ball
+            //If the fielder bobbled but the same fielder collected the ball OR there was no bobble, log single fielder
+            Fielder* fielder = (contact->first_fielder.has_value()) ? &contact->first_fielder.value() : &contact->collect_fielder.value();
+
+            writer.BeginObject("First Fielder");
+            writer.Number("Fielder Roster Location", fielder->fielder_roster_loc);
+            writeDecoded(writer, "Fielder Position", DecodeType::Position, fielder->fielder_pos, inDecode);
+            writeDecoded(writer, "Fielder Character", DecodeType::Character, fielder->fielder_char_id, inDecode);
+            writeDecoded(writer, "Fielder Action", DecodeType::Action, fielder->fielder_action, inDecode);
+            writer.Number("Fielder Jump", fielder->fielder_jump);
+            writer.Number("Fielder Swap", fielder->fielder_swapped_for_batter);
+            writeDecoded(writer, "Fielder Manual Selected", DecodeType::ManualSelect, fielder->fielder_manual_select_arg, inDecode);
+            writer.Number("Fielder Position - X", floatConverter(fielder->fielder_x_pos));
+            writer.Number("Fielder Position - Y", floatConverter(fielder->fielder_y_pos));
+            writer.Number("Fielder Position - Z", floatConverter(fielder->fielder_z_pos));
+            writeDecoded(writer, "Fielder Bobble", DecodeType::Bobble, fielder->bobble, inDecode);
+            writer.EndObject();
         }
+        writer.EndObject(); //close contact
+    }
+    writer.EndObject(); //close pitch
+}
 
+void StatTracker::publishHUD(bool after_play){
+    Event& event = m_game_info.getCurrentEvent();
 
-        //=== Pitch ===
-        if (event.pitch.has_value()){
-            Pitch* pitch = &event.pitch.value();
-            json_stream << "      \"Pitch\": {\n";
-            json_stream << "        \"Pitcher Team Id\": "    << std::to_string(pitch->pitcher_team_id) << ",\n";
-            json_stream << "        \"Pitcher Char Id\": "    << decode("Character", pitch->pitcher_char_id, inDecode) << ",\n";
-            json_stream << "        \"Pitch Type\": "         << decode("Pitch", pitch->pitch_type, inDecode) << ",\n";
-            json_stream << "        \"Charge Type\": "        << decode("ChargePitch", pitch->charge_type, inDecode) << ",\n";
-            json_stream << "        \"Star Pitch\": "         << std::to_string(pitch->star_pitch) << ",\n";
-            json_stream << "        \"Pitch Speed\": "        << std::to_string(pitch->pitch_speed) << ",\n";
-            json_stream << "        \"Ball Position - Strikezone\": "   << floatConverter(pitch->ball_z_strike_vs_ball) << ",\n";
-            json_stream << "        \"In Strikezone\": "      << std::to_string(pitch->ball_in_strikezone) << ",\n";
-            json_stream << "        \"" << pitch->bat_contact_x_pos.name << "\": " << floatConverter(pitch->bat_contact_x_pos.get_value()) << ",\n";
-            json_stream << "        \"" << pitch->bat_contact_z_pos.name << "\": " << floatConverter(pitch->bat_contact_z_pos.get_value()) << ",\n";
-            json_stream << "        \"DB\": "                 << std::to_string(pitch->db) << ",\n";
-            json_stream << "        \"Type of Swing\": "      << decode("Swing", pitch->type_of_swing, inDecode);
-            
-            //=== Contact ===
-            if (pitch->contact.has_value() && pitch->contact->type_of_contact.get_value() != 0xFF){
-                json_stream << ",\n";
-
-                Contact* contact = &pitch->contact.value();
-                json_stream << "        \"Contact\": {\n";
-                json_stream << "          \"" << contact->type_of_contact.name << "\":" << decode("Contact", contact->type_of_contact.get_value(), inDecode) << ",\n";
-                json_stream << "          \"" << contact->charge_power_up.name << "\": " << floatConverter(contact->charge_power_up.get_value()) << ",\n";
-                json_stream << "          \"" << contact->charge_power_down.name << "\": " << floatConverter(contact->charge_power_down.get_value()) << ",\n";
-                json_stream << "          \"" << contact->moon_shot.name << "\": " << contact->moon_shot.get_key_value_string().second << ",\n"; 
-                json_stream << "          \"" << contact->input_direction_push_pull.name << "\": " << decode("Stick", contact->input_direction_push_pull.get_value(), inDecode) << ",\n";
-                json_stream << "          \"" << contact->input_direction_stick.name << "\": " << decode("StickVec", contact->input_direction_stick.get_value(), inDecode) << ",\n";
-                json_stream << "          \"" << contact->frame_of_swing.name << "\": \"" << std::dec << contact->frame_of_swing.get_value() << "\",\n";
-
-                json_stream << "          \"" << contact->power.name << "\": \"" << std::dec << contact->power.get_value() <<"\",\n";
-                json_stream << "          \"" << contact->vert_angle.name << "\": \"" << std::dec << contact->vert_angle.get_value() << "\",\n";
-                json_stream << "          \"" << contact->horiz_angle.name << "\": \"" << std::dec << contact->horiz_angle.get_value() << "\",\n";
-
-                json_stream << "          \"" << contact->contact_absolute.name << "\": " << floatConverter(contact->contact_absolute.get_value()) << ",\n";
-                json_stream << "          \"" << contact->contact_quality.name << "\": " << floatConverter(contact->contact_quality.get_value()) << ",\n";
-                
-                json_stream << "          \"" << contact->rng1.name << "\": \"" << std::dec << contact->rng1.get_value() << "\",\n";
-                json_stream << "          \"" << contact->rng2.name << "\": \"" << std::dec << contact->rng2.get_value() << "\",\n";
-                json_stream << "          \"" << contact->rng3.name << "\": \"" << std::dec << contact->rng3.get_value() << "\",\n";
-
-                json_stream << "          \"" << contact->ball_x_velo.name << "\": " << floatConverter(contact->ball_x_velo.get_value()) << ",\n";
-                json_stream << "          \"" << contact->ball_y_velo.name << "\": " << floatConverter(contact->ball_y_velo.get_value()) << ",\n";
-                json_stream << "          \"" << contact->ball_z_velo.name << "\": " << floatConverter(contact->ball_z_velo.get_value()) << ",\n";
-
-                json_stream << "          \"" << contact->ball_contact_x_pos.name << "\": " << floatConverter(contact->ball_contact_x_pos.get_value()) << ",\n";
-                json_stream << "          \"" << contact->ball_contact_z_pos.name << "\": " << floatConverter(contact->ball_contact_z_pos.get_value()) << ",\n";
-                                
-                json_stream << "          \"" << contact->ball_x_pos.name << "\": " << floatConverter(contact->ball_x_pos.get_value()) << ",\n";
-                json_stream << "          \"" << contact->ball_y_pos.name << "\": " << floatConverter(contact->ball_y_pos.get_value()) << ",\n";
-                json_stream << "          \"" << contact->ball_z_pos.name << "\": " << floatConverter(contact->ball_z_pos.get_value()) << ",\n";
-
-                json_stream << "          \"" << contact->ball_max_height.name << "\": " << floatConverter(contact->ball_max_height.get_value()) << ",\n";
-                json_stream << "          \"" << contact->ball_hang_time.name << "\": \"" << std::dec << contact->ball_hang_time.get_value() << "\",\n";
-                json_stream << "          \"Contact Result - Primary\": "         << decode("PrimaryContactResult", contact->primary_contact_result, inDecode) << ",\n";
-                json_stream << "          \"Contact Result - Secondary\": "       << decode("SecondaryContactResult", contact->secondary_contact_result, inDecode);
-
-                //=== Fielder ===
-                //TODO could be reworked
-                if (contact->first_fielder.has_value() || contact->collect_fielder.has_value()){
-                    json_stream << ",\n";
-
-                    //First fielder to touch the ball
-                    Fielder* fielder;
-
-                    //If the fielder bobbled but the same fielder collected the ball OR there was no bobble, log single fielder
-                    
-                    if (contact->first_fielder.has_value()) { fielder = &contact->first_fielder.value(); }
-                    else {fielder = &contact->collect_fielder.value();}
-
-                    json_stream << "          \"First Fielder\": {\n";
-                    json_stream << "            \"Fielder Roster Location\": " << std::to_string(fielder->fielder_roster_loc) << ",\n";
-                    json_stream << "            \"Fielder Position\": "        << decode("Position", fielder->fielder_pos, inDecode) << ",\n";
-                    json_stream << "            \"Fielder Character\": "       << decode("Character", fielder->fielder_char_id, inDecode) << ",\n";
-                    json_stream << "            \"Fielder Action\": "          << decode("Action", fielder->fielder_action, inDecode) << ",\n";
-                    json_stream << "            \"Fielder Jump\": "            << std::to_string(fielder->fielder_jump) << ",\n";
-                    json_stream << "            \"Fielder Swap\": "            << std::to_string(fielder->fielder_swapped_for_batter) << ",\n";
-                    json_stream << "            \"Fielder Manual Selected\": " << decode("ManualSelect", fielder->fielder_manual_select_arg, inDecode) << ",\n";
-                    json_stream << "            \"Fielder Position - X\": "    << floatConverter(fielder->fielder_x_pos) << ",\n";
-                    json_stream << "            \"Fielder Position - Y\": "    << floatConverter(fielder->fielder_y_pos) << ",\n";
-                    json_stream << "            \"Fielder Position - Z\": "    << floatConverter(fielder->fielder_z_pos) << ",\n";
-                    json_stream << "            \"Fielder Bobble\": "          << decode("Bobble", fielder->bobble, inDecode) << "\n";
-                    json_stream << "          }\n";
-                    /*
-                    else if (contact->first_fielder.has_value() 
-                            && (contact->first_fielder->fielder_roster_loc != contact->collect_fielder->fielder_roster_loc)) {
-                        
-                        Fielder* first_fielder  = &contact->first_fielder.value();
-                        Fielder* second_fielder = &contact->collect_fielder.value();
-
-                        json_stream << "          \"First Fielder\": {\n";
-                        json_stream << "            \"Fielder Roster Location\": " << std::to_string(first_fielder->fielder_roster_loc) << ",\n";
-                        json_stream << "            \"Fielder Position\": "        << std::to_string(first_fielder->fielder_pos) << ",\n";
-                        json_stream << "            \"Fielder Character\": "       << std::to_string(first_fielder->fielder_char_id) << ",\n";
-                        json_stream << "            \"Fielder Action\": "          << std::to_string(first_fielder->fielder_action) << ",\n";
-                        json_stream << "            \"Fielder Swap\": "            << std::to_string(first_fielder->fielder_swapped_for_batter) << ",\n";
-                        json_stream << "            \"Fielder Position - X\": "    << floatConverter(first_fielder->fielder_x_pos) << ",\n";
-                        json_stream << "            \"Fielder Position - Y\": "    << floatConverter(first_fielder->fielder_y_pos) << ",\n";
-                        json_stream << "            \"Fielder Position - Z\": "    << floatConverter(first_fielder->fielder_z_pos) << ",\n";
-                        json_stream << "            \"Fielder Bobble\": "          << std::to_string(first_fielder->bobble) << "\n";
-                        json_stream << "          },\n";
-                        json_stream << "          \"Second Fielder\": {\n";
-                        json_stream << "            \"Fielder Roster Location\": " << std::to_string(second_fielder->fielder_roster_loc) << ",\n";
-                        json_stream << "            \"Fielder Position\": "        << std::to_string(second_fielder->fielder_pos) << ",\n";
-                        json_stream << "            \"Fielder Character\": "       << std::to_string(second_fielder->fielder_char_id) << ",\n";
-                        json_stream << "            \"Fielder Action\": "          << std::to_string(second_fielder->fielder_action) << ",\n";
-                        json_stream << "            \"Fielder Swap\": "            << std::to_string(second_fielder->fielder_swapped_for_batter) << ",\n";
-                        json_stream << "            \"Fielder Position - X\": "    << floatConverter(second_fielder->fielder_x_pos) << ",\n";
-                        json_stream << "            \"Fielder Position - Y\": "    << floatConverter(second_fielder->fielder_y_pos) << ",\n";
-                        json_stream << "            \"Fielder Position - Z\": "    << floatConverter(second_fielder->fielder_z_pos) << ",\n";
-                        json_stream << "            \"Fielder Bobble\": "          << std::to_string(second_fielder->bobble) << "\n";
-                        json_stream << "          }\n";
-                    }
-                    */
-                }
-                else{ //Finish contact section
-                    json_stream << "\n";
-                }
-                json_stream << "        }\n";
-            }
-            else { //Finish pitch section
-                json_stream << "\n";
-            }
-            json_stream << "      }\n";
+    const auto now = std::chrono::steady_clock::now();
+    if (!m_hud_stream.isOpen() && now >= m_hud_stream_retry){
+        if (!m_hud_stream.open(File::GetUserPath(D_HUDFILES_IDX) + "hud.stream")){
+            m_hud_stream_retry = now + cHUDStreamRetryInterval;
         }
-
-        std::string end_comma = (std::next(event_map_iter) !=  m_game_info.events.end()) ? "," : "";
-        json_stream << "    }" << end_comma << "\n";
     }
+    if (m_hud_stream.isOpen()){
+        TrackerHUDStream::State state{};
+        state.game_id = m_game_info.game_id;
+        state.event_num = m_game_info.event_num;
+        state.phase = after_play ? 1 : 0;
+        state.inning = event.inning;
+        state.half_inning = event.half_inning;
+        state.balls = event.balls;
+        state.strikes = event.strikes;
+        state.outs = event.outs;
+        state.away_score = event.away_score;
+        state.home_score = event.home_score;
+        state.away_stars = event.away_stars;
+        state.home_stars = event.home_stars;
+        state.is_star_chance = event.is_star_chance;
+        state.chem_links_ob = event.chem_links_ob;
+        state.pitcher_stamina = event.pitcher_stamina;
+        state.batter_roster_loc = event.batter_roster_loc;
+        state.pitcher_roster_loc = event.pitcher_roster_loc;
+        const bool half_inning = event.half_inning;
+        if (event.batter_roster_loc < cRosterSize){
+            state.batter_char_id = m_game_info.character_summaries[half_inning][event.batter_roster_loc].char_id;
+        }
+        if (event.pitcher_roster_loc < cRosterSize){
+            state.pitcher_char_id = m_game_info.character_summaries[!half_inning][event.pitcher_roster_loc].char_id;
+        }
 
-    json_stream << "  ]\n";
-    json_stream << "}\n";
+        const std::optional<Runner>* runners[] = {&event.runner_batter, &event.runner_1, &event.runner_2, &event.runner_3};
+        for (size_t base = 0; base < std::size(runners); ++base){
+            state.runners[base] = runners[base]->has_value() ? (*runners[base])->roster_loc : TrackerHUDStream::cNoRunner;
+        }
+        if (m_game_info.previous_state.has_value()){
+            state.prev_result_of_atbat = m_game_info.previous_state->result_of_atbat;
+            state.prev_rbi = m_game_info.previous_state->rbi;
+        }
+        m_hud_stream.publish(state);
+    }
 
-    return json_stream.str();
+    if (Config::Get(Config::MAIN_STAT_TRACKER_HUD_FILE)){
+        std::string hud_file_path = File::GetUserPath(D_HUDFILES_IDX) + "decoded.hud.json";
+        std::string_view json = getHUDJSON(fmt::format("{}{}", m_game_info.event_num, after_play ? 'b' : 'a'), event, m_game_info.previous_state, true);
+        File::Delete(hud_file_path);
+        File::WriteStringToFile(hud_file_path, json);
+    }
 }
 
-std::string StatTracker::getHUDJSON(std::string in_event_num, Event& in_curr_event, std::optional<Event> in_prev_event, bool inDecode){
-    std::stringstream json_stream;
-
+std::string_view StatTracker::getHUDJSON(std::string_view in_event_num, Event& in_curr_event, std::optional<Event>& in_prev_event, bool inDecode){
     if (in_curr_event.inning == 0) {
         return "{}";
     }
 
-    json_stream << "{\n";
-
-    json_stream << "  \"Event Num\": \""             << in_event_num << "\",\n";
-    json_stream << "  \"Away Player\": \""           << m_game_info.getAwayTeamPlayer().GetUsername() << "\",\n";
-    json_stream << "  \"Home Player\": \""           << m_game_info.getHomeTeamPlayer().GetUsername() << "\",\n";
-    json_stream << "  \"Inning\": "                  << std::to_string(in_curr_event.inning) << ",\n";
-    json_stream << "  \"Half Inning\": "             << std::to_string(in_curr_event.half_inning) << ",\n";
-    json_stream << "  \"Away Score\": "              << std::dec << in_curr_event.away_score << ",\n";
-    json_stream << "  \"Home Score\": "              << std::dec << in_curr_event.home_score << ",\n";
-    json_stream << "  \"Balls\": "                   << std::to_string(in_curr_event.balls) << ",\n";
-    json_stream << "  \"Strikes\": "                 << std::to_string(in_curr_event.strikes) << ",\n";
-    json_stream << "  \"Outs\": "                    << std::to_string(in_curr_event.outs) << ",\n";
-    json_stream << "  \"Star Chance\": "             << std::to_string(in_curr_event.is_star_chance) << ",\n";
-    json_stream << "  \"Away Stars\": "              << std::to_string(in_curr_event.away_stars) << ",\n";
-    json_stream << "  \"Home Stars\": "              << std::to_string(in_curr_event.home_stars) << ",\n";
-    json_stream << "  \"Pitcher Stamina\": "         << std::to_string(in_curr_event.pitcher_stamina) << ",\n";
-    json_stream << "  \"Chemistry Links on Base\": " << std::to_string(in_curr_event.chem_links_ob) << ",\n";
-    json_stream << "  \"" << in_curr_event.num_outs_during_play.name << "\": " << in_curr_event.num_outs_during_play.get_key_value_string().second << ",\n";
-    json_stream << "  \"Pitcher Roster Loc\": "      << std::to_string(in_curr_event.pitcher_roster_loc) << ",\n";
-    json_stream << "  \"Batter Roster Loc\": "       << std::to_string(in_curr_event.batter_roster_loc) << ",\n";
-
-    for (int team=0; team < 2; ++team){
-        for (int roster=0; roster < cRosterSize; ++roster){
+    //Reuses the buffer of the previous HUD, so this does not allocate once the buffer has grown
+    Common::JsonWriter& writer = m_hud_writer;
+    writer.Clear();
+    writer.BeginObject();
+
+    writer.String("Event Num", in_event_num);
+    writer.String("Away Player", m_game_info.getAwayTeamPlayer().GetUsername());
+    writer.String("Home Player", m_game_info.getHomeTeamPlayer().GetUsername());
+    writer.Number("Inning", in_curr_event.inning);
+    writer.Number("Half Inning", in_curr_event.half_inning);
+    writer.Number("Away Score", in_curr_event.away_score);
+    writer.Number("Home Score", in_curr_event.home_score);
+    writer.Number("Balls", in_curr_event.balls);
+    writer.Number("Strikes", in_curr_event.strikes);
+    writer.Number("Outs", in_curr_event.outs);
+    writer.Number("Star Chance", in_curr_event.is_star_chance);
+    writer.Number("Away Stars", in_curr_event.away_stars);
+    writer.Number("Home Stars", in_curr_event.home_stars);
+    writer.Number("Pitcher Stamina", in_curr_event.pitcher_stamina);
+    writer.Number("Chemistry Links on Base", in_curr_event.chem_links_ob);
+    writer.Number(in_curr_event.num_outs_during_play.name, in_curr_event.num_outs_during_play.get_value());
+    writer.Number("Pitcher Roster Loc", in_curr_event.pitcher_roster_loc);
+    writer.Number("Batter Roster Loc", in_curr_event.batter_roster_loc);
 
-            u8 captain_roster_loc = 0;
-            if (team == 0){
-                captain_roster_loc = (m_game_info.home_port == m_game_info.team0_port) ? m_game_info.team0_captain_roster_loc : m_game_info.team1_captain_roster_loc;
-            }
-            else{ // team == 1
-                captain_roster_loc = (m_game_info.away_port == m_game_info.team0_port) ? m_game_info.team0_captain_roster_loc : m_game_info.team1_captain_roster_loc;
-            }
+    for (int team=0; team < cNumOfTeams; ++team){
+        u8 captain_roster_loc = 0;
+        if (team == 0){
+            captain_roster_loc = (m_game_info.home_port == m_game_info.team0_port) ? m_game_info.team0_captain_roster_loc : m_game_info.team1_captain_roster_loc;
+        }
+        else{ // team == 1
+            captain_roster_loc = (m_game_info.away_port == m_game_info.team0_port) ? m_game_info.team0_captain_roster_loc : m_game_info.team1_captain_roster_loc;
+        }
 
-            std::string team_string = (team == 0) ? "Away" : "Home";
-
-            CharacterSummary& char_summary = m_game_info.character_summaries[team][roster];
-            std::string label = "\"" + team_string + " Roster " + std::to_string(roster) + "\": ";
-            json_stream << "  " << label << "{\n";
-            json_stream << "    \"Team\": \""        << std::to_string(team) << "\",\n";
-            json_stream << "    \"RosterID\": "      << std::to_string(roster) << ",\n";
-            json_stream << "    \"CharID\": "        << decode("Character", char_summary.char_id, inDecode) << ",\n";
-            json_stream << "    \"Superstar\": "     << std::to_string(char_summary.is_starred) << ",\n";
-            json_stream << "    \"Captain\": "       << std::to_string(roster == captain_roster_loc) << ",\n";
-            json_stream << "    \"Fielding Hand\": " << decode("Hand", char_summary.fielding_hand, inDecode) << ",\n";
-            json_stream << "    \"Batting Hand\": "  << decode("Hand", char_summary.batting_hand, inDecode) << ",\n";
-
-            //=== Defensive Stats ===
-            EndGameRosterDefensiveStats& def_stat = char_summary.end_game_defensive_stats;
-            json_stream << "    \"Defensive Stats\": {\n";
-            json_stream << "      \"Batters Faced\": "       << std::to_string(def_stat.batters_faced) << ",\n";
-            json_stream << "      \"Runs Allowed\": "        << std::dec << def_stat.runs_allowed << ",\n";
-            json_stream << "      \"Earned Runs\": "        << std::dec << def_stat.earned_runs << ",\n";
-            json_stream << "      \"Batters Walked\": "      << def_stat.batters_walked << ",\n";
-            json_stream << "      \"Batters Hit\": "         << def_stat.batters_hit << ",\n";
-            json_stream << "      \"Hits Allowed\": "        << def_stat.hits_allowed << ",\n";
-            json_stream << "      \"HRs Allowed\": "         << def_stat.homeruns_allowed << ",\n";
-            json_stream << "      \"Pitches Thrown\": "      << def_stat.pitches_thrown << ",\n";
-            json_stream << "      \"Stamina\": "             << def_stat.stamina << ",\n";
-            json_stream << "      \"Was Pitcher\": "         << std::to_string(def_stat.was_pitcher) << ",\n";
-            json_stream << "      \"Strikeouts\": "          << std::to_string(def_stat.strike_outs) << ",\n";
-            json_stream << "      \"Star Pitches Thrown\": " << std::to_string(def_stat.star_pitches_thrown) << ",\n";
-            json_stream << "      \"Big Plays\": "           << std::to_string(def_stat.big_plays) << ",\n";
-            json_stream << "      \"Outs Pitched\": "        << std::to_string(def_stat.outs_pitched) << ",\n";
-            json_stream << "      \"Batters Per Position\": [\n";
-
-            if (m_fielder_tracker[team].battersAtAnyPosition(roster, 0)){
-                json_stream << "        {\n";
-                for (int pos = 0; pos < cNumOfPositions; ++pos) {
-                    if (m_fielder_tracker[team].fielder_map[roster].batter_count_by_position[pos] > 0){
-                        std::string comma = (m_fielder_tracker[team].battersAtAnyPosition(roster, pos+1)) ? "," : "";
-                        json_stream << "            \"" << cPosition.at(pos) << "\": " << std::to_string(m_fielder_tracker[team].fielder_map[roster].batter_count_by_position[pos]) << comma << "\n";
-                    }
-                }
-                json_stream << "        }\n";
-            }
-            json_stream << "      ],\n";
-
-            json_stream << "      \"Batter Outs Per Position\": [\n";
-            if (m_fielder_tracker[team].batterOutsAtAnyPosition(roster, 0)){
-                json_stream << "        {\n";
-                for (int pos = 0; pos < cNumOfPositions; ++pos) {
-                    if (m_fielder_tracker[team].fielder_map[roster].batter_outs_by_position[pos] > 0){
-                        std::string comma = (m_fielder_tracker[team].batterOutsAtAnyPosition(roster, pos+1)) ? "," : "";
-                        json_stream << "            \"" << cPosition.at(pos) << "\": " << std::to_string(m_fielder_tracker[team].fielder_map[roster].batter_outs_by_position[pos]) << comma << "\n";
-                    }
-                }
-                json_stream << "        }\n";
-            }
-            json_stream << "      ],\n";
-
-            json_stream << "      \"Outs Per Position\": [\n";
-            if (m_fielder_tracker[team].outsAtAnyPosition(roster, 0)){
-                json_stream << "        {\n";
-                for (int pos = 0; pos < cNumOfPositions; ++pos) {
-                    if (m_fielder_tracker[team].fielder_map[roster].out_count_by_position[pos] > 0){
-                        std::string comma = (m_fielder_tracker[team].outsAtAnyPosition(roster, pos+1)) ? "," : "";
-                        json_stream << "            \"" << cPosition.at(pos) << "\": " << std::to_string(m_fielder_tracker[team].fielder_map[roster].out_count_by_position[pos]) << comma << "\n";
-                    }
-                }
-                json_stream << "        }\n";
-            }
-            json_stream << "      ]\n";
-            json_stream << "    },\n";
-
-            //=== Offensive Stats ===
-            EndGameRosterOffensiveStats& of_stat = char_summary.end_game_offensive_stats;
-            json_stream << "    \"Offensive Stats\": {\n";
-            json_stream << "      \"At Bats\": "          << std::to_string(of_stat.at_bats) << ",\n";
-            json_stream << "      \"Hits\": "             << std::to_string(of_stat.hits) << ",\n";
-            json_stream << "      \"Singles\": "          << std::to_string(of_stat.singles) << ",\n";
-            json_stream << "      \"Doubles\": "          << std::to_string(of_stat.doubles) << ",\n";
-            json_stream << "      \"Triples\": "          << std::to_string(of_stat.triples) << ",\n";
-            json_stream << "      \"Homeruns\": "         << std::to_string(of_stat.homeruns) << ",\n";
-            json_stream << "      \"Successful Bunts\": " << std::to_string(of_stat.successful_bunts) << ",\n";
-            json_stream << "      \"Sac Flys\": "         << std::to_string(of_stat.sac_flys) << ",\n";
-            json_stream << "      \"Strikeouts\": "       << std::to_string(of_stat.strikouts) << ",\n";
-            json_stream << "      \"Walks (4 Balls)\": "  << std::to_string(of_stat.walks_4balls) << ",\n";
-            json_stream << "      \"Walks (Hit)\": "      << std::to_string(of_stat.walks_hit) << ",\n";
-            json_stream << "      \"RBI\": "              << std::to_string(of_stat.rbi) << ",\n";
-            json_stream << "      \"Bases Stolen\": "     << std::to_string(of_stat.bases_stolen) << ",\n";
-            json_stream << "      \"Star Hits\": "        << std::to_string(of_stat.star_hits) << "\n";
-            json_stream << "    }\n";
-            json_stream << "  },\n";
+        for (int roster=0; roster < cRosterSize; ++roster){
+            writeRosterJSON(writer, team, roster, captain_roster_loc, inDecode);
         }
     }
 
     //=== Runners ===
-    //Build vector of <Runner*, Label/Name>
-    std::vector<std::pair<Runner*, std::string>> runners;
-    if (in_curr_event.runner_batter) {
-        runners.push_back({&in_curr_event.runner_batter.value(), "Batter"});
-    }
-    if (in_curr_event.runner_1) {
-        runners.push_back({&in_curr_event.runner_1.value(), "1B"});
-    }
-    if (in_curr_event.runner_2) {
-        runners.push_back({&in_curr_event.runner_2.value(), "2B"});
-    }
-    if (in_curr_event.runner_3) {
-        runners.push_back({&in_curr_event.runner_3.value(), "3B"});
-    }
-
-    for (auto runner = runners.begin(); runner != runners.end(); runner++){
-        Runner* runner_info = runner->first;
-        std::string& label = runner->second;
-
-        json_stream << "  \"Runner " << label << "\": {\n";
-        json_stream << "    \"Runner Roster Loc\": "   << std::to_string(runner_info->roster_loc) << ",\n";
-        json_stream << "    \"Runner Char Id\": "      << decode("Character", runner_info->char_id, inDecode) << ",\n";
-        json_stream << "    \"Runner Initial Base\": " << std::to_string(runner_info->initial_base) << ",\n";
-        json_stream << "    \"Out Type\": "            << decode("Out", runner_info->out_type, inDecode) << ",\n";
-        json_stream << "    \"Out Location\": "        << std::to_string(runner_info->out_location) << ",\n";
-        //json_stream << "    \"Runner Basepath Location\": "  << std::to_string(runner_info->basepath_location) << ",\n";
-        json_stream << "    \"Steal\": "               << decode("Steal", runner_info->steal, inDecode) << ",\n";
-        json_stream << "    \"Runner Result Base\": "  << std::to_string(runner_info->result_base) << "\n";
-        std::string comma = (std::next(runner) == runners.end() && !in_prev_event.has_value() ) ? "" : ",";
-        json_stream << "  }" << comma << "\n";
-    }
-
-    //Previous Event - return if first event of game. Else write the event
-    if (!in_prev_event.has_value()){
-        json_stream << "}";
-        return json_stream.str();
-    }
-
-    //=== Pitch ===
-
-    json_stream << "  \"Previous Event\": {\n";
-    json_stream << "    \"RBI\": "                     << std::to_string(in_prev_event->rbi) << ",\n";
-    std::string comma = (in_prev_event->pitch.has_value()) ? "," : "";
-    json_stream << "    \"Result of AB\": "            << decode("AtBatResult", in_prev_event->result_of_atbat, inDecode) << comma << "\n";
-    if (in_prev_event->pitch.has_value()){
-        Pitch* pitch = &in_prev_event->pitch.value();
-        json_stream << "    \"Pitch\": {\n";
-        json_stream << "      \"Pitcher Team Id\": "    << std::to_string(pitch->pitcher_team_id) << ",\n";
-        json_stream << "      \"Pitcher Char Id\": "    << decode("Character", pitch->pitcher_char_id, inDecode) << ",\n";
-        json_stream << "      \"Pitch Type\": "         << decode("Pitch", pitch->pitch_type, inDecode) << ",\n";
-        json_stream << "      \"Charge Type\": "        << decode("ChargePitch", pitch->charge_type, inDecode) << ",\n";
-        json_stream << "      \"Star Pitch\": "         << std::to_string(pitch->star_pitch) << ",\n";
-        json_stream << "      \"Pitch Speed\": "        << std::to_string(pitch->pitch_speed) << ",\n";
-        json_stream << "      \"Ball Position - Strikezone\": "   << floatConverter(pitch->ball_z_strike_vs_ball) << ",\n";
-        json_stream << "      \"In Strikezone\": "      << std::to_string(pitch->ball_in_strikezone) << ",\n";
-        json_stream << "        \"" << pitch->bat_contact_x_pos.name << "\": " << floatConverter(pitch->bat_contact_x_pos.get_value()) << ",\n";
-        json_stream << "        \"" << pitch->bat_contact_z_pos.name << "\": " << floatConverter(pitch->bat_contact_z_pos.get_value()) << ",\n";
-        json_stream << "      \"DB\": "                 << std::to_string(pitch->db) << ",\n";
-        json_stream << "      \"Type of Swing\": "      << decode("Swing", pitch->type_of_swing, inDecode);
-        
-        //=== Contact ===
-        if (pitch->contact.has_value() && pitch->contact->type_of_contact.get_value() != 0xFF){
-            json_stream << ",\n";
-
-            Contact* contact = &pitch->contact.value();
-            json_stream << "      \"Contact\": {\n";
-            json_stream << "        \"" << contact->type_of_contact.name << "\":" << decode("Contact", contact->type_of_contact.get_value(), inDecode) << ",\n";
-            json_stream << "        \"" << contact->charge_power_up.name << "\": " << floatConverter(contact->charge_power_up.get_value()) << ",\n";
-            json_stream << "        \"" << contact->charge_power_down.name << "\": " << floatConverter(contact->charge_power_down.get_value()) << ",\n";
-            json_stream << "        \"" << contact->moon_shot.name << "\": " << contact->moon_shot.get_key_value_string().second << ",\n"; 
-            json_stream << "        \"" << contact->input_direction_push_pull.name << "\": " << decode("Stick", contact->input_direction_push_pull.get_value(), inDecode) << ",\n";
-            json_stream << "        \"" << contact->input_direction_stick.name << "\": " << decode("StickVec", contact->input_direction_stick.get_value(), inDecode) << ",\n";
-            json_stream << "        \"" << contact->frame_of_swing.name << "\": \"" << std::dec << contact->frame_of_swing.get_value() << "\",\n";
-            json_stream << "        \"" << contact->power.name << "\": \"" << std::dec << contact->power.get_value() <<"\",\n";
-            json_stream << "        \"" << contact->vert_angle.name << "\": \"" << std::dec << contact->vert_angle.get_value() << "\",\n";
-            json_stream << "        \"" << contact->horiz_angle.name << "\": \"" << std::dec << contact->horiz_angle.get_value() << "\",\n";
-            json_stream << "        \"" << contact->contact_absolute.name << "\": " << floatConverter(contact->contact_absolute.get_value()) << ",\n";
-            json_stream << "        \"" << contact->contact_quality.name << "\": " << floatConverter(contact->contact_quality.get_value()) << ",\n";
-            json_stream << "        \"" << contact->rng1.name << "\": \"" << std::dec << contact->rng1.get_value() << "\",\n";
-            json_stream << "        \"" << contact->rng2.name << "\": \"" << std::dec << contact->rng2.get_value() << "\",\n";
-            json_stream << "        \"" << contact->rng3.name << "\": \"" << std::dec << contact->rng3.get_value() << "\",\n";
-            json_stream << "        \"" << contact->ball_x_velo.name << "\": " << floatConverter(contact->ball_x_velo.get_value()) << ",\n";
-            json_stream << "        \"" << contact->ball_y_velo.name << "\": " << floatConverter(contact->ball_y_velo.get_value()) << ",\n";
-            json_stream << "        \"" << contact->ball_z_velo.name << "\": " << floatConverter(contact->ball_z_velo.get_value()) << ",\n";
-            json_stream << "        \"" << contact->ball_contact_x_pos.name << "\": " << floatConverter(contact->ball_contact_x_pos.get_value()) << ",\n";
-            json_stream << "        \"" << contact->ball_contact_z_pos.name << "\": " << floatConverter(contact->ball_contact_z_pos.get_value()) << ",\n";
-            json_stream << "        \"" << contact->ball_x_pos.name << "\": " << floatConverter(contact->ball_x_pos.get_value()) << ",\n";
-            json_stream << "        \"" << contact->ball_y_pos.name << "\": " << floatConverter(contact->ball_y_pos.get_value()) << ",\n";
-            json_stream << "        \"" << contact->ball_z_pos.name << "\": " << floatConverter(contact->ball_z_pos.get_value()) << ",\n";
-            json_stream << "        \"" << contact->ball_hang_time.name << "\": " << std::dec << contact->ball_hang_time.get_value() << ",\n";
-            json_stream << "        \"" << contact->ball_max_height.name << "\": " << floatConverter(contact->ball_max_height.get_value()) << ",\n";
-            json_stream << "        \"Contact Result - Primary\": "         << decode("PrimaryContactResult", contact->primary_contact_result, inDecode) << ",\n";
-            json_stream << "        \"Contact Result - Secondary\": "       << decode("SecondaryContactResult", contact->secondary_contact_result, inDecode);
-
-            //=== Fielder ===
-            //TODO could be reworked
-            if (contact->first_fielder.has_value() || contact->collect_fielder.has_value()){
-                json_stream << ",\n";
-
-                //First fielder to touch the ball
-                Fielder* fielder;
-
-                //If the fielder bobbled but the same fielder collected the ball OR there was no bobble, log single fielder
-                
-                if (contact->first_fielder.has_value()) { fielder = &contact->first_fielder.value(); }
-                else {fielder = &contact->collect_fielder.value();}
-
-                json_stream << "        \"First Fielder\": {\n";
-                json_stream << "          \"Fielder Roster Location\": " << std::to_string(fielder->fielder_roster_loc) << ",\n";
-                json_stream << "          \"Fielder Position\": "        << decode("Position", fielder->fielder_pos, inDecode) << ",\n";
-                json_stream << "          \"Fielder Character\": "       << decode("Character", fielder->fielder_char_id, inDecode) << ",\n";
-                json_stream << "          \"Fielder Action\": "          << decode("Action", fielder->fielder_action, inDecode) << ",\n";
-                json_stream << "          \"Fielder Jump\": "            << std::to_string(fielder->fielder_jump) << ",\n";
-                json_stream << "          \"Fielder Swap\": "            << std::to_string(fielder->fielder_swapped_for_batter) << ",\n";
-                json_stream << "          \"Fielder Manual Selected\": " << decode("ManualSelect", fielder->fielder_manual_select_arg, inDecode) << ",\n";
-                json_stream << "          \"Fielder Position - X\": "    << floatConverter(fielder->fielder_x_pos) << ",\n";
-                json_stream << "          \"Fielder Position - Y\": "    << floatConverter(fielder->fielder_y_pos) << ",\n";
-                json_stream << "          \"Fielder Position - Z\": "    << floatConverter(fielder->fielder_z_pos) << ",\n";
-                json_stream << "          \"Fielder Bobble\": "          << decode("Bobble", fielder->bobble, inDecode) << "\n";
-                json_stream << "        }\n";
-            }
-            else{ //Finish contact section
-                json_stream << "\n";
-            }
-            json_stream << "      }\n"; //close contact
-        }
-        else { //Finish pitch section
-            json_stream << "\n";
+    writeRunnersJSON(writer, in_curr_event, inDecode);
+
+    //Previous Event - skip if first event of game. Else write the event
+    if (in_prev_event.has_value()){
+        Event& prev_event = in_prev_event.value();
+        writer.BeginObject("Previous Event");
+        writer.Number("RBI", prev_event.rbi);
+        writeDecoded(writer, "Result of AB", DecodeType::AtBatResult, prev_event.result_of_atbat, inDecode);
+        if (prev_event.pitch.has_value()){
+            writePitchJSON(writer, prev_event.pitch.value(), inDecode, false);
         }
-        json_stream << "    }\n"; //Close pitch
+        writer.EndObject(); //Close Previous Event
     }
-    json_stream << "  }\n"; //Close Previous Event
-    json_stream << "}";
-    return json_stream.str();
+
+    writer.EndObject();
+    return writer.GetView();
 }
 
 //Scans player for possession
@@ -1553,27 +1766,27 @@ std::optional<StatTracker::Fielder> StatTracker::logFielderWithBall(const Core::
         u32 aFielderRosterLoc = aFielder_RosterLoc + (pos * cFielder_Offset);
         u32 aFielderCharId = aFielder_CharId + (pos * cFielder_Offset);
 
-        bool fielder_has_ball = (PowerPC::MMU::HostRead_U8(guard, aFielderControlStatus) == 0xA);
+        bool fielder_has_ball = (m_read_plan.read<u8>(guard, aFielderControlStatus) == 0xA);
 
         if (fielder_has_ball) {
             Fielder fielder_with_ball;
             //get char id
-            fielder_with_ball.fielder_roster_loc = PowerPC::MMU::HostRead_U8(guard, aFielderRosterLoc);
-            fielder_with_ball.fielder_char_id = PowerPC::MMU::HostRead_U8(guard, aFielderCharId);
+            fielder_with_ball.fielder_roster_loc = m_read_plan.read<u8>(guard, aFielderRosterLoc);
+            fielder_with_ball.fielder_char_id = m_read_plan.read<u8>(guard, aFielderCharId);
             fielder_with_ball.fielder_pos = pos;
 
-            fielder_with_ball.fielder_x_pos = PowerPC::MMU::HostRead_U32(guard, aFielderPosX);
-            fielder_with_ball.fielder_y_pos = PowerPC::MMU::HostRead_U32(guard, aFielderPosY);
-            fielder_with_ball.fielder_z_pos = PowerPC::MMU::HostRead_U32(guard, aFielderPosZ);
+            fielder_with_ball.fielder_x_pos = m_read_plan.read<u32>(guard, aFielderPosX);
+            fielder_with_ball.fielder_y_pos = m_read_plan.read<u32>(guard, aFielderPosY);
+            fielder_with_ball.fielder_z_pos = m_read_plan.read<u32>(guard, aFielderPosZ);
 
-            if (PowerPC::MMU::HostRead_U8(guard, aFielderAction)) {
-                fielder_with_ball.fielder_action = PowerPC::MMU::HostRead_U8(guard, aFielderAction); //2 = Slide, 3 = Walljump
+            if (m_read_plan.read<u8>(guard, aFielderAction)) {
+                fielder_with_ball.fielder_action = m_read_plan.read<u8>(guard, aFielderAction); //2 = Slide, 3 = Walljump
             }
-            if (PowerPC::MMU::HostRead_U8(guard, aFielderJump)) {
-                fielder_with_ball.fielder_jump = PowerPC::MMU::HostRead_U8(guard, aFielderJump); //1 = jump
+            if (m_read_plan.read<u8>(guard, aFielderJump)) {
+                fielder_with_ball.fielder_jump = m_read_plan.read<u8>(guard, aFielderJump); //1 = jump
             }
 
-            fielder_with_ball.fielder_manual_select_arg = PowerPC::MMU::HostRead_U8(guard, aFielder_ManualSelectArg);
+            fielder_with_ball.fielder_manual_select_arg = m_read_plan.read<u8>(guard, aFielder_ManualSelectArg);
 
             std::cout << "Fielder Pos=" << std::to_string(pos) << " Fielder RosterLoc=" << std::to_string(fielder_with_ball.fielder_roster_loc)
                       << " Fielder Action: " << std::to_string(fielder_with_ball.fielder_action)
@@ -1605,8 +1818,8 @@ std::optional<StatTracker::Fielder> StatTracker::logFielderBobble(const Core::CP
         u32 aFielderCharId = aFielder_CharId + (pos * cFielder_Offset);
         
         u8 typeOfFielderDisruption = 0x0;
-        u8 bobble_addr = PowerPC::MMU::HostRead_U8(guard, aFielderBobbleStatus);
-        u8 knockout_addr = PowerPC::MMU::HostRead_U8(guard, aFielderKnockoutStatus);
+        u8 bobble_addr = m_read_plan.read<u8>(guard, aFielderBobbleStatus);
+        u8 knockout_addr = m_read_plan.read<u8>(guard, aFielderKnockoutStatus);
 
         if (knockout_addr) {
             typeOfFielderDisruption = 0x10; //Knockout - no bobble
@@ -1618,24 +1831,24 @@ std::optional<StatTracker::Fielder> StatTracker::logFielderBobble(const Core::CP
         if (typeOfFielderDisruption > 0x1) {
             Fielder fielder_that_bobbled;
             //get char id
-            fielder_that_bobbled.fielder_roster_loc = PowerPC::MMU::HostRead_U8(guard, aFielderRosterLoc);
-            fielder_that_bobbled.fielder_char_id = PowerPC::MMU::HostRead_U8(guard, aFielderCharId);
+            fielder_that_bobbled.fielder_roster_loc = m_read_plan.read<u8>(guard, aFielderRosterLoc);
+            fielder_that_bobbled.fielder_char_id = m_read_plan.read<u8>(guard, aFielderCharId);
 
-            fielder_that_bobbled.fielder_x_pos = PowerPC::MMU::HostRead_U32(guard, aFielderPosX);
-            fielder_that_bobbled.fielder_y_pos = PowerPC::MMU::HostRead_U32(guard, aFielderPosY);
-            fielder_that_bobbled.fielder_z_pos = PowerPC::MMU::HostRead_U32(guard, aFielderPosZ);
+            fielder_that_bobbled.fielder_x_pos = m_read_plan.read<u32>(guard, aFielderPosX);
+            fielder_that_bobbled.fielder_y_pos = m_read_plan.read<u32>(guard, aFielderPosY);
+            fielder_that_bobbled.fielder_z_pos = m_read_plan.read<u32>(guard, aFielderPosZ);
             fielder_that_bobbled.fielder_pos = pos;
             fielder_that_bobbled.bobble = typeOfFielderDisruption;
 
-            if (PowerPC::MMU::HostRead_U8(guard, aFielderAction)) {
-                fielder_that_bobbled.fielder_action = PowerPC::MMU::HostRead_U8(guard, aFielderAction); //2 = Slide, 3 = Walljump
+            if (m_read_plan.read<u8>(guard, aFielderAction)) {
+                fielder_that_bobbled.fielder_action = m_read_plan.read<u8>(guard, aFielderAction); //2 = Slide, 3 = Walljump
             }
-            if (PowerPC::MMU::HostRead_U8(guard, aFielderJump)) {
-                fielder_that_bobbled.fielder_jump = PowerPC::MMU::HostRead_U8(guard, aFielderJump); //1 = jump
+            if (m_read_plan.read<u8>(guard, aFielderJump)) {
+                fielder_that_bobbled.fielder_jump = m_read_plan.read<u8>(guard, aFielderJump); //1 = jump
             }
 
             //We can read manual select now because we don't have the ball
-            fielder_that_bobbled.fielder_manual_select_arg = PowerPC::MMU::HostRead_U8(guard, aFielder_ManualSelectArg);
+            fielder_that_bobbled.fielder_manual_select_arg = m_read_plan.read<u8>(guard, aFielder_ManualSelectArg);
 
             std::cout << "Fielder Pos=" << std::to_string(pos) << " Fielder RosterLoc=" << std::to_string(fielder_that_bobbled.fielder_roster_loc)
                       << " Fielder Action: " << std::to_string(fielder_that_bobbled.fielder_action) 
@@ -1700,6 +1913,10 @@ void StatTracker::clearTagSetId(bool netplay) {
 
 
 bool StatTracker::shouldSubmitGame() {
+    if (!m_submitter) {
+        return false;
+    }
+
     bool cpuInGame = (m_game_info.getAwayTeamPlayer().GetUserID() == "CPU") || (m_game_info.getHomeTeamPlayer().GetUserID() == "CPU");
     bool tag_set_game = m_game_info.tag_set_id.has_value();
     std::cout << "Checking game submission. TagSetSelected=" << tag_set_game << " cpuInGame=" << cpuInGame << "\n";
@@ -1743,10 +1960,10 @@ void StatTracker::initPlayerInfo(const Core::CPUThreadGuard& guard){
     //Collect port info for players
     if (m_game_info.team0_port == 0xFF && m_game_info.team1_port == 0xFF){
         //From Roeming
-        std::array<u8, 2> ports = {PowerPC::MMU::HostRead_U8(guard, 0x800e874c), PowerPC::MMU::HostRead_U8(guard, 0x800e874d)};
+        std::array<u8, 2> ports = {m_read_plan.read<u8>(guard, 0x800e874c), m_read_plan.read<u8>(guard, 0x800e874d)};
         
-        u8 BattingPort = ports[PowerPC::MMU::HostRead_U32(guard, 0x80892990)];
-        u8 FieldingPort = ports[PowerPC::MMU::HostRead_U32(guard, 0x80892994)];
+        u8 BattingPort = ports[m_read_plan.read<u32>(guard, 0x80892990)];
+        u8 FieldingPort = ports[m_read_plan.read<u32>(guard, 0x80892994)];
         
         m_game_info.team0_port = ports[0];
         m_game_info.team1_port = ports[1];
@@ -1768,8 +1985,8 @@ void StatTracker::initPlayerInfo(const Core::CPUThreadGuard& guard){
             home_player_name = m_game_info.team0_player.GetUsername();
         }
 
-        std::cout << "ports[0]=" << std::to_string(PowerPC::MMU::HostRead_U8(guard, 0x800e874c)) << " ports[1]=" << std::to_string(PowerPC::MMU::HostRead_U8(guard, 0x800e874d)) << "\n";
-        std::cout << "BattingPort=" << std::to_string(PowerPC::MMU::HostRead_U32(guard, 0x80892990)) << " FieldingPort=" << std::to_string(PowerPC::MMU::HostRead_U32(guard, 0x80892994)) << "\n";
+        std::cout << "ports[0]=" << std::to_string(m_read_plan.read<u8>(guard, 0x800e874c)) << " ports[1]=" << std::to_string(m_read_plan.read<u8>(guard, 0x800e874d)) << "\n";
+        std::cout << "BattingPort=" << std::to_string(m_read_plan.read<u32>(guard, 0x80892990)) << " FieldingPort=" << std::to_string(m_read_plan.read<u32>(guard, 0x80892994)) << "\n";
 
         std::cout << "Info:  Fielder Port=" << std::to_string(FieldingPort) << ", Batter Port=" << std::to_string(BattingPort) << "\n";
         std::cout << "Info:  Team0 Port=" << std::to_string(m_game_info.team0_port) << ", Team1 Port=" << std::to_string(m_game_info.team1_port) << "\n";
@@ -1778,12 +1995,14 @@ void StatTracker::initPlayerInfo(const Core::CPUThreadGuard& guard){
 
         initCaptains(guard);
     }
+
+    writeStatFileGameInfo();
 }
 
 void StatTracker::initCaptains(const Core::CPUThreadGuard& guard)
 {
-    m_game_info.team0_captain_roster_loc = PowerPC::MMU::HostRead_U8(guard, aTeam0_Captain_Roster_Loc);
-    m_game_info.team1_captain_roster_loc = PowerPC::MMU::HostRead_U8(guard, aTeam1_Captain_Roster_Loc);
+    m_game_info.team0_captain_roster_loc = m_read_plan.read<u8>(guard, aTeam0_Captain_Roster_Loc);
+    m_game_info.team1_captain_roster_loc = m_read_plan.read<u8>(guard, aTeam1_Captain_Roster_Loc);
 
     u8 away_captain_roster_loc = (m_game_info.away_port == m_game_info.team0_port) ? m_game_info.team0_captain_roster_loc : m_game_info.team1_captain_roster_loc;
     u8 home_captain_roster_loc = (m_game_info.home_port == m_game_info.team0_port) ? m_game_info.team0_captain_roster_loc : m_game_info.team1_captain_roster_loc;
@@ -1793,43 +2012,31 @@ void StatTracker::initCaptains(const Core::CPUThreadGuard& guard)
 }
 
 void StatTracker::onGameQuit(const Core::CPUThreadGuard& guard){
-    u8 quitter_port = PowerPC::MMU::HostRead_U8(guard, aWhoQuit);
+    u8 quitter_port = m_read_plan.read<u8>(guard, aWhoQuit);
     m_game_info.quitter_team = (quitter_port == m_game_info.away_port);
     logGameInfo(guard);
 
     std::cout << "Quit detected\n";
 
     //Game has ended. Write file but do not submit
-    std::string jsonPath = getStatJsonPath("quit.decode.");
-    std::string json = getStatJSON(true);
-    
-    File::WriteStringToFile(jsonPath, json);
-
-    jsonPath = getStatJsonPath("quit.");
-    json = getStatJSON(false, true);
-    
-    File::WriteStringToFile(jsonPath, json);
+    writeGameFiles("quit.decode.", "quit.", false);
+    closeStatFile(true);
 
-    // json = getStatJSON(false, false);
     // if (shouldSubmitGame()) {
-    //     const Common::HttpRequest::Response response =
-    //     m_http.Post("https://api.projectrio.app/populate_db/", json,
-    //         {
-    //             {"Content-Type", "application/json"},
-    //         }
-    //     );
+    //     writeStatJSON(m_json_writer, false, false);
+    //     m_submitter->SubmitGame(m_game_info.game_id, m_json_writer.GetString());
     // }
 }
 
 std::optional<StatTracker::Runner> StatTracker::logRunnerInfo(const Core::CPUThreadGuard& guard, u8 base){
     std::optional<Runner> runner;
     //See if there is a runner in this pos
-    if (PowerPC::MMU::HostRead_U8(guard, aRunner_RosterLoc + (base * cRunner_Offset)) != 0xFF){
+    if (m_read_plan.read<u8>(guard, aRunner_RosterLoc + (base * cRunner_Offset)) != 0xFF){
         Runner init_runner;
-        init_runner.roster_loc = PowerPC::MMU::HostRead_U8(guard, aRunner_RosterLoc + (base * cRunner_Offset));
-        init_runner.char_id = PowerPC::MMU::HostRead_U8(guard, aRunner_CharId + (base * cRunner_Offset));
+        init_runner.roster_loc = m_read_plan.read<u8>(guard, aRunner_RosterLoc + (base * cRunner_Offset));
+        init_runner.char_id = m_read_plan.read<u8>(guard, aRunner_CharId + (base * cRunner_Offset));
         init_runner.initial_base = base;
-        init_runner.basepath_location = PowerPC::MMU::HostRead_U32(guard, aRunner_BasepathPercentage + (base * cRunner_Offset));
+        init_runner.basepath_location = m_read_plan.read<u32>(guard, aRunner_BasepathPercentage + (base * cRunner_Offset));
         runner = std::make_optional(init_runner);
         return runner;        
     }
@@ -1838,9 +2045,9 @@ std::optional<StatTracker::Runner> StatTracker::logRunnerInfo(const Core::CPUThr
 
 bool StatTracker::anyRunnerStealing(const Core::CPUThreadGuard& guard, Event& in_event)
 {
-    u8 runner_1_stealing = PowerPC::MMU::HostRead_U8(guard, aRunner_Stealing + (1 * cRunner_Offset));
-    u8 runner_2_stealing = PowerPC::MMU::HostRead_U8(guard, aRunner_Stealing + (2 * cRunner_Offset));
-    u8 runner_3_stealing = PowerPC::MMU::HostRead_U8(guard, aRunner_Stealing + (3 * cRunner_Offset));
+    u8 runner_1_stealing = m_read_plan.read<u8>(guard, aRunner_Stealing + (1 * cRunner_Offset));
+    u8 runner_2_stealing = m_read_plan.read<u8>(guard, aRunner_Stealing + (2 * cRunner_Offset));
+    u8 runner_3_stealing = m_read_plan.read<u8>(guard, aRunner_Stealing + (3 * cRunner_Offset));
 
     return (runner_1_stealing || runner_2_stealing || runner_3_stealing);
 }
@@ -1850,169 +2057,92 @@ void StatTracker::logRunnerEvents(const Core::CPUThreadGuard& guard, Runner* in_
     if (in_runner->out_type != 0 ) { return; }
 
     //Return if runner has already gotten out
-    in_runner->out_type = PowerPC::MMU::HostRead_U8(guard, aRunner_OutType + (in_runner->initial_base * cRunner_Offset));
+    in_runner->out_type = m_read_plan.read<u8>(guard, aRunner_OutType + (in_runner->initial_base * cRunner_Offset));
     if (in_runner->out_type != 0) {
-        in_runner->out_location = PowerPC::MMU::HostRead_U8(guard, aRunner_CurrentBase + (in_runner->initial_base * cRunner_Offset));
+        in_runner->out_location = m_read_plan.read<u8>(guard, aRunner_CurrentBase + (in_runner->initial_base * cRunner_Offset));
         in_runner->result_base = 0xFF;
-        in_runner->basepath_location = PowerPC::MMU::HostRead_U32(guard, aRunner_BasepathPercentage + (in_runner->initial_base * cRunner_Offset));
+        in_runner->basepath_location = m_read_plan.read<u32>(guard, aRunner_BasepathPercentage + (in_runner->initial_base * cRunner_Offset));
 
         std::cout << "Logging Runner " << std::to_string(in_runner->initial_base) << ": Out. Type=" << std::to_string(in_runner->out_type)
         << " Location=" << std::to_string(in_runner->out_location) << "\n";
     }
     else{
-        in_runner->result_base = PowerPC::MMU::HostRead_U8(guard, aRunner_CurrentBase + (in_runner->initial_base * cRunner_Offset));
+        in_runner->result_base = m_read_plan.read<u8>(guard, aRunner_CurrentBase + (in_runner->initial_base * cRunner_Offset));
     }
 
-    if (PowerPC::MMU::HostRead_U8(guard, aRunner_Stealing + (in_runner->initial_base * cRunner_Offset)) > in_runner->steal){
-        in_runner->steal = PowerPC::MMU::HostRead_U8(guard, aRunner_Stealing + (in_runner->initial_base * cRunner_Offset));
+    if (m_read_plan.read<u8>(guard, aRunner_Stealing + (in_runner->initial_base * cRunner_Offset)) > in_runner->steal){
+        in_runner->steal = m_read_plan.read<u8>(guard, aRunner_Stealing + (in_runner->initial_base * cRunner_Offset));
         std::cout << "Logging Runner " << std::to_string(in_runner->initial_base) << ": Steal. Type=" << std::to_string(in_runner->steal)<< "\n";
     }
 }
 
-std::string StatTracker::decode(std::string type, u8 value, bool decode){
-    if (!decode) { return std::to_string(value);}
-
-    std::string retVal = "Unable to Decode";
-    
-    if (type == "Character"){
-        if (cCharIdToCharName.count(value)){
-            retVal = cCharIdToCharName.at(value);
-        }
-    }
-    else if (type == "Stadium"){
-        if (cStadiumIdToStadiumName.count(value)){
-            retVal = cStadiumIdToStadiumName.at(value);
-        }
-    }
-    else if (type == "Contact"){
-        if (cTypeOfContactToHR.count(value)){
-            retVal = cTypeOfContactToHR.at(value);
-        }
-    }
-    else if (type == "Hand"){
-        if (cHandToHR.count(value)){
-            retVal = cHandToHR.at(value);
-        }
+static const std::map<u8, std::string>* getDecodeTable(StatTracker::DecodeType type){
+    using DecodeType = StatTracker::DecodeType;
+    switch (type){
+        case DecodeType::Character:              return &cCharIdToCharName;
+        case DecodeType::Stadium:                return &cStadiumIdToStadiumName;
+        case DecodeType::Contact:                return &cTypeOfContactToHR;
+        case DecodeType::Hand:                   return &cHandToHR;
+        case DecodeType::Stick:                  return &cInputDirectionToHR;
+        case DecodeType::Pitch:                  return &cPitchTypeToHR;
+        case DecodeType::ChargePitch:            return &cChargePitchTypeToHR;
+        case DecodeType::Swing:                  return &cTypeOfSwing;
+        case DecodeType::Position:               return &cPosition;
+        case DecodeType::Action:                 return &cFielderActions;
+        case DecodeType::Bobble:                 return &cFielderBobbles;
+        case DecodeType::ManualSelect:           return &cManualSelectDecode;
+        case DecodeType::Steal:                  return &cStealType;
+        case DecodeType::Out:                    return &cOutType;
+        case DecodeType::PrimaryContactResult:   return &cPrimaryContactResult;
+        case DecodeType::SecondaryContactResult: return &cSecondaryContactResult;
+        case DecodeType::PitchResult:            return &cPitchResult;
+        case DecodeType::AtBatResult:            return &cAtBatResult;
+        default:                                 return nullptr;
     }
-    else if (type == "Stick"){
-        if (cInputDirectionToHR.count(value)){
-            retVal = cInputDirectionToHR.at(value);
-        }
+}
+
+void StatTracker::writeDecoded(Common::JsonWriter& writer, std::string_view key, DecodeType type, u8 value, bool decode){
+    if (!decode) {
+        writer.Number(key, value);
+        return;
     }
-    else if (type == "StickVec"){
-        retVal = "";
-        if ( (value & 0x1) > 0 ){
-            if (retVal != ""){
-                retVal += "+";
-            }
-            retVal += "Left";
-        }
-        if ( (value & 0x2) > 0 ){
-            if (retVal != ""){
-                retVal += "+";
-            }
-            retVal += "Right";
-        } 
-        if ( (value & 0x4) > 0 ){
-            if (retVal != ""){
-                retVal += "+";
+
+    if (type == DecodeType::StickVec){
+        //Builds e.g. "Left+Up" from the direction bits. Fits the small string buffer so nothing is allocated
+        static constexpr std::array<std::string_view, 4> directions = {"Left", "Right", "Down", "Up"};
+        std::array<char, 32> buffer;
+        size_t length = 0;
+        for (size_t bit = 0; bit < directions.size(); ++bit){
+            if ((value & (1 << bit)) == 0) {
+                continue;
             }
-            retVal += "Down";
-        } 
-        if ( (value & 0x8) > 0 ){
-            if (retVal != ""){
-                retVal += "+";
+            if (length != 0) {
+                buffer[length++] = '+';
             }
-            retVal += "Up";
-        } 
-    }
-    else if (type == "Pitch"){
-        if (cPitchTypeToHR.count(value)){
-            retVal = cPitchTypeToHR.at(value);
-        }
-    }
-    else if (type == "ChargePitch"){
-        if (cChargePitchTypeToHR.count(value)){
-            retVal = cChargePitchTypeToHR.at(value);
-        }
-    }
-    else if (type == "Swing"){
-        if (cTypeOfSwing.count(value)){
-            retVal = cTypeOfSwing.at(value);
-        }
-    }
-    else if (type == "Position"){
-        if (cPosition.count(value)){
-            retVal = cPosition.at(value);
-        }
-    }
-    else if (type == "Action"){
-        if (cFielderActions.count(value)){
-            retVal = cFielderActions.at(value);
-        }
-    }
-    else if (type == "Bobble"){
-        if (cFielderBobbles.count(value)){
-            retVal = cFielderBobbles.at(value);
-        }
-    }
-    else if (type == "ManualSelect"){
-        if (cManualSelectDecode.count(value)){
-            retVal = cManualSelectDecode.at(value);
-        }
-    }
-    else if (type == "Steal"){
-        if (cStealType.count(value)){
-            retVal = cStealType.at(value);
+            directions[bit].copy(&buffer[length], directions[bit].size());
+            length += directions[bit].size();
         }
+        writer.String(key, std::string_view(buffer.data(), length));
+        return;
     }
-    else if (type == "Out"){
-        if (cOutType.count(value)){
-            retVal = cOutType.at(value);
-        }
-    }
-    else if (type == "PrimaryContactResult"){
-        if (cPrimaryContactResult.count(value)){
-            retVal = cPrimaryContactResult.at(value);
-        }
-    }
-    else if (type == "SecondaryContactResult"){
-        if (cSecondaryContactResult.count(value)){
-            retVal = cSecondaryContactResult.at(value);
-        }
-    }
-    else if (type == "PitchResult"){
-        if (cPitchResult.count(value)){
-            retVal = cPitchResult.at(value);
-        }
-    }
-    else if (type == "AtBatResult"){
-        if (cAtBatResult.count(value)){
-            retVal = cAtBatResult.at(value);
+
+    if (type == DecodeType::QuitterTeam){
+        switch (value){
+            case 0:    writer.String(key, "Home");  return;
+            case 1:    writer.String(key, "Away");  return;
+            case 2:    writer.String(key, "Crash"); return;
+            case 0xFF: writer.String(key, "None");  return;
         }
     }
-    else if (type == "QuitterTeam"){
-        if (value == 0){
-            retVal = "Home";
-        }
-        else if (value == 1){
-            retVal = "Away";
-        }
-        else if (value == 2){
-            retVal = "Crash";
-        }
-        else if (value == 0xFF){
-            retVal = "None";
+    else if (const std::map<u8, std::string>* table = getDecodeTable(type)){
+        const auto it = table->find(value);
+        if (it != table->end()){
+            writer.String(key, it->second);
+            return;
         }
     }
-    else{
-        retVal += ". Invalid Type (" + type + ")";
-    }
-    
-    if (retVal == "Unable to Decode"){
-        retVal += ". Invalid Value (" + std::to_string(value) + ").";
-    }
-    return ("\"" + retVal + "\"");
+
+    writer.String(key, fmt::format("Unable to Decode. Invalid Value ({}).", value));
 }
 
 void StatTracker::postOngoingGame(Event& in_curr_event){
@@ -2020,91 +2150,61 @@ void StatTracker::postOngoingGame(Event& in_curr_event){
 
     std::cout << "postOngoingGame()\n";
 
-    std::stringstream json_stream;
+    Common::JsonWriter writer(2048);
+    writer.BeginObject();
+    writer.QuotedNumber("GameID", m_game_info.game_id);
+    writer.String("Date - Start", m_game_info.start_unix_date_time);
 
-    json_stream << "{\n";
-    std::string start_date_time = m_game_info.start_unix_date_time;
-    json_stream << "  \"GameID\": \"" << m_game_info.game_id << "\",\n";
-    json_stream << "  \"Date - Start\": \"" << start_date_time << "\",\n";
-    
-    std::string tag_set_id_str = "\"\"";
     if (m_game_info.tag_set_id.has_value()){
-        tag_set_id_str = std::to_string(m_game_info.tag_set_id.value());
+        writer.Number("TagSetID", m_game_info.tag_set_id.value());
+    }
+    else {
+        writer.String("TagSetID", "");
     }
-    json_stream << "  \"TagSetID\": " << tag_set_id_str << ",\n";
-    json_stream << "  \"StadiumID\": " << decode("Stadium", m_game_info.stadium, false) << ",\n";
-    json_stream << "  \"Away Player\": \""           << m_game_info.getAwayTeamPlayer().GetUserID() << "\",\n";
-    json_stream << "  \"Home Player\": \""           << m_game_info.getHomeTeamPlayer().GetUserID() << "\",\n";
+    writeDecoded(writer, "StadiumID", DecodeType::Stadium, m_game_info.stadium, false);
+    writer.String("Away Player", m_game_info.getAwayTeamPlayer().GetUserID());
+    writer.String("Home Player", m_game_info.getHomeTeamPlayer().GetUserID());
 
     u8 away_captain_roster_loc = (m_game_info.away_port == m_game_info.team0_port) ? m_game_info.team0_captain_roster_loc : m_game_info.team1_captain_roster_loc;
     u8 home_captain_roster_loc = (m_game_info.home_port == m_game_info.team0_port) ? m_game_info.team0_captain_roster_loc : m_game_info.team1_captain_roster_loc;
 
-    json_stream << "  \"Away Captain\": "            << std::to_string(away_captain_roster_loc) << ",\n";
-    json_stream << "  \"Home Captain\": "            << std::to_string(home_captain_roster_loc) << ",\n";
-
-    json_stream << "  \"Away Roster 0 CharID\": "            << std::to_string(m_game_info.character_summaries[0][0].char_id) << ",\n";
-    json_stream << "  \"Away Roster 1 CharID\": "            << std::to_string(m_game_info.character_summaries[0][1].char_id) << ",\n";
-    json_stream << "  \"Away Roster 2 CharID\": "            << std::to_string(m_game_info.character_summaries[0][2].char_id) << ",\n";
-    json_stream << "  \"Away Roster 3 CharID\": "            << std::to_string(m_game_info.character_summaries[0][3].char_id) << ",\n";
-    json_stream << "  \"Away Roster 4 CharID\": "            << std::to_string(m_game_info.character_summaries[0][4].char_id) << ",\n";
-    json_stream << "  \"Away Roster 5 CharID\": "            << std::to_string(m_game_info.character_summaries[0][5].char_id) << ",\n";
-    json_stream << "  \"Away Roster 6 CharID\": "            << std::to_string(m_game_info.character_summaries[0][6].char_id) << ",\n";
-    json_stream << "  \"Away Roster 7 CharID\": "            << std::to_string(m_game_info.character_summaries[0][7].char_id) << ",\n";
-    json_stream << "  \"Away Roster 8 CharID\": "            << std::to_string(m_game_info.character_summaries[0][8].char_id) << ",\n";
-    json_stream << "  \"Home Roster 0 CharID\": "            << std::to_string(m_game_info.character_summaries[1][0].char_id) << ",\n";
-    json_stream << "  \"Home Roster 1 CharID\": "            << std::to_string(m_game_info.character_summaries[1][1].char_id) << ",\n";
-    json_stream << "  \"Home Roster 2 CharID\": "            << std::to_string(m_game_info.character_summaries[1][2].char_id) << ",\n";
-    json_stream << "  \"Home Roster 3 CharID\": "            << std::to_string(m_game_info.character_summaries[1][3].char_id) << ",\n";
-    json_stream << "  \"Home Roster 4 CharID\": "            << std::to_string(m_game_info.character_summaries[1][4].char_id) << ",\n";
-    json_stream << "  \"Home Roster 5 CharID\": "            << std::to_string(m_game_info.character_summaries[1][5].char_id) << ",\n";
-    json_stream << "  \"Home Roster 6 CharID\": "            << std::to_string(m_game_info.character_summaries[1][6].char_id) << ",\n";
-    json_stream << "  \"Home Roster 7 CharID\": "            << std::to_string(m_game_info.character_summaries[1][7].char_id) << ",\n";
-    json_stream << "  \"Home Roster 8 CharID\": "            << std::to_string(m_game_info.character_summaries[1][8].char_id) << ",\n";
-
-    json_stream << "  \"Away Stars\": "              << std::to_string(in_curr_event.away_stars) << ",\n";
-    json_stream << "  \"Home Stars\": "              << std::to_string(in_curr_event.home_stars) << ",\n";
-    json_stream << "  \"Pitcher\": "                 << std::to_string(in_curr_event.pitcher_roster_loc) << "\n";
-    json_stream << "}\n";
-
-    const Common::HttpRequest::Response response =
-        m_http.Post("https://api.projectrio.app/populate_db/ongoing_game/", json_stream.str(),
-            {
-                {"Content-Type", "application/json"},
-            }
-        );
+    writer.Number("Away Captain", away_captain_roster_loc);
+    writer.Number("Home Captain", home_captain_roster_loc);
+
+    for (int team=0; team < cNumOfTeams; ++team){
+        for (int roster=0; roster < cRosterSize; ++roster){
+            writer.Number(cRosterCharIdKeys[team][roster], m_game_info.character_summaries[team][roster].char_id);
+        }
+    }
+
+    writer.Number("Away Stars", in_curr_event.away_stars);
+    writer.Number("Home Stars", in_curr_event.home_stars);
+    writer.Number("Pitcher", in_curr_event.pitcher_roster_loc);
+    writer.EndObject();
+
+    m_submitter->PostOngoingGame(m_game_info.game_id, writer.GetString());
 }
 void StatTracker::updateOngoingGame(Event& in_curr_event){
     if (!shouldSubmitGame()){ return; }
-    
-    std::stringstream json_stream;
-
-    json_stream << "{\n";
-    json_stream << "  \"GameID\": \"" << m_game_info.game_id << "\",\n";
-    json_stream << "  \"Inning\": "                  << std::to_string(in_curr_event.inning) << ",\n";
-    json_stream << "  \"Half Inning\": "             << std::to_string(in_curr_event.half_inning) << ",\n";
-    json_stream << "  \"Away Score\": "              << std::dec << in_curr_event.away_score << ",\n";
-    json_stream << "  \"Home Score\": "              << std::dec << in_curr_event.home_score << ",\n";
-    json_stream << "  \"Outs\": "                    << std::to_string(in_curr_event.outs) << ",\n";
-    json_stream << "  \"Away Stars\": "              << std::to_string(in_curr_event.away_stars) << ",\n";
-    json_stream << "  \"Home Stars\": "              << std::to_string(in_curr_event.home_stars) << ",\n";
-    //json_stream << "  \"Chemistry Links on Base\": " << std::to_string(in_curr_event.chem_links_ob) << ",\n";
-    json_stream << "  \"Pitcher\": "      << std::to_string(in_curr_event.pitcher_roster_loc) << ",\n";
-    json_stream << "  \"Batter\": "       << std::to_string(in_curr_event.batter_roster_loc) << ",\n";
-
-    bool runner_1, runner_2, runner_3;
-    runner_1 = (in_curr_event.runner_1.has_value());
-    runner_2 = (in_curr_event.runner_2.has_value());
-    runner_3 = (in_curr_event.runner_3.has_value());
-
-    json_stream << "  \"Runner 1B\": "       << std::to_string(runner_1) << ",\n";
-    json_stream << "  \"Runner 2B\": "       << std::to_string(runner_2) << ",\n";
-    json_stream << "  \"Runner 3B\": "       << std::to_string(runner_3) << "\n";
-    json_stream << "}\n";
-
-    const Common::HttpRequest::Response response =
-        m_http.Post("https://api.projectrio.app/populate_db/ongoing_game/", json_stream.str(),
-            {
-                {"Content-Type", "application/json"},
-            }
-        );
+
+    Common::JsonWriter writer(512);
+    writer.BeginObject();
+    writer.QuotedNumber("GameID", m_game_info.game_id);
+    writer.Number("Inning", in_curr_event.inning);
+    writer.Number("Half Inning", in_curr_event.half_inning);
+    writer.Number("Away Score", in_curr_event.away_score);
+    writer.Number("Home Score", in_curr_event.home_score);
+    writer.Number("Outs", in_curr_event.outs);
+    writer.Number("Away Stars", in_curr_event.away_stars);
+    writer.Number("Home Stars", in_curr_event.home_stars);
+    //writer.Number("Chemistry Links on Base", in_curr_event.chem_links_ob);
+    writer.Number("Pitcher", in_curr_event.pitcher_roster_loc);
+    writer.Number("Batter", in_curr_event.batter_roster_loc);
+
+    writer.Number("Runner 1B", static_cast<u8>(in_curr_event.runner_1.has_value()));
+    writer.Number("Runner 2B", static_cast<u8>(in_curr_event.runner_2.has_value()));
+    writer.Number("Runner 3B", static_cast<u8>(in_curr_event.runner_3.has_value()));
+    writer.EndObject();
+
+    m_submitter->UpdateOngoingGame(m_game_info.game_id, writer.GetString());
 }
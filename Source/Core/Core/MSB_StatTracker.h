@@ -1,27 +1,39 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <array>
+#include <chrono>
 #include <vector>
 #include <map>
 #include <set>
 #include <tuple>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
 #include "Core/HW/Memmap.h"
 #include <picojson.h>
 
 #include "Common/HttpRequest.h"
+#include "Common/JsonWriter.h"
 
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
 
 #include "Core/LocalPlayers.h"
 #include "Core/Logger.h"
+#include "Core/MSB_StatSubmitter.h"
 #include "Core/TrackerAdr.h"
+#include "Core/TrackerColumnTable.h"
+#include "Core/TrackerHUDStream.h"
 
 namespace Tag {
 class TagSet;
 }
+namespace StatFile {
+class Writer;
+}
 
 enum class GAME_STATE
 {
@@ -291,6 +303,26 @@ static const std::map<u8, std::string> cManualSelectDecode = {
 static const int cRosterSize = 9;
 static const int cNumOfTeams = 2;
 static const int cNumOfPositions = 9;
+static const int cNumOfBases = 4; //Batter plus the three bases
+
+//JSON keys, spelled out so serializing a game does not build them at runtime
+static constexpr std::array<std::array<std::string_view, cRosterSize>, cNumOfTeams> cRosterKeys = {{
+    {"Away Roster 0", "Away Roster 1", "Away Roster 2", "Away Roster 3", "Away Roster 4",
+     "Away Roster 5", "Away Roster 6", "Away Roster 7", "Away Roster 8"},
+    {"Home Roster 0", "Home Roster 1", "Home Roster 2", "Home Roster 3", "Home Roster 4",
+     "Home Roster 5", "Home Roster 6", "Home Roster 7", "Home Roster 8"},
+}};
+
+static constexpr std::array<std::array<std::string_view, cRosterSize>, cNumOfTeams> cRosterCharIdKeys = {{
+    {"Away Roster 0 CharID", "Away Roster 1 CharID", "Away Roster 2 CharID", "Away Roster 3 CharID", "Away Roster 4 CharID",
+     "Away Roster 5 CharID", "Away Roster 6 CharID", "Away Roster 7 CharID", "Away Roster 8 CharID"},
+    {"Home Roster 0 CharID", "Home Roster 1 CharID", "Home Roster 2 CharID", "Home Roster 3 CharID", "Home Roster 4 CharID",
+     "Home Roster 5 CharID", "Home Roster 6 CharID", "Home Roster 7 CharID", "Home Roster 8 CharID"},
+}};
+
+static constexpr std::array<std::string_view, cNumOfBases> cRunnerKeys = {
+    "Runner Batter", "Runner 1B", "Runner 2B", "Runner 3B"
+};
 
 //Addrs for triggering evts
 static const u32 aGameId           = 0x802EBF8C;
@@ -497,7 +529,19 @@ static const u32 cRunner_Offset = 0x154;
 
 class StatTracker{
 public:
-    //StatTracker() { };
+    enum class Mode {
+        //Records the game and submits it to the Rio API
+        Online,
+        //Records the game without submitting anything, for games replayed from a movie that
+        //were already submitted when they were played, and for rollback games whose stats
+        //include mispredicted frames
+        NoSubmit,
+        //Only holds a game that was read back from a stat file, never submits or records anything
+        Offline,
+    };
+
+    explicit StatTracker(Mode mode = Mode::Online);
+    ~StatTracker();
     Logger state_logger = Logger("state_log");;
 
     struct EndGameRosterDefensiveStats{
@@ -727,6 +771,55 @@ public:
             return stringifiedHistory;
         }
     };
+
+    //Field layouts of the records that make up an event. Shared by the event log and the
+    //binary stat file
+    struct EventSchema{
+        std::span<const TrackerColumnTable<Event>::Field> event;
+        std::span<const TrackerColumnTable<Runner>::Field> runner;
+        std::span<const TrackerColumnTable<Pitch>::Field> pitch;
+        std::span<const TrackerColumnTable<Contact>::Field> contact;
+        std::span<const TrackerColumnTable<Fielder>::Field> fielder;
+    };
+    static const EventSchema& getEventSchema();
+
+    //Finished events of a game, stored column by column.
+    //
+    //Events, runners, pitches, contacts and fielders each get their own TrackerColumnTable, and
+    //the optional parts of an event are linked by row. Only what ends up in the stat file is
+    //kept. The event that is still being logged lives in GameInfo::current_event until it is done
+    class EventLog{
+    public:
+        EventLog();
+
+        void append(const Event& event);
+        //Copies a stored event back into out, reusing whatever out already holds
+        void load(u32 row, Event& out) const;
+
+        u16 getEventNum(u32 row) const;
+        u8 getInning(u32 row) const;
+
+        u32 size() const { return m_events.size(); }
+        bool empty() const { return size() == 0; }
+        void clear();
+        //Bytes held by the log, including spare capacity
+        size_t memoryUsage() const;
+
+    private:
+        static constexpr u32 cNoRow = 0xFFFFFFFF;
+
+        TrackerColumnTable<Event> m_events;
+        TrackerColumnTable<Runner> m_runners;
+        TrackerColumnTable<Pitch> m_pitches;
+        TrackerColumnTable<Contact> m_contacts;
+        TrackerColumnTable<Fielder> m_fielders;
+
+        //Row links, cNoRow if the part is missing
+        std::vector<std::array<u32, cNumOfBases>> m_event_runners;
+        std::vector<u32> m_event_pitch;
+        std::vector<u32> m_pitch_contact;
+        std::vector<std::array<u32, 2>> m_contact_fielders; //First, collect
+    };
     
     struct GameInfo{
         u32 game_id;
@@ -759,6 +852,9 @@ public:
         u8 innings_selected;
         u8 innings_played;
 
+        //Rio build the game was recorded with
+        std::string rio_version;
+
         //Netplay info
         bool netplay;
         std::string netplay_opponent_alias;
@@ -780,8 +876,10 @@ public:
         //Array of both teams' character summaries
         std::array<std::array<CharacterSummary, cRosterSize>, cNumOfTeams> character_summaries;
 
-        //All of the events for this game
-        std::map<u16, Event> events;
+        //All of the finished events for this game
+        EventLog events;
+        //The event being logged. Moved into events once the next one starts
+        std::optional<Event> current_event;
         std::optional<Event> previous_state;
         bool write_hud = true;
 
@@ -791,8 +889,8 @@ public:
 
         std::map<int, LocalPlayers::LocalPlayers::Player> NetplayerUserInfo;  // int is port
 
-        Event& getCurrentEvent() { return events.at(event_num); }
-        bool currentEventVld() { return (events.count(event_num) >= 1); }
+        Event& getCurrentEvent() { return current_event.value(); }
+        bool currentEventVld() { return current_event.has_value(); }
 
         LocalPlayers::LocalPlayers::Player getAwayTeamPlayer() { 
             if (team0_port == away_port) {
@@ -845,13 +943,13 @@ public:
         u8 prev_batter_roster_loc = 0xFF; //Used to check each pitch if the batter has changed.
                                           //Mark current positions when changed
 
-        void initTracker(const Core::CPUThreadGuard& guard, u8 inTeamId){
+        void initTracker(const Core::CPUThreadGuard& guard, const TrackerReadPlan& read_plan, u8 inTeamId){
             team_id = inTeamId;
             initialized = true;
             for (u8 pos=0; pos < cRosterSize; ++pos){
                 u32 aFielderRosterLoc_calc = aFielder_RosterLoc + (pos * cFielder_Offset);
 
-                u8 roster_loc = PowerPC::MMU::HostRead_U8(guard, aFielderRosterLoc_calc);
+                u8 roster_loc = read_plan.read<u8>(guard, aFielderRosterLoc_calc);
 
                 std::cout << "RosterLoc:" << std::to_string(roster_loc) 
                           << " Init Pos=" << cPosition.at(pos) << std::endl;
@@ -868,11 +966,11 @@ public:
         }
         
         //Scans field to see who is playing which position and increments counts for positions
-        void evaluateFielders(const Core::CPUThreadGuard& guard) {
+        void evaluateFielders(const Core::CPUThreadGuard& guard, const TrackerReadPlan& read_plan) {
             for (u8 pos=0; pos < cRosterSize; ++pos){
                 u32 aFielderRosterLoc_calc = aFielder_RosterLoc + (pos * cFielder_Offset);
 
-                u8 roster_loc = PowerPC::MMU::HostRead_U8(guard, aFielderRosterLoc_calc);
+                u8 roster_loc = read_plan.read<u8>(guard, aFielderRosterLoc_calc);
 
                 //If new position, mark changed (unless this is the first pitch of the AB (pos==0xFF))
                 //Then set new position
@@ -1000,7 +1098,13 @@ public:
     // void setTagSet(int tagset);
 
     void Run(const Core::CPUThreadGuard& guard);
+    //Registers every address the tracker reads each frame, so Run can snapshot them in bulk
+    void buildReadPlan();
     void lookForTriggerEvents(const Core::CPUThreadGuard& guard);
+    //Event driven mode. Captures m_trigger_plan and returns true if Run has to look at this frame
+    bool triggersChanged(const Core::CPUThreadGuard& guard);
+    //True for the states that only ever leave on a change of a value in m_trigger_plan
+    bool isWaitingOnTriggers() const;
 
     void logGameInfo(const Core::CPUThreadGuard& guard);
     void logDefensiveStats(const Core::CPUThreadGuard& guard, int team_id, int roster_id);
@@ -1037,15 +1141,83 @@ public:
         return out_float;
     }
 
-    Common::HttpRequest m_http{std::chrono::minutes{3}};
-
-    //The type of value to decode, the value to be decoded, bool for decode if true or original value if false
-    std::string decode(std::string type, u8 value, bool decode);
+    //Snapshot of tracked memory, valid for the duration of Run
+    TrackerReadPlan m_read_plan;
+
+    //Values the state machines wait on between plays, as of the last frame that was looked at
+    TrackerReadPlan m_trigger_plan;
+    std::vector<u8> m_trigger_values;
+    //States the last run ended in, if it was left waiting on m_trigger_plan
+    std::optional<std::pair<GAME_STATE, EVENT_STATE>> m_waiting_states;
+
+    const bool m_offline;
+
+    //Sends games and OngoingGame updates off the CPU thread
+    std::unique_ptr<StatSubmitter> m_submitter;
+
+    //Binary record of the game in progress, see MSB_StatFile.h
+    std::unique_ptr<StatFile::Writer> m_stat_file;
+    void openStatFile();
+    void writeStatFileGameInfo();
+    //Writes the final game info and closes the file. The event still being logged is stored first
+    //if include_current_event is set
+    void closeStatFile(bool include_current_event);
+    //Moves the current event into the event log and the stat file
+    void finishCurrentEvent();
+
+    //Serialization buffers. Kept across games so writing a game reuses their capacity
+    Common::JsonWriter m_json_writer;
+    Common::JsonWriter m_hud_writer;
+    //Events array of the stat file, [0] raw and [1] decoded
+    std::array<Common::JsonWriter, 2> m_events_writer;
+
+    enum class DecodeType {
+        Character,
+        Stadium,
+        Contact,
+        Hand,
+        Stick,
+        StickVec,
+        Pitch,
+        ChargePitch,
+        Swing,
+        Position,
+        Action,
+        Bobble,
+        ManualSelect,
+        Steal,
+        Out,
+        PrimaryContactResult,
+        SecondaryContactResult,
+        PitchResult,
+        AtBatResult,
+        QuitterTeam,
+    };
 
-    //Returns JSON, PathToWriteTo
-    std::string getStatJSON(bool inDecode, bool hide_riokey = true);
-    std::string getEventJSON(u16 in_event_num, Event& in_event, bool inDecode);
-    std::string getHUDJSON(std::string in_event_num, Event& in_curr_event, std::optional<Event> in_prev_event, bool inDecode);
+    //Writes key with the original value as a number, or with its human readable name if decode is true
+    void writeDecoded(Common::JsonWriter& writer, std::string_view key, DecodeType type, u8 value, bool decode);
+
+    //Writes the decoded and raw stat files for the current game. Submits the raw one if submit is true
+    void writeGameFiles(const std::string& decoded_prefix, const std::string& raw_prefix, bool submit);
+    //Writes the decoded and raw stat files of the game to the given paths. Returns false if either failed
+    bool writeJSONFiles(const std::string& decoded_path, const std::string& raw_path);
+    //Writes the stat file into writer. Expects writeEventsJSON to have filled m_events_writer
+    void writeStatJSON(Common::JsonWriter& writer, bool inDecode, bool hide_riokey);
+    void writeEventsJSON(Common::JsonWriter& events, bool inDecode);
+    void writeEventJSON(Common::JsonWriter& writer, u16 in_event_num, Event& in_event, bool inDecode);
+    void writeRosterJSON(Common::JsonWriter& writer, int team, int roster, u8 captain_roster_loc, bool inDecode);
+    void writeRunnersJSON(Common::JsonWriter& writer, Event& in_event, bool inDecode);
+    void writePitchJSON(Common::JsonWriter& writer, Pitch& pitch, bool inDecode, bool hang_time_as_string);
+    //Live HUD for overlays, see TrackerHUDStream.h. Opened on the first update
+    TrackerHUDStream m_hud_stream;
+    //The HUD updates too often to try a stream that failed to open on each of them
+    static constexpr std::chrono::seconds cHUDStreamRetryInterval{10};
+    std::chrono::steady_clock::time_point m_hud_stream_retry{};
+    //Publishes the current event to the HUD stream, and to decoded.hud.json if enabled. after_play
+    //is false for the HUD shown before the pitch ('a') and true once the play is over ('b')
+    void publishHUD(bool after_play);
+    //Returned view is valid until the next call
+    std::string_view getHUDJSON(std::string_view in_event_num, Event& in_curr_event, std::optional<Event>& in_prev_event, bool inDecode);
     //Returns path to save json
     std::string getStatJsonPath(std::string prefix);
 
@@ -1055,12 +1227,12 @@ public:
     std::pair<u8,u8> getBatterFielderPorts(const Core::CPUThreadGuard& guard){
         // These values are the actual port numbers
         // and are indexed into using the below u8s
-        std::array<u8, 2> ports = {PowerPC::MMU::HostRead_U8(guard, 0x800e874c), PowerPC::MMU::HostRead_U8(guard, 0x800e874d)};
+        std::array<u8, 2> ports = {m_read_plan.read<u8>(guard, 0x800e874c), m_read_plan.read<u8>(guard, 0x800e874d)};
 
         // These registers will always be 0 or 1
         // and swap values each half inning
-        u32 BattingTeam = PowerPC::MMU::HostRead_U32(guard, 0x80892990);
-        u32 PitchingTeam = PowerPC::MMU::HostRead_U32(guard, 0x80892994);
+        u32 BattingTeam = m_read_plan.read<u32>(guard, 0x80892990);
+        u32 PitchingTeam = m_read_plan.read<u32>(guard, 0x80892994);
         
         u8 BattingPort = ports[BattingTeam];
         u8 FieldingPort = ports[PitchingTeam];
@@ -1091,22 +1263,11 @@ public:
             logGameInfo(guard);
 
             //Remove current event, wasn't finished
-            auto it = m_game_info.events.find(m_game_info.event_num);
-            if ((&it != NULL) && (it != m_game_info.events.end()))
-            {
-              m_game_info.events.erase(it);
-            }
-
-            //Game has ended. Write file but do not submit
-            std::string jsonPath = getStatJsonPath("crash.decode.");
-            std::string json = getStatJSON(true);
-            
-            File::WriteStringToFile(jsonPath, json);
+            m_game_info.current_event.reset();
 
-            jsonPath = getStatJsonPath("crash.");
-            json = getStatJSON(false, true);
-            
-            File::WriteStringToFile(jsonPath, json);
+            //Every finished event is already on disk. Only the game info is left to write,
+            //dolphin-tool stats turns the file into the usual JSON
+            closeStatFile(false);
             init();
         }
     }
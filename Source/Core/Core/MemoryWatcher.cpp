@@ -3,28 +3,91 @@
 
 #include "Core/MemoryWatcher.h"
 
+#include <algorithm>
+#include <charconv>
 #include <cstring>
 #include <fstream>
-#include <iostream>
-#include <sstream>
+#include <iterator>
 #include <unistd.h>
 
+#include <fmt/format.h>
+
 #include "Common/FileUtil.h"
-#include "Core/HW/SystemTimers.h"
+#include "Common/StringUtil.h"
+#include "Common/Swap.h"
+#include "Core/Core.h"
+#include "Core/HW/Memmap.h"
 #include "Core/PowerPC/MMU.h"
+#include "Core/System.h"
+
+namespace
+{
+constexpr size_t BINARY_HEADER_SIZE = 3 * sizeof(u32);
+constexpr size_t BINARY_CHANGE_SIZE = 2 * sizeof(u32);
+
+// Dolphin only runs on little-endian hosts, so values are copied as they are
+void AppendU32(std::vector<char>& packet, u32 value)
+{
+  const char* bytes = reinterpret_cast<const char*>(&value);
+  packet.insert(packet.end(), bytes, bytes + sizeof(value));
+}
+
+bool IsSeparator(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Appends the offsets of line, returns false if there are none
+bool ParseOffsets(std::string_view line, std::vector<u32>& offsets)
+{
+  const size_t first = offsets.size();
+  const char* it = line.data();
+  const char* const end = line.data() + line.size();
+  while (true)
+  {
+    it = std::find_if(it, end, [](char c) { return !IsSeparator(c); });
+    if (it == end)
+      break;
+
+    u32 offset;
+    const auto [next, error] = std::from_chars(it, end, offset, 16);
+    // Like the stream parser this replaces, stop at the first thing that is not a hex number
+    if (error != std::errc() || (next != end && !IsSeparator(*next)))
+      break;
+    offsets.push_back(offset);
+    it = next;
+  }
+  return offsets.size() != first;
+}
+}  // namespace
 
 MemoryWatcher::MemoryWatcher()
+    : MemoryWatcher(File::GetUserPath(F_MEMORYWATCHERLOCATIONS_IDX),
+                    File::GetUserPath(F_MEMORYWATCHERSOCKET_IDX),
+                    File::GetUserPath(F_MEMORYWATCHERCONTROL_IDX))
+{
+}
+
+MemoryWatcher::MemoryWatcher(const std::string& locations_path, const std::string& socket_path,
+                             const std::string& control_path)
 {
   m_running = false;
-  if (!LoadAddresses(File::GetUserPath(F_MEMORYWATCHERLOCATIONS_IDX)))
+  if (!LoadAddresses(locations_path))
     return;
-  if (!OpenSocket(File::GetUserPath(F_MEMORYWATCHERSOCKET_IDX)))
+  if (!OpenSocket(socket_path))
     return;
+  OpenControlSocket(control_path);
   m_running = true;
 }
 
 MemoryWatcher::~MemoryWatcher()
 {
+  if (m_control_fd >= 0)
+  {
+    close(m_control_fd);
+    unlink(m_control_path.c_str());
+  }
+
   if (!m_running)
     return;
 
@@ -39,23 +102,64 @@ bool MemoryWatcher::LoadAddresses(const std::string& path)
   if (!locations)
     return false;
 
+  // An empty file is fine, addresses can also be added through the control socket
   std::string line;
   while (std::getline(locations, line))
-    ParseLine(line);
+    AddWatch(line);
+
+  return true;
+}
+
+bool MemoryWatcher::AddWatch(std::string_view line)
+{
+  const auto [it, inserted] = m_ids.try_emplace(std::string(line), m_next_id);
+  if (!inserted)
+    return false;
+
+  const size_t first_offset = m_offsets.size();
+  if (!ParseOffsets(line, m_offsets))
+  {
+    m_ids.erase(it);
+    return false;
+  }
 
-  return !m_values.empty();
+  m_watches.push_back({m_next_id++, static_cast<u32>(first_offset),
+                       static_cast<u32>(m_offsets.size() - first_offset), 0});
+  m_lines.emplace_back(line);
+  return true;
 }
 
-void MemoryWatcher::ParseLine(const std::string& line)
+bool MemoryWatcher::RemoveWatch(std::string_view line)
 {
-  m_values[line] = 0;
-  m_addresses[line] = std::vector<u32>();
+  const auto it = m_ids.find(std::string(line));
+  if (it == m_ids.end())
+    return false;
 
-  std::istringstream offsets(line);
-  offsets >> std::hex;
-  u32 offset;
-  while (offsets >> offset)
-    m_addresses[line].push_back(offset);
+  const u32 id = it->second;
+  m_ids.erase(it);
+  const auto watch = std::find_if(m_watches.begin(), m_watches.end(),
+                                  [id](const Watch& w) { return w.id == id; });
+  const size_t index = watch - m_watches.begin();
+  std::swap(m_watches[index], m_watches.back());
+  std::swap(m_lines[index], m_lines.back());
+  m_watches.pop_back();
+  m_lines.pop_back();
+
+  RebuildOffsets();
+  return true;
+}
+
+void MemoryWatcher::RebuildOffsets()
+{
+  std::vector<u32> offsets;
+  offsets.reserve(m_offsets.size());
+  for (Watch& watch : m_watches)
+  {
+    const auto first = m_offsets.begin() + watch.first_offset;
+    watch.first_offset = static_cast<u32>(offsets.size());
+    offsets.insert(offsets.end(), first, first + watch.offset_count);
+  }
+  m_offsets = std::move(offsets);
 }
 
 bool MemoryWatcher::OpenSocket(const std::string& path)
@@ -67,38 +171,208 @@ bool MemoryWatcher::OpenSocket(const std::string& path)
   return m_fd >= 0;
 }
 
-u32 MemoryWatcher::ChasePointer(const Core::CPUThreadGuard& guard, const std::string& line)
+void MemoryWatcher::OpenControlSocket(const std::string& path)
 {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(addr.sun_path))
+    return;
+  std::memcpy(addr.sun_path, path.c_str(), path.size());
+
+  m_control_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (m_control_fd < 0)
+    return;
+
+  // Left behind by a previous session that did not shut down cleanly
+  unlink(path.c_str());
+  if (bind(m_control_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+  {
+    close(m_control_fd);
+    m_control_fd = -1;
+    return;
+  }
+  m_control_path = path;
+}
+
+void MemoryWatcher::HandleCommand(std::string_view command)
+{
+  command = StripWhitespace(command);
+  const size_t space = command.find(' ');
+  const std::string_view name = command.substr(0, space);
+  const std::string_view argument =
+      space == std::string_view::npos ? std::string_view() : StripWhitespace(command.substr(space));
+
+  if (name == "add")
+  {
+    AddWatch(argument);
+  }
+  else if (name == "remove")
+  {
+    RemoveWatch(argument);
+  }
+  else if (name == "rate")
+  {
+    u32 interval;
+    const auto [end, error] =
+        std::from_chars(argument.data(), argument.data() + argument.size(), interval);
+    if (error == std::errc() && interval != 0)
+      m_sample_interval = interval;
+  }
+  else if (name == "format")
+  {
+    if (argument == "text")
+      m_format = Format::Text;
+    else if (argument == "binary")
+      m_format = Format::Binary;
+  }
+}
+
+void MemoryWatcher::ReceiveCommands()
+{
+  if (m_control_fd < 0)
+    return;
+
+  char buffer[4096];
+  while (true)
+  {
+    const ssize_t size = recv(m_control_fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (size <= 0)
+      break;
+
+    std::string_view commands(buffer, size);
+    while (!commands.empty())
+    {
+      const size_t end = commands.find_first_of("\n\0", 0, 2);
+      HandleCommand(commands.substr(0, end));
+      commands.remove_prefix(end == std::string_view::npos ? commands.size() : end + 1);
+    }
+  }
+}
+
+void MemoryWatcher::UpdateRAMView(const Core::CPUThreadGuard& guard)
+{
+  m_ram = nullptr;
+  m_ram_size = 0;
+
+  // Every GameCube title and almost every Wii title maps MEM1 at 0x80000000 with a BAT, in which
+  // case the effective address is the physical one with the segment bits masked off. Check that
+  // this still holds at both ends of MEM1 before bypassing the MMU for this sample.
+  auto& memory = guard.GetSystem().GetMemory();
+  const u32 size = memory.GetRamSizeReal();
+  if (!memory.GetRAM() || size < sizeof(u32) ||
+      !PowerPC::MMU::HostIsRAMAddress(guard, Memory::MEM1_BASE_ADDR) ||
+      !PowerPC::MMU::HostIsRAMAddress(guard, Memory::MEM1_BASE_ADDR + size - 1))
+  {
+    return;
+  }
+  m_ram = memory.GetRAM();
+  m_ram_size = size;
+}
+
+u32 MemoryWatcher::Read(const Core::CPUThreadGuard& guard, u32 address) const
+{
+  const u32 physical = address - Memory::MEM1_BASE_ADDR;
+  if (physical < m_ram_size && m_ram_size - physical >= sizeof(u32))
+  {
+    u32 value;
+    std::memcpy(&value, m_ram + physical, sizeof(value));
+    return Common::swap32(value);
+  }
+  return PowerPC::MMU::HostRead_U32(guard, address);
+}
+
+bool MemoryWatcher::IsRAMAddress(const Core::CPUThreadGuard& guard, u32 address) const
+{
+  if (address - Memory::MEM1_BASE_ADDR < m_ram_size)
+    return true;
+  return PowerPC::MMU::HostIsRAMAddress(guard, address);
+}
+
+u32 MemoryWatcher::ChasePointer(const Core::CPUThreadGuard& guard, const Watch& watch) const
+{
+  const u32* const offsets = m_offsets.data() + watch.first_offset;
   u32 value = 0;
-  for (u32 offset : m_addresses[line])
+  for (u32 i = 0; i < watch.offset_count; ++i)
   {
-    value = PowerPC::MMU::HostRead_U32(guard, value + offset);
-    if (!PowerPC::MMU::HostIsRAMAddress(guard, value))
+    value = Read(guard, value + offsets[i]);
+    if (!IsRAMAddress(guard, value))
       break;
   }
   return value;
 }
 
-std::string MemoryWatcher::ComposeMessages(const Core::CPUThreadGuard& guard)
+void MemoryWatcher::BeginPacket()
 {
-  std::ostringstream message_stream;
-  message_stream << std::hex;
+  m_packet.clear();
+  m_packet_changes = 0;
+  if (m_format == Format::Binary)
+  {
+    AppendU32(m_packet, BINARY_MAGIC);
+    AppendU32(m_packet, m_frame);
+    AppendU32(m_packet, 0);
+  }
+}
+
+void MemoryWatcher::AppendChange(const Watch& watch, size_t index)
+{
+  if (m_format == Format::Binary)
+  {
+    if (m_packet.size() + BINARY_CHANGE_SIZE > MAX_PACKET_SIZE)
+    {
+      SendPacket();
+      BeginPacket();
+    }
+    AppendU32(m_packet, watch.id);
+    AppendU32(m_packet, watch.value);
+  }
+  else
+  {
+    // Room for the longest value and the terminating null
+    if (m_packet_changes != 0 && m_packet.size() + m_lines[index].size() + 12 > MAX_PACKET_SIZE)
+    {
+      SendPacket();
+      BeginPacket();
+    }
+    fmt::format_to(std::back_inserter(m_packet), "{}\n{:x}\n", m_lines[index], watch.value);
+  }
+  ++m_packet_changes;
+}
 
-  for (auto& entry : m_values)
+void MemoryWatcher::SendPacket()
+{
+  if (m_format == Format::Binary)
+  {
+    std::memcpy(m_packet.data() + BINARY_HEADER_SIZE - sizeof(u32), &m_packet_changes,
+                sizeof(m_packet_changes));
+  }
+  else
   {
-    std::string address = entry.first;
-    u32& current_value = entry.second;
+    m_packet.push_back('\0');
+  }
+
+  sendto(m_fd, m_packet.data(), m_packet.size(), 0, reinterpret_cast<sockaddr*>(&m_addr),
+         sizeof(m_addr));
+}
 
-    u32 new_value = ChasePointer(guard, address);
-    if (new_value != current_value)
+void MemoryWatcher::ComposeMessages(const Core::CPUThreadGuard& guard)
+{
+  UpdateRAMView(guard);
+  BeginPacket();
+
+  for (size_t i = 0; i < m_watches.size(); ++i)
+  {
+    Watch& watch = m_watches[i];
+    const u32 new_value = ChasePointer(guard, watch);
+    if (new_value != watch.value)
     {
-      // Update the value
-      current_value = new_value;
-      message_stream << address << '\n' << new_value << '\n';
+      watch.value = new_value;
+      AppendChange(watch, i);
     }
   }
 
-  return message_stream.str();
+  // The text format has always sent a datagram per sample, even an empty one
+  if (m_format == Format::Text || m_packet_changes != 0)
+    SendPacket();
 }
 
 void MemoryWatcher::Step(const Core::CPUThreadGuard& guard)
@@ -106,7 +380,11 @@ void MemoryWatcher::Step(const Core::CPUThreadGuard& guard)
   if (!m_running)
     return;
 
-  std::string message = ComposeMessages(guard);
-  sendto(m_fd, message.c_str(), message.size() + 1, 0, reinterpret_cast<sockaddr*>(&m_addr),
-         sizeof(m_addr));
+  ReceiveCommands();
+
+  ++m_frame;
+  if (m_frame % m_sample_interval != 0)
+    return;
+
+  ComposeMessages(guard);
 }
@@ -5,10 +5,11 @@
 
 #include "Common/CommonTypes.h"
 
-#include <map>
 #include <string>
+#include <string_view>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <unordered_map>
 #include <vector>
 
 namespace Core
@@ -22,30 +23,100 @@ class CPUThreadGuard;
 // The input file is a newline-separated list of hex memory addresses, without
 // the "0x". To follow pointers, separate addresses with a space. For example,
 // "ABCD EF" will watch the address at (*0xABCD) + 0xEF.
-// The output to the socket is two lines. The first is the address from the
-// input file, and the second is the new value in hex.
+//
+// Every sample sends all values that changed since the previous sample in one datagram. Only
+// samples with more than MAX_PACKET_SIZE bytes of changes are split across several datagrams.
+// In the text format (the default) every value is two lines: the address as written in the input
+// file, and the new value in hex. The binary format is a little-endian header of u32 magic
+// ("MWB1"), u32 frame and u32 count, followed by count pairs of u32 watch id and u32 value. Watch
+// ids count up from 0 in the order of the input file and carry on with the watches added at
+// runtime. Binary samples without changes are not sent.
+//
+// Commands are read from datagrams sent to the control socket, one command per line:
+//   add <address>          Watch an address, written as in the input file
+//   remove <address>       Stop watching an address
+//   rate <n>               Sample every n-th frame
+//   format <text|binary>   Output format of the following samples
 class MemoryWatcher final
 {
 public:
+  static constexpr u32 BINARY_MAGIC = 0x3142574D;  // "MWB1"
+  static constexpr size_t MAX_PACKET_SIZE = 64 * 1024;
+
   MemoryWatcher();
+  MemoryWatcher(const std::string& locations_path, const std::string& socket_path,
+                const std::string& control_path);
   ~MemoryWatcher();
+
+  MemoryWatcher(const MemoryWatcher&) = delete;
+  MemoryWatcher& operator=(const MemoryWatcher&) = delete;
+
   void Step(const Core::CPUThreadGuard& guard);
 
+  bool IsRunning() const { return m_running; }
+  size_t GetWatchCount() const { return m_watches.size(); }
+
 private:
+  enum class Format
+  {
+    Text,
+    Binary,
+  };
+
+  // A watched line, compiled to a slice of m_offsets
+  struct Watch
+  {
+    u32 id;
+    u32 first_offset;
+    u32 offset_count;
+    u32 value;
+  };
+
   bool LoadAddresses(const std::string& path);
   bool OpenSocket(const std::string& path);
+  void OpenControlSocket(const std::string& path);
+
+  bool AddWatch(std::string_view line);
+  bool RemoveWatch(std::string_view line);
+  void RebuildOffsets();
+  void HandleCommand(std::string_view command);
+  void ReceiveCommands();
+
+  // Checks whether MEM1 can be read directly for this sample
+  void UpdateRAMView(const Core::CPUThreadGuard& guard);
+  u32 Read(const Core::CPUThreadGuard& guard, u32 address) const;
+  bool IsRAMAddress(const Core::CPUThreadGuard& guard, u32 address) const;
+  u32 ChasePointer(const Core::CPUThreadGuard& guard, const Watch& watch) const;
 
-  void ParseLine(const std::string& line);
-  u32 ChasePointer(const Core::CPUThreadGuard& guard, const std::string& line);
-  std::string ComposeMessages(const Core::CPUThreadGuard& guard);
+  void ComposeMessages(const Core::CPUThreadGuard& guard);
+  void BeginPacket();
+  void AppendChange(const Watch& watch, size_t index);
+  void SendPacket();
 
   bool m_running = false;
 
-  int m_fd;
+  int m_fd = -1;
   sockaddr_un m_addr{};
+  int m_control_fd = -1;
+  std::string m_control_path;
+
+  Format m_format = Format::Text;
+  u32 m_sample_interval = 1;
+  u32 m_frame = 0;
+
+  // Watched lines in no particular order, and the pointer chains they follow
+  std::vector<Watch> m_watches;
+  std::vector<u32> m_offsets;
+  // Address as stored in the file, for each entry of m_watches
+  std::vector<std::string> m_lines;
+  // Address as stored in the file -> watch id
+  std::unordered_map<std::string, u32> m_ids;
+  u32 m_next_id = 0;
+
+  const u8* m_ram = nullptr;
+  u32 m_ram_size = 0;
 
-  // Address as stored in the file -> list of offsets to follow
-  std::map<std::string, std::vector<u32>> m_addresses;
-  // Address as stored in the file -> current value
-  std::map<std::string, u32> m_values;
+  // Datagram being composed, reused across samples
+  std::vector<char> m_packet;
+  u32 m_packet_changes = 0;
 };
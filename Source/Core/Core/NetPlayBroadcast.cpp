@@ -0,0 +1,773 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/NetPlayBroadcast.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "Common/Logging/Log.h"
+#include "Common/SFMLHelper.h"
+#include "Common/StringUtil.h"
+#include "Common/Version.h"
+#include "Core/NetPlayCommon.h"
+
+namespace NetPlay
+{
+namespace
+{
+// Sent as the connect data of the relay connection of a host, spectators connect with zero
+constexpr u32 BROADCAST_SOURCE_MAGIC = 0x52494F42;
+
+// The fields of a pad in the order of the bits of a change mask. The ones that change most often
+// come first, so that their mask fits in the first byte of the header.
+enum ChangedField : u32
+{
+  FIELD_BUTTON = 1 << 0,
+  FIELD_STICK_X = 1 << 1,
+  FIELD_STICK_Y = 1 << 2,
+  FIELD_SUBSTICK_X = 1 << 3,
+  FIELD_SUBSTICK_Y = 1 << 4,
+  FIELD_TRIGGER_LEFT = 1 << 5,
+  FIELD_TRIGGER_RIGHT = 1 << 6,
+  FIELD_ANALOG_A = 1 << 7,
+  FIELD_ANALOG_B = 1 << 8,
+  // Toggles, without a value
+  FIELD_CONNECTED = 1 << 9,
+  FIELD_ALL = (1 << 10) - 1,
+};
+
+GCPadStatus NeutralPad()
+{
+  GCPadStatus pad;
+  pad.stickX = GCPadStatus::MAIN_STICK_CENTER_X;
+  pad.stickY = GCPadStatus::MAIN_STICK_CENTER_Y;
+  pad.substickX = GCPadStatus::C_STICK_CENTER_X;
+  pad.substickY = GCPadStatus::C_STICK_CENTER_Y;
+  return pad;
+}
+
+// The u8 fields after the buttons, in the order of their bits
+constexpr std::array<u8 GCPadStatus::*, 8> BYTE_FIELDS{
+    &GCPadStatus::stickX,      &GCPadStatus::stickY,      &GCPadStatus::substickX,
+    &GCPadStatus::substickY,   &GCPadStatus::triggerLeft, &GCPadStatus::triggerRight,
+    &GCPadStatus::analogA,     &GCPadStatus::analogB,
+};
+
+u32 GetChangedFields(const GCPadStatus& previous, const GCPadStatus& status)
+{
+  u32 mask = 0;
+  if (previous.button != status.button)
+    mask |= FIELD_BUTTON;
+  for (size_t i = 0; i < BYTE_FIELDS.size(); ++i)
+  {
+    if (previous.*BYTE_FIELDS[i] != status.*BYTE_FIELDS[i])
+      mask |= FIELD_STICK_X << i;
+  }
+  if (previous.isConnected != status.isConnected)
+    mask |= FIELD_CONNECTED;
+  return mask;
+}
+
+void WriteVarInt(std::vector<u8>& out, u64 value)
+{
+  while (value >= 0x80)
+  {
+    out.push_back(static_cast<u8>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<u8>(value));
+}
+
+class BatchReader
+{
+public:
+  explicit BatchReader(std::span<const u8> data) : m_data(data) {}
+
+  bool Failed() const { return m_failed; }
+  bool AtEnd() const { return m_position == m_data.size(); }
+
+  u8 ReadU8()
+  {
+    if (m_position >= m_data.size())
+    {
+      m_failed = true;
+      return 0;
+    }
+    return m_data[m_position++];
+  }
+
+  u64 ReadVarInt()
+  {
+    u64 value = 0;
+    for (u32 shift = 0; shift < 64; shift += 7)
+    {
+      const u8 byte = ReadU8();
+      value |= u64(byte & 0x7F) << shift;
+      if (!(byte & 0x80))
+        return value;
+    }
+    m_failed = true;
+    return 0;
+  }
+
+private:
+  std::span<const u8> m_data;
+  size_t m_position = 0;
+  bool m_failed = false;
+};
+
+MessageID GetMessageID(std::span<const u8> data)
+{
+  return static_cast<MessageID>(data[0]);
+}
+
+std::span<const u8> GetPacketData(const sf::Packet& packet)
+{
+  return {static_cast<const u8*>(packet.getData()), packet.getDataSize()};
+}
+}  // namespace
+
+void BroadcastEncoder::Reset()
+{
+  m_pads = {};
+}
+
+void BroadcastEncoder::AddInput(PadIndex pad, const GCPadStatus& status)
+{
+  m_pads.at(pad).pending.push_back(status);
+}
+
+bool BroadcastEncoder::HasInputs() const
+{
+  return std::any_of(m_pads.begin(), m_pads.end(),
+                     [](const PadStream& stream) { return !stream.pending.empty(); });
+}
+
+std::vector<u8> BroadcastEncoder::TakeBatch()
+{
+  std::vector<PadInputRun> runs;
+  for (size_t pad = 0; pad < m_pads.size(); ++pad)
+  {
+    const PadStream& stream = m_pads[pad];
+    if (!stream.pending.empty())
+      runs.push_back({static_cast<PadIndex>(pad), stream.next_index, stream.pending});
+  }
+  std::vector<u8> out = EncodeInputBatch(runs);
+
+  for (PadStream& stream : m_pads)
+  {
+    stream.next_index += stream.pending.size();
+    stream.pending.clear();
+  }
+  return out;
+}
+
+std::vector<u8> EncodeInputBatch(std::span<const PadInputRun> runs)
+{
+  std::vector<u8> out;
+  out.push_back(static_cast<u8>(runs.size()));
+
+  for (const PadInputRun& run : runs)
+  {
+    out.push_back(static_cast<u8>(run.pad));
+    WriteVarInt(out, run.first_index);
+    WriteVarInt(out, run.inputs.size());
+
+    // An odd header is a run of inputs that repeat the one before them, an even one the mask of
+    // the fields that changed, followed by their values
+    GCPadStatus previous = NeutralPad();
+    u64 repeats = 0;
+    for (const GCPadStatus& status : run.inputs)
+    {
+      const u32 mask = GetChangedFields(previous, status);
+      if (mask == 0)
+      {
+        ++repeats;
+        continue;
+      }
+
+      if (repeats != 0)
+      {
+        WriteVarInt(out, repeats << 1 | 1);
+        repeats = 0;
+      }
+      WriteVarInt(out, u64{mask} << 1);
+      if (mask & FIELD_BUTTON)
+      {
+        out.push_back(static_cast<u8>(status.button));
+        out.push_back(static_cast<u8>(status.button >> 8));
+      }
+      for (size_t i = 0; i < BYTE_FIELDS.size(); ++i)
+      {
+        if (mask & (FIELD_STICK_X << i))
+          out.push_back(status.*BYTE_FIELDS[i]);
+      }
+      previous = status;
+    }
+    if (repeats != 0)
+      WriteVarInt(out, repeats << 1 | 1);
+  }
+  return out;
+}
+
+std::optional<std::vector<BroadcastInput>> DecodeBroadcastBatch(std::span<const u8> data)
+{
+  std::vector<BroadcastInput> inputs;
+  BatchReader reader(data);
+  const u8 sections = reader.ReadU8();
+  for (u8 section = 0; section < sections && !reader.Failed(); ++section)
+  {
+    const u8 pad = reader.ReadU8();
+    const u64 first_index = reader.ReadVarInt();
+    const u64 count = reader.ReadVarInt();
+    // Every input takes at least a bit of the batch
+    if (pad >= BroadcastEncoder::NUM_PADS || count > data.size() * 8 * 64)
+      return std::nullopt;
+
+    GCPadStatus status = NeutralPad();
+    u64 decoded = 0;
+    while (decoded < count && !reader.Failed())
+    {
+      const u64 header = reader.ReadVarInt();
+      u64 repeats = 1;
+      if (header & 1)
+      {
+        repeats = header >> 1;
+      }
+      else
+      {
+        const u64 mask = header >> 1;
+        if (mask == 0 || mask > FIELD_ALL)
+          return std::nullopt;
+        if (mask & FIELD_BUTTON)
+        {
+          status.button = reader.ReadU8();
+          status.button |= reader.ReadU8() << 8;
+        }
+        for (size_t i = 0; i < BYTE_FIELDS.size(); ++i)
+        {
+          if (mask & (FIELD_STICK_X << i))
+            status.*BYTE_FIELDS[i] = reader.ReadU8();
+        }
+        if (mask & FIELD_CONNECTED)
+          status.isConnected = !status.isConnected;
+      }
+
+      if (repeats == 0 || repeats > count - decoded)
+        return std::nullopt;
+      for (u64 i = 0; i < repeats; ++i)
+        inputs.push_back({static_cast<PadIndex>(pad), first_index + decoded + i, status});
+      decoded += repeats;
+    }
+  }
+
+  if (reader.Failed() || !reader.AtEnd())
+    return std::nullopt;
+  return inputs;
+}
+
+BroadcastSource::BroadcastSource(const std::string& relay_address, std::chrono::seconds delay,
+                                 std::string key, std::string spectator_key)
+    : m_delay(delay), m_key(std::move(key)), m_spectator_key(std::move(spectator_key))
+{
+  std::string host = relay_address;
+  u16 port = DEFAULT_RELAY_PORT;
+  const size_t colon = relay_address.rfind(':');
+  if (colon != std::string::npos)
+  {
+    host = relay_address.substr(0, colon);
+    if (!TryParse(relay_address.substr(colon + 1), &port))
+    {
+      ERROR_LOG_FMT(NETPLAY, "Invalid broadcast relay address \"{}\"", relay_address);
+      return;
+    }
+  }
+
+  m_host.reset(enet_host_create(nullptr, 1, CHANNEL_COUNT, 0, 0));
+  if (!m_host)
+    return;
+  m_host->mtu = std::min(m_host->mtu, MAX_ENET_MTU);
+
+  ENetAddress address;
+  enet_address_set_host(&address, host.c_str());
+  address.port = port;
+  m_peer = enet_host_connect(m_host.get(), &address, CHANNEL_COUNT, BROADCAST_SOURCE_MAGIC);
+  if (!m_peer)
+  {
+    m_host.reset();
+    return;
+  }
+  enet_peer_timeout(m_peer, 0, PEER_TIMEOUT.count(), PEER_TIMEOUT.count());
+  m_last_batch = std::chrono::steady_clock::now();
+
+  INFO_LOG_FMT(NETPLAY, "Broadcasting to {}:{} with a delay of {}s", host, port, delay.count());
+}
+
+BroadcastSource::~BroadcastSource()
+{
+  if (m_peer)
+  {
+    enet_peer_disconnect(m_peer, 0);
+    enet_host_flush(m_host.get());
+  }
+}
+
+void BroadcastSource::QueueBatch()
+{
+  const std::vector<u8> batch = m_encoder.TakeBatch();
+  sf::Packet packet;
+  packet << MessageID::BroadcastInputs;
+  packet.append(batch.data(), batch.size());
+  m_queue.push_back({std::chrono::steady_clock::now() + m_delay, std::move(packet)});
+}
+
+void BroadcastSource::SendMessage(const sf::Packet& packet)
+{
+  std::lock_guard lk(m_mutex);
+  if (!m_host)
+    return;
+
+  // Inputs of the game before it are sent first
+  if (m_encoder.HasInputs())
+    QueueBatch();
+  m_queue.push_back({std::chrono::steady_clock::now() + m_delay, packet});
+
+  if (GetMessageID(GetPacketData(packet)) == MessageID::StartGame)
+    m_encoder.Reset();
+}
+
+void BroadcastSource::AddInput(PadIndex pad, const GCPadStatus& status)
+{
+  std::lock_guard lk(m_mutex);
+  m_encoder.AddInput(pad, status);
+}
+
+BroadcastSource::Events BroadcastSource::Update()
+{
+  Events events;
+  std::lock_guard lk(m_mutex);
+  if (!m_host)
+    return events;
+
+  const auto now = std::chrono::steady_clock::now();
+  if (now - m_last_batch >= BATCH_INTERVAL)
+  {
+    if (m_encoder.HasInputs())
+      QueueBatch();
+    m_last_batch = now;
+  }
+
+  while (m_connected && !m_queue.empty() && m_queue.front().due <= now)
+  {
+    Common::ENet::SendPacket(m_peer, m_queue.front().packet, DEFAULT_CHANNEL);
+    m_queue.pop_front();
+  }
+  // Nothing is sent anymore once the relay is gone
+  if (!m_peer)
+    m_queue.clear();
+
+  ENetEvent event;
+  while (m_peer && enet_host_service(m_host.get(), &event, 0) > 0)
+  {
+    switch (event.type)
+    {
+    case ENET_EVENT_TYPE_CONNECT:
+    {
+      INFO_LOG_FMT(NETPLAY, "Connected to the broadcast relay");
+      sf::Packet hello;
+      hello << Common::GetScmRevGitStr();
+      hello << static_cast<u32>(m_delay.count());
+      hello << m_key;
+      hello << m_spectator_key;
+      Common::ENet::SendPacket(m_peer, hello, DEFAULT_CHANNEL);
+      m_connected = true;
+      events.connected = true;
+      break;
+    }
+    case ENET_EVENT_TYPE_RECEIVE:
+      if (event.packet->dataLength != 0 &&
+          static_cast<MessageID>(event.packet->data[0]) == MessageID::BroadcastKeyframeRequest)
+      {
+        events.keyframe_requested = true;
+      }
+      enet_packet_destroy(event.packet);
+      break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+      ERROR_LOG_FMT(NETPLAY, "Lost the connection to the broadcast relay");
+      m_peer = nullptr;
+      m_connected = false;
+      events.disconnected = true;
+      break;
+    default:
+      break;
+    }
+  }
+  return events;
+}
+
+BroadcastRelay::BroadcastRelay(u16 port, u32 max_spectators, std::string key)
+    : m_max_spectators(std::min<u32>(max_spectators, ENET_PROTOCOL_MAXIMUM_PEER_ID - 1)),
+      m_key(std::move(key))
+{
+  if (enet_initialize() != 0)
+    return;
+
+  ENetAddress address;
+  address.host = ENET_HOST_ANY;
+  address.port = port;
+  // Room for the host, and for spectators that are turned away
+  m_host.reset(enet_host_create(&address, std::min<size_t>(m_max_spectators + 16,
+                                                           ENET_PROTOCOL_MAXIMUM_PEER_ID),
+                                CHANNEL_COUNT, 0, 0));
+  if (m_host)
+    m_host->mtu = std::min(m_host->mtu, MAX_ENET_MTU);
+}
+
+BroadcastRelay::~BroadcastRelay()
+{
+  if (!m_host)
+    return;
+
+  for (auto& [peer, spectator] : m_spectators)
+    enet_peer_disconnect(peer, 0);
+  if (m_source)
+    enet_peer_disconnect(m_source, 0);
+  enet_host_flush(m_host.get());
+}
+
+void BroadcastRelay::Service(std::chrono::milliseconds timeout)
+{
+  ENetEvent event;
+  int net = enet_host_service(m_host.get(), &event, static_cast<u32>(timeout.count()));
+  while (net > 0)
+  {
+    switch (event.type)
+    {
+    case ENET_EVENT_TYPE_CONNECT:
+      enet_peer_timeout(event.peer, 0, PEER_TIMEOUT.count(), PEER_TIMEOUT.count());
+      if (event.data != BROADCAST_SOURCE_MAGIC)
+      {
+        m_spectators.emplace(event.peer, Spectator{});
+      }
+      else if (m_key.empty())
+      {
+        WARN_LOG_FMT(NETPLAY, "Turning away a host, {:x}:{}, as the relay has no key",
+                     event.peer->address.host, event.peer->address.port);
+        enet_peer_disconnect(event.peer, 0);
+      }
+      else if (m_source)
+      {
+        WARN_LOG_FMT(NETPLAY, "Turning away a second host, {:x}:{}", event.peer->address.host,
+                     event.peer->address.port);
+        enet_peer_disconnect(event.peer, 0);
+      }
+      else
+      {
+        // Not the host until its first message shows the key
+        m_pending_sources.insert(event.peer);
+      }
+      break;
+    case ENET_EVENT_TYPE_RECEIVE:
+    {
+      const std::span<const u8> data(event.packet->data, event.packet->dataLength);
+      m_stats.bytes_received += data.size();
+      const auto it = m_spectators.find(event.peer);
+      if (!data.empty() && event.peer == m_source)
+        OnSourceData(data);
+      else if (m_pending_sources.contains(event.peer))
+        OnSourceHello(event.peer, data);
+      else if (!data.empty() && it != m_spectators.end())
+        OnSpectatorData(event.peer, it->second, data);
+      enet_packet_destroy(event.packet);
+      break;
+    }
+    case ENET_EVENT_TYPE_DISCONNECT:
+      OnDisconnect(event.peer);
+      break;
+    default:
+      break;
+    }
+    net = enet_host_service(m_host.get(), &event, 0);
+  }
+
+  // Joiners that waited long enough for a keyframe make do with what there is
+  const auto now = std::chrono::steady_clock::now();
+  for (auto& [peer, spectator] : m_spectators)
+  {
+    if (spectator.waiting_until && *spectator.waiting_until <= now)
+    {
+      spectator.waiting_until.reset();
+      SendGame(peer);
+    }
+  }
+}
+
+void BroadcastRelay::OnSourceHello(ENetPeer* peer, std::span<const u8> data)
+{
+  m_pending_sources.erase(peer);
+
+  // The first message of a host tells the version spectators need, the delay and the keys
+  sf::Packet packet;
+  packet.append(data.data(), data.size());
+  std::string version;
+  u32 delay = 0;
+  std::string key;
+  std::string spectator_key;
+  packet >> version >> delay >> key >> spectator_key;
+  if (!packet || key != m_key || m_source)
+  {
+    WARN_LOG_FMT(NETPLAY, "Turning away a host, {:x}:{}, without the key of the relay",
+                 peer->address.host, peer->address.port);
+    enet_peer_disconnect(peer, 0);
+    return;
+  }
+
+  m_source = peer;
+  m_version = std::move(version);
+  m_delay = std::chrono::seconds(delay);
+  m_spectator_key = std::move(spectator_key);
+  INFO_LOG_FMT(NETPLAY, "Host connected from {:x}:{}, runs {} with a delay of {}s",
+               peer->address.host, peer->address.port, m_version, delay);
+}
+
+void BroadcastRelay::OnSourceData(std::span<const u8> data)
+{
+  const MessageID mid = GetMessageID(data);
+  switch (mid)
+  {
+  case MessageID::BroadcastInputs:
+  {
+    const std::optional<std::vector<BroadcastInput>> inputs = DecodeBroadcastBatch(data.subspan(1));
+    if (!inputs)
+    {
+      ERROR_LOG_FMT(NETPLAY, "Dropping a malformed batch of inputs");
+      return;
+    }
+    Batch batch{Message(data.begin(), data.end()), {}};
+    for (const BroadcastInput& input : *inputs)
+      batch.end[input.pad] = std::max(batch.end[input.pad], input.index + 1);
+    m_batches.push_back(std::move(batch));
+    ++m_stats.batches;
+    SendToSpectators(data, true);
+    break;
+  }
+  case MessageID::BroadcastKeyframe:
+  {
+    sf::Packet packet;
+    packet.append(data.data(), data.size());
+    MessageID keyframe_mid;
+    packet >> keyframe_mid;
+    for (u64& inputs : m_keyframe_inputs)
+      inputs = Common::PacketReadU64(packet);
+
+    m_keyframe = Message(data.begin(), data.end());
+    m_keyframe_time = std::chrono::steady_clock::now();
+    m_keyframe_requested.reset();
+    ++m_stats.keyframes;
+    INFO_LOG_FMT(NETPLAY, "Received a keyframe of {} bytes", data.size());
+
+    // Batches that end before the keyframe are not needed anymore
+    while (!m_batches.empty())
+    {
+      const Batch& batch = m_batches.front();
+      bool covered = true;
+      for (size_t pad = 0; pad < BroadcastEncoder::NUM_PADS; ++pad)
+        covered = covered && batch.end[pad] <= m_keyframe_inputs[pad];
+      if (!covered)
+        break;
+      m_batches.pop_front();
+    }
+
+    for (auto& [peer, spectator] : m_spectators)
+    {
+      if (!spectator.waiting_until)
+        continue;
+      spectator.waiting_until.reset();
+      SendGame(peer);
+    }
+    break;
+  }
+  case MessageID::SyncCodes:
+    if (m_start_game)
+      ClearGame();
+    m_game_setup.emplace_back(data.begin(), data.end());
+    SendToSpectators(data, true);
+    break;
+  case MessageID::StartGame:
+    if (m_start_game)
+      ClearGame();
+    m_start_game = Message(data.begin(), data.end());
+    SendToSpectators(data, true);
+    break;
+  case MessageID::StopGame:
+  case MessageID::DisableGame:
+    SendToSpectators(data, true);
+    ClearGame();
+    break;
+  case MessageID::PlayerJoin:
+    if (data.size() > 1)
+      m_players[data[1]] = Message(data.begin(), data.end());
+    SendToSpectators(data, false);
+    break;
+  case MessageID::PlayerLeave:
+    if (data.size() > 1)
+      m_players.erase(data[1]);
+    SendToSpectators(data, false);
+    break;
+  case MessageID::ChatMessage:
+    SendToSpectators(data, false);
+    break;
+  default:
+    m_lobby[mid] = Message(data.begin(), data.end());
+    SendToSpectators(data, false);
+    break;
+  }
+}
+
+void BroadcastRelay::OnSpectatorData(ENetPeer* peer, Spectator& spectator,
+                                     std::span<const u8> data)
+{
+  // Spectators only ever speak to introduce themselves
+  if (spectator.joined)
+    return;
+
+  sf::Packet packet;
+  packet.append(data.data(), data.size());
+  std::string version;
+  std::string revision;
+  std::string name;
+  std::string key;
+  std::string spectator_key;
+  packet >> version >> revision >> name >> key >> spectator_key;
+
+  ConnectionError error = ConnectionError::NoError;
+  if (m_version.empty())
+    error = ConnectionError::NotBroadcasting;
+  else if (version != m_version)
+    error = ConnectionError::VersionMismatch;
+  else if (m_stats.spectators >= m_max_spectators)
+    error = ConnectionError::ServerFull;
+  else if (StringUTF8CodePointCount(name) > MAX_NAME_LENGTH)
+    error = ConnectionError::NameTooLong;
+  else if (spectator_key != m_spectator_key)
+    error = ConnectionError::WrongSpectatorKey;
+
+  sf::Packet response;
+  response << error;
+  if (error != ConnectionError::NoError)
+  {
+    Send(peer, GetPacketData(response));
+    enet_peer_disconnect_later(peer, 0);
+    return;
+  }
+
+  response << BROADCAST_SPECTATOR_PID;
+  Send(peer, GetPacketData(response));
+  spectator.joined = true;
+  ++m_stats.spectators;
+  INFO_LOG_FMT(NETPLAY, "{} is spectating, {} spectators", name, m_stats.spectators);
+
+  for (const auto& [pid, message] : m_players)
+    Send(peer, message);
+  for (const auto& [mid, message] : m_lobby)
+    Send(peer, message);
+
+  // Without a recent keyframe, a joiner would have to catch up on much of the game
+  const auto now = std::chrono::steady_clock::now();
+  const bool needs_keyframe = m_keyframe ? now - m_keyframe_time > KEYFRAME_MAX_AGE :
+                                           !m_batches.empty();
+  if (m_start_game && needs_keyframe && m_source)
+  {
+    spectator.waiting_until = now + m_delay + KEYFRAME_WAIT;
+    RequestKeyframe();
+    return;
+  }
+  SendGame(peer);
+}
+
+void BroadcastRelay::OnDisconnect(ENetPeer* peer)
+{
+  m_pending_sources.erase(peer);
+  if (peer == m_source)
+  {
+    INFO_LOG_FMT(NETPLAY, "Host disconnected, ending the broadcast");
+    m_source = nullptr;
+    m_version.clear();
+    m_spectator_key.clear();
+    ClearGame();
+    m_players.clear();
+    m_lobby.clear();
+    for (auto& [spectator_peer, spectator] : m_spectators)
+      enet_peer_disconnect_later(spectator_peer, 0);
+    return;
+  }
+
+  const auto it = m_spectators.find(peer);
+  if (it == m_spectators.end())
+    return;
+  if (it->second.joined)
+    --m_stats.spectators;
+  m_spectators.erase(it);
+}
+
+void BroadcastRelay::SendGame(ENetPeer* peer)
+{
+  for (const Message& message : m_game_setup)
+    Send(peer, message);
+  // Ahead of the start, so that the spectator has it before the game boots
+  if (m_start_game && m_keyframe)
+    Send(peer, *m_keyframe);
+  if (m_start_game)
+    Send(peer, *m_start_game);
+  for (const Batch& batch : m_batches)
+    Send(peer, batch.message);
+}
+
+void BroadcastRelay::SendToSpectators(std::span<const u8> data, bool game)
+{
+  // One packet shared by all of them
+  ENetPacket* packet = enet_packet_create(data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
+  for (const auto& [peer, spectator] : m_spectators)
+  {
+    if (!spectator.joined || (game && spectator.waiting_until))
+      continue;
+    enet_peer_send(peer, DEFAULT_CHANNEL, packet);
+    m_stats.bytes_sent += data.size();
+  }
+  if (packet->referenceCount == 0)
+    enet_packet_destroy(packet);
+}
+
+void BroadcastRelay::Send(ENetPeer* peer, std::span<const u8> data)
+{
+  ENetPacket* packet = enet_packet_create(data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
+  if (enet_peer_send(peer, DEFAULT_CHANNEL, packet) < 0)
+    enet_packet_destroy(packet);
+  m_stats.bytes_sent += data.size();
+}
+
+void BroadcastRelay::RequestKeyframe()
+{
+  const auto now = std::chrono::steady_clock::now();
+  if (m_keyframe_requested && now - *m_keyframe_requested < m_delay + KEYFRAME_WAIT)
+    return;
+
+  sf::Packet packet;
+  packet << MessageID::BroadcastKeyframeRequest;
+  Send(m_source, GetPacketData(packet));
+  m_keyframe_requested = now;
+}
+
+void BroadcastRelay::ClearGame()
+{
+  m_game_setup.clear();
+  m_start_game.reset();
+  m_keyframe.reset();
+  m_keyframe_requested.reset();
+  m_batches.clear();
+  // There is nothing left to wait for
+  for (auto& [peer, spectator] : m_spectators)
+    spectator.waiting_until.reset();
+}
+}  // namespace NetPlay
@@ -0,0 +1,220 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+
+#include "Common/CommonTypes.h"
+#include "Common/ENet.h"
+#include "Core/NetPlayProto.h"
+#include "InputCommon/GCPadStatus.h"
+
+namespace NetPlay
+{
+// Spectators of a broadcast are not players of the session, the relay gives all of them this id
+constexpr PlayerId BROADCAST_SPECTATOR_PID = 0xFF;
+constexpr u16 DEFAULT_RELAY_PORT = 2627;
+
+struct BroadcastInput
+{
+  PadIndex pad;
+  // Inputs of a pad are counted from the start of the game
+  u64 index;
+  GCPadStatus status;
+};
+
+// Packs the inputs of a game for broadcasting. An input is stored as the fields that changed since
+// the input before it, and runs of inputs that did not change at all take a byte. Every batch
+// starts from a neutral pad, so that it can be decoded without the batches before it.
+class BroadcastEncoder final
+{
+public:
+  static constexpr size_t NUM_PADS = 4;
+
+  // Starts counting inputs from zero
+  void Reset();
+  void AddInput(PadIndex pad, const GCPadStatus& status);
+  bool HasInputs() const;
+  // Encodes the inputs added since the last batch
+  std::vector<u8> TakeBatch();
+
+private:
+  struct PadStream
+  {
+    u64 next_index = 0;
+    std::vector<GCPadStatus> pending;
+  };
+
+  std::array<PadStream, NUM_PADS> m_pads;
+};
+
+// Consecutive inputs of a pad
+struct PadInputRun
+{
+  PadIndex pad;
+  u64 first_index;
+  std::span<const GCPadStatus> inputs;
+};
+
+// The format of the batches, which the redundant input transport of players uses as well. A pad
+// may have several runs, and there are no more than 255 of them.
+std::vector<u8> EncodeInputBatch(std::span<const PadInputRun> runs);
+// Empty if the batch is malformed
+std::optional<std::vector<BroadcastInput>> DecodeBroadcastBatch(std::span<const u8> data);
+
+// The host side of a broadcast. Mirrors what the server sends its players, except for inputs,
+// which are batched, to a relay. Everything is held back by the spectator delay, in the order it
+// was sent.
+//
+// Thread safe, messages are sent from the GUI and server threads.
+class BroadcastSource final
+{
+public:
+  static constexpr std::chrono::milliseconds BATCH_INTERVAL{250};
+
+  struct Events
+  {
+    bool connected = false;
+    bool disconnected = false;
+    bool keyframe_requested = false;
+  };
+
+  // The address is "host:port" or "host". The key is the one the relay was started with, and
+  // spectators need the spectator key to watch, anyone may if it is empty.
+  BroadcastSource(const std::string& relay_address, std::chrono::seconds delay, std::string key,
+                  std::string spectator_key);
+  ~BroadcastSource();
+  BroadcastSource(const BroadcastSource&) = delete;
+  BroadcastSource& operator=(const BroadcastSource&) = delete;
+
+  bool IsValid() const { return m_host != nullptr; }
+
+  // Inputs of a new game are counted from zero once its StartGame is sent
+  void SendMessage(const sf::Packet& packet);
+  void AddInput(PadIndex pad, const GCPadStatus& status);
+
+  // Sends what is due and services the connection, called from the server thread
+  Events Update();
+
+private:
+  struct Pending
+  {
+    std::chrono::steady_clock::time_point due;
+    sf::Packet packet;
+  };
+
+  void QueueBatch();
+
+  std::mutex m_mutex;
+  Common::ENet::ENetHostPtr m_host;
+  ENetPeer* m_peer = nullptr;
+  bool m_connected = false;
+  const std::chrono::seconds m_delay;
+  const std::string m_key;
+  const std::string m_spectator_key;
+  BroadcastEncoder m_encoder;
+  std::chrono::steady_clock::time_point m_last_batch;
+  std::deque<Pending> m_queue;
+};
+
+// Fans a broadcast out to spectators, who connect like to a server and are sent what its players
+// are sent. Spectators that join during a game get the latest keyframe, a savestate of the host,
+// followed by the inputs after it.
+//
+// Only a host that knows the key of the relay may broadcast, without a key nobody can. Spectators
+// need the spectator key that the host set for its broadcast.
+class BroadcastRelay final
+{
+public:
+  struct Stats
+  {
+    size_t spectators = 0;
+    u64 batches = 0;
+    u64 keyframes = 0;
+    u64 bytes_received = 0;
+    u64 bytes_sent = 0;
+  };
+
+  BroadcastRelay(u16 port, u32 max_spectators, std::string key);
+  ~BroadcastRelay();
+  BroadcastRelay(const BroadcastRelay&) = delete;
+  BroadcastRelay& operator=(const BroadcastRelay&) = delete;
+
+  bool IsValid() const { return m_host != nullptr; }
+  bool HasSource() const { return m_source != nullptr; }
+
+  void Service(std::chrono::milliseconds timeout);
+  const Stats& GetStats() const { return m_stats; }
+
+private:
+  // Joiners wait this much longer than the spectator delay for a keyframe they asked for
+  static constexpr std::chrono::seconds KEYFRAME_WAIT{10};
+  // Joiners ask for a new keyframe if the latest one is older than this
+  static constexpr std::chrono::seconds KEYFRAME_MAX_AGE{30};
+
+  using Message = std::vector<u8>;
+
+  struct Spectator
+  {
+    bool joined = false;
+    // Only sent the lobby until a fresh keyframe arrives or the wait ends
+    std::optional<std::chrono::steady_clock::time_point> waiting_until;
+  };
+
+  struct Batch
+  {
+    Message message;
+    // Per pad, one past the last input of the batch
+    std::array<u64, BroadcastEncoder::NUM_PADS> end{};
+  };
+
+  void OnSourceHello(ENetPeer* peer, std::span<const u8> data);
+  void OnSourceData(std::span<const u8> data);
+  void OnSpectatorData(ENetPeer* peer, Spectator& spectator, std::span<const u8> data);
+  void OnDisconnect(ENetPeer* peer);
+  void SendGame(ENetPeer* peer);
+  // Game messages are held back from joiners that wait for a keyframe
+  void SendToSpectators(std::span<const u8> data, bool game);
+  void Send(ENetPeer* peer, std::span<const u8> data);
+  void RequestKeyframe();
+  void ClearGame();
+
+  Common::ENet::ENetHostPtr m_host;
+  const u32 m_max_spectators;
+  const std::string m_key;
+  // Hosts that connected but have not shown the key yet
+  std::set<ENetPeer*> m_pending_sources;
+  ENetPeer* m_source = nullptr;
+  std::string m_version;
+  std::string m_spectator_key;
+  std::chrono::seconds m_delay{};
+  std::map<ENetPeer*, Spectator> m_spectators;
+
+  std::map<PlayerId, Message> m_players;
+  // The latest of each message that sets state of the lobby
+  std::map<MessageID, Message> m_lobby;
+  // Sent before the game starts, like the codes
+  std::vector<Message> m_game_setup;
+  std::optional<Message> m_start_game;
+  std::optional<Message> m_keyframe;
+  std::array<u64, BroadcastEncoder::NUM_PADS> m_keyframe_inputs{};
+  std::chrono::steady_clock::time_point m_keyframe_time;
+  std::optional<std::chrono::steady_clock::time_point> m_keyframe_requested;
+  // Since the keyframe, or the start of the game without one
+  std::deque<Batch> m_batches;
+
+  Stats m_stats;
+};
+}  // namespace NetPlay
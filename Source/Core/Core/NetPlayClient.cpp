@@ -18,6 +18,7 @@
 
 #include <fmt/format.h>
 
+#include "AudioCommon/SoundStream.h"
 #include "Common/Assert.h"
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
@@ -30,6 +31,7 @@
 #include "Common/QoSSession.h"
 #include "Common/SFMLHelper.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 #include "Common/Timer.h"
 #include "Common/Version.h"
 
@@ -55,6 +57,7 @@
 #include "Core/HW/SI/SI_Device.h"
 #include "Core/HW/SI/SI_DeviceGCController.h"
 #include "Core/HW/Sram.h"
+#include "Core/HW/VideoInterface.h"
 #include "Core/HW/WiiSave.h"
 #include "Core/HW/WiiSaveStructs.h"
 #include "Core/HW/WiimoteEmu/DesiredWiimoteState.h"
@@ -65,8 +68,11 @@
 #include "Core/IOS/USB/Bluetooth/BTEmu.h"
 #include "Core/IOS/Uids.h"
 #include "Core/Movie.h"
+#include "Core/NetPlayBroadcast.h"
 #include "Core/NetPlayCommon.h"
+#include "Core/NetPlayRollback.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/State.h"
 #include "Core/SyncIdentifier.h"
 #include "Core/System.h"
 #include "DiscIO/Blob.h"
@@ -92,6 +98,11 @@ static std::mutex crit_netplay_client;
 static NetPlayClient* netplay_client = nullptr;
 static bool s_si_poll_batching = false;
 
+// Spectators of a broadcast run unthrottled while more inputs than this are buffered, until they
+// are down to the second number. Inputs arrive in batches of about 15.
+constexpr u32 BROADCAST_CATCH_UP_INPUTS = 60;
+constexpr u32 BROADCAST_CAUGHT_UP_INPUTS = 30;
+
 // called from ---GUI--- thread
 NetPlayClient::~NetPlayClient()
 {
@@ -107,6 +118,8 @@ NetPlayClient::~NetPlayClient()
       m_game_digest_thread.join();
     m_do_loop.Clear();
     m_thread.join();
+    if (m_broadcast_keyframe_thread.joinable())
+      m_broadcast_keyframe_thread.join();
 
     m_chunked_data_receive_queue.clear();
     m_dialog->HideChunkedProgressDialog();
@@ -280,6 +293,8 @@ bool NetPlayClient::Connect()
   packet << Common::GetNetplayDolphinVer();
   packet << m_player_name;
   packet << m_player_key;
+  // Only read by broadcast relays, servers stop after the player key
+  packet << Config::Get(Config::NETPLAY_BROADCAST_SPECTATOR_KEY);
   Send(packet);
   enet_host_flush(m_client);
   sf::Packet rpac;
@@ -322,6 +337,12 @@ bool NetPlayClient::Connect()
     case ConnectionError::NameTooLong:
       m_dialog->OnConnectionError(_trans("Nickname is too long."));
       break;
+    case ConnectionError::NotBroadcasting:
+      m_dialog->OnConnectionError(_trans("The relay is not connected to a host."));
+      break;
+    case ConnectionError::WrongSpectatorKey:
+      m_dialog->OnConnectionError(_trans("The spectator key of the broadcast is wrong."));
+      break;
     default:
       m_dialog->OnConnectionError(_trans("The server sent an unknown error message."));
       break;
@@ -426,6 +447,10 @@ void NetPlayClient::OnData(sf::Packet& packet)
     OnPadHostData(packet);
     break;
 
+  case MessageID::PadInputs:
+    OnPadInputs(packet);
+    break;
+
   case MessageID::WiimoteData:
     OnWiimoteData(packet);
     break;
@@ -523,8 +548,16 @@ void NetPlayClient::OnData(sf::Packet& packet)
     OnNightMsg(packet);
     break;  
 
-  case MessageID::Checksum:
-    OnChecksumMsg(packet);
+  case MessageID::DesyncHash:
+    OnDesyncHash(packet);
+    break;
+
+  case MessageID::DesyncNodes:
+    OnDesyncNodes(packet);
+    break;
+
+  case MessageID::DesyncBlocks:
+    OnDesyncBlocks(packet);
     break;
 
   case MessageID::GameID:
@@ -543,6 +576,18 @@ void NetPlayClient::OnData(sf::Packet& packet)
     OnCourseMsg(packet);
     break;
 
+  case MessageID::BroadcastInputs:
+    OnBroadcastInputs(packet);
+    break;
+
+  case MessageID::BroadcastKeyframe:
+    OnBroadcastKeyframe(packet);
+    break;
+
+  case MessageID::BroadcastKeyframeRequest:
+    m_broadcast_keyframe_requested = true;
+    break;
+
   default:
     PanicAlertFmtT("Unknown message received with id : {0}", static_cast<u8>(mid));
     break;
@@ -797,6 +842,27 @@ void NetPlayClient::OnPadHostData(sf::Packet& packet)
   }
 }
 
+void NetPlayClient::OnPadInputs(sf::Packet& packet)
+{
+  if (!m_input_link)
+    return;
+
+  std::vector<BroadcastInput> inputs;
+  if (!m_input_link->OnPacket(packet, inputs))
+  {
+    ERROR_LOG_FMT(NETPLAY, "Received malformed pad inputs");
+    return;
+  }
+
+  for (const BroadcastInput& input : inputs)
+    m_pad_buffer.at(input.pad).Push(input.status);
+  if (!inputs.empty())
+    m_gc_pad_event.Set();
+
+  if (m_input_link->IsAckNeeded())
+    Send(m_input_link->MakePacket(), INPUT_CHANNEL);
+}
+
 void NetPlayClient::OnWiimoteData(sf::Packet& packet)
 {
   while (!packet.endOfPacket())
@@ -1002,11 +1068,32 @@ void NetPlayClient::OnStartGame(sf::Packet& packet)
     packet >> m_net_settings.golf_mode;
     packet >> m_net_settings.use_fma;
     packet >> m_net_settings.hide_remote_gbas;
+    packet >> m_net_settings.rollback_frames;
+    packet >> m_net_settings.desync_regions;
+    packet >> m_net_settings.redundant_inputs;
 
     for (size_t i = 0; i < sizeof(m_net_settings.sram); ++i)
       packet >> m_net_settings.sram[i];
 
     m_net_settings.is_hosting = m_local_player->IsHost();
+
+    // Spectators of a broadcast start from the keyframe or from the inputs alone, saves are not
+    // sent to them and there is nothing to roll back
+    if (IsBroadcastSpectator())
+    {
+      m_net_settings.savedata_load = false;
+      m_net_settings.savedata_write = false;
+      m_net_settings.savedata_sync_all_wii = false;
+      m_net_settings.rollback_frames = 0;
+      m_net_settings.redundant_inputs = false;
+      // Inputs of the game follow right after this, before it boots
+      ClearBuffers();
+    }
+
+    // The other players may send inputs before this game is booted
+    m_input_link.reset();
+    if (m_net_settings.redundant_inputs)
+      m_input_link = std::make_unique<InputLink>(m_current_game);
   }
 
   m_dialog->OnMsgStartGame();
@@ -1017,6 +1104,8 @@ void NetPlayClient::OnStopGame(sf::Packet& packet)
   INFO_LOG_FMT(NETPLAY, "Game stopped");
 
   StopGame();
+  if (IsBroadcastSpectator())
+    ResetBroadcast();
   m_dialog->OnMsgStopGame();
 }
 
@@ -1105,6 +1194,10 @@ void NetPlayClient::OnSyncSaveData(sf::Packet& packet)
     OnSyncSaveDataGBA(packet);
     break;
 
+  case SyncSaveDataID::Blocks:
+    OnSyncSaveDataBlocks(packet);
+    break;
+
   default:
     PanicAlertFmtT("Unknown SYNC_SAVE_DATA message received with id: {0}", static_cast<u8>(sub_id));
     break;
@@ -1158,7 +1251,7 @@ void NetPlayClient::OnSyncSaveDataRaw(sf::Packet& packet)
     return;
   }
 
-  const bool success = DecompressPacketIntoFile(packet, path);
+  const bool success = m_sync_blocks.ReadFile(packet, path);
   SyncSaveDataResponse(success);
 }
 
@@ -1190,7 +1283,7 @@ void NetPlayClient::OnSyncSaveDataGCI(sf::Packet& packet)
     INFO_LOG_FMT(NETPLAY, "Received GCI: {}", file_name);
 
     if (!Common::IsFileNameSafe(file_name) ||
-        !DecompressPacketIntoFile(packet, path + DIR_SEP + file_name))
+        !m_sync_blocks.ReadFile(packet, path + DIR_SEP + file_name))
     {
       WARN_LOG_FMT(NETPLAY, "Received invalid GCI.");
       SyncSaveDataResponse(false);
@@ -1235,7 +1328,7 @@ void NetPlayClient::OnSyncSaveDataWii(sf::Packet& packet)
   {
     INFO_LOG_FMT(NETPLAY, "Received Mii data.");
 
-    auto buffer = DecompressPacketIntoBuffer(packet);
+    auto buffer = m_sync_blocks.ReadBuffer(packet);
 
     temp_fs->CreateFullPath(IOS::PID_KERNEL, IOS::PID_KERNEL, "/shared2/menu/FaceLib/", 0,
                             fs_modes);
@@ -1314,7 +1407,7 @@ void NetPlayClient::OnSyncSaveDataWii(sf::Packet& packet)
 
       if (file.type == WiiSave::Storage::SaveFile::Type::File)
       {
-        auto buffer = DecompressPacketIntoBuffer(packet);
+        auto buffer = m_sync_blocks.ReadBuffer(packet);
         if (!buffer)
         {
           SyncSaveDataResponse(false);
@@ -1340,7 +1433,7 @@ void NetPlayClient::OnSyncSaveDataWii(sf::Packet& packet)
   if (has_redirected_save)
   {
     INFO_LOG_FMT(NETPLAY, "Received redirected save.");
-    if (!DecompressPacketIntoFolder(packet, redirect_path))
+    if (!m_sync_blocks.ReadFolder(packet, redirect_path))
     {
       PanicAlertFmtT("Failed to write redirected save.");
       SyncSaveDataResponse(false);
@@ -1369,10 +1462,26 @@ void NetPlayClient::OnSyncSaveDataGBA(sf::Packet& packet)
     return;
   }
 
-  const bool success = DecompressPacketIntoFile(packet, path);
+  const bool success = m_sync_blocks.ReadFile(packet, path);
   SyncSaveDataResponse(success);
 }
 
+void NetPlayClient::OnSyncSaveDataBlocks(sf::Packet& packet)
+{
+  // Decompressed as they arrive, while the next ones are still being sent
+  constexpr size_t header_size = sizeof(MessageID) + sizeof(SyncSaveDataID);
+  const std::span<const u8> batch(static_cast<const u8*>(packet.getData()) + header_size,
+                                  packet.getDataSize() - header_size);
+
+  INFO_LOG_FMT(NETPLAY, "Received {} bytes of save data blocks.", batch.size());
+
+  if (!m_sync_blocks.AddBatch(batch))
+  {
+    WARN_LOG_FMT(NETPLAY, "Received invalid save data blocks.");
+    SyncSaveDataResponse(false);
+  }
+}
+
 void NetPlayClient::OnSyncCodes(sf::Packet& packet)
 {
   // Recieve Data Packet
@@ -1654,17 +1763,203 @@ void NetPlayClient::OnDisableReplaysMsg(sf::Packet& packet)
   Gecko::setDisableReplays(disable);
 }
 
-void NetPlayClient::OnChecksumMsg(sf::Packet& packet)
+void NetPlayClient::OnDesyncHash(sf::Packet& packet)
+{
+  PlayerId pid;
+  packet >> pid;
+  const u64 frame = Common::PacketReadU64(packet);
+  const u64 root = Common::PacketReadU64(packet);
+
+  if (!m_desync_detector)
+    return;
+  m_desync_detector->AddRemoteRoot(pid, frame, root);
+  CheckDesyncMismatch();
+}
+
+void NetPlayClient::OnDesyncNodes(sf::Packet& packet)
 {
-  u32 inChecksum;
-  u8 checksumId;
-  packet >> inChecksum;
-  packet >> checksumId;
+  PlayerId pid;
+  packet >> pid;
+  const u64 frame = Common::PacketReadU64(packet);
+  u32 level;
+  u32 count;
+  packet >> level;
+  packet >> count;
+
+  if (!m_desync_detector)
+    return;
+  // The count comes from the peer, the level it names has no more nodes than here
+  if (count > m_desync_detector->GetLevelSize(level))
+  {
+    WARN_LOG_FMT(NETPLAY, "Player {} sent {} desync nodes for level {}", pid, count, level);
+    return;
+  }
+
+  std::vector<DesyncDetector::Node> nodes(count);
+  for (DesyncDetector::Node& node : nodes)
+  {
+    packet >> node.index;
+    node.hash = Common::PacketReadU64(packet);
+  }
+
+  const std::vector<u32> differing = m_desync_detector->Compare(frame, level, nodes);
+  if (differing.empty())
+    return;
+
+  if (level < m_desync_detector->GetDepth())
+  {
+    SendDesyncNodes(frame, level + 1, differing);
+    return;
+  }
 
-  if (ourChecksum[checksumId] != inChecksum)
+  std::string ranges;
+  for (const u32 leaf : differing)
   {
-    m_dialog->OnDesync(0, "");
+    const DesyncDetector::Block& block = m_desync_detector->GetBlock(leaf);
+    ranges += block.registers ?
+                  std::string(" registers") :
+                  fmt::format(" {:08x}-{:08x}", block.address, block.address + block.size);
   }
+  INFO_LOG_FMT(NETPLAY, "Desync with player {} at frame {}:{}", pid, frame, ranges);
+  m_dialog->AppendChat(fmt::format("Desync at frame {} in{}", frame, ranges));
+  SendDesyncBlocks(frame, differing);
+}
+
+void NetPlayClient::OnDesyncBlocks(sf::Packet& packet)
+{
+  PlayerId pid;
+  packet >> pid;
+  const u64 frame = Common::PacketReadU64(packet);
+  u32 count;
+  packet >> count;
+
+  if (!m_desync_detector)
+    return;
+
+  std::string player_name = fmt::format("player{}", pid);
+  {
+    std::lock_guard lkp(m_crit.players);
+    const auto it = m_players.find(pid);
+    if (it != m_players.end())
+      player_name = it->second.name;
+  }
+
+  // The remote blocks next to the local ones, to be compared with a hex editor
+  const std::string path = GetDesyncDumpPath(frame);
+  for (u32 i = 0; i < count; ++i)
+  {
+    u32 leaf;
+    u32 size;
+    packet >> leaf;
+    packet >> size;
+    if (size > DesyncDetector::BLOCK_SIZE)
+      return;
+    std::vector<u8> data(size);
+    for (u8& byte : data)
+      packet >> byte;
+
+    const std::vector<u8> local = m_desync_detector->GetBlockData(frame, leaf);
+    if (local.empty())
+      continue;
+    const DesyncDetector::Block& block = m_desync_detector->GetBlock(leaf);
+    const std::string name =
+        block.registers ? std::string("registers") : fmt::format("{:08x}", block.address);
+    File::IOFile(fmt::format("{}{}_local.bin", path, name), "wb")
+        .WriteBytes(local.data(), local.size());
+    File::IOFile(fmt::format("{}{}_{}.bin", path, name, pid), "wb")
+        .WriteBytes(data.data(), data.size());
+  }
+
+  INFO_LOG_FMT(NETPLAY, "Dumped the desynced blocks of {} to {}", player_name, path);
+  m_dialog->AppendChat(fmt::format("Dumped the desynced memory of {} to {}", player_name, path));
+}
+
+// called from ---CPU--- thread and ---NETPLAY--- thread
+void NetPlayClient::CheckDesyncMismatch()
+{
+  const std::optional<DesyncDetector::Mismatch> mismatch = m_desync_detector->TakeMismatch();
+  if (!mismatch)
+    return;
+
+  std::string player = "??";
+  {
+    std::lock_guard lkp(m_crit.players);
+    const auto it = m_players.find(mismatch->pid);
+    if (it != m_players.end())
+      player = it->second.name;
+  }
+  INFO_LOG_FMT(NETPLAY, "Game state of player {} ({}) differs in frames {} to {}", player,
+               mismatch->pid, mismatch->frame, mismatch->frame + DesyncDetector::STATE_FRAMES - 1);
+  m_dialog->OnDesync(static_cast<u32>(mismatch->frame), player);
+
+  // The local state, to go with the blocks that differ once they are found
+  const std::string path = GetDesyncDumpPath(mismatch->frame);
+  const std::vector<u8> state = m_desync_detector->GetStateData(mismatch->frame);
+  File::IOFile(path + "state_local.bin", "wb").WriteBytes(state.data(), state.size());
+
+  // The other players send theirs as well, and each side answers with the children of the nodes
+  // that differ
+  const u32 root = 0;
+  if (m_desync_detector->GetDepth() == 0)
+    SendDesyncBlocks(mismatch->frame, {&root, 1});
+  else
+    SendDesyncNodes(mismatch->frame, 1, {&root, 1});
+}
+
+void NetPlayClient::SendDesyncNodes(u64 frame, u32 level, std::span<const u32> parents)
+{
+  u32 sent = m_desync_levels_sent.load();
+  do
+  {
+    if (level <= sent)
+      return;
+  } while (!m_desync_levels_sent.compare_exchange_weak(sent, level));
+
+  const std::vector<DesyncDetector::Node> nodes =
+      m_desync_detector->GetChildren(frame, level, parents);
+  sf::Packet packet;
+  packet << MessageID::DesyncNodes;
+  packet << sf::Uint64{frame};
+  packet << level;
+  packet << static_cast<u32>(nodes.size());
+  for (const DesyncDetector::Node& node : nodes)
+  {
+    packet << node.index;
+    packet << sf::Uint64{node.hash};
+  }
+  SendAsync(std::move(packet));
+}
+
+void NetPlayClient::SendDesyncBlocks(u64 frame, std::span<const u32> leaves)
+{
+  // A few are enough to see what went wrong, after a while everything differs anyway
+  constexpr size_t MAX_BLOCKS = 8;
+
+  if (m_desync_blocks_sent.exchange(true))
+    return;
+
+  const size_t count = std::min(leaves.size(), MAX_BLOCKS);
+  sf::Packet packet;
+  packet << MessageID::DesyncBlocks;
+  packet << sf::Uint64{frame};
+  packet << static_cast<u32>(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    const std::vector<u8> data = m_desync_detector->GetBlockData(frame, leaves[i]);
+    packet << leaves[i];
+    packet << static_cast<u32>(data.size());
+    packet.append(data.data(), data.size());
+  }
+  SendAsync(std::move(packet));
+}
+
+std::string NetPlayClient::GetDesyncDumpPath(u64 frame) const
+{
+  const std::string path =
+      fmt::format("{}Desync/{}/frame{}_", File::GetUserPath(D_DUMP_IDX), m_selected_game.game_id,
+                  frame);
+  File::CreateFullPath(path);
+  return path;
 }
 
 void NetPlayClient::OnGameIDMsg(sf::Packet& packet)
@@ -1691,7 +1986,7 @@ void NetPlayClient::OnCourseMsg(sf::Packet& packet)
 
 void NetPlayClient::Send(const sf::Packet& packet, const u8 channel_id)
 {
-  Common::ENet::SendPacket(m_server, packet, channel_id);
+  Common::ENet::SendPacket(m_server, packet, channel_id, GetChannelFlags(channel_id));
 }
 
 void NetPlayClient::DisplayPlayersPing()
@@ -1816,7 +2111,13 @@ void NetPlayClient::ThreadFunc()
     int net;
     if (m_traversal_client)
       m_traversal_client->HandleResends();
-    net = enet_host_service(m_client, &netEvent, 250);
+    // Inputs that were not acknowledged are resent a few times a second
+    net = enet_host_service(m_client, &netEvent, m_input_link ? 50 : 250);
+    if (m_input_link && m_is_running.IsSet() &&
+        m_input_link->NeedsResend(std::chrono::steady_clock::now()))
+    {
+      Send(m_input_link->MakePacket(), INPUT_CHANNEL);
+    }
 
     // run auto golf mode stuff here
     if (Core::IsRunning() && m_is_running.IsSet())  // redundancy
@@ -1973,6 +2274,19 @@ void NetPlayClient::AddPadStateToPacket(const int in_game_pad, const GCPadStatus
     packet << pad.analogA << pad.analogB << pad.stickX << pad.stickY << pad.substickX
            << pad.substickY << pad.triggerLeft << pad.triggerRight << pad.isConnected;
   }
+
+  if (m_input_link && !m_host_input_authority)
+    m_input_link->AddInput(static_cast<PadIndex>(in_game_pad), pad);
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::SendPadData(sf::Packet&& packet)
+{
+  // The link was given the same inputs, and sends them with the ones that were not acknowledged
+  if (m_input_link && !m_host_input_authority)
+    SendAsync(m_input_link->MakePacket(), INPUT_CHANNEL);
+  else
+    SendAsync(std::move(packet));
 }
 
 // called from ---CPU--- thread
@@ -2024,9 +2338,36 @@ bool NetPlayClient::StartGame(const std::string& path)
   m_is_running.Set();
   NetPlay_Enable(this);
 
-  ClearBuffers();
+  // Spectators of a broadcast may already have the first inputs
+  if (!IsBroadcastSpectator())
+    ClearBuffers();
 
   m_first_pad_status_received.fill(false);
+  m_consumed_pad_inputs.fill(0);
+  m_last_broadcast_keyframe = {};
+  m_broadcast_catching_up = false;
+
+  // Spectators have nobody to compare with
+  m_desync_detector.reset();
+  if (!IsBroadcastSpectator())
+  {
+    m_desync_detector =
+        std::make_unique<DesyncDetector>(ParseDesyncRegions(m_net_settings.desync_regions));
+  }
+  m_desync_levels_sent = 0;
+  m_desync_blocks_sent = false;
+
+  m_rollback_session.reset();
+  if (m_net_settings.rollback_frames != 0)
+  {
+    // Owned by the functions, so that it is destroyed along with the buffers it saved
+    auto states = std::make_shared<State::IncrementalStates>();
+    m_rollback_session = std::make_unique<RollbackSession>(
+        m_net_settings.rollback_frames,
+        std::chrono::microseconds(Config::Get(Config::NETPLAY_ROLLBACK_BUDGET_US)),
+        [states](std::vector<u8>& buffer) { states->Save(buffer); },
+        [states](const std::vector<u8>& buffer) { states->Load(buffer); });
+  }
 
   if (m_dialog->IsRecording())
   {
@@ -2096,6 +2437,9 @@ void NetPlayClient::SyncSaveDataResponse(const bool success)
   {
     if (++m_sync_save_data_success_count >= m_sync_save_data_count)
     {
+      // The host will only send the blocks that were not part of this sync
+      m_sync_blocks.Retain();
+
       sf::Packet response_packet;
       response_packet << MessageID::SyncSaveData;
       response_packet << SyncSaveDataID::Success;
@@ -2105,6 +2449,8 @@ void NetPlayClient::SyncSaveDataResponse(const bool success)
   }
   else
   {
+    m_sync_blocks.Clear();
+
     sf::Packet response_packet;
     response_packet << MessageID::SyncSaveData;
     response_packet << SyncSaveDataID::Failure;
@@ -2288,6 +2634,12 @@ bool NetPlayClient::GetNetPads(const int pad_nb, const bool batching, GCPadStatu
   // specific pad arbitrarily. In this case, we poll just that pad
   // and send it.
 
+  if (IsBroadcastSpectator())
+    return GetBroadcastPad(pad_nb, pad_status);
+
+  if (m_rollback_session)
+    return GetRollbackPad(pad_nb, batching, pad_status);
+
   // When here when told to so we don't deadlock in certain situations
   while (m_wait_on_input)
   {
@@ -2322,7 +2674,7 @@ bool NetPlayClient::GetNetPads(const int pad_nb, const bool batching, GCPadStatu
     }
 
     if (send_packet)
-      SendAsync(std::move(packet));
+      SendPadData(std::move(packet));
 
     if (m_host_input_authority)
       SendPadHostPoll(-1);
@@ -2336,7 +2688,7 @@ bool NetPlayClient::GetNetPads(const int pad_nb, const bool batching, GCPadStatu
       sf::Packet packet;
       packet << MessageID::PadData;
       if (PollLocalPad(local_pad, packet))
-        SendAsync(std::move(packet));
+        SendPadData(std::move(packet));
     }
 
     if (m_host_input_authority)
@@ -2397,6 +2749,7 @@ bool NetPlayClient::GetNetPads(const int pad_nb, const bool batching, GCPadStatu
   }
 
   m_pad_buffer[pad_nb].Pop(*pad_status);
+  ++m_consumed_pad_inputs[pad_nb];
 
   auto& movie = Core::System::GetInstance().GetMovie();
   if (movie.IsRecordingInput())
@@ -2412,6 +2765,262 @@ bool NetPlayClient::GetNetPads(const int pad_nb, const bool batching, GCPadStatu
   return true;
 }
 
+// called from ---CPU--- thread
+bool NetPlayClient::GetRollbackPad(const int pad_nb, const bool batching,
+                                   GCPadStatus* pad_status)
+{
+  // Re-simulated frames read the inputs that were already read for them, only live frames poll
+  // the local pads. Polling works like GetNetPads otherwise.
+  if (!m_rollback_session->IsResimulating())
+  {
+    if (IsFirstInGamePad(pad_nb) && batching)
+    {
+      sf::Packet packet;
+      packet << MessageID::PadData;
+
+      bool send_packet = false;
+      const int num_local_pads = NumLocalPads();
+      for (int local_pad = 0; local_pad < num_local_pads; local_pad++)
+        send_packet = PollLocalPad(local_pad, packet) || send_packet;
+
+      if (send_packet)
+        SendPadData(std::move(packet));
+    }
+    else if (!batching)
+    {
+      const int local_pad = InGamePadToLocalPad(pad_nb);
+      if (local_pad < 4)
+      {
+        sf::Packet packet;
+        packet << MessageID::PadData;
+        if (PollLocalPad(local_pad, packet))
+          SendPadData(std::move(packet));
+      }
+    }
+  }
+
+  // Only waits when the remote inputs are further behind than predictions may go
+  ReceiveRollbackInputs();
+  while (!m_rollback_session->CanConsume(pad_nb))
+  {
+    if (!m_is_running.IsSet())
+      return false;
+
+    m_gc_pad_event.Wait();
+    ReceiveRollbackInputs();
+  }
+
+  // Movies are not recorded in this mode, they would contain the predicted inputs
+  *pad_status = m_rollback_session->ConsumeInput(pad_nb);
+  return true;
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::ReceiveRollbackInputs()
+{
+  GCPadStatus pad_status;
+  for (int pad = 0; pad < RollbackSession::NUM_PADS; ++pad)
+  {
+    while (m_pad_buffer[pad].Pop(pad_status))
+      m_rollback_session->AddInput(pad, pad_status);
+  }
+}
+
+// called from ---CPU--- thread
+bool NetPlayClient::GetBroadcastPad(const int pad_nb, GCPadStatus* pad_status)
+{
+  // The keyframe replaces the state this poll is read into, no input is used up for it
+  if (m_broadcast_keyframe_pending)
+  {
+    *pad_status = GCPadStatus{};
+    return true;
+  }
+
+  // Inputs pile up after joining during a game, or after the relay stalled
+  const u32 buffered = m_pad_buffer[pad_nb].Size();
+  const bool catching_up = buffered > (m_broadcast_catching_up ? BROADCAST_CAUGHT_UP_INPUTS :
+                                                                 BROADCAST_CATCH_UP_INPUTS);
+  if (catching_up != m_broadcast_catching_up)
+  {
+    m_broadcast_catching_up = catching_up;
+    Config::SetCurrent(Config::MAIN_EMULATION_SPEED, catching_up ? 0.0f : 1.0f);
+  }
+
+  while (m_pad_buffer[pad_nb].Size() == 0)
+  {
+    if (!m_is_running.IsSet())
+      return false;
+
+    m_gc_pad_event.Wait();
+  }
+
+  m_pad_buffer[pad_nb].Pop(*pad_status);
+  return true;
+}
+
+bool NetPlayClient::IsPollEndEventNeeded() const
+{
+  return m_rollback_session != nullptr || m_broadcast_keyframe_requested ||
+         m_broadcast_keyframe_pending;
+}
+
+bool NetPlayClient::IsResimulating() const
+{
+  return m_rollback_session && m_rollback_session->IsResimulating();
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::OnPollEnd()
+{
+  if (m_rollback_session)
+  {
+    ReceiveRollbackInputs();
+    m_rollback_session->EndFrame();
+
+    // Re-simulated frames have already been seen and heard. CoreTiming does not throttle them
+    // either, their cycles are behind the ones it already waited for.
+    const bool resimulating = m_rollback_session->IsResimulating();
+    auto& system = Core::System::GetInstance();
+    system.GetVideoInterface().SetOutputSuppressed(resimulating);
+    if (SoundStream* sound_stream = system.GetSoundStream())
+      sound_stream->GetMixer()->SetSamplesDiscarded(resimulating);
+  }
+
+  if (m_broadcast_keyframe_requested)
+    TakeBroadcastKeyframe();
+  if (m_broadcast_keyframe_pending)
+    LoadBroadcastKeyframe();
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::TakeBroadcastKeyframe()
+{
+  const auto now = std::chrono::steady_clock::now();
+  if (now - m_last_broadcast_keyframe <
+      std::chrono::seconds(Config::Get(Config::NETPLAY_BROADCAST_KEYFRAME_INTERVAL)))
+  {
+    return;
+  }
+
+  // Spectators can only start from inputs that are final
+  std::array<u64, 4> consumed = m_consumed_pad_inputs;
+  if (m_rollback_session)
+  {
+    if (m_rollback_session->IsResimulating() || !m_rollback_session->IsFrameFinal())
+      return;
+    for (int pad = 0; pad < RollbackSession::NUM_PADS; ++pad)
+      consumed[pad] = m_rollback_session->GetConsumedCount(pad);
+  }
+
+  m_broadcast_keyframe_requested = false;
+  m_last_broadcast_keyframe = now;
+
+  std::vector<u8> state;
+  State::SaveToBufferOnCPUThread(state);
+
+  // Compressing takes longer than a frame
+  if (m_broadcast_keyframe_thread.joinable())
+    m_broadcast_keyframe_thread.join();
+  m_broadcast_keyframe_thread = std::thread([this, consumed, state = std::move(state)] {
+    Common::SetCurrentThreadName("NetPlay Keyframe");
+
+    sf::Packet packet;
+    packet << MessageID::BroadcastKeyframe;
+    for (const u64 inputs : consumed)
+      packet << sf::Uint64{inputs};
+    if (!CompressBufferIntoPacket(state, packet))
+      return;
+
+    INFO_LOG_FMT(NETPLAY, "Sending a keyframe of {} bytes for the broadcast",
+                 packet.getDataSize());
+    SendAsync(std::move(packet));
+  });
+}
+
+// called from ---CPU--- thread
+void NetPlayClient::LoadBroadcastKeyframe()
+{
+  std::vector<u8> state;
+  {
+    std::lock_guard lk(m_broadcast_keyframe_mutex);
+    state = std::move(m_broadcast_keyframe);
+    m_broadcast_keyframe.clear();
+    m_broadcast_keyframe_pending = false;
+  }
+
+  if (!state.empty())
+    State::LoadFromBufferOnCPUThread(state);
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayClient::OnBroadcastInputs(sf::Packet& packet)
+{
+  std::vector<u8> batch;
+  while (!packet.endOfPacket())
+  {
+    u8 byte;
+    packet >> byte;
+    batch.push_back(byte);
+  }
+
+  const std::optional<std::vector<BroadcastInput>> inputs = DecodeBroadcastBatch(batch);
+  if (!inputs)
+  {
+    ERROR_LOG_FMT(NETPLAY, "Received a malformed batch of inputs");
+    return;
+  }
+
+  for (const BroadcastInput& input : *inputs)
+  {
+    u64& next = m_broadcast_next_input[input.pad];
+    // Used before the keyframe was taken
+    if (input.index < next)
+      continue;
+    if (input.index != next)
+    {
+      ERROR_LOG_FMT(NETPLAY, "Inputs {} to {} of pad {} are missing from the broadcast", next,
+                    input.index - 1, input.pad);
+    }
+    next = input.index + 1;
+    m_pad_buffer[input.pad].Push(input.status);
+  }
+  m_gc_pad_event.Set();
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayClient::OnBroadcastKeyframe(sf::Packet& packet)
+{
+  std::array<u64, 4> consumed;
+  for (u64& inputs : consumed)
+    inputs = Common::PacketReadU64(packet);
+
+  std::optional<std::vector<u8>> state = DecompressPacketIntoBuffer(packet);
+  if (!state)
+  {
+    ERROR_LOG_FMT(NETPLAY, "Could not decompress the keyframe of the broadcast");
+    return;
+  }
+
+  INFO_LOG_FMT(NETPLAY, "Starting from a keyframe, after inputs {}", fmt::join(consumed, ", "));
+  std::lock_guard lk(m_broadcast_keyframe_mutex);
+  m_broadcast_keyframe = std::move(*state);
+  m_broadcast_next_input = consumed;
+  m_broadcast_keyframe_pending = true;
+}
+
+void NetPlayClient::ResetBroadcast()
+{
+  std::lock_guard lk(m_broadcast_keyframe_mutex);
+  m_broadcast_keyframe.clear();
+  m_broadcast_keyframe_pending = false;
+  m_broadcast_next_input.fill(0);
+}
+
+bool NetPlayClient::IsBroadcastSpectator() const
+{
+  return m_pid == BROADCAST_SPECTATOR_PID;
+}
+
 u64 NetPlayClient::GetInitialRTCValue() const
 {
   return m_initial_rtc;
@@ -2491,6 +3100,17 @@ bool NetPlayClient::PollLocalPad(const int local_pad, sf::Packet& packet)
       m_first_pad_status_received[ingame_pad] = true;
     }
   }
+  else if (m_rollback_session)
+  {
+    // Local inputs go straight to the session, the buffer is the local input delay
+    while (m_rollback_session->GetInputCount(ingame_pad) <=
+           m_rollback_session->GetConsumedCount(ingame_pad) + m_target_buffer_size)
+    {
+      m_rollback_session->AddInput(ingame_pad, pad_status);
+      AddPadStateToPacket(ingame_pad, pad_status, packet);
+      data_added = true;
+    }
+  }
   else
   {
     // adjust the buffer either up or down
@@ -2614,8 +3234,38 @@ bool NetPlayClient::StopGame()
 {
   InvokeStop();
 
+  if (m_rollback_session)
+  {
+    const RollbackSession::Stats stats = m_rollback_session->GetStats();
+    INFO_LOG_FMT(NETPLAY,
+                 "Rollback: {} frames, {} rollbacks, {} frames re-simulated (deepest {}) in "
+                 "{:.1f}ms (longest {:.1f}ms), {} snapshots every {} frames, save {:.0f}us, "
+                 "load {:.0f}us, {} frames over budget",
+                 stats.frames, stats.rollbacks, stats.resimulated_frames,
+                 stats.max_rollback_depth, stats.resimulation_ms, stats.max_resimulation_ms,
+                 stats.snapshots, stats.snapshot_interval, stats.average_save_us,
+                 stats.average_load_us, stats.budget_overruns);
+  }
+
+  if (m_input_link)
+  {
+    const InputLink::Stats stats = m_input_link->GetStats();
+    INFO_LOG_FMT(NETPLAY,
+                 "Redundant inputs: {} packets sent with {} inputs, {} packets received with {} "
+                 "new inputs, {} duplicates, {} out of order, at most {} unacknowledged",
+                 stats.packets_sent, stats.inputs_sent, stats.packets_received,
+                 stats.inputs_received, stats.duplicate_inputs, stats.early_inputs,
+                 stats.max_unacked);
+  }
+
   NetPlay_Disable();
 
+  if (m_broadcast_catching_up)
+  {
+    Config::SetCurrent(Config::MAIN_EMULATION_SPEED, 1.0f);
+    m_broadcast_catching_up = false;
+  }
+
   // stop game
   m_dialog->StopGame();
 
@@ -2868,21 +3518,29 @@ void NetPlayClient::SendGameStatus()
   Send(packet);
 }
 
-void NetPlayClient::SendChecksum(u8 checksumId, u64 frame, u32 checksum)
+// called from ---CPU--- thread
+void NetPlayClient::HashDesyncState(const Core::CPUThreadGuard& guard, u64 frame)
 {
-  netplay_client->ourChecksum[checksumId] = checksum;
-
-  if (frame < 1000) // dont send the initial ones since they're whack
+  std::lock_guard lk(crit_netplay_client);
+  if (!netplay_client || !netplay_client->m_desync_detector)
     return;
 
-  u8 newId = checksumId + 11 & 0xf;  // send checksum from 5 seconds ago
+  DesyncDetector& detector = *netplay_client->m_desync_detector;
+  detector.HashSlice(guard, frame);
 
-  sf::Packet packet;
-  packet << MessageID::Checksum;
-  packet << netplay_client->ourChecksum[newId]; 
-  packet << newId;
+  // Only states that can not be rolled back anymore are compared
+  if (netplay_client->m_rollback_session && !netplay_client->m_rollback_session->IsFrameFinal())
+    return;
 
-  netplay_client->SendAsync(std::move(packet));
+  for (const auto& [hashed_frame, root] : detector.Finalize(frame))
+  {
+    sf::Packet packet;
+    packet << MessageID::DesyncHash;
+    packet << sf::Uint64{hashed_frame};
+    packet << sf::Uint64{root};
+    netplay_client->SendAsync(std::move(packet));
+  }
+  netplay_client->CheckDesyncMismatch();
 }
 
 void NetPlayClient::SendTimeBase()
@@ -3054,6 +3712,31 @@ void SetSIPollBatching(bool state)
   s_si_poll_batching = state;
 }
 
+bool IsPollEndEventNeeded()
+{
+  std::lock_guard lk(crit_netplay_client);
+  return netplay_client && netplay_client->IsPollEndEventNeeded();
+}
+
+void OnPollEnd()
+{
+  std::lock_guard lk(crit_netplay_client);
+  if (netplay_client)
+    netplay_client->OnPollEnd();
+}
+
+bool IsResimulating()
+{
+  std::lock_guard lk(crit_netplay_client);
+  return netplay_client && netplay_client->IsResimulating();
+}
+
+bool IsRollbackEnabled()
+{
+  std::lock_guard lk(crit_netplay_client);
+  return netplay_client && netplay_client->GetNetSettings().rollback_frames != 0;
+}
+
 void SendPowerButtonEvent()
 {
   ASSERT(IsNetPlayRunning());
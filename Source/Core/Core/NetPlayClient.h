@@ -5,6 +5,7 @@
 
 #include <SFML/Network/Packet.hpp>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <memory>
@@ -20,7 +21,11 @@
 #include "Common/Event.h"
 #include "Common/SPSCQueue.h"
 #include "Common/TraversalClient.h"
+#include "Core/NetPlayDesync.h"
+#include "Core/NetPlayInputTransport.h"
 #include "Core/NetPlayProto.h"
+#include "Core/NetPlayRollback.h"
+#include "Core/NetPlaySyncBlocks.h"
 #include "Core/SyncIdentifier.h"
 #include "InputCommon/GCPadStatus.h"
 #include "Core/LocalPlayers.h"
@@ -162,7 +167,6 @@ public:
   void RequestGolfControl();
   std::string GetCurrentGolfer();
   std::vector<std::string> v_ActiveGeckoCodes;
-  std::map<u8, u32> ourChecksum;
 
   // Send and receive pads values
   struct WiimoteDataBatchEntry
@@ -173,6 +177,13 @@ public:
   bool WiimoteUpdate(const std::span<WiimoteDataBatchEntry>& entries);
   bool GetNetPads(int pad_nb, bool from_vi, GCPadStatus* pad_status);
 
+  bool IsPollEndEventNeeded() const;
+  void OnPollEnd();
+  // Whether the frame is being simulated again after a rollback
+  bool IsResimulating() const;
+  // Connected to a relay instead of a server
+  bool IsBroadcastSpectator() const;
+
   u64 GetInitialRTCValue() const;
 
   void OnTraversalStateChanged() override;
@@ -196,7 +207,8 @@ public:
   bool PortHasPlayerAssigned(int port);
 
   static void SendTimeBase();
-  static void SendChecksum(u8 checksumId, u64 frame, u32 checksum);
+  // Called every frame from the CPU thread, see DesyncDetector
+  static void HashDesyncState(const Core::CPUThreadGuard& guard, u64 frame);
   bool DoAllPlayersHaveGame();
 
   static std::string GetNetplayNames(u8 PortInt);
@@ -267,6 +279,35 @@ protected:
   bool m_wait_on_input;
   bool m_wait_on_input_received;
 
+  // Only in the rollback network mode. Created before the game starts and kept until the next
+  // one, so that the CPU thread never sees it change.
+  std::unique_ptr<RollbackSession> m_rollback_session;
+  // The same, for every network mode
+  std::unique_ptr<DesyncDetector> m_desync_detector;
+  // The same, made when the game starts if the host made inputs redundant
+  std::unique_ptr<InputLink> m_input_link;
+  // Levels of the desync search sent so far, several players can ask for the same one. The first
+  // is sent from the CPU thread, the others from the network thread.
+  std::atomic<u32> m_desync_levels_sent = 0;
+  std::atomic<bool> m_desync_blocks_sent = false;
+
+  // Inputs the game read per pad, which is where the inputs of a broadcast continue after a
+  // keyframe taken now
+  std::array<u64, 4> m_consumed_pad_inputs{};
+  // Set by the relay through the server, a keyframe is taken once the last one is old enough
+  std::atomic<bool> m_broadcast_keyframe_requested = false;
+  std::chrono::steady_clock::time_point m_last_broadcast_keyframe;
+  // Compresses and sends the keyframe, the CPU thread only saves it
+  std::thread m_broadcast_keyframe_thread;
+
+  // Of spectators of a broadcast. The keyframe arrives ahead of the start of the game and is
+  // loaded after its first poll, with the inputs before it skipped.
+  std::mutex m_broadcast_keyframe_mutex;
+  std::vector<u8> m_broadcast_keyframe;
+  std::atomic<bool> m_broadcast_keyframe_pending = false;
+  std::array<u64, 4> m_broadcast_next_input{};
+  bool m_broadcast_catching_up = false;
+
   Player* m_local_player = nullptr;
 
   u32 m_current_game = 0;
@@ -295,6 +336,12 @@ private:
   void SyncCodeResponse(bool success);
 
   bool PollLocalPad(int local_pad, sf::Packet& packet);
+  bool GetRollbackPad(int pad_nb, bool batching, GCPadStatus* pad_status);
+  void ReceiveRollbackInputs();
+  bool GetBroadcastPad(int pad_nb, GCPadStatus* pad_status);
+  void TakeBroadcastKeyframe();
+  void LoadBroadcastKeyframe();
+  void ResetBroadcast();
   void SendPadHostPoll(PadIndex pad_num);
 
   bool AddLocalWiimoteToBuffer(int local_wiimote, const WiimoteEmu::SerializedWiimoteState& state,
@@ -302,6 +349,7 @@ private:
 
   void UpdateDevices();
   void AddPadStateToPacket(int in_game_pad, const GCPadStatus& np, sf::Packet& packet);
+  void SendPadData(sf::Packet&& packet);
   void AddWiimoteStateToPacket(int in_game_pad, const WiimoteEmu::SerializedWiimoteState& np,
                                sf::Packet& packet);
   void Send(const sf::Packet& packet, u8 channel_id = DEFAULT_CHANNEL);
@@ -328,6 +376,7 @@ private:
   void OnGBAConfig(sf::Packet& packet);
   void OnPadData(sf::Packet& packet);
   void OnPadHostData(sf::Packet& packet);
+  void OnPadInputs(sf::Packet& packet);
   void OnWiimoteData(sf::Packet& packet);
   void OnPadBuffer(sf::Packet& packet);
   void OnHostInputAuthority(sf::Packet& packet);
@@ -347,6 +396,7 @@ private:
   void OnSyncSaveDataGCI(sf::Packet& packet);
   void OnSyncSaveDataWii(sf::Packet& packet);
   void OnSyncSaveDataGBA(sf::Packet& packet);
+  void OnSyncSaveDataBlocks(sf::Packet& packet);
   void OnSyncCodes(sf::Packet& packet);
   void OnSyncCodesNotify();
   void OnSyncCodesNotifyGecko(sf::Packet& packet);
@@ -362,11 +412,19 @@ private:
   void OnSendCodesMsg(sf::Packet& packet);
   void OnCoinFlipMsg(sf::Packet& packet);
   void OnNightMsg(sf::Packet& packet);
-  void OnChecksumMsg(sf::Packet& packet);
+  void OnDesyncHash(sf::Packet& packet);
+  void OnDesyncNodes(sf::Packet& packet);
+  void OnDesyncBlocks(sf::Packet& packet);
+  void CheckDesyncMismatch();
+  void SendDesyncNodes(u64 frame, u32 level, std::span<const u32> parents);
+  void SendDesyncBlocks(u64 frame, std::span<const u32> leaves);
+  std::string GetDesyncDumpPath(u64 frame) const;
   void OnGameIDMsg(sf::Packet& packet);
   void OnStadiumMsg(sf::Packet& packet);
   void OnCourseMsg(sf::Packet& packet);
   void OnDisableReplaysMsg(sf::Packet& packet);
+  void OnBroadcastInputs(sf::Packet& packet);
+  void OnBroadcastKeyframe(sf::Packet& packet);
 
   int framesAsGolfer = 0;
 
@@ -389,6 +447,7 @@ private:
   Common::Event m_wait_on_input_event;
   u8 m_sync_save_data_count = 0;
   u8 m_sync_save_data_success_count = 0;
+  SyncBlockReader m_sync_blocks;
   u16 m_sync_gecko_codes_count = 0;
   u16 m_sync_gecko_codes_success_count = 0;
   bool m_sync_gecko_codes_complete = false;
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 
+#include <enet/enet.h>
 #include <fmt/format.h>
 #include <lzo/lzo1x.h>
 
@@ -12,6 +13,7 @@
 #include "Common/IOFile.h"
 #include "Common/MsgHandler.h"
 #include "Common/SFMLHelper.h"
+#include "Core/NetPlayProto.h"
 
 namespace NetPlay
 {
@@ -297,4 +299,13 @@ std::optional<std::vector<u8>> DecompressPacketIntoBuffer(sf::Packet& packet)
 
   return out_buffer;
 }
+
+u32 GetChannelFlags(u8 channel_id)
+{
+  // Inputs repeat the ones that were not acknowledged, waiting for a lost packet would only delay
+  // the ones after it
+  if (channel_id == INPUT_CHANNEL)
+    return ENET_PACKET_FLAG_UNSEQUENCED;
+  return ENET_PACKET_FLAG_RELIABLE;
+}
 }  // namespace NetPlay
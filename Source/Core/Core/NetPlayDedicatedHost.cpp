@@ -0,0 +1,699 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/NetPlayDedicatedHost.h"
+
+#include <algorithm>
+#include <map>
+#include <span>
+#include <string_view>
+
+#include <SFML/Network/Packet.hpp>
+#include <enet/enet.h>
+#include <fmt/format.h>
+
+#include "Common/ENet.h"
+#include "Common/Logging/Log.h"
+#include "Common/SFMLHelper.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/Version.h"
+#include "Core/NetPlayCommon.h"
+#include "Core/NetPlayServer.h"
+#include "InputCommon/GCPadStatus.h"
+
+namespace NetPlay
+{
+using Clock = std::chrono::steady_clock;
+
+// How long workers wait for packets before servicing their lobbies anyway, which ENet needs to
+// resend and time out
+constexpr std::chrono::milliseconds WORKER_WAIT{10};
+constexpr std::chrono::seconds PING_INTERVAL{1};
+// Clients take the player with this id for the host, which a dedicated host does not have
+constexpr PlayerId FIRST_PLAYER_ID = 2;
+constexpr std::string_view START_COMMAND = "/start";
+
+class DedicatedSession final
+{
+public:
+  DedicatedSession(u16 port, const DedicatedHost::Settings& settings, u32 number);
+  ~DedicatedSession();
+  DedicatedSession(const DedicatedSession&) = delete;
+  DedicatedSession& operator=(const DedicatedSession&) = delete;
+
+  bool IsValid() const { return m_host != nullptr; }
+  ENetSocket GetSocket() const { return m_host->socket; }
+
+  // Handles what was received and sends what is due, called from the worker of the session
+  void Service(Clock::time_point now);
+
+  // Thread safe
+  NetPlaySession GetInfo() const;
+  void AddStats(DedicatedHost::Stats& stats) const;
+
+private:
+  struct Player
+  {
+    PlayerId pid = 0;
+    ENetPeer* peer = nullptr;
+    std::string name;
+    std::string riokey;
+    std::string revision;
+    SyncIdentifierComparison game_status = SyncIdentifierComparison::Unknown;
+    bool has_ipl_dump = false;
+    bool has_hardware_fma = false;
+    u32 ping = 0;
+    u32 current_game = 0;
+  };
+
+  void OnReceive(ENetPeer* peer, std::span<const u8> data);
+  ConnectionError OnConnect(ENetPeer* peer, sf::Packet& packet);
+  // False if the message is malformed or the player sent something they may not
+  bool OnData(Player& player, sf::Packet& packet, std::span<const u8> data);
+  bool OnPadData(Player& player, sf::Packet& packet, std::span<const u8> data);
+  void OnDisconnect(ENetPeer* peer);
+  void StartGame();
+  void StopGame(MessageID mid);
+
+  void Send(const Player& player, const sf::Packet& packet);
+  void SendToPlayers(const sf::Packet& packet, PlayerId skip_pid = 0);
+  // Sends the bytes of a message as they were received
+  void RelayToPlayers(std::span<const u8> data, PlayerId skip_pid);
+  void SendPadMapping();
+
+  u16 m_port;
+  const std::string m_name;
+  const DedicatedHost::Settings& m_settings;
+  Common::ENet::ENetHostPtr m_host;
+
+  std::map<PlayerId, Player> m_players;
+  std::map<ENetPeer*, PlayerId> m_peers;
+  PadMappingArray m_pad_map{};
+  bool m_is_running = false;
+  u32 m_current_game = 0;
+  u32 m_ping_key = 0;
+  Clock::time_point m_ping_time;
+
+  std::atomic<u32> m_player_count = 0;
+  std::atomic<bool> m_in_game = false;
+  std::atomic<u64> m_games_started = 0;
+  std::atomic<u64> m_inputs_relayed = 0;
+  std::atomic<u64> m_bytes_received = 0;
+  std::atomic<u64> m_bytes_sent = 0;
+};
+
+DedicatedSession::DedicatedSession(u16 port, const DedicatedHost::Settings& settings, u32 number)
+    : m_port(port), m_name(fmt::format("{} {}", settings.name, number)), m_settings(settings)
+{
+  ENetAddress address;
+  address.host = ENET_HOST_ANY;
+  address.port = port;
+  // Room for players that are turned away
+  m_host.reset(enet_host_create(&address, settings.max_players + 4, CHANNEL_COUNT, 0, 0));
+  if (!m_host)
+    return;
+  m_host->mtu = std::min(m_host->mtu, MAX_ENET_MTU);
+  m_port = m_host->address.port;
+}
+
+DedicatedSession::~DedicatedSession()
+{
+  if (!m_host)
+    return;
+
+  for (const auto& [peer, pid] : m_peers)
+    enet_peer_disconnect(peer, 0);
+  enet_host_flush(m_host.get());
+}
+
+void DedicatedSession::Service(Clock::time_point now)
+{
+  ENetEvent event;
+  while (enet_host_service(m_host.get(), &event, 0) > 0)
+  {
+    switch (event.type)
+    {
+    case ENET_EVENT_TYPE_CONNECT:
+      // Players are added once they sent who they are
+      enet_peer_timeout(event.peer, 0, PEER_TIMEOUT.count(), PEER_TIMEOUT.count());
+      break;
+    case ENET_EVENT_TYPE_RECEIVE:
+      m_bytes_received += event.packet->dataLength;
+      OnReceive(event.peer, std::span(event.packet->data, event.packet->dataLength));
+      enet_packet_destroy(event.packet);
+      break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+      OnDisconnect(event.peer);
+      break;
+    default:
+      break;
+    }
+  }
+
+  if (now - m_ping_time >= PING_INTERVAL && !m_players.empty())
+  {
+    // only used as an identifier, not time value, so truncation is fine
+    m_ping_key = static_cast<u32>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count());
+    m_ping_time = now;
+    sf::Packet packet;
+    packet << MessageID::Ping << m_ping_key;
+    SendToPlayers(packet);
+  }
+
+  // Inputs go out as soon as they are relayed rather than on the next service
+  enet_host_flush(m_host.get());
+}
+
+NetPlaySession DedicatedSession::GetInfo() const
+{
+  NetPlaySession session;
+  session.name = m_name;
+  session.region = m_settings.region;
+  session.method = "direct";
+  session.server_id = m_settings.address;
+  session.game_id = m_settings.game.name;
+  session.version = Common::GetScmDescStr();
+  session.player_count = static_cast<int>(m_player_count.load());
+  session.port = m_port;
+  session.in_game = m_in_game;
+  return session;
+}
+
+void DedicatedSession::AddStats(DedicatedHost::Stats& stats) const
+{
+  ++stats.sessions;
+  stats.players += m_player_count;
+  stats.games_running += m_in_game ? 1 : 0;
+  stats.games_started += m_games_started;
+  stats.inputs_relayed += m_inputs_relayed;
+  stats.bytes_received += m_bytes_received;
+  stats.bytes_sent += m_bytes_sent;
+}
+
+void DedicatedSession::OnReceive(ENetPeer* peer, std::span<const u8> data)
+{
+  sf::Packet packet;
+  packet.append(data.data(), data.size());
+
+  const auto it = m_peers.find(peer);
+  if (it == m_peers.end())
+  {
+    const ConnectionError error = OnConnect(peer, packet);
+    if (error != ConnectionError::NoError)
+    {
+      INFO_LOG_FMT(NETPLAY, "{}: error {} initializing peer {:x}:{}", m_name, u8(error),
+                   peer->address.host, peer->address.port);
+      sf::Packet response;
+      response << error;
+      Common::ENet::SendPacket(peer, response, DEFAULT_CHANNEL);
+      enet_peer_disconnect_later(peer, 0);
+    }
+    return;
+  }
+
+  Player& player = m_players.at(it->second);
+  if (!OnData(player, packet, data))
+  {
+    INFO_LOG_FMT(NETPLAY, "{}: invalid packet from player {}, disconnecting.", m_name, player.pid);
+    enet_peer_disconnect(peer, 0);
+    OnDisconnect(peer);
+  }
+}
+
+ConnectionError DedicatedSession::OnConnect(ENetPeer* peer, sf::Packet& packet)
+{
+  std::string netplay_version;
+  packet >> netplay_version;
+  if (netplay_version != Common::GetScmRevGitStr())
+    return ConnectionError::VersionMismatch;
+
+  if (m_is_running)
+    return ConnectionError::GameRunning;
+
+  if (m_players.size() >= m_settings.max_players)
+    return ConnectionError::ServerFull;
+
+  Player new_player;
+  new_player.peer = peer;
+  packet >> new_player.revision;
+  packet >> new_player.name;
+  packet >> new_player.riokey;
+  if (StringUTF8CodePointCount(new_player.name) > MAX_NAME_LENGTH)
+    return ConnectionError::NameTooLong;
+
+  new_player.pid = FIRST_PLAYER_ID;
+  while (m_players.contains(new_player.pid))
+    ++new_player.pid;
+
+  const auto free_pad = std::find(m_pad_map.begin(), m_pad_map.end(), PlayerId{0});
+  if (free_pad != m_pad_map.end())
+    *free_pad = new_player.pid;
+
+  sf::Packet join;
+  join << MessageID::PlayerJoin << new_player.pid << new_player.name << new_player.riokey
+       << new_player.revision;
+  SendToPlayers(join);
+
+  // The first message tells the new player that they are connected
+  sf::Packet response;
+  response << MessageID::ConnectionSuccessful << new_player.pid;
+  Send(new_player, response);
+
+  response.clear();
+  response << MessageID::ChangeGame;
+  WriteSyncIdentifier(response, m_settings.game.sync_identifier);
+  response << m_settings.game.name;
+  Send(new_player, response);
+
+  response.clear();
+  response << MessageID::PadBuffer << m_settings.buffer;
+  Send(new_player, response);
+
+  response.clear();
+  response << MessageID::HostInputAuthority << false;
+  Send(new_player, response);
+
+  for (const auto& [pid, player] : m_players)
+  {
+    response.clear();
+    response << MessageID::PlayerJoin << pid << player.name << player.riokey << player.revision;
+    Send(new_player, response);
+
+    response.clear();
+    response << MessageID::GameStatus << pid << player.game_status;
+    Send(new_player, response);
+  }
+
+  response.clear();
+  response << MessageID::GameMode << false << 0;
+  Send(new_player, response);
+
+  response.clear();
+  response << MessageID::NightStadium << false;
+  Send(new_player, response);
+
+  response.clear();
+  response << MessageID::DisableReplays << false;
+  Send(new_player, response);
+
+  INFO_LOG_FMT(NETPLAY, "{}: {} joined as player {}", m_name, new_player.name, new_player.pid);
+  m_peers.emplace(peer, new_player.pid);
+  m_players.emplace(new_player.pid, std::move(new_player));
+  m_player_count = static_cast<u32>(m_players.size());
+
+  SendPadMapping();
+
+  sf::Packet gba_config;
+  gba_config << MessageID::GBAConfig;
+  for (const GBAConfig& config : GBAConfigArray{})
+  {
+    gba_config << config.enabled << config.has_rom << config.title;
+    for (u8 byte : config.hash)
+      gba_config << byte;
+  }
+  SendToPlayers(gba_config);
+
+  sf::Packet wiimote_mapping;
+  wiimote_mapping << MessageID::WiimoteMapping;
+  for (PlayerId mapping : PadMappingArray{})
+    wiimote_mapping << mapping;
+  SendToPlayers(wiimote_mapping);
+
+  // Pinged on the next service
+  m_ping_time = {};
+
+  return ConnectionError::NoError;
+}
+
+bool DedicatedSession::OnData(Player& player, sf::Packet& packet, std::span<const u8> data)
+{
+  MessageID mid;
+  packet >> mid;
+  if (!packet)
+    return false;
+
+  switch (mid)
+  {
+  case MessageID::ChatMessage:
+  {
+    std::string message;
+    packet >> message;
+
+    // The player with the lowest id, usually the one who joined first, starts the games
+    if (message == START_COMMAND && player.pid == m_players.begin()->first)
+    {
+      StartGame();
+      break;
+    }
+
+    sf::Packet chat;
+    chat << MessageID::ChatMessage << player.pid << message;
+    SendToPlayers(chat, player.pid);
+    break;
+  }
+
+  case MessageID::PadSpectator:
+  {
+    bool spectator;
+    packet >> spectator;
+    if (m_is_running)
+      break;
+
+    const auto own_pad = std::find(m_pad_map.begin(), m_pad_map.end(), player.pid);
+    const auto free_pad = std::find(m_pad_map.begin(), m_pad_map.end(), PlayerId{0});
+    if (spectator && own_pad != m_pad_map.end())
+      *own_pad = 0;
+    else if (!spectator && own_pad == m_pad_map.end() && free_pad != m_pad_map.end())
+      *free_pad = player.pid;
+    SendPadMapping();
+    break;
+  }
+
+  // Settings of the game that every player is sent, including the one who changed them
+  case MessageID::SendCodes:
+  case MessageID::CoinFlip:
+  case MessageID::NightStadium:
+  case MessageID::GameID:
+  case MessageID::Stadium:
+  case MessageID::DisableReplays:
+  case MessageID::Course:
+    RelayToPlayers(data, 0);
+    break;
+
+  case MessageID::PowerButton:
+    RelayToPlayers(data, player.pid);
+    break;
+
+  case MessageID::PadData:
+    return OnPadData(player, packet, data);
+
+  case MessageID::Pong:
+  {
+    u32 ping_key = 0;
+    packet >> ping_key;
+    if (ping_key != m_ping_key)
+      break;
+
+    player.ping = static_cast<u32>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - m_ping_time).count());
+    sf::Packet ping;
+    ping << MessageID::PlayerPingData << player.pid << player.ping;
+    SendToPlayers(ping);
+    break;
+  }
+
+  case MessageID::StartGame:
+    packet >> player.current_game;
+    break;
+
+  case MessageID::StopGame:
+    if (m_is_running)
+      StopGame(MessageID::StopGame);
+    break;
+
+  case MessageID::GameStatus:
+  {
+    packet >> player.game_status;
+    sf::Packet status;
+    status << MessageID::GameStatus << player.pid << player.game_status;
+    SendToPlayers(status);
+    break;
+  }
+
+  case MessageID::ClientCapabilities:
+    packet >> player.has_ipl_dump >> player.has_hardware_fma;
+    break;
+
+  case MessageID::DesyncHash:
+  case MessageID::DesyncNodes:
+  case MessageID::DesyncBlocks:
+  {
+    // Compared by the clients, like with a desktop host
+    sf::Packet desync;
+    desync << mid << player.pid;
+    desync.append(data.data() + sizeof(MessageID), data.size() - sizeof(MessageID));
+    SendToPlayers(desync, player.pid);
+    break;
+  }
+
+  default:
+    // The rest is either sent by the host only, like the golf mode and the data syncs, or checked
+    // by it, like the time bases, which nobody does here
+    DEBUG_LOG_FMT(NETPLAY, "{}: ignoring message {:x} from player {}", m_name, u8(mid),
+                  player.pid);
+    break;
+  }
+
+  return true;
+}
+
+bool DedicatedSession::OnPadData(Player& player, sf::Packet& packet, std::span<const u8> data)
+{
+  // From the last game, still being received
+  if (!m_is_running || player.current_game != m_current_game)
+    return true;
+
+  // Checked before relaying the message as it came, GBAs are never enabled here so every pad has
+  // all of its fields
+  u64 inputs = 0;
+  while (!packet.endOfPacket())
+  {
+    PadIndex map;
+    GCPadStatus pad;
+    packet >> map >> pad.button >> pad.analogA >> pad.analogB >> pad.stickX >> pad.stickY >>
+        pad.substickX >> pad.substickY >> pad.triggerLeft >> pad.triggerRight >> pad.isConnected;
+    if (!packet || map < 0 || static_cast<size_t>(map) >= m_pad_map.size() ||
+        m_pad_map[map] != player.pid)
+    {
+      return false;
+    }
+    ++inputs;
+  }
+
+  RelayToPlayers(data, player.pid);
+  m_inputs_relayed += inputs;
+  return true;
+}
+
+void DedicatedSession::OnDisconnect(ENetPeer* peer)
+{
+  const auto it = m_peers.find(peer);
+  if (it == m_peers.end())
+    return;
+
+  const PlayerId pid = it->second;
+  m_peers.erase(it);
+  m_players.erase(pid);
+  m_player_count = static_cast<u32>(m_players.size());
+  INFO_LOG_FMT(NETPLAY, "{}: player {} left", m_name, pid);
+
+  const bool had_pad = std::find(m_pad_map.begin(), m_pad_map.end(), pid) != m_pad_map.end();
+  std::replace(m_pad_map.begin(), m_pad_map.end(), pid, PlayerId{0});
+  if (m_is_running && (had_pad || m_players.empty()))
+    StopGame(MessageID::DisableGame);
+
+  sf::Packet leave;
+  leave << MessageID::PlayerLeave << pid;
+  SendToPlayers(leave);
+  SendPadMapping();
+}
+
+void DedicatedSession::StartGame()
+{
+  if (m_is_running)
+    return;
+
+  const bool everyone_has_game =
+      std::all_of(m_players.begin(), m_players.end(), [](const auto& entry) {
+        return entry.second.game_status == SyncIdentifierComparison::SameGame;
+      });
+  if (!everyone_has_game)
+  {
+    INFO_LOG_FMT(NETPLAY, "{}: not starting, a player does not have the game", m_name);
+    return;
+  }
+
+  const auto all = [this](bool Player::*capability) {
+    return std::all_of(m_players.begin(), m_players.end(),
+                       [&](const auto& entry) { return entry.second.*capability; });
+  };
+
+  NetSettings settings = m_settings.game.settings;
+  settings.skip_ipl = settings.skip_ipl || !all(&Player::has_ipl_dump);
+  settings.load_ipl_dump = settings.load_ipl_dump && all(&Player::has_ipl_dump);
+  settings.use_fma = all(&Player::has_hardware_fma);
+  // There are no saves or codes of a host to sync, and inputs are only relayed
+  settings.savedata_load = false;
+  settings.savedata_write = false;
+  settings.savedata_sync_all_wii = false;
+  settings.sync_codes = false;
+  settings.golf_mode = false;
+  settings.redundant_inputs = false;
+
+  // only used as an identifier, not time value, so truncation is fine
+  m_current_game = static_cast<u32>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        Clock::now().time_since_epoch())
+                                        .count());
+  m_is_running = true;
+  m_in_game = true;
+  ++m_games_started;
+  INFO_LOG_FMT(NETPLAY, "{}: starting game {}", m_name, m_current_game);
+
+  sf::Packet buffer;
+  buffer << MessageID::PadBuffer << m_settings.buffer;
+  SendToPlayers(buffer);
+  SendToPlayers(MakeStartGamePacket(m_current_game, settings, GetInitialNetPlayRTC(),
+                                    m_settings.game.region));
+}
+
+void DedicatedSession::StopGame(MessageID mid)
+{
+  m_is_running = false;
+  m_in_game = false;
+  INFO_LOG_FMT(NETPLAY, "{}: game {} stopped", m_name, m_current_game);
+
+  sf::Packet packet;
+  packet << mid;
+  SendToPlayers(packet);
+}
+
+void DedicatedSession::Send(const Player& player, const sf::Packet& packet)
+{
+  if (Common::ENet::SendPacket(player.peer, packet, DEFAULT_CHANNEL))
+    m_bytes_sent += packet.getDataSize();
+}
+
+void DedicatedSession::SendToPlayers(const sf::Packet& packet, PlayerId skip_pid)
+{
+  RelayToPlayers(std::span(static_cast<const u8*>(packet.getData()), packet.getDataSize()),
+                 skip_pid);
+}
+
+void DedicatedSession::RelayToPlayers(std::span<const u8> data, PlayerId skip_pid)
+{
+  // A single packet for every player, ENet frees it once it was sent to the last of them
+  ENetPacket* packet = enet_packet_create(data.data(), data.size(), ENET_PACKET_FLAG_RELIABLE);
+  if (!packet)
+    return;
+
+  for (const auto& [pid, player] : m_players)
+  {
+    if (pid != skip_pid && enet_peer_send(player.peer, DEFAULT_CHANNEL, packet) == 0)
+      m_bytes_sent += data.size();
+  }
+  if (packet->referenceCount == 0)
+    enet_packet_destroy(packet);
+}
+
+void DedicatedSession::SendPadMapping()
+{
+  sf::Packet packet;
+  packet << MessageID::PadMapping;
+  for (PlayerId mapping : m_pad_map)
+    packet << mapping;
+  SendToPlayers(packet);
+}
+
+DedicatedHost::DedicatedHost(Settings settings) : m_settings(std::move(settings))
+{
+  if (m_settings.sessions > MAX_SESSIONS)
+  {
+    ERROR_LOG_FMT(NETPLAY, "A dedicated host runs at most {} lobbies", MAX_SESSIONS);
+    return;
+  }
+  if (enet_initialize() != 0)
+    return;
+
+  m_valid = true;
+  for (u32 i = 0; i < m_settings.sessions; ++i)
+  {
+    const u16 port = m_settings.first_port != 0 ? static_cast<u16>(m_settings.first_port + i) : 0;
+    auto session = std::make_unique<DedicatedSession>(port, m_settings, i + 1);
+#ifndef _WIN32
+    // Past this, the descriptor does not fit in the socket set of its worker
+    if (session->IsValid() && session->GetSocket() >= FD_SETSIZE)
+    {
+      ERROR_LOG_FMT(NETPLAY, "Out of socket descriptors for a dedicated session");
+      m_valid = false;
+      m_sessions.clear();
+      return;
+    }
+#endif
+    if (!session->IsValid())
+    {
+      ERROR_LOG_FMT(NETPLAY, "Could not bind port {} for a dedicated session",
+                    m_settings.first_port + i);
+      m_valid = false;
+      m_sessions.clear();
+      return;
+    }
+    m_sessions.push_back(std::move(session));
+  }
+
+  u32 threads = m_settings.threads != 0 ? m_settings.threads : std::thread::hardware_concurrency();
+  const u32 min_threads =
+      (m_settings.sessions + MAX_SESSIONS_PER_WORKER - 1) / MAX_SESSIONS_PER_WORKER;
+  threads = std::clamp<u32>(threads, std::max<u32>(min_threads, 1),
+                            std::max<u32>(m_settings.sessions, 1));
+  for (u32 i = 0; i < threads; ++i)
+    m_workers.push_back(std::make_unique<Worker>());
+  for (size_t i = 0; i < m_sessions.size(); ++i)
+    m_workers[i % threads]->sessions.push_back(m_sessions[i].get());
+  for (auto& worker : m_workers)
+    worker->thread = std::thread(&DedicatedHost::WorkerFunc, this, std::ref(*worker));
+}
+
+DedicatedHost::~DedicatedHost()
+{
+  m_stop = true;
+  for (auto& worker : m_workers)
+  {
+    if (worker->thread.joinable())
+      worker->thread.join();
+  }
+}
+
+void DedicatedHost::WorkerFunc(Worker& worker)
+{
+  Common::SetCurrentThreadName("Dedicated host worker");
+
+  while (!m_stop)
+  {
+    ENetSocketSet sockets;
+    ENET_SOCKETSET_EMPTY(sockets);
+    ENetSocket max_socket = 0;
+    for (const DedicatedSession* session : worker.sessions)
+    {
+      ENET_SOCKETSET_ADD(sockets, session->GetSocket());
+      max_socket = std::max(max_socket, session->GetSocket());
+    }
+    enet_socketset_select(max_socket, &sockets, nullptr, static_cast<u32>(WORKER_WAIT.count()));
+
+    const auto start = Clock::now();
+    for (DedicatedSession* session : worker.sessions)
+      session->Service(start);
+    worker.busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start)
+                          .count();
+  }
+}
+
+std::vector<NetPlaySession> DedicatedHost::GetSessions() const
+{
+  std::vector<NetPlaySession> sessions;
+  for (const auto& session : m_sessions)
+    sessions.push_back(session->GetInfo());
+  return sessions;
+}
+
+DedicatedHost::Stats DedicatedHost::GetStats() const
+{
+  Stats stats;
+  for (const auto& session : m_sessions)
+    session->AddStats(stats);
+  for (const auto& worker : m_workers)
+    stats.busy += std::chrono::nanoseconds(worker->busy_ns.load());
+  return stats;
+}
+}  // namespace NetPlay
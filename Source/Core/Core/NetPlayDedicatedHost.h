@@ -0,0 +1,107 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayProto.h"
+#include "Core/SyncIdentifier.h"
+#include "UICommon/NetPlayIndex.h"
+
+namespace NetPlay
+{
+class DedicatedSession;
+
+// What games of a dedicated host are started with, which a desktop host takes from its game list
+// and its config when a game is started
+struct DedicatedGame
+{
+  SyncIdentifier sync_identifier;
+  std::string name;
+  // Directory of the region for save data
+  std::string region;
+  NetSettings settings;
+};
+
+// Runs lobbies of players without a desktop host and without emulating anything. Every lobby has
+// a port of its own, since players pick a lobby by its address, and the lobbies are spread over a
+// worker thread per core, which waits on the sockets of all of its lobbies at once.
+//
+// The first player of a lobby starts a game by writing /start in the chat once every player has
+// the game. Save data and codes are not synced, and inputs are relayed as players send them.
+class DedicatedHost final
+{
+public:
+  // A worker waits with select(), whose socket sets hold 64 sockets on Windows and only descriptors
+  // below 1024 elsewhere, so a worker gets a few lobbies less than the former and a host well
+  // under the latter
+  static constexpr u32 MAX_SESSIONS_PER_WORKER = 60;
+  static constexpr u32 MAX_SESSIONS = 512;
+
+  struct Settings
+  {
+    // Zero gives every lobby a free port, which GetSessions lists
+    u16 first_port = 2626;
+    // At most MAX_SESSIONS
+    u32 sessions = 1;
+    // One per core if zero, and never fewer than MAX_SESSIONS_PER_WORKER allows
+    u32 threads = 0;
+    u32 max_players = 8;
+    u32 buffer = 8;
+    // Lobbies are named after it and numbered
+    std::string name = "Dedicated";
+    // Where players connect to, as listed in the index
+    std::string address = "127.0.0.1";
+    std::string region = "NA";
+    DedicatedGame game;
+  };
+
+  struct Stats
+  {
+    size_t sessions = 0;
+    size_t players = 0;
+    size_t games_running = 0;
+    u64 games_started = 0;
+    u64 inputs_relayed = 0;
+    u64 bytes_received = 0;
+    u64 bytes_sent = 0;
+    // Time the workers spent on events rather than waiting for them, about their CPU time
+    std::chrono::nanoseconds busy{};
+  };
+
+  explicit DedicatedHost(Settings settings);
+  ~DedicatedHost();
+  DedicatedHost(const DedicatedHost&) = delete;
+  DedicatedHost& operator=(const DedicatedHost&) = delete;
+
+  // False if there are too many lobbies or a port could not be bound
+  bool IsValid() const { return m_valid; }
+
+  // The lobbies, as the index lists them
+  std::vector<NetPlaySession> GetSessions() const;
+  Stats GetStats() const;
+
+private:
+  struct Worker
+  {
+    std::vector<DedicatedSession*> sessions;
+    std::thread thread;
+    std::atomic<u64> busy_ns = 0;
+  };
+
+  void WorkerFunc(Worker& worker);
+
+  const Settings m_settings;
+  std::vector<std::unique_ptr<DedicatedSession>> m_sessions;
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::atomic<bool> m_stop = false;
+  bool m_valid = false;
+};
+}  // namespace NetPlay
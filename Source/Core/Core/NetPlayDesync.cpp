@@ -0,0 +1,383 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/NetPlayDesync.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <xxhash.h>
+
+#include "Common/Assert.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/System.h"
+
+namespace NetPlay
+{
+namespace
+{
+constexpr u32 MEM1_START = 0x80000000;
+constexpr u32 MEM1_END = 0x81800000;
+
+// ps0 and ps1 of each FPR, then pc, the GPRs, CR, MSR, FPSCR, XER and the segment registers
+constexpr size_t REGISTERS_SIZE = 64 * sizeof(u64) + 53 * sizeof(u32);
+
+// A slice is hashed every frame, on top of everything else the frame does
+constexpr double HASH_WARNING_US = 200.0;
+
+template <typename T>
+u8* Append(u8* out, const T& value)
+{
+  std::memcpy(out, &value, sizeof(T));
+  return out + sizeof(T);
+}
+
+void ReadRegisters(const PowerPC::PowerPCState& ppc_state, u8* out)
+{
+  for (const PowerPC::PairedSingle& ps : ppc_state.ps)
+  {
+    out = Append(out, ps.PS0AsU64());
+    out = Append(out, ps.PS1AsU64());
+  }
+  out = Append(out, ppc_state.pc);
+  for (const u32 gpr : ppc_state.gpr)
+    out = Append(out, gpr);
+  out = Append(out, ppc_state.cr.Get());
+  out = Append(out, ppc_state.msr.Hex);
+  out = Append(out, ppc_state.fpscr.Hex);
+  out = Append(out, ppc_state.GetXER().Hex);
+  for (const u32 sr : ppc_state.sr)
+    out = Append(out, sr);
+}
+}  // namespace
+
+std::vector<DesyncRegion> ParseDesyncRegions(std::string_view text)
+{
+  std::vector<DesyncRegion> regions;
+  for (const std::string& range : SplitString(std::string(text), ','))
+  {
+    const std::string trimmed(StripWhitespace(range));
+    if (trimmed.empty())
+      continue;
+
+    const std::vector<std::string> bounds = SplitString(trimmed, '-');
+    u32 start = 0;
+    u32 end = 0;
+    if (bounds.size() != 2 || !TryParse(bounds[0], &start, 16) ||
+        !TryParse(bounds[1], &end, 16) || start >= end || start < MEM1_START || end > MEM1_END)
+    {
+      WARN_LOG_FMT(NETPLAY, "Skipping invalid desync region \"{}\"", trimmed);
+      continue;
+    }
+    regions.push_back({start, end - start});
+  }
+  return regions;
+}
+
+DesyncDetector::DesyncDetector(std::vector<DesyncRegion> regions) : m_regions(std::move(regions))
+{
+  for (const DesyncRegion& region : m_regions)
+  {
+    for (u32 offset = 0; offset < region.size; offset += BLOCK_SIZE)
+    {
+      const u32 size = std::min(BLOCK_SIZE, region.size - offset);
+      m_blocks.push_back({region.address + offset, size, false});
+      m_block_offsets.push_back(m_state_size + offset);
+    }
+    m_state_size += region.size;
+  }
+  m_blocks.push_back({0, static_cast<u32>(REGISTERS_SIZE), true});
+  m_block_offsets.push_back(m_state_size);
+  m_state_size += REGISTERS_SIZE;
+  m_block_offsets.push_back(m_state_size);
+
+  u32 size = static_cast<u32>(m_blocks.size());
+  m_level_sizes.push_back(size);
+  while (size > 1)
+  {
+    size = (size + FAN_OUT - 1) / FAN_OUT;
+    m_level_sizes.push_back(size);
+  }
+  std::reverse(m_level_sizes.begin(), m_level_sizes.end());
+}
+
+void DesyncDetector::HashSlice(const Core::CPUThreadGuard& guard, u64 frame)
+{
+  const auto start = std::chrono::steady_clock::now();
+  auto& system = guard.GetSystem();
+  auto& memory = system.GetMemory();
+
+  std::lock_guard lk(m_mutex);
+  Entry* entry = GetEntryForSlice(frame);
+  if (!entry)
+    return;
+
+  const auto [first, last] = GetSliceBlocks(frame);
+  for (u32 i = first; i < last; ++i)
+  {
+    const Block& block = m_blocks[i];
+    u8* out = entry->state.data() + m_block_offsets[i];
+    if (block.registers)
+    {
+      ReadRegisters(system.GetPPCState(), out);
+      continue;
+    }
+    const u8* pointer = memory.GetPointerForRange(block.address, block.size);
+    if (pointer)
+      std::memcpy(out, pointer, block.size);
+    else
+      std::memset(out, 0, block.size);
+  }
+  FinishSlice(*entry, frame);
+
+  const double us =
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  if (us > HASH_WARNING_US && m_stats.max_hash_us <= HASH_WARNING_US)
+  {
+    WARN_LOG_FMT(NETPLAY, "Hashing a slice of {} bytes for desync detection took {:.0f}us",
+                 m_state_size / STATE_FRAMES, us);
+  }
+  ++m_stats.hashes;
+  m_stats.last_hash_us = us;
+  m_stats.max_hash_us = std::max(m_stats.max_hash_us, us);
+}
+
+void DesyncDetector::AddState(u64 frame, std::span<const u8> state)
+{
+  ASSERT(state.size() == m_state_size);
+  std::lock_guard lk(m_mutex);
+  Entry& entry = GetEntryForWriting(frame);
+  std::memcpy(entry.state.data(), state.data(), m_state_size);
+  HashLeaves(entry, 0, static_cast<u32>(m_blocks.size()));
+  entry.slices = STATE_FRAMES;
+  HashTree(entry);
+}
+
+void DesyncDetector::AddSlice(u64 frame, std::span<const u8> state)
+{
+  ASSERT(state.size() == m_state_size);
+  std::lock_guard lk(m_mutex);
+  Entry* entry = GetEntryForSlice(frame);
+  if (!entry)
+    return;
+
+  const auto [first, last] = GetSliceBlocks(frame);
+  std::memcpy(entry->state.data() + m_block_offsets[first], state.data() + m_block_offsets[first],
+              m_block_offsets[last] - m_block_offsets[first]);
+  FinishSlice(*entry, frame);
+}
+
+DesyncDetector::Entry* DesyncDetector::GetEntryForSlice(u64 frame)
+{
+  const u64 state_frame = frame - frame % STATE_FRAMES;
+  const u32 slice = static_cast<u32>(frame % STATE_FRAMES);
+  if (slice == 0)
+    return &GetEntryForWriting(state_frame);
+
+  // Nothing to add to when netplay started in the middle of the state. A rollback goes back to a
+  // slice that was read before.
+  const auto it = std::find_if(m_history.begin(), m_history.end(), [state_frame](const Entry& e) {
+    return e.frame == state_frame && !e.final;
+  });
+  return it != m_history.end() && it->slices >= slice ? &*it : nullptr;
+}
+
+std::pair<u32, u32> DesyncDetector::GetSliceBlocks(u64 frame) const
+{
+  // The registers are the last block, so they are read on the last frame
+  const u64 slice = frame % STATE_FRAMES;
+  const u64 num_blocks = m_blocks.size();
+  return {static_cast<u32>(num_blocks * slice / STATE_FRAMES),
+          static_cast<u32>(num_blocks * (slice + 1) / STATE_FRAMES)};
+}
+
+void DesyncDetector::FinishSlice(Entry& entry, u64 frame)
+{
+  const auto [first, last] = GetSliceBlocks(frame);
+  HashLeaves(entry, first, last);
+  entry.slices = static_cast<u32>(frame % STATE_FRAMES) + 1;
+  if (entry.slices == STATE_FRAMES)
+    HashTree(entry);
+}
+
+void DesyncDetector::HashLeaves(Entry& entry, u32 first, u32 last) const
+{
+  std::vector<u64>& leaves = entry.levels.back();
+  for (u32 i = first; i < last; ++i)
+    leaves[i] = XXH3_64bits(entry.state.data() + m_block_offsets[i], m_blocks[i].size);
+}
+
+void DesyncDetector::HashTree(Entry& entry) const
+{
+  for (size_t level = m_level_sizes.size() - 1; level > 0; --level)
+  {
+    const std::vector<u64>& children = entry.levels[level];
+    std::vector<u64>& parents = entry.levels[level - 1];
+    for (size_t i = 0; i < parents.size(); ++i)
+    {
+      const size_t first = i * FAN_OUT;
+      const size_t count = std::min<size_t>(FAN_OUT, children.size() - first);
+      parents[i] = XXH3_64bits(children.data() + first, count * sizeof(u64));
+    }
+  }
+}
+
+DesyncDetector::Entry& DesyncDetector::GetEntryForWriting(u64 frame)
+{
+  // Frames after this one are from before a rollback, and will be hashed again
+  while (!m_history.empty() && m_history.back().frame >= frame && !m_history.back().final)
+    m_history.pop_back();
+
+  if (m_history.size() >= HISTORY_SIZE)
+  {
+    Entry entry = std::move(m_history.front());
+    m_history.pop_front();
+    m_history.push_back(std::move(entry));
+  }
+  else
+  {
+    m_history.emplace_back();
+  }
+
+  Entry& entry = m_history.back();
+  entry.frame = frame;
+  entry.slices = 0;
+  entry.final = false;
+  entry.state.resize(m_state_size);
+  entry.levels.resize(m_level_sizes.size());
+  for (size_t level = 0; level < m_level_sizes.size(); ++level)
+    entry.levels[level].resize(m_level_sizes[level]);
+  return entry;
+}
+
+const DesyncDetector::Entry* DesyncDetector::FindEntry(u64 frame) const
+{
+  if (m_mismatched_entry && m_mismatched_entry->frame == frame)
+    return &*m_mismatched_entry;
+  const auto it = std::find_if(m_history.begin(), m_history.end(),
+                               [frame](const Entry& entry) { return entry.frame == frame; });
+  return it != m_history.end() ? &*it : nullptr;
+}
+
+std::vector<std::pair<u64, u64>> DesyncDetector::Finalize(u64 frame)
+{
+  std::lock_guard lk(m_mutex);
+  std::vector<std::pair<u64, u64>> roots;
+  for (Entry& entry : m_history)
+  {
+    // A state that is missing slices can't be completed anymore once its frames are final
+    if (entry.frame + STATE_FRAMES - 1 > frame || entry.final || entry.slices != STATE_FRAMES)
+      continue;
+    entry.final = true;
+    roots.emplace_back(entry.frame, entry.levels[0][0]);
+  }
+  CheckRemoteRoots();
+  return roots;
+}
+
+void DesyncDetector::AddRemoteRoot(u8 pid, u64 frame, u64 root)
+{
+  std::lock_guard lk(m_mutex);
+  m_remote_roots[{pid, frame}] = root;
+  CheckRemoteRoots();
+}
+
+void DesyncDetector::CheckRemoteRoots()
+{
+  const u64 oldest = m_history.empty() ? 0 : m_history.front().frame;
+  for (auto it = m_remote_roots.begin(); it != m_remote_roots.end();)
+  {
+    const auto& [pid, frame] = it->first;
+    const Entry* entry = FindEntry(frame);
+    if (!entry || !entry->final)
+    {
+      // Not hashed or not final here yet, unless it is too old to be compared at all
+      if (!entry && frame < oldest)
+        it = m_remote_roots.erase(it);
+      else
+        ++it;
+      continue;
+    }
+
+    if (entry->levels[0][0] != it->second && !m_mismatch)
+    {
+      m_mismatch = Mismatch{pid, frame};
+      m_mismatched_entry = *entry;
+    }
+    it = m_remote_roots.erase(it);
+  }
+}
+
+std::optional<DesyncDetector::Mismatch> DesyncDetector::TakeMismatch()
+{
+  std::lock_guard lk(m_mutex);
+  if (!m_mismatch || m_mismatch_taken)
+    return std::nullopt;
+  m_mismatch_taken = true;
+  return m_mismatch;
+}
+
+std::vector<DesyncDetector::Node> DesyncDetector::GetChildren(u64 frame, u32 level,
+                                                              std::span<const u32> parents) const
+{
+  std::lock_guard lk(m_mutex);
+  std::vector<Node> nodes;
+  const Entry* entry = FindEntry(frame);
+  if (!entry || level == 0 || level >= entry->levels.size())
+    return nodes;
+
+  const std::vector<u64>& hashes = entry->levels[level];
+  for (const u32 parent : parents)
+  {
+    const size_t first = size_t(parent) * FAN_OUT;
+    for (size_t i = first; i < std::min<size_t>(first + FAN_OUT, hashes.size()); ++i)
+      nodes.push_back({static_cast<u32>(i), hashes[i]});
+  }
+  return nodes;
+}
+
+std::vector<u32> DesyncDetector::Compare(u64 frame, u32 level, std::span<const Node> remote) const
+{
+  std::lock_guard lk(m_mutex);
+  std::vector<u32> differing;
+  const Entry* entry = FindEntry(frame);
+  if (!entry || level >= entry->levels.size())
+    return differing;
+
+  const std::vector<u64>& hashes = entry->levels[level];
+  for (const Node& node : remote)
+  {
+    if (node.index < hashes.size() && hashes[node.index] != node.hash)
+      differing.push_back(node.index);
+  }
+  return differing;
+}
+
+std::vector<u8> DesyncDetector::GetBlockData(u64 frame, u32 leaf) const
+{
+  std::lock_guard lk(m_mutex);
+  const Entry* entry = FindEntry(frame);
+  if (!entry || leaf >= m_blocks.size())
+    return {};
+  const u8* data = entry->state.data() + m_block_offsets[leaf];
+  return std::vector<u8>(data, data + m_blocks[leaf].size);
+}
+
+std::vector<u8> DesyncDetector::GetStateData(u64 frame) const
+{
+  std::lock_guard lk(m_mutex);
+  const Entry* entry = FindEntry(frame);
+  return entry ? entry->state : std::vector<u8>();
+}
+
+DesyncDetector::Stats DesyncDetector::GetStats() const
+{
+  std::lock_guard lk(m_mutex);
+  return m_stats;
+}
+}  // namespace NetPlay
@@ -0,0 +1,166 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace Core
+{
+class CPUThreadGuard;
+}
+
+namespace NetPlay
+{
+struct DesyncRegion
+{
+  u32 address;
+  u32 size;
+};
+
+// Parses ranges like "802E0000-80400000,80870000-808A0000". Ranges outside of MEM1 are skipped.
+std::vector<DesyncRegion> ParseDesyncRegions(std::string_view text);
+
+// Finds where the game state of two players went apart. Every STATE_FRAMES frames the players
+// start hashing the same regions of memory and the PowerPC registers into a tree, whose leaves are
+// blocks of memory and whose inner nodes hash FAN_OUT children each, and exchange the roots. Once
+// two roots differ, the players exchange the children of the nodes that differ, one level at a
+// time, until they are left with the blocks that differ.
+//
+// A state is read a slice of blocks per frame over STATE_FRAMES frames, so that no frame takes
+// much longer than the others. Every player reads the same slice on the same frame.
+//
+// Thread safe, states are added on the CPU thread and remote hashes arrive on the network thread.
+class DesyncDetector final
+{
+public:
+  static constexpr u32 BLOCK_SIZE = 0x1000;
+  static constexpr u32 FAN_OUT = 16;
+  // Frames a state is read over, a state starts on each multiple of this
+  static constexpr u32 STATE_FRAMES = 60;
+  // How many hashed states are kept for comparing against remote ones
+  static constexpr size_t HISTORY_SIZE = 16;
+
+  struct Node
+  {
+    u32 index;
+    u64 hash;
+  };
+
+  // A leaf of the tree, the registers are the last one
+  struct Block
+  {
+    u32 address;
+    u32 size;
+    bool registers;
+  };
+
+  struct Mismatch
+  {
+    u8 pid;
+    u64 frame;
+  };
+
+  // Of the slices read by HashSlice
+  struct Stats
+  {
+    u64 hashes = 0;
+    double last_hash_us = 0.0;
+    double max_hash_us = 0.0;
+  };
+
+  explicit DesyncDetector(std::vector<DesyncRegion> regions);
+
+  const std::vector<DesyncRegion>& GetRegions() const { return m_regions; }
+  // Bytes of a state: the regions one after another, followed by the registers
+  size_t GetStateSize() const { return m_state_size; }
+  // Levels below the root, the leaves are at this level
+  u32 GetDepth() const { return static_cast<u32>(m_level_sizes.size() - 1); }
+  // Nodes of a level, zero below the leaves
+  u32 GetLevelSize(u32 level) const
+  {
+    return level < m_level_sizes.size() ? m_level_sizes[level] : 0;
+  }
+  const Block& GetBlock(u32 leaf) const { return m_blocks[leaf]; }
+
+  // Called every frame. Reads and hashes the frame's slice of the state that started on the last
+  // multiple of STATE_FRAMES, the registers and the root are hashed on its last frame. A frame
+  // that was hashed before, e.g. when it is simulated again after a rollback, replaces its slice.
+  void HashSlice(const Core::CPUThreadGuard& guard, u64 frame);
+  // A whole state that was already read, mostly for tests
+  void AddState(u64 frame, std::span<const u8> state);
+  // The frame's slice of a state that was already read, for tests
+  void AddSlice(u64 frame, std::span<const u8> state);
+
+  // Called once no frame up to and including frame can be rolled back anymore. Returns the first
+  // frames and roots of the states read by then that have not been sent yet.
+  std::vector<std::pair<u64, u64>> Finalize(u64 frame);
+  // Compared once the frame is final here too
+  void AddRemoteRoot(u8 pid, u64 frame, u64 root);
+  // Only the first mismatch is returned, everything after it differs anyway
+  std::optional<Mismatch> TakeMismatch();
+
+  // The nodes of a level that are children of the given nodes of the level above
+  std::vector<Node> GetChildren(u64 frame, u32 level, std::span<const u32> parents) const;
+  // The indices of the remote nodes that differ from the local ones
+  std::vector<u32> Compare(u64 frame, u32 level, std::span<const Node> remote) const;
+  // The bytes of a leaf as they were hashed
+  std::vector<u8> GetBlockData(u64 frame, u32 leaf) const;
+  // The whole state as it was hashed
+  std::vector<u8> GetStateData(u64 frame) const;
+
+  Stats GetStats() const;
+
+private:
+  struct Entry
+  {
+    // The first frame it is read on
+    u64 frame;
+    // Read in order, the state is complete once all of them are
+    u32 slices;
+    bool final;
+    std::vector<u8> state;
+    // The root level first
+    std::vector<std::vector<u64>> levels;
+  };
+
+  // Null when earlier slices of the state are missing
+  Entry* GetEntryForSlice(u64 frame);
+  // The first block read on the frame and one past the last
+  std::pair<u32, u32> GetSliceBlocks(u64 frame) const;
+  void FinishSlice(Entry& entry, u64 frame);
+  void HashLeaves(Entry& entry, u32 first, u32 last) const;
+  void HashTree(Entry& entry) const;
+  Entry& GetEntryForWriting(u64 frame);
+  const Entry* FindEntry(u64 frame) const;
+  void CheckRemoteRoots();
+
+  const std::vector<DesyncRegion> m_regions;
+  std::vector<Block> m_blocks;
+  // Offsets of the blocks in a state, and one past the last
+  std::vector<size_t> m_block_offsets;
+  // Nodes per level, the root level first
+  std::vector<u32> m_level_sizes;
+  size_t m_state_size = 0;
+
+  mutable std::mutex m_mutex;
+  // Oldest first
+  std::deque<Entry> m_history;
+  // Kept after it left the history, for answering the other players
+  std::optional<Entry> m_mismatched_entry;
+  std::map<std::pair<u8, u64>, u64> m_remote_roots;
+  std::optional<Mismatch> m_mismatch;
+  bool m_mismatch_taken = false;
+  Stats m_stats;
+};
+}  // namespace NetPlay
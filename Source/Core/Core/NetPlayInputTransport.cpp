@@ -0,0 +1,226 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/NetPlayInputTransport.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "Common/SFMLHelper.h"
+#include "Core/NetPlayProto.h"
+
+namespace NetPlay
+{
+void InputLink::AddInput(PadIndex pad, const GCPadStatus& status)
+{
+  std::lock_guard lk(m_mutex);
+  OutgoingPad& outgoing = m_outgoing.at(pad);
+  outgoing.inputs.push_back(status);
+  outgoing.acked.push_back(false);
+
+  const size_t unacked = std::accumulate(
+      m_outgoing.begin(), m_outgoing.end(), size_t(0),
+      [](size_t sum, const OutgoingPad& pad_outgoing) { return sum + pad_outgoing.inputs.size(); });
+  m_stats.max_unacked = std::max(m_stats.max_unacked, unacked);
+}
+
+bool InputLink::HasUnacked() const
+{
+  std::lock_guard lk(m_mutex);
+  return HasUnackedLocked();
+}
+
+bool InputLink::NeedsResend(std::chrono::steady_clock::time_point now) const
+{
+  std::lock_guard lk(m_mutex);
+  return HasUnackedLocked() && now - m_last_send >= RESEND_INTERVAL;
+}
+
+bool InputLink::HasUnackedLocked() const
+{
+  return std::any_of(m_outgoing.begin(), m_outgoing.end(),
+                     [](const OutgoingPad& outgoing) { return !outgoing.inputs.empty(); });
+}
+
+sf::Packet InputLink::MakePacket()
+{
+  std::lock_guard lk(m_mutex);
+  sf::Packet packet;
+  packet << MessageID::PadInputs << m_game;
+
+  u8 ack_mask = 0;
+  for (size_t pad = 0; pad < NUM_PADS; ++pad)
+  {
+    if (m_incoming[pad].next != 0 || !m_incoming[pad].early.empty())
+      ack_mask |= 1 << pad;
+  }
+  packet << ack_mask;
+  for (size_t pad = 0; pad < NUM_PADS; ++pad)
+  {
+    if (!(ack_mask & (1 << pad)))
+      continue;
+    const Ack ack = GetAck(pad);
+    packet << static_cast<u32>(ack.next) << ack.received;
+  }
+
+  // The oldest inputs first, the other side can only use them in order. When there are too many
+  // after a long loss, the newest is sent as well, so that it is acknowledged by the time the
+  // ones before it have arrived.
+  std::vector<PadInputRun> runs;
+  for (size_t pad = 0; pad < NUM_PADS; ++pad)
+  {
+    const OutgoingPad& outgoing = m_outgoing[pad];
+    size_t budget = MAX_INPUTS_PER_PACKET - 1;
+    size_t i = 0;
+    while (i < outgoing.inputs.size() && budget != 0)
+    {
+      if (outgoing.acked[i])
+      {
+        ++i;
+        continue;
+      }
+      size_t end = i;
+      while (end < outgoing.inputs.size() && !outgoing.acked[end] && end - i < budget)
+        ++end;
+      runs.push_back({static_cast<PadIndex>(pad), outgoing.base + i,
+                      std::span(outgoing.inputs).subspan(i, end - i)});
+      budget -= end - i;
+      m_stats.inputs_sent += end - i;
+      i = end;
+    }
+
+    const size_t newest = outgoing.inputs.size() - 1;
+    if (i < outgoing.inputs.size() && !outgoing.acked[newest])
+    {
+      runs.push_back({static_cast<PadIndex>(pad), outgoing.base + newest,
+                      std::span(outgoing.inputs).subspan(newest, 1)});
+      ++m_stats.inputs_sent;
+    }
+  }
+
+  const std::vector<u8> batch = EncodeInputBatch(runs);
+  packet.append(batch.data(), batch.size());
+
+  m_last_send = std::chrono::steady_clock::now();
+  m_ack_needed = false;
+  ++m_stats.packets_sent;
+  return packet;
+}
+
+bool InputLink::OnPacket(sf::Packet& packet, std::vector<BroadcastInput>& inputs)
+{
+  u32 game;
+  u8 ack_mask;
+  packet >> game >> ack_mask;
+  if (!packet)
+    return false;
+  // Sent before this game started, or after it stopped on the other side
+  if (game != m_game)
+    return true;
+
+  std::lock_guard lk(m_mutex);
+  ++m_stats.packets_received;
+  for (size_t pad = 0; pad < NUM_PADS; ++pad)
+  {
+    if (!(ack_mask & (1 << pad)))
+      continue;
+    u32 next;
+    Ack ack;
+    packet >> next >> ack.received;
+    if (!packet)
+      return false;
+    ack.next = next;
+    OnAck(pad, ack);
+  }
+
+  std::vector<u8> batch;
+  while (!packet.endOfPacket())
+  {
+    u8 byte;
+    packet >> byte;
+    batch.push_back(byte);
+  }
+  const std::optional<std::vector<BroadcastInput>> received = DecodeBroadcastBatch(batch);
+  if (!received)
+    return false;
+
+  for (const BroadcastInput& input : *received)
+  {
+    IncomingPad& incoming = m_incoming[input.pad];
+    if (input.index < incoming.next || incoming.early.contains(input.index))
+    {
+      ++m_stats.duplicate_inputs;
+      continue;
+    }
+
+    m_ack_needed = true;
+    if (input.index != incoming.next)
+    {
+      if (input.index - incoming.next <= MAX_EARLY_INPUTS)
+        incoming.early.emplace(input.index, input.status);
+      continue;
+    }
+
+    inputs.push_back(input);
+    ++incoming.next;
+    ++m_stats.inputs_received;
+    for (auto it = incoming.early.begin();
+         it != incoming.early.end() && it->first == incoming.next;
+         it = incoming.early.erase(it))
+    {
+      inputs.push_back({input.pad, it->first, it->second});
+      ++incoming.next;
+      ++m_stats.inputs_received;
+      ++m_stats.early_inputs;
+    }
+  }
+  return true;
+}
+
+bool InputLink::IsAckNeeded() const
+{
+  std::lock_guard lk(m_mutex);
+  return m_ack_needed;
+}
+
+InputLink::Stats InputLink::GetStats() const
+{
+  std::lock_guard lk(m_mutex);
+  return m_stats;
+}
+
+void InputLink::OnAck(size_t pad, const Ack& ack)
+{
+  OutgoingPad& outgoing = m_outgoing[pad];
+  const u64 end = outgoing.base + outgoing.inputs.size();
+  // Acknowledges inputs that were never sent
+  if (ack.next > end)
+    return;
+
+  for (u32 bit = 0; bit < 32; ++bit)
+  {
+    const u64 index = ack.next + 1 + bit;
+    if ((ack.received & (1u << bit)) && index >= outgoing.base && index < end)
+      outgoing.acked[index - outgoing.base] = true;
+  }
+
+  size_t dropped = ack.next > outgoing.base ? ack.next - outgoing.base : 0;
+  while (dropped < outgoing.acked.size() && outgoing.acked[dropped])
+    ++dropped;
+  outgoing.inputs.erase(outgoing.inputs.begin(), outgoing.inputs.begin() + dropped);
+  outgoing.acked.erase(outgoing.acked.begin(), outgoing.acked.begin() + dropped);
+  outgoing.base += dropped;
+}
+
+InputLink::Ack InputLink::GetAck(size_t pad) const
+{
+  const IncomingPad& incoming = m_incoming[pad];
+  Ack ack{incoming.next, 0};
+  for (auto it = incoming.early.upper_bound(incoming.next);
+       it != incoming.early.end() && it->first <= incoming.next + 32; ++it)
+  {
+    ack.received |= 1u << (it->first - incoming.next - 1);
+  }
+  return ack;
+}
+}  // namespace NetPlay
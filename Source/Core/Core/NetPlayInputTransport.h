@@ -0,0 +1,107 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayBroadcast.h"
+#include "InputCommon/GCPadStatus.h"
+
+namespace NetPlay
+{
+// The pad inputs of one side of a connection during a game, sent over the unreliable input
+// channel. Every packet repeats the inputs the other side did not acknowledge yet, so that a lost
+// packet is covered by the next one instead of stalling every player until it is resent, and
+// acknowledges the inputs received from the other side. Inputs are indexed per pad from the start
+// of the game, like those of a broadcast.
+//
+// Thread safe, inputs are added on the CPU thread and packets are received on the network thread.
+class InputLink final
+{
+public:
+  static constexpr size_t NUM_PADS = BroadcastEncoder::NUM_PADS;
+  // Inputs of a pad in a packet. More are sent once the first ones are acknowledged.
+  static constexpr size_t MAX_INPUTS_PER_PACKET = 64;
+  // Inputs received ahead of a missing one that are held until it arrives
+  static constexpr u64 MAX_EARLY_INPUTS = 512;
+  // How long unacknowledged inputs wait to be sent again when no new input is sent
+  static constexpr std::chrono::milliseconds RESEND_INTERVAL{50};
+
+  struct Stats
+  {
+    u64 packets_sent = 0;
+    u64 packets_received = 0;
+    u64 inputs_sent = 0;
+    u64 inputs_received = 0;
+    // Inputs that were received again, the cost of the redundancy
+    u64 duplicate_inputs = 0;
+    // Inputs that arrived after a later one, which a reliable channel would have waited for
+    u64 early_inputs = 0;
+    size_t max_unacked = 0;
+  };
+
+  // Packets of other games are ignored
+  explicit InputLink(u32 game) : m_game(game) {}
+
+  u32 GetGame() const { return m_game; }
+
+  void AddInput(PadIndex pad, const GCPadStatus& status);
+  bool HasUnacked() const;
+  bool NeedsResend(std::chrono::steady_clock::time_point now) const;
+
+  // A PadInputs message with the acknowledgements and the unacknowledged inputs
+  sf::Packet MakePacket();
+
+  // Reads a PadInputs message after its id. Inputs that are next in order are appended to
+  // inputs, which includes ones that were held until a missing input arrived. False if the
+  // message is malformed.
+  bool OnPacket(sf::Packet& packet, std::vector<BroadcastInput>& inputs);
+  // Whether the last packet had new inputs, which should be acknowledged even if there is
+  // nothing to send
+  bool IsAckNeeded() const;
+
+  Stats GetStats() const;
+
+private:
+  // Every input before next, and of the 32 after it, the ones whose bit is set
+  struct Ack
+  {
+    u64 next = 0;
+    u32 received = 0;
+  };
+
+  struct OutgoingPad
+  {
+    // Index of the first input, every input before it was acknowledged
+    u64 base = 0;
+    std::vector<GCPadStatus> inputs;
+    std::vector<bool> acked;
+  };
+
+  struct IncomingPad
+  {
+    u64 next = 0;
+    std::map<u64, GCPadStatus> early;
+  };
+
+  bool HasUnackedLocked() const;
+  void OnAck(size_t pad, const Ack& ack);
+  Ack GetAck(size_t pad) const;
+
+  const u32 m_game;
+  mutable std::mutex m_mutex;
+  std::array<OutgoingPad, NUM_PADS> m_outgoing;
+  std::array<IncomingPad, NUM_PADS> m_incoming;
+  std::chrono::steady_clock::time_point m_last_send;
+  bool m_ack_needed = false;
+  Stats m_stats;
+};
+}  // namespace NetPlay
@@ -0,0 +1,134 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/NetPlayPadBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace NetPlay
+{
+void PadBufferController::AddSample(PlayerId pid, u32 rtt_ms)
+{
+  std::lock_guard lk(m_mutex);
+  History& history = m_histories[pid];
+  const u8 bucket = static_cast<u8>(std::min<u32>(rtt_ms / BUCKET_MS, NUM_BUCKETS - 1));
+  history.samples.push_back(bucket);
+  ++history.counts[bucket];
+  if (history.samples.size() > WINDOW_SAMPLES)
+  {
+    --history.counts[history.samples.front()];
+    history.samples.pop_front();
+  }
+}
+
+void PadBufferController::RemovePlayer(PlayerId pid)
+{
+  std::lock_guard lk(m_mutex);
+  m_histories.erase(pid);
+}
+
+std::optional<u32> PadBufferController::GetPercentile(PlayerId pid, double share) const
+{
+  std::lock_guard lk(m_mutex);
+  return GetPercentileLocked(pid, share);
+}
+
+std::optional<u32> PadBufferController::GetPercentileLocked(PlayerId pid, double share) const
+{
+  const auto it = m_histories.find(pid);
+  if (it == m_histories.end() || it->second.samples.size() < MIN_SAMPLES)
+    return std::nullopt;
+
+  const History& history = it->second;
+  const size_t rank = std::max<size_t>(
+      1, static_cast<size_t>(std::ceil(share * static_cast<double>(history.samples.size()))));
+  size_t seen = 0;
+  size_t bucket = 0;
+  for (; bucket < NUM_BUCKETS - 1; ++bucket)
+  {
+    seen += history.counts[bucket];
+    if (seen >= rank)
+      break;
+  }
+  // The top of the bucket, so that rounding never makes a round trip look shorter
+  return static_cast<u32>((bucket + 1) * BUCKET_MS);
+}
+
+std::optional<PadBufferController::Decision>
+PadBufferController::GetNeeded(std::span<const PlayerId> players) const
+{
+  std::lock_guard lk(m_mutex);
+  return GetNeededLocked(players);
+}
+
+std::optional<PadBufferController::Decision>
+PadBufferController::GetNeededLocked(std::span<const PlayerId> players) const
+{
+  // Inputs go from a player to the server and from there to the others, half a round trip each
+  Decision decision{MIN_BUFFER};
+  u32 first_rtt = 0;
+  u32 second_rtt = 0;
+  for (const PlayerId pid : players)
+  {
+    const std::optional<u32> rtt = GetPercentileLocked(pid, PERCENTILE);
+    if (!rtt)
+      return std::nullopt;
+
+    if (decision.first == 0 || *rtt > first_rtt)
+    {
+      decision.second = decision.first;
+      second_rtt = first_rtt;
+      decision.first = pid;
+      first_rtt = *rtt;
+    }
+    else if (decision.second == 0 || *rtt > second_rtt)
+    {
+      decision.second = pid;
+      second_rtt = *rtt;
+    }
+  }
+
+  // Nobody waits for the inputs of another player
+  if (decision.second == 0)
+    return decision;
+
+  decision.path_ms = (first_rtt + second_rtt + 1) / 2;
+  const u32 frames =
+      static_cast<u32>(std::ceil(decision.path_ms / FRAME_TIME_MS)) + MARGIN_FRAMES;
+  decision.buffer = std::clamp(frames, MIN_BUFFER, MAX_BUFFER);
+  return decision;
+}
+
+std::optional<PadBufferController::Decision>
+PadBufferController::Update(u32 current, std::span<const PlayerId> players, Clock::time_point now)
+{
+  std::lock_guard lk(m_mutex);
+  std::optional<Decision> decision = GetNeededLocked(players);
+  if (!decision || decision->buffer == current)
+  {
+    m_lower_since.reset();
+    return std::nullopt;
+  }
+
+  if (decision->buffer > current)
+  {
+    m_lower_since.reset();
+    decision->buffer = std::min(decision->buffer, current + MAX_RAISE);
+    return decision;
+  }
+
+  if (!m_lower_since)
+  {
+    m_lower_since = now;
+    return std::nullopt;
+  }
+  if (now - *m_lower_since < LOWER_DELAY)
+    return std::nullopt;
+
+  // Wait again before the next frame
+  m_lower_since = now;
+  decision->buffer = current - 1;
+  return decision;
+}
+}  // namespace NetPlay
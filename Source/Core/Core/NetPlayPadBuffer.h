@@ -0,0 +1,87 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayProto.h"
+
+namespace NetPlay
+{
+// Picks the pad buffer from the round trip times the server measures with its pings. Every
+// player keeps a histogram of their recent samples, and the buffer covers the time an input takes
+// from one player through the server to another, for the pair of players furthest apart.
+//
+// Thread safe, samples are added on the network thread and games are started from others.
+class PadBufferController final
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // The buffers picked from. Buffers set by hand have a higher minimum, but a picked buffer
+  // already covers the measured round trips.
+  static constexpr u32 MIN_BUFFER = 1;
+  static constexpr u32 MAX_BUFFER = 30;
+  // Pings are sent every second, so this is about the last half minute
+  static constexpr size_t WINDOW_SAMPLES = 30;
+  // Players are ignored until they have been pinged this many times
+  static constexpr size_t MIN_SAMPLES = 5;
+  static constexpr u32 BUCKET_MS = 2;
+  // The last bucket counts every round trip longer than the ones before it
+  static constexpr size_t NUM_BUCKETS = 256;
+  // Share of the round trips the buffer covers
+  static constexpr double PERCENTILE = 0.95;
+  // For the time between an input being polled and it being sent
+  static constexpr u32 MARGIN_FRAMES = 1;
+  static constexpr double FRAME_TIME_MS = 1000.0 / 59.94;
+  // Frames a single update may add. Every player waits for them, like for a stall.
+  static constexpr u32 MAX_RAISE = 4;
+  // How long the buffer has to be larger than needed before a frame is taken off
+  static constexpr std::chrono::seconds LOWER_DELAY{10};
+
+  struct Decision
+  {
+    u32 buffer = 0;
+    // The pair of players the buffer was picked for, and the time an input takes between them
+    PlayerId first = 0;
+    PlayerId second = 0;
+    u32 path_ms = 0;
+  };
+
+  void AddSample(PlayerId pid, u32 rtt_ms);
+  void RemovePlayer(PlayerId pid);
+
+  // Round trip time that the given share of the recent samples of a player are within
+  std::optional<u32> GetPercentile(PlayerId pid, double share) const;
+  // Smallest buffer that covers the inputs between the given players. Empty until every one of
+  // them has enough samples.
+  std::optional<Decision> GetNeeded(std::span<const PlayerId> players) const;
+  // A new buffer if the current one should change. It is raised at once, up to MAX_RAISE, and
+  // lowered a frame at a time once it has been larger than needed for LOWER_DELAY.
+  std::optional<Decision> Update(u32 current, std::span<const PlayerId> players,
+                                 Clock::time_point now);
+
+private:
+  struct History
+  {
+    std::array<u16, NUM_BUCKETS> counts{};
+    // Buckets of the samples, oldest first
+    std::deque<u8> samples;
+  };
+
+  std::optional<u32> GetPercentileLocked(PlayerId pid, double share) const;
+  std::optional<Decision> GetNeededLocked(std::span<const PlayerId> players) const;
+
+  mutable std::mutex m_mutex;
+  std::map<PlayerId, History> m_histories;
+  std::optional<Clock::time_point> m_lower_since;
+};
+}  // namespace NetPlay
@@ -105,6 +105,12 @@ struct NetSettings
   bool golf_mode = false;
   bool use_fma = false;
   bool hide_remote_gbas = false;
+  // Zero unless the network mode is rollback
+  u32 rollback_frames = 0;
+  // Memory hashed for finding desyncs, see DesyncDetector
+  std::string desync_regions;
+  // Inputs are sent over the unreliable channel with InputLink
+  bool redundant_inputs = false;
 
   Sram sram;
 
@@ -154,6 +160,10 @@ enum class MessageID : u8
   PadHostData = 0x63,
   GBAConfig = 0x64,
   PadSpectator = 0x66,
+  BroadcastInputs = 0x67,
+  BroadcastKeyframe = 0x68,
+  BroadcastKeyframeRequest = 0x69,
+  PadInputs = 0x6A,
 
   WiimoteData = 0x70,
   WiimoteMapping = 0x71,
@@ -175,7 +185,10 @@ enum class MessageID : u8
 
   TimeBase = 0xB0,
   DesyncDetected = 0xB1,
-  Checksum = 0xB2,
+  // 0xB2 was Checksum, which is not reused so that older builds can't mistake one for the other
+  DesyncNodes = 0xB3,
+  DesyncBlocks = 0xB4,
+  DesyncHash = 0xB5,
 
   ComputeGameDigest = 0xC0,
   GameDigestProgress = 0xC1,
@@ -208,7 +221,9 @@ enum class ConnectionError : u8
   ServerFull = 1,
   GameRunning = 2,
   VersionMismatch = 3,
-  NameTooLong = 4
+  NameTooLong = 4,
+  NotBroadcasting = 5,
+  WrongSpectatorKey = 6
 };
 
 enum class SyncSaveDataID : u8
@@ -219,7 +234,8 @@ enum class SyncSaveDataID : u8
   RawData = 3,
   GCIData = 4,
   WiiData = 5,
-  GBAData = 6
+  GBAData = 6,
+  Blocks = 7
 };
 
 enum class SyncCodeID : u8
@@ -241,6 +257,8 @@ enum : u8
 {
   DEFAULT_CHANNEL,
   CHUNKED_DATA_CHANNEL,
+  // Unreliable and unsequenced, for InputLink
+  INPUT_CHANNEL,
   CHANNEL_COUNT
 };
 
@@ -270,6 +288,13 @@ std::string GetPlayerMappingString(PlayerId pid, const PadMappingArray& pad_map,
                                    const PadMappingArray& wiimote_map);
 bool IsNetPlayRunning();
 void SetSIPollBatching(bool state);
+// Called on the CPU thread after every SI poll, for rollback and for keyframes of broadcasts
+bool IsPollEndEventNeeded();
+void OnPollEnd();
+// Called on the CPU thread. Re-simulated frames were already seen, heard and tracked once.
+bool IsResimulating();
+// Whether the game being started rolls back mispredicted frames
+bool IsRollbackEnabled();
 void SendPowerButtonEvent();
 std::string GetGBASavePath(int pad_num);
 PadDetails GetPadDetails(int pad_num);
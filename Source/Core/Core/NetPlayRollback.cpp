@@ -0,0 +1,282 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/NetPlayRollback.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+#include "Common/Logging/Log.h"
+
+namespace NetPlay
+{
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+bool IsSameStatus(const GCPadStatus& a, const GCPadStatus& b)
+{
+  return a.button == b.button && a.stickX == b.stickX && a.stickY == b.stickY &&
+         a.substickX == b.substickX && a.substickY == b.substickY &&
+         a.triggerLeft == b.triggerLeft && a.triggerRight == b.triggerRight &&
+         a.analogA == b.analogA && a.analogB == b.analogB && a.isConnected == b.isConnected;
+}
+
+double ElapsedUs(Clock::time_point start)
+{
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// Smooths out the occasional slow save, e.g. when the host is busy with something else
+void UpdateAverage(double& average, double sample, u64 count)
+{
+  average = count == 1 ? sample : average + (sample - average) / 16;
+}
+}  // namespace
+
+RollbackSession::RollbackSession(u32 max_frames, std::chrono::microseconds budget,
+                                 SaveFunction save, LoadFunction load)
+    : m_max_frames(std::max(max_frames, 1u)), m_budget(budget), m_save(std::move(save)),
+      m_load(std::move(load))
+{
+  // Nothing has been pressed before the first input arrives
+  for (Pad& pad : m_pads)
+  {
+    pad.last_confirmed.stickX = GCPadStatus::MAIN_STICK_CENTER_X;
+    pad.last_confirmed.stickY = GCPadStatus::MAIN_STICK_CENTER_Y;
+    pad.last_confirmed.substickX = GCPadStatus::C_STICK_CENTER_X;
+    pad.last_confirmed.substickY = GCPadStatus::C_STICK_CENTER_Y;
+  }
+}
+
+void RollbackSession::AddInput(int pad, const GCPadStatus& status)
+{
+  Pad& p = m_pads[pad];
+  const u64 index = p.confirmed++;
+  p.last_confirmed = status;
+
+  if (index - p.base >= p.inputs.size())
+  {
+    p.inputs.push_back(status);
+    return;
+  }
+
+  // Inputs arrive in order, so the first misprediction found is the earliest one
+  GCPadStatus& stored = p.inputs[index - p.base];
+  if (index < p.consumed && !p.first_misprediction && !IsSameStatus(stored, status))
+    p.first_misprediction = index;
+  stored = status;
+}
+
+bool RollbackSession::CanConsume(int pad) const
+{
+  // Nothing can be rolled back before the first snapshot
+  const Pad& p = m_pads[pad];
+  return p.consumed < p.confirmed + (m_snapshots.empty() ? 0 : m_max_frames);
+}
+
+GCPadStatus RollbackSession::ConsumeInput(int pad)
+{
+  Pad& p = m_pads[pad];
+  const u64 index = p.consumed++;
+  if (index < p.confirmed)
+    return p.inputs[index - p.base];
+
+  // Kept to be compared with the real input once it arrives
+  const GCPadStatus prediction = p.last_confirmed;
+  if (index - p.base < p.inputs.size())
+    p.inputs[index - p.base] = prediction;
+  else
+    p.inputs.push_back(prediction);
+  return prediction;
+}
+
+bool RollbackSession::IsFrameFinal() const
+{
+  return std::all_of(m_pads.begin(), m_pads.end(),
+                     [](const Pad& p) { return p.consumed <= p.confirmed; });
+}
+
+bool RollbackSession::IsPredicting() const
+{
+  // Pads the game never reads have neither inputs nor reads
+  return std::any_of(m_pads.begin(), m_pads.end(), [](const Pad& p) {
+    return p.consumed != 0 && p.consumed >= p.confirmed;
+  });
+}
+
+void RollbackSession::EndFrame()
+{
+  const Clock::time_point start = Clock::now();
+  // Frames that take a snapshot may use the budget of the frames that did not
+  const double allowed_us = double(m_budget.count()) * m_interval;
+  const bool mispredicted = std::any_of(m_pads.begin(), m_pads.end(),
+                                        [](const Pad& p) { return p.first_misprediction; });
+  if (mispredicted)
+  {
+    Rollback();
+  }
+  else
+  {
+    const bool was_resimulating = IsResimulating();
+    ++m_frame;
+    if (was_resimulating && !IsResimulating())
+    {
+      const double elapsed_ms =
+          std::chrono::duration<double, std::milli>(Clock::now() - m_resimulation_start).count();
+      std::lock_guard lk(m_stats_mutex);
+      m_stats.resimulation_ms += elapsed_ms;
+      m_stats.max_resimulation_ms = std::max(m_stats.max_resimulation_ms, elapsed_ms);
+    }
+
+    // Frames whose inputs are all known only need an occasional snapshot, to limit how far back
+    // a later rollback has to go
+    const u64 frames_since_snapshot =
+        m_snapshots.empty() ? UINT64_MAX : m_frame - m_snapshots.back().frame;
+    if (frames_since_snapshot >= (IsPredicting() ? m_interval : m_max_frames))
+      SaveSnapshot();
+
+    DropOldSnapshots();
+    TrimInputs();
+  }
+
+  const double cost_us = ElapsedUs(start);
+  std::lock_guard lk(m_stats_mutex);
+  m_stats.frames = std::max(m_stats.frames, m_frame);
+  if (m_budget.count() != 0 && cost_us > allowed_us)
+    ++m_stats.budget_overruns;
+}
+
+void RollbackSession::Rollback()
+{
+  // The newest snapshot from before the first wrong prediction of every pad
+  const auto is_before_mispredictions = [this](const Snapshot& snapshot) {
+    for (int i = 0; i < NUM_PADS; ++i)
+    {
+      const std::optional<u64>& misprediction = m_pads[i].first_misprediction;
+      if (misprediction && snapshot.consumed[i] > *misprediction)
+        return false;
+    }
+    return true;
+  };
+  auto it = std::find_if(m_snapshots.rbegin(), m_snapshots.rend(), is_before_mispredictions);
+  if (it == m_snapshots.rend())
+  {
+    // DropOldSnapshots always keeps one from before the first prediction
+    ERROR_LOG_FMT(NETPLAY, "No snapshot to roll back to at frame {}", m_frame);
+    it = std::prev(m_snapshots.rend());
+  }
+
+  // A rollback during a rollback still has to get back to the same frame
+  if (!IsResimulating())
+  {
+    m_resimulation_end = m_frame + 1;
+    m_resimulation_start = Clock::now();
+  }
+
+  const Clock::time_point start = Clock::now();
+  m_load(it->state);
+  const double load_us = ElapsedUs(start);
+
+  m_frame = it->frame;
+  for (int i = 0; i < NUM_PADS; ++i)
+  {
+    m_pads[i].consumed = it->consumed[i];
+    m_pads[i].first_misprediction.reset();
+  }
+  while (m_snapshots.back().frame > m_frame)
+  {
+    m_free_buffers.push_back(std::move(m_snapshots.back().state));
+    m_snapshots.pop_back();
+  }
+
+  const u32 depth = static_cast<u32>(m_resimulation_end - m_frame);
+  std::lock_guard lk(m_stats_mutex);
+  ++m_stats.rollbacks;
+  m_stats.resimulated_frames += depth;
+  m_stats.max_rollback_depth = std::max(m_stats.max_rollback_depth, depth);
+  UpdateAverage(m_average_load_us, load_us, m_stats.rollbacks);
+  m_stats.average_load_us = m_average_load_us;
+}
+
+void RollbackSession::SaveSnapshot()
+{
+  Snapshot& snapshot = m_snapshots.emplace_back();
+  snapshot.frame = m_frame;
+  for (int i = 0; i < NUM_PADS; ++i)
+    snapshot.consumed[i] = m_pads[i].consumed;
+  if (!m_free_buffers.empty())
+  {
+    snapshot.state = std::move(m_free_buffers.back());
+    m_free_buffers.pop_back();
+  }
+
+  const Clock::time_point start = Clock::now();
+  m_save(snapshot.state);
+  const double save_us = ElapsedUs(start);
+
+  std::lock_guard lk(m_stats_mutex);
+  ++m_stats.snapshots;
+  UpdateAverage(m_average_save_us, save_us, m_stats.snapshots);
+  m_stats.average_save_us = m_average_save_us;
+  UpdateInterval();
+  m_stats.snapshot_interval = m_interval;
+}
+
+void RollbackSession::DropOldSnapshots()
+{
+  // Only inputs that have not been confirmed yet can be mispredicted, so nothing will roll back
+  // further than the newest snapshot from before them
+  const auto is_confirmed = [this](const Snapshot& snapshot) {
+    for (int i = 0; i < NUM_PADS; ++i)
+    {
+      if (snapshot.consumed[i] > m_pads[i].confirmed)
+        return false;
+    }
+    return true;
+  };
+  const auto anchor = std::find_if(m_snapshots.rbegin(), m_snapshots.rend(), is_confirmed);
+  if (anchor == m_snapshots.rend())
+    return;
+
+  const size_t count = std::distance(anchor, m_snapshots.rend()) - 1;
+  for (size_t i = 0; i < count; ++i)
+  {
+    m_free_buffers.push_back(std::move(m_snapshots.front().state));
+    m_snapshots.pop_front();
+  }
+}
+
+void RollbackSession::TrimInputs()
+{
+  // Re-simulation reads inputs again from the oldest snapshot on
+  for (int i = 0; i < NUM_PADS; ++i)
+  {
+    Pad& p = m_pads[i];
+    const u64 keep =
+        std::min(m_snapshots.empty() ? p.consumed : m_snapshots.front().consumed[i], p.confirmed);
+    while (p.base < keep)
+    {
+      p.inputs.pop_front();
+      ++p.base;
+    }
+  }
+}
+
+void RollbackSession::UpdateInterval()
+{
+  // Saving less often makes rollbacks deeper but keeps the frames that save within the budget
+  if (m_budget.count() == 0)
+    return;
+  const double frames = std::ceil(m_average_save_us / m_budget.count());
+  m_interval = static_cast<u32>(std::clamp(frames, 1.0, double(m_max_frames)));
+}
+
+RollbackSession::Stats RollbackSession::GetStats() const
+{
+  std::lock_guard lk(m_stats_mutex);
+  return m_stats;
+}
+}  // namespace NetPlay
@@ -0,0 +1,126 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "InputCommon/GCPadStatus.h"
+
+namespace NetPlay
+{
+// Lets the game run ahead of the inputs of the remote players. Inputs that have not arrived yet
+// are predicted to be the last one that did, and the state at the start of recent frames is kept
+// in memory. Once an input arrives that does not match its prediction, the newest state from
+// before it is loaded and the frames since are simulated again with the real input.
+//
+// A frame is the time between two SI polls. The input streams are indexed by how many times the
+// game read each pad, which is the same for every player. Everything but GetStats must be called
+// from the CPU thread.
+class RollbackSession final
+{
+public:
+  static constexpr int NUM_PADS = 4;
+
+  using SaveFunction = std::function<void(std::vector<u8>& buffer)>;
+  using LoadFunction = std::function<void(const std::vector<u8>& buffer)>;
+
+  struct Stats
+  {
+    u64 frames = 0;
+    u64 rollbacks = 0;
+    // Frames simulated again, summed over all rollbacks
+    u64 resimulated_frames = 0;
+    u32 max_rollback_depth = 0;
+    double resimulation_ms = 0.0;
+    double max_resimulation_ms = 0.0;
+    u64 snapshots = 0;
+    double average_save_us = 0.0;
+    double average_load_us = 0.0;
+    // A snapshot is taken every this many frames while inputs are being predicted
+    u32 snapshot_interval = 1;
+    // Frames whose saving and loading took longer than the budget of all frames since the
+    // previous snapshot
+    u64 budget_overruns = 0;
+  };
+
+  // max_frames is how far the inputs of a pad may be predicted. budget is how long saving and
+  // loading states may take per frame, snapshots are taken less often when saving is slower.
+  RollbackSession(u32 max_frames, std::chrono::microseconds budget, SaveFunction save,
+                  LoadFunction load);
+
+  // Adds the next input of a pad, in the order the game reads them
+  void AddInput(int pad, const GCPadStatus& status);
+  u64 GetInputCount(int pad) const { return m_pads[pad].confirmed; }
+  u64 GetConsumedCount(int pad) const { return m_pads[pad].consumed; }
+
+  // False if the next input would have to be predicted too far ahead, the caller should wait for
+  // more inputs to arrive
+  bool CanConsume(int pad) const;
+  GCPadStatus ConsumeInput(int pad);
+
+  // Called between the SI poll and the next one, rolls back if a prediction was wrong and takes a
+  // snapshot if one is needed
+  void EndFrame();
+
+  u64 GetFrame() const { return m_frame; }
+  bool IsResimulating() const { return m_frame < m_resimulation_end; }
+  // Whether every input read so far was a real one, so that the frame can not be rolled back
+  bool IsFrameFinal() const;
+
+  Stats GetStats() const;
+
+private:
+  struct Pad
+  {
+    // Inputs from index base on, confirmed ones followed by the ones predicted after them
+    std::deque<GCPadStatus> inputs;
+    u64 base = 0;
+    u64 confirmed = 0;
+    u64 consumed = 0;
+    GCPadStatus last_confirmed;
+    std::optional<u64> first_misprediction;
+  };
+
+  struct Snapshot
+  {
+    u64 frame;
+    std::array<u64, NUM_PADS> consumed;
+    std::vector<u8> state;
+  };
+
+  bool IsPredicting() const;
+  void Rollback();
+  void SaveSnapshot();
+  void DropOldSnapshots();
+  void TrimInputs();
+  void UpdateInterval();
+
+  const u32 m_max_frames;
+  const std::chrono::microseconds m_budget;
+  const SaveFunction m_save;
+  const LoadFunction m_load;
+
+  std::array<Pad, NUM_PADS> m_pads;
+  u64 m_frame = 0;
+  u64 m_resimulation_end = 0;
+  std::chrono::steady_clock::time_point m_resimulation_start;
+
+  // Oldest first. The buffers of dropped snapshots are reused, states rarely change size.
+  std::deque<Snapshot> m_snapshots;
+  std::vector<std::vector<u8>> m_free_buffers;
+  u32 m_interval = 1;
+  double m_average_save_us = 0.0;
+  double m_average_load_us = 0.0;
+
+  mutable std::mutex m_stats_mutex;
+  Stats m_stats;
+};
+}  // namespace NetPlay
@@ -59,6 +59,7 @@
 #include "Core/IOS/FS/FileSystem.h"
 #include "Core/IOS/IOS.h"
 #include "Core/IOS/Uids.h"
+#include "Core/NetPlayBroadcast.h"
 #include "Core/NetPlayClient.h"  //for NetPlayUI
 #include "Core/NetPlayCommon.h"
 #include "Core/SyncIdentifier.h"
@@ -73,6 +74,8 @@
 
 #include "UICommon/GameFile.h"
 
+#include "VideoCommon/OnScreenDisplay.h"
+
 #if !defined(_WIN32)
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -165,10 +168,24 @@ NetPlayServer::NetPlayServer(const u16 port, const bool forward_port, NetPlayUI*
   }
   if (m_server != nullptr)
   {
+    const std::string relay = Config::Get(Config::NETPLAY_BROADCAST_RELAY);
+    if (!relay.empty())
+    {
+      m_broadcast = std::make_unique<BroadcastSource>(
+          relay, std::chrono::seconds(Config::Get(Config::NETPLAY_BROADCAST_DELAY)),
+          Config::Get(Config::NETPLAY_BROADCAST_KEY),
+          Config::Get(Config::NETPLAY_BROADCAST_SPECTATOR_KEY));
+      if (!m_broadcast->IsValid())
+      {
+        PanicAlertFmtT("Could not connect to the broadcast relay {0}.", relay);
+        m_broadcast.reset();
+      }
+    }
+
     is_connected = true;
     m_do_loop = true;
     m_thread = std::thread(&NetPlayServer::ThreadFunc, this);
-    m_target_buffer_size = 8;
+    m_target_buffer_size = MIN_PAD_BUFFER_SIZE;
     m_chunked_data_thread = std::thread(&NetPlayServer::ChunkedDataThreadFunc, this);
 
 #ifdef USE_UPNP
@@ -269,13 +286,18 @@ void NetPlayServer::ThreadFunc()
       m_index.SetInGame(m_is_running);
 
       m_update_pings = false;
+
+      if (m_is_running && Config::Get(Config::NETPLAY_AUTO_BUFFER))
+        UpdateAutoPadBuffer();
     }
 
     ENetEvent netEvent;
     int net;
     if (m_traversal_client)
       m_traversal_client->HandleResends();
-    net = enet_host_service(m_server, &netEvent, 1000);
+    // Batches of a broadcast are due a few times a second, and so are resent inputs
+    net = enet_host_service(m_server, &netEvent,
+                            m_broadcast || m_settings.redundant_inputs ? 50 : 1000);
     while (!m_async_queue.Empty())
     {
       INFO_LOG_FMT(NETPLAY, "Processing async queue event.");
@@ -296,6 +318,10 @@ void NetPlayServer::ThreadFunc()
       INFO_LOG_FMT(NETPLAY, "Processing async queue event done.");
       m_async_queue.Pop();
     }
+    if (m_broadcast)
+      UpdateBroadcast();
+    if (m_settings.redundant_inputs && m_is_running)
+      ResendPadInputs();
     if (net > 0)
     {
       switch (netEvent.type)
@@ -418,7 +444,7 @@ void NetPlayServer::ThreadFunc()
   m_players.clear();
 }
 
-static void SendSyncIdentifier(sf::Packet& spac, const SyncIdentifier& sync_identifier)
+void WriteSyncIdentifier(sf::Packet& spac, const SyncIdentifier& sync_identifier)
 {
   // We cast here due to a potential long vs long long mismatch
   spac << static_cast<sf::Uint64>(sync_identifier.dol_elf_size);
@@ -479,7 +505,7 @@ ConnectionError NetPlayServer::OnConnect(ENetPeer* incoming_connection, sf::Pack
   {
     sf::Packet send_packet;
     send_packet << MessageID::ChangeGame;
-    SendSyncIdentifier(send_packet, m_selected_game_identifier);
+    WriteSyncIdentifier(send_packet, m_selected_game_identifier);
     send_packet << m_selected_game_name;
     Send(new_player.socket, send_packet);
   }
@@ -567,6 +593,7 @@ unsigned int NetPlayServer::OnDisconnect(const Client& player)
   auto it = m_players.find(player.pid);
   if (it != m_players.end())
     m_players.erase(it);
+  m_buffer_controller.RemovePlayer(pid);
 
   // alert other players of disconnect
   SendToClients(spac);
@@ -670,6 +697,47 @@ void NetPlayServer::UpdateGBAConfig()
   SendToClients(spac);
 }
 
+std::vector<PlayerId> NetPlayServer::GetPlayersWithPads() const
+{
+  std::vector<PlayerId> players;
+  for (const PlayerId mapping : m_pad_map)
+  {
+    if (mapping != 0 && std::find(players.begin(), players.end(), mapping) == players.end())
+      players.push_back(mapping);
+  }
+  return players;
+}
+
+// called from ---NETPLAY--- thread
+bool NetPlayServer::IsAutoPadBufferEnabled() const
+{
+  // Rollback hides the latency that the buffer would otherwise be raised for
+  return !m_host_input_authority && m_settings.rollback_frames == 0 &&
+         Config::Get(Config::NETPLAY_AUTO_BUFFER);
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayServer::UpdateAutoPadBuffer()
+{
+  if (!IsAutoPadBufferEnabled())
+    return;
+
+  const std::optional<PadBufferController::Decision> decision = m_buffer_controller.Update(
+      m_target_buffer_size, GetPlayersWithPads(), PadBufferController::Clock::now());
+  if (!decision)
+    return;
+
+  INFO_LOG_FMT(NETPLAY, "Auto buffer: {} -> {}, {} ms between players {} and {}",
+               m_target_buffer_size, decision->buffer, decision->path_ms, decision->first,
+               decision->second);
+  OSD::AddTypedMessage(OSD::MessageType::NetPlayBuffer,
+                       fmt::format("Auto buffer: {} ({} ms between players {} and {})",
+                                   decision->buffer, decision->path_ms, decision->first,
+                                   decision->second),
+                       OSD::Duration::NORMAL, OSD::Color::CYAN);
+  SetPadBufferSize(decision->buffer, PadBufferController::MIN_BUFFER);
+}
+
 // called from ---NETPLAY--- thread
 void NetPlayServer::UpdateWiimoteMapping()
 {
@@ -684,11 +752,17 @@ void NetPlayServer::UpdateWiimoteMapping()
 
 // called from ---GUI--- thread and ---NETPLAY--- thread
 void NetPlayServer::AdjustPadBufferSize(unsigned int size)
+{
+  SetPadBufferSize(size, MIN_PAD_BUFFER_SIZE);
+}
+
+// called from ---GUI--- thread and ---NETPLAY--- thread
+void NetPlayServer::SetPadBufferSize(u32 size, u32 min_size)
 {
   std::lock_guard lkg(m_crit.game);
 
-  if (size < 8)
-    size = 8;
+  if (size < min_size)
+    size = min_size;
 
   m_target_buffer_size = size;
 
@@ -793,12 +867,12 @@ void NetPlayServer::SendChunked(sf::Packet&& packet, const PlayerId pid, const s
 }
 
 void NetPlayServer::SendChunkedToClients(sf::Packet&& packet, const PlayerId skip_pid,
-                                         const std::string& title)
+                                         const std::string& title, const bool wait_for_players)
 {
   {
     std::lock_guard lkq(m_crit.chunked_data_queue_write);
-    m_chunked_data_queue.Push(
-        ChunkedDataQueueEntry{std::move(packet), skip_pid, TargetMode::AllExcept, title});
+    m_chunked_data_queue.Push(ChunkedDataQueueEntry{
+        std::move(packet), skip_pid, TargetMode::AllExcept, title, wait_for_players});
   }
   m_chunked_data_event.Set();
 }
@@ -1020,7 +1094,47 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
     else
     {
       SendToClients(spac, player.pid);
+      BroadcastPadData(spac);
+    }
+  }
+  break;
+
+  case MessageID::PadInputs:
+  {
+    InputLink* link = GetInputLink(player);
+    if (!link)
+      break;
+
+    std::vector<BroadcastInput> inputs;
+    if (!link->OnPacket(packet, inputs))
+      return 1;
+
+    sf::Packet spac;
+    spac << MessageID::PadData;
+    for (const BroadcastInput& input : inputs)
+    {
+      // If the data is not from the correct player,
+      // then disconnect them.
+      if (m_pad_map.at(input.pad) != player.pid)
+        return 1;
+
+      const GCPadStatus& pad = input.status;
+      spac << input.pad << pad.button;
+      if (!m_gba_config.at(input.pad).enabled)
+      {
+        spac << pad.analogA << pad.analogB << pad.stickX << pad.stickY << pad.substickX
+             << pad.substickY << pad.triggerLeft << pad.triggerRight << pad.isConnected;
+      }
+    }
+
+    if (!inputs.empty())
+    {
+      SendPadInputs(inputs, player.pid);
+      BroadcastPadData(spac);
     }
+    // The other players were sent the inputs, the player is only sent the acknowledgement
+    if (link->IsAckNeeded())
+      Send(player.socket, link->MakePacket(), INPUT_CHANNEL);
   }
   break;
 
@@ -1052,6 +1166,17 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
     }
 
     SendToClients(spac, player.pid);
+    BroadcastPadData(spac);
+  }
+  break;
+
+  case MessageID::BroadcastKeyframe:
+  {
+    if (!player.IsHost())
+      return 1;
+
+    if (m_broadcast)
+      m_broadcast->SendMessage(packet);
   }
   break;
 
@@ -1160,6 +1285,7 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
     if (m_ping_key == ping_key)
     {
       player.ping = ping;
+      m_buffer_controller.AddSample(player.pid, ping);
     }
 
     sf::Packet spac;
@@ -1270,18 +1396,17 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
   }
   break;
 
-  case MessageID::Checksum:
+  case MessageID::DesyncHash:
+  case MessageID::DesyncNodes:
+  case MessageID::DesyncBlocks:
   {
-    u32 inChecksum;
-    u8 checksumId;
-    packet >> inChecksum;
-    packet >> checksumId;
-
+    // Compared by the clients, which also find where they differ among themselves
     sf::Packet spac;
-    spac << MessageID::Checksum;
-    spac << inChecksum;
-    spac << checksumId;
-    SendToClients(spac);
+    spac << mid;
+    spac << player.pid;
+    spac.append(static_cast<const u8*>(packet.getData()) + sizeof(MessageID),
+                packet.getDataSize() - sizeof(MessageID));
+    SendToClients(spac, player.pid);
   }
   break;
 
@@ -1339,6 +1464,11 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
     {
     case SyncSaveDataID::Success:
     {
+      {
+        std::lock_guard lkp(m_crit.players);
+        player.sync_blocks = m_sync_blocks;
+      }
+
       if (m_start_pending)
       {
         m_save_data_synced_players++;
@@ -1370,6 +1500,9 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
       m_dialog->AppendChat(Common::FmtFormatT("{0} failed to synchronize.", player.name));
       m_dialog->OnGameStartAborted();
       ChunkedDataAbort();
+
+      std::lock_guard lkp(m_crit.players);
+      player.sync_blocks.clear();
       m_start_pending = false;
     }
     break;
@@ -1497,7 +1630,7 @@ bool NetPlayServer::ChangeGame(const SyncIdentifier& sync_identifier,
   // send changed game to clients
   sf::Packet spac;
   spac << MessageID::ChangeGame;
-  SendSyncIdentifier(spac, m_selected_game_identifier);
+  WriteSyncIdentifier(spac, m_selected_game_identifier);
   spac << m_selected_game_name;
 
   SendAsyncToClients(std::move(spac));
@@ -1510,7 +1643,7 @@ bool NetPlayServer::ComputeGameDigest(const SyncIdentifier& sync_identifier)
 {
   sf::Packet spac;
   spac << MessageID::ComputeGameDigest;
-  SendSyncIdentifier(spac, sync_identifier);
+  WriteSyncIdentifier(spac, sync_identifier);
 
   SendAsyncToClients(std::move(spac));
 
@@ -1527,28 +1660,13 @@ bool NetPlayServer::AbortGameDigest()
   return true;
 }
 
-// called from ---GUI--- thread
-bool NetPlayServer::SetupNetSettings()
+NetSettings GetNetSettingsFromConfig(const std::string& game_id, u16 revision)
 {
-  const auto game = m_dialog->FindGameFile(m_selected_game_identifier);
-  if (game == nullptr)
-  {
-    ERROR_LOG_FMT(NETPLAY, "Game {:02x} not found in game list.",
-                  fmt::join(m_selected_game_identifier.sync_hash, ""));
-    PanicAlertFmtT("Selected game doesn't exist in game list!");
-    return false;
-  }
-
-  INFO_LOG_FMT(NETPLAY, "Loading game settings for {:02x}.",
-               fmt::join(m_selected_game_identifier.sync_hash, ""));
-
   NetPlay::NetSettings settings;
 
   // Load GameINI so we can sync the settings from it
-  Config::AddLayer(
-      ConfigLoaders::GenerateGlobalGameConfigLoader(game->GetGameID(), game->GetRevision()));
-  Config::AddLayer(
-      ConfigLoaders::GenerateLocalGameConfigLoader(game->GetGameID(), game->GetRevision()));
+  Config::AddLayer(ConfigLoaders::GenerateGlobalGameConfigLoader(game_id, revision));
+  Config::AddLayer(ConfigLoaders::GenerateLocalGameConfigLoader(game_id, revision));
 
   // Copy all relevant settings
   settings.cpu_thread = Config::Get(Config::MAIN_CPU_THREAD);
@@ -1618,8 +1736,8 @@ bool NetPlayServer::SetupNetSettings()
   settings.fast_disc_speed = Config::Get(Config::MAIN_FAST_DISC_SPEED);
   settings.mmu = Config::Get(Config::MAIN_MMU);
   settings.fastmem = Config::Get(Config::MAIN_FASTMEM);
-  settings.skip_ipl = Config::Get(Config::MAIN_SKIP_IPL) || !DoAllPlayersHaveIPLDump();
-  settings.load_ipl_dump = Config::Get(Config::SESSION_LOAD_IPL_DUMP) && DoAllPlayersHaveIPLDump();
+  settings.skip_ipl = Config::Get(Config::MAIN_SKIP_IPL);
+  settings.load_ipl_dump = Config::Get(Config::SESSION_LOAD_IPL_DUMP);
   settings.vertex_rounding = Config::Get(Config::GFX_HACK_VERTEX_ROUNDING);
   settings.internal_resolution = Config::Get(Config::GFX_EFB_SCALE);
   settings.efb_scaled_copy = Config::Get(Config::GFX_HACK_COPY_EFB_SCALED);
@@ -1647,13 +1765,43 @@ bool NetPlayServer::SetupNetSettings()
   settings.strict_settings_sync = Config::Get(Config::NETPLAY_STRICT_SETTINGS_SYNC);
   settings.sync_codes = true;
   settings.golf_mode = Config::Get(Config::NETPLAY_NETWORK_MODE) == "golf";
-  settings.use_fma = DoAllPlayersHaveHardwareFMA();
   settings.hide_remote_gbas = Config::Get(Config::NETPLAY_HIDE_REMOTE_GBAS);
+  settings.rollback_frames = Config::Get(Config::NETPLAY_NETWORK_MODE) == "rollback" ?
+                                 std::max(Config::Get(Config::NETPLAY_ROLLBACK_FRAMES), 1u) :
+                                 0;
+  settings.desync_regions = Config::Get(Config::NETPLAY_DESYNC_REGIONS);
+  // Golf mode sends inputs through a single player
+  settings.redundant_inputs = Config::Get(Config::NETPLAY_REDUNDANT_INPUTS) && !settings.golf_mode;
 
   // Unload GameINI to restore things to normal
   Config::RemoveLayer(Config::LayerType::GlobalGame);
   Config::RemoveLayer(Config::LayerType::LocalGame);
 
+  return settings;
+}
+
+// called from ---GUI--- thread
+bool NetPlayServer::SetupNetSettings()
+{
+  const auto game = m_dialog->FindGameFile(m_selected_game_identifier);
+  if (game == nullptr)
+  {
+    ERROR_LOG_FMT(NETPLAY, "Game {:02x} not found in game list.",
+                  fmt::join(m_selected_game_identifier.sync_hash, ""));
+    PanicAlertFmtT("Selected game doesn't exist in game list!");
+    return false;
+  }
+
+  INFO_LOG_FMT(NETPLAY, "Loading game settings for {:02x}.",
+               fmt::join(m_selected_game_identifier.sync_hash, ""));
+
+  NetPlay::NetSettings settings = GetNetSettingsFromConfig(game->GetGameID(), game->GetRevision());
+  settings.skip_ipl = settings.skip_ipl || !DoAllPlayersHaveIPLDump();
+  settings.load_ipl_dump = settings.load_ipl_dump && DoAllPlayersHaveIPLDump();
+  settings.use_fma = DoAllPlayersHaveHardwareFMA();
+  // Host input authority sends inputs through the host
+  settings.redundant_inputs = settings.redundant_inputs && !m_host_input_authority;
+
   m_settings = settings;
 
   return true;
@@ -1748,6 +1896,100 @@ bool NetPlayServer::RequestStartGame()
   return true;
 }
 
+sf::Packet MakeStartGamePacket(u32 game, const NetSettings& settings, u64 initial_rtc,
+                               const std::string& region)
+{
+  sf::Packet spac;
+  spac << MessageID::StartGame;
+  spac << game;
+  spac << settings.cpu_thread;
+  spac << settings.cpu_core;
+  spac << settings.enable_cheats;
+  spac << settings.selected_language;
+  spac << settings.override_region_settings;
+  spac << settings.dsp_enable_jit;
+  spac << settings.dsp_hle;
+  spac << settings.ram_override_enable;
+  spac << settings.mem1_size;
+  spac << settings.mem2_size;
+  spac << settings.fallback_region;
+  spac << settings.allow_sd_writes;
+  spac << settings.oc_enable;
+  spac << settings.oc_factor;
+
+  for (auto slot : ExpansionInterface::SLOTS)
+    spac << static_cast<int>(settings.exi_device[slot]);
+
+  spac << settings.memcard_size_override;
+
+  for (u32 value : settings.sysconf_settings)
+    spac << value;
+
+  spac << settings.efb_access_enable;
+  spac << settings.bbox_enable;
+  spac << settings.force_progressive;
+  spac << settings.efb_to_texture_enable;
+  spac << settings.xfb_to_texture_enable;
+  spac << settings.disable_copy_to_vram;
+  spac << settings.immediate_xfb_enable;
+  spac << settings.efb_emulate_format_changes;
+  spac << settings.safe_texture_cache_color_samples;
+  spac << settings.perf_queries_enable;
+  spac << settings.float_exceptions;
+  spac << settings.divide_by_zero_exceptions;
+  spac << settings.fprf;
+  spac << settings.accurate_nans;
+  spac << settings.disable_icache;
+  spac << settings.sync_on_skip_idle;
+  spac << settings.sync_gpu;
+  spac << settings.sync_gpu_max_distance;
+  spac << settings.sync_gpu_min_distance;
+  spac << settings.sync_gpu_overclock;
+  spac << settings.jit_follow_branch;
+  spac << settings.fast_disc_speed;
+  spac << settings.mmu;
+  spac << settings.fastmem;
+  spac << settings.skip_ipl;
+  spac << settings.load_ipl_dump;
+  spac << settings.vertex_rounding;
+  spac << settings.internal_resolution;
+  spac << settings.efb_scaled_copy;
+  spac << settings.fast_depth_calc;
+  spac << settings.enable_pixel_lighting;
+  spac << settings.widescreen_hack;
+  spac << settings.force_texture_filtering;
+  spac << settings.max_anisotropy;
+  spac << settings.force_true_color;
+  spac << settings.disable_copy_filter;
+  spac << settings.disable_fog;
+  spac << settings.arbitrary_mipmap_detection;
+  spac << settings.arbitrary_mipmap_detection_threshold;
+  spac << settings.enable_gpu_texture_decoding;
+  spac << settings.defer_efb_copies;
+  spac << settings.efb_access_tile_size;
+  spac << settings.efb_access_defer_invalidation;
+  spac << settings.savedata_load;
+  spac << settings.savedata_write;
+  spac << settings.savedata_sync_all_wii;
+  spac << settings.strict_settings_sync;
+  spac << static_cast<sf::Uint64>(initial_rtc);
+  spac << region;
+  spac << settings.sync_codes;
+
+  spac << settings.golf_mode;
+  spac << settings.use_fma;
+  spac << settings.hide_remote_gbas;
+  spac << settings.rollback_frames;
+  spac << settings.desync_regions;
+  spac << settings.redundant_inputs;
+
+  const u8* sram = reinterpret_cast<const u8*>(&settings.sram);
+  for (size_t i = 0; i < sizeof(settings.sram); ++i)
+    spac << sram[i];
+
+  return spac;
+}
+
 // called from multiple threads
 bool NetPlayServer::StartGame()
 {
@@ -1759,9 +2001,18 @@ bool NetPlayServer::StartGame()
   // only used as an identifier, not time value, so truncation is fine
   m_current_game = static_cast<u32>(Common::Timer::NowMs());
 
-  // no change, just update with clients
   if (!m_host_input_authority)
-    AdjustPadBufferSize(m_target_buffer_size);
+  {
+    // A game starts with the buffer that its players need, without waiting for it to be raised
+    std::optional<PadBufferController::Decision> needed;
+    if (IsAutoPadBufferEnabled())
+      needed = m_buffer_controller.GetNeeded(GetPlayersWithPads());
+
+    if (needed)
+      SetPadBufferSize(needed->buffer, PadBufferController::MIN_BUFFER);
+    else
+      AdjustPadBufferSize(m_target_buffer_size);
+  }
 
   m_current_golfer = 1;
   m_pending_golfer = 0;
@@ -1776,91 +2027,7 @@ bool NetPlayServer::StartGame()
   InitSRAM(&m_settings.sram, SConfig::GetInstance().m_strSRAM);
 
   // tell clients to start game
-  sf::Packet spac;
-  spac << MessageID::StartGame;
-  spac << m_current_game;
-  spac << m_settings.cpu_thread;
-  spac << m_settings.cpu_core;
-  spac << m_settings.enable_cheats;
-  spac << m_settings.selected_language;
-  spac << m_settings.override_region_settings;
-  spac << m_settings.dsp_enable_jit;
-  spac << m_settings.dsp_hle;
-  spac << m_settings.ram_override_enable;
-  spac << m_settings.mem1_size;
-  spac << m_settings.mem2_size;
-  spac << m_settings.fallback_region;
-  spac << m_settings.allow_sd_writes;
-  spac << m_settings.oc_enable;
-  spac << m_settings.oc_factor;
-
-  for (auto slot : ExpansionInterface::SLOTS)
-    spac << static_cast<int>(m_settings.exi_device[slot]);
-
-  spac << m_settings.memcard_size_override;
-
-  for (u32 value : m_settings.sysconf_settings)
-    spac << value;
-
-  spac << m_settings.efb_access_enable;
-  spac << m_settings.bbox_enable;
-  spac << m_settings.force_progressive;
-  spac << m_settings.efb_to_texture_enable;
-  spac << m_settings.xfb_to_texture_enable;
-  spac << m_settings.disable_copy_to_vram;
-  spac << m_settings.immediate_xfb_enable;
-  spac << m_settings.efb_emulate_format_changes;
-  spac << m_settings.safe_texture_cache_color_samples;
-  spac << m_settings.perf_queries_enable;
-  spac << m_settings.float_exceptions;
-  spac << m_settings.divide_by_zero_exceptions;
-  spac << m_settings.fprf;
-  spac << m_settings.accurate_nans;
-  spac << m_settings.disable_icache;
-  spac << m_settings.sync_on_skip_idle;
-  spac << m_settings.sync_gpu;
-  spac << m_settings.sync_gpu_max_distance;
-  spac << m_settings.sync_gpu_min_distance;
-  spac << m_settings.sync_gpu_overclock;
-  spac << m_settings.jit_follow_branch;
-  spac << m_settings.fast_disc_speed;
-  spac << m_settings.mmu;
-  spac << m_settings.fastmem;
-  spac << m_settings.skip_ipl;
-  spac << m_settings.load_ipl_dump;
-  spac << m_settings.vertex_rounding;
-  spac << m_settings.internal_resolution;
-  spac << m_settings.efb_scaled_copy;
-  spac << m_settings.fast_depth_calc;
-  spac << m_settings.enable_pixel_lighting;
-  spac << m_settings.widescreen_hack;
-  spac << m_settings.force_texture_filtering;
-  spac << m_settings.max_anisotropy;
-  spac << m_settings.force_true_color;
-  spac << m_settings.disable_copy_filter;
-  spac << m_settings.disable_fog;
-  spac << m_settings.arbitrary_mipmap_detection;
-  spac << m_settings.arbitrary_mipmap_detection_threshold;
-  spac << m_settings.enable_gpu_texture_decoding;
-  spac << m_settings.defer_efb_copies;
-  spac << m_settings.efb_access_tile_size;
-  spac << m_settings.efb_access_defer_invalidation;
-  spac << m_settings.savedata_load;
-  spac << m_settings.savedata_write;
-  spac << m_settings.savedata_sync_all_wii;
-  spac << m_settings.strict_settings_sync;
-  spac << initial_rtc;
-  spac << region;
-  spac << m_settings.sync_codes;
-
-  spac << m_settings.golf_mode;
-  spac << m_settings.use_fma;
-  spac << m_settings.hide_remote_gbas;
-
-  for (size_t i = 0; i < sizeof(m_settings.sram); ++i)
-    spac << m_settings.sram[i];
-
-  SendAsyncToClients(std::move(spac));
+  SendAsyncToClients(MakeStartGamePacket(m_current_game, m_settings, initial_rtc, region));
 
   m_start_pending = false;
   m_is_running = true;
@@ -2008,6 +2175,42 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
   if (sync_info.save_count == 0)
     return true;
 
+  // Blocks that every player kept from the last sync are not sent again
+  std::set<SyncBlockHash> known_blocks;
+  {
+    std::lock_guard lkp(m_crit.players);
+    bool first_player = true;
+    for (const auto& [pid, player] : m_players)
+    {
+      if (player.IsHost())
+        continue;
+      if (first_player)
+      {
+        known_blocks = player.sync_blocks;
+        first_player = false;
+      }
+      else
+      {
+        std::erase_if(known_blocks, [&player](const SyncBlockHash& hash) {
+          return !player.sync_blocks.contains(hash);
+        });
+      }
+    }
+  }
+
+  // The blocks are sent as they are compressed, and the saves that refer to them once all of them
+  // have been sent
+  SyncBlockWriter writer(
+      [this](sf::Packet&& blocks) {
+        sf::Packet pac;
+        pac << MessageID::SyncSaveData;
+        pac << SyncSaveDataID::Blocks;
+        pac.append(blocks.getData(), blocks.getDataSize());
+        SendChunkedToClients(std::move(pac), 1, "Save Data Synchronization", false);
+      },
+      std::move(known_blocks));
+  std::vector<std::pair<sf::Packet, std::string>> saves;
+
   const auto game_region = sync_info.game->GetRegion();
   const auto gamecube_region = Config::ToGameCubeRegion(game_region);
   const std::string region = Config::GetDirectoryForRegion(gamecube_region);
@@ -2034,7 +2237,7 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
       {
         INFO_LOG_FMT(NETPLAY, "Sending data of raw memcard {} in slot {}.", path,
                      is_slot_a ? 'A' : 'B');
-        if (!CompressFileIntoPacket(path, pac))
+        if (!writer.WriteFile(path, pac))
           return false;
       }
       else
@@ -2045,8 +2248,8 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
         pac << sf::Uint64{0};
       }
 
-      SendChunkedToClients(std::move(pac), 1,
-                           fmt::format("Memory Card {} Synchronization", is_slot_a ? 'A' : 'B'));
+      saves.emplace_back(std::move(pac),
+                         fmt::format("Memory Card {} Synchronization", is_slot_a ? 'A' : 'B'));
     }
     else if (Config::Get(Config::GetInfoForEXIDevice(slot)) ==
              ExpansionInterface::EXIDeviceType::MemoryCardFolder)
@@ -2073,7 +2276,7 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
           const std::string filename = file.substr(file.find_last_of('/') + 1);
           INFO_LOG_FMT(NETPLAY, "Sending GCI {}.", filename);
           pac << filename;
-          if (!CompressFileIntoPacket(file, pac))
+          if (!writer.WriteFile(file, pac))
             return false;
         }
       }
@@ -2085,8 +2288,8 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
         pac << static_cast<u8>(0);
       }
 
-      SendChunkedToClients(std::move(pac), 1,
-                           fmt::format("GCI Folder {} Synchronization", is_slot_a ? 'A' : 'B'));
+      saves.emplace_back(std::move(pac),
+                         fmt::format("GCI Folder {} Synchronization", is_slot_a ? 'A' : 'B'));
     }
   }
 
@@ -2101,7 +2304,7 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
     {
       INFO_LOG_FMT(NETPLAY, "Sending Mii data.");
       pac << true;
-      if (!CompressBufferIntoPacket(*sync_info.mii_data, pac))
+      if (!writer.WriteBuffer(*sync_info.mii_data, pac))
         return false;
     }
     else
@@ -2162,7 +2365,7 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
           if (file.type == WiiSave::Storage::SaveFile::Type::File)
           {
             const std::optional<std::vector<u8>>& data = *file.data;
-            if (!data || !CompressBufferIntoPacket(*data, pac))
+            if (!data || !writer.WriteBuffer(*data, pac))
               return false;
           }
         }
@@ -2179,7 +2382,7 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
       INFO_LOG_FMT(NETPLAY, "Sending redirected save at {}.",
                    sync_info.redirected_save->m_target_path);
       pac << true;
-      if (!CompressFolderIntoPacket(sync_info.redirected_save->m_target_path, pac))
+      if (!writer.WriteFolder(sync_info.redirected_save->m_target_path, pac))
         return false;
     }
     else
@@ -2188,7 +2391,7 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
       pac << false;  // no redirected save
     }
 
-    SendChunkedToClients(std::move(pac), 1, "Wii Save Synchronization");
+    saves.emplace_back(std::move(pac), "Wii Save Synchronization");
   }
 
   for (size_t i = 0; i < m_gba_config.size(); ++i)
@@ -2208,7 +2411,7 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
       if (File::Exists(path))
       {
         INFO_LOG_FMT(NETPLAY, "Sending data of GBA save at {} for slot {}.", path, i);
-        if (!CompressFileIntoPacket(path, pac))
+        if (!writer.WriteFile(path, pac))
           return false;
       }
       else
@@ -2218,11 +2421,27 @@ bool NetPlayServer::SyncSaveData(const SaveSyncInfo& sync_info)
         pac << sf::Uint64{0};
       }
 
-      SendChunkedToClients(std::move(pac), 1,
-                           fmt::format("GBA{} Save File Synchronization", i + 1));
+      saves.emplace_back(std::move(pac), fmt::format("GBA{} Save File Synchronization", i + 1));
     }
   }
 
+  if (!writer.Finish())
+    return false;
+
+  const SyncBlockWriter::Stats& stats = writer.GetStats();
+  INFO_LOG_FMT(NETPLAY,
+               "Sending {} bytes of save data as {} unique bytes, {} of which players already "
+               "have, compressed to {}.",
+               stats.bytes, stats.unique_bytes, stats.known_bytes, stats.compressed_bytes);
+
+  {
+    std::lock_guard lkp(m_crit.players);
+    m_sync_blocks = writer.GetBlocks();
+  }
+
+  for (auto& [pac, title] : saves)
+    SendChunkedToClients(std::move(pac), 1, title);
+
   return true;
 }
 
@@ -2399,7 +2618,7 @@ void NetPlayServer::CheckSyncAndStartGame()
   }
 }
 
-u64 NetPlayServer::GetInitialNetPlayRTC() const
+u64 GetInitialNetPlayRTC()
 {
   if (Config::Get(Config::MAIN_CUSTOM_RTC_ENABLE))
     return Config::Get(Config::MAIN_CUSTOM_RTC_VALUE);
@@ -2407,10 +2626,47 @@ u64 NetPlayServer::GetInitialNetPlayRTC() const
   return Common::Timer::GetLocalTimeSinceJan1970();
 }
 
+// What spectators of a broadcast are sent, besides inputs
+static bool IsBroadcastMessage(MessageID mid)
+{
+  switch (mid)
+  {
+  case MessageID::PlayerJoin:
+  case MessageID::PlayerLeave:
+  case MessageID::ChatMessage:
+  case MessageID::GameMode:
+  case MessageID::PadMapping:
+  case MessageID::PadBuffer:
+  case MessageID::GBAConfig:
+  case MessageID::WiimoteMapping:
+  case MessageID::HostInputAuthority:
+  case MessageID::ChangeGame:
+  case MessageID::StartGame:
+  case MessageID::StopGame:
+  case MessageID::DisableGame:
+  case MessageID::SyncCodes:
+  case MessageID::SendCodes:
+  case MessageID::NightStadium:
+  case MessageID::GameID:
+  case MessageID::Stadium:
+  case MessageID::DisableReplays:
+  case MessageID::Course:
+    return true;
+  default:
+    return false;
+  }
+}
+
 // called from multiple threads
 void NetPlayServer::SendToClients(const sf::Packet& packet, const PlayerId skip_pid,
                                   const u8 channel_id)
 {
+  if (m_broadcast && packet.getDataSize() != 0 &&
+      IsBroadcastMessage(static_cast<MessageID>(static_cast<const u8*>(packet.getData())[0])))
+  {
+    m_broadcast->SendMessage(packet);
+  }
+
   for (auto& p : m_players)
   {
     if (p.second.pid && p.second.pid != skip_pid)
@@ -2420,9 +2676,145 @@ void NetPlayServer::SendToClients(const sf::Packet& packet, const PlayerId skip_
   }
 }
 
+// called from ---NETPLAY--- thread
+void NetPlayServer::UpdateBroadcast()
+{
+  const BroadcastSource::Events events = m_broadcast->Update();
+  if (events.connected)
+    SendBroadcastSnapshot();
+
+  // Keyframes are taken by the client of the host
+  if (events.keyframe_requested)
+  {
+    std::lock_guard lkp(m_crit.players);
+    const auto host = m_players.find(1);
+    if (host != m_players.end())
+    {
+      sf::Packet spac;
+      spac << MessageID::BroadcastKeyframeRequest;
+      Send(host->second.socket, spac);
+    }
+  }
+
+  if (events.disconnected)
+    m_dialog->AppendChat(Common::GetStringT("Lost the connection to the broadcast relay."));
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayServer::SendBroadcastSnapshot()
+{
+  // The relay learns of everything after this from the messages to the players
+  std::lock_guard lkg(m_crit.game);
+  std::lock_guard lkp(m_crit.players);
+  for (const auto& [pid, player] : m_players)
+  {
+    sf::Packet spac;
+    spac << MessageID::PlayerJoin << pid << player.name << player.riokey << player.revision;
+    m_broadcast->SendMessage(spac);
+  }
+
+  if (!m_selected_game_name.empty())
+  {
+    sf::Packet spac;
+    spac << MessageID::ChangeGame;
+    WriteSyncIdentifier(spac, m_selected_game_identifier);
+    spac << m_selected_game_name;
+    m_broadcast->SendMessage(spac);
+  }
+
+  sf::Packet buffer_packet;
+  buffer_packet << MessageID::PadBuffer << m_target_buffer_size;
+  m_broadcast->SendMessage(buffer_packet);
+
+  sf::Packet authority_packet;
+  authority_packet << MessageID::HostInputAuthority << m_host_input_authority;
+  m_broadcast->SendMessage(authority_packet);
+
+  sf::Packet mode_packet;
+  mode_packet << MessageID::GameMode << m_tagset_id.has_value() << m_tagset_id.value_or(0);
+  m_broadcast->SendMessage(mode_packet);
+
+  sf::Packet night_packet;
+  night_packet << MessageID::NightStadium << m_current_night_value;
+  m_broadcast->SendMessage(night_packet);
+
+  sf::Packet replays_packet;
+  replays_packet << MessageID::DisableReplays << m_current_disable_replays_value;
+  m_broadcast->SendMessage(replays_packet);
+
+  UpdatePadMapping();
+  UpdateGBAConfig();
+  UpdateWiimoteMapping();
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayServer::BroadcastPadData(sf::Packet& packet)
+{
+  if (!m_broadcast)
+    return;
+
+  // The same packet as the players are sent, the inputs in the order they are used in
+  MessageID mid;
+  packet >> mid;
+  while (!packet.endOfPacket())
+  {
+    PadIndex map;
+    packet >> map;
+
+    GCPadStatus pad;
+    packet >> pad.button;
+    if (!m_gba_config.at(map).enabled)
+    {
+      packet >> pad.analogA >> pad.analogB >> pad.stickX >> pad.stickY >> pad.substickX >>
+          pad.substickY >> pad.triggerLeft >> pad.triggerRight >> pad.isConnected;
+    }
+    m_broadcast->AddInput(map, pad);
+  }
+}
+
+// called from ---NETPLAY--- thread
+InputLink* NetPlayServer::GetInputLink(Client& player)
+{
+  if (!m_settings.redundant_inputs)
+    return nullptr;
+
+  // Made for the first packet of a game, which may be one to the player
+  if (!player.input_link || player.input_link->GetGame() != m_current_game)
+    player.input_link = std::make_unique<InputLink>(m_current_game);
+  return player.input_link.get();
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayServer::SendPadInputs(std::span<const BroadcastInput> inputs, const PlayerId skip_pid)
+{
+  for (auto& [pid, player] : m_players)
+  {
+    if (!pid || pid == skip_pid)
+      continue;
+
+    InputLink* link = GetInputLink(player);
+    for (const BroadcastInput& input : inputs)
+      link->AddInput(input.pad, input.status);
+    Send(player.socket, link->MakePacket(), INPUT_CHANNEL);
+  }
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayServer::ResendPadInputs()
+{
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard lkp(m_crit.players);
+  for (auto& [pid, player] : m_players)
+  {
+    InputLink* link = player.input_link.get();
+    if (link && link->GetGame() == m_current_game && link->NeedsResend(now))
+      Send(player.socket, link->MakePacket(), INPUT_CHANNEL);
+  }
+}
+
 void NetPlayServer::Send(ENetPeer* socket, const sf::Packet& packet, const u8 channel_id)
 {
-  Common::ENet::SendPacket(socket, packet, channel_id);
+  Common::ENet::SendPacket(socket, packet, channel_id, GetChannelFlags(channel_id));
 }
 
 void NetPlayServer::KickPlayer(PlayerId player)
@@ -2619,7 +3011,7 @@ void NetPlayServer::ChunkedDataThreadFunc()
 
         ChunkedDataSend(std::move(pac), e.target_pid, e.target_mode);
 
-        if (e.target_mode == TargetMode::AllExcept && e.target_pid == 1)
+        if (e.target_mode == TargetMode::AllExcept && e.target_pid == 1 && e.wait_for_players)
           m_dialog->ShowChunkedProgressDialog(e.title, e.packet.getDataSize(), players);
       }
 
@@ -2683,11 +3075,15 @@ void NetPlayServer::ChunkedDataThreadFunc()
         ChunkedDataSend(std::move(pac), e.target_pid, e.target_mode);
       }
 
-      while (m_chunked_data_complete_count[id] < player_count && m_do_loop &&
-             !m_abort_chunked_data && !skip_wait)
-        m_chunked_data_complete_event.Wait();
+      if (e.wait_for_players)
+      {
+        while (m_chunked_data_complete_count[id] < player_count && m_do_loop &&
+               !m_abort_chunked_data && !skip_wait)
+          m_chunked_data_complete_event.Wait();
+      }
       m_chunked_data_complete_count.erase(id);
-      m_dialog->HideChunkedProgressDialog();
+      if (e.wait_for_players)
+        m_dialog->HideChunkedProgressDialog();
 
       m_chunked_data_queue.Pop();
     }
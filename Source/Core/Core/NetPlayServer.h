@@ -10,25 +10,33 @@
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <set>
+#include <span>
 #include <sstream>
+#include <string>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <optional>
+#include <vector>
 
 #include "Common/Event.h"
 #include "Common/QoSSession.h"
 #include "Common/SPSCQueue.h"
 #include "Common/Timer.h"
 #include "Common/TraversalClient.h"
+#include "Core/NetPlayInputTransport.h"
+#include "Core/NetPlayPadBuffer.h"
 #include "Core/NetPlayProto.h"
+#include "Core/NetPlaySyncBlocks.h"
 #include "Core/SyncIdentifier.h"
 #include "InputCommon/GCPadStatus.h"
 #include "UICommon/NetPlayIndex.h"
 
 namespace NetPlay
 {
+class BroadcastSource;
 class NetPlayUI;
 struct SaveSyncInfo;
 
@@ -40,8 +48,10 @@ public:
   void SendAsyncToClients(sf::Packet&& packet, PlayerId skip_pid = 0,
                           u8 channel_id = DEFAULT_CHANNEL);
   void SendChunked(sf::Packet&& packet, PlayerId pid, const std::string& title = "");
+  // With wait_for_players unset, the next entry is sent right after this one instead of once
+  // every player has received it
   void SendChunkedToClients(sf::Packet&& packet, PlayerId skip_pid = 0,
-                            const std::string& title = "");
+                            const std::string& title = "", bool wait_for_players = true);
 
   NetPlayServer(u16 port, bool forward_port, NetPlayUI* dialog,
                 const NetTraversalConfig& traversal_config);
@@ -84,6 +94,9 @@ public:
   bool is_connected = false;
 
 private:
+  // The buffer is never set below this by hand, only when it is picked automatically
+  static constexpr u32 MIN_PAD_BUFFER_SIZE = 8;
+
   class Client
   {
   public:
@@ -98,9 +111,14 @@ private:
     ENetPeer* socket = nullptr;
     u32 ping = 0;
     u32 current_game = 0;
+    // Of the current game if inputs are redundant, see GetInputLink
+    std::unique_ptr<InputLink> input_link;
 
     Common::QoSSession qos_session;
 
+    // Of the last save data sync the player completed, which the player keeps for the next one
+    std::set<SyncBlockHash> sync_blocks;
+
     bool operator==(const Client& other) const { return this == &other; }
     bool IsHost() const { return pid == 1; }
   };
@@ -125,6 +143,7 @@ private:
     PlayerId target_pid{};
     TargetMode target_mode{};
     std::string title;
+    bool wait_for_players = true;
   };
 
   bool SetupNetSettings();
@@ -133,8 +152,6 @@ private:
   bool SyncCodes();
   void CheckSyncAndStartGame();
 
-  u64 GetInitialNetPlayRTC() const;
-
   template <typename... Data>
   void SendResponseToPlayer(const Client& player, const MessageID message_id,
                             Data&&... data_to_send);
@@ -142,6 +159,16 @@ private:
   void SendResponseToAllPlayers(const MessageID message_id, Data&&... data_to_send);
   void SendToClients(const sf::Packet& packet, PlayerId skip_pid = 0,
                      u8 channel_id = DEFAULT_CHANNEL);
+  void UpdateBroadcast();
+  void SendBroadcastSnapshot();
+  void BroadcastPadData(sf::Packet& packet);
+  InputLink* GetInputLink(Client& player);
+  void SendPadInputs(std::span<const BroadcastInput> inputs, PlayerId skip_pid);
+  void ResendPadInputs();
+  std::vector<PlayerId> GetPlayersWithPads() const;
+  bool IsAutoPadBufferEnabled() const;
+  void UpdateAutoPadBuffer();
+  void SetPadBufferSize(u32 size, u32 min_size);
   void Send(ENetPeer* socket, const sf::Packet& packet, u8 channel_id = DEFAULT_CHANNEL);
   ConnectionError OnConnect(ENetPeer* socket, sf::Packet& received_packet);
   unsigned int OnDisconnect(const Client& player);
@@ -177,10 +204,14 @@ private:
   bool m_update_pings = false;
   u32 m_current_game = 0;
   unsigned int m_target_buffer_size = 0;
+  // Fed by every ping, used when the buffer is picked automatically
+  PadBufferController m_buffer_controller;
   PadMappingArray m_pad_map;
   GBAConfigArray m_gba_config;
   PadMappingArray m_wiimote_map;
   unsigned int m_save_data_synced_players = 0;
+  // Of the current save data sync
+  std::set<SyncBlockHash> m_sync_blocks;
   unsigned int m_codes_synced_players = 0;
   bool m_saves_synced = true;
   bool m_codes_synced = true;
@@ -222,7 +253,18 @@ private:
 
   ENetHost* m_server = nullptr;
   Common::TraversalClient* m_traversal_client = nullptr;
+  // Only if games are broadcast to a relay
+  std::unique_ptr<BroadcastSource> m_broadcast;
   NetPlayUI* m_dialog = nullptr;
   NetPlayIndex m_index;
 };
+
+// Shared with the dedicated host, which runs sessions without a NetPlayServer
+void WriteSyncIdentifier(sf::Packet& spac, const SyncIdentifier& sync_identifier);
+// The settings of the config and the INIs of a game. Those that depend on what every player has,
+// like an IPL dump, are left to the caller.
+NetSettings GetNetSettingsFromConfig(const std::string& game_id, u16 revision);
+u64 GetInitialNetPlayRTC();
+sf::Packet MakeStartGamePacket(u32 game, const NetSettings& settings, u64 initial_rtc,
+                               const std::string& region);
 }  // namespace NetPlay
@@ -0,0 +1,373 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "Core/NetPlaySyncBlocks.h"
+
+#include <algorithm>
+
+#include <fmt/format.h>
+#include <xxhash.h>
+#include <zstd.h>
+
+#include "Common/FileUtil.h"
+#include "Common/IOFile.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
+#include "Common/SFMLHelper.h"
+#include "Common/Swap.h"
+
+namespace NetPlay
+{
+// Whether the block is compressed, its hash, its size and the size it is sent with
+constexpr size_t FRAME_HEADER_SIZE = sizeof(u8) + 2 * sizeof(u64) + 2 * sizeof(u32);
+
+SyncBlockHash HashSyncBlock(std::span<const u8> data)
+{
+  const XXH128_hash_t hash = XXH3_128bits(data.data(), data.size());
+  return {hash.high64, hash.low64};
+}
+
+static void WriteHash(const SyncBlockHash& hash, sf::Packet& packet)
+{
+  packet << static_cast<sf::Uint64>(hash.high) << static_cast<sf::Uint64>(hash.low);
+}
+
+static SyncBlockHash ReadHash(sf::Packet& packet)
+{
+  SyncBlockHash hash;
+  hash.high = Common::PacketReadU64(packet);
+  hash.low = Common::PacketReadU64(packet);
+  return hash;
+}
+
+struct SyncBlockWriter::CompressState
+{
+  ~CompressState() { ZSTD_freeCCtx(context); }
+
+  ZSTD_CCtx* context = nullptr;
+};
+
+SyncBlockWriter::SyncBlockWriter(BatchCallback on_batch, std::set<SyncBlockHash> known_blocks)
+    : m_on_batch(std::move(on_batch)), m_known(std::move(known_blocks))
+{
+  const auto set_up = [](CompressState* state) {
+    state->context = ZSTD_createCCtx();
+    return state->context ? DiscIO::ConversionResultCode::Success :
+                            DiscIO::ConversionResultCode::InternalError;
+  };
+
+  const auto compress = [](CompressState* state,
+                           Block block) -> DiscIO::ConversionResult<Frame> {
+    Frame frame;
+    frame.hash = block.hash;
+    frame.size = static_cast<u32>(block.data.size());
+    frame.data.resize(ZSTD_compressBound(block.data.size()));
+    const size_t size =
+        ZSTD_compressCCtx(state->context, frame.data.data(), frame.data.size(), block.data.data(),
+                          block.data.size(), ZSTD_CLEVEL_DEFAULT);
+    if (ZSTD_isError(size))
+      return DiscIO::ConversionResultCode::InternalError;
+
+    // Data that does not get smaller, like already compressed files, is sent as it is
+    frame.compressed = size < block.data.size();
+    if (frame.compressed)
+      frame.data.resize(size);
+    else
+      frame.data = std::move(block.data);
+    return frame;
+  };
+
+  m_compressor = std::make_unique<Compressor>(
+      set_up, compress, [this](Frame frame) { return OutputFrame(std::move(frame)); });
+}
+
+SyncBlockWriter::~SyncBlockWriter() = default;
+
+void SyncBlockWriter::WriteBlock(std::vector<u8> block, sf::Packet& packet)
+{
+  const SyncBlockHash hash = HashSyncBlock(block);
+  WriteHash(hash, packet);
+
+  m_stats.bytes += block.size();
+  if (!m_queued.insert(hash).second)
+    return;
+
+  m_stats.unique_bytes += block.size();
+  if (m_known.contains(hash))
+  {
+    m_stats.known_bytes += block.size();
+    return;
+  }
+  m_compressor->CompressAndWrite({hash, std::move(block)});
+}
+
+bool SyncBlockWriter::WriteFile(const std::string& file_path, sf::Packet& packet)
+{
+  File::IOFile file(file_path, "rb");
+  if (!file)
+  {
+    PanicAlertFmtT("Failed to open file \"{0}\".", file_path);
+    return false;
+  }
+
+  const u64 size = file.GetSize();
+  packet << static_cast<sf::Uint64>(size);
+
+  for (u64 offset = 0; offset < size; offset += SYNC_BLOCK_SIZE)
+  {
+    std::vector<u8> block(std::min<u64>(SYNC_BLOCK_SIZE, size - offset));
+    if (!file.ReadBytes(block.data(), block.size()))
+    {
+      PanicAlertFmtT("Error reading file: {0}", file_path);
+      return false;
+    }
+    WriteBlock(std::move(block), packet);
+  }
+
+  return m_compressor->GetStatus() == DiscIO::ConversionResultCode::Success;
+}
+
+static bool WriteFolderInternal(SyncBlockWriter& writer, const File::FSTEntry& folder,
+                                sf::Packet& packet)
+{
+  packet << static_cast<sf::Uint64>(folder.children.size());
+  for (const File::FSTEntry& child : folder.children)
+  {
+    packet << child.virtualName << child.isDirectory;
+    const bool success = child.isDirectory ? WriteFolderInternal(writer, child, packet) :
+                                             writer.WriteFile(child.physicalName, packet);
+    if (!success)
+      return false;
+  }
+  return true;
+}
+
+bool SyncBlockWriter::WriteFolder(const std::string& folder_path, sf::Packet& packet)
+{
+  if (!File::IsDirectory(folder_path))
+  {
+    packet << false;
+    return true;
+  }
+
+  packet << true;
+  return WriteFolderInternal(*this, File::ScanDirectoryTree(folder_path, true), packet);
+}
+
+bool SyncBlockWriter::WriteBuffer(std::span<const u8> buffer, sf::Packet& packet)
+{
+  packet << static_cast<sf::Uint64>(buffer.size());
+
+  for (size_t offset = 0; offset < buffer.size(); offset += SYNC_BLOCK_SIZE)
+  {
+    const auto block = buffer.subspan(offset, std::min(SYNC_BLOCK_SIZE, buffer.size() - offset));
+    WriteBlock(std::vector<u8>(block.begin(), block.end()), packet);
+  }
+
+  return m_compressor->GetStatus() == DiscIO::ConversionResultCode::Success;
+}
+
+DiscIO::ConversionResultCode SyncBlockWriter::OutputFrame(Frame frame)
+{
+  m_batch << frame.compressed;
+  WriteHash(frame.hash, m_batch);
+  m_batch << frame.size << static_cast<u32>(frame.data.size());
+  m_batch.append(frame.data.data(), frame.data.size());
+  m_stats.compressed_bytes += frame.data.size();
+
+  if (m_batch.getDataSize() >= SYNC_BATCH_SIZE)
+  {
+    m_on_batch(std::move(m_batch));
+    m_batch = sf::Packet();
+  }
+
+  return DiscIO::ConversionResultCode::Success;
+}
+
+bool SyncBlockWriter::Finish()
+{
+  if (!m_finished)
+  {
+    m_compressor->Shutdown();
+    m_finished = true;
+
+    if (m_batch.getDataSize() != 0 &&
+        m_compressor->GetStatus() == DiscIO::ConversionResultCode::Success)
+    {
+      m_on_batch(std::move(m_batch));
+      m_batch = sf::Packet();
+    }
+  }
+
+  return m_compressor->GetStatus() == DiscIO::ConversionResultCode::Success;
+}
+
+struct SyncBlockReader::DecompressState
+{
+  ~DecompressState() { ZSTD_freeDCtx(context); }
+
+  ZSTD_DCtx* context = ZSTD_createDCtx();
+};
+
+SyncBlockReader::SyncBlockReader() : m_state(std::make_unique<DecompressState>())
+{
+}
+
+SyncBlockReader::~SyncBlockReader() = default;
+
+bool SyncBlockReader::AddBatch(std::span<const u8> batch)
+{
+  while (!batch.empty())
+  {
+    if (batch.size() < FRAME_HEADER_SIZE)
+      return false;
+
+    const bool compressed = batch[0] != 0;
+    const SyncBlockHash hash{Common::swap64(&batch[1]), Common::swap64(&batch[9])};
+    const u32 size = Common::swap32(&batch[17]);
+    const u32 stored_size = Common::swap32(&batch[21]);
+    batch = batch.subspan(FRAME_HEADER_SIZE);
+    if (size > SYNC_BLOCK_SIZE || stored_size > batch.size())
+      return false;
+
+    std::vector<u8> block(size);
+    if (compressed)
+    {
+      const size_t result = ZSTD_decompressDCtx(m_state->context, block.data(), block.size(),
+                                                batch.data(), stored_size);
+      if (ZSTD_isError(result) || result != size)
+        return false;
+    }
+    else
+    {
+      if (stored_size != size)
+        return false;
+      std::copy_n(batch.data(), size, block.data());
+    }
+    batch = batch.subspan(stored_size);
+
+    if (HashSyncBlock(block) != hash)
+    {
+      WARN_LOG_FMT(NETPLAY, "Received a sync block that does not match its hash.");
+      return false;
+    }
+    m_blocks.insert_or_assign(hash, std::move(block));
+  }
+
+  return true;
+}
+
+const std::vector<u8>* SyncBlockReader::ReadBlock(sf::Packet& packet, u64 remaining)
+{
+  const SyncBlockHash hash = ReadHash(packet);
+  const auto it = m_blocks.find(hash);
+  if (!packet || it == m_blocks.end() ||
+      it->second.size() != std::min<u64>(SYNC_BLOCK_SIZE, remaining))
+  {
+    WARN_LOG_FMT(NETPLAY, "Sync data refers to a block {:016x}{:016x} that was not received.",
+                 hash.high, hash.low);
+    return nullptr;
+  }
+  m_read.insert(hash);
+  return &it->second;
+}
+
+bool SyncBlockReader::ReadFile(sf::Packet& packet, const std::string& file_path)
+{
+  const u64 size = Common::PacketReadU64(packet);
+  if (size == 0)
+    return true;
+
+  File::IOFile file(file_path, "wb");
+  if (!file)
+  {
+    PanicAlertFmtT("Failed to open file \"{0}\". Verify your write permissions.", file_path);
+    return false;
+  }
+
+  for (u64 offset = 0; offset < size; offset += SYNC_BLOCK_SIZE)
+  {
+    const std::vector<u8>* block = ReadBlock(packet, size - offset);
+    if (!block)
+      return false;
+
+    if (!file.WriteBytes(block->data(), block->size()))
+    {
+      PanicAlertFmtT("Error writing file: {0}", file_path);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool SyncBlockReader::ReadFolderInternal(sf::Packet& packet, const std::string& folder_path)
+{
+  if (!File::CreateFullPath(folder_path + "/"))
+    return false;
+
+  const u64 size = Common::PacketReadU64(packet);
+  for (u64 i = 0; i < size; ++i)
+  {
+    std::string name;
+    packet >> name;
+
+    if (name.find('/') != std::string::npos)
+      return false;
+#ifdef _WIN32
+    if (name.find('\\') != std::string::npos)
+      return false;
+#endif
+    if (std::all_of(name.begin(), name.end(), [](char c) { return c == '.'; }))
+      return false;
+
+    bool is_folder;
+    packet >> is_folder;
+    if (!packet)
+      return false;
+
+    const std::string path = fmt::format("{}/{}", folder_path, name);
+    const bool success = is_folder ? ReadFolderInternal(packet, path) : ReadFile(packet, path);
+    if (!success)
+      return false;
+  }
+  return true;
+}
+
+bool SyncBlockReader::ReadFolder(sf::Packet& packet, const std::string& folder_path)
+{
+  bool folder_existed;
+  packet >> folder_existed;
+  if (!folder_existed)
+    return true;
+  return ReadFolderInternal(packet, folder_path);
+}
+
+std::optional<std::vector<u8>> SyncBlockReader::ReadBuffer(sf::Packet& packet)
+{
+  const u64 size = Common::PacketReadU64(packet);
+  std::vector<u8> buffer;
+
+  for (u64 offset = 0; offset < size; offset += SYNC_BLOCK_SIZE)
+  {
+    const std::vector<u8>* block = ReadBlock(packet, size - offset);
+    if (!block)
+      return std::nullopt;
+    buffer.insert(buffer.end(), block->begin(), block->end());
+  }
+
+  return buffer;
+}
+
+void SyncBlockReader::Retain()
+{
+  std::erase_if(m_blocks, [this](const auto& block) { return !m_read.contains(block.first); });
+  m_read.clear();
+}
+
+void SyncBlockReader::Clear()
+{
+  m_blocks.clear();
+  m_read.clear();
+}
+}  // namespace NetPlay
@@ -0,0 +1,143 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <compare>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/MultithreadedCompressor.h"
+
+namespace NetPlay
+{
+// Save data is synced as blocks, which are compressed with zstd on every core and sent in batches
+// while the blocks after them are still being read and compressed. The messages that describe the
+// saves only refer to the blocks by the hash of their contents and are sent after the last batch.
+// A block is sent once per sync however often it appears, like the same save in both memory card
+// slots or the erased blocks of a memory card, and not at all if every player kept it from the last
+// sync, like when the same match is played again.
+constexpr size_t SYNC_BLOCK_SIZE = 128 * 1024;
+// Big enough for the time waiting for players to take a batch to not matter, small enough for
+// players to decompress a batch while the next one is being sent
+constexpr size_t SYNC_BATCH_SIZE = 1024 * 1024;
+
+struct SyncBlockHash
+{
+  u64 high = 0;
+  u64 low = 0;
+
+  auto operator<=>(const SyncBlockHash&) const = default;
+};
+
+SyncBlockHash HashSyncBlock(std::span<const u8> data);
+
+class SyncBlockWriter final
+{
+public:
+  // Called from a thread of the writer with every batch of blocks, in order
+  using BatchCallback = std::function<void(sf::Packet&& batch)>;
+
+  struct Stats
+  {
+    u64 bytes = 0;
+    // Of the blocks that were not written before
+    u64 unique_bytes = 0;
+    // Of the unique blocks that every player already has
+    u64 known_bytes = 0;
+    u64 compressed_bytes = 0;
+  };
+
+  // The known blocks are referred to without being sent
+  explicit SyncBlockWriter(BatchCallback on_batch, std::set<SyncBlockHash> known_blocks = {});
+  ~SyncBlockWriter();
+  SyncBlockWriter(const SyncBlockWriter&) = delete;
+  SyncBlockWriter& operator=(const SyncBlockWriter&) = delete;
+
+  // Write the size and the blocks of the data to the packet, and queue the blocks that were not
+  // queued before to be compressed and sent
+  bool WriteFile(const std::string& file_path, sf::Packet& packet);
+  bool WriteFolder(const std::string& folder_path, sf::Packet& packet);
+  bool WriteBuffer(std::span<const u8> buffer, sf::Packet& packet);
+
+  // Waits for the queued blocks to be passed on, false if one of them could not be compressed
+  bool Finish();
+
+  // Complete once finished
+  const Stats& GetStats() const { return m_stats; }
+  // Every block that the written data refers to
+  const std::set<SyncBlockHash>& GetBlocks() const { return m_queued; }
+
+private:
+  struct Block
+  {
+    SyncBlockHash hash;
+    std::vector<u8> data;
+  };
+
+  struct Frame
+  {
+    SyncBlockHash hash;
+    u32 size = 0;
+    bool compressed = false;
+    std::vector<u8> data;
+  };
+
+  struct CompressState;
+  using Compressor = DiscIO::MultithreadedCompressor<CompressState, Block, Frame>;
+
+  void WriteBlock(std::vector<u8> block, sf::Packet& packet);
+  DiscIO::ConversionResultCode OutputFrame(Frame frame);
+
+  BatchCallback m_on_batch;
+  std::set<SyncBlockHash> m_known;
+  std::set<SyncBlockHash> m_queued;
+  // Only accessed by the output thread of the compressor until it is shut down
+  sf::Packet m_batch;
+  Stats m_stats;
+  bool m_finished = false;
+  // Last, for its threads to be stopped before what they use is destroyed
+  std::unique_ptr<Compressor> m_compressor;
+};
+
+class SyncBlockReader final
+{
+public:
+  SyncBlockReader();
+  ~SyncBlockReader();
+  SyncBlockReader(const SyncBlockReader&) = delete;
+  SyncBlockReader& operator=(const SyncBlockReader&) = delete;
+
+  // Decompresses the blocks of a batch, false if it is malformed
+  bool AddBatch(std::span<const u8> batch);
+
+  // Counterparts of the writer, false if the data refers to a block that was not received
+  bool ReadFile(sf::Packet& packet, const std::string& file_path);
+  bool ReadFolder(sf::Packet& packet, const std::string& folder_path);
+  std::optional<std::vector<u8>> ReadBuffer(sf::Packet& packet);
+
+  // Keeps only the blocks that were read since the last call, which the host expects to be kept
+  // once a sync succeeded
+  void Retain();
+  void Clear();
+
+private:
+  struct DecompressState;
+
+  const std::vector<u8>* ReadBlock(sf::Packet& packet, u64 remaining);
+  bool ReadFolderInternal(sf::Packet& packet, const std::string& folder_path);
+
+  std::map<SyncBlockHash, std::vector<u8>> m_blocks;
+  std::set<SyncBlockHash> m_read;
+  std::unique_ptr<DecompressState> m_state;
+};
+}  // namespace NetPlay
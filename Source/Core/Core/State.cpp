@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstring>
 #include <filesystem>
 #include <locale>
 #include <map>
@@ -27,6 +28,7 @@
 #include "Common/Event.h"
 #include "Common/FileUtil.h"
 #include "Common/IOFile.h"
+#include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
@@ -39,8 +41,10 @@
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/GeckoCode.h"
+#include "Core/HW/DirtyPageTracker.h"
 #include "Core/HW/HW.h"
 #include "Core/HW/Memmap.h"
+#include "Core/HW/PageSnapshots.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/Host.h"
 #include "Core/Movie.h"
@@ -244,6 +248,156 @@ void SaveToBuffer(std::vector<u8>& buffer)
       true);
 }
 
+template <typename F>
+static void WriteToBuffer(std::vector<u8>& buffer, F do_state)
+{
+  // The state rarely changes size, so measuring it first is only needed when the buffer is too
+  // small, which PointerWrap reports by switching to measure mode
+  u8* ptr = buffer.data();
+  PointerWrap p(&ptr, buffer.size(), PointerWrap::Mode::Write);
+  do_state(p);
+  const size_t buffer_size = ptr - buffer.data();
+  const bool buffer_too_small = p.IsMeasureMode();
+  buffer.resize(buffer_size);
+  if (buffer_too_small)
+  {
+    ptr = buffer.data();
+    PointerWrap p_retry(&ptr, buffer_size, PointerWrap::Mode::Write);
+    do_state(p_retry);
+  }
+}
+
+void SaveToBufferOnCPUThread(std::vector<u8>& buffer)
+{
+  WriteToBuffer(buffer, [](PointerWrap& p) { DoState(p); });
+}
+
+void LoadFromBufferOnCPUThread(const std::vector<u8>& buffer)
+{
+  // PointerWrap does not write to the buffer in read mode
+  u8* ptr = const_cast<u8*>(buffer.data());
+  PointerWrap p(&ptr, buffer.size(), PointerWrap::Mode::Read);
+  DoState(p);
+}
+
+namespace
+{
+// Starts the buffers of incremental states, followed by the state without memory
+struct IncrementalStateHeader
+{
+  u32 cookie;
+  u32 instance;
+  Memory::PageSnapshots::Id snapshot;
+};
+static_assert(std::is_trivially_copyable_v<IncrementalStateHeader>);
+
+constexpr u32 INCREMENTAL_STATE_COOKIE = 0x52434E49;  // "INCR"
+
+std::atomic<u32> s_incremental_states_instances = 0;
+}  // namespace
+
+IncrementalStates::IncrementalStates() : m_instance(++s_incremental_states_instances)
+{
+}
+
+IncrementalStates::~IncrementalStates()
+{
+  // The tracker is already stopped if the game has ended
+  if (m_snapshots)
+    Core::System::GetInstance().GetMemory().GetDirtyPageTracker().Stop();
+}
+
+bool IncrementalStates::IsSupported()
+{
+  auto& system = Core::System::GetInstance();
+  return Memory::DirtyPageTracker::IsSupported() && !system.IsWii() &&
+         system.GetMemory().IsARAMInSegment();
+}
+
+void IncrementalStates::Start()
+{
+  m_started = true;
+  if (!IsSupported())
+  {
+    INFO_LOG_FMT(CORE, "Incremental states are not supported, saving full states");
+    return;
+  }
+
+  auto& memory = Core::System::GetInstance().GetMemory();
+  u8* untracked_view = memory.GetUntrackedView();
+  if (!untracked_view)
+  {
+    ERROR_LOG_FMT(CORE, "Failed to map memory for incremental states, saving full states");
+    return;
+  }
+
+  // Covers ARAM too on GameCube, which is in the same segment
+  const u32 page_count = memory.GetDirtyPageCount();
+  memory.GetDirtyPageTracker().Start(page_count, memory.GetDirtyPageViews(true));
+  m_snapshots = std::make_unique<Memory::PageSnapshots>(
+      memory.GetDirtyPageTracker(), page_count,
+      std::vector<Memory::DirtyPageTracker::View>{{untracked_view, 0, page_count}});
+}
+
+void IncrementalStates::Save(std::vector<u8>& buffer)
+{
+  if (!m_started)
+    Start();
+  if (!m_snapshots)
+  {
+    SaveToBufferOnCPUThread(buffer);
+    return;
+  }
+
+  IncrementalStateHeader header;
+  if (buffer.size() >= sizeof(header))
+  {
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    if (header.cookie == INCREMENTAL_STATE_COOKIE && header.instance == m_instance &&
+        m_snapshots->IsValid(header.snapshot))
+    {
+      m_snapshots->Release(header.snapshot);
+    }
+  }
+
+  // The video backend writes back to memory when saving, so the pages are taken afterwards
+  header = {INCREMENTAL_STATE_COOKIE, m_instance, 0};
+  WriteToBuffer(buffer, [&header](PointerWrap& p) {
+    p.SetMemoryExcluded();
+    p.Do(header);
+    DoState(p);
+  });
+  header.snapshot = m_snapshots->Take();
+  std::memcpy(buffer.data(), &header, sizeof(header));
+}
+
+void IncrementalStates::Load(const std::vector<u8>& buffer)
+{
+  if (!m_snapshots)
+  {
+    LoadFromBufferOnCPUThread(buffer);
+    return;
+  }
+
+  IncrementalStateHeader header;
+  if (buffer.size() < sizeof(header))
+    return;
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  if (header.cookie != INCREMENTAL_STATE_COOKIE || header.instance != m_instance ||
+      !m_snapshots->IsValid(header.snapshot))
+  {
+    ERROR_LOG_FMT(CORE, "Tried to load an incremental state that was not saved by this object");
+    return;
+  }
+
+  m_snapshots->Restore(header.snapshot);
+  u8* ptr = const_cast<u8*>(buffer.data());
+  PointerWrap p(&ptr, buffer.size(), PointerWrap::Mode::Read);
+  p.SetMemoryExcluded();
+  p.Do(header);
+  DoState(p);
+}
+
 namespace
 {
 struct SlotWithTimestamp
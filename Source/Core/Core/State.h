@@ -7,12 +7,18 @@
 
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <vector>
 
 #include "Common/CommonTypes.h"
 
+namespace Memory
+{
+class PageSnapshots;
+}
+
 namespace State
 {
 // number of states
@@ -104,6 +110,42 @@ void LoadAs(const std::string& filename);
 void SaveToBuffer(std::vector<u8>& buffer);
 void LoadFromBuffer(std::vector<u8>& buffer);
 
+// Used by NetPlay rollback. Unlike the functions above these are only callable from the CPU
+// thread, also work while NetPlay is running, and reuse the memory already in the buffer.
+void SaveToBufferOnCPUThread(std::vector<u8>& buffer);
+void LoadFromBufferOnCPUThread(const std::vector<u8>& buffer);
+
+// States for taking one every frame. Instead of all of emulated RAM and ARAM, a buffer only
+// refers to a snapshot of their pages, which copies the pages written since the previous save.
+// The snapshot of a buffer is released when the buffer is saved into again or when this is
+// destroyed, so buffers must not be copied and can only be loaded by the object that saved them.
+//
+// Falls back to the functions above when pages can not be tracked. Only callable from the CPU
+// thread while the game is running.
+class IncrementalStates final
+{
+public:
+  IncrementalStates();
+  ~IncrementalStates();
+  IncrementalStates(const IncrementalStates&) = delete;
+  IncrementalStates& operator=(const IncrementalStates&) = delete;
+
+  // Writes to emulated memory by the kernel fail while its pages are tracked, which IOS does for
+  // file and socket reads, so only GameCube games are supported. ARAM also has to be in the memory
+  // segment, which Config::SESSION_INCREMENTAL_STATES has to be set for before the game boots.
+  static bool IsSupported();
+
+  void Save(std::vector<u8>& buffer);
+  void Load(const std::vector<u8>& buffer);
+
+private:
+  void Start();
+
+  const u32 m_instance;
+  bool m_started = false;
+  std::unique_ptr<Memory::PageSnapshots> m_snapshots;
+};
+
 void LoadLastSaved(int i = 1);
 void SaveFirstSaved();
 void UndoSaveState();
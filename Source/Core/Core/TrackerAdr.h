@@ -8,18 +8,20 @@
 // #include "Core/HW/Memmap.h"
 #include "Core/PowerPC/MMU.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/TrackerReadPlan.h"
 
 template <typename T>
 class TrackerValue {
 public:
     TrackerValue() {};
-    TrackerValue(std::string in_name, T in_default_value)
+    TrackerValue(const char* in_name, T in_default_value)
     {
         name = in_name;
         default_value = in_default_value;
     };
     
-    std::string name;
+    //Always a string literal, so every copy of a tracker shares the same name
+    const char* name = "";
     std::optional<T> value;
     std::optional<T> prev_value;
 
@@ -52,7 +54,7 @@ template <typename T>
 class TrackerAdr : public TrackerValue<T>{
 public:
     TrackerAdr() {};
-    TrackerAdr(std::string in_name, u32 in_adr, T in_default_value) :
+    TrackerAdr(const char* in_name, u32 in_adr, T in_default_value) :
         TrackerValue<T>(in_name, in_default_value),
         adr(in_adr)
     {
@@ -75,6 +77,17 @@ public:
         TrackerValue<T>::set_value(mem_val);
         return mem_val;
     }
+
+    //Same as above, served from the plan's snapshot when it covers adr
+    T read_value(const Core::CPUThreadGuard& guard, const TrackerReadPlan& plan) {
+        T mem_val = plan.read<T>(guard, adr);
+        TrackerValue<T>::set_value(mem_val);
+        return mem_val;
+    }
+
+    void add_to(TrackerReadPlan& plan) const {
+        plan.add(adr, sizeof(T));
+    }
 };
 
 //ostream& operator<<(ostream& os, const TrackerValue<T>& dt)
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+//Append-only table that stores every field of a record type in its own dense array.
+//
+//The layout of a row is described once by a schema (a static array of Fields) that all rows and
+//all tables of the same record type share, so a stored row costs exactly the sum of its field
+//widths. Rows are copied back into a record with load() when they need to be handed to code
+//that works on records, or read one field at a time with get() when scanning a single column.
+template <typename Record>
+class TrackerColumnTable{
+public:
+    struct Field{
+        u8 width; //1, 2 or 4 bytes
+        u32 (*get)(const Record&);
+        void (*set)(Record&, u32);
+    };
+
+    //Schema entry for a plain u8/u16/u32/bool member or a TrackerValue/TrackerAdr member
+    template <auto Member>
+    static constexpr Field column(){
+        using T = std::remove_cvref_t<decltype(std::declval<Record&>().*Member)>;
+        if constexpr (requires(const T& t) { t.default_value; }){
+            using V = decltype(T::default_value);
+            return {sizeof(V),
+                    [](const Record& record) -> u32 {
+                        const T& tracked = record.*Member;
+                        return tracked.value.value_or(tracked.default_value);
+                    },
+                    [](Record& record, u32 value) { (record.*Member).value = static_cast<V>(value); }};
+        }
+        else{
+            static_assert(std::is_integral_v<T> && sizeof(T) <= sizeof(u32));
+            return {sizeof(T),
+                    [](const Record& record) -> u32 { return record.*Member; },
+                    [](Record& record, u32 value) { record.*Member = static_cast<T>(value); }};
+        }
+    }
+
+    explicit TrackerColumnTable(std::span<const Field> schema) : m_schema(schema), m_columns(schema.size()) {}
+
+    //Returns the row the record was stored at
+    u32 append(const Record& record){
+        for (size_t field = 0; field < m_schema.size(); ++field){
+            const u32 value = m_schema[field].get(record);
+            const u8 width = m_schema[field].width;
+            std::vector<u8>& column = m_columns[field];
+            const size_t end = column.size();
+            column.resize(end + width);
+            if (width == 1){
+                column[end] = static_cast<u8>(value);
+            }
+            else if (width == 2){
+                const u16 value16 = static_cast<u16>(value);
+                std::memcpy(&column[end], &value16, sizeof(value16));
+            }
+            else{
+                std::memcpy(&column[end], &value, sizeof(value));
+            }
+        }
+        return m_rows++;
+    }
+
+    u32 get(u32 row, size_t field) const{
+        const u8 width = m_schema[field].width;
+        const u8* src = &m_columns[field][static_cast<size_t>(row) * width];
+        if (width == 1){
+            return *src;
+        }
+        if (width == 2){
+            u16 value;
+            std::memcpy(&value, src, sizeof(value));
+            return value;
+        }
+        u32 value;
+        std::memcpy(&value, src, sizeof(value));
+        return value;
+    }
+
+    void load(u32 row, Record& out) const{
+        for (size_t field = 0; field < m_schema.size(); ++field){
+            m_schema[field].set(out, get(row, field));
+        }
+    }
+
+    u32 size() const { return m_rows; }
+
+    void reserve(u32 rows){
+        for (size_t field = 0; field < m_schema.size(); ++field){
+            m_columns[field].reserve(static_cast<size_t>(rows) * m_schema[field].width);
+        }
+    }
+
+    void clear(){
+        for (std::vector<u8>& column : m_columns){
+            column.clear();
+        }
+        m_rows = 0;
+    }
+
+    //Bytes held by the columns, including spare capacity
+    size_t memoryUsage() const{
+        size_t bytes = sizeof(*this) + m_columns.capacity() * sizeof(std::vector<u8>);
+        for (const std::vector<u8>& column : m_columns){
+            bytes += column.capacity();
+        }
+        return bytes;
+    }
+
+private:
+    std::span<const Field> m_schema;
+    std::vector<std::vector<u8>> m_columns;
+    u32 m_rows = 0;
+};
@@ -0,0 +1,216 @@
+#include "Core/TrackerHUDStream.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "Common/StringUtil.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct Header{
+    char magic[4];
+    u32 version;
+    u32 slot_count;
+    u32 slot_size;
+    u64 sequence;
+};
+
+constexpr char cMagic[4] = {'R', 'H', 'U', 'D'};
+constexpr u32 cHeaderSize = 64;
+constexpr u32 cFileSize = cHeaderSize + TrackerHUDStream::cSlotCount * TrackerHUDStream::cSlotSize;
+
+static_assert(sizeof(Header) <= cHeaderSize);
+static_assert(sizeof(TrackerHUDStream::Record) <= TrackerHUDStream::cSlotSize);
+static_assert(std::atomic_ref<u64>::is_always_lock_free);
+
+//The stream lives in memory shared with other processes, so the sequence fields are only ever
+//touched atomically. Readers map the file read-only, loads never write to it
+std::atomic_ref<u64> atomicAt(const u8* view, size_t offset){
+    return std::atomic_ref<u64>(*reinterpret_cast<u64*>(const_cast<u8*>(view) + offset));
+}
+
+std::atomic_ref<u64> headerSequence(const u8* view){
+    return atomicAt(view, offsetof(Header, sequence));
+}
+
+size_t slotOffset(u64 sequence){
+    return cHeaderSize + ((sequence - 1) % TrackerHUDStream::cSlotCount) * TrackerHUDStream::cSlotSize;
+}
+
+u8* mapFile(const std::string& path, bool writable, void*& mapping){
+#ifdef _WIN32
+    const HANDLE file = CreateFileW(UTF8ToWString(path).c_str(), writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return nullptr; }
+
+    const HANDLE file_mapping = CreateFileMappingW(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                                   0, cFileSize, nullptr);
+    CloseHandle(file);
+    if (!file_mapping) { return nullptr; }
+
+    void* view = MapViewOfFile(file_mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, cFileSize);
+    if (!view){
+        CloseHandle(file_mapping);
+        return nullptr;
+    }
+    mapping = file_mapping;
+    return static_cast<u8*>(view);
+#else
+    const int fd = ::open(path.c_str(), writable ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+    if (fd < 0) { return nullptr; }
+
+    if (writable && ftruncate(fd, cFileSize) != 0){
+        ::close(fd);
+        return nullptr;
+    }
+    if (!writable && lseek(fd, 0, SEEK_END) < static_cast<off_t>(cFileSize)){
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* view = mmap(nullptr, cFileSize, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) { return nullptr; }
+    mapping = nullptr;
+    return static_cast<u8*>(view);
+#endif
+}
+
+void unmapFile(u8* view, void* mapping){
+    if (!view) { return; }
+#ifdef _WIN32
+    UnmapViewOfFile(view);
+    CloseHandle(mapping);
+#else
+    munmap(view, cFileSize);
+#endif
+}
+
+}
+
+TrackerHUDStream::~TrackerHUDStream(){
+    close();
+}
+
+bool TrackerHUDStream::open(const std::string& path){
+    close();
+
+    m_view = mapFile(path, true, m_mapping);
+    if (!m_view) { return false; }
+
+    //Readers that still hold the old session see sequence drop back to 0 and start over
+    headerSequence(m_view).store(0, std::memory_order_release);
+    std::memset(m_view + cHeaderSize, 0, cFileSize - cHeaderSize);
+
+    Header header{};
+    std::memcpy(header.magic, cMagic, sizeof(cMagic));
+    header.version = cVersion;
+    header.slot_count = cSlotCount;
+    header.slot_size = cSlotSize;
+    std::memcpy(m_view, &header, offsetof(Header, sequence));
+
+    m_sequence = 0;
+    m_last_state.reset();
+    return true;
+}
+
+void TrackerHUDStream::close(){
+    unmapFile(m_view, m_mapping);
+    m_view = nullptr;
+    m_mapping = nullptr;
+}
+
+void TrackerHUDStream::publish(const State& state){
+    if (!isOpen()) { return; }
+
+    u32 changed = ~0u;
+    if (m_last_state.has_value()){
+        const State& last = m_last_state.value();
+        changed = 0;
+        if (state.event_num != last.event_num || state.phase != last.phase) { changed |= Event; }
+        if (state.inning != last.inning || state.half_inning != last.half_inning) { changed |= Inning; }
+        if (state.away_score != last.away_score || state.home_score != last.home_score) { changed |= Score; }
+        if (state.balls != last.balls || state.strikes != last.strikes || state.outs != last.outs) { changed |= Count; }
+        if (state.away_stars != last.away_stars || state.home_stars != last.home_stars ||
+            state.is_star_chance != last.is_star_chance) { changed |= Stars; }
+        if (state.batter_roster_loc != last.batter_roster_loc || state.batter_char_id != last.batter_char_id) { changed |= Batter; }
+        if (state.pitcher_roster_loc != last.pitcher_roster_loc || state.pitcher_char_id != last.pitcher_char_id ||
+            state.pitcher_stamina != last.pitcher_stamina) { changed |= Pitcher; }
+        if (std::memcmp(state.runners, last.runners, sizeof(state.runners)) != 0 ||
+            state.chem_links_ob != last.chem_links_ob) { changed |= Runners; }
+        if (state.prev_result_of_atbat != last.prev_result_of_atbat || state.prev_rbi != last.prev_rbi) { changed |= Result; }
+    }
+    m_last_state = state;
+
+    const u64 sequence = ++m_sequence;
+    const size_t offset = slotOffset(sequence);
+    std::atomic_ref<u64> lock = atomicAt(m_view, offset + offsetof(Record, lock));
+
+    lock.store(sequence * 2 - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(m_view + offset + offsetof(Record, changed), &changed, sizeof(changed));
+    std::memcpy(m_view + offset + offsetof(Record, state), &state, sizeof(state));
+    lock.store(sequence * 2, std::memory_order_release);
+
+    headerSequence(m_view).store(sequence, std::memory_order_release);
+}
+
+TrackerHUDStream::Reader::~Reader(){
+    unmapFile(m_view, m_mapping);
+}
+
+bool TrackerHUDStream::Reader::open(const std::string& path){
+    unmapFile(m_view, m_mapping);
+    m_view = mapFile(path, false, m_mapping);
+    if (!m_view) { return false; }
+
+    Header header;
+    std::memcpy(&header, m_view, sizeof(header));
+    if (std::memcmp(header.magic, cMagic, sizeof(cMagic)) != 0 || header.version != cVersion ||
+        header.slot_count != cSlotCount || header.slot_size != cSlotSize){
+        unmapFile(m_view, m_mapping);
+        m_view = nullptr;
+        return false;
+    }
+    return true;
+}
+
+u64 TrackerHUDStream::Reader::getSequence() const{
+    if (!m_view) { return 0; }
+    return headerSequence(m_view).load(std::memory_order_acquire);
+}
+
+std::optional<TrackerHUDStream::Record> TrackerHUDStream::Reader::read(u64 sequence) const{
+    if (!m_view || sequence == 0 || sequence > getSequence()) { return std::nullopt; }
+
+    const size_t offset = slotOffset(sequence);
+    const std::atomic_ref<u64> lock = atomicAt(m_view, offset + offsetof(Record, lock));
+
+    if (lock.load(std::memory_order_acquire) != sequence * 2) { return std::nullopt; }
+    Record record;
+    std::memcpy(&record, m_view + offset, sizeof(record));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (lock.load(std::memory_order_relaxed) != sequence * 2) { return std::nullopt; }
+
+    record.lock = sequence * 2;
+    return record;
+}
+
+std::optional<TrackerHUDStream::Record> TrackerHUDStream::Reader::readLatest() const{
+    //Only fails if the writer lapped the whole ring between two loads, so this settles quickly
+    for (int attempt = 0; attempt < 16; ++attempt){
+        const u64 sequence = getSequence();
+        if (sequence == 0) { return std::nullopt; }
+        if (std::optional<Record> record = read(sequence)) { return record; }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+//Live HUD data for overlays, published through a memory mapped file instead of a JSON file.
+//
+//The file is a 64 byte header followed by a ring of cSlotCount records of 64 bytes each. All
+//integers are little-endian.
+//
+//  Header:  "RHUD", u32 version, u32 slot count, u32 slot size, u64 sequence
+//  Record:  u64 lock, u32 changed, State state
+//
+//sequence is the number of records published so far. Record n (starting at 1) lives in slot
+//(n - 1) % slot count and is complete when its lock reads 2 * n. The lock is 2 * n - 1 while the
+//record is being written. Readers never block the tracker: read sequence, read the lock, copy the
+//record and read the lock again. The copy is good if both locks read 2 * n, otherwise the slot was
+//overwritten and the reader moves on to the newest record. sequence starts over at 0 when a new
+//tracker opens the file.
+//
+//changed flags the parts of the state that differ from the previous record, so an overlay can
+//redraw only what moved. Every record still carries the full state, a reader that falls behind
+//just takes the newest one.
+class TrackerHUDStream{
+public:
+    static constexpr u32 cVersion = 1;
+    static constexpr u32 cSlotCount = 64;
+    static constexpr u32 cSlotSize = 64;
+    static constexpr u8 cNoRunner = 0xFF;
+
+    enum Changed : u32 {
+        Event = 1 << 0,  //event_num, phase
+        Inning = 1 << 1, //inning, half_inning
+        Score = 1 << 2,
+        Count = 1 << 3,  //balls, strikes, outs
+        Stars = 1 << 4,  //stars, star chance
+        Batter = 1 << 5,
+        Pitcher = 1 << 6, //pitcher roster loc, char id and stamina
+        Runners = 1 << 7,
+        Result = 1 << 8, //result of the last finished play
+    };
+
+    struct State{
+        u32 game_id;
+        u16 event_num;
+        u8 phase;        //0 before the pitch, 1 once the play is over (the 'a' and 'b' HUDs)
+        u8 inning;
+        u8 half_inning;
+        u8 balls;
+        u8 strikes;
+        u8 outs;
+        u16 away_score;
+        u16 home_score;
+        u8 away_stars;
+        u8 home_stars;
+        u8 is_star_chance;
+        u8 chem_links_ob;
+        u16 pitcher_stamina;
+        u8 batter_roster_loc;
+        u8 batter_char_id;
+        u8 pitcher_roster_loc;
+        u8 pitcher_char_id;
+        u8 runners[4];   //Roster loc of the batter and the runners on 1st to 3rd, cNoRunner if empty
+        u8 prev_result_of_atbat; //Last finished play, the current one once phase is 1
+        u8 prev_rbi;
+        u8 reserved[2];
+
+        bool operator==(const State&) const = default;
+    };
+
+    struct Record{
+        u64 lock;
+        u32 changed;
+        State state;
+    };
+
+    TrackerHUDStream() = default;
+    TrackerHUDStream(const TrackerHUDStream&) = delete;
+    TrackerHUDStream& operator=(const TrackerHUDStream&) = delete;
+    ~TrackerHUDStream();
+
+    //Maps path as a new stream, resetting whatever an earlier session left in it
+    bool open(const std::string& path);
+    bool isOpen() const { return m_view != nullptr; }
+    void close();
+
+    void publish(const State& state);
+    u64 getSequence() const { return m_sequence; }
+
+    //Reading side of the stream, as an overlay would do it
+    class Reader{
+    public:
+        Reader() = default;
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        ~Reader();
+
+        bool open(const std::string& path);
+        //Number of records published so far
+        u64 getSequence() const;
+        //Record sequence, or nullopt if it was not published yet or has been overwritten since
+        std::optional<Record> read(u64 sequence) const;
+        std::optional<Record> readLatest() const;
+
+    private:
+        u8* m_view = nullptr;
+        void* m_mapping = nullptr;
+    };
+
+private:
+    u8* m_view = nullptr;
+    void* m_mapping = nullptr;
+    u64 m_sequence = 0;
+    std::optional<State> m_last_state;
+};
@@ -0,0 +1,98 @@
+#include "Core/TrackerReadPlan.h"
+
+#include <algorithm>
+
+#include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/System.h"
+
+void TrackerReadPlan::add(u32 adr, u32 size){
+    //Only cached MEM1 can be copied in bulk. Anything else is left to the MMU
+    if (adr < Memory::MEM1_BASE_ADDR || size == 0 ||
+        adr - Memory::MEM1_BASE_ADDR + size > Memory::MEM1_SIZE_RETAIL) { return; }
+
+    m_ranges.emplace_back(adr, size);
+    m_valid = false;
+}
+
+void TrackerReadPlan::addTable(u32 adr, u32 size, u32 stride, u32 count){
+    for (u32 i = 0; i < count; ++i){
+        add(adr + (i * stride), size);
+    }
+}
+
+void TrackerReadPlan::build(){
+    std::sort(m_ranges.begin(), m_ranges.end());
+
+    m_spans.clear();
+    u32 offset = 0;
+    for (const auto& [adr, size] : m_ranges){
+        const u32 end = adr + size;
+        if (!m_spans.empty()){
+            Span& last = m_spans.back();
+            if (adr <= last.adr + last.size + cMaxSpanGap){
+                const u32 new_size = std::max(last.adr + last.size, end) - last.adr;
+                offset += new_size - last.size;
+                last.size = new_size;
+                continue;
+            }
+        }
+        m_spans.push_back({adr, size, offset});
+        offset += size;
+    }
+
+    m_snapshot.assign(offset, 0);
+    m_valid = false;
+}
+
+bool TrackerReadPlan::capture(const Core::CPUThreadGuard& guard){
+    auto& memory = guard.GetSystem().GetMemory();
+    u8* ram = memory.GetRAM();
+    if (!ram || m_spans.empty()){
+        m_valid = false;
+        return false;
+    }
+
+    //The game maps MEM1 at 0x80000000 with a BAT (as every GameCube title does), so the
+    //physical address is the effective address with the segment bits masked off. Make sure
+    //that still holds for both ends of the plan before trusting the raw copy
+    const Span& first = m_spans.front();
+    const Span& last = m_spans.back();
+    if (!PowerPC::MMU::HostIsRAMAddress(guard, first.adr) ||
+        !PowerPC::MMU::HostIsRAMAddress(guard, last.adr + last.size - 1)){
+        m_valid = false;
+        return false;
+    }
+
+    return capture(ram, memory.GetRamSizeReal());
+}
+
+bool TrackerReadPlan::capture(const u8* mem1, u32 mem1_size){
+    m_valid = false;
+    if (!mem1) { return false; }
+
+    for (const Span& span : m_spans){
+        const u32 physical = span.adr - Memory::MEM1_BASE_ADDR;
+        if (physical >= mem1_size || span.size > mem1_size - physical) { return false; }
+
+        std::memcpy(&m_snapshot[span.offset], mem1 + physical, span.size);
+    }
+
+    m_valid = true;
+    return true;
+}
+
+const u8* TrackerReadPlan::find(u32 adr, u32 size) const{
+    if (!m_valid) { return nullptr; }
+
+    //First span that starts after adr. The one before it is the only candidate
+    auto it = std::upper_bound(m_spans.begin(), m_spans.end(), adr,
+                               [](u32 value, const Span& span) { return value < span.adr; });
+    if (it == m_spans.begin()) { return nullptr; }
+    --it;
+
+    const u32 offset_in_span = adr - it->adr;
+    if (offset_in_span >= it->size || size > it->size - offset_in_span) { return nullptr; }
+
+    return &m_snapshot[it->offset + offset_in_span];
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Swap.h"
+#include "Core/PowerPC/MMU.h"
+
+namespace Core
+{
+class CPUThreadGuard;
+}
+
+//Batches the memory reads of the stat tracker.
+//
+//Addresses are registered once, sorted and merged into a handful of contiguous spans of MEM1.
+//capture() then copies every span into a small snapshot buffer with one memcpy each, and reads
+//are served from that buffer instead of going through the MMU one field at a time. Values stay
+//big-endian in the snapshot and are swapped when read, which is a single bswap per field.
+//
+//Reads that are not covered by the plan, or happen while there is no valid snapshot, fall back
+//to PowerPC::MMU::HostRead_*.
+class TrackerReadPlan{
+public:
+    struct Span{
+        u32 adr;
+        u32 size;
+        u32 offset; //Into the snapshot buffer
+    };
+
+    //Registered ranges closer together than this are merged into one span.
+    //Copying a few unused bytes is cheaper than starting another span
+    static constexpr u32 cMaxSpanGap = 256;
+
+    void add(u32 adr, u32 size);
+    //Registers count copies of a field that repeat every stride bytes (fielder and runner tables)
+    void addTable(u32 adr, u32 size, u32 stride, u32 count);
+
+    //Sorts and merges the registered ranges. Must be called before capture()
+    void build();
+
+    //Copies all spans out of emulated memory. Returns false if MEM1 is not available,
+    //in which case every read falls back to the MMU until the next successful capture
+    bool capture(const Core::CPUThreadGuard& guard);
+    //Copies all spans out of a host copy of MEM1
+    bool capture(const u8* mem1, u32 mem1_size);
+    void invalidate() { m_valid = false; }
+
+    bool isValid() const { return m_valid; }
+    const std::vector<std::pair<u32, u32>>& getRanges() const { return m_ranges; }
+    const std::vector<Span>& getSpans() const { return m_spans; }
+    size_t getSnapshotSize() const { return m_snapshot.size(); }
+    //Raw captured bytes, only meaningful while isValid()
+    std::span<const u8> getSnapshot() const { return m_snapshot; }
+
+    //Returns the value from the snapshot, or nullopt if adr is not covered by a valid snapshot
+    template <typename T>
+    std::optional<T> tryRead(u32 adr) const {
+        static_assert(std::is_same_v<T, u8> || std::is_same_v<T, u16> || std::is_same_v<T, u32>);
+
+        const u8* src = find(adr, sizeof(T));
+        if (!src) { return std::nullopt; }
+
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        return Common::FromBigEndian(value);
+    }
+
+    template <typename T>
+    T read(const Core::CPUThreadGuard& guard, u32 adr) const {
+        if (const std::optional<T> value = tryRead<T>(adr)) {
+            return *value;
+        }
+
+        if constexpr(std::is_same_v<T, u8>){
+            return PowerPC::MMU::HostRead_U8(guard, adr);
+        }
+        else if constexpr(std::is_same_v<T, u16>){
+            return PowerPC::MMU::HostRead_U16(guard, adr);
+        }
+        else {
+            return PowerPC::MMU::HostRead_U32(guard, adr);
+        }
+    }
+
+private:
+    const u8* find(u32 adr, u32 size) const;
+
+    //Registered [adr, adr + size) ranges
+    std::vector<std::pair<u32, u32>> m_ranges;
+    //Sorted by adr, non-overlapping
+    std::vector<Span> m_spans;
+    std::vector<u8> m_snapshot;
+    bool m_valid = false;
+};
@@ -0,0 +1,223 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "DolphinNoGUI/FifoBenchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "Common/Config/Config.h"
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Common/JsonWriter.h"
+#include "Common/WindowSystemInfo.h"
+#include "Core/Boot/Boot.h"
+#include "Core/BootManager.h"
+#include "Core/Config/MainSettings.h"
+#include "Core/Core.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
+#include "Core/System.h"
+
+#include "VideoCommon/StageTimings.h"
+#include "VideoCommon/VideoBackendBase.h"
+
+namespace FifoBenchmark
+{
+struct Result
+{
+  std::string capture;
+  std::string backend;
+  bool played = false;
+  u32 frames = 0;
+  u64 time_ns = 0;
+  std::array<StageTimings::StageTotal, StageTimings::NUM_STAGES> stages{};
+};
+
+static u64 GetTimeNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static std::vector<std::string> FindCaptures(const std::vector<std::string>& paths)
+{
+  std::vector<std::string> captures;
+  for (const std::string& path : paths)
+  {
+    if (File::IsDirectory(path))
+    {
+      const std::vector<std::string> found = Common::DoFileSearch({path}, {".dff"});
+      captures.insert(captures.end(), found.begin(), found.end());
+    }
+    else
+    {
+      captures.push_back(path);
+    }
+  }
+  return captures;
+}
+
+static Result Play(const std::string& capture, const std::string& backend, u32 loops,
+                   const WindowSystemInfo& wsi)
+{
+  Result result{.capture = capture, .backend = backend};
+  Config::SetCurrent(Config::MAIN_GFX_BACKEND, backend);
+
+  auto& fifo_player = Core::System::GetInstance().GetFifoPlayer();
+  fifo_player.SetLoopCount(loops);
+
+  // Called on the CPU thread before each frame is written. In single core that is also the thread
+  // that processes the commands, so no stage is being timed while the timings are reset.
+  std::atomic<u32> frames = 0;
+  std::atomic<u64> start_time = 0;
+  u32 loops_started = 0;
+  fifo_player.SetFrameWrittenCallback([&] {
+    if (fifo_player.GetCurrentFrameNum() == fifo_player.GetFrameRangeStart() &&
+        ++loops_started == std::min(loops, 2u))
+    {
+      StageTimings::Reset();
+      frames = 0;
+      start_time = GetTimeNs();
+    }
+    ++frames;
+  });
+
+  auto boot = BootParameters::GenerateFromFile(capture);
+  if (!boot || !BootManager::BootCore(std::move(boot), wsi))
+  {
+    fmt::print(stderr, "Could not play {}\n", capture);
+    fifo_player.SetFrameWrittenCallback(nullptr);
+    return result;
+  }
+
+  // FifoPlayer breaks the CPU once the last loop has been written
+  Core::State state = Core::GetState();
+  while (state != Core::State::Uninitialized && (frames == 0 || state != Core::State::Paused))
+  {
+    Core::HostDispatchJobs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    state = Core::GetState();
+  }
+
+  result.played = state == Core::State::Paused;
+  if (result.played)
+  {
+    result.frames = frames;
+    result.time_ns = GetTimeNs() - start_time;
+    result.stages = StageTimings::GetTotals();
+  }
+
+  Core::Stop();
+  Core::Shutdown();
+  fifo_player.SetFrameWrittenCallback(nullptr);
+  fifo_player.SetLoopCount(0);
+  return result;
+}
+
+static void WriteResult(Common::JsonWriter& json, const Result& result)
+{
+  json.BeginObject();
+  json.String("capture", result.capture);
+  json.String("backend", result.backend);
+  json.Bool("played", result.played);
+  json.Number("frames", result.frames);
+  json.Number("time_ns", result.time_ns);
+
+  u64 staged_time_ns = 0;
+  json.BeginObject("stages");
+  for (size_t i = 0; i < StageTimings::NUM_STAGES; ++i)
+  {
+    json.BeginObject(StageTimings::GetStageName(static_cast<StageTimings::Stage>(i)));
+    json.Number("time_ns", result.stages[i].time_ns);
+    json.Number("calls", result.stages[i].calls);
+    json.EndObject();
+    staged_time_ns += result.stages[i].time_ns;
+  }
+  json.EndObject();
+
+  // Writing the frames to memory, the rest of the emulated hardware and presenting
+  json.Number("other_ns", result.time_ns - std::min(staged_time_ns, result.time_ns));
+  json.EndObject();
+}
+
+int Run(const std::vector<std::string>& captures, const std::vector<std::string>& backends,
+        u32 loops, const std::string& output_path, const WindowSystemInfo& wsi)
+{
+  for (const std::string& backend : backends)
+  {
+    const auto& available = VideoBackendBase::GetAvailableBackends();
+    if (std::none_of(available.begin(), available.end(),
+                     [&backend](const auto& b) { return b->GetName() == backend; }))
+    {
+      fmt::print(stderr, "Unknown video backend {}\n", backend);
+      return 1;
+    }
+  }
+
+  const std::vector<std::string> files = FindCaptures(captures);
+  if (files.empty())
+  {
+    fmt::print(stderr, "No FIFO logs found\n");
+    return 1;
+  }
+
+  // Single core processes the commands on the same thread that writes them, so the stages are
+  // timed without waiting on another thread and the results can be compared from run to run.
+  Config::SetCurrent(Config::MAIN_CPU_THREAD, false);
+  Config::SetCurrent(Config::MAIN_AUDIO_BACKEND, BACKEND_NULLSOUND);
+  Config::SetCurrent(Config::MAIN_EMULATION_SPEED, 0.0f);
+  StageTimings::SetEnabled(true);
+
+  std::vector<Result> results;
+  for (const std::string& file : files)
+  {
+    for (const std::string& backend : backends)
+    {
+      fmt::print(stderr, "Playing {} on {}\n", file, backend);
+      results.push_back(Play(file, backend, loops, wsi));
+
+      const Result& result = results.back();
+      if (result.played && result.frames != 0)
+      {
+        fmt::print(stderr, "{} frames in {:.2f}s: {:.2f}ms per frame\n", result.frames,
+                   result.time_ns / 1e9, result.time_ns / 1e6 / result.frames);
+      }
+    }
+  }
+  StageTimings::SetEnabled(false);
+
+  Common::JsonWriter json;
+  json.BeginObject();
+  json.Number("loops", loops);
+  json.Number("timed_loops", std::max(loops, 2u) - 1);
+  json.BeginArray("results");
+  for (const Result& result : results)
+    WriteResult(json, result);
+  json.EndArray();
+  json.EndObject();
+
+  if (output_path.empty())
+  {
+    fmt::print("{}\n", json.GetView());
+  }
+  else if (!File::WriteStringToFile(output_path, json.GetView()))
+  {
+    fmt::print(stderr, "Could not write {}\n", output_path);
+    return 1;
+  }
+
+  const bool all_played = std::all_of(results.begin(), results.end(),
+                                      [](const Result& result) { return result.played; });
+  return all_played ? 0 : 1;
+}
+}  // namespace FifoBenchmark
@@ -0,0 +1,22 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+struct WindowSystemInfo;
+
+namespace FifoBenchmark
+{
+// Plays every FIFO log in captures, which can also name directories of them, on each of the video
+// backends, as fast as possible and loops times in a row. Writes how long each stage of the
+// command processing took as JSON to output_path, or to stdout if it is empty. The first loop
+// warms up the caches and is not timed, unless it is the only one. Returns the exit code for the
+// benchmark.
+int Run(const std::vector<std::string>& captures, const std::vector<std::string>& backends,
+        u32 loops, const std::string& output_path, const WindowSystemInfo& wsi);
+}  // namespace FifoBenchmark
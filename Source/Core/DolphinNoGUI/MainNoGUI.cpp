@@ -9,6 +9,7 @@
 #include <cstring>
 #include <signal.h>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifndef _WIN32
@@ -17,13 +18,22 @@
 #include <Windows.h>
 #endif
 
+#include "AudioCommon/AudioCommon.h"
+#include "Common/CommonPaths.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Core/Boot/Boot.h"
 #include "Core/BootManager.h"
+#include "Core/Config/MainSettings.h"
 #include "Core/Core.h"
 #include "Core/DolphinAnalytics.h"
 #include "Core/Host.h"
+#include "Core/Movie.h"
+#include "Core/System.h"
+#include "DolphinNoGUI/FifoBenchmark.h"
+#include "DolphinNoGUI/ReplayBatch.h"
 
 #include "UICommon/CommandLineParse.h"
 #ifdef USE_DISCORD_PRESENCE
@@ -36,6 +46,8 @@
 #include "VideoCommon/VideoBackendBase.h"
 
 static std::unique_ptr<Platform> s_platform;
+// Keeps stdout to the results of the benchmark
+static bool s_fifo_benchmark = false;
 
 static void signal_handler(int)
 {
@@ -78,6 +90,8 @@ void Host_Message(HostMessageID id)
 
 void Host_UpdateTitle(const std::string& title)
 {
+  if (s_fifo_benchmark)
+    return;
   s_platform->SetTitle(title);
 }
 
@@ -153,6 +167,8 @@ std::unique_ptr<GBAHostInterface> Host_CreateGBAHost(std::weak_ptr<HW::GBA::Core
 static std::unique_ptr<Platform> GetPlatform(const optparse::Values& options)
 {
   std::string platform_name = static_cast<const char*>(options.get("platform"));
+  if (options.get("stats_replay") || options.get("fifo_benchmark"))
+    platform_name = "headless";
 
 #if HAVE_X11
   if (platform_name == "x11" || platform_name.empty())
@@ -210,10 +226,144 @@ int main(int argc, char* argv[])
             "macos"
 #endif
       });
+  parser->add_option("--stats_replay")
+      .action("store_true")
+      .help("Play back the movie as fast as possible without video or audio output to regenerate "
+            "its game stats, then exit (Requires --movie)");
+  parser->add_option("--stats_replay_dir")
+      .action("store")
+      .metavar("<dir>")
+      .type("string")
+      .help("Regenerate the game stats of every movie in <dir> with --stats_replay, one process "
+            "per movie");
+  parser->add_option("-j", "--jobs")
+      .action("store")
+      .type("int")
+      .set_default(static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)))
+      .help("Number of movies replayed at once with --stats_replay_dir [default: %default]");
+  parser->add_option("--stats_output_dir")
+      .action("store")
+      .metavar("<dir>")
+      .type("string")
+      .help("Write the stat and HUD files of --stats_replay to <dir> instead of the user "
+            "directory. With --stats_replay_dir, every movie gets a directory of its own in <dir> "
+            "[default: the Stats directory of the movies]");
+  parser->add_option("--fifo_benchmark")
+      .action("store_true")
+      .help("Play back the FIFO logs given as arguments, or those in the directories given, as "
+            "fast as possible on each video backend and print how long each stage of the command "
+            "processing took as JSON");
+  parser->add_option("--fifo_benchmark_backends")
+      .action("store")
+      .metavar("<backends>")
+      .type("string")
+      .set_default("Null,Software Renderer")
+      .help("Comma separated video backends to benchmark with [default: %default]");
+  parser->add_option("--fifo_benchmark_loops")
+      .action("store")
+      .type("int")
+      .set_default(5)
+      .help("How many times each FIFO log is played, the first loop is not timed unless it is "
+            "the only one [default: %default]");
+  parser->add_option("--fifo_benchmark_output")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Write the benchmark results to <file> instead of stdout");
 
   optparse::Values& options = CommandLineParse::ParseArguments(parser.get(), argc, argv);
   std::vector<std::string> args = parser->args();
 
+  if (options.is_set("stats_replay_dir"))
+  {
+    std::vector<std::string> child_args{argv[0], "--stats_replay"};
+    if (options.is_set("user"))
+      child_args.insert(child_args.end(), {"--user", static_cast<const char*>(options.get("user"))});
+    if (options.is_set_by_user("config"))
+    {
+      for (const std::string& config : options.all("config"))
+        child_args.insert(child_args.end(), {"--config", config});
+    }
+    if (options.is_set("exec"))
+    {
+      for (const std::string& path : options.all("exec"))
+        child_args.insert(child_args.end(), {"--exec", path});
+    }
+    else if (!args.empty())
+    {
+      child_args.insert(child_args.end(), {"--exec", args.front()});
+    }
+    else
+    {
+      fprintf(stderr, "--stats_replay_dir requires the game to replay the movies with.\n");
+      return 1;
+    }
+
+    const int jobs = static_cast<int>(options.get("jobs"));
+    if (jobs < 1)
+    {
+      fprintf(stderr, "Invalid number of jobs\n");
+      return 1;
+    }
+    const std::string movie_dir = static_cast<const char*>(options.get("stats_replay_dir"));
+    const std::string output_dir = options.is_set("stats_output_dir") ?
+                                       static_cast<const char*>(options.get("stats_output_dir")) :
+                                       movie_dir + "/Stats";
+    return ReplayBatch::Run(child_args, movie_dir, output_dir, static_cast<unsigned int>(jobs));
+  }
+
+  std::string user_directory;
+  if (options.is_set("user"))
+    user_directory = static_cast<const char*>(options.get("user"));
+
+  if (options.get("fifo_benchmark"))
+  {
+    if (args.empty())
+    {
+      fprintf(stderr, "--fifo_benchmark requires the FIFO logs to play.\n");
+      return 1;
+    }
+    const int loops = static_cast<int>(options.get("fifo_benchmark_loops"));
+    if (loops < 1)
+    {
+      fprintf(stderr, "Invalid number of loops\n");
+      return 1;
+    }
+
+    s_fifo_benchmark = true;
+    s_platform = GetPlatform(options);
+    if (!s_platform || !s_platform->Init())
+    {
+      fprintf(stderr, "No platform found, or failed to initialize.\n");
+      return 1;
+    }
+    const WindowSystemInfo wsi = s_platform->GetWindowSystemInfo();
+
+    UICommon::SetUserDirectory(user_directory);
+    UICommon::Init();
+    UICommon::InitControllers(wsi);
+
+    const int result = FifoBenchmark::Run(
+        args, SplitString(static_cast<const char*>(options.get("fifo_benchmark_backends")), ','),
+        static_cast<u32>(loops),
+        options.is_set("fifo_benchmark_output") ?
+            static_cast<const char*>(options.get("fifo_benchmark_output")) :
+            "",
+        wsi);
+
+    UICommon::ShutdownControllers();
+    UICommon::Shutdown();
+    s_platform.reset();
+    return result;
+  }
+
+  const bool stats_replay = static_cast<bool>(options.get("stats_replay"));
+  if (stats_replay && !options.is_set("movie"))
+  {
+    fprintf(stderr, "--stats_replay requires a movie.\n");
+    return 1;
+  }
+
   std::optional<std::string> save_state_path;
   if (options.is_set("save_state"))
   {
@@ -256,10 +406,6 @@ int main(int argc, char* argv[])
     return 0;
   }
 
-  std::string user_directory;
-  if (options.is_set("user"))
-    user_directory = static_cast<const char*>(options.get("user"));
-
   s_platform = GetPlatform(options);
   if (!s_platform || !s_platform->Init())
   {
@@ -284,9 +430,47 @@ int main(int argc, char* argv[])
     return 1;
   }
 
-  Core::AddOnStateChangedCallback([](Core::State state) {
+  if (stats_replay && options.is_set("stats_output_dir"))
+  {
+    const std::string output_dir = static_cast<const char*>(options.get("stats_output_dir"));
+    File::SetUserPath(D_MSSBFILES_IDX, output_dir);
+    File::SetUserPath(D_HUDFILES_IDX, output_dir + DIR_SEP HUDFILES_DIR);
+    File::CreateFullPath(File::GetUserPath(D_HUDFILES_IDX));
+  }
+
+  if (stats_replay)
+  {
+    // Only the stat tracker has to see the game, so nothing is drawn or played and the CPU is not
+    // throttled. None of this changes how the movie plays back.
+    Config::SetCurrent(Config::MAIN_GFX_BACKEND, "Null");
+    Config::SetCurrent(Config::MAIN_AUDIO_BACKEND, BACKEND_NULLSOUND);
+    Config::SetCurrent(Config::MAIN_EMULATION_SPEED, 0.0f);
+    // Emulation pauses when the movie runs out, which is what ends the replay
+    Config::SetCurrent(Config::MAIN_MOVIE_PAUSE_MOVIE, true);
+  }
+
+  if (options.is_set("movie"))
+  {
+    std::optional<std::string> movie_save_state_path;
+    auto& movie = Core::System::GetInstance().GetMovie();
+    if (!movie.PlayInput(static_cast<const char*>(options.get("movie")), &movie_save_state_path))
+    {
+      fprintf(stderr, "Could not play the specified movie\n");
+      return 1;
+    }
+    if (movie_save_state_path)
+    {
+      boot->boot_session_data.SetSavestateData(std::move(movie_save_state_path),
+                                               DeleteSavestateAfterBoot::No);
+    }
+  }
+
+  Core::AddOnStateChangedCallback([stats_replay](Core::State state) {
     if (state == Core::State::Uninitialized)
       s_platform->Stop();
+    else if (stats_replay && state == Core::State::Paused &&
+             !Core::System::GetInstance().GetMovie().IsPlayingInput())
+      s_platform->Stop();
   });
 
 #ifdef _WIN32
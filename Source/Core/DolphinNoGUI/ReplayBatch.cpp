@@ -0,0 +1,163 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "DolphinNoGUI/ReplayBatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+#include <fmt/format.h>
+
+#include "Common/CommonPaths.h"
+#include "Common/FileSearch.h"
+#include "Common/StringUtil.h"
+
+namespace ReplayBatch
+{
+#ifdef _WIN32
+// Quotes an argument so that CommandLineToArgvW and the C runtime of the child read it back as it
+// was. Backslashes are only special in front of a quote, including the closing one.
+static std::string QuoteArgument(const std::string& arg)
+{
+  if (!arg.empty() && arg.find_first_of(" \t\n\v\"") == std::string::npos)
+    return arg;
+
+  std::string quoted = "\"";
+  size_t backslashes = 0;
+  for (const char c : arg)
+  {
+    if (c == '\\')
+    {
+      ++backslashes;
+      continue;
+    }
+    quoted.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+    quoted.push_back(c);
+    backslashes = 0;
+  }
+  quoted.append(backslashes * 2, '\\');
+  quoted.push_back('"');
+  return quoted;
+}
+#endif
+
+// Runs a process to completion. Returns its exit code, or -1 if it could not be started or did
+// not exit normally.
+static int RunProcess(const std::vector<std::string>& args)
+{
+#ifdef _WIN32
+  std::string command_line;
+  for (const std::string& arg : args)
+    command_line += QuoteArgument(arg) + ' ';
+
+  STARTUPINFOW sinfo{.cb = sizeof(sinfo)};
+  PROCESS_INFORMATION pinfo;
+  if (!CreateProcessW(nullptr, UTF8ToWString(command_line).data(), nullptr, nullptr, FALSE, 0,
+                      nullptr, nullptr, &sinfo, &pinfo))
+  {
+    return -1;
+  }
+
+  WaitForSingleObject(pinfo.hProcess, INFINITE);
+  DWORD exit_code = 0;
+  if (!GetExitCodeProcess(pinfo.hProcess, &exit_code))
+    exit_code = static_cast<DWORD>(-1);
+  CloseHandle(pinfo.hThread);
+  CloseHandle(pinfo.hProcess);
+  return static_cast<int>(exit_code);
+#else
+  std::vector<std::string> arg_storage = args;
+  std::vector<char*> argv;
+  for (std::string& arg : arg_storage)
+    argv.push_back(arg.data());
+  argv.push_back(nullptr);
+
+  pid_t pid;
+  if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0)
+    return -1;
+
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0)
+  {
+    if (errno != EINTR)
+      return -1;
+  }
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
+
+int Run(const std::vector<std::string>& child_args, const std::string& movie_dir,
+        const std::string& output_dir, unsigned int jobs)
+{
+  const std::vector<std::string> movies = Common::DoFileSearch({movie_dir}, {".dtm"});
+  if (movies.empty())
+  {
+    fprintf(stderr, "No movies found in %s\n", movie_dir.c_str());
+    return 1;
+  }
+
+  jobs = static_cast<unsigned int>(std::clamp<size_t>(jobs, 1, movies.size()));
+  fmt::print("Replaying {} movies, {} at a time\n", movies.size(), jobs);
+
+  // The emulator only exists once per process, so every movie gets its own. Movies are handed
+  // out one at a time, so a long game never holds up the rest of the batch. The processes share
+  // the user directory, but not the files they write, like the HUD stream.
+  std::atomic<size_t> next_movie = 0;
+  std::atomic<size_t> finished_movies = 0;
+  std::atomic<size_t> failed_movies = 0;
+  std::mutex output_lock;
+  const auto batch_start = std::chrono::steady_clock::now();
+  const auto worker = [&] {
+    for (size_t i = next_movie++; i < movies.size(); i = next_movie++)
+    {
+      std::vector<std::string> args = child_args;
+      args.push_back("--movie");
+      args.push_back(movies[i]);
+      std::string movie_name;
+      SplitPath(movies[i], nullptr, &movie_name, nullptr);
+      args.push_back("--stats_output_dir");
+      args.push_back(output_dir + DIR_SEP + movie_name);
+
+      const auto start = std::chrono::steady_clock::now();
+      const int exit_code = RunProcess(args);
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      if (exit_code != 0)
+        ++failed_movies;
+
+      std::lock_guard lk(output_lock);
+      fmt::print("[{}/{}] {} {} in {:.1f}s\n", ++finished_movies, movies.size(), movies[i],
+                 exit_code == 0 ? "replayed" : fmt::format("failed ({})", exit_code),
+                 elapsed.count());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < jobs; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - batch_start;
+  const size_t replayed = movies.size() - failed_movies;
+  fmt::print("Replayed {} of {} movies in {:.1f}s: {:.1f} games/hour\n", replayed, movies.size(),
+             elapsed.count(), replayed * 3600.0 / elapsed.count());
+
+  return failed_movies == 0 ? 0 : 1;
+}
+}  // namespace ReplayBatch
@@ -0,0 +1,17 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace ReplayBatch
+{
+// Replays every movie in movie_dir to regenerate its game stats, each in its own process.
+// child_args is the command line of such a process without the movie, which is passed with
+// --movie. Every process writes its files to a directory named after its movie in output_dir.
+// Runs up to jobs processes at once. Returns the exit code for the batch.
+int Run(const std::vector<std::string>& child_args, const std::string& movie_dir,
+        const std::string& output_dir, unsigned int jobs);
+}  // namespace ReplayBatch
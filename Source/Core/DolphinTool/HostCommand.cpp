@@ -0,0 +1,222 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "DolphinTool/HostCommand.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <OptionParser.h>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/Config/MainSettings.h"
+#include "Core/Config/NetplaySettings.h"
+#include "Core/HW/Sram.h"
+#include "Core/NetPlayDedicatedHost.h"
+#include "Core/NetPlayServer.h"
+#include "Core/TitleDatabase.h"
+#include "UICommon/GameFile.h"
+#include "UICommon/NetPlayLocalIndex.h"
+#include "UICommon/UICommon.h"
+
+namespace DolphinTool
+{
+static std::atomic<bool> s_stop_requested = false;
+
+static void SignalHandler(int)
+{
+  s_stop_requested = true;
+}
+
+// Reads an option that must lie in a range, the default if it is not set
+static std::optional<int> GetIntOption(const optparse::Values& options, const char* name,
+                                       int default_value, int min, int max)
+{
+  if (!options.is_set(name))
+    return default_value;
+
+  const int value = static_cast<int>(options.get(name));
+  if (value < min || value > max)
+    return std::nullopt;
+  return value;
+}
+
+int HostCommand(const std::vector<std::string>& args)
+{
+  optparse::OptionParser parser;
+
+  parser.usage("usage: host [options]...");
+
+  parser.add_option("-u", "--user")
+      .type("string")
+      .action("store")
+      .help("User folder path, which the NetPlay settings and the SRAM are read from. "
+            "Will be automatically created if this option is not set.")
+      .set_default("");
+
+  parser.add_option("-i", "--input")
+      .type("string")
+      .action("store")
+      .help("Path to disc image FILE of the game the lobbies play.")
+      .metavar("FILE");
+
+  parser.add_option("-p", "--port")
+      .type("int")
+      .action("store")
+      .help("Port of the first lobby, the others follow it. Defaults to 2626.")
+      .metavar("PORT");
+
+  parser.add_option("-s", "--sessions")
+      .type("int")
+      .action("store")
+      .help("Number of lobbies, at most 512. Defaults to 1.")
+      .metavar("COUNT");
+
+  parser.add_option("-t", "--threads")
+      .type("int")
+      .action("store")
+      .help("Number of threads the lobbies are spread over. Defaults to one per core.")
+      .metavar("COUNT");
+
+  parser.add_option("-m", "--max_players")
+      .type("int")
+      .action("store")
+      .help("Maximum number of players in a lobby. Defaults to 8.")
+      .metavar("COUNT");
+
+  parser.add_option("-a", "--address")
+      .type("string")
+      .action("store")
+      .help("Address players connect to, as the index lists it. Defaults to 127.0.0.1.")
+      .metavar("ADDRESS");
+
+  parser.add_option("-l", "--index_port")
+      .type("int")
+      .action("store")
+      .help("Port to list the lobbies on, for players who set their NetPlay index to this "
+            "machine. Not listed if this option is not set.")
+      .metavar("PORT");
+
+  const optparse::Values& options = parser.parse_args(args);
+
+  UICommon::SetUserDirectory(options["user"]);
+  UICommon::Init();
+
+  // Validate options
+  if (!options.is_set("input"))
+  {
+    fmt::print(std::cerr, "Error: No input set\n");
+    return EXIT_FAILURE;
+  }
+
+  constexpr int max_port = std::numeric_limits<u16>::max();
+  const std::optional<int> port = GetIntOption(options, "port", 2626, 1, max_port);
+  constexpr int max_sessions = NetPlay::DedicatedHost::MAX_SESSIONS;
+  const std::optional<int> sessions = GetIntOption(options, "sessions", 1, 1, max_sessions);
+  const std::optional<int> threads = GetIntOption(options, "threads", 0, 0, 1024);
+  const std::optional<int> max_players = GetIntOption(options, "max_players", 8, 1, 255);
+  const std::optional<int> index_port = GetIntOption(options, "index_port", 0, 1, max_port);
+  if (!port || !sessions || !threads || !max_players || !index_port)
+  {
+    fmt::print(std::cerr, "Error: Invalid option value\n");
+    return EXIT_FAILURE;
+  }
+  if (*port + *sessions - 1 > max_port)
+  {
+    fmt::print(std::cerr, "Error: Not enough ports for {} lobbies\n", *sessions);
+    return EXIT_FAILURE;
+  }
+
+  const UICommon::GameFile game(options["input"]);
+  if (!game.IsValid())
+  {
+    fmt::print(std::cerr, "Error: Unable to open disc image\n");
+    return EXIT_FAILURE;
+  }
+
+  NetPlay::DedicatedHost::Settings settings;
+  settings.first_port = static_cast<u16>(*port);
+  settings.sessions = static_cast<u32>(*sessions);
+  settings.threads = static_cast<u32>(*threads);
+  settings.max_players = static_cast<u32>(*max_players);
+  settings.buffer = Config::Get(Config::NETPLAY_BUFFER_SIZE);
+  settings.region = Config::Get(Config::NETPLAY_INDEX_REGION);
+  if (!Config::Get(Config::NETPLAY_INDEX_NAME).empty())
+    settings.name = Config::Get(Config::NETPLAY_INDEX_NAME);
+  if (options.is_set("address"))
+    settings.address = options["address"];
+
+  const Core::TitleDatabase title_database;
+  settings.game.sync_identifier = game.GetSyncIdentifier();
+  settings.game.name = game.GetNetPlayName(title_database);
+  settings.game.region =
+      Config::GetDirectoryForRegion(Config::ToGameCubeRegion(game.GetRegion()));
+  settings.game.settings = NetPlay::GetNetSettingsFromConfig(game.GetGameID(), game.GetRevision());
+  InitSRAM(&settings.game.settings.sram, File::GetUserPath(F_GCSRAM_IDX));
+
+  NetPlay::DedicatedHost host(std::move(settings));
+  if (!host.IsValid())
+  {
+    fmt::print(std::cerr, "Error: Could not listen on ports {} to {}\n", *port,
+               *port + *sessions - 1);
+    return EXIT_FAILURE;
+  }
+
+  std::unique_ptr<NetPlayLocalIndex> index;
+  if (options.is_set("index_port"))
+  {
+    index = std::make_unique<NetPlayLocalIndex>(static_cast<u16>(*index_port),
+                                                [&host] { return host.GetSessions(); });
+    if (!index->IsValid())
+    {
+      fmt::print(std::cerr, "Error: Could not list the lobbies on port {}\n", *index_port);
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::signal(SIGINT, SignalHandler);
+  std::signal(SIGTERM, SignalHandler);
+
+  fmt::print(std::cout, "Hosting {} lobbies of {} on ports {} to {}\n", *sessions,
+             game.GetNetPlayName(title_database), *port, *port + *sessions - 1);
+  if (index)
+    fmt::print(std::cout, "Listing them on port {}\n", *index_port);
+
+  auto last_print = std::chrono::steady_clock::now();
+  NetPlay::DedicatedHost::Stats last_stats;
+  while (!s_stop_requested)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_print < std::chrono::seconds(10))
+      continue;
+
+    const NetPlay::DedicatedHost::Stats stats = host.GetStats();
+    const double busy_percent =
+        100.0 * std::chrono::duration<double>(stats.busy - last_stats.busy).count() /
+        std::chrono::duration<double>(now - last_print).count();
+    fmt::print(std::cout,
+               "{} players, {} games running, {} started, {} inputs relayed, {} KiB in, {} KiB "
+               "out, {:.1f}% busy\n",
+               stats.players, stats.games_running, stats.games_started, stats.inputs_relayed,
+               stats.bytes_received / 1024, stats.bytes_sent / 1024, busy_percent);
+    last_print = now;
+    last_stats = stats;
+  }
+
+  return EXIT_SUCCESS;
+}
+}  // namespace DolphinTool
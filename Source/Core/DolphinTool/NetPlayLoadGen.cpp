@@ -0,0 +1,411 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Synthetic load for the lobbies of `dolphin-tool host`: players that join every lobby, start a
+// game once all of them are in, and send an input every frame like a busy dedicated host would
+// see. Reports the latency of relaying the inputs from one player to the others. The host prints
+// how busy it was itself.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+#include <enet/enet.h>
+#include <fmt/format.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/ENet.h"
+#include "Common/SFMLHelper.h"
+#include "Common/Version.h"
+#include "Core/NetPlayProto.h"
+#include "Core/SyncIdentifier.h"
+
+using namespace NetPlay;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr std::chrono::microseconds FRAME_TIME{16683};
+constexpr std::chrono::seconds TIMEOUT{30};
+
+struct Options
+{
+  std::string server = "127.0.0.1";
+  u16 port = 2626;
+  u32 lobbies = 125;
+  u32 players = 4;
+  double seconds = 10;
+  u32 threads = 4;
+};
+
+struct ReceivedPad
+{
+  PadIndex map;
+  u16 sequence;
+  Clock::time_point time;
+};
+
+// A player as the lobby sees one, without anything emulated behind it
+class FakeClient
+{
+public:
+  FakeClient(const std::string& server, u16 port)
+  {
+    m_host.reset(enet_host_create(nullptr, 1, CHANNEL_COUNT, 0, 0));
+    ENetAddress address;
+    enet_address_set_host(&address, server.c_str());
+    address.port = port;
+    m_peer = enet_host_connect(m_host.get(), &address, CHANNEL_COUNT, 0);
+  }
+
+  void Service()
+  {
+    ENetEvent event;
+    while (enet_host_service(m_host.get(), &event, 0) > 0)
+    {
+      switch (event.type)
+      {
+      case ENET_EVENT_TYPE_CONNECT:
+      {
+        sf::Packet hello;
+        hello << Common::GetScmRevGitStr() << std::string("loadgen") << std::string("Player")
+              << std::string();
+        Send(hello);
+        break;
+      }
+      case ENET_EVENT_TYPE_RECEIVE:
+      {
+        sf::Packet packet;
+        packet.append(event.packet->data, event.packet->dataLength);
+        enet_packet_destroy(event.packet);
+        OnData(packet);
+        break;
+      }
+      case ENET_EVENT_TYPE_DISCONNECT:
+        disconnected = true;
+        break;
+      default:
+        break;
+      }
+    }
+    enet_host_flush(m_host.get());
+  }
+
+  void Send(const sf::Packet& packet)
+  {
+    Common::ENet::SendPacket(m_peer, packet, DEFAULT_CHANNEL);
+  }
+
+  void SendStatus()
+  {
+    sf::Packet packet;
+    packet << MessageID::GameStatus << SyncIdentifierComparison::SameGame;
+    Send(packet);
+  }
+
+  void SendStart()
+  {
+    sf::Packet packet;
+    packet << MessageID::ChatMessage << std::string("/start");
+    Send(packet);
+  }
+
+  void SendPad(u16 sequence)
+  {
+    sf::Packet packet;
+    packet << MessageID::PadData << GetPad() << sequence;
+    for (int i = 0; i < 8; ++i)
+      packet << u8(0x80);
+    packet << true;
+    Send(packet);
+  }
+
+  PadIndex GetPad() const
+  {
+    const auto it = std::find(pad_map.begin(), pad_map.end(), pid);
+    return it != pad_map.end() ? static_cast<PadIndex>(it - pad_map.begin()) : -1;
+  }
+
+  PlayerId pid = 0;
+  bool disconnected = false;
+  bool sent_status = false;
+  u32 game = 0;
+  PadMappingArray pad_map{};
+  std::map<PlayerId, SyncIdentifierComparison> statuses;
+  std::vector<ReceivedPad> pads;
+  std::vector<Clock::time_point> sent;
+
+private:
+  void OnData(sf::Packet& packet)
+  {
+    MessageID mid;
+    packet >> mid;
+
+    if (pid == 0)
+    {
+      if (mid == MessageID::ConnectionSuccessful)
+        packet >> pid;
+      else
+        disconnected = true;
+      return;
+    }
+
+    switch (mid)
+    {
+    case MessageID::Ping:
+    {
+      u32 key;
+      packet >> key;
+      sf::Packet pong;
+      pong << MessageID::Pong << key;
+      Send(pong);
+      break;
+    }
+    case MessageID::PadMapping:
+      for (PlayerId& mapping : pad_map)
+        packet >> mapping;
+      break;
+    case MessageID::GameStatus:
+    {
+      PlayerId player;
+      SyncIdentifierComparison status;
+      packet >> player >> status;
+      statuses[player] = status;
+      break;
+    }
+    case MessageID::StartGame:
+    {
+      packet >> game;
+      sf::Packet started;
+      started << MessageID::StartGame << game;
+      Send(started);
+      break;
+    }
+    case MessageID::PadData:
+    {
+      const auto now = Clock::now();
+      while (!packet.endOfPacket())
+      {
+        PadIndex map;
+        u16 sequence;
+        u8 byte;
+        bool connected;
+        packet >> map >> sequence;
+        for (int i = 0; i < 8; ++i)
+          packet >> byte;
+        packet >> connected;
+        pads.push_back({map, sequence, now});
+      }
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  Common::ENet::ENetHostPtr m_host;
+  ENetPeer* m_peer = nullptr;
+};
+
+using Lobby = std::vector<std::unique_ptr<FakeClient>>;
+
+std::atomic<u32> s_started_threads{0};
+std::atomic<bool> s_go{false};
+std::atomic<bool> s_failed{false};
+
+template <typename Predicate>
+bool RunUntil(const std::vector<FakeClient*>& clients, Predicate predicate)
+{
+  const auto deadline = Clock::now() + TIMEOUT;
+  while (!predicate())
+  {
+    if (Clock::now() > deadline || s_failed)
+      return false;
+    for (FakeClient* client : clients)
+      client->Service();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// Every lobby is driven by a single thread, which also handles the inputs of its players
+void Drive(const Options& options, std::vector<Lobby>& lobbies, u32 thread, u16 frames)
+{
+  std::vector<Lobby*> own;
+  std::vector<FakeClient*> clients;
+  for (u32 i = thread; i < options.lobbies; i += options.threads)
+  {
+    Lobby& lobby = lobbies[i];
+    const u16 port = static_cast<u16>(options.port + i);
+    for (u32 j = 0; j < options.players; ++j)
+    {
+      lobby.push_back(std::make_unique<FakeClient>(options.server, port));
+      lobby.back()->sent.resize(frames);
+      clients.push_back(lobby.back().get());
+    }
+    own.push_back(&lobby);
+  }
+
+  // The first player of a lobby starts the game once everyone has it
+  std::vector<bool> sent_start(own.size());
+  const bool started = RunUntil(clients, [&] {
+    for (FakeClient* client : clients)
+    {
+      if (client->pid != 0 && !client->sent_status)
+      {
+        client->SendStatus();
+        client->sent_status = true;
+      }
+    }
+    bool all_started = true;
+    for (size_t i = 0; i < own.size(); ++i)
+    {
+      Lobby& lobby = *own[i];
+      FakeClient& owner = **std::min_element(
+          lobby.begin(), lobby.end(), [](auto& x, auto& y) { return x->pid < y->pid; });
+      if (!sent_start[i] && owner.pid != 0 && owner.statuses.size() == lobby.size() &&
+          owner.GetPad() != -1)
+      {
+        owner.SendStart();
+        sent_start[i] = true;
+      }
+      all_started &= std::all_of(lobby.begin(), lobby.end(), [](auto& c) { return c->game != 0; });
+    }
+    return all_started;
+  });
+  if (!started)
+    s_failed = true;
+
+  ++s_started_threads;
+  while (!s_go && !s_failed)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  if (s_failed)
+    return;
+
+  const auto start = Clock::now();
+  u16 frame = 0;
+  const size_t expected = static_cast<size_t>(frames) * (options.players - 1);
+  const bool done = RunUntil(clients, [&] {
+    for (; frame < frames && Clock::now() >= start + frame * FRAME_TIME; ++frame)
+    {
+      for (FakeClient* client : clients)
+      {
+        client->sent[frame] = Clock::now();
+        client->SendPad(frame);
+      }
+    }
+    return frame == frames && std::all_of(clients.begin(), clients.end(), [&](auto* client) {
+             return client->pads.size() >= expected;
+           });
+  });
+  if (!done)
+    s_failed = true;
+}
+
+bool ParseOptions(int argc, char** argv, Options* options)
+{
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    const std::string arg = argv[i];
+    const char* value = argv[i + 1];
+    if (arg == "--server")
+      options->server = value;
+    else if (arg == "--port")
+      options->port = static_cast<u16>(std::atoi(value));
+    else if (arg == "--lobbies")
+      options->lobbies = std::max(std::atoi(value), 1);
+    else if (arg == "--players")
+      options->players = std::max(std::atoi(value), 2);
+    else if (arg == "--seconds")
+      options->seconds = std::atof(value);
+    else if (arg == "--threads")
+      options->threads = std::max(std::atoi(value), 1);
+    else
+      return false;
+  }
+  return argc % 2 == 1;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if (!ParseOptions(argc, argv, &options))
+  {
+    fmt::print(stderr,
+               "usage: {} [--server address] [--port first port] [--lobbies count] "
+               "[--players per lobby] [--seconds duration] [--threads count]\n",
+               argv[0]);
+    return 1;
+  }
+  if (enet_initialize() != 0)
+  {
+    fmt::print(stderr, "could not initialize ENet\n");
+    return 1;
+  }
+
+  // The sequence numbers of the inputs are 16 bits
+  const u16 frames = static_cast<u16>(
+      std::clamp(options.seconds * 1000000.0 / FRAME_TIME.count(), 1.0, 65535.0));
+  options.threads = std::min(options.threads, options.lobbies);
+
+  std::vector<Lobby> lobbies(options.lobbies);
+  std::vector<std::thread> threads;
+  for (u32 i = 0; i < options.threads; ++i)
+    threads.emplace_back(Drive, std::cref(options), std::ref(lobbies), i, frames);
+  while (s_started_threads != options.threads)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  const auto start = Clock::now();
+  s_go = true;
+  for (std::thread& thread : threads)
+    thread.join();
+  const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  if (s_failed)
+  {
+    fmt::print(stderr, "not every lobby started a game and relayed every input within {}s\n",
+               TIMEOUT.count());
+    enet_deinitialize();
+    return 1;
+  }
+
+  std::vector<double> latencies;
+  for (const Lobby& lobby : lobbies)
+  {
+    for (const auto& receiver : lobby)
+    {
+      for (const ReceivedPad& pad : receiver->pads)
+      {
+        const auto sender = std::find_if(lobby.begin(), lobby.end(),
+                                         [&](auto& client) { return client->GetPad() == pad.map; });
+        if (sender == lobby.end() || pad.sequence >= (*sender)->sent.size())
+          continue;
+        latencies.push_back(std::chrono::duration<double, std::milli>(
+                                pad.time - (*sender)->sent[pad.sequence])
+                                .count());
+      }
+    }
+  }
+  std::sort(latencies.begin(), latencies.end());
+  const auto percentile = [&latencies](double p) -> double {
+    if (latencies.empty())
+      return 0;
+    return latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+  };
+
+  fmt::print("{} lobbies of {} for {} frames in {:.1f}s: {} inputs relayed\n", options.lobbies,
+             options.players, frames, seconds, latencies.size());
+  fmt::print("relay latency: p50 {:.2f}ms p99 {:.2f}ms max {:.2f}ms\n", percentile(0.5),
+             percentile(0.99), percentile(1.0));
+  enet_deinitialize();
+  return 0;
+}
@@ -0,0 +1,118 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "DolphinTool/RelayCommand.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <OptionParser.h>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayBroadcast.h"
+
+namespace DolphinTool
+{
+static std::atomic<bool> s_stop_requested = false;
+
+static void SignalHandler(int)
+{
+  s_stop_requested = true;
+}
+
+int RelayCommand(const std::vector<std::string>& args)
+{
+  optparse::OptionParser parser;
+
+  parser.usage("usage: relay [options]...");
+
+  parser.add_option("-p", "--port")
+      .type("int")
+      .action("store")
+      .help(fmt::format("Port the host and the spectators connect to. Defaults to {}.",
+                        NetPlay::DEFAULT_RELAY_PORT))
+      .metavar("PORT");
+
+  parser.add_option("-m", "--max_spectators")
+      .type("int")
+      .action("store")
+      .help("Maximum number of spectators. Defaults to 500.")
+      .metavar("COUNT");
+
+  parser.add_option("-k", "--key")
+      .type("string")
+      .action("store")
+      .help("Key that hosts need to broadcast, which they set as their broadcast key.")
+      .metavar("KEY");
+
+  const optparse::Values& options = parser.parse_args(args);
+
+  // Validate options
+  int port = NetPlay::DEFAULT_RELAY_PORT;
+  if (options.is_set("port"))
+  {
+    port = static_cast<int>(options.get("port"));
+    if (port < 1 || port > std::numeric_limits<u16>::max())
+    {
+      fmt::print(std::cerr, "Error: Invalid port\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  int max_spectators = 500;
+  if (options.is_set("max_spectators"))
+  {
+    max_spectators = static_cast<int>(options.get("max_spectators"));
+    if (max_spectators < 1)
+    {
+      fmt::print(std::cerr, "Error: Invalid number of spectators\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!options.is_set("key") || options["key"].empty())
+  {
+    fmt::print(std::cerr, "Error: No key set, anyone could broadcast\n");
+    return EXIT_FAILURE;
+  }
+
+  NetPlay::BroadcastRelay relay(static_cast<u16>(port), static_cast<u32>(max_spectators),
+                                options["key"]);
+  if (!relay.IsValid())
+  {
+    fmt::print(std::cerr, "Error: Could not listen on port {}\n", port);
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGINT, SignalHandler);
+  std::signal(SIGTERM, SignalHandler);
+
+  fmt::print(std::cout, "Relaying broadcasts on port {}\n", port);
+  auto last_print = std::chrono::steady_clock::now();
+  while (!s_stop_requested)
+  {
+    relay.Service(std::chrono::milliseconds(100));
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_print < std::chrono::seconds(10))
+      continue;
+    last_print = now;
+
+    const NetPlay::BroadcastRelay::Stats& stats = relay.GetStats();
+    fmt::print(std::cout,
+               "{}host, {} spectators, {} batches, {} keyframes, {} KiB in, {} KiB out\n",
+               relay.HasSource() ? "" : "no ", stats.spectators, stats.batches, stats.keyframes,
+               stats.bytes_received / 1024, stats.bytes_sent / 1024);
+  }
+
+  return EXIT_SUCCESS;
+}
+}  // namespace DolphinTool
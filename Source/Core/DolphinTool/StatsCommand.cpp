@@ -0,0 +1,169 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "DolphinTool/StatsCommand.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <OptionParser.h>
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Core/MSB_StatFile.h"
+#include "Core/MSB_StatTracker.h"
+
+namespace DolphinTool
+{
+static bool ConvertStatFile(StatTracker& tracker, const std::string& input_path,
+                            const std::string& output_dir, std::mutex& output_lock)
+{
+  std::string name;
+  SplitPath(input_path, nullptr, &name, nullptr);
+
+  const StatFile::ReadResult result = StatFile::read(input_path, tracker);
+  if (result == StatFile::ReadResult::Invalid)
+  {
+    std::lock_guard lk(output_lock);
+    fmt::print(std::cerr, "Error: {} is not a valid stat file\n", input_path);
+    return false;
+  }
+
+  const std::string decoded_path = fmt::format("{}decoded.{}.json", output_dir, name);
+  const std::string raw_path = fmt::format("{}{}.json", output_dir, name);
+  if (!tracker.writeJSONFiles(decoded_path, raw_path))
+  {
+    std::lock_guard lk(output_lock);
+    fmt::print(std::cerr, "Error: Could not write {}\n", raw_path);
+    return false;
+  }
+
+  std::lock_guard lk(output_lock);
+  fmt::print(std::cout, "{} -> {}{}\n", input_path, raw_path,
+             result == StatFile::ReadResult::Truncated ? " (incomplete game)" : "");
+  return true;
+}
+
+int StatsCommand(const std::vector<std::string>& args)
+{
+  optparse::OptionParser parser;
+
+  parser.usage("usage: stats [options]...");
+
+  parser.add_option("-i", "--input")
+      .type("string")
+      .action("store")
+      .help("Path to a stat FILE to convert.")
+      .metavar("FILE");
+
+  parser.add_option("-d", "--directory")
+      .type("string")
+      .action("store")
+      .help("Convert every stat file in DIR.")
+      .metavar("DIR");
+
+  parser.add_option("-o", "--output")
+      .type("string")
+      .action("store")
+      .help("Directory the JSON files are written to. Defaults to the directory of the input.")
+      .metavar("DIR");
+
+  parser.add_option("-j", "--jobs")
+      .type("int")
+      .action("store")
+      .help("Number of files converted in parallel in directory mode. "
+            "Defaults to the number of hardware threads.")
+      .metavar("JOBS");
+
+  const optparse::Values& options = parser.parse_args(args);
+
+  // Validate options
+  if (options.is_set("input") == options.is_set("directory"))
+  {
+    fmt::print(std::cerr, "Error: Set exactly one of input and directory\n");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> input_paths;
+  std::string output_dir;
+  if (options.is_set("input"))
+  {
+    input_paths.push_back(options["input"]);
+    SplitPath(input_paths.back(), &output_dir, nullptr, nullptr);
+  }
+  else
+  {
+    output_dir = options["directory"];
+    input_paths = Common::DoFileSearch({output_dir}, {StatFile::cExtension});
+  }
+
+  if (options.is_set("output"))
+    output_dir = options["output"];
+  if (!output_dir.empty() && output_dir.back() != '/' && output_dir.back() != '\\')
+    output_dir += '/';
+  if (!output_dir.empty() && !File::IsDirectory(output_dir) && !File::CreateFullPath(output_dir))
+  {
+    fmt::print(std::cerr, "Error: Could not create {}\n", output_dir);
+    return EXIT_FAILURE;
+  }
+
+  if (input_paths.empty())
+  {
+    fmt::print(std::cerr, "Error: No stat files found\n");
+    return EXIT_FAILURE;
+  }
+
+  unsigned int jobs = std::max(std::thread::hardware_concurrency(), 1u);
+  if (options.is_set("jobs"))
+  {
+    const int requested_jobs = static_cast<int>(options.get("jobs"));
+    if (requested_jobs < 1)
+    {
+      fmt::print(std::cerr, "Error: Invalid number of jobs\n");
+      return EXIT_FAILURE;
+    }
+    jobs = static_cast<unsigned int>(requested_jobs);
+  }
+  jobs = std::min<size_t>(jobs, input_paths.size());
+
+  // Files are handed out one at a time, so a long game never holds up the rest of the batch.
+  // Every worker decodes into its own offline tracker and reuses it for all of its files.
+  std::atomic<size_t> next_file = 0;
+  std::atomic<size_t> failed_files = 0;
+  std::mutex output_lock;
+  const auto worker = [&] {
+    const auto tracker = std::make_unique<StatTracker>(StatTracker::Mode::Offline);
+    for (size_t i = next_file++; i < input_paths.size(); i = next_file++)
+    {
+      if (!ConvertStatFile(*tracker, input_paths[i], output_dir, output_lock))
+        ++failed_files;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < jobs; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  if (failed_files != 0)
+  {
+    fmt::print(std::cerr, "Error: {} of {} files could not be converted\n", failed_files.load(),
+               input_paths.size());
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+}  // namespace DolphinTool
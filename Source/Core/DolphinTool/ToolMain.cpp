@@ -18,13 +18,16 @@
 
 #include "DolphinTool/ConvertCommand.h"
 #include "DolphinTool/HeaderCommand.h"
+#include "DolphinTool/HostCommand.h"
+#include "DolphinTool/RelayCommand.h"
+#include "DolphinTool/StatsCommand.h"
 #include "DolphinTool/VerifyCommand.h"
 
 static void PrintUsage()
 {
   fmt::print(std::cerr, "usage: dolphin-tool COMMAND -h\n"
                         "\n"
-                        "commands supported: [convert, verify, header]\n");
+                        "commands supported: [convert, verify, header, stats, relay, host]\n");
 }
 
 #ifdef _WIN32
@@ -51,6 +54,12 @@ int main(int argc, char* argv[])
     return DolphinTool::VerifyCommand(args);
   else if (command_str == "header")
     return DolphinTool::HeaderCommand(args);
+  else if (command_str == "stats")
+    return DolphinTool::StatsCommand(args);
+  else if (command_str == "relay")
+    return DolphinTool::RelayCommand(args);
+  else if (command_str == "host")
+    return DolphinTool::HostCommand(args);
   PrintUsage();
   return EXIT_FAILURE;
 }
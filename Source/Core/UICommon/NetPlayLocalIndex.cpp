@@ -0,0 +1,203 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "UICommon/NetPlayLocalIndex.h"
+
+#include <map>
+
+#include <fmt/format.h>
+#include <picojson.h>
+
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+
+// Requests are a line and a few headers, anything longer is not from the index client
+constexpr size_t MAX_REQUEST_SIZE = 8192;
+constexpr u32 RECEIVE_TIMEOUT_MS = 1000;
+// How often the thread checks whether it should stop
+constexpr u32 ACCEPT_TIMEOUT_MS = 100;
+
+NetPlayLocalIndex::NetPlayLocalIndex(u16 port, SessionSource source) : m_source(std::move(source))
+{
+  if (enet_initialize() != 0)
+    return;
+
+  m_socket = enet_socket_create(ENET_SOCKET_TYPE_STREAM);
+  if (m_socket == ENET_SOCKET_NULL)
+    return;
+
+  ENetAddress address;
+  address.host = ENET_HOST_ANY;
+  address.port = port;
+  enet_socket_set_option(m_socket, ENET_SOCKOPT_REUSEADDR, 1);
+  if (enet_socket_bind(m_socket, &address) != 0 || enet_socket_listen(m_socket, 16) != 0)
+  {
+    enet_socket_destroy(m_socket);
+    m_socket = ENET_SOCKET_NULL;
+    return;
+  }
+
+  m_thread = std::thread(&NetPlayLocalIndex::ThreadFunc, this);
+}
+
+NetPlayLocalIndex::~NetPlayLocalIndex()
+{
+  m_stop = true;
+  if (m_thread.joinable())
+    m_thread.join();
+  if (m_socket != ENET_SOCKET_NULL)
+    enet_socket_destroy(m_socket);
+}
+
+static std::string DecodeComponent(std::string_view component)
+{
+  std::string decoded;
+  for (size_t i = 0; i < component.size(); ++i)
+  {
+    u32 value;
+    if (component[i] == '%' && i + 2 < component.size() &&
+        TryParse("0x" + std::string(component.substr(i + 1, 2)), &value))
+    {
+      decoded += static_cast<char>(value);
+      i += 2;
+    }
+    else
+    {
+      decoded += component[i] == '+' ? ' ' : component[i];
+    }
+  }
+  return decoded;
+}
+
+std::string NetPlayLocalIndex::MakeListResponse(const std::vector<NetPlaySession>& sessions,
+                                                std::string_view query)
+{
+  std::map<std::string, std::string> filters;
+  for (const std::string& pair : SplitString(std::string(query), '&'))
+  {
+    const size_t equals = pair.find('=');
+    if (equals != std::string::npos)
+      filters[pair.substr(0, equals)] = DecodeComponent(pair.substr(equals + 1));
+  }
+
+  const auto matches = [&filters](const std::string& key, const auto& predicate) {
+    const auto it = filters.find(key);
+    return it == filters.end() || predicate(it->second);
+  };
+
+  picojson::array entries;
+  for (const NetPlaySession& session : sessions)
+  {
+    if (!matches("name",
+                 [&](const std::string& name) {
+                   return session.name.find(name) != std::string::npos;
+                 }) ||
+        !matches("version", [&](const std::string& version) { return session.version == version; }) ||
+        !matches("region", [&](const std::string& region) { return session.region == region; }) ||
+        !matches("password",
+                 [&](const std::string& password) {
+                   return (password == "1") == session.has_password;
+                 }) ||
+        !matches("in_game",
+                 [&](const std::string& in_game) { return (in_game == "1") == session.in_game; }))
+    {
+      continue;
+    }
+
+    picojson::object entry;
+    entry["name"] = picojson::value(session.name);
+    entry["region"] = picojson::value(session.region);
+    entry["method"] = picojson::value(session.method);
+    entry["game"] = picojson::value(session.game_id);
+    entry["server_id"] = picojson::value(session.server_id);
+    entry["password"] = picojson::value(session.has_password);
+    entry["player_count"] = picojson::value(static_cast<double>(session.player_count));
+    entry["port"] = picojson::value(static_cast<double>(session.port));
+    entry["in_game"] = picojson::value(session.in_game);
+    entry["version"] = picojson::value(session.version);
+    entries.emplace_back(std::move(entry));
+  }
+
+  picojson::object response;
+  response["status"] = picojson::value("OK");
+  response["sessions"] = picojson::value(std::move(entries));
+  return picojson::value(std::move(response)).serialize();
+}
+
+void NetPlayLocalIndex::ThreadFunc()
+{
+  Common::SetCurrentThreadName("Local NetPlay index");
+
+  while (!m_stop)
+  {
+    u32 condition = ENET_SOCKET_WAIT_RECEIVE;
+    if (enet_socket_wait(m_socket, &condition, ACCEPT_TIMEOUT_MS) != 0 ||
+        !(condition & ENET_SOCKET_WAIT_RECEIVE))
+    {
+      continue;
+    }
+
+    const ENetSocket connection = enet_socket_accept(m_socket, nullptr);
+    if (connection == ENET_SOCKET_NULL)
+      continue;
+    HandleConnection(connection);
+    enet_socket_shutdown(connection, ENET_SOCKET_SHUTDOWN_READ_WRITE);
+    enet_socket_destroy(connection);
+  }
+}
+
+void NetPlayLocalIndex::HandleConnection(ENetSocket socket)
+{
+  std::string request;
+  while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_SIZE)
+  {
+    u32 condition = ENET_SOCKET_WAIT_RECEIVE;
+    if (enet_socket_wait(socket, &condition, RECEIVE_TIMEOUT_MS) != 0 ||
+        !(condition & ENET_SOCKET_WAIT_RECEIVE))
+    {
+      return;
+    }
+
+    char data[1024];
+    ENetBuffer buffer;
+    buffer.data = data;
+    buffer.dataLength = sizeof(data);
+    const int received = enet_socket_receive(socket, nullptr, &buffer, 1);
+    if (received <= 0)
+      return;
+    request.append(data, received);
+  }
+
+  // Like "GET /v0/list?region=EU HTTP/1.1"
+  const std::vector<std::string> request_line =
+      SplitString(request.substr(0, request.find("\r\n")), ' ');
+  const std::string target = request_line.size() == 3 ? request_line[1] : "";
+  const size_t question_mark = target.find('?');
+  const std::string_view path = std::string_view(target).substr(0, question_mark);
+  const std::string_view query =
+      question_mark != std::string::npos ? std::string_view(target).substr(question_mark + 1) :
+                                           std::string_view();
+
+  const bool found = request_line.size() == 3 && request_line[0] == "GET" && path == "/v0/list";
+  const std::string body = found ? MakeListResponse(m_source(), query) :
+                                   std::string(R"({"status":"NOT_FOUND"})");
+  const std::string response =
+      fmt::format("HTTP/1.1 {}\r\nContent-Type: application/json\r\nContent-Length: {}\r\n"
+                  "Connection: close\r\n\r\n{}",
+                  found ? "200 OK" : "404 Not Found", body.size(), body);
+  DEBUG_LOG_FMT(NETPLAY, "Local index: {} {}", request_line.size() == 3 ? target : "?",
+                found ? 200 : 404);
+
+  size_t sent = 0;
+  while (sent < response.size())
+  {
+    ENetBuffer buffer;
+    buffer.data = const_cast<char*>(response.data() + sent);
+    buffer.dataLength = response.size() - sent;
+    const int result = enet_socket_send(socket, nullptr, &buffer, 1);
+    if (result <= 0)
+      return;
+    sent += result;
+  }
+}
@@ -0,0 +1,45 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <enet/enet.h>
+
+#include "Common/CommonTypes.h"
+#include "UICommon/NetPlayIndex.h"
+
+// A stand-in for the index server on the local machine, for lobbies that are not announced to the
+// public one, like those of a dedicated host. Players who set their index server to it see the
+// lobbies in their browser. Only the list is served, at /v0/list, with the filters of the index.
+class NetPlayLocalIndex
+{
+public:
+  using SessionSource = std::function<std::vector<NetPlaySession>()>;
+
+  NetPlayLocalIndex(u16 port, SessionSource source);
+  ~NetPlayLocalIndex();
+  NetPlayLocalIndex(const NetPlayLocalIndex&) = delete;
+  NetPlayLocalIndex& operator=(const NetPlayLocalIndex&) = delete;
+
+  bool IsValid() const { return m_socket != ENET_SOCKET_NULL; }
+
+  // The body of the response to a list request, for a query like "region=EU&in_game=0"
+  static std::string MakeListResponse(const std::vector<NetPlaySession>& sessions,
+                                      std::string_view query);
+
+private:
+  void ThreadFunc();
+  void HandleConnection(ENetSocket socket);
+
+  SessionSource m_source;
+  ENetSocket m_socket = ENET_SOCKET_NULL;
+  std::thread m_thread;
+  std::atomic<bool> m_stop = false;
+};
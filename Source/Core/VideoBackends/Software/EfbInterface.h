@@ -58,5 +58,7 @@ void EncodeXFB(u8* xfb_in_ram, u32 memory_stride, const MathUtil::Rectangle<int>
 
 u32 GetPerfQueryResult(PerfQueryType type);
 void ResetPerfQuery();
+// Counted for the calling thread until it flushes its counts
 void IncPerfCounterQuadCount(PerfQueryType type);
+void FlushPerfCounters();
 }  // namespace EfbInterface
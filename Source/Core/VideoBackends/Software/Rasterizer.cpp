@@ -4,14 +4,25 @@
 #include "VideoBackends/Software/Rasterizer.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include <fmt/format.h>
+
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+#include "Common/Thread.h"
 
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/SWBoundingBox.h"
 #include "VideoBackends/Software/Tev.h"
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/BPMemory.h"
@@ -96,21 +107,104 @@ struct Slope
   }
 };
 
-static Slope ZSlope;
-static Slope WSlope;
-static Slope ColorSlopes[2][4];
-static Slope TexSlopes[8][3];
+// A triangle clipped to a scissor rectangle, with everything needed to draw any part of it
+struct Triangle
+{
+  Slope ZSlope;
+  Slope WSlope;
+  Slope ColorSlopes[2][4];
+  Slope TexSlopes[8][3];
+
+  // Deltas and half-edge constants of the edges, in 28.4 fixed point
+  s32 DX12, DX23, DX31;
+  s32 DY12, DY23, DY31;
+  s32 C1, C2, C3;
 
-static Tev tev;
-static RasterBlock rasterBlock;
+  // Bounding rectangle
+  s32 minx, maxx, miny, maxy;
+};
+
+// What a thread needs to draw pixels
+struct DrawContext
+{
+  Tev tev;
+  RasterBlock rasterBlock;
+  u32 rasterizedPixels = 0;
+
+  // The last block with shaded pixels in the order of a single thread, out of those this thread
+  // drew since the last flush, and what its last pixel left behind. 0 when there is none.
+  u64 lastBlock = 0;
+  Tev::CarriedState carried;
+};
+
+// Triangles are queued in the tiles of the EFB they cover, and the tiles are drawn by all threads
+// at once, each drawing the triangles of a tile in order. A multiple of the block size, for no
+// block to be split between tiles.
+static constexpr s32 TILE_SIZE = 32;
+static constexpr s32 TILES_X = (EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+static constexpr s32 TILES_Y = (EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+// Triangles are drawn before the end of a draw call once this many are queued
+static constexpr size_t MAX_QUEUED_TRIANGLES = 2048;
+
+static Slope ZSlope;
 
 static std::vector<BPFunctions::ScissorRect> scissors;
 
+static std::vector<Triangle> s_triangles;
+static std::array<std::vector<u32>, TILES_X * TILES_Y> s_tile_triangles;
+static std::vector<u32> s_used_tiles;
+static std::atomic<size_t> s_next_tile;
+
+// The first context is the GPU thread's, which draws right away when it is the only one
+static std::vector<std::unique_ptr<DrawContext>> s_contexts;
+static std::vector<std::thread> s_threads;
+static std::mutex s_threads_lock;
+static std::condition_variable s_work_available;
+static std::condition_variable s_work_done;
+static u64 s_work_generation = 0;
+static size_t s_busy_threads = 0;
+static bool s_exit_threads = false;
+// Whether the triangles of the current draw are drawn right away on the GPU thread, in the order
+// a single thread would draw their pixels
+static bool s_draw_in_order = true;
+
+static void WorkerThread(size_t index);
+
 void Init()
 {
   // The other slopes are set each for each primitive drawn, but zfreeze means that the z slope
   // needs to be set to an (untested) default value.
   ZSlope = Slope();
+
+  Shutdown();
+
+  const u32 num_threads = g_Config.GetSWRasterizerThreads();
+  s_contexts.clear();
+  for (u32 i = 0; i < num_threads; i++)
+    s_contexts.push_back(std::make_unique<DrawContext>());
+
+  // The threads start out waiting for the first generation
+  s_work_generation = 0;
+  s_exit_threads = false;
+  for (u32 i = 1; i < num_threads; i++)
+    s_threads.emplace_back(WorkerThread, i);
+}
+
+void Shutdown()
+{
+  {
+    std::lock_guard lk(s_threads_lock);
+    s_exit_threads = true;
+  }
+  s_work_available.notify_all();
+  for (std::thread& thread : s_threads)
+    thread.join();
+  s_threads.clear();
+
+  s_triangles.clear();
+  for (u32 tile : s_used_tiles)
+    s_tile_triangles[tile].clear();
+  s_used_tiles.clear();
 }
 
 void ScissorChanged()
@@ -142,14 +236,15 @@ static inline int iround(float x)
 
 void SetTevKonstColors()
 {
-  tev.SetKonstColors();
+  for (auto& context : s_contexts)
+    context->tev.SetKonstColors();
 }
 
-static void Draw(s32 x, s32 y, s32 xi, s32 yi)
+static void Draw(const Triangle& triangle, DrawContext& context, s32 x, s32 y, s32 xi, s32 yi)
 {
-  INCSTAT(g_stats.this_frame.rasterized_pixels);
+  context.rasterizedPixels++;
 
-  s32 z = (s32)std::clamp<float>(ZSlope.GetValue(x, y), 0.0f, 16777215.0f);
+  s32 z = (s32)std::clamp<float>(triangle.ZSlope.GetValue(x, y), 0.0f, 16777215.0f);
 
   if (bpmem.GetEmulatedZ() == EmulatedZ::Early)
   {
@@ -164,7 +259,9 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
     EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
   }
 
-  RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
+  Tev& tev = context.tev;
+  const RasterBlock& rasterBlock = context.rasterBlock;
+  const RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
   tev.Position[0] = x;
   tev.Position[1] = y;
@@ -175,7 +272,7 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
   {
     for (int comp = 0; comp < 4; comp++)
     {
-      u16 color = (u16)ColorSlopes[i][comp].GetValue(x, y);
+      u16 color = (u16)triangle.ColorSlopes[i][comp].GetValue(x, y);
 
       // clamp color value to 0
       u16 mask = ~(color >> 8);
@@ -207,7 +304,8 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
   tev.Draw();
 }
 
-static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoord)
+static inline void CalculateLOD(const RasterBlock& rasterBlock, s32* lodp, bool* linear,
+                                u32 texmap, u32 texcoord)
 {
   auto texUnit = bpmem.tex.GetUnit(texmap);
 
@@ -218,9 +316,9 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
 
   float sDelta, tDelta;
 
-  float* uv00 = rasterBlock.Pixel[0][0].Uv[texcoord];
-  float* uv10 = rasterBlock.Pixel[1][0].Uv[texcoord];
-  float* uv01 = rasterBlock.Pixel[0][1].Uv[texcoord];
+  const float* uv00 = rasterBlock.Pixel[0][0].Uv[texcoord];
+  const float* uv10 = rasterBlock.Pixel[1][0].Uv[texcoord];
+  const float* uv01 = rasterBlock.Pixel[0][1].Uv[texcoord];
 
   float dudx = fabsf(uv00[0] - uv10[0]);
   float dvdx = fabsf(uv00[1] - uv10[1]);
@@ -258,7 +356,7 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
   *lodp = lod;
 }
 
-static void BuildBlock(s32 blockX, s32 blockY)
+static void BuildBlock(const Triangle& triangle, RasterBlock& rasterBlock, s32 blockX, s32 blockY)
 {
   for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
   {
@@ -269,19 +367,19 @@ static void BuildBlock(s32 blockX, s32 blockY)
       s32 x = xi + blockX;
       s32 y = yi + blockY;
 
-      float invW = 1.0f / WSlope.GetValue(x, y);
+      float invW = 1.0f / triangle.WSlope.GetValue(x, y);
       pixel.InvW = invW;
 
       // tex coords
       for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
       {
         float projection = invW;
-        float q = TexSlopes[i][2].GetValue(x, y) * invW;
+        float q = triangle.TexSlopes[i][2].GetValue(x, y) * invW;
         if (q != 0.0f)
           projection = invW / q;
 
-        pixel.Uv[i][0] = TexSlopes[i][0].GetValue(x, y) * projection;
-        pixel.Uv[i][1] = TexSlopes[i][1].GetValue(x, y) * projection;
+        pixel.Uv[i][0] = triangle.TexSlopes[i][0].GetValue(x, y) * projection;
+        pixel.Uv[i][1] = triangle.TexSlopes[i][1].GetValue(x, y) * projection;
       }
     }
   }
@@ -291,7 +389,8 @@ static void BuildBlock(s32 blockX, s32 blockY)
     u32 texmap = bpmem.tevindref.getTexMap(i);
     u32 texcoord = bpmem.tevindref.getTexCoord(i);
 
-    CalculateLOD(&rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
+    CalculateLOD(rasterBlock, &rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap,
+                 texcoord);
   }
 
   for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -303,7 +402,8 @@ static void BuildBlock(s32 blockX, s32 blockY)
       u32 texmap = order.getTexMap(stageOdd);
       u32 texcoord = order.getTexCoord(stageOdd);
 
-      CalculateLOD(&rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
+      CalculateLOD(rasterBlock, &rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap,
+                   texcoord);
     }
   }
 }
@@ -320,34 +420,22 @@ void UpdateZSlope(const OutputVertexData* v0, const OutputVertexData* v1,
   }
 }
 
-static void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v1,
-                                  const OutputVertexData* v2,
-                                  const BPFunctions::ScissorRect& scissor)
+// Draws the part of the triangle in the rectangle. order places a queued triangle before the ones
+// queued after it, and is 0 for triangles drawn right away.
+static void DrawTriangle(const Triangle& triangle, const MathUtil::Rectangle<int>& rect,
+                         DrawContext& context, u64 order)
 {
-  // The zslope should be updated now, even if the triangle is rejected by the scissor test, as
-  // zfreeze depends on it
-  UpdateZSlope(v0, v1, v2, scissor.x_off, scissor.y_off);
+  const s32 DX12 = triangle.DX12;
+  const s32 DX23 = triangle.DX23;
+  const s32 DX31 = triangle.DX31;
 
-  // adapted from http://devmaster.net/posts/6145/advanced-rasterization
+  const s32 DY12 = triangle.DY12;
+  const s32 DY23 = triangle.DY23;
+  const s32 DY31 = triangle.DY31;
 
-  // 28.4 fixed-pou32 coordinates. rounded to nearest and adjusted to match hardware output
-  // could also take floor and adjust -8
-  const s32 Y1 = iround(16.0f * (v0->screenPosition.y - scissor.y_off)) - 9;
-  const s32 Y2 = iround(16.0f * (v1->screenPosition.y - scissor.y_off)) - 9;
-  const s32 Y3 = iround(16.0f * (v2->screenPosition.y - scissor.y_off)) - 9;
-
-  const s32 X1 = iround(16.0f * (v0->screenPosition.x - scissor.x_off)) - 9;
-  const s32 X2 = iround(16.0f * (v1->screenPosition.x - scissor.x_off)) - 9;
-  const s32 X3 = iround(16.0f * (v2->screenPosition.x - scissor.x_off)) - 9;
-
-  // Deltas
-  const s32 DX12 = X1 - X2;
-  const s32 DX23 = X2 - X3;
-  const s32 DX31 = X3 - X1;
-
-  const s32 DY12 = Y1 - Y2;
-  const s32 DY23 = Y2 - Y3;
-  const s32 DY31 = Y3 - Y1;
+  const s32 C1 = triangle.C1;
+  const s32 C2 = triangle.C2;
+  const s32 C3 = triangle.C3;
 
   // Fixed-pos32 deltas
   const s32 FDX12 = DX12 * 16;
@@ -358,61 +446,10 @@ static void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertex
   const s32 FDY23 = DY23 * 16;
   const s32 FDY31 = DY31 * 16;
 
-  // Bounding rectangle
-  s32 minx = (std::min(std::min(X1, X2), X3) + 0xF) >> 4;
-  s32 maxx = (std::max(std::max(X1, X2), X3) + 0xF) >> 4;
-  s32 miny = (std::min(std::min(Y1, Y2), Y3) + 0xF) >> 4;
-  s32 maxy = (std::max(std::max(Y1, Y2), Y3) + 0xF) >> 4;
-
-  // scissor
-  ASSERT(scissor.rect.left >= 0);
-  ASSERT(scissor.rect.right <= static_cast<int>(EFB_WIDTH));
-  ASSERT(scissor.rect.top >= 0);
-  ASSERT(scissor.rect.bottom <= static_cast<int>(EFB_HEIGHT));
-
-  minx = std::max(minx, scissor.rect.left);
-  maxx = std::min(maxx, scissor.rect.right);
-  miny = std::max(miny, scissor.rect.top);
-  maxy = std::min(maxy, scissor.rect.bottom);
-
-  if (minx >= maxx || miny >= maxy)
-    return;
-
-  // Set up the remaining slopes
-  const SlopeContext ctx(v0, v1, v2, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4, scissor.x_off,
-                         scissor.y_off);
-
-  float w[3] = {1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w,
-                1.0f / v2->projectedPosition.w};
-  WSlope = Slope(w[0], w[1], w[2], ctx);
-
-  for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
-  {
-    for (int comp = 0; comp < 4; comp++)
-      ColorSlopes[i][comp] = Slope(v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], ctx);
-  }
-
-  for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
-  {
-    for (int comp = 0; comp < 3; comp++)
-    {
-      TexSlopes[i][comp] = Slope(v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1],
-                                 v2->texCoords[i][comp] * w[2], ctx);
-    }
-  }
-
-  // Half-edge constants
-  s32 C1 = DY12 * X1 - DX12 * Y1;
-  s32 C2 = DY23 * X2 - DX23 * Y2;
-  s32 C3 = DY31 * X3 - DX31 * Y3;
-
-  // Correct for fill convention
-  if (DY12 < 0 || (DY12 == 0 && DX12 > 0))
-    C1++;
-  if (DY23 < 0 || (DY23 == 0 && DX23 > 0))
-    C2++;
-  if (DY31 < 0 || (DY31 == 0 && DX31 > 0))
-    C3++;
+  const s32 minx = std::max(triangle.minx, rect.left);
+  const s32 maxx = std::min(triangle.maxx, rect.right);
+  const s32 miny = std::max(triangle.miny, rect.top);
+  const s32 maxy = std::min(triangle.maxy, rect.bottom);
 
   // Start in corner of 2x2 block
   s32 block_minx = minx & ~(BLOCK_SIZE - 1);
@@ -455,7 +492,8 @@ static void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertex
       if (a == 0x0 || b == 0x0 || c == 0x0)
         continue;
 
-      BuildBlock(x, y);
+      BuildBlock(triangle, context.rasterBlock, x, y);
+      const u32 pixels_in = context.tev.PixelsIn;
 
       // Accept whole block when totally covered
       // We still need to check min/max x/y because of the scissor
@@ -465,7 +503,7 @@ static void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertex
         {
           for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
           {
-            Draw(x + ix, y + iy, ix, iy);
+            Draw(triangle, context, x + ix, y + iy, ix, iy);
           }
         }
       }
@@ -488,7 +526,7 @@ static void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertex
               // This check enforces the scissor rectangle, since it might not be aligned with the
               // blocks
               if (x + ix >= minx && x + ix < maxx && y + iy >= miny && y + iy < maxy)
-                Draw(x + ix, y + iy, ix, iy);
+                Draw(triangle, context, x + ix, y + iy, ix, iy);
             }
 
             CX1 -= FDY12;
@@ -501,6 +539,186 @@ static void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertex
           CY3 += FDX31;
         }
       }
+
+      // Blocks are drawn row by row, and a block is never split between tiles
+      const u64 block = order | static_cast<u64>(y) << 16 | static_cast<u64>(x);
+      if (order != 0 && context.tev.PixelsIn != pixels_in && block > context.lastBlock)
+      {
+        context.lastBlock = block;
+        context.carried = context.tev.GetCarriedState();
+      }
+    }
+  }
+
+  // A batch of pixels shaded at once must not cover a pixel twice
+  context.tev.Flush();
+}
+
+static void DrawTiles(DrawContext& context)
+{
+  for (size_t i = s_next_tile++; i < s_used_tiles.size(); i = s_next_tile++)
+  {
+    const u32 tile = s_used_tiles[i];
+    const s32 left = static_cast<s32>(tile % TILES_X) * TILE_SIZE;
+    const s32 top = static_cast<s32>(tile / TILES_X) * TILE_SIZE;
+    const MathUtil::Rectangle<int> rect(left, top, left + TILE_SIZE, top + TILE_SIZE);
+
+    for (u32 index : s_tile_triangles[tile])
+      DrawTriangle(s_triangles[index], rect, context, static_cast<u64>(index + 1) << 32);
+  }
+}
+
+static void WorkerThread(size_t index)
+{
+  Common::SetCurrentThreadName(fmt::format("SW Rasterizer {}", index).c_str());
+
+  u64 generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock lk(s_threads_lock);
+      s_work_available.wait(
+          lk, [&generation] { return s_exit_threads || s_work_generation != generation; });
+      if (s_exit_threads)
+        return;
+      generation = s_work_generation;
+    }
+
+    DrawTiles(*s_contexts[index]);
+    EfbInterface::FlushPerfCounters();
+    BBoxManager::Flush();
+
+    {
+      std::lock_guard lk(s_threads_lock);
+      if (--s_busy_threads == 0)
+        s_work_done.notify_one();
+    }
+  }
+}
+
+static void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v1,
+                                  const OutputVertexData* v2,
+                                  const BPFunctions::ScissorRect& scissor)
+{
+  // The zslope should be updated now, even if the triangle is rejected by the scissor test, as
+  // zfreeze depends on it
+  UpdateZSlope(v0, v1, v2, scissor.x_off, scissor.y_off);
+
+  // adapted from http://devmaster.net/posts/6145/advanced-rasterization
+
+  // 28.4 fixed-pou32 coordinates. rounded to nearest and adjusted to match hardware output
+  // could also take floor and adjust -8
+  const s32 Y1 = iround(16.0f * (v0->screenPosition.y - scissor.y_off)) - 9;
+  const s32 Y2 = iround(16.0f * (v1->screenPosition.y - scissor.y_off)) - 9;
+  const s32 Y3 = iround(16.0f * (v2->screenPosition.y - scissor.y_off)) - 9;
+
+  const s32 X1 = iround(16.0f * (v0->screenPosition.x - scissor.x_off)) - 9;
+  const s32 X2 = iround(16.0f * (v1->screenPosition.x - scissor.x_off)) - 9;
+  const s32 X3 = iround(16.0f * (v2->screenPosition.x - scissor.x_off)) - 9;
+
+  // Bounding rectangle
+  s32 minx = (std::min(std::min(X1, X2), X3) + 0xF) >> 4;
+  s32 maxx = (std::max(std::max(X1, X2), X3) + 0xF) >> 4;
+  s32 miny = (std::min(std::min(Y1, Y2), Y3) + 0xF) >> 4;
+  s32 maxy = (std::max(std::max(Y1, Y2), Y3) + 0xF) >> 4;
+
+  // scissor
+  ASSERT(scissor.rect.left >= 0);
+  ASSERT(scissor.rect.right <= static_cast<int>(EFB_WIDTH));
+  ASSERT(scissor.rect.top >= 0);
+  ASSERT(scissor.rect.bottom <= static_cast<int>(EFB_HEIGHT));
+
+  minx = std::max(minx, scissor.rect.left);
+  maxx = std::min(maxx, scissor.rect.right);
+  miny = std::max(miny, scissor.rect.top);
+  maxy = std::min(maxy, scissor.rect.bottom);
+
+  if (minx >= maxx || miny >= maxy)
+    return;
+
+  Triangle triangle;
+  triangle.ZSlope = ZSlope;
+  triangle.minx = minx;
+  triangle.maxx = maxx;
+  triangle.miny = miny;
+  triangle.maxy = maxy;
+
+  // Set up the remaining slopes
+  const SlopeContext ctx(v0, v1, v2, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4, scissor.x_off,
+                         scissor.y_off);
+
+  float w[3] = {1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w,
+                1.0f / v2->projectedPosition.w};
+  triangle.WSlope = Slope(w[0], w[1], w[2], ctx);
+
+  for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
+  {
+    for (int comp = 0; comp < 4; comp++)
+    {
+      triangle.ColorSlopes[i][comp] =
+          Slope(v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], ctx);
+    }
+  }
+
+  for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
+  {
+    for (int comp = 0; comp < 3; comp++)
+    {
+      triangle.TexSlopes[i][comp] =
+          Slope(v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1],
+                v2->texCoords[i][comp] * w[2], ctx);
+    }
+  }
+
+  // Deltas
+  const s32 DX12 = X1 - X2;
+  const s32 DX23 = X2 - X3;
+  const s32 DX31 = X3 - X1;
+
+  const s32 DY12 = Y1 - Y2;
+  const s32 DY23 = Y2 - Y3;
+  const s32 DY31 = Y3 - Y1;
+
+  // Half-edge constants
+  s32 C1 = DY12 * X1 - DX12 * Y1;
+  s32 C2 = DY23 * X2 - DX23 * Y2;
+  s32 C3 = DY31 * X3 - DX31 * Y3;
+
+  // Correct for fill convention
+  if (DY12 < 0 || (DY12 == 0 && DX12 > 0))
+    C1++;
+  if (DY23 < 0 || (DY23 == 0 && DX23 > 0))
+    C2++;
+  if (DY31 < 0 || (DY31 == 0 && DX31 > 0))
+    C3++;
+
+  triangle.DX12 = DX12;
+  triangle.DX23 = DX23;
+  triangle.DX31 = DX31;
+  triangle.DY12 = DY12;
+  triangle.DY23 = DY23;
+  triangle.DY31 = DY31;
+  triangle.C1 = C1;
+  triangle.C2 = C2;
+  triangle.C3 = C3;
+
+  if (s_draw_in_order)
+  {
+    DrawTriangle(triangle, scissor.rect, *s_contexts[0], 0);
+    return;
+  }
+
+  const u32 index = static_cast<u32>(s_triangles.size());
+  s_triangles.push_back(triangle);
+
+  for (s32 tile_y = miny / TILE_SIZE; tile_y <= (maxy - 1) / TILE_SIZE; tile_y++)
+  {
+    for (s32 tile_x = minx / TILE_SIZE; tile_x <= (maxx - 1) / TILE_SIZE; tile_x++)
+    {
+      const u32 tile = static_cast<u32>(tile_y * TILES_X + tile_x);
+      if (s_tile_triangles[tile].empty())
+        s_used_tiles.push_back(tile);
+      s_tile_triangles[tile].push_back(index);
     }
   }
 }
@@ -510,7 +728,66 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
 {
   INCSTAT(g_stats.this_frame.num_triangles_drawn);
 
+  // Draws are flushed once they are done, so the registers are the same for every queued triangle.
+  // The pixels of draws that read what the pixel before left behind can't be drawn by tiles.
+  if (s_triangles.empty())
+    s_draw_in_order = s_threads.empty() || Tev::DependsOnPixelOrder();
+
   for (const auto& scissor : scissors)
     DrawTriangleFrontFace(v0, v1, v2, scissor);
+
+  if (s_triangles.size() >= MAX_QUEUED_TRIANGLES)
+    Flush();
+}
+
+void Flush()
+{
+  if (!s_triangles.empty())
+  {
+    s_next_tile = 0;
+    {
+      std::lock_guard lk(s_threads_lock);
+      s_work_generation++;
+      s_busy_threads = s_threads.size();
+    }
+    s_work_available.notify_all();
+
+    DrawTiles(*s_contexts[0]);
+
+    {
+      std::unique_lock lk(s_threads_lock);
+      s_work_done.wait(lk, [] { return s_busy_threads == 0; });
+    }
+
+    // The GPU thread carries on from the last pixel drawn, like a single thread would
+    const DrawContext* last = s_contexts[0].get();
+    for (const auto& context : s_contexts)
+    {
+      if (context->lastBlock > last->lastBlock)
+        last = context.get();
+    }
+    if (last->lastBlock != 0)
+      s_contexts[0]->tev.SetCarriedState(last->carried);
+    for (auto& context : s_contexts)
+      context->lastBlock = 0;
+
+    s_triangles.clear();
+    for (u32 tile : s_used_tiles)
+      s_tile_triangles[tile].clear();
+    s_used_tiles.clear();
+  }
+
+  EfbInterface::FlushPerfCounters();
+  BBoxManager::Flush();
+
+  for (auto& context : s_contexts)
+  {
+    ADDSTAT(g_stats.this_frame.rasterized_pixels, context->rasterizedPixels);
+    ADDSTAT(g_stats.this_frame.tev_pixels_in, context->tev.PixelsIn);
+    ADDSTAT(g_stats.this_frame.tev_pixels_out, context->tev.PixelsOut);
+    context->rasterizedPixels = 0;
+    context->tev.PixelsIn = 0;
+    context->tev.PixelsOut = 0;
+  }
 }
 }  // namespace Rasterizer
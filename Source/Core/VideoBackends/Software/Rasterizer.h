@@ -10,12 +10,17 @@ struct OutputVertexData;
 namespace Rasterizer
 {
 void Init();
+void Shutdown();
 void ScissorChanged();
 
 void UpdateZSlope(const OutputVertexData* v0, const OutputVertexData* v1,
                   const OutputVertexData* v2, s32 x_off, s32 y_off);
+// May only queue the triangle to be drawn by the rasterizer threads, which the state it depends on
+// must not change before
 void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v1,
                            const OutputVertexData* v2);
+// Draws the queued triangles and adds up what the threads counted
+void Flush();
 
 void SetTevKonstColors();
 
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <array>
+#include <mutex>
 
 #include "Common/CommonTypes.h"
 
@@ -14,6 +15,10 @@ namespace
 {
 // Current bounding box coordinates.
 std::array<u16, 4> s_coordinates{};
+
+// The box drawn by the calling rasterizer thread since it last flushed it
+thread_local std::array<u16, 4> s_pending{0xffff, 0, 0xffff, 0};
+std::mutex s_pending_lock;
 }  // Anonymous namespace
 
 u16 GetCoordinate(Coordinate coordinate)
@@ -28,15 +33,29 @@ void SetCoordinate(Coordinate coordinate, u16 value)
 
 void Update(u16 left, u16 right, u16 top, u16 bottom)
 {
-  const u16 new_left = std::min(left, GetCoordinate(Coordinate::Left));
-  const u16 new_right = std::max(right, GetCoordinate(Coordinate::Right));
-  const u16 new_top = std::min(top, GetCoordinate(Coordinate::Top));
-  const u16 new_bottom = std::max(bottom, GetCoordinate(Coordinate::Bottom));
+  s_pending[0] = std::min(left, s_pending[0]);
+  s_pending[1] = std::max(right, s_pending[1]);
+  s_pending[2] = std::min(top, s_pending[2]);
+  s_pending[3] = std::max(bottom, s_pending[3]);
+}
+
+void Flush()
+{
+  if (s_pending[0] > s_pending[1])
+    return;
+
+  std::lock_guard lk(s_pending_lock);
+  const u16 new_left = std::min(s_pending[0], GetCoordinate(Coordinate::Left));
+  const u16 new_right = std::max(s_pending[1], GetCoordinate(Coordinate::Right));
+  const u16 new_top = std::min(s_pending[2], GetCoordinate(Coordinate::Top));
+  const u16 new_bottom = std::max(s_pending[3], GetCoordinate(Coordinate::Bottom));
 
   SetCoordinate(Coordinate::Left, new_left);
   SetCoordinate(Coordinate::Right, new_right);
   SetCoordinate(Coordinate::Top, new_top);
   SetCoordinate(Coordinate::Bottom, new_bottom);
+
+  s_pending = {0xffff, 0, 0xffff, 0};
 }
 
 }  // namespace BBoxManager
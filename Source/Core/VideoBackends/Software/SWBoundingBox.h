@@ -24,8 +24,9 @@ u16 GetCoordinate(Coordinate coordinate);
 // Sets a particular coordinate for the bounding box.
 void SetCoordinate(Coordinate coordinate, u16 value);
 
-// Updates all bounding box coordinates.
+// Updates all bounding box coordinates once the calling thread flushes its updates.
 void Update(u16 left, u16 right, u16 top, u16 bottom);
+void Flush();
 }  // namespace BBoxManager
 
 namespace SW
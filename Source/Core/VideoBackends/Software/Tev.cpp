@@ -18,7 +18,6 @@
 
 #include "VideoCommon/PerfQueryBase.h"
 #include "VideoCommon/PixelShaderManager.h"
-#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/XFMemory.h"
@@ -392,17 +391,19 @@ void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
   }
 }
 
-void Tev::Draw()
+Tev::Tev() : Tev(TevSIMD::GetBestPath())
 {
-  ASSERT(Position[0] >= 0 && Position[0] < s32(EFB_WIDTH));
-  ASSERT(Position[1] >= 0 && Position[1] < s32(EFB_HEIGHT));
+}
 
-  INCSTAT(g_stats.this_frame.tev_pixels_in);
+Tev::Tev(TevSIMD::Path path) : m_path(path), m_lane_count(TevSIMD::GetLaneCount(path))
+{
+}
 
+void Tev::SetInitialRegisters()
+{
   auto& system = Core::System::GetInstance();
   auto& pixel_shader_manager = system.GetPixelShaderManager();
 
-  // initial color values
   for (int i = 0; i < 4; i++)
   {
     Reg[static_cast<TevOutput>(i)].r = pixel_shader_manager.constants.colors[i][0];
@@ -410,7 +411,10 @@ void Tev::Draw()
     Reg[static_cast<TevOutput>(i)].b = pixel_shader_manager.constants.colors[i][2];
     Reg[static_cast<TevOutput>(i)].a = pixel_shader_manager.constants.colors[i][3];
   }
+}
 
+void Tev::SampleIndirectStages()
+{
   for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
   {
     const int stageNum2 = stageNum >> 1;
@@ -434,109 +438,273 @@ void Tev::Draw()
                            IndirectLod[stageNum], IndirectLinear[stageNum], texmap,
                            IndirectTex[stageNum]);
   }
+}
 
-  for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
-  {
-    const int stageNum2 = stageNum >> 1;
-    const int stageOdd = stageNum & 1;
-    const TwoTevStageOrders& order = bpmem.tevorders[stageNum2];
-
-    // stage combiners
-    const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
-    const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+void Tev::SampleStage(unsigned int stageNum)
+{
+  const int stageOdd = stageNum & 1;
+  const TwoTevStageOrders& order = bpmem.tevorders[stageNum >> 1];
+  const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
 
-    u32 texcoordSel = order.getTexCoord(stageOdd);
-    const u32 texmap = order.getTexMap(stageOdd);
+  u32 texcoordSel = order.getTexCoord(stageOdd);
+  const u32 texmap = order.getTexMap(stageOdd);
 
-    // Quirk: when the tex coord is not less than the number of tex gens (i.e. the tex coord does
-    // not exist), then tex coord 0 is used (though sometimes glitchy effects happen on console).
-    if (texcoordSel >= bpmem.genMode.numtexgens)
-      texcoordSel = 0;
-
-    Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
+  // Quirk: when the tex coord is not less than the number of tex gens (i.e. the tex coord does
+  // not exist), then tex coord 0 is used (though sometimes glitchy effects happen on console).
+  if (texcoordSel >= bpmem.genMode.numtexgens)
+    texcoordSel = 0;
 
-    // sample texture
-    if (order.getEnable(stageOdd))
-    {
-      // RGBA
-      u8 texel[4];
+  Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
 
-      if (bpmem.genMode.numtexgens > 0)
-      {
-        TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum],
-                               TextureLinear[stageNum], texmap, texel);
-      }
-      else
-      {
-        // It seems like the result is always black when no tex coords are enabled, but further
-        // hardware testing is needed.
-        std::memset(texel, 0, 4);
-      }
-
-      const auto& swap = bpmem.tevksel.GetSwapTable(ac.tswap);
-      TexColor.r = texel[u32(swap[ColorChannel::Red])];
-      TexColor.g = texel[u32(swap[ColorChannel::Green])];
-      TexColor.b = texel[u32(swap[ColorChannel::Blue])];
-      TexColor.a = texel[u32(swap[ColorChannel::Alpha])];
-    }
-
-    // set konst for this stage
-    const auto kc = bpmem.tevksel.GetKonstColor(stageNum);
-    const auto ka = bpmem.tevksel.GetKonstAlpha(stageNum);
-    StageKonst.r = m_KonstLUT[kc].r;
-    StageKonst.g = m_KonstLUT[kc].g;
-    StageKonst.b = m_KonstLUT[kc].b;
-    StageKonst.a = m_KonstLUT[ka].a;
-
-    // set color
-    SetRasColor(order.getColorChan(stageOdd), ac.rswap);
-
-    // combine inputs
-    InputRegType inputs[4];
-    inputs[BLU_C].a = m_ColorInputLUT[cc.a].b;
-    inputs[BLU_C].b = m_ColorInputLUT[cc.b].b;
-    inputs[BLU_C].c = m_ColorInputLUT[cc.c].b;
-    inputs[BLU_C].d = m_ColorInputLUT[cc.d].b;
-    inputs[GRN_C].a = m_ColorInputLUT[cc.a].g;
-    inputs[GRN_C].b = m_ColorInputLUT[cc.b].g;
-    inputs[GRN_C].c = m_ColorInputLUT[cc.c].g;
-    inputs[GRN_C].d = m_ColorInputLUT[cc.d].g;
-    inputs[RED_C].a = m_ColorInputLUT[cc.a].r;
-    inputs[RED_C].b = m_ColorInputLUT[cc.b].r;
-    inputs[RED_C].c = m_ColorInputLUT[cc.c].r;
-    inputs[RED_C].d = m_ColorInputLUT[cc.d].r;
-    inputs[ALP_C].a = m_AlphaInputLUT[ac.a].a;
-    inputs[ALP_C].b = m_AlphaInputLUT[ac.b].a;
-    inputs[ALP_C].c = m_AlphaInputLUT[ac.c].a;
-    inputs[ALP_C].d = m_AlphaInputLUT[ac.d].a;
-
-    if (cc.bias != TevBias::Compare)
-      DrawColorRegular(cc, inputs);
-    else
-      DrawColorCompare(cc, inputs);
+  // sample texture
+  if (order.getEnable(stageOdd))
+  {
+    // RGBA
+    u8 texel[4];
 
-    if (cc.clamp)
+    if (bpmem.genMode.numtexgens > 0)
     {
-      Reg[cc.dest].r = Clamp255(Reg[cc.dest].r);
-      Reg[cc.dest].g = Clamp255(Reg[cc.dest].g);
-      Reg[cc.dest].b = Clamp255(Reg[cc.dest].b);
+      TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum],
+                             TextureLinear[stageNum], texmap, texel);
     }
     else
     {
-      Reg[cc.dest].r = Clamp1024(Reg[cc.dest].r);
-      Reg[cc.dest].g = Clamp1024(Reg[cc.dest].g);
-      Reg[cc.dest].b = Clamp1024(Reg[cc.dest].b);
+      // It seems like the result is always black when no tex coords are enabled, but further
+      // hardware testing is needed.
+      std::memset(texel, 0, 4);
     }
 
-    if (ac.bias != TevBias::Compare)
-      DrawAlphaRegular(ac, inputs);
-    else
-      DrawAlphaCompare(ac, inputs);
+    const auto& swap = bpmem.tevksel.GetSwapTable(ac.tswap);
+    TexColor.r = texel[u32(swap[ColorChannel::Red])];
+    TexColor.g = texel[u32(swap[ColorChannel::Green])];
+    TexColor.b = texel[u32(swap[ColorChannel::Blue])];
+    TexColor.a = texel[u32(swap[ColorChannel::Alpha])];
+  }
+}
 
-    if (ac.clamp)
-      Reg[ac.dest].a = Clamp255(Reg[ac.dest].a);
-    else
-      Reg[ac.dest].a = Clamp1024(Reg[ac.dest].a);
+void Tev::SetStageKonst(unsigned int stageNum)
+{
+  const auto kc = bpmem.tevksel.GetKonstColor(stageNum);
+  const auto ka = bpmem.tevksel.GetKonstAlpha(stageNum);
+  StageKonst.r = m_KonstLUT[kc].r;
+  StageKonst.g = m_KonstLUT[kc].g;
+  StageKonst.b = m_KonstLUT[kc].b;
+  StageKonst.a = m_KonstLUT[ka].a;
+}
+
+void Tev::CombineStage(unsigned int stageNum)
+{
+  const TwoTevStageOrders& order = bpmem.tevorders[stageNum >> 1];
+  const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+  const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+
+  // set konst for this stage
+  SetStageKonst(stageNum);
+
+  // set color
+  SetRasColor(order.getColorChan(stageNum & 1), ac.rswap);
+
+  // combine inputs
+  InputRegType inputs[4];
+  inputs[BLU_C].a = m_ColorInputLUT[cc.a].b;
+  inputs[BLU_C].b = m_ColorInputLUT[cc.b].b;
+  inputs[BLU_C].c = m_ColorInputLUT[cc.c].b;
+  inputs[BLU_C].d = m_ColorInputLUT[cc.d].b;
+  inputs[GRN_C].a = m_ColorInputLUT[cc.a].g;
+  inputs[GRN_C].b = m_ColorInputLUT[cc.b].g;
+  inputs[GRN_C].c = m_ColorInputLUT[cc.c].g;
+  inputs[GRN_C].d = m_ColorInputLUT[cc.d].g;
+  inputs[RED_C].a = m_ColorInputLUT[cc.a].r;
+  inputs[RED_C].b = m_ColorInputLUT[cc.b].r;
+  inputs[RED_C].c = m_ColorInputLUT[cc.c].r;
+  inputs[RED_C].d = m_ColorInputLUT[cc.d].r;
+  inputs[ALP_C].a = m_AlphaInputLUT[ac.a].a;
+  inputs[ALP_C].b = m_AlphaInputLUT[ac.b].a;
+  inputs[ALP_C].c = m_AlphaInputLUT[ac.c].a;
+  inputs[ALP_C].d = m_AlphaInputLUT[ac.d].a;
+
+  if (cc.bias != TevBias::Compare)
+    DrawColorRegular(cc, inputs);
+  else
+    DrawColorCompare(cc, inputs);
+
+  if (cc.clamp)
+  {
+    Reg[cc.dest].r = Clamp255(Reg[cc.dest].r);
+    Reg[cc.dest].g = Clamp255(Reg[cc.dest].g);
+    Reg[cc.dest].b = Clamp255(Reg[cc.dest].b);
+  }
+  else
+  {
+    Reg[cc.dest].r = Clamp1024(Reg[cc.dest].r);
+    Reg[cc.dest].g = Clamp1024(Reg[cc.dest].g);
+    Reg[cc.dest].b = Clamp1024(Reg[cc.dest].b);
+  }
+
+  if (ac.bias != TevBias::Compare)
+    DrawAlphaRegular(ac, inputs);
+  else
+    DrawAlphaCompare(ac, inputs);
+
+  if (ac.clamp)
+    Reg[ac.dest].a = Clamp255(Reg[ac.dest].a);
+  else
+    Reg[ac.dest].a = Clamp1024(Reg[ac.dest].a);
+}
+
+void Tev::ApplyZTexture(TevColor texColor, s32* position)
+{
+  u32 ztex = bpmem.ztex1.bias;
+  switch (bpmem.ztex2.type)
+  {
+  case ZTexFormat::U8:
+    ztex += texColor[ALP_C];
+    break;
+  case ZTexFormat::U16:
+    ztex += texColor[ALP_C] << 8 | texColor[RED_C];
+    break;
+  case ZTexFormat::U24:
+    ztex += texColor[RED_C] << 16 | texColor[GRN_C] << 8 | texColor[BLU_C];
+    break;
+  default:
+    PanicAlertFmt("Invalid ztex format {}", bpmem.ztex2.type);
+  }
+
+  if (bpmem.ztex2.op == ZTexOp::Add)
+    ztex += position[2];
+
+  position[2] = ztex & 0x00ffffff;
+}
+
+u32 Tev::GetFogFactor(const s32* position)
+{
+  float ze;
+
+  if (bpmem.fog.c_proj_fsel.proj == FogProjection::Perspective)
+  {
+    // perspective
+    // ze = A/(B - (Zs >> B_SHF))
+    const s32 denom = bpmem.fog.b_magnitude - (position[2] >> bpmem.fog.b_shift);
+    // in addition downscale magnitude and zs to 0.24 bits
+    ze = (bpmem.fog.GetA() * 16777215.0f) / static_cast<float>(denom);
+  }
+  else
+  {
+    // orthographic
+    // ze = a*Zs
+    // in addition downscale zs to 0.24 bits
+    ze = bpmem.fog.GetA() * (static_cast<float>(position[2]) / 16777215.0f);
+  }
+
+  if (bpmem.fogRange.Base.Enabled)
+  {
+    // TODO: This is untested and should definitely be checked against real hw.
+    // - No idea if offset is really normalized against the viewport width or against the
+    // projection matrix or yet something else
+    // - scaling of the "k" coefficient isn't clear either.
+
+    // First, calculate the offset from the viewport center (normalized to 0..1)
+    const float offset =
+        (position[0] - (static_cast<s32>(bpmem.fogRange.Base.Center.Value()) - 342)) /
+        static_cast<float>(xfmem.viewport.wd);
+
+    // Based on that, choose the index such that points which are far away from the z-axis use the
+    // 10th "k" value and such that central points use the first value.
+    float floatindex = 9.f - std::abs(offset) * 9.f;
+    floatindex = std::clamp(floatindex, 0.f, 9.f);  // TODO: This shouldn't be necessary!
+
+    // Get the two closest integer indices, look up the corresponding samples
+    const int indexlower = (int)floatindex;
+    const int indexupper = indexlower + 1;
+    // Look up coefficient... Seems like multiplying by 4 makes Fortune Street work properly (fog
+    // is too strong without the factor)
+    const float klower = bpmem.fogRange.K[indexlower / 2].GetValue(indexlower % 2) * 4.f;
+    const float kupper = bpmem.fogRange.K[indexupper / 2].GetValue(indexupper % 2) * 4.f;
+
+    // linearly interpolate the samples and multiple ze by the resulting adjustment factor
+    const float factor = indexupper - floatindex;
+    const float k = klower * factor + kupper * (1.f - factor);
+    const float x_adjust = sqrt(offset * offset + k * k) / k;
+    ze *= x_adjust;  // NOTE: This is basically dividing by a cosine (hidden behind
+                     // GXInitFogAdjTable): 1/cos = c/b = sqrt(a^2+b^2)/b
+  }
+
+  ze -= bpmem.fog.GetC();
+
+  // clamp 0 to 1
+  float fog = std::clamp(ze, 0.f, 1.f);
+
+  switch (bpmem.fog.c_proj_fsel.fsel)
+  {
+  case FogType::Exp:
+    fog = 1.0f - pow(2.0f, -8.0f * fog);
+    break;
+  case FogType::ExpSq:
+    fog = 1.0f - pow(2.0f, -8.0f * fog * fog);
+    break;
+  case FogType::BackwardsExp:
+    fog = 1.0f - fog;
+    fog = pow(2.0f, -8.0f * fog);
+    break;
+  case FogType::BackwardsExpSq:
+    fog = 1.0f - fog;
+    fog = pow(2.0f, -8.0f * fog * fog);
+    break;
+  default:
+    break;
+  }
+
+  return (u32)(fog * 256);
+}
+
+void Tev::WritePixel(const s32* position, u8* output)
+{
+  if (bpmem.GetEmulatedZ() == EmulatedZ::Late)
+  {
+    // TODO: Check against hw if these values get incremented even if depth testing is disabled
+    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+
+    if (!EfbInterface::ZCompare(position[0], position[1], position[2]))
+      return;
+
+    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+  }
+
+  // The GC/Wii GPU rasterizes in 2x2 pixel groups, so bounding box values will be rounded to the
+  // extents of these groups, rather than the exact pixel.
+  BBoxManager::Update(static_cast<u16>(position[0] & ~1), static_cast<u16>(position[0] | 1),
+                      static_cast<u16>(position[1] & ~1), static_cast<u16>(position[1] | 1));
+
+  PixelsOut++;
+  EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+
+  EfbInterface::BlendTev(position[0], position[1], output);
+}
+
+void Tev::Draw()
+{
+  ASSERT(Position[0] >= 0 && Position[0] < s32(EFB_WIDTH));
+  ASSERT(Position[1] >= 0 && Position[1] < s32(EFB_HEIGHT));
+
+  PixelsIn++;
+
+  if (m_lane_count != 0)
+    QueuePixel();
+  else
+    DrawPixel();
+}
+
+void Tev::DrawPixel()
+{
+  // initial color values
+  SetInitialRegisters();
+
+  SampleIndirectStages();
+
+  for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+  {
+    SampleStage(stageNum);
+    CombineStage(stageNum);
   }
 
   // convert to 8 bits per component
@@ -552,137 +720,176 @@ void Tev::Draw()
 
   // z texture
   if (bpmem.ztex2.op != ZTexOp::Disabled)
+    ApplyZTexture(TexColor, Position);
+
+  // fog
+  if (bpmem.fog.c_proj_fsel.fsel != FogType::Off)
   {
-    u32 ztex = bpmem.ztex1.bias;
-    switch (bpmem.ztex2.type)
-    {
-    case ZTexFormat::U8:
-      ztex += TexColor[ALP_C];
-      break;
-    case ZTexFormat::U16:
-      ztex += TexColor[ALP_C] << 8 | TexColor[RED_C];
-      break;
-    case ZTexFormat::U24:
-      ztex += TexColor[RED_C] << 16 | TexColor[GRN_C] << 8 | TexColor[BLU_C];
-      break;
-    default:
-      PanicAlertFmt("Invalid ztex format {}", bpmem.ztex2.type);
-    }
+    // lerp from output to fog color
+    const u32 fogInt = GetFogFactor(Position);
+    const u32 invFog = 256 - fogInt;
 
-    if (bpmem.ztex2.op == ZTexOp::Add)
-      ztex += Position[2];
+    output[RED_C] = (output[RED_C] * invFog + fogInt * bpmem.fog.color.r) >> 8;
+    output[GRN_C] = (output[GRN_C] * invFog + fogInt * bpmem.fog.color.g) >> 8;
+    output[BLU_C] = (output[BLU_C] * invFog + fogInt * bpmem.fog.color.b) >> 8;
+  }
 
-    Position[2] = ztex & 0x00ffffff;
+  WritePixel(Position, output);
+}
+
+void Tev::QueuePixel()
+{
+  // Sampling stays in pixel order as the indirect stages and stages without a texture carry
+  // their results over to the next pixel
+  const u32 lane = m_queued++;
+
+  SampleIndirectStages();
+
+  for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+  {
+    SampleStage(stageNum);
+    for (int i = 0; i < 4; i++)
+      m_lanes.tex[stageNum][i][lane] = TexColor[i];
+    m_lanes.bump[stageNum][lane] = AlphaBump;
   }
 
-  // fog
-  if (bpmem.fog.c_proj_fsel.fsel != FogType::Off)
+  for (int i = 0; i < 2; i++)
   {
-    float ze;
+    for (int j = 0; j < 4; j++)
+      m_lanes.color[i][j][lane] = Color[i][j];
+  }
+  std::copy_n(Position, 3, m_positions[lane]);
 
-    if (bpmem.fog.c_proj_fsel.proj == FogProjection::Perspective)
-    {
-      // perspective
-      // ze = A/(B - (Zs >> B_SHF))
-      const s32 denom = bpmem.fog.b_magnitude - (Position[2] >> bpmem.fog.b_shift);
-      // in addition downscale magnitude and zs to 0.24 bits
-      ze = (bpmem.fog.GetA() * 16777215.0f) / static_cast<float>(denom);
-    }
-    else
-    {
-      // orthographic
-      // ze = a*Zs
-      // in addition downscale zs to 0.24 bits
-      ze = bpmem.fog.GetA() * (static_cast<float>(Position[2]) / 16777215.0f);
-    }
+  if (m_queued == m_lane_count)
+    Flush();
+}
 
-    if (bpmem.fogRange.Base.Enabled)
-    {
-      // TODO: This is untested and should definitely be checked against real hw.
-      // - No idea if offset is really normalized against the viewport width or against the
-      // projection matrix or yet something else
-      // - scaling of the "k" coefficient isn't clear either.
-
-      // First, calculate the offset from the viewport center (normalized to 0..1)
-      const float offset =
-          (Position[0] - (static_cast<s32>(bpmem.fogRange.Base.Center.Value()) - 342)) /
-          static_cast<float>(xfmem.viewport.wd);
-
-      // Based on that, choose the index such that points which are far away from the z-axis use the
-      // 10th "k" value and such that central points use the first value.
-      float floatindex = 9.f - std::abs(offset) * 9.f;
-      floatindex = std::clamp(floatindex, 0.f, 9.f);  // TODO: This shouldn't be necessary!
-
-      // Get the two closest integer indices, look up the corresponding samples
-      const int indexlower = (int)floatindex;
-      const int indexupper = indexlower + 1;
-      // Look up coefficient... Seems like multiplying by 4 makes Fortune Street work properly (fog
-      // is too strong without the factor)
-      const float klower = bpmem.fogRange.K[indexlower / 2].GetValue(indexlower % 2) * 4.f;
-      const float kupper = bpmem.fogRange.K[indexupper / 2].GetValue(indexupper % 2) * 4.f;
-
-      // linearly interpolate the samples and multiple ze by the resulting adjustment factor
-      const float factor = indexupper - floatindex;
-      const float k = klower * factor + kupper * (1.f - factor);
-      const float x_adjust = sqrt(offset * offset + k * k) / k;
-      ze *= x_adjust;  // NOTE: This is basically dividing by a cosine (hidden behind
-                       // GXInitFogAdjTable): 1/cos = c/b = sqrt(a^2+b^2)/b
-    }
+void Tev::Flush()
+{
+  if (m_queued == 0)
+    return;
 
-    ze -= bpmem.fog.GetC();
+  SetInitialRegisters();
+  for (int i = 0; i < 4; i++)
+  {
+    for (int j = 0; j < 4; j++)
+      m_lanes.initial[i][j] = Reg[static_cast<TevOutput>(i)][j];
+  }
+  for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+  {
+    SetStageKonst(stageNum);
+    for (int i = 0; i < 4; i++)
+      m_lanes.konst[stageNum][i] = StageKonst[i];
+  }
 
-    // clamp 0 to 1
-    float fog = std::clamp(ze, 0.f, 1.f);
+  u8 output[TevSIMD::MAX_LANES][4];
+  const u32 passed = TevSIMD::Combine(m_path, m_lanes, output) & ((1u << m_queued) - 1);
 
-    switch (bpmem.fog.c_proj_fsel.fsel)
+  const bool ztex = bpmem.ztex2.op != ZTexOp::Disabled;
+  const bool fog = bpmem.fog.c_proj_fsel.fsel != FogType::Off;
+  if (ztex || fog)
+  {
+    u16 fogFactors[TevSIMD::MAX_LANES]{};
+    const unsigned int lastStage = bpmem.genMode.numtevstages;
+    for (u32 lane = 0; lane < m_queued; lane++)
     {
-    case FogType::Exp:
-      fog = 1.0f - pow(2.0f, -8.0f * fog);
-      break;
-    case FogType::ExpSq:
-      fog = 1.0f - pow(2.0f, -8.0f * fog * fog);
-      break;
-    case FogType::BackwardsExp:
-      fog = 1.0f - fog;
-      fog = pow(2.0f, -8.0f * fog);
-      break;
-    case FogType::BackwardsExpSq:
-      fog = 1.0f - fog;
-      fog = pow(2.0f, -8.0f * fog * fog);
-      break;
-    default:
-      break;
+      if (!(passed & (1u << lane)))
+        continue;
+
+      if (ztex)
+      {
+        const TevColor texColor(
+            m_lanes.tex[lastStage][ALP_C][lane], m_lanes.tex[lastStage][BLU_C][lane],
+            m_lanes.tex[lastStage][GRN_C][lane], m_lanes.tex[lastStage][RED_C][lane]);
+        ApplyZTexture(texColor, m_positions[lane]);
+      }
+      if (fog)
+        fogFactors[lane] = GetFogFactor(m_positions[lane]);
     }
 
-    // lerp from output to fog color
-    const u32 fogInt = (u32)(fog * 256);
-    const u32 invFog = 256 - fogInt;
+    if (fog)
+      TevSIMD::Fog(m_path, fogFactors, output);
+  }
 
-    output[RED_C] = (output[RED_C] * invFog + fogInt * bpmem.fog.color.r) >> 8;
-    output[GRN_C] = (output[GRN_C] * invFog + fogInt * bpmem.fog.color.g) >> 8;
-    output[BLU_C] = (output[BLU_C] * invFog + fogInt * bpmem.fog.color.b) >> 8;
+  for (u32 lane = 0; lane < m_queued; lane++)
+  {
+    if (passed & (1u << lane))
+      WritePixel(m_positions[lane], output[lane]);
   }
 
-  if (bpmem.GetEmulatedZ() == EmulatedZ::Late)
+  m_queued = 0;
+}
+
+bool Tev::DependsOnPixelOrder()
+{
+  // The first stage adds to the coordinate of the last stage of the pixel before
+  if (bpmem.tevind[0].fb_addprev)
+    return true;
+
+  // Whether a stage reads the color or the alpha of an input
+  const auto reads = [](unsigned int stageNum, TevColorArg color, TevColorArg color_alpha,
+                        TevAlphaArg alpha) {
+    const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+    const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+    for (const TevColorArg arg : {cc.a.Value(), cc.b.Value(), cc.c.Value(), cc.d.Value()})
+    {
+      if (arg == color || arg == color_alpha)
+        return true;
+    }
+    return ac.a == alpha || ac.b == alpha || ac.c == alpha || ac.d == alpha;
+  };
+
+  bool sampled = false;
+  for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
   {
-    // TODO: Check against hw if these values get incremented even if depth testing is disabled
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+    // The indirect stages that don't exist aren't sampled
+    const TevStageIndirect& indirect = bpmem.tevind[stageNum];
+    if (indirect.bt >= bpmem.genMode.numindstages &&
+        (indirect.matrix_index != IndMtxIndex::Off || indirect.bs != IndTexBumpAlpha::Off))
+    {
+      return true;
+    }
 
-    if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
-      return;
+    // Nor are the colors of the channels that aren't rasterized
+    const TwoTevStageOrders& order = bpmem.tevorders[stageNum >> 1];
+    const RasColorChan chan = order.getColorChan(stageNum & 1);
+    const u32 num_colors = bpmem.genMode.numcolchans;
+    if (((chan == RasColorChan::Color0 && num_colors < 1) ||
+         (chan == RasColorChan::Color1 && num_colors < 2)) &&
+        reads(stageNum, TevColorArg::RasColor, TevColorArg::RasAlpha, TevAlphaArg::RasAlpha))
+    {
+      return true;
+    }
 
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+    // Or the texture color of the stages before the first texture
+    sampled |= order.getEnable(stageNum & 1);
+    if (!sampled &&
+        reads(stageNum, TevColorArg::TexColor, TevColorArg::TexAlpha, TevAlphaArg::TexAlpha))
+    {
+      return true;
+    }
   }
 
-  // The GC/Wii GPU rasterizes in 2x2 pixel groups, so bounding box values will be rounded to the
-  // extents of these groups, rather than the exact pixel.
-  BBoxManager::Update(static_cast<u16>(Position[0] & ~1), static_cast<u16>(Position[0] | 1),
-                      static_cast<u16>(Position[1] & ~1), static_cast<u16>(Position[1] | 1));
+  // The z texture is the texture color of the last stage
+  return !sampled && bpmem.ztex2.op != ZTexOp::Disabled;
+}
 
-  INCSTAT(g_stats.this_frame.tev_pixels_out);
-  EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+Tev::CarriedState Tev::GetCarriedState() const
+{
+  CarriedState state;
+  std::memcpy(state.color, Color, sizeof(Color));
+  state.tex_color = TexColor;
+  std::memcpy(state.indirect_tex, IndirectTex, sizeof(IndirectTex));
+  state.tex_coord = TexCoord;
+  return state;
+}
 
-  EfbInterface::BlendTev(Position[0], Position[1], output);
+void Tev::SetCarriedState(const CarriedState& state)
+{
+  std::memcpy(Color, state.color, sizeof(Color));
+  TexColor = state.tex_color;
+  std::memcpy(IndirectTex, state.indirect_tex, sizeof(IndirectTex));
+  TexCoord = state.tex_coord;
 }
 
 void Tev::SetKonstColors()
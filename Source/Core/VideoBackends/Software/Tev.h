@@ -6,6 +6,7 @@
 #include <array>
 
 #include "Common/EnumMap.h"
+#include "VideoBackends/Software/TevSIMD.h"
 #include "VideoCommon/BPMemory.h"
 
 class Tev
@@ -212,7 +213,29 @@ class Tev
 
   void Indirect(unsigned int stageNum, s32 s, s32 t);
 
+  void SetInitialRegisters();
+  void SampleIndirectStages();
+  void SampleStage(unsigned int stageNum);
+  void SetStageKonst(unsigned int stageNum);
+  void CombineStage(unsigned int stageNum);
+  static void ApplyZTexture(TevColor texColor, s32* position);
+  static u32 GetFogFactor(const s32* position);
+  void WritePixel(const s32* position, u8* output);
+
+  void DrawPixel();
+  void QueuePixel();
+
+  // Pixels that are sampled but not shaded yet, for the SIMD path
+  TevSIMD::Path m_path;
+  u32 m_lane_count;
+  u32 m_queued = 0;
+  TevSIMD::Lanes m_lanes{};
+  s32 m_positions[TevSIMD::MAX_LANES][3]{};
+
 public:
+  Tev();
+  explicit Tev(TevSIMD::Path path);
+
   s32 Position[3]{};
   u8 Color[2][4]{};  // must be RGBA for correct swap table ordering
   TextureCoordinateType Uv[8]{};
@@ -221,6 +244,10 @@ public:
   s32 TextureLod[16]{};
   bool TextureLinear[16]{};
 
+  // Counted here as every rasterizer thread has its own Tev
+  u32 PixelsIn = 0;
+  u32 PixelsOut = 0;
+
   enum
   {
     ALP_C,
@@ -229,6 +256,25 @@ public:
     RED_C
   };
 
+  // What a pixel leaves behind for the next one: the colors of the channels that aren't rasterized,
+  // the texture color of the stages before the first texture, the indirect stages that don't exist
+  // and the coordinate the first stage adds to
+  struct CarriedState
+  {
+    u8 color[2][4]{};
+    TevColor tex_color;
+    u8 indirect_tex[4][4]{};
+    TextureCoordinateType tex_coord{};
+  };
+
+  // Whether the pixels read what the pixel shaded before them left behind, which makes the result
+  // depend on the order they are drawn in
+  static bool DependsOnPixelOrder();
+  CarriedState GetCarriedState() const;
+  void SetCarriedState(const CarriedState& state);
+
   void SetKonstColors();
   void Draw();
+  // Shades the pixels that Draw queued, before anything reads the EFB or changes the registers
+  void Flush();
 };
@@ -0,0 +1,92 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "VideoBackends/Software/TevSIMD.h"
+
+#include "Common/CPUDetect.h"
+#include "Common/Inline.h"
+#include "Common/MsgHandler.h"
+
+#include "VideoCommon/BPMemory.h"
+
+#if defined(_M_X86) || defined(_M_X86_64)
+#define USE_SSE
+#endif
+
+#if defined(USE_SSE)
+#include <immintrin.h>
+
+#define USE_SSE41
+#include "VideoBackends/Software/TevSIMDImpl.h"
+#define USE_AVX2
+#include "VideoBackends/Software/TevSIMDImpl.h"
+
+#if defined(__AVX2__)
+static constexpr int MIN_SSE = 52;
+#elif defined(__SSE4_1__)
+static constexpr int MIN_SSE = 41;
+#else
+static constexpr int MIN_SSE = 0;
+#endif
+#endif
+
+namespace TevSIMD
+{
+Path GetBestPath()
+{
+#if defined(USE_SSE)
+  if (MIN_SSE >= 52 || cpu_info.bAVX2)
+    return Path::AVX2;
+  if (MIN_SSE >= 41 || cpu_info.bSSE4_1)
+    return Path::SSE41;
+#endif
+  return Path::Scalar;
+}
+
+u32 GetLaneCount(Path path)
+{
+  switch (path)
+  {
+  case Path::SSE41:
+    return 4;
+  case Path::AVX2:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+u32 Combine(Path path, const Lanes& lanes, u8 (*output)[4])
+{
+  switch (path)
+  {
+#if defined(USE_SSE)
+  case Path::SSE41:
+    return TevSIMD_SSE41::Combine(lanes, output);
+  case Path::AVX2:
+    return TevSIMD_AVX2::Combine(lanes, output);
+#endif
+  default:
+    PanicAlertFmt("Invalid TEV path {}", static_cast<int>(path));
+    return 0;
+  }
+}
+
+void Fog(Path path, const u16* factors, u8 (*output)[4])
+{
+  switch (path)
+  {
+#if defined(USE_SSE)
+  case Path::SSE41:
+    TevSIMD_SSE41::Fog(factors, output);
+    break;
+  case Path::AVX2:
+    TevSIMD_AVX2::Fog(factors, output);
+    break;
+#endif
+  default:
+    PanicAlertFmt("Invalid TEV path {}", static_cast<int>(path));
+    break;
+  }
+}
+}  // namespace TevSIMD
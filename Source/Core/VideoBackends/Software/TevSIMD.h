@@ -0,0 +1,47 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Runs the combiners, the alpha test and the fog blend of the TEV on several pixels at once, one
+// pixel per vector lane. Texture sampling and the indirect stages carry state from one pixel to the
+// next, so Tev still does them for each pixel and only hands over their results.
+namespace TevSIMD
+{
+enum class Path
+{
+  Scalar,
+  SSE41,
+  AVX2,
+};
+
+constexpr u32 MAX_LANES = 8;
+constexpr u32 MAX_STAGES = 16;
+
+// One element per pixel, colors in the component order of Tev (ABGR) unless noted otherwise
+struct Lanes
+{
+  // The colors of the rasterizer in RGBA order, as the swap tables expect them
+  alignas(16) s16 color[2][4][MAX_LANES];
+  // The texture color after the swap table and the bump alpha of every stage
+  alignas(16) s16 tex[MAX_STAGES][4][MAX_LANES];
+  alignas(16) s16 bump[MAX_STAGES][MAX_LANES];
+
+  // The same for every pixel
+  s16 initial[4][4];
+  s16 konst[MAX_STAGES][4];
+};
+
+// The fastest path the CPU supports
+Path GetBestPath();
+// How many pixels the path shades at once, 0 for the scalar path
+u32 GetLaneCount(Path path);
+
+// Writes the color of every lane in ABGR order and returns a mask of the lanes that pass the alpha
+// test, all lanes of the path are shaded
+u32 Combine(Path path, const Lanes& lanes, u8 (*output)[4]);
+// Blends the colors towards the fog color, with a factor from 0 to 256 for each lane
+void Fog(Path path, const u16* factors, u8 (*output)[4]);
+}  // namespace TevSIMD
@@ -0,0 +1,491 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#if defined(USE_AVX2)
+#define VECTOR_NAMESPACE TevSIMD_AVX2
+#elif defined(USE_SSE41)
+#define VECTOR_NAMESPACE TevSIMD_SSE41
+#else
+#error This file is meant to be used by TevSIMD.cpp only!
+#endif
+
+#if defined(__GNUC__) && defined(USE_AVX2) && !defined(__AVX2__)
+#define ATTR_TARGET __attribute__((target("avx2")))
+#elif defined(__GNUC__) && defined(USE_SSE41) && !defined(__SSE4_1__)
+#define ATTR_TARGET __attribute__((target("sse4.1")))
+#else
+#define ATTR_TARGET
+#endif
+
+namespace VECTOR_NAMESPACE
+{
+// Every lane holds a color component of one pixel as an s32, which is wide enough for all the
+// intermediate results of the combiners
+#if defined(USE_AVX2)
+typedef __m256i Vector;
+constexpr u32 LANES = 8;
+
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Load(const s16* values)
+{
+  return _mm256_cvtepi16_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(values)));
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Set(s32 value)
+{
+  return _mm256_set1_epi32(value);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Add(Vector a, Vector b)
+{
+  return _mm256_add_epi32(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Sub(Vector a, Vector b)
+{
+  return _mm256_sub_epi32(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Mul(Vector a, Vector b)
+{
+  return _mm256_mullo_epi32(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector And(Vector a, Vector b)
+{
+  return _mm256_and_si256(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Or(Vector a, Vector b)
+{
+  return _mm256_or_si256(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Xor(Vector a, Vector b)
+{
+  return _mm256_xor_si256(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector CmpGt(Vector a, Vector b)
+{
+  return _mm256_cmpgt_epi32(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector CmpEq(Vector a, Vector b)
+{
+  return _mm256_cmpeq_epi32(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Clamp(Vector value, s32 min, s32 max)
+{
+  return _mm256_min_epi32(_mm256_max_epi32(value, Set(min)), Set(max));
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector ShiftLeft(Vector value, int shift)
+{
+  return _mm256_sll_epi32(value, _mm_cvtsi32_si128(shift));
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector ShiftRight(Vector value, int shift)
+{
+  return _mm256_sra_epi32(value, _mm_cvtsi32_si128(shift));
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static u32 MoveMask(Vector mask)
+{
+  return _mm256_movemask_ps(_mm256_castsi256_ps(mask));
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static void Store(u8 (*output)[4], Vector value)
+{
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), value);
+}
+#else
+typedef __m128i Vector;
+constexpr u32 LANES = 4;
+
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Load(const s16* values)
+{
+  return _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(values)));
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Set(s32 value)
+{
+  return _mm_set1_epi32(value);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Add(Vector a, Vector b)
+{
+  return _mm_add_epi32(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Sub(Vector a, Vector b)
+{
+  return _mm_sub_epi32(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Mul(Vector a, Vector b)
+{
+  return _mm_mullo_epi32(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector And(Vector a, Vector b)
+{
+  return _mm_and_si128(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Or(Vector a, Vector b)
+{
+  return _mm_or_si128(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Xor(Vector a, Vector b)
+{
+  return _mm_xor_si128(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector CmpGt(Vector a, Vector b)
+{
+  return _mm_cmpgt_epi32(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector CmpEq(Vector a, Vector b)
+{
+  return _mm_cmpeq_epi32(a, b);
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Clamp(Vector value, s32 min, s32 max)
+{
+  return _mm_min_epi32(_mm_max_epi32(value, Set(min)), Set(max));
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector ShiftLeft(Vector value, int shift)
+{
+  return _mm_sll_epi32(value, _mm_cvtsi32_si128(shift));
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector ShiftRight(Vector value, int shift)
+{
+  return _mm_sra_epi32(value, _mm_cvtsi32_si128(shift));
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static u32 MoveMask(Vector mask)
+{
+  return _mm_movemask_ps(_mm_castsi128_ps(mask));
+}
+ATTR_TARGET DOLPHIN_FORCE_INLINE static void Store(u8 (*output)[4], Vector value)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(output), value);
+}
+#endif
+
+enum
+{
+  ALP_C,
+  BLU_C,
+  GRN_C,
+  RED_C
+};
+
+// The registers of the combiners, like the bit fields of InputRegType in Tev
+struct Inputs
+{
+  Vector a, b, c, d;
+};
+
+struct StageState
+{
+  Vector reg[4][4];
+  Vector tex[4];
+  Vector ras[4];
+  Vector konst[4];
+};
+
+static constexpr Common::EnumMap<s16, TevBias::Compare> s_BiasLUT{0, 128, -128, 0};
+static constexpr Common::EnumMap<u8, TevScale::Divide2> s_ScaleLShiftLUT{0, 1, 2, 0};
+static constexpr Common::EnumMap<u8, TevScale::Divide2> s_ScaleRShiftLUT{0, 0, 0, 1};
+
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector ColorInput(const StageState& state, TevColorArg arg,
+                                                          int component)
+{
+  switch (arg)
+  {
+  case TevColorArg::PrevColor:
+  case TevColorArg::Color0:
+  case TevColorArg::Color1:
+  case TevColorArg::Color2:
+    return state.reg[u32(arg) / 2][component];
+  case TevColorArg::PrevAlpha:
+  case TevColorArg::Alpha0:
+  case TevColorArg::Alpha1:
+  case TevColorArg::Alpha2:
+    return state.reg[u32(arg) / 2][ALP_C];
+  case TevColorArg::TexColor:
+    return state.tex[component];
+  case TevColorArg::TexAlpha:
+    return state.tex[ALP_C];
+  case TevColorArg::RasColor:
+    return state.ras[component];
+  case TevColorArg::RasAlpha:
+    return state.ras[ALP_C];
+  case TevColorArg::One:
+    return Set(255);
+  case TevColorArg::Half:
+    return Set(128);
+  case TevColorArg::Konst:
+    return state.konst[component];
+  default:
+    return Set(0);
+  }
+}
+
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector AlphaInput(const StageState& state, TevAlphaArg arg)
+{
+  switch (arg)
+  {
+  case TevAlphaArg::PrevAlpha:
+  case TevAlphaArg::Alpha0:
+  case TevAlphaArg::Alpha1:
+  case TevAlphaArg::Alpha2:
+    return state.reg[u32(arg)][ALP_C];
+  case TevAlphaArg::TexAlpha:
+    return state.tex[ALP_C];
+  case TevAlphaArg::RasAlpha:
+    return state.ras[ALP_C];
+  case TevAlphaArg::Konst:
+    return state.konst[ALP_C];
+  default:
+    return Set(0);
+  }
+}
+
+// Truncates the inputs the way storing them in the bit fields of InputRegType does
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Inputs MakeInputs(Vector a, Vector b, Vector c, Vector d)
+{
+  const Vector mask = Set(0xff);
+  return {And(a, mask), And(b, mask), And(c, mask), ShiftRight(ShiftLeft(d, 21), 21)};
+}
+
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Regular(const Inputs& in, TevBias bias, TevOp op,
+                                                       TevScale scale, bool is_alpha)
+{
+  const Vector c = Add(in.c, ShiftRight(in.c, 7));
+
+  Vector temp = Add(Mul(in.a, Sub(Set(256), c)), Mul(in.b, c));
+  temp = ShiftLeft(temp, s_ScaleLShiftLUT[scale]);
+  temp = Add(temp, Set((scale == TevScale::Divide2) ? 0 : (op == TevOp::Sub) ? 127 : 128));
+  if (op == TevOp::Sub)
+  {
+    // The color combiner rounds before negating, the alpha combiner after
+    temp = is_alpha ? ShiftRight(Sub(Set(0), temp), 8) : Sub(Set(0), ShiftRight(temp, 8));
+  }
+  else
+  {
+    temp = ShiftRight(temp, 8);
+  }
+
+  const Vector result =
+      Add(ShiftLeft(Add(in.d, Set(s_BiasLUT[bias])), s_ScaleLShiftLUT[scale]), temp);
+  return ShiftRight(result, s_ScaleRShiftLUT[scale]);
+}
+
+// The value compared for the modes that do not compare each component on its own
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector CompareValue(TevCompareMode mode, Vector b, Vector g,
+                                                            Vector r)
+{
+  switch (mode)
+  {
+  case TevCompareMode::GR16:
+    return Or(ShiftLeft(g, 8), r);
+  case TevCompareMode::BGR24:
+    return Or(ShiftLeft(b, 16), Or(ShiftLeft(g, 8), r));
+  default:
+    return r;
+  }
+}
+
+ATTR_TARGET DOLPHIN_FORCE_INLINE static Vector Compare(const Inputs& in, Vector a, Vector b,
+                                                       TevComparison comparison)
+{
+  const Vector mask = comparison == TevComparison::GT ? CmpGt(a, b) : CmpEq(a, b);
+  return Add(in.d, And(mask, in.c));
+}
+
+ATTR_TARGET static Vector AlphaCompare(Vector alpha, u32 ref, CompareMode comp)
+{
+  const Vector all = CmpEq(alpha, alpha);
+  switch (comp)
+  {
+  case CompareMode::Never:
+    return Set(0);
+  case CompareMode::LEqual:
+    return Xor(CmpGt(alpha, Set(ref)), all);
+  case CompareMode::Less:
+    return CmpGt(Set(ref), alpha);
+  case CompareMode::GEqual:
+    return Xor(CmpGt(Set(ref), alpha), all);
+  case CompareMode::Greater:
+    return CmpGt(alpha, Set(ref));
+  case CompareMode::Equal:
+    return CmpEq(alpha, Set(ref));
+  case CompareMode::NEqual:
+    return Xor(CmpEq(alpha, Set(ref)), all);
+  default:
+    return all;
+  }
+}
+
+ATTR_TARGET static u32 AlphaTest(Vector alpha)
+{
+  const Vector comp0 = AlphaCompare(alpha, bpmem.alpha_test.ref0, bpmem.alpha_test.comp0);
+  const Vector comp1 = AlphaCompare(alpha, bpmem.alpha_test.ref1, bpmem.alpha_test.comp1);
+
+  const u32 all = (1u << LANES) - 1;
+  switch (bpmem.alpha_test.logic)
+  {
+  case AlphaTestOp::And:
+    return MoveMask(And(comp0, comp1));
+  case AlphaTestOp::Or:
+    return MoveMask(Or(comp0, comp1));
+  case AlphaTestOp::Xor:
+    return MoveMask(Xor(comp0, comp1));
+  case AlphaTestOp::Xnor:
+    return MoveMask(Xor(comp0, comp1)) ^ all;
+  default:
+    return all;
+  }
+}
+
+ATTR_TARGET static u32 Combine(const TevSIMD::Lanes& lanes, u8 (*output)[4])
+{
+  StageState state;
+  for (int i = 0; i < 4; i++)
+  {
+    for (int j = 0; j < 4; j++)
+      state.reg[i][j] = Set(lanes.initial[i][j]);
+  }
+
+  for (u32 stage = 0; stage <= bpmem.genMode.numtevstages; stage++)
+  {
+    const TwoTevStageOrders& order = bpmem.tevorders[stage >> 1];
+    const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stage].colorC;
+    const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stage].alphaC;
+
+    for (int i = 0; i < 4; i++)
+    {
+      state.tex[i] = Load(lanes.tex[stage][i]);
+      state.konst[i] = Set(lanes.konst[stage][i]);
+    }
+
+    const RasColorChan ras_chan = order.getColorChan(stage & 1);
+    switch (ras_chan)
+    {
+    case RasColorChan::Color0:
+    case RasColorChan::Color1:
+    {
+      const auto& color = lanes.color[ras_chan == RasColorChan::Color0 ? 0 : 1];
+      const auto& swap = bpmem.tevksel.GetSwapTable(ac.rswap);
+      state.ras[RED_C] = Load(color[u32(swap[ColorChannel::Red])]);
+      state.ras[GRN_C] = Load(color[u32(swap[ColorChannel::Green])]);
+      state.ras[BLU_C] = Load(color[u32(swap[ColorChannel::Blue])]);
+      state.ras[ALP_C] = Load(color[u32(swap[ColorChannel::Alpha])]);
+      break;
+    }
+    case RasColorChan::AlphaBump:
+    case RasColorChan::NormalizedAlphaBump:
+    {
+      Vector bump = Load(lanes.bump[stage]);
+      if (ras_chan == RasColorChan::NormalizedAlphaBump)
+        bump = Or(bump, ShiftRight(bump, 5));
+      for (Vector& component : state.ras)
+        component = bump;
+      break;
+    }
+    default:
+      if (ras_chan != RasColorChan::Zero)
+        PanicAlertFmt("Invalid ras color channel: {}", ras_chan);
+      for (Vector& component : state.ras)
+        component = Set(0);
+      break;
+    }
+
+    // All inputs are read before either combiner writes its destination
+    Inputs inputs[4];
+    for (int i = BLU_C; i <= RED_C; i++)
+    {
+      inputs[i] = MakeInputs(ColorInput(state, cc.a, i), ColorInput(state, cc.b, i),
+                             ColorInput(state, cc.c, i), ColorInput(state, cc.d, i));
+    }
+    inputs[ALP_C] = MakeInputs(AlphaInput(state, ac.a), AlphaInput(state, ac.b),
+                               AlphaInput(state, ac.c), AlphaInput(state, ac.d));
+
+    Vector* color_dest = state.reg[u32(cc.dest.Value())];
+    if (cc.bias != TevBias::Compare)
+    {
+      for (int i = BLU_C; i <= RED_C; i++)
+        color_dest[i] = Regular(inputs[i], cc.bias, cc.op, cc.scale, false);
+    }
+    else
+    {
+      const TevCompareMode mode = cc.compare_mode;
+      const Vector a =
+          CompareValue(mode, inputs[BLU_C].a, inputs[GRN_C].a, inputs[RED_C].a);
+      const Vector b =
+          CompareValue(mode, inputs[BLU_C].b, inputs[GRN_C].b, inputs[RED_C].b);
+      for (int i = BLU_C; i <= RED_C; i++)
+      {
+        if (mode == TevCompareMode::RGB8)
+          color_dest[i] = Compare(inputs[i], inputs[i].a, inputs[i].b, cc.comparison);
+        else
+          color_dest[i] = Compare(inputs[i], a, b, cc.comparison);
+      }
+    }
+
+    for (int i = BLU_C; i <= RED_C; i++)
+      color_dest[i] = cc.clamp ? Clamp(color_dest[i], 0, 255) : Clamp(color_dest[i], -1024, 1023);
+
+    Vector& alpha_dest = state.reg[u32(ac.dest.Value())][ALP_C];
+    if (ac.bias != TevBias::Compare)
+    {
+      alpha_dest = Regular(inputs[ALP_C], ac.bias, ac.op, ac.scale, true);
+    }
+    else if (ac.compare_mode == TevCompareMode::A8)
+    {
+      alpha_dest = Compare(inputs[ALP_C], inputs[ALP_C].a, inputs[ALP_C].b, ac.comparison);
+    }
+    else
+    {
+      const TevCompareMode mode = ac.compare_mode;
+      const Vector a =
+          CompareValue(mode, inputs[BLU_C].a, inputs[GRN_C].a, inputs[RED_C].a);
+      const Vector b =
+          CompareValue(mode, inputs[BLU_C].b, inputs[GRN_C].b, inputs[RED_C].b);
+      alpha_dest = Compare(inputs[ALP_C], a, b, ac.comparison);
+    }
+
+    alpha_dest = ac.clamp ? Clamp(alpha_dest, 0, 255) : Clamp(alpha_dest, -1024, 1023);
+  }
+
+  // Like the scalar path, the last stage decides which registers are put onto the screen
+  const u32 last_stage = bpmem.genMode.numtevstages;
+  const Vector* color = state.reg[u32(bpmem.combiners[last_stage].colorC.dest.Value())];
+  const Vector mask = Set(0xff);
+  const Vector alpha = And(state.reg[u32(bpmem.combiners[last_stage].alphaC.dest.Value())][ALP_C],
+                           mask);
+
+  // Each lane becomes the four bytes of one pixel
+  Store(output, Or(Or(alpha, ShiftLeft(And(color[BLU_C], mask), 8)),
+                   Or(ShiftLeft(And(color[GRN_C], mask), 16), ShiftLeft(color[RED_C], 24))));
+
+  return AlphaTest(alpha);
+}
+
+ATTR_TARGET static void Fog(const u16* factors, u8 (*output)[4])
+{
+  // Two pixels per 128 bits with a u16 for every component, as the results are at most 255 * 256
+  const __m128i fog_color =
+      _mm_setr_epi16(0, bpmem.fog.color.b, bpmem.fog.color.g, bpmem.fog.color.r, 0,
+                     bpmem.fog.color.b, bpmem.fog.color.g, bpmem.fog.color.r);
+  const __m128i keep_alpha = _mm_setr_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+  const __m128i zero = _mm_setzero_si128();
+
+  for (u32 i = 0; i < LANES; i += 4)
+  {
+    const __m128i colors = _mm_loadu_si128(reinterpret_cast<const __m128i*>(output[i]));
+    const __m128i fog = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(factors + i));
+    const __m128i fog_pairs = _mm_unpacklo_epi16(fog, fog);
+
+    __m128i blended[2];
+    for (int half = 0; half < 2; half++)
+    {
+      const __m128i color =
+          half == 0 ? _mm_unpacklo_epi8(colors, zero) : _mm_unpackhi_epi8(colors, zero);
+      const __m128i factor = half == 0 ? _mm_unpacklo_epi32(fog_pairs, fog_pairs) :
+                                         _mm_unpackhi_epi32(fog_pairs, fog_pairs);
+      const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(256), factor);
+      const __m128i result = _mm_srli_epi16(
+          _mm_add_epi16(_mm_mullo_epi16(color, inverse), _mm_mullo_epi16(fog_color, factor)), 8);
+      blended[half] = _mm_or_si128(_mm_and_si128(keep_alpha, color),
+                                   _mm_andnot_si128(keep_alpha, result));
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output[i]),
+                     _mm_packus_epi16(blended[0], blended[1]));
+  }
+}
+}  // namespace VECTOR_NAMESPACE
+
+#undef ATTR_TARGET
+#undef VECTOR_NAMESPACE
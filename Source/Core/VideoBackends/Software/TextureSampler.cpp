@@ -5,6 +5,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+
+#if defined(_M_X86) || defined(_M_X86_64)
+#include <emmintrin.h>
+#endif
 
 #include "Common/CommonTypes.h"
 #include "Common/MsgHandler.h"
@@ -68,6 +73,69 @@ static inline void AddTexel(const u8* inTexel, u32* outTexel, u32 fract)
   outTexel[3] += inTexel[3] * fract;
 }
 
+#if defined(_M_X86) || defined(_M_X86_64)
+// All four components of two texels times their weights, which must fit in an s16
+static inline __m128i WeightTexels(const u8* texel0, const u8* texel1, u32 fract0, u32 fract1)
+{
+  u32 packed0, packed1;
+  std::memcpy(&packed0, texel0, sizeof(u32));
+  std::memcpy(&packed1, texel1, sizeof(u32));
+  // The components of the two texels are interleaved for pmaddwd to add their products
+  const __m128i texels = _mm_unpacklo_epi8(
+      _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed0), _mm_cvtsi32_si128(packed1)),
+      _mm_setzero_si128());
+  return _mm_madd_epi16(texels, _mm_set1_epi32(fract0 | fract1 << 16));
+}
+
+static inline void StoreTexel(__m128i texel, int shift, u8* sample)
+{
+  texel = _mm_srli_epi32(texel, shift);
+  texel = _mm_packus_epi16(_mm_packs_epi32(texel, texel), texel);
+  const u32 packed = _mm_cvtsi128_si32(texel);
+  std::memcpy(sample, &packed, sizeof(u32));
+}
+#endif
+
+// Blends the texels of a mip level with the texels of the next one
+static inline void BlendMips(const u8* texel0, const u8* texel1, u32 fract, u8* sample)
+{
+#if defined(_M_X86) || defined(_M_X86_64)
+  StoreTexel(WeightTexels(texel0, texel1, 16 - fract, fract), 4, sample);
+#else
+  u32 texel[4];
+  SetTexel(texel0, texel, 16 - fract);
+  AddTexel(texel1, texel, fract);
+
+  sample[0] = (u8)(texel[0] >> 4);
+  sample[1] = (u8)(texel[1] >> 4);
+  sample[2] = (u8)(texel[2] >> 4);
+  sample[3] = (u8)(texel[3] >> 4);
+#endif
+}
+
+// Blends a 2x2 group of texels, ordered top left, top right, bottom left and bottom right
+static inline void BlendBilinear(const u8 (*texels)[4], u32 fractS, u32 fractT, u8* sample)
+{
+#if defined(_M_X86) || defined(_M_X86_64)
+  const __m128i top = WeightTexels(texels[0], texels[1], (128 - fractS) * (128 - fractT),
+                                   fractS * (128 - fractT));
+  const __m128i bottom =
+      WeightTexels(texels[2], texels[3], (128 - fractS) * fractT, fractS * fractT);
+  StoreTexel(_mm_add_epi32(top, bottom), 14, sample);
+#else
+  u32 texel[4];
+  SetTexel(texels[0], texel, (128 - fractS) * (128 - fractT));
+  AddTexel(texels[1], texel, (fractS) * (128 - fractT));
+  AddTexel(texels[2], texel, (128 - fractS) * (fractT));
+  AddTexel(texels[3], texel, (fractS) * (fractT));
+
+  sample[0] = (u8)(texel[0] >> 14);
+  sample[1] = (u8)(texel[1] >> 14);
+  sample[2] = (u8)(texel[2] >> 14);
+  sample[3] = (u8)(texel[3] >> 14);
+#endif
+}
+
 void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8* sample)
 {
   int baseMip = 0;
@@ -92,19 +160,11 @@ void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8* sample)
 
   if (mipLinear)
   {
-    u8 sampledTex[4];
-    u32 texel[4];
-
-    SampleMip(s, t, baseMip, linear, texmap, sampledTex);
-    SetTexel(sampledTex, texel, (16 - lodFract));
+    u8 sampledTex[2][4];
 
-    SampleMip(s, t, baseMip + 1, linear, texmap, sampledTex);
-    AddTexel(sampledTex, texel, lodFract);
-
-    sample[0] = (u8)(texel[0] >> 4);
-    sample[1] = (u8)(texel[1] >> 4);
-    sample[2] = (u8)(texel[2] >> 4);
-    sample[3] = (u8)(texel[3] >> 4);
+    SampleMip(s, t, baseMip, linear, texmap, sampledTex[0]);
+    SampleMip(s, t, baseMip + 1, linear, texmap, sampledTex[1]);
+    BlendMips(sampledTex[0], sampledTex[1], lodFract, sample);
   }
   else
 #endif
@@ -192,8 +252,7 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8* sample)
     int imageTPlus1 = imageT + 1;
     const int fractT = t & 0x7f;
 
-    u8 sampledTex[4];
-    u32 texel[4];
+    u8 sampledTex[4][4];
 
     WrapCoord(&imageS, tm0.wrap_s, image_width_minus_1 + 1);
     WrapCoord(&imageT, tm0.wrap_t, image_height_minus_1 + 1);
@@ -202,45 +261,28 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8* sample)
 
     if (!(texfmt == TextureFormat::RGBA8 && texUnit.texImage1.cache_manually_managed))
     {
-      TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageT, image_width_minus_1, texfmt,
-                             tlut, tlutfmt);
-      SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
-
-      TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageT, image_width_minus_1, texfmt,
-                             tlut, tlutfmt);
-      AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
-
-      TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageTPlus1, image_width_minus_1, texfmt,
+      TexDecoder_DecodeTexel(sampledTex[0], imageSrc, imageS, imageT, image_width_minus_1, texfmt,
                              tlut, tlutfmt);
-      AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
-
-      TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageTPlus1, image_width_minus_1,
+      TexDecoder_DecodeTexel(sampledTex[1], imageSrc, imageSPlus1, imageT, image_width_minus_1,
                              texfmt, tlut, tlutfmt);
-      AddTexel(sampledTex, texel, (fractS) * (fractT));
+      TexDecoder_DecodeTexel(sampledTex[2], imageSrc, imageS, imageTPlus1, image_width_minus_1,
+                             texfmt, tlut, tlutfmt);
+      TexDecoder_DecodeTexel(sampledTex[3], imageSrc, imageSPlus1, imageTPlus1,
+                             image_width_minus_1, texfmt, tlut, tlutfmt);
     }
     else
     {
-      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageT,
-                                          image_width_minus_1);
-      SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
-
-      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageT,
+      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex[0], imageSrc, imageSrcOdd, imageS, imageT,
                                           image_width_minus_1);
-      AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
-
-      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageTPlus1,
-                                          image_width_minus_1);
-      AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
-
-      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1,
+      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex[1], imageSrc, imageSrcOdd, imageSPlus1,
+                                          imageT, image_width_minus_1);
+      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex[2], imageSrc, imageSrcOdd, imageS,
+                                          imageTPlus1, image_width_minus_1);
+      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex[3], imageSrc, imageSrcOdd, imageSPlus1,
                                           imageTPlus1, image_width_minus_1);
-      AddTexel(sampledTex, texel, (fractS) * (fractT));
     }
 
-    sample[0] = (u8)(texel[0] >> 14);
-    sample[1] = (u8)(texel[1] >> 14);
-    sample[2] = (u8)(texel[2] >> 14);
-    sample[3] = (u8)(texel[3] >> 14);
+    BlendBilinear(sampledTex, fractS, fractT, sample);
   }
   else
   {
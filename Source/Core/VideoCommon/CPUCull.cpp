@@ -139,10 +139,18 @@ void CPUCull::Init()
 
 bool CPUCull::AreAllVerticesCulled(VertexLoaderBase* loader, OpcodeDecoder::Primitive primitive,
                                    const u8* src, u32 count)
+{
+  PrepareTransform(loader, primitive, count);
+  TransformVertices(src, 0, count);
+  return AreTransformedVerticesCulled(count);
+}
+
+void CPUCull::PrepareTransform(VertexLoaderBase* loader, OpcodeDecoder::Primitive primitive,
+                               u32 count)
 {
   ASSERT_MSG(VIDEO, primitive < OpcodeDecoder::Primitive::GX_DRAW_LINES,
              "CPUCull should not be called on lines or points");
-  const u32 stride = loader->m_native_vtx_decl.stride;
+  m_stride = loader->m_native_vtx_decl.stride;
   const bool posHas3Elems = loader->m_native_vtx_decl.position.components >= 3;
   const bool perVertexPosMtx = loader->m_native_vtx_decl.posmtx.enable;
   if (m_transform_buffer_size < count) [[unlikely]]
@@ -163,10 +171,18 @@ bool CPUCull::AreAllVerticesCulled(VertexLoaderBase* loader, OpcodeDecoder::Prim
   CullMode cullmode = bpmem.genMode.cullmode;
   if (xfmem.viewport.ht > 0)  // See videosoftware Clipper.cpp:IsBackface
     cullmode = cullmode_invert[cullmode];
-  const TransformFunction transform = m_transform_table[posHas3Elems][perVertexPosMtx];
-  transform(m_transform_buffer.get(), src, stride, count);
-  const CullFunction cull = m_cull_table[primitive][cullmode];
-  return cull(m_transform_buffer.get(), count);
+  m_transform = m_transform_table[posHas3Elems][perVertexPosMtx];
+  m_cull = m_cull_table[primitive][cullmode];
+}
+
+void CPUCull::TransformVertices(const u8* src, u32 first, u32 count) const
+{
+  m_transform(m_transform_buffer.get() + first, src + first * m_stride, m_stride, count);
+}
+
+bool CPUCull::AreTransformedVerticesCulled(u32 count) const
+{
+  return m_cull(m_transform_buffer.get(), count);
 }
 
 template <typename T>
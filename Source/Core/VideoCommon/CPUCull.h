@@ -15,6 +15,14 @@ public:
   bool AreAllVerticesCulled(VertexLoaderBase* loader, OpcodeDecoder::Primitive primitive,
                             const u8* src, u32 count);
 
+  // AreAllVerticesCulled in steps, so that several threads can transform the vertices of a draw.
+  // Transforming only reads the state set up by PrepareTransform.
+  void PrepareTransform(VertexLoaderBase* loader, OpcodeDecoder::Primitive primitive, u32 count);
+  // Transforms the vertices from first to first + count, src being where vertex 0 is. Vertices are
+  // transformed two at a time, so first has to be even.
+  void TransformVertices(const u8* src, u32 first, u32 count) const;
+  bool AreTransformedVerticesCulled(u32 count) const;
+
   struct alignas(16) TransformedVertex
   {
     float x, y, z, w;
@@ -31,6 +39,9 @@ private:
   };
   std::unique_ptr<TransformedVertex[], BufferDeleter<TransformedVertex>> m_transform_buffer{};
   u32 m_transform_buffer_size = 0;
+  u32 m_stride = 0;
+  TransformFunction m_transform = nullptr;
+  CullFunction m_cull = nullptr;
   std::array<std::array<TransformFunction, 2>, 2> m_transform_table{};
   Common::EnumMap<Common::EnumMap<CullFunction, CullMode::All>,
                   OpcodeDecoder::Primitive::GX_DRAW_TRIANGLE_FAN>
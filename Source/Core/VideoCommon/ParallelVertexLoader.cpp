@@ -0,0 +1,198 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "VideoCommon/ParallelVertexLoader.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include <fmt/format.h>
+
+#include "Common/Thread.h"
+#include "VideoCommon/CPUCull.h"
+#include "VideoCommon/VertexLoaderBase.h"
+#include "VideoCommon/VertexLoaderManager.h"
+
+// The first two vertices of each part but the first are loaded after the other parts, as are the
+// last three or four vertices of the draw
+static constexpr u32 MIN_VERTICES_PER_PART = 16;
+
+ParallelVertexLoader::ParallelVertexLoader(u32 num_threads)
+{
+  num_threads = std::max(num_threads, 1u);
+  m_part_starts.resize(num_threads + 1);
+  m_loaded_counts.resize(num_threads);
+  for (u32 i = 1; i < num_threads; i++)
+    m_threads.emplace_back(&ParallelVertexLoader::WorkerThread, this, i);
+}
+
+ParallelVertexLoader::~ParallelVertexLoader()
+{
+  {
+    std::lock_guard lk(m_threads_lock);
+    m_exit_threads = true;
+  }
+  m_work_available.notify_all();
+  for (std::thread& thread : m_threads)
+    thread.join();
+}
+
+u32 ParallelVertexLoader::GetNumParts(const VertexLoaderBase* loader, int count) const
+{
+  if (m_threads.empty() || !loader->IsThreadSafe())
+    return 1;
+
+  const u64 vertex_bytes = loader->m_vertex_size + loader->m_native_vtx_decl.stride;
+  const u64 parts = std::min(static_cast<u64>(count) * vertex_bytes / MIN_BYTES_PER_PART,
+                             static_cast<u64>(count) / MIN_VERTICES_PER_PART);
+  return static_cast<u32>(std::clamp<u64>(parts, 1, m_threads.size() + 1));
+}
+
+bool ParallelVertexLoader::ShouldSplit(const VertexLoaderBase* loader, int count) const
+{
+  return GetNumParts(loader, count) > 1;
+}
+
+int ParallelVertexLoader::RunVertices(VertexLoaderBase* loader, const u8* src, u8* dst, int count,
+                                      CPUCull* cull)
+{
+  const u32 num_parts = GetNumParts(loader, count);
+  if (num_parts == 1)
+  {
+    count = loader->RunVertices(src, dst, count);
+    if (cull)
+      cull->TransformVertices(dst, 0, count);
+    return count;
+  }
+
+  const u32 vertex_size = loader->m_vertex_size;
+  const u32 stride = loader->m_native_vtx_decl.stride;
+
+  // Skipped vertices don't update the caches, which then keep values from before the draw
+  const auto old_position_cache = VertexLoaderManager::position_cache;
+  const auto old_position_matrix_index_cache = VertexLoaderManager::position_matrix_index_cache;
+  const auto old_tangent_cache = VertexLoaderManager::tangent_cache;
+  const auto old_binormal_cache = VertexLoaderManager::binormal_cache;
+
+  // Every part writes to the zfreeze caches, so the last vertices are loaded once the parts are
+  // done. Parts start on even vertices to keep the transformed vertices aligned.
+  const u32 tail_start = (count - 3) & ~1u;
+  for (u32 i = 0; i <= num_parts; i++)
+    m_part_starts[i] = static_cast<u32>(static_cast<u64>(tail_start) * i / num_parts) & ~1u;
+
+  m_loader = loader;
+  m_src = src;
+  m_dst = dst;
+  m_cull = cull;
+  {
+    std::lock_guard lk(m_threads_lock);
+    m_num_parts = num_parts;
+    m_work_generation++;
+    m_busy_threads = num_parts - 1;
+  }
+  m_work_available.notify_all();
+
+  RunPart(0);
+
+  {
+    std::unique_lock lk(m_threads_lock);
+    m_work_done.wait(lk, [this] { return m_busy_threads == 0; });
+  }
+
+  bool skipped = false;
+  for (u32 i = 0; i < num_parts; i++)
+  {
+    const u32 expected_count = m_part_starts[i + 1] - m_part_starts[i] - (i == 0 ? 0 : 1);
+    skipped |= m_loaded_counts[i] != static_cast<int>(expected_count);
+  }
+
+  // The loaders can write up to 4 bytes past the last vertex, so a part doesn't load its first
+  // vertex while the part before it might still write over it. Loading it now writes over the
+  // start of the next vertex instead, which is put back.
+  for (u32 i = 1; i < num_parts && !skipped; i++)
+  {
+    const u32 first = m_part_starts[i];
+    u8* const next_vertex = dst + (first + 1) * stride;
+    std::array<u8, 4> next_vertex_start;
+    std::memcpy(next_vertex_start.data(), next_vertex, next_vertex_start.size());
+    skipped = loader->RunVertices(src + first * vertex_size, dst + first * stride, 1) != 1;
+    std::memcpy(next_vertex, next_vertex_start.data(), next_vertex_start.size());
+
+    if (cull && !skipped)
+      cull->TransformVertices(dst, first, 2);
+  }
+
+  if (!skipped)
+  {
+    const int tail_count = count - static_cast<int>(tail_start);
+    skipped = loader->RunVertices(src + tail_start * vertex_size, dst + tail_start * stride,
+                                  tail_count) != tail_count;
+    if (cull && !skipped)
+      cull->TransformVertices(dst, tail_start, tail_count);
+  }
+
+  // Where a vertex goes depends on how many were skipped before it, so start over. Games hardly
+  // ever skip vertices.
+  if (skipped) [[unlikely]]
+  {
+    VertexLoaderManager::position_cache = old_position_cache;
+    VertexLoaderManager::position_matrix_index_cache = old_position_matrix_index_cache;
+    VertexLoaderManager::tangent_cache = old_tangent_cache;
+    VertexLoaderManager::binormal_cache = old_binormal_cache;
+    count = loader->RunVertices(src, dst, count);
+    if (cull)
+      cull->TransformVertices(dst, 0, count);
+  }
+
+  return count;
+}
+
+void ParallelVertexLoader::RunPart(u32 part)
+{
+  const u32 vertex_size = m_loader->m_vertex_size;
+  const u32 stride = m_loader->m_native_vtx_decl.stride;
+  const u32 begin = part == 0 ? 0 : m_part_starts[part] + 1;
+  const u32 end = m_part_starts[part + 1];
+  const int count = static_cast<int>(end - begin);
+
+  m_loaded_counts[part] =
+      m_loader->RunVertices(m_src + begin * vertex_size, m_dst + begin * stride, count);
+
+  // The vertex loaded separately is transformed along with the one after it
+  const u32 transform_begin = part == 0 ? 0 : begin + 1;
+  if (m_cull && m_loaded_counts[part] == count)
+    m_cull->TransformVertices(m_dst, transform_begin, end - transform_begin);
+}
+
+void ParallelVertexLoader::WorkerThread(u32 index)
+{
+  Common::SetCurrentThreadName(fmt::format("Vertex Loader {}", index).c_str());
+
+  u64 generation = 0;
+  while (true)
+  {
+    u32 num_parts;
+    {
+      std::unique_lock lk(m_threads_lock);
+      m_work_available.wait(
+          lk, [this, &generation] { return m_exit_threads || m_work_generation != generation; });
+      if (m_exit_threads)
+        return;
+      generation = m_work_generation;
+      num_parts = m_num_parts;
+    }
+
+    // Draws that aren't that large don't use every thread
+    if (index >= num_parts)
+      continue;
+
+    RunPart(index);
+
+    {
+      std::lock_guard lk(m_threads_lock);
+      if (--m_busy_threads == 0)
+        m_work_done.notify_one();
+    }
+  }
+}
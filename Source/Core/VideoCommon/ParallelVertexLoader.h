@@ -0,0 +1,60 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+class CPUCull;
+class VertexLoaderBase;
+
+// Splits the vertices of large draws between threads, which load them straight into the vertex
+// buffer. The vertices are also transformed for CPU culling by the thread that loaded them.
+class ParallelVertexLoader
+{
+public:
+  // num_threads counts the thread that runs the draws
+  explicit ParallelVertexLoader(u32 num_threads);
+  ~ParallelVertexLoader();
+
+  ParallelVertexLoader(const ParallelVertexLoader&) = delete;
+  ParallelVertexLoader& operator=(const ParallelVertexLoader&) = delete;
+
+  // Whether splitting the draw is worth waking up the other threads for
+  bool ShouldSplit(const VertexLoaderBase* loader, int count) const;
+
+  // Same as loader->RunVertices, with the same vertex buffer contents and zfreeze caches once it
+  // returns. When cull is given, its PrepareTransform has to have been called for the draw.
+  int RunVertices(VertexLoaderBase* loader, const u8* src, u8* dst, int count, CPUCull* cull);
+
+private:
+  // Each part of a draw should be at least this many bytes of input and output vertices
+  static constexpr u32 MIN_BYTES_PER_PART = 64 * 1024;
+
+  u32 GetNumParts(const VertexLoaderBase* loader, int count) const;
+  void RunPart(u32 part);
+  void WorkerThread(u32 index);
+
+  // The draw being split. Part 0 is loaded by the thread that runs the draw.
+  VertexLoaderBase* m_loader = nullptr;
+  const u8* m_src = nullptr;
+  u8* m_dst = nullptr;
+  CPUCull* m_cull = nullptr;
+  u32 m_num_parts = 0;
+  std::vector<u32> m_part_starts;
+  // Fewer vertices than expected are loaded when some are skipped
+  std::vector<int> m_loaded_counts;
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_threads_lock;
+  std::condition_variable m_work_available;
+  std::condition_variable m_work_done;
+  u64 m_work_generation = 0;
+  size_t m_busy_threads = 0;
+  bool m_exit_threads = false;
+};
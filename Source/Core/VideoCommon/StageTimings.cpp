@@ -0,0 +1,88 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "VideoCommon/StageTimings.h"
+
+#include <chrono>
+
+namespace StageTimings
+{
+std::atomic<bool> g_enabled = false;
+
+// The preprocessing of the FIFO in dual core times its decoding on the CPU thread while the GPU
+// thread times the rest, so the totals are shared and the open stages are per thread.
+static std::array<std::atomic<u64>, NUM_STAGES> s_time_ns;
+static std::array<std::atomic<u64>, NUM_STAGES> s_calls;
+static thread_local ScopedStage* s_current_stage = nullptr;
+
+static u64 GetTimeNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void SetEnabled(bool enabled)
+{
+  g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Reset()
+{
+  for (size_t i = 0; i < NUM_STAGES; ++i)
+  {
+    s_time_ns[i].store(0, std::memory_order_relaxed);
+    s_calls[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+std::array<StageTotal, NUM_STAGES> GetTotals()
+{
+  std::array<StageTotal, NUM_STAGES> totals;
+  for (size_t i = 0; i < NUM_STAGES; ++i)
+  {
+    totals[i].time_ns = s_time_ns[i].load(std::memory_order_relaxed);
+    totals[i].calls = s_calls[i].load(std::memory_order_relaxed);
+  }
+  return totals;
+}
+
+std::string_view GetStageName(Stage stage)
+{
+  switch (stage)
+  {
+  case Stage::Decode:
+    return "decode";
+  case Stage::VertexLoad:
+    return "vertex_load";
+  case Stage::Cull:
+    return "cull";
+  case Stage::TextureDecode:
+    return "texture_decode";
+  case Stage::DrawSubmit:
+    return "draw_submit";
+  }
+  return "unknown";
+}
+
+void ScopedStage::Begin(Stage stage)
+{
+  m_active = true;
+  m_stage = stage;
+  m_parent = s_current_stage;
+  s_current_stage = this;
+  m_start = GetTimeNs();
+}
+
+void ScopedStage::End()
+{
+  const u64 elapsed = GetTimeNs() - m_start;
+  const size_t index = static_cast<size_t>(m_stage);
+  s_time_ns[index].fetch_add(elapsed - m_nested_time, std::memory_order_relaxed);
+  s_calls[index].fetch_add(1, std::memory_order_relaxed);
+
+  if (m_parent)
+    m_parent->m_nested_time += elapsed;
+  s_current_stage = m_parent;
+}
+}  // namespace StageTimings
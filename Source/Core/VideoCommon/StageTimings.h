@@ -0,0 +1,71 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+
+#include "Common/CommonTypes.h"
+
+// Wall time spent in each stage of the command processing, for benchmarks. Stages nest, e.g. a
+// flush in the middle of loading vertices or a texture load in the middle of a flush, and the time
+// of the inner stage is only counted for it, so the stages add up to the time spent in all of them.
+namespace StageTimings
+{
+enum class Stage
+{
+  Decode,
+  VertexLoad,
+  Cull,
+  TextureDecode,
+  DrawSubmit,
+};
+
+constexpr size_t NUM_STAGES = static_cast<size_t>(Stage::DrawSubmit) + 1;
+
+struct StageTotal
+{
+  u64 time_ns = 0;
+  u64 calls = 0;
+};
+
+// Checked by every ScopedStage, timing is off unless a benchmark turns it on
+extern std::atomic<bool> g_enabled;
+
+void SetEnabled(bool enabled);
+void Reset();
+std::array<StageTotal, NUM_STAGES> GetTotals();
+std::string_view GetStageName(Stage stage);
+
+class ScopedStage
+{
+public:
+  explicit ScopedStage(Stage stage)
+  {
+    if (g_enabled.load(std::memory_order_relaxed)) [[unlikely]]
+      Begin(stage);
+  }
+  ~ScopedStage()
+  {
+    if (m_active) [[unlikely]]
+      End();
+  }
+
+  ScopedStage(const ScopedStage&) = delete;
+  ScopedStage& operator=(const ScopedStage&) = delete;
+
+private:
+  void Begin(Stage stage);
+  void End();
+
+  bool m_active = false;
+  Stage m_stage{};
+  u64 m_start = 0;
+  // Time spent in the stages nested in this one
+  u64 m_nested_time = 0;
+  ScopedStage* m_parent = nullptr;
+};
+}  // namespace StageTimings
@@ -47,6 +47,7 @@
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/Present.h"
 #include "VideoCommon/ShaderCache.h"
+#include "VideoCommon/StageTimings.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/TMEM.h"
 #include "VideoCommon/TextureConversionShader.h"
@@ -1706,6 +1707,7 @@ RcTcacheEntry TextureCacheBase::CreateTextureEntry(
   }
   else
   {
+    StageTimings::ScopedStage timing(StageTimings::Stage::TextureDecode);
     const u32 texLevels = no_mips ? 1 : texture_info.GetLevelCount();
     const u32 expanded_width = texture_info.GetExpandedWidth();
     const u32 expanded_height = texture_info.GetExpandedHeight();
@@ -27,6 +27,8 @@
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/ParallelVertexLoader.h"
+#include "VideoCommon/StageTimings.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderBase.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -50,6 +52,8 @@ u32 g_current_components;
 typedef std::unordered_map<VertexLoaderUID, std::unique_ptr<VertexLoaderBase>> VertexLoaderMap;
 static std::mutex s_vertex_loader_map_lock;
 static VertexLoaderMap s_vertex_loader_map;
+// Only used by the GPU thread
+static std::unique_ptr<ParallelVertexLoader> s_parallel_loader;
 // TODO - change into array of pointers. Keep a map of all seen so far.
 
 Common::EnumMap<u8*, CPArray::TexCoord7> cached_arraybases;
@@ -67,10 +71,13 @@ void Init()
   g_main_vertex_loaders.fill(nullptr);
   g_preprocess_vertex_loaders.fill(nullptr);
   SETSTAT(g_stats.num_vertex_loaders, 0);
+  s_parallel_loader = std::make_unique<ParallelVertexLoader>(g_Config.GetVertexLoaderThreads());
 }
 
 void Clear()
 {
+  s_parallel_loader.reset();
+
   std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
   s_vertex_loader_map.clear();
   s_native_vertex_map.clear();
@@ -373,15 +380,33 @@ int RunVertices(int vtx_attr_group, OpcodeDecoder::Primitive primitive, int coun
     DataReader dst = g_vertex_manager->PrepareForAdditionalData(primitive, count, stride,
                                                                 cullall || can_cpu_cull);
 
-    count = loader->RunVertices(src, dst.GetPointer(), count);
-
-    if (can_cpu_cull && !cullall)
+    const bool cpu_cull = can_cpu_cull && !cullall;
+    bool all_culled;
+    if (s_parallel_loader && s_parallel_loader->ShouldSplit(loader, count))
+    {
+      // The vertices are transformed for culling by the threads that load them
+      CPUCull* cull =
+          cpu_cull ? &g_vertex_manager->PrepareCPUCull(loader, primitive, count) : nullptr;
+      {
+        StageTimings::ScopedStage timing(StageTimings::Stage::VertexLoad);
+        count = s_parallel_loader->RunVertices(loader, src, dst.GetPointer(), count, cull);
+      }
+      all_culled = cpu_cull && g_vertex_manager->AreTransformedVerticesCulled(count);
+    }
+    else
     {
-      if (!g_vertex_manager->AreAllVerticesCulled(loader, primitive, dst.GetPointer(), count))
       {
-        DataReader new_dst = g_vertex_manager->DisableCullAll(stride);
-        memmove(new_dst.GetPointer(), dst.GetPointer(), count * stride);
+        StageTimings::ScopedStage timing(StageTimings::Stage::VertexLoad);
+        count = loader->RunVertices(src, dst.GetPointer(), count);
       }
+      all_culled = cpu_cull && g_vertex_manager->AreAllVerticesCulled(loader, primitive,
+                                                                       dst.GetPointer(), count);
+    }
+
+    if (cpu_cull && !all_culled)
+    {
+      DataReader new_dst = g_vertex_manager->DisableCullAll(stride);
+      memmove(new_dst.GetPointer(), dst.GetPointer(), count * stride);
     }
 
     g_vertex_manager->AddIndices(primitive, count);
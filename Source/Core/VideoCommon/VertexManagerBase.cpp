@@ -34,6 +34,7 @@
 #include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/StageTimings.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/TextureInfo.h"
 #include "VideoCommon/VertexLoaderManager.h"
@@ -142,9 +143,23 @@ bool VertexManagerBase::AreAllVerticesCulled(VertexLoaderBase* loader,
                                              OpcodeDecoder::Primitive primitive, const u8* src,
                                              u32 count)
 {
+  StageTimings::ScopedStage timing(StageTimings::Stage::Cull);
   return m_cpu_cull.AreAllVerticesCulled(loader, primitive, src, count);
 }
 
+CPUCull& VertexManagerBase::PrepareCPUCull(VertexLoaderBase* loader,
+                                           OpcodeDecoder::Primitive primitive, u32 count)
+{
+  m_cpu_cull.PrepareTransform(loader, primitive, count);
+  return m_cpu_cull;
+}
+
+bool VertexManagerBase::AreTransformedVerticesCulled(u32 count)
+{
+  StageTimings::ScopedStage timing(StageTimings::Stage::Cull);
+  return m_cpu_cull.AreTransformedVerticesCulled(count);
+}
+
 DataReader VertexManagerBase::PrepareForAdditionalData(OpcodeDecoder::Primitive primitive,
                                                        u32 count, u32 stride, bool cullall)
 {
@@ -438,6 +453,7 @@ void VertexManagerBase::Flush()
     return;
 
   m_is_flushed = true;
+  StageTimings::ScopedStage timing(StageTimings::Stage::DrawSubmit);
 
   if (m_draw_counter == 0)
   {
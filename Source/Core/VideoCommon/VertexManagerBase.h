@@ -108,6 +108,9 @@ public:
   void AddIndices(OpcodeDecoder::Primitive primitive, u32 num_vertices);
   bool AreAllVerticesCulled(VertexLoaderBase* loader, OpcodeDecoder::Primitive primitive,
                             const u8* src, u32 count);
+  /// For culling vertices that are transformed as they are loaded
+  CPUCull& PrepareCPUCull(VertexLoaderBase* loader, OpcodeDecoder::Primitive primitive, u32 count);
+  bool AreTransformedVerticesCulled(u32 count);
   virtual DataReader PrepareForAdditionalData(OpcodeDecoder::Primitive primitive, u32 count,
                                               u32 stride, bool cullall);
   /// Switch cullall off after a call to PrepareForAdditionalData with cullall true
@@ -152,7 +152,9 @@ void VideoConfig::Refresh()
   iShaderCompilationMode = Config::Get(Config::GFX_SHADER_COMPILATION_MODE);
   iShaderCompilerThreads = Config::Get(Config::GFX_SHADER_COMPILER_THREADS);
   iShaderPrecompilerThreads = Config::Get(Config::GFX_SHADER_PRECOMPILER_THREADS);
+  iSWRasterizerThreads = Config::Get(Config::GFX_SW_RASTERIZER_THREADS);
   bCPUCull = Config::Get(Config::GFX_CPU_CULL);
+  iVertexLoaderThreads = Config::Get(Config::GFX_VERTEX_LOADER_THREADS);
 
   texture_filtering_mode = Config::Get(Config::GFX_ENHANCE_FORCE_TEXTURE_FILTERING);
   iMaxAnisotropy = Config::Get(Config::GFX_ENHANCE_MAX_ANISOTROPY);
@@ -279,6 +281,25 @@ u32 VideoConfig::GetShaderPrecompilerThreads() const
     return 1;
 }
 
+u32 VideoConfig::GetSWRasterizerThreads() const
+{
+  if (iSWRasterizerThreads > 0)
+    return static_cast<u32>(iSWRasterizerThreads);
+
+  // Automatic number, leaving a core for the CPU thread.
+  return static_cast<u32>(std::max(cpu_info.num_cores - 1, 1));
+}
+
+u32 VideoConfig::GetVertexLoaderThreads() const
+{
+  if (iVertexLoaderThreads > 0)
+    return static_cast<u32>(iVertexLoaderThreads);
+
+  // Automatic number. Few draws are large enough for more threads to help, and the CPU thread
+  // needs a core of its own.
+  return static_cast<u32>(std::clamp(cpu_info.num_cores - 1, 1, 4));
+}
+
 void CheckForConfigChanges()
 {
   const ShaderHostConfig old_shader_host_config = ShaderHostConfig::GetCurrent();
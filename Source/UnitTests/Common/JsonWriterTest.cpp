@@ -0,0 +1,116 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include <picojson.h>
+
+#include "Common/JsonWriter.h"
+
+TEST(JsonWriter, Layout)
+{
+  Common::JsonWriter writer;
+  writer.BeginObject();
+  writer.QuotedNumber("GameID", 1234u);
+  writer.Number("Score", u16{7});
+  writer.Number("Speed", 1.5f);
+  writer.BeginArray("Empty");
+  writer.EndArray();
+  writer.BeginArray("List");
+  writer.BeginObject();
+  writer.String("P", "Mario");
+  writer.EndObject();
+  writer.EndArray();
+  writer.BeginObject("Nested");
+  writer.Bool("Flag", true);
+  writer.Null("Nothing");
+  writer.EndObject();
+  writer.EndObject();
+
+  EXPECT_EQ(writer.GetView(), "{\n"
+                              "  \"GameID\": \"1234\",\n"
+                              "  \"Score\": 7,\n"
+                              "  \"Speed\": 1.5,\n"
+                              "  \"Empty\": [],\n"
+                              "  \"List\": [\n"
+                              "    {\n"
+                              "      \"P\": \"Mario\"\n"
+                              "    }\n"
+                              "  ],\n"
+                              "  \"Nested\": {\n"
+                              "    \"Flag\": true,\n"
+                              "    \"Nothing\": null\n"
+                              "  }\n"
+                              "}");
+}
+
+TEST(JsonWriter, EscapesStrings)
+{
+  Common::JsonWriter writer;
+  writer.BeginObject();
+  writer.String("Name \"1\"", "a\\b\n\x01");
+  writer.EndObject();
+
+  EXPECT_EQ(writer.GetView(), "{\n  \"Name \\\"1\\\"\": \"a\\\\b\\n\\u0001\"\n}");
+
+  picojson::value value;
+  ASSERT_TRUE(picojson::parse(value, std::string(writer.GetView())).empty());
+  EXPECT_EQ(value.get("Name \"1\"").get<std::string>(), "a\\b\n\x01");
+}
+
+TEST(JsonWriter, AppendElements)
+{
+  Common::JsonWriter elements;
+  elements.Clear(2);
+  for (int i = 0; i < 2; ++i)
+  {
+    elements.BeginObject();
+    elements.Number("N", i);
+    elements.EndObject();
+  }
+
+  Common::JsonWriter direct;
+  direct.BeginObject();
+  direct.BeginArray("Events");
+  for (int i = 0; i < 2; ++i)
+  {
+    direct.BeginObject();
+    direct.Number("N", i);
+    direct.EndObject();
+  }
+  direct.EndArray();
+  direct.EndObject();
+
+  Common::JsonWriter spliced;
+  spliced.BeginObject();
+  spliced.BeginArray("Events");
+  spliced.AppendElements(elements);
+  spliced.EndArray();
+  spliced.EndObject();
+
+  EXPECT_EQ(spliced.GetView(), direct.GetView());
+}
+
+TEST(JsonWriter, ReuseDoesNotAllocate)
+{
+  Common::JsonWriter writer;
+  const auto write = [&writer] {
+    writer.Clear();
+    writer.BeginObject();
+    for (int i = 0; i < 100; ++i)
+    {
+      writer.Number("Integer", i);
+      writer.Number("Float", i * 0.25f);
+      writer.String("String", "Bowser Jr");
+    }
+    writer.EndObject();
+  };
+
+  write();
+  const char* const data = writer.GetString().data();
+  const size_t capacity = writer.GetString().capacity();
+  write();
+  EXPECT_EQ(writer.GetString().data(), data);
+  EXPECT_EQ(writer.GetString().capacity(), capacity);
+}
@@ -0,0 +1,291 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Swap.h"
+#include "Core/CheatSearch.h"
+
+namespace
+{
+constexpr u32 MEMORY_BASE = 0x80000000;
+constexpr u32 MEMORY_SIZE = 0x10000;
+
+constexpr Cheats::CompareType COMPARE_TYPES[] = {
+    Cheats::CompareType::Equal,   Cheats::CompareType::NotEqual,
+    Cheats::CompareType::Less,    Cheats::CompareType::LessOrEqual,
+    Cheats::CompareType::Greater, Cheats::CompareType::GreaterOrEqual,
+};
+
+// Starts below the memory, straddles a page, and runs past the end of the memory
+const std::vector<Cheats::MemoryRange> RANGES = {
+    {0x7FFFF801, 0x1000},
+    {0x80001003, 0x5000},
+    {0x8000A001, 0x2FFF},
+    {0x8000F002, 0x2000},
+};
+
+template <typename T>
+bool Compare(Cheats::CompareType compare_type, const T& new_value, const T& old_value)
+{
+  switch (compare_type)
+  {
+  case Cheats::CompareType::Equal:
+    return new_value == old_value;
+  case Cheats::CompareType::NotEqual:
+    return new_value != old_value;
+  case Cheats::CompareType::Less:
+    return new_value < old_value;
+  case Cheats::CompareType::LessOrEqual:
+    return new_value <= old_value;
+  case Cheats::CompareType::Greater:
+    return new_value > old_value;
+  default:
+    return new_value >= old_value;
+  }
+}
+
+// Few distinct bytes, so that equal values are common
+std::vector<u8> MakeMemory(u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> byte(0, 3);
+  std::vector<u8> memory(MEMORY_SIZE);
+  for (u8& b : memory)
+    b = static_cast<u8>(byte(rng) * 0x41);
+  return memory;
+}
+
+template <typename T>
+std::optional<T> ReadValue(const std::vector<u8>& memory, u64 address,
+                           u32 memory_size = MEMORY_SIZE)
+{
+  if (address < MEMORY_BASE || address + sizeof(T) > u64(MEMORY_BASE) + memory_size)
+    return std::nullopt;
+  T value;
+  std::memcpy(&value, &memory[address - MEMORY_BASE], sizeof(T));
+  return Common::FromBigEndian(value);
+}
+
+// What NewSearch and NextSearch find when reading value by value
+template <typename T>
+std::vector<Cheats::SearchResult<T>>
+ReferenceNewSearch(const std::vector<u8>& memory, bool aligned,
+                   std::optional<Cheats::CompareType> compare_type, const T& value)
+{
+  std::vector<Cheats::SearchResult<T>> results;
+  for (const Cheats::MemoryRange& range : RANGES)
+  {
+    for (u64 address = range.m_start; address + sizeof(T) <= range.m_start + range.m_length;
+         ++address)
+    {
+      if (aligned && address % sizeof(T) != 0)
+        continue;
+      const std::optional<T> current = ReadValue<T>(memory, address);
+      if (current && (!compare_type || Compare(*compare_type, *current, value)))
+      {
+        auto& r = results.emplace_back();
+        r.m_address = static_cast<u32>(address);
+        r.m_value = *current;
+        r.m_value_state = Cheats::SearchResultValueState::ValueFromPhysicalMemory;
+      }
+    }
+  }
+  return results;
+}
+
+template <typename T>
+std::vector<Cheats::SearchResult<T>>
+ReferenceNextSearch(const std::vector<u8>& memory, u32 memory_size,
+                    const std::vector<Cheats::SearchResult<T>>& previous_results,
+                    Cheats::CompareType compare_type, const std::optional<T>& value)
+{
+  std::vector<Cheats::SearchResult<T>> results;
+  for (const Cheats::SearchResult<T>& previous : previous_results)
+  {
+    const std::optional<T> current = ReadValue<T>(memory, previous.m_address, memory_size);
+    if (!current)
+    {
+      auto& r = results.emplace_back();
+      r.m_address = previous.m_address;
+      r.m_value_state = Cheats::SearchResultValueState::AddressNotAccessible;
+      continue;
+    }
+
+    if (!previous.IsValueValid() ||
+        Compare(compare_type, *current, value ? *value : previous.m_value))
+    {
+      auto& r = results.emplace_back();
+      r.m_address = previous.m_address;
+      r.m_value = *current;
+      r.m_value_state = Cheats::SearchResultValueState::ValueFromPhysicalMemory;
+    }
+  }
+  return results;
+}
+
+template <typename T>
+void ExpectSameResults(const std::vector<Cheats::SearchResult<T>>& expected,
+                       const Cheats::SearchResultBitmap& bitmap)
+{
+  ASSERT_EQ(bitmap.GetResultCount(), expected.size());
+  const std::vector<Cheats::SearchResult<T>> actual = bitmap.ToList<T>(0, expected.size());
+  ASSERT_EQ(actual.size(), expected.size());
+
+  size_t valid_count = 0;
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(actual[i].m_address, expected[i].m_address);
+    ASSERT_EQ(actual[i].m_value_state, expected[i].m_value_state);
+    if (expected[i].IsValueValid())
+    {
+      ++valid_count;
+      ASSERT_EQ(std::memcmp(&actual[i].m_value, &expected[i].m_value, sizeof(T)), 0);
+    }
+  }
+  EXPECT_EQ(bitmap.GetValidValueCount(), valid_count);
+}
+
+template <typename T>
+class CheatSearchTest : public testing::Test
+{
+};
+
+using SearchTypes = testing::Types<u8, u16, u32, u64, s8, s16, s32, s64, float, double>;
+TYPED_TEST_SUITE(CheatSearchTest, SearchTypes);
+}  // namespace
+
+TYPED_TEST(CheatSearchTest, NewSearchMatchesReference)
+{
+  using T = TypeParam;
+  const std::vector<u8> memory = MakeMemory(1);
+  const T value = *ReadValue<T>(memory, MEMORY_BASE + 0x2345);
+
+  for (const bool aligned : {false, true})
+  {
+    Cheats::SearchResultBitmap bitmap;
+    bitmap.Capture(RANGES, memory.data(), MEMORY_BASE, MEMORY_SIZE, sizeof(T), aligned);
+
+    bitmap.Filter<T>(nullptr, std::nullopt, std::nullopt);
+    ExpectSameResults(ReferenceNewSearch<T>(memory, aligned, std::nullopt, value), bitmap);
+
+    for (const Cheats::CompareType compare_type : COMPARE_TYPES)
+    {
+      SCOPED_TRACE(fmt::format("aligned {} compare type {}", aligned, int(compare_type)));
+      bitmap.Filter<T>(nullptr, compare_type, value);
+      ExpectSameResults(ReferenceNewSearch<T>(memory, aligned, compare_type, value), bitmap);
+    }
+  }
+}
+
+TYPED_TEST(CheatSearchTest, NextSearchMatchesReference)
+{
+  using T = TypeParam;
+  const std::vector<u8> first_memory = MakeMemory(2);
+  const std::vector<u8> second_memory = MakeMemory(3);
+  const T value = *ReadValue<T>(second_memory, MEMORY_BASE + 0x6789);
+
+  for (const bool aligned : {false, true})
+  {
+    Cheats::SearchResultBitmap first;
+    first.Capture(RANGES, first_memory.data(), MEMORY_BASE, MEMORY_SIZE, sizeof(T), aligned);
+    first.Filter<T>(nullptr, std::nullopt, std::nullopt);
+    const std::vector<Cheats::SearchResult<T>> first_results =
+        ReferenceNewSearch<T>(first_memory, aligned, std::nullopt, value);
+
+    // The second copy can read less than the first
+    const u32 second_size = MEMORY_SIZE - 0x1000;
+    for (const Cheats::CompareType compare_type : COMPARE_TYPES)
+    {
+      for (const bool against_value : {false, true})
+      {
+        SCOPED_TRACE(fmt::format("aligned {} compare type {} against value {}", aligned,
+                                 int(compare_type), against_value));
+        Cheats::SearchResultBitmap second;
+        second.Capture(RANGES, second_memory.data(), MEMORY_BASE, second_size, sizeof(T),
+                       aligned);
+        const std::optional<T> compare_value =
+            against_value ? std::optional<T>(value) : std::nullopt;
+        second.Filter<T>(&first, compare_type, compare_value);
+
+        const std::vector<Cheats::SearchResult<T>> expected = ReferenceNextSearch<T>(
+            second_memory, second_size, first_results, compare_type, compare_value);
+        ExpectSameResults(expected, second);
+
+        // A third search keeps the inaccessible values and compares the rest against the second
+        Cheats::SearchResultBitmap third;
+        third.Capture(RANGES, second_memory.data(), MEMORY_BASE, MEMORY_SIZE, sizeof(T), aligned);
+        third.Filter<T>(&second, Cheats::CompareType::Equal, std::nullopt);
+        ExpectSameResults(
+            ReferenceNextSearch<T>(second_memory, MEMORY_SIZE, expected,
+                                   Cheats::CompareType::Equal, std::nullopt),
+            third);
+      }
+    }
+  }
+}
+
+TEST(CheatSearch, ResultSelection)
+{
+  const std::vector<u8> memory = MakeMemory(4);
+  Cheats::SearchResultBitmap bitmap;
+  bitmap.Capture(RANGES, memory.data(), MEMORY_BASE, MEMORY_SIZE, sizeof(u16), false);
+  bitmap.Filter<u16>(nullptr, Cheats::CompareType::Equal, u16(0x4141));
+
+  const std::vector<Cheats::SearchResult<u16>> all =
+      bitmap.ToList<u16>(0, bitmap.GetResultCount());
+  ASSERT_GT(all.size(), 100u);
+  for (size_t index :
+       {size_t(0), size_t(1), size_t(63), size_t(64), all.size() / 2, all.size() - 1})
+  {
+    const size_t position = bitmap.GetResultPosition(index);
+    EXPECT_EQ(bitmap.GetAddress(position), all[index].m_address);
+    EXPECT_EQ(bitmap.GetValue<u16>(position), 0x4141);
+
+    const std::vector<Cheats::SearchResult<u16>> one = bitmap.ToList<u16>(index, index + 1);
+    ASSERT_EQ(one.size(), 1u);
+    EXPECT_EQ(one[0].m_address, all[index].m_address);
+  }
+}
+
+TEST(CheatSearch, FullMEM1Search)
+{
+  constexpr u32 mem1_size = 0x01800000;
+  std::vector<u8> memory(mem1_size);
+  std::mt19937 rng(5);
+  for (size_t i = 0; i < memory.size(); i += 4)
+  {
+    const u32 value = Common::swap32(rng() % 1024);
+    std::memcpy(&memory[i], &value, sizeof(value));
+  }
+  const std::vector<Cheats::MemoryRange> ranges = {{MEMORY_BASE, mem1_size}};
+
+  for (const bool aligned : {true, false})
+  {
+    const auto start = std::chrono::steady_clock::now();
+    Cheats::SearchResultBitmap bitmap;
+    bitmap.Capture(ranges, memory.data(), MEMORY_BASE, mem1_size, sizeof(u32), aligned);
+    bitmap.Filter<u32>(nullptr, Cheats::CompareType::Equal, u32(100));
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    size_t expected = 0;
+    for (u32 i = 0; i + sizeof(u32) <= mem1_size; i += aligned ? sizeof(u32) : 1)
+    {
+      u32 value;
+      std::memcpy(&value, &memory[i], sizeof(value));
+      expected += Common::swap32(value) == 100;
+    }
+    EXPECT_EQ(bitmap.GetResultCount(), expected);
+    fmt::print("MEM1 u32 search, aligned {}: {:.1f}ms, {} results, {} bytes\n", aligned,
+               elapsed.count(), bitmap.GetResultCount(), bitmap.GetMemoryUsage());
+  }
+}
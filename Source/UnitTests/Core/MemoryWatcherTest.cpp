@@ -0,0 +1,339 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Common/Swap.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/MemoryWatcher.h"
+#include "Core/PowerPC/MMU.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/System.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+int BindSocket(const std::string& path)
+{
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path))
+    return -1;
+  std::memcpy(addr.sun_path, path.c_str(), path.size());
+
+  const int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (fd >= 0 && bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+  {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+sockaddr_un SocketAddress(const std::string& path)
+{
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.c_str(), std::min(path.size(), sizeof(addr.sun_path) - 1));
+  return addr;
+}
+
+void SendTo(int fd, const sockaddr_un& addr, const std::string& message)
+{
+  sendto(fd, message.data(), message.size(), 0, reinterpret_cast<const sockaddr*>(&addr),
+         sizeof(addr));
+}
+
+void SendTo(const std::string& path, const std::string& message)
+{
+  const int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  SendTo(fd, SocketAddress(path), message);
+  close(fd);
+}
+
+// Returns every datagram that is waiting on the socket
+std::vector<std::string> ReceiveAll(int fd)
+{
+  std::vector<std::string> packets;
+  std::vector<char> buffer(MemoryWatcher::MAX_PACKET_SIZE + 1);
+  while (true)
+  {
+    const ssize_t size = recv(fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+    if (size < 0)
+      break;
+    packets.emplace_back(buffer.data(), size);
+  }
+  return packets;
+}
+
+u32 PacketU32(const std::string& packet, size_t index)
+{
+  u32 value;
+  std::memcpy(&value, packet.data() + index * sizeof(u32), sizeof(value));
+  return value;
+}
+
+// The watcher as it was before watches were compiled to flat arrays: a map lookup and an MMU
+// read per offset, and a string stream for the message.
+class LegacyWatcher
+{
+public:
+  void Add(const std::string& line)
+  {
+    m_values[line] = 0;
+    std::istringstream offsets(line);
+    offsets >> std::hex;
+    u32 offset;
+    while (offsets >> offset)
+      m_addresses[line].push_back(offset);
+  }
+
+  std::string ComposeMessages(const Core::CPUThreadGuard& guard)
+  {
+    std::ostringstream message_stream;
+    message_stream << std::hex;
+    for (auto& [address, current_value] : m_values)
+    {
+      u32 new_value = 0;
+      for (u32 offset : m_addresses[address])
+      {
+        new_value = PowerPC::MMU::HostRead_U32(guard, new_value + offset);
+        if (!PowerPC::MMU::HostIsRAMAddress(guard, new_value))
+          break;
+      }
+      if (new_value != current_value)
+      {
+        current_value = new_value;
+        message_stream << address << '\n' << new_value << '\n';
+      }
+    }
+    return message_stream.str();
+  }
+
+private:
+  std::map<std::string, std::vector<u32>> m_addresses;
+  std::map<std::string, u32> m_values;
+};
+
+// Sets up MEM1 and the default GameCube BATs, like a running game has them.
+class MemoryWatcherTest : public testing::Test
+{
+protected:
+  MemoryWatcherTest()
+      : m_system(Core::System::GetInstance()), m_profile_path(File::CreateTempDir())
+  {
+    if (!UserDirectoryExists())
+      return;
+
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    m_system.GetMemory().Init();
+    m_system.GetPowerPC().Init(PowerPC::CPUCore::Interpreter);
+
+    auto& ppc_state = m_system.GetPPCState();
+    ppc_state.spr[SPR_DBAT0U] = 0x80001fff;
+    ppc_state.spr[SPR_DBAT0L] = 0x00000002;
+    ppc_state.spr[SPR_DBAT1U] = 0xc0001fff;
+    ppc_state.spr[SPR_DBAT1L] = 0x0000002a;
+    ppc_state.msr.DR = 1;
+    m_system.GetMMU().DBATUpdated();
+
+    m_locations_path = m_profile_path + "/Locations.txt";
+    m_socket_path = m_profile_path + "/MemoryWatcher";
+    m_control_path = m_profile_path + "/MemoryWatcherControl";
+    m_client_fd = BindSocket(m_socket_path);
+  }
+  ~MemoryWatcherTest() override
+  {
+    if (!UserDirectoryExists())
+      return;
+
+    if (m_client_fd >= 0)
+      close(m_client_fd);
+    m_system.GetPowerPC().Shutdown();
+    m_system.GetMemory().Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  bool UserDirectoryExists() const { return !m_profile_path.empty(); }
+
+  void WriteU32(u32 address, u32 value)
+  {
+    const u32 swapped = Common::swap32(value);
+    std::memcpy(m_system.GetMemory().GetRAM() + (address - Memory::MEM1_BASE_ADDR), &swapped,
+                sizeof(swapped));
+  }
+
+  Core::System& m_system;
+  std::string m_profile_path;
+  std::string m_locations_path;
+  std::string m_socket_path;
+  std::string m_control_path;
+  int m_client_fd = -1;
+};
+}  // namespace
+
+TEST_F(MemoryWatcherTest, SendsChangedValues)
+{
+  if (!UserDirectoryExists())
+    GTEST_SKIP() << "Could not create a user directory";
+  ASSERT_GE(m_client_fd, 0);
+
+  WriteU32(0x80001000, 0x12345678);
+  WriteU32(0x80002000, 0x80003000);
+  WriteU32(0x80003010, 42);
+  ASSERT_TRUE(File::WriteStringToFile(m_locations_path, "80001000\n80002000 10\nnot an address\n"));
+
+  const Core::CPUThreadGuard guard(m_system);
+  MemoryWatcher watcher(m_locations_path, m_socket_path, m_control_path);
+  ASSERT_TRUE(watcher.IsRunning());
+  EXPECT_EQ(watcher.GetWatchCount(), 2u);
+
+  watcher.Step(guard);
+  std::vector<std::string> packets = ReceiveAll(m_client_fd);
+  ASSERT_EQ(packets.size(), 1u);
+  EXPECT_EQ(packets[0], std::string("80001000\n12345678\n80002000 10\n2a\n") + '\0');
+
+  // Only what changed, and an empty datagram when nothing did
+  WriteU32(0x80003010, 43);
+  watcher.Step(guard);
+  watcher.Step(guard);
+  packets = ReceiveAll(m_client_fd);
+  ASSERT_EQ(packets.size(), 2u);
+  EXPECT_EQ(packets[0], std::string("80002000 10\n2b\n") + '\0');
+  EXPECT_EQ(packets[1], std::string(1, '\0'));
+
+  // Subscriptions, sampling rate and format change at runtime
+  WriteU32(0x80004000, 7);
+  SendTo(m_control_path, "format binary\nadd 80004000\nremove 80001000\nrate 2\n");
+  watcher.Step(guard);
+  EXPECT_EQ(watcher.GetWatchCount(), 2u);
+  packets = ReceiveAll(m_client_fd);
+  ASSERT_EQ(packets.size(), 1u);
+  ASSERT_EQ(packets[0].size(), 5 * sizeof(u32));
+  EXPECT_EQ(PacketU32(packets[0], 0), MemoryWatcher::BINARY_MAGIC);
+  EXPECT_EQ(PacketU32(packets[0], 1), 4u);
+  EXPECT_EQ(PacketU32(packets[0], 2), 1u);
+  // The third watch, after the two from the file
+  EXPECT_EQ(PacketU32(packets[0], 3), 2u);
+  EXPECT_EQ(PacketU32(packets[0], 4), 7u);
+
+  // Frame 5 is skipped, frame 6 picks up the change
+  WriteU32(0x80001000, 1);
+  WriteU32(0x80003010, 44);
+  watcher.Step(guard);
+  EXPECT_TRUE(ReceiveAll(m_client_fd).empty());
+  watcher.Step(guard);
+  packets = ReceiveAll(m_client_fd);
+  ASSERT_EQ(packets.size(), 1u);
+  ASSERT_EQ(packets[0].size(), 5 * sizeof(u32));
+  EXPECT_EQ(PacketU32(packets[0], 1), 6u);
+  EXPECT_EQ(PacketU32(packets[0], 3), 1u);
+  EXPECT_EQ(PacketU32(packets[0], 4), 44u);
+
+  // Binary samples without changes are not sent
+  watcher.Step(guard);
+  watcher.Step(guard);
+  EXPECT_TRUE(ReceiveAll(m_client_fd).empty());
+}
+
+TEST_F(MemoryWatcherTest, Benchmark10kAddresses)
+{
+  if (!UserDirectoryExists())
+    GTEST_SKIP() << "Could not create a user directory";
+  ASSERT_GE(m_client_fd, 0);
+
+  // Half plain addresses, half a pointer followed by an offset, all into one table of pointers
+  constexpr u32 WATCHES = 10000;
+  constexpr u32 TABLE = 0x80100000;
+  constexpr u32 DATA = 0x80200000;
+  std::string locations;
+  LegacyWatcher legacy;
+  for (u32 i = 0; i < WATCHES; ++i)
+  {
+    WriteU32(TABLE + i * 4, DATA + i * 8);
+    WriteU32(DATA + i * 8 + 4, i);
+    const std::string line =
+        i % 2 ? fmt::format("{:x} 4", TABLE + i * 4) : fmt::format("{:x}", DATA + i * 8 + 4);
+    locations += line + '\n';
+    legacy.Add(line);
+  }
+  ASSERT_TRUE(File::WriteStringToFile(m_locations_path, locations));
+
+  const Core::CPUThreadGuard guard(m_system);
+  MemoryWatcher watcher(m_locations_path, m_socket_path, m_control_path);
+  ASSERT_TRUE(watcher.IsRunning());
+  ASSERT_EQ(watcher.GetWatchCount(), WATCHES);
+
+  // Keeps the socket drained so sending never blocks
+  std::atomic<bool> done = false;
+  std::atomic<u64> received = 0;
+  std::thread client([&] {
+    std::vector<char> buffer(MemoryWatcher::MAX_PACKET_SIZE + 1);
+    while (!done.load(std::memory_order_relaxed))
+    {
+      if (recv(m_client_fd, buffer.data(), buffer.size(), MSG_DONTWAIT) > 0)
+        received.fetch_add(1, std::memory_order_relaxed);
+      else
+        std::this_thread::yield();
+    }
+  });
+
+  // Every value is sent on the first frame, after that 1% of them change per frame
+  constexpr int FRAMES = 200;
+  const auto measure = [&](auto&& step) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < FRAMES; ++frame)
+    {
+      for (u32 i = frame % 100; i < WATCHES; i += 100)
+        WriteU32(DATA + i * 8 + 4, i + frame + 1);
+      step();
+    }
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / FRAMES;
+  };
+
+  const int legacy_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  const sockaddr_un legacy_addr = SocketAddress(m_socket_path);
+  const double legacy_us = measure([&] {
+    const std::string message = legacy.ComposeMessages(guard);
+    SendTo(legacy_fd, legacy_addr, message.substr(0, MemoryWatcher::MAX_PACKET_SIZE));
+  });
+  close(legacy_fd);
+  const double text_us = measure([&] { watcher.Step(guard); });
+  SendTo(m_control_path, "format binary");
+  const double binary_us = measure([&] { watcher.Step(guard); });
+
+  done = true;
+  client.join();
+  EXPECT_GT(received.load(), 0u);
+
+  fmt::print("{} watches: legacy {:.1f}us/frame, text {:.1f}us/frame ({:.1f}x), "
+             "binary {:.1f}us/frame ({:.1f}x)\n",
+             WATCHES, legacy_us, text_us, legacy_us / text_us, binary_us,
+             legacy_us / binary_us);
+}
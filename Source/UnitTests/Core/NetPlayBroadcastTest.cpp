@@ -0,0 +1,210 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayBroadcast.h"
+#include "InputCommon/GCPadStatus.h"
+
+using NetPlay::BroadcastEncoder;
+using NetPlay::BroadcastInput;
+
+namespace
+{
+// Held buttons and sticks that drift, like a player would make them
+class InputWalk
+{
+public:
+  explicit InputWalk(u32 seed) : m_rng(seed)
+  {
+    m_status.stickX = GCPadStatus::MAIN_STICK_CENTER_X;
+    m_status.stickY = GCPadStatus::MAIN_STICK_CENTER_Y;
+    m_status.substickX = GCPadStatus::C_STICK_CENTER_X;
+    m_status.substickY = GCPadStatus::C_STICK_CENTER_Y;
+    m_status.isConnected = true;
+  }
+
+  const GCPadStatus& Next()
+  {
+    if (m_rng() % 8 == 0)
+      m_status.button ^= 1 << (m_rng() % 13);
+    if (m_rng() % 3 == 0)
+      m_status.stickX = static_cast<u8>(m_status.stickX + static_cast<int>(m_rng() % 9) - 4);
+    if (m_rng() % 3 == 0)
+      m_status.stickY = static_cast<u8>(m_status.stickY + static_cast<int>(m_rng() % 9) - 4);
+    if (m_rng() % 30 == 0)
+      m_status.triggerLeft = static_cast<u8>(m_rng());
+    if (m_rng() % 500 == 0)
+      m_status.isConnected = !m_status.isConnected;
+    return m_status;
+  }
+
+private:
+  std::mt19937 m_rng;
+  GCPadStatus m_status;
+};
+
+bool operator==(const GCPadStatus& a, const GCPadStatus& b)
+{
+  return a.button == b.button && a.stickX == b.stickX && a.stickY == b.stickY &&
+         a.substickX == b.substickX && a.substickY == b.substickY &&
+         a.triggerLeft == b.triggerLeft && a.triggerRight == b.triggerRight &&
+         a.analogA == b.analogA && a.analogB == b.analogB && a.isConnected == b.isConnected;
+}
+}  // namespace
+
+TEST(NetPlayBroadcast, RoundTripsInputs)
+{
+  BroadcastEncoder encoder;
+  std::vector<InputWalk> walks{InputWalk(1), InputWalk(2)};
+  std::vector<std::vector<GCPadStatus>> sent(2);
+  std::vector<std::vector<GCPadStatus>> received(2);
+
+  for (int batch = 0; batch < 20; ++batch)
+  {
+    // Pads do not have to be polled in step
+    for (int frame = 0; frame < 15; ++frame)
+    {
+      for (NetPlay::PadIndex pad = 0; pad < 2; ++pad)
+      {
+        if (pad == 1 && frame % 4 == 0)
+          continue;
+        sent[pad].push_back(walks[pad].Next());
+        encoder.AddInput(pad, sent[pad].back());
+      }
+    }
+
+    ASSERT_TRUE(encoder.HasInputs());
+    const std::optional<std::vector<BroadcastInput>> inputs =
+        NetPlay::DecodeBroadcastBatch(encoder.TakeBatch());
+    EXPECT_FALSE(encoder.HasInputs());
+    ASSERT_TRUE(inputs);
+    for (const BroadcastInput& input : *inputs)
+    {
+      ASSERT_LT(input.pad, 2);
+      EXPECT_EQ(input.index, received[input.pad].size());
+      received[input.pad].push_back(input.status);
+    }
+  }
+
+  for (size_t pad = 0; pad < 2; ++pad)
+  {
+    ASSERT_EQ(sent[pad].size(), received[pad].size());
+    for (size_t i = 0; i < sent[pad].size(); ++i)
+      EXPECT_TRUE(sent[pad][i] == received[pad][i]) << "pad " << pad << " input " << i;
+  }
+}
+
+TEST(NetPlayBroadcast, DecodesBatchesOnTheirOwn)
+{
+  BroadcastEncoder encoder;
+  InputWalk walk(3);
+  std::vector<GCPadStatus> sent;
+  std::vector<std::vector<u8>> batches;
+  for (int batch = 0; batch < 3; ++batch)
+  {
+    for (int frame = 0; frame < 10; ++frame)
+    {
+      sent.push_back(walk.Next());
+      encoder.AddInput(3, sent.back());
+    }
+    batches.push_back(encoder.TakeBatch());
+  }
+
+  // Like a spectator that joined after the first batch
+  const std::optional<std::vector<BroadcastInput>> inputs =
+      NetPlay::DecodeBroadcastBatch(batches[2]);
+  ASSERT_TRUE(inputs);
+  ASSERT_EQ(inputs->size(), 10u);
+  for (size_t i = 0; i < inputs->size(); ++i)
+  {
+    EXPECT_EQ((*inputs)[i].pad, 3);
+    EXPECT_EQ((*inputs)[i].index, 20 + i);
+    EXPECT_TRUE((*inputs)[i].status == sent[20 + i]);
+  }
+
+  // Counting starts over
+  encoder.Reset();
+  encoder.AddInput(0, sent[0]);
+  const std::optional<std::vector<BroadcastInput>> restarted =
+      NetPlay::DecodeBroadcastBatch(encoder.TakeBatch());
+  ASSERT_TRUE(restarted);
+  ASSERT_EQ(restarted->size(), 1u);
+  EXPECT_EQ(restarted->front().index, 0u);
+}
+
+TEST(NetPlayBroadcast, CompressesIdleInputs)
+{
+  BroadcastEncoder encoder;
+  GCPadStatus status;
+  status.stickX = GCPadStatus::MAIN_STICK_CENTER_X;
+  status.stickY = GCPadStatus::MAIN_STICK_CENTER_Y;
+  status.substickX = GCPadStatus::C_STICK_CENTER_X;
+  status.substickY = GCPadStatus::C_STICK_CENTER_Y;
+  status.button = PAD_BUTTON_A;
+  status.isConnected = true;
+  for (int frame = 0; frame < 600; ++frame)
+  {
+    for (NetPlay::PadIndex pad = 0; pad < 4; ++pad)
+      encoder.AddInput(pad, status);
+  }
+
+  const std::vector<u8> batch = encoder.TakeBatch();
+  // Ten seconds of four pads that hold a button
+  EXPECT_LT(batch.size(), 40u);
+  const std::optional<std::vector<BroadcastInput>> inputs = NetPlay::DecodeBroadcastBatch(batch);
+  ASSERT_TRUE(inputs);
+  EXPECT_EQ(inputs->size(), 2400u);
+}
+
+TEST(NetPlayBroadcast, RejectsMalformedBatches)
+{
+  BroadcastEncoder encoder;
+  InputWalk walk(4);
+  for (int frame = 0; frame < 30; ++frame)
+    encoder.AddInput(1, walk.Next());
+  const std::vector<u8> batch = encoder.TakeBatch();
+
+  for (size_t size = 0; size < batch.size(); ++size)
+  {
+    const std::vector<u8> truncated(batch.begin(), batch.begin() + size);
+    EXPECT_FALSE(NetPlay::DecodeBroadcastBatch(truncated)) << "truncated to " << size;
+  }
+
+  std::vector<u8> trailing = batch;
+  trailing.push_back(0);
+  EXPECT_FALSE(NetPlay::DecodeBroadcastBatch(trailing));
+
+  std::vector<u8> bad_pad = batch;
+  bad_pad[1] = 4;
+  EXPECT_FALSE(NetPlay::DecodeBroadcastBatch(bad_pad));
+}
+
+TEST(NetPlayBroadcast, Size)
+{
+  BroadcastEncoder encoder;
+  std::vector<InputWalk> walks{InputWalk(5), InputWalk(6), InputWalk(7), InputWalk(8)};
+  constexpr int FRAMES = 3600;
+  constexpr int FRAMES_PER_BATCH = 15;
+  size_t size = 0;
+  for (int frame = 0; frame < FRAMES; ++frame)
+  {
+    for (NetPlay::PadIndex pad = 0; pad < 4; ++pad)
+      encoder.AddInput(pad, walks[pad].Next());
+    if ((frame + 1) % FRAMES_PER_BATCH == 0)
+      size += encoder.TakeBatch().size();
+  }
+
+  // A PadData message carries the index and the ten fields of each pad
+  const size_t raw_size = size_t(FRAMES) * 4 * 12;
+  fmt::print("A minute of four pads takes {} bytes in batches, {} bytes as PadData\n", size,
+             raw_size);
+  EXPECT_LT(size, raw_size / 2);
+}
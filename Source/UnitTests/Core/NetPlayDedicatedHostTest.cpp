@@ -0,0 +1,346 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+#include <enet/enet.h>
+#include <gtest/gtest.h>
+#include <picojson.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/ENet.h"
+#include "Common/SFMLHelper.h"
+#include "Common/Version.h"
+#include "Core/NetPlayDedicatedHost.h"
+#include "Core/NetPlayProto.h"
+#include "UICommon/NetPlayLocalIndex.h"
+
+using namespace NetPlay;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr std::chrono::seconds TIMEOUT{20};
+
+struct ReceivedPad
+{
+  PadIndex map;
+  u16 sequence;
+};
+
+// A player as the lobby sees one, without anything emulated behind it
+class FakeClient
+{
+public:
+  explicit FakeClient(u16 port)
+  {
+    m_host.reset(enet_host_create(nullptr, 1, CHANNEL_COUNT, 0, 0));
+    ENetAddress address;
+    enet_address_set_host(&address, "127.0.0.1");
+    address.port = port;
+    m_peer = enet_host_connect(m_host.get(), &address, CHANNEL_COUNT, 0);
+  }
+
+  void Service()
+  {
+    ENetEvent event;
+    while (enet_host_service(m_host.get(), &event, 0) > 0)
+    {
+      switch (event.type)
+      {
+      case ENET_EVENT_TYPE_CONNECT:
+      {
+        sf::Packet hello;
+        hello << Common::GetScmRevGitStr() << std::string("test") << std::string("Player")
+              << std::string();
+        Send(hello);
+        break;
+      }
+      case ENET_EVENT_TYPE_RECEIVE:
+      {
+        sf::Packet packet;
+        packet.append(event.packet->data, event.packet->dataLength);
+        enet_packet_destroy(event.packet);
+        OnData(packet);
+        break;
+      }
+      case ENET_EVENT_TYPE_DISCONNECT:
+        disconnected = true;
+        break;
+      default:
+        break;
+      }
+    }
+    enet_host_flush(m_host.get());
+  }
+
+  void Send(const sf::Packet& packet)
+  {
+    Common::ENet::SendPacket(m_peer, packet, DEFAULT_CHANNEL);
+  }
+
+  void SendStatus()
+  {
+    sf::Packet packet;
+    packet << MessageID::GameStatus << SyncIdentifierComparison::SameGame;
+    Send(packet);
+  }
+
+  void SendChat(const std::string& message)
+  {
+    sf::Packet packet;
+    packet << MessageID::ChatMessage << message;
+    Send(packet);
+  }
+
+  void SendPad(PadIndex map, u16 sequence)
+  {
+    sf::Packet packet;
+    packet << MessageID::PadData << map << sequence;
+    for (int i = 0; i < 8; ++i)
+      packet << u8(0x80);
+    packet << true;
+    Send(packet);
+  }
+
+  PadIndex GetPad() const
+  {
+    const auto it = std::find(pad_map.begin(), pad_map.end(), pid);
+    return it != pad_map.end() ? static_cast<PadIndex>(it - pad_map.begin()) : -1;
+  }
+
+  PlayerId pid = 0;
+  ConnectionError error = ConnectionError::NoError;
+  bool disconnected = false;
+  bool changed_game = false;
+  bool stopped = false;
+  u32 game = 0;
+  PadMappingArray pad_map{};
+  std::map<PlayerId, SyncIdentifierComparison> statuses;
+  std::vector<std::string> chat;
+  std::vector<ReceivedPad> pads;
+
+private:
+  void OnData(sf::Packet& packet)
+  {
+    MessageID mid;
+    packet >> mid;
+
+    if (pid == 0)
+    {
+      if (mid == MessageID::ConnectionSuccessful)
+        packet >> pid;
+      else
+        error = static_cast<ConnectionError>(mid);
+      return;
+    }
+
+    switch (mid)
+    {
+    case MessageID::Ping:
+    {
+      u32 key;
+      packet >> key;
+      sf::Packet pong;
+      pong << MessageID::Pong << key;
+      Send(pong);
+      break;
+    }
+    case MessageID::PadMapping:
+      for (PlayerId& mapping : pad_map)
+        packet >> mapping;
+      break;
+    case MessageID::GameStatus:
+    {
+      PlayerId player;
+      SyncIdentifierComparison status;
+      packet >> player >> status;
+      statuses[player] = status;
+      break;
+    }
+    case MessageID::ChangeGame:
+      changed_game = true;
+      break;
+    case MessageID::ChatMessage:
+    {
+      PlayerId player;
+      std::string message;
+      packet >> player >> message;
+      chat.push_back(message);
+      break;
+    }
+    case MessageID::StartGame:
+    {
+      packet >> game;
+      sf::Packet started;
+      started << MessageID::StartGame << game;
+      Send(started);
+      break;
+    }
+    case MessageID::StopGame:
+    case MessageID::DisableGame:
+      stopped = true;
+      break;
+    case MessageID::PadData:
+    {
+      while (!packet.endOfPacket())
+      {
+        PadIndex map;
+        u16 sequence;
+        u8 byte;
+        bool connected;
+        packet >> map >> sequence;
+        for (int i = 0; i < 8; ++i)
+          packet >> byte;
+        packet >> connected;
+        pads.push_back({map, sequence});
+      }
+      break;
+    }
+    default:
+      break;
+    }
+  }
+
+  Common::ENet::ENetHostPtr m_host;
+  ENetPeer* m_peer = nullptr;
+};
+
+DedicatedHost::Settings MakeSettings(u16 port, u32 sessions, u32 threads)
+{
+  DedicatedHost::Settings settings;
+  settings.first_port = port;
+  settings.sessions = sessions;
+  settings.threads = threads;
+  settings.max_players = 4;
+  settings.game.name = "Test Game";
+  settings.game.region = "USA";
+  return settings;
+}
+
+template <typename Predicate>
+bool RunUntil(const std::vector<FakeClient*>& clients, Predicate predicate)
+{
+  const auto deadline = Clock::now() + TIMEOUT;
+  while (!predicate())
+  {
+    if (Clock::now() > deadline)
+      return false;
+    for (FakeClient* client : clients)
+      client->Service();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+void RunFor(const std::vector<FakeClient*>& clients, std::chrono::milliseconds duration)
+{
+  const auto end = Clock::now() + duration;
+  RunUntil(clients, [&] { return Clock::now() > end; });
+}
+}  // namespace
+
+TEST(NetPlayDedicatedHost, RunsALobby)
+{
+  // On a free port, so that the test can run next to anything else
+  DedicatedHost host(MakeSettings(0, 1, 1));
+  ASSERT_TRUE(host.IsValid());
+  const u16 port = host.GetSessions()[0].port;
+  ASSERT_NE(port, 0);
+
+  FakeClient a(port);
+  ASSERT_TRUE(RunUntil({&a}, [&] { return a.pid != 0; }));
+  FakeClient b(port);
+  const std::vector<FakeClient*> clients{&a, &b};
+  ASSERT_TRUE(RunUntil(clients, [&] {
+    return b.pid != 0 && a.GetPad() != -1 && a.pad_map == b.pad_map && b.GetPad() != -1;
+  }));
+
+  // Clients take player 1 for the host
+  EXPECT_EQ(a.pid, 2);
+  EXPECT_EQ(b.pid, 3);
+  EXPECT_TRUE(a.changed_game);
+  EXPECT_TRUE(b.changed_game);
+
+  const std::vector<NetPlaySession> sessions = host.GetSessions();
+  ASSERT_EQ(sessions.size(), 1u);
+  EXPECT_EQ(sessions[0].port, port);
+  EXPECT_EQ(sessions[0].player_count, 2);
+  EXPECT_EQ(sessions[0].game_id, "Test Game");
+
+  // Not before everyone has the game
+  b.SendStatus();
+  a.SendChat("/start");
+  RunFor(clients, std::chrono::milliseconds(200));
+  EXPECT_EQ(a.game, 0u);
+
+  // Nor by anyone but the first player
+  a.SendStatus();
+  ASSERT_TRUE(RunUntil(clients, [&] { return a.statuses.size() == 2; }));
+  b.SendChat("/start");
+  ASSERT_TRUE(RunUntil(clients, [&] { return !a.chat.empty(); }));
+  EXPECT_EQ(a.chat[0], "/start");
+  EXPECT_EQ(a.game, 0u);
+
+  a.SendChat("/start");
+  ASSERT_TRUE(RunUntil(clients, [&] { return a.game != 0 && b.game != 0; }));
+  EXPECT_EQ(a.game, b.game);
+  EXPECT_TRUE(host.GetSessions()[0].in_game);
+
+  a.SendPad(a.GetPad(), 7);
+  ASSERT_TRUE(RunUntil(clients, [&] { return !b.pads.empty(); }));
+  EXPECT_EQ(b.pads[0].map, a.GetPad());
+  EXPECT_EQ(b.pads[0].sequence, 7);
+  EXPECT_TRUE(a.pads.empty());
+  EXPECT_EQ(host.GetStats().inputs_relayed, 1u);
+
+  // Inputs for the pad of somebody else get the sender thrown out, which ends the game
+  b.SendPad(a.GetPad(), 8);
+  ASSERT_TRUE(RunUntil(clients, [&] { return b.disconnected && a.stopped; }));
+  EXPECT_TRUE(a.pads.empty());
+  EXPECT_EQ(host.GetSessions()[0].player_count, 1);
+}
+
+TEST(NetPlayDedicatedHost, RefusesMoreLobbiesThanSocketSetsHold)
+{
+  EXPECT_FALSE(DedicatedHost(MakeSettings(0, DedicatedHost::MAX_SESSIONS + 1, 1)).IsValid());
+
+  // A single thread is not enough for them
+  DedicatedHost host(MakeSettings(0, DedicatedHost::MAX_SESSIONS_PER_WORKER + 1, 1));
+  ASSERT_TRUE(host.IsValid());
+  EXPECT_EQ(host.GetSessions().size(), DedicatedHost::MAX_SESSIONS_PER_WORKER + 1);
+}
+
+TEST(NetPlayDedicatedHost, ListsLobbiesLikeTheIndex)
+{
+  std::vector<NetPlaySession> sessions(2);
+  sessions[0].name = "Dedicated 1";
+  sessions[0].region = "EU";
+  sessions[0].port = 2626;
+  sessions[1].name = "Dedicated 2";
+  sessions[1].region = "NA";
+  sessions[1].in_game = true;
+
+  const auto list = [&](std::string_view query) {
+    picojson::value json;
+    const std::string error =
+        picojson::parse(json, NetPlayLocalIndex::MakeListResponse(sessions, query));
+    EXPECT_TRUE(error.empty());
+    EXPECT_EQ(json.get("status").to_str(), "OK");
+    return json.get("sessions").get<picojson::array>();
+  };
+
+  EXPECT_EQ(list("").size(), 2u);
+  EXPECT_EQ(list("region=EU").size(), 1u);
+  EXPECT_EQ(list("in_game=0")[0].get("name").to_str(), "Dedicated 1");
+  EXPECT_EQ(list("name=Dedicated%202").size(), 1u);
+  EXPECT_EQ(list("name=Dedicated%202&region=EU").size(), 0u);
+  EXPECT_EQ(list("")[0].get("port").get<double>(), 2626.0);
+}
@@ -0,0 +1,163 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayDesync.h"
+
+using NetPlay::DesyncDetector;
+
+namespace
+{
+std::vector<u8> MakeState(const DesyncDetector& detector, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<u8> state(detector.GetStateSize());
+  for (u8& byte : state)
+    byte = static_cast<u8>(rng());
+  return state;
+}
+
+// Runs the exchange of two clients until both are left with the blocks that differ
+std::vector<u32> FindDifferingBlocks(const DesyncDetector& a, const DesyncDetector& b, u64 frame)
+{
+  const u32 root = 0;
+  std::vector<u32> parents{root};
+  for (u32 level = 1; level <= a.GetDepth(); ++level)
+  {
+    const std::vector<u32> from_a = b.Compare(frame, level, a.GetChildren(frame, level, parents));
+    const std::vector<u32> from_b = a.Compare(frame, level, b.GetChildren(frame, level, parents));
+    EXPECT_EQ(from_a, from_b);
+    parents = from_a;
+  }
+  return parents;
+}
+}  // namespace
+
+TEST(NetPlayDesync, ParsesRegions)
+{
+  const std::vector<NetPlay::DesyncRegion> regions =
+      NetPlay::ParseDesyncRegions(" 802E0000-80400000, 80000000-7FFFFFFF,90000000-90001000,"
+                                  "80870000-808a0000,,garbage");
+  ASSERT_EQ(regions.size(), 2u);
+  EXPECT_EQ(regions[0].address, 0x802E0000u);
+  EXPECT_EQ(regions[0].size, 0x120000u);
+  EXPECT_EQ(regions[1].address, 0x80870000u);
+  EXPECT_EQ(regions[1].size, 0x30000u);
+}
+
+TEST(NetPlayDesync, LocatesDifferingBlocks)
+{
+  const std::vector<NetPlay::DesyncRegion> regions{{0x80100000, 0x42000}, {0x80800000, 0x1800}};
+  DesyncDetector a(regions);
+  DesyncDetector b(regions);
+  // 66 + 2 blocks and the registers, so three levels below the root
+  EXPECT_EQ(a.GetDepth(), 2u);
+  EXPECT_EQ(a.GetLevelSize(0), 1u);
+  EXPECT_EQ(a.GetLevelSize(2), 69u);
+  EXPECT_EQ(a.GetLevelSize(3), 0u);
+
+  std::vector<u8> state = MakeState(a, 1);
+  a.AddState(60, state);
+  b.AddState(60, state);
+
+  // A block in the second region, and the registers at the end
+  state[0x42000 + 0x1000 + 5] ^= 1;
+  state.back() ^= 1;
+  a.AddState(120, state);
+  b.AddState(120, MakeState(a, 1));
+
+  // The states are read until the frame before the next one starts
+  for (const auto& [frame, root] : a.Finalize(179))
+    b.AddRemoteRoot(1, frame, root);
+  EXPECT_FALSE(b.TakeMismatch());
+  b.Finalize(179);
+  const std::optional<DesyncDetector::Mismatch> mismatch = b.TakeMismatch();
+  ASSERT_TRUE(mismatch);
+  EXPECT_EQ(mismatch->pid, 1);
+  EXPECT_EQ(mismatch->frame, 120u);
+  // Only the first one is reported
+  EXPECT_FALSE(b.TakeMismatch());
+
+  const std::vector<u32> blocks = FindDifferingBlocks(a, b, 120);
+  ASSERT_EQ(blocks.size(), 2u);
+  EXPECT_EQ(a.GetBlock(blocks[0]).address, 0x80801000u);
+  EXPECT_EQ(a.GetBlock(blocks[0]).size, 0x800u);
+  EXPECT_TRUE(a.GetBlock(blocks[1]).registers);
+  EXPECT_NE(a.GetBlockData(120, blocks[0]), b.GetBlockData(120, blocks[0]));
+  EXPECT_TRUE(FindDifferingBlocks(a, b, 60).empty());
+}
+
+TEST(NetPlayDesync, ComparesOnlyFinalStates)
+{
+  const std::vector<NetPlay::DesyncRegion> regions{{0x80000000, 0x10000}};
+  DesyncDetector a(regions);
+  DesyncDetector b(regions);
+
+  // b predicted wrong and hashes the frame again after a rollback, before it is final
+  a.AddState(60, MakeState(a, 1));
+  b.AddState(60, MakeState(b, 2));
+  b.AddState(30, MakeState(b, 3));
+  b.AddState(60, MakeState(b, 1));
+
+  for (const auto& [frame, root] : a.Finalize(119))
+    b.AddRemoteRoot(1, frame, root);
+  const std::vector<std::pair<u64, u64>> roots = b.Finalize(119);
+  ASSERT_EQ(roots.size(), 2u);
+  EXPECT_FALSE(b.TakeMismatch());
+
+  // Sent once
+  EXPECT_TRUE(b.Finalize(119).empty());
+}
+
+TEST(NetPlayDesync, ReadsAStateOverManyFrames)
+{
+  const std::vector<NetPlay::DesyncRegion> regions{{0x80000000, 0x80000}};
+  DesyncDetector a(regions);
+  DesyncDetector b(regions);
+  const std::vector<u8> state = MakeState(a, 1);
+  a.AddState(60, state);
+
+  // b predicted wrong from frame 90 on, and reads those slices again after a rollback
+  const std::vector<u8> wrong = MakeState(b, 2);
+  for (u64 frame = 60; frame < 120; ++frame)
+    b.AddSlice(frame, frame < 90 ? state : wrong);
+  for (u64 frame = 90; frame < 120; ++frame)
+    b.AddSlice(frame, state);
+
+  // Not sent before its last frame is final
+  EXPECT_TRUE(b.Finalize(118).empty());
+  for (const auto& [frame, root] : a.Finalize(119))
+    b.AddRemoteRoot(1, frame, root);
+  EXPECT_EQ(b.Finalize(119).size(), 1u);
+  EXPECT_FALSE(b.TakeMismatch());
+  EXPECT_EQ(b.GetStateData(60), state);
+
+  // Netplay started in the middle of this one
+  for (u64 frame = 150; frame < 180; ++frame)
+    b.AddSlice(frame, state);
+  EXPECT_TRUE(b.Finalize(179).empty());
+}
+
+TEST(NetPlayDesync, Benchmark)
+{
+  // The default regions
+  DesyncDetector detector(NetPlay::ParseDesyncRegions(
+      "802E0000-80400000,804E0000-80500000,80870000-808A0000"));
+  const std::vector<u8> state = MakeState(detector, 1);
+
+  constexpr int COUNT = 100;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < COUNT; ++i)
+    detector.AddState(i * 60, state);
+  const double us =
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+  fmt::print("Hashing {} bytes took {:.1f}us, {:.1f}us per frame\n", detector.GetStateSize(),
+             us / COUNT, us / COUNT / DesyncDetector::STATE_FRAMES);
+}
@@ -0,0 +1,383 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/SFMLHelper.h"
+#include "Core/NetPlayInputTransport.h"
+#include "Core/NetPlayProto.h"
+#include "InputCommon/GCPadStatus.h"
+
+using NetPlay::BroadcastInput;
+using NetPlay::InputLink;
+
+namespace
+{
+constexpr u32 GAME = 1234;
+constexpr double FRAME_MS = 1000.0 / 60.0;
+
+GCPadStatus MakeInput(u32 frame)
+{
+  GCPadStatus status;
+  status.button = static_cast<u16>(frame / 7);
+  status.stickX = static_cast<u8>(frame);
+  return status;
+}
+
+// Like the link on the receiving side, after the id of the message
+bool Receive(InputLink& link, sf::Packet packet, std::vector<BroadcastInput>& inputs)
+{
+  NetPlay::MessageID mid;
+  packet >> mid;
+  EXPECT_EQ(mid, NetPlay::MessageID::PadInputs);
+  return link.OnPacket(packet, inputs);
+}
+
+struct NetworkConditions
+{
+  double latency_ms;
+  double jitter_ms;
+  double loss;
+};
+
+struct PacingResult
+{
+  // Frames the receiver had to wait for an input
+  u32 stalls = 0;
+  double max_frame_ms = 0.0;
+  // Standard deviation of the time between frames
+  double frame_deviation_ms = 0.0;
+  // How far the last frame is behind an ideal run
+  double total_delay_ms = 0.0;
+};
+
+class SimulatedNetwork
+{
+public:
+  SimulatedNetwork(const NetworkConditions& conditions, u32 seed)
+      : m_conditions(conditions), m_rng(seed)
+  {
+  }
+
+  // When the packet arrives, or nothing if it is lost
+  std::optional<double> Transmit(double now)
+  {
+    if (std::uniform_real_distribution<double>(0.0, 1.0)(m_rng) < m_conditions.loss)
+      return std::nullopt;
+    const double jitter =
+        std::abs(std::normal_distribution<double>(0.0, m_conditions.jitter_ms)(m_rng));
+    return now + m_conditions.latency_ms + jitter;
+  }
+
+private:
+  NetworkConditions m_conditions;
+  std::mt19937 m_rng;
+};
+
+// The receiver plays frame f once its input has arrived, buffer frames after it was sent
+PacingResult MeasurePacing(const std::vector<double>& arrivals, u32 buffer)
+{
+  PacingResult result;
+  std::vector<double> intervals;
+  double previous = buffer * FRAME_MS;
+  for (size_t frame = 1; frame < arrivals.size(); ++frame)
+  {
+    const double due = previous + FRAME_MS;
+    const double played = std::max(due, arrivals[frame]);
+    if (played > due)
+      ++result.stalls;
+    intervals.push_back(played - previous);
+    previous = played;
+  }
+
+  double sum = 0.0;
+  for (const double interval : intervals)
+  {
+    sum += interval;
+    result.max_frame_ms = std::max(result.max_frame_ms, interval);
+  }
+  const double mean = sum / intervals.size();
+  double variance = 0.0;
+  for (const double interval : intervals)
+    variance += (interval - mean) * (interval - mean);
+  result.frame_deviation_ms = std::sqrt(variance / intervals.size());
+  result.total_delay_ms = std::max(0.0, previous - (buffer + arrivals.size() - 1) * FRAME_MS);
+  return result;
+}
+
+// A reliable and ordered channel like the default one of ENet, which sends a packet per frame
+// and resends lost ones after a timeout
+std::vector<double> SimulateReliable(const NetworkConditions& conditions, u32 frames, u32 seed)
+{
+  SimulatedNetwork network(conditions, seed);
+  // ENet resends after the round trip time and four times its deviation
+  const double timeout = 2 * conditions.latency_ms + 4 * conditions.jitter_ms;
+  std::vector<double> arrivals(frames);
+  double delivered = 0.0;
+  for (u32 frame = 0; frame < frames; ++frame)
+  {
+    double sent = frame * FRAME_MS;
+    std::optional<double> arrival = network.Transmit(sent);
+    while (!arrival)
+    {
+      sent += timeout;
+      arrival = network.Transmit(sent);
+    }
+    // Held back until the packets before it were delivered
+    delivered = std::max(delivered, *arrival);
+    arrivals[frame] = delivered;
+  }
+  return arrivals;
+}
+
+// Two links that send a packet per frame, and acknowledgements back over the same network
+std::vector<double> SimulateRedundant(const NetworkConditions& conditions, u32 frames, u32 seed)
+{
+  SimulatedNetwork network(conditions, seed);
+  InputLink sender(GAME);
+  InputLink receiver(GAME);
+  // Packets in flight by arrival time, to the receiver or back to the sender
+  std::multimap<double, std::pair<bool, sf::Packet>> in_flight;
+  std::vector<double> arrivals(frames, -1.0);
+  u32 received = 0;
+
+  auto deliver_until = [&](double now) {
+    while (!in_flight.empty() && in_flight.begin()->first <= now)
+    {
+      auto node = in_flight.extract(in_flight.begin());
+      const double time = node.key();
+      auto& [to_receiver, packet] = node.mapped();
+      std::vector<BroadcastInput> inputs;
+      if (to_receiver)
+      {
+        EXPECT_TRUE(Receive(receiver, packet, inputs));
+        for (const BroadcastInput& input : inputs)
+        {
+          EXPECT_EQ(input.index, received);
+          arrivals[received++] = time;
+        }
+        if (receiver.IsAckNeeded())
+        {
+          if (const std::optional<double> arrival = network.Transmit(time))
+            in_flight.emplace(*arrival, std::make_pair(false, receiver.MakePacket()));
+          else
+            receiver.MakePacket();
+        }
+      }
+      else
+      {
+        EXPECT_TRUE(Receive(sender, packet, inputs));
+      }
+    }
+  };
+
+  double now = 0.0;
+  for (u32 frame = 0; frame < frames; ++frame)
+  {
+    now = frame * FRAME_MS;
+    deliver_until(now);
+    sender.AddInput(0, MakeInput(frame));
+    if (const std::optional<double> arrival = network.Transmit(now))
+      in_flight.emplace(*arrival, std::make_pair(true, sender.MakePacket()));
+    else
+      sender.MakePacket();
+  }
+  // The last inputs are resent until they are acknowledged
+  while (received < frames)
+  {
+    now += InputLink::RESEND_INTERVAL.count();
+    deliver_until(now);
+    if (sender.HasUnacked())
+    {
+      if (const std::optional<double> arrival = network.Transmit(now))
+        in_flight.emplace(*arrival, std::make_pair(true, sender.MakePacket()));
+    }
+  }
+  return arrivals;
+}
+}  // namespace
+
+TEST(NetPlayInputTransport, DeliversInOrderDespiteLoss)
+{
+  InputLink a(GAME);
+  InputLink b(GAME);
+  std::mt19937 rng(1);
+  std::vector<sf::Packet> delayed;
+  u32 received = 0;
+
+  for (u32 frame = 0; frame < 600; ++frame)
+  {
+    a.AddInput(2, MakeInput(frame));
+    sf::Packet packet = a.MakePacket();
+
+    // A third is lost, and a third arrives after the next one
+    const u32 fate = rng() % 3;
+    if (fate == 1)
+    {
+      delayed.push_back(std::move(packet));
+      continue;
+    }
+
+    std::vector<sf::Packet> arriving;
+    if (fate == 2)
+      arriving.push_back(std::move(packet));
+    arriving.insert(arriving.end(), delayed.begin(), delayed.end());
+    delayed.clear();
+
+    for (const sf::Packet& arrived : arriving)
+    {
+      std::vector<BroadcastInput> inputs;
+      ASSERT_TRUE(Receive(b, arrived, inputs));
+      for (const BroadcastInput& input : inputs)
+      {
+        EXPECT_EQ(input.pad, 2);
+        EXPECT_EQ(input.index, received);
+        EXPECT_EQ(input.status.stickX, MakeInput(received).stickX);
+        EXPECT_EQ(input.status.button, MakeInput(received).button);
+        ++received;
+      }
+    }
+
+    // Every other acknowledgement is lost
+    if (b.IsAckNeeded())
+    {
+      sf::Packet ack = b.MakePacket();
+      std::vector<BroadcastInput> inputs;
+      if (frame % 2 == 0)
+        ASSERT_TRUE(Receive(a, ack, inputs));
+      EXPECT_TRUE(inputs.empty());
+    }
+  }
+
+  EXPECT_GT(received, 500u);
+  const InputLink::Stats stats = b.GetStats();
+  EXPECT_EQ(stats.inputs_received, received);
+  EXPECT_GT(stats.duplicate_inputs, 0u);
+}
+
+TEST(NetPlayInputTransport, StopsSendingAcknowledgedInputs)
+{
+  InputLink a(GAME);
+  InputLink b(GAME);
+  for (u32 frame = 0; frame < 10; ++frame)
+    a.AddInput(0, MakeInput(frame));
+
+  std::vector<BroadcastInput> inputs;
+  ASSERT_TRUE(Receive(b, a.MakePacket(), inputs));
+  EXPECT_EQ(inputs.size(), 10u);
+  EXPECT_TRUE(a.HasUnacked());
+
+  // Acknowledgements are not acknowledged themselves
+  ASSERT_TRUE(b.IsAckNeeded());
+  ASSERT_TRUE(Receive(a, b.MakePacket(), inputs));
+  EXPECT_FALSE(a.IsAckNeeded());
+  EXPECT_FALSE(a.HasUnacked());
+
+  // Only the new input
+  a.AddInput(0, MakeInput(10));
+  inputs.clear();
+  ASSERT_TRUE(Receive(b, a.MakePacket(), inputs));
+  ASSERT_EQ(inputs.size(), 1u);
+  EXPECT_EQ(inputs[0].index, 10u);
+  EXPECT_EQ(b.GetStats().duplicate_inputs, 0u);
+}
+
+TEST(NetPlayInputTransport, AcknowledgesInputsAfterAGap)
+{
+  InputLink a(GAME);
+  InputLink b(GAME);
+
+  // After a loss of more inputs than fit in a packet
+  constexpr u32 COUNT = InputLink::MAX_INPUTS_PER_PACKET + 6;
+  for (u32 frame = 0; frame < COUNT; ++frame)
+    a.AddInput(1, MakeInput(frame));
+
+  std::vector<BroadcastInput> inputs;
+  ASSERT_TRUE(Receive(b, a.MakePacket(), inputs));
+  ASSERT_EQ(inputs.size(), InputLink::MAX_INPUTS_PER_PACKET - 1);
+  EXPECT_EQ(b.GetStats().inputs_received, inputs.size());
+
+  // The newest input is acknowledged and not sent again
+  ASSERT_TRUE(b.IsAckNeeded());
+  ASSERT_TRUE(Receive(a, b.MakePacket(), inputs));
+  inputs.clear();
+  ASSERT_TRUE(Receive(b, a.MakePacket(), inputs));
+  ASSERT_EQ(inputs.size(), 7u);
+  for (u32 i = 0; i < inputs.size(); ++i)
+    EXPECT_EQ(inputs[i].index, InputLink::MAX_INPUTS_PER_PACKET - 1 + i);
+  EXPECT_EQ(b.GetStats().early_inputs, 1u);
+  EXPECT_EQ(b.GetStats().duplicate_inputs, 0u);
+
+  ASSERT_TRUE(Receive(a, b.MakePacket(), inputs));
+  EXPECT_FALSE(a.HasUnacked());
+}
+
+TEST(NetPlayInputTransport, IgnoresOtherGames)
+{
+  InputLink a(GAME);
+  InputLink b(GAME + 1);
+  a.AddInput(0, MakeInput(0));
+
+  std::vector<BroadcastInput> inputs;
+  ASSERT_TRUE(Receive(b, a.MakePacket(), inputs));
+  EXPECT_TRUE(inputs.empty());
+  EXPECT_FALSE(b.IsAckNeeded());
+  EXPECT_EQ(b.GetStats().packets_received, 0u);
+}
+
+TEST(NetPlayInputTransport, RejectsMalformedPackets)
+{
+  InputLink a(GAME);
+  InputLink b(GAME);
+  for (u32 frame = 0; frame < 20; ++frame)
+    a.AddInput(3, MakeInput(frame));
+  const sf::Packet packet = a.MakePacket();
+  const u8* data = static_cast<const u8*>(packet.getData());
+
+  for (size_t size = 1; size < packet.getDataSize(); ++size)
+  {
+    sf::Packet truncated;
+    truncated.append(data, size);
+    std::vector<BroadcastInput> inputs;
+    EXPECT_FALSE(Receive(b, truncated, inputs)) << "truncated to " << size;
+  }
+}
+
+// A lost packet of a reliable channel holds back every input after it until it is resent, while
+// the redundant one covers it with the next packet
+TEST(NetPlayInputTransport, LossSimulation)
+{
+  constexpr u32 FRAMES = 3600;
+  constexpr u32 BUFFER = 4;
+  const NetworkConditions conditions[] = {
+      {30.0, 2.0, 0.0}, {30.0, 5.0, 0.01}, {30.0, 5.0, 0.05}, {30.0, 10.0, 0.10}};
+
+  for (const NetworkConditions& condition : conditions)
+  {
+    const PacingResult reliable =
+        MeasurePacing(SimulateReliable(condition, FRAMES, 1), BUFFER);
+    const PacingResult redundant =
+        MeasurePacing(SimulateRedundant(condition, FRAMES, 1), BUFFER);
+
+    fmt::print("{:.0f}ms +-{:.0f}ms, {:.0f}% loss: reliable {} stalls, longest frame {:.1f}ms, "
+               "deviation {:.1f}ms, {:.0f}ms behind; redundant {} stalls, longest frame "
+               "{:.1f}ms, deviation {:.1f}ms, {:.0f}ms behind\n",
+               condition.latency_ms, condition.jitter_ms, condition.loss * 100, reliable.stalls,
+               reliable.max_frame_ms, reliable.frame_deviation_ms, reliable.total_delay_ms,
+               redundant.stalls, redundant.max_frame_ms, redundant.frame_deviation_ms,
+               redundant.total_delay_ms);
+
+    EXPECT_LE(redundant.stalls, reliable.stalls);
+    if (condition.loss != 0.0)
+      EXPECT_LT(redundant.total_delay_ms, reliable.total_delay_ms);
+  }
+}
@@ -0,0 +1,262 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayPadBuffer.h"
+#include "Core/NetPlayProto.h"
+
+using NetPlay::PadBufferController;
+using NetPlay::PlayerId;
+
+namespace
+{
+constexpr u32 FRAMES_PER_SECOND = 60;
+const PadBufferController::Clock::time_point START{};
+
+PadBufferController::Clock::time_point At(u32 seconds)
+{
+  return START + std::chrono::seconds(seconds);
+}
+
+// Round trips of a player to the host, one per frame, shaped like recorded ones: a base time with
+// jitter, short spikes now and then, and a period of congestion in which the base time rises
+struct TraceProfile
+{
+  double base_ms;
+  double jitter_ms;
+  // Chance of a frame starting a spike, and how much it adds
+  double spike_chance;
+  double spike_ms;
+  // Seconds of the trace the base time is raised, and by how much
+  u32 congestion_start;
+  u32 congestion_end;
+  double congestion_ms;
+};
+
+std::vector<u32> MakeTrace(const TraceProfile& profile, u32 seconds, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> jitter(0.0, profile.jitter_ms);
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+  std::vector<u32> trace;
+  u32 spike_frames = 0;
+  for (u32 frame = 0; frame < seconds * FRAMES_PER_SECOND; ++frame)
+  {
+    const u32 second = frame / FRAMES_PER_SECOND;
+    double rtt = profile.base_ms + std::abs(jitter(rng));
+    if (second >= profile.congestion_start && second < profile.congestion_end)
+      rtt += profile.congestion_ms;
+    if (spike_frames == 0 && chance(rng) < profile.spike_chance)
+      spike_frames = 6;
+    if (spike_frames != 0)
+    {
+      rtt += profile.spike_ms;
+      --spike_frames;
+    }
+    trace.push_back(static_cast<u32>(rtt));
+  }
+  return trace;
+}
+
+struct RunResult
+{
+  u32 late_frames = 0;
+  double average_buffer = 0;
+};
+
+// Inputs of a frame are late when the path between the two players takes longer than the frames
+// the buffer leaves for it
+bool IsLate(u32 buffer, const std::vector<u32>& a, const std::vector<u32>& b, size_t frame)
+{
+  const double path_ms = (a[frame] + b[frame]) / 2.0;
+  const double budget_ms =
+      (buffer - PadBufferController::MARGIN_FRAMES) * PadBufferController::FRAME_TIME_MS;
+  return path_ms > budget_ms;
+}
+
+// The adaptive run starts once both players were pinged a few times, and so does this one
+constexpr size_t FIRST_FRAME = PadBufferController::MIN_SAMPLES * FRAMES_PER_SECOND;
+
+RunResult RunFixed(u32 buffer, const std::vector<u32>& a, const std::vector<u32>& b)
+{
+  RunResult result{0, static_cast<double>(buffer)};
+  for (size_t frame = FIRST_FRAME; frame < a.size(); ++frame)
+    result.late_frames += IsLate(buffer, a, b, frame);
+  return result;
+}
+
+// Like the server, which pings every second and starts the game once everyone was pinged a few
+// times
+RunResult RunAdaptive(const std::vector<u32>& a, const std::vector<u32>& b)
+{
+  constexpr std::array<PlayerId, 2> players{1, 2};
+  PadBufferController controller;
+
+  for (size_t frame = 0; frame < FIRST_FRAME; frame += FRAMES_PER_SECOND)
+  {
+    controller.AddSample(1, a[frame]);
+    controller.AddSample(2, b[frame]);
+  }
+  u32 buffer = controller.GetNeeded(players)->buffer;
+
+  RunResult result;
+  double buffer_sum = 0;
+  u32 frames = 0;
+  for (size_t frame = FIRST_FRAME; frame < a.size(); ++frame)
+  {
+    if (frame % FRAMES_PER_SECOND == 0)
+    {
+      controller.AddSample(1, a[frame]);
+      controller.AddSample(2, b[frame]);
+      const auto decision = controller.Update(
+          buffer, players, At(static_cast<u32>(frame / FRAMES_PER_SECOND)));
+      if (decision)
+        buffer = decision->buffer;
+    }
+    result.late_frames += IsLate(buffer, a, b, frame);
+    buffer_sum += buffer;
+    ++frames;
+  }
+  result.average_buffer = buffer_sum / frames;
+  return result;
+}
+}  // namespace
+
+TEST(NetPlayPadBuffer, PercentileOfRecentSamples)
+{
+  PadBufferController controller;
+  EXPECT_FALSE(controller.GetPercentile(1, 0.5));
+
+  for (u32 rtt = 1; rtt <= PadBufferController::WINDOW_SAMPLES; ++rtt)
+    controller.AddSample(1, rtt * 10);
+  EXPECT_EQ(*controller.GetPercentile(1, 0.5), 152u);
+  EXPECT_EQ(*controller.GetPercentile(1, 1.0), 302u);
+
+  // The first samples fall out of the window
+  for (u32 i = 0; i < PadBufferController::WINDOW_SAMPLES / 2; ++i)
+    controller.AddSample(1, 20);
+  EXPECT_EQ(*controller.GetPercentile(1, 0.5), 22u);
+
+  // Longer than the histogram goes
+  for (u32 i = 0; i < PadBufferController::WINDOW_SAMPLES; ++i)
+    controller.AddSample(1, 5000);
+  EXPECT_EQ(*controller.GetPercentile(1, 0.5),
+            PadBufferController::NUM_BUCKETS * PadBufferController::BUCKET_MS);
+
+  controller.RemovePlayer(1);
+  EXPECT_FALSE(controller.GetPercentile(1, 0.5));
+}
+
+TEST(NetPlayPadBuffer, CoversTheLongestPath)
+{
+  PadBufferController controller;
+  for (u32 i = 0; i < PadBufferController::MIN_SAMPLES; ++i)
+  {
+    controller.AddSample(1, 1);
+    controller.AddSample(2, 59);
+    controller.AddSample(3, 99);
+  }
+
+  const std::array<PlayerId, 3> players{1, 2, 3};
+  const auto needed = controller.GetNeeded(players);
+  ASSERT_TRUE(needed);
+  EXPECT_EQ(needed->first, 3);
+  EXPECT_EQ(needed->second, 2);
+  EXPECT_EQ(needed->path_ms, 80u);
+  // 80 ms are a bit less than five frames
+  EXPECT_EQ(needed->buffer, 5 + PadBufferController::MARGIN_FRAMES);
+
+  // A single player waits for nobody
+  const std::array<PlayerId, 1> alone{3};
+  EXPECT_EQ(controller.GetNeeded(alone)->buffer, PadBufferController::MIN_BUFFER);
+
+  // Not every player was pinged yet
+  const std::array<PlayerId, 2> joined{1, 4};
+  EXPECT_FALSE(controller.GetNeeded(joined));
+}
+
+TEST(NetPlayPadBuffer, RaisesAtOnceAndLowersSlowly)
+{
+  PadBufferController controller;
+  const std::array<PlayerId, 2> players{1, 2};
+  for (u32 i = 0; i < PadBufferController::WINDOW_SAMPLES; ++i)
+  {
+    controller.AddSample(1, 1);
+    controller.AddSample(2, 300);
+  }
+
+  u32 buffer = 2;
+  auto decision = controller.Update(buffer, players, At(0));
+  ASSERT_TRUE(decision);
+  EXPECT_EQ(decision->buffer, buffer + PadBufferController::MAX_RAISE);
+  buffer = decision->buffer;
+  while ((decision = controller.Update(buffer, players, At(0))))
+    buffer = decision->buffer;
+  EXPECT_EQ(buffer, controller.GetNeeded(players)->buffer);
+
+  for (u32 i = 0; i < PadBufferController::WINDOW_SAMPLES; ++i)
+    controller.AddSample(2, 1);
+  const u32 seconds = static_cast<u32>(PadBufferController::LOWER_DELAY.count());
+  EXPECT_FALSE(controller.Update(buffer, players, At(1)));
+  EXPECT_FALSE(controller.Update(buffer, players, At(seconds)));
+  decision = controller.Update(buffer, players, At(1 + seconds));
+  ASSERT_TRUE(decision);
+  EXPECT_EQ(decision->buffer, buffer - 1);
+  EXPECT_FALSE(controller.Update(buffer - 1, players, At(2 + seconds)));
+}
+
+TEST(NetPlayPadBuffer, LowerLatencyThanAFixedBufferAtEqualStalls)
+{
+  constexpr u32 SECONDS = 600;
+  constexpr TraceProfile WIRED{25.0, 3.0, 0.0005, 20.0, 0, 0, 0.0};
+  constexpr TraceProfile WIFI{45.0, 8.0, 0.001, 60.0, 0, 0, 0.0};
+  constexpr TraceProfile CONGESTED{45.0, 8.0, 0.001, 60.0, 200, 320, 90.0};
+
+  struct Match
+  {
+    const char* name;
+    TraceProfile a;
+    TraceProfile b;
+    // A fixed buffer can be as good on a connection that does not change
+    bool changes;
+  };
+  constexpr std::array<Match, 3> matches{{
+      {"wired and wifi", WIRED, WIFI, false},
+      {"wifi and wifi", WIFI, WIFI, false},
+      {"wired and congested wifi", WIRED, CONGESTED, true},
+  }};
+
+  for (size_t i = 0; i < matches.size(); ++i)
+  {
+    const Match& match = matches[i];
+    const std::vector<u32> a = MakeTrace(match.a, SECONDS, static_cast<u32>(2 * i + 1));
+    const std::vector<u32> b = MakeTrace(match.b, SECONDS, static_cast<u32>(2 * i + 2));
+
+    const RunResult adaptive = RunAdaptive(a, b);
+    // The smallest fixed buffer that stalls no more often
+    u32 fixed = PadBufferController::MIN_BUFFER;
+    while (RunFixed(fixed, a, b).late_frames > adaptive.late_frames)
+      ++fixed;
+    const RunResult fixed_result = RunFixed(fixed, a, b);
+
+    fmt::print("{}: adaptive {:.2f} frames, {} late; fixed {} frames, {} late\n", match.name,
+               adaptive.average_buffer, adaptive.late_frames, fixed, fixed_result.late_frames);
+    if (match.changes)
+      EXPECT_LT(adaptive.average_buffer + 1.0, fixed_result.average_buffer) << match.name;
+    else
+      EXPECT_LE(adaptive.average_buffer, fixed_result.average_buffer) << match.name;
+    // A stall every few seconds would be worse than any latency it saves
+    EXPECT_LT(adaptive.late_frames, a.size() / 50) << match.name;
+  }
+}
@@ -0,0 +1,218 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayRollback.h"
+#include "InputCommon/GCPadStatus.h"
+
+namespace
+{
+constexpr int LOCAL_PAD = 0;
+constexpr int REMOTE_PAD = 1;
+constexpr u64 FRAMES = 2000;
+
+// Buttons change every few reads, so that most predictions are right but not all
+GCPadStatus MakeInput(int pad, u64 index, bool constant)
+{
+  GCPadStatus status;
+  status.button = constant ? 0 : static_cast<u16>((index / 5 + pad * 3) % 4);
+  status.stickX =
+      static_cast<u8>(GCPadStatus::MAIN_STICK_CENTER_X + (constant ? 0 : index / 9 % 3));
+  status.stickY = GCPadStatus::MAIN_STICK_CENTER_Y;
+  return status;
+}
+
+// Everything the game does depends on the inputs it reads, and on nothing else
+struct FakeGame
+{
+  u64 frame = 0;
+  u64 hash = 0;
+
+  void Read(const GCPadStatus& status)
+  {
+    hash = (hash ^ status.button ^ (u64(status.stickX) << 16)) * 0x100000001B3;
+  }
+
+  // Reads the local pad a second time every few frames, like games polling between SI polls
+  template <typename ReadPad>
+  void RunFrame(ReadPad read_pad)
+  {
+    Read(read_pad(LOCAL_PAD));
+    Read(read_pad(REMOTE_PAD));
+    if (frame % 7 == 0)
+      Read(read_pad(LOCAL_PAD));
+    ++frame;
+  }
+};
+
+// The hash at the start of every frame when all inputs are known in time
+std::vector<u64> ReferenceHashes(bool constant)
+{
+  FakeGame game;
+  u64 reads[2] = {};
+  std::vector<u64> hashes;
+  while (game.frame <= FRAMES)
+  {
+    hashes.push_back(game.hash);
+    game.RunFrame([&](int pad) { return MakeInput(pad, reads[pad]++, constant); });
+  }
+  return hashes;
+}
+
+struct Result
+{
+  NetPlay::RollbackSession::Stats stats;
+  u64 final_frames = 0;
+  u64 mismatches = 0;
+  // The frames the per-frame hooks ran on, which skip re-simulated frames like RunRioFunctions
+  std::vector<u64> hooked_frames;
+};
+
+// The remote inputs arrive a few frames after the game wants them, the local ones right away
+Result RunSession(u32 max_frames, std::chrono::microseconds budget,
+                  std::chrono::microseconds save_delay, bool constant)
+{
+  const std::vector<u64> reference = ReferenceHashes(constant);
+  FakeGame game;
+  const auto save = [&](std::vector<u8>& buffer) {
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < save_delay)
+    {
+    }
+    buffer.resize(sizeof(game));
+    std::memcpy(buffer.data(), &game, sizeof(game));
+  };
+  const auto load = [&](const std::vector<u8>& buffer) {
+    std::memcpy(&game, buffer.data(), sizeof(game));
+  };
+  NetPlay::RollbackSession session(max_frames, budget, save, load);
+
+  Result result;
+  u64 live_frame = 0;
+  u64 remote_sent = 0;
+  const auto send_remote = [&] {
+    session.AddInput(REMOTE_PAD, MakeInput(REMOTE_PAD, remote_sent, constant));
+    ++remote_sent;
+  };
+  const auto read_pad = [&](int pad) {
+    const u64 local_count = session.GetInputCount(LOCAL_PAD);
+    for (u64 i = local_count; i < session.GetConsumedCount(LOCAL_PAD) + 2; ++i)
+      session.AddInput(LOCAL_PAD, MakeInput(LOCAL_PAD, i, constant));
+    // Waiting on the network
+    while (!session.CanConsume(pad))
+      send_remote();
+    return session.ConsumeInput(pad);
+  };
+
+  while (game.frame < FRAMES)
+  {
+    if (!session.IsResimulating())
+    {
+      result.hooked_frames.push_back(game.frame);
+      ++live_frame;
+      // Latency with some jitter
+      while (remote_sent + 3 + remote_sent / 10 % 3 <= live_frame)
+        send_remote();
+    }
+
+    game.RunFrame(read_pad);
+    session.EndFrame();
+    EXPECT_EQ(session.GetFrame(), game.frame);
+
+    if (session.IsFrameFinal())
+    {
+      ++result.final_frames;
+      if (game.hash != reference[game.frame])
+        ++result.mismatches;
+    }
+  }
+
+  result.stats = session.GetStats();
+  return result;
+}
+}  // namespace
+
+TEST(NetPlayRollback, ResimulatesToTheSameState)
+{
+  const Result result = RunSession(8, std::chrono::microseconds(0), {}, false);
+  EXPECT_EQ(result.mismatches, 0u);
+  EXPECT_GT(result.final_frames, FRAMES / 2);
+  EXPECT_GT(result.stats.rollbacks, 0u);
+  EXPECT_GT(result.stats.resimulated_frames, result.stats.rollbacks);
+  EXPECT_LE(result.stats.max_rollback_depth, 8u + 2u);
+  EXPECT_EQ(result.stats.snapshot_interval, 1u);
+}
+
+TEST(NetPlayRollback, CorrectPredictionsDoNotRollBack)
+{
+  const Result result = RunSession(8, std::chrono::microseconds(0), {}, true);
+  EXPECT_EQ(result.mismatches, 0u);
+  EXPECT_EQ(result.stats.rollbacks, 0u);
+  EXPECT_EQ(result.stats.frames, FRAMES);
+}
+
+TEST(NetPlayRollback, HooksSeeEveryFrameOnce)
+{
+  const Result rollback = RunSession(8, std::chrono::microseconds(0), {}, false);
+  const Result no_rollback = RunSession(8, std::chrono::microseconds(0), {}, true);
+  ASSERT_GT(rollback.stats.rollbacks, 0u);
+  ASSERT_EQ(no_rollback.stats.rollbacks, 0u);
+
+  // Frame counters such as the average ping and the draft timer end up the same as without
+  // rollbacks
+  EXPECT_EQ(rollback.hooked_frames.size(), FRAMES);
+  EXPECT_EQ(rollback.hooked_frames, no_rollback.hooked_frames);
+}
+
+TEST(NetPlayRollback, StallsWhenPredictingTooFar)
+{
+  // Only three frames may be predicted while the remote inputs are three to five frames late
+  const Result result = RunSession(3, std::chrono::microseconds(0), {}, false);
+  EXPECT_EQ(result.mismatches, 0u);
+  EXPECT_GT(result.stats.rollbacks, 0u);
+  EXPECT_LE(result.stats.max_rollback_depth, 3u + 2u);
+}
+
+TEST(NetPlayRollback, SlowSavesStayWithinBudget)
+{
+  const Result result =
+      RunSession(8, std::chrono::microseconds(100), std::chrono::microseconds(250), false);
+  EXPECT_EQ(result.mismatches, 0u);
+  EXPECT_GT(result.stats.rollbacks, 0u);
+  EXPECT_GE(result.stats.snapshot_interval, 3u);
+  EXPECT_LT(result.stats.snapshots, (result.stats.frames + result.stats.resimulated_frames) / 2);
+}
+
+TEST(NetPlayRollback, WaitsForTheFirstInputs)
+{
+  NetPlay::RollbackSession session(8, std::chrono::microseconds(0), [](std::vector<u8>&) {},
+                                   [](const std::vector<u8>&) {});
+  EXPECT_FALSE(session.CanConsume(REMOTE_PAD));
+  session.AddInput(REMOTE_PAD, MakeInput(REMOTE_PAD, 0, false));
+  ASSERT_TRUE(session.CanConsume(REMOTE_PAD));
+  session.ConsumeInput(REMOTE_PAD);
+  session.EndFrame();
+  EXPECT_TRUE(session.IsFrameFinal());
+
+  // Predicts the last input, then rolls back once the real one is different
+  EXPECT_TRUE(session.CanConsume(REMOTE_PAD));
+  const GCPadStatus predicted = session.ConsumeInput(REMOTE_PAD);
+  EXPECT_EQ(predicted.button, MakeInput(REMOTE_PAD, 0, false).button);
+  EXPECT_FALSE(session.IsFrameFinal());
+  GCPadStatus actual = predicted;
+  actual.button ^= PAD_BUTTON_A;
+  session.AddInput(REMOTE_PAD, actual);
+  session.EndFrame();
+  EXPECT_EQ(session.GetFrame(), 1u);
+  EXPECT_TRUE(session.IsResimulating());
+  EXPECT_EQ(session.ConsumeInput(REMOTE_PAD).button, actual.button);
+  session.EndFrame();
+  EXPECT_FALSE(session.IsResimulating());
+  EXPECT_EQ(session.GetStats().rollbacks, 1u);
+}
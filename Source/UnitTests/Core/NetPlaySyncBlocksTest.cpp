@@ -0,0 +1,269 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/IOFile.h"
+#include "Core/NetPlayCommon.h"
+#include "Core/NetPlaySyncBlocks.h"
+
+using NetPlay::SYNC_BLOCK_SIZE;
+using NetPlay::SyncBlockReader;
+using NetPlay::SyncBlockWriter;
+
+namespace
+{
+// Mostly erased, with saves made of repeating records and a bit of noise
+std::vector<u8> MakeMemcard(size_t size, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<u8> card(size, 0xff);
+  for (size_t offset = 0; offset < size / 4; offset += 64)
+  {
+    for (size_t i = 0; i < 64; ++i)
+      card[offset + i] = rng() % 4 == 0 ? static_cast<u8>(rng()) : static_cast<u8>(i);
+  }
+  return card;
+}
+
+std::vector<u8> MakeNoise(size_t size, u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::vector<u8> data(size);
+  std::generate(data.begin(), data.end(), [&rng] { return static_cast<u8>(rng()); });
+  return data;
+}
+
+void WriteFile(const std::string& path, const std::vector<u8>& data)
+{
+  File::IOFile file(path, "wb");
+  ASSERT_TRUE(file.WriteBytes(data.data(), data.size()));
+}
+
+std::vector<u8> ReadFile(const std::string& path)
+{
+  std::string data;
+  File::ReadFileToString(path, data);
+  return std::vector<u8>(data.begin(), data.end());
+}
+
+class NetPlaySyncBlocksTest : public testing::Test
+{
+protected:
+  NetPlaySyncBlocksTest() : m_temp_dir(File::CreateTempDir()) {}
+  ~NetPlaySyncBlocksTest() override { File::DeleteDirRecursively(m_temp_dir); }
+
+  std::string m_temp_dir;
+};
+}  // namespace
+
+TEST_F(NetPlaySyncBlocksTest, RoundTrip)
+{
+  const std::vector<u8> card = MakeMemcard(2 * 1024 * 1024 + 123, 1);
+  const std::vector<u8> noise = MakeNoise(300 * 1024, 2);
+  WriteFile(m_temp_dir + "/card.raw", card);
+  File::CreateFullPath(m_temp_dir + "/folder/sub/");
+  WriteFile(m_temp_dir + "/folder/a.bin", noise);
+  WriteFile(m_temp_dir + "/folder/sub/b.bin", card);
+  WriteFile(m_temp_dir + "/folder/sub/empty.bin", {});
+
+  std::vector<sf::Packet> batches;
+  SyncBlockWriter writer([&batches](sf::Packet&& batch) { batches.push_back(std::move(batch)); });
+
+  sf::Packet saves;
+  ASSERT_TRUE(writer.WriteFile(m_temp_dir + "/card.raw", saves));
+  ASSERT_TRUE(writer.WriteFolder(m_temp_dir + "/folder", saves));
+  ASSERT_TRUE(writer.WriteFolder(m_temp_dir + "/missing", saves));
+  ASSERT_TRUE(writer.WriteBuffer(noise, saves));
+  ASSERT_TRUE(writer.Finish());
+
+  // The card is sent once, and its erased blocks only once
+  const SyncBlockWriter::Stats& stats = writer.GetStats();
+  EXPECT_EQ(stats.bytes, 2 * card.size() + 2 * noise.size());
+  EXPECT_LT(stats.unique_bytes, card.size() / 2 + noise.size() + 2 * SYNC_BLOCK_SIZE);
+  EXPECT_LT(stats.compressed_bytes, stats.unique_bytes);
+
+  SyncBlockReader reader;
+  for (const sf::Packet& batch : batches)
+  {
+    ASSERT_TRUE(reader.AddBatch(
+        std::span(static_cast<const u8*>(batch.getData()), batch.getDataSize())));
+  }
+
+  const std::string out = m_temp_dir + "/out";
+  File::CreateFullPath(out + "/");
+  ASSERT_TRUE(reader.ReadFile(saves, out + "/card.raw"));
+  ASSERT_TRUE(reader.ReadFolder(saves, out + "/folder"));
+  ASSERT_TRUE(reader.ReadFolder(saves, out + "/missing"));
+  const std::optional<std::vector<u8>> buffer = reader.ReadBuffer(saves);
+
+  EXPECT_EQ(ReadFile(out + "/card.raw"), card);
+  EXPECT_EQ(ReadFile(out + "/folder/a.bin"), noise);
+  EXPECT_EQ(ReadFile(out + "/folder/sub/b.bin"), card);
+  EXPECT_FALSE(File::Exists(out + "/missing"));
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(*buffer, noise);
+  EXPECT_TRUE(saves.endOfPacket());
+}
+
+TEST_F(NetPlaySyncBlocksTest, RejectsBadBatches)
+{
+  const std::vector<u8> card = MakeMemcard(512 * 1024, 3);
+
+  std::vector<sf::Packet> batches;
+  SyncBlockWriter writer([&batches](sf::Packet&& batch) { batches.push_back(std::move(batch)); });
+  sf::Packet saves;
+  ASSERT_TRUE(writer.WriteBuffer(card, saves));
+  ASSERT_TRUE(writer.Finish());
+  ASSERT_EQ(batches.size(), 1u);
+
+  const u8* data = static_cast<const u8*>(batches[0].getData());
+  std::vector<u8> batch(data, data + batches[0].getDataSize());
+
+  SyncBlockReader reader;
+  EXPECT_FALSE(reader.AddBatch(std::span(batch).first(batch.size() - 1)));
+
+  batch.back() ^= 0xff;
+  SyncBlockReader corrupted_reader;
+  EXPECT_FALSE(corrupted_reader.AddBatch(batch));
+
+  // Without the blocks, the saves cannot be read
+  SyncBlockReader empty_reader;
+  sf::Packet saves_copy = saves;
+  EXPECT_FALSE(empty_reader.ReadBuffer(saves_copy));
+}
+
+TEST_F(NetPlaySyncBlocksTest, SkipsKeptBlocks)
+{
+  std::vector<u8> card = MakeMemcard(16 * 1024 * 1024, 4);
+  const std::string path = m_temp_dir + "/card.raw";
+  SyncBlockReader reader;
+
+  const auto sync = [&](std::set<NetPlay::SyncBlockHash> known_blocks) {
+    WriteFile(path, card);
+    u64 sent = 0;
+    SyncBlockWriter writer(
+        [&](sf::Packet&& batch) {
+          sent += batch.getDataSize();
+          EXPECT_TRUE(reader.AddBatch(
+              std::span(static_cast<const u8*>(batch.getData()), batch.getDataSize())));
+        },
+        std::move(known_blocks));
+
+    sf::Packet saves;
+    EXPECT_TRUE(writer.WriteFile(path, saves));
+    EXPECT_TRUE(writer.Finish());
+    EXPECT_TRUE(reader.ReadFile(saves, m_temp_dir + "/out.raw"));
+    EXPECT_EQ(ReadFile(m_temp_dir + "/out.raw"), card);
+    reader.Retain();
+    return std::pair(writer.GetBlocks(), sent);
+  };
+
+  const auto [first_blocks, first_sent] = sync({});
+  EXPECT_GT(first_sent, 1024u * 1024);
+
+  // The same match again
+  const auto [second_blocks, second_sent] = sync(first_blocks);
+  EXPECT_EQ(second_blocks, first_blocks);
+  EXPECT_EQ(second_sent, 0u);
+
+  // A save was written to during the match
+  std::fill_n(card.begin() + 3 * SYNC_BLOCK_SIZE + 100, 8192, 0x42);
+  const auto [third_blocks, third_sent] = sync(second_blocks);
+  EXPECT_GT(third_sent, 0u);
+  EXPECT_LT(third_sent, SYNC_BLOCK_SIZE);
+
+  fmt::print("Syncing a memory card again: {} bytes, {} bytes with a changed save\n", second_sent,
+             third_sent);
+}
+
+// A memory card in both slots and a Riivolution folder, over a typical home upload
+TEST_F(NetPlaySyncBlocksTest, SyncTime)
+{
+  using Clock = std::chrono::steady_clock;
+  using Seconds = std::chrono::duration<double>;
+  constexpr double BYTES_PER_SECOND = 20'000'000 / 8.0;
+  constexpr double RTT = 0.05;
+
+  const std::vector<u8> card = MakeMemcard(16 * 1024 * 1024, 4);
+  WriteFile(m_temp_dir + "/card.raw", card);
+  File::CreateFullPath(m_temp_dir + "/riivolution/");
+  for (int i = 0; i < 8; ++i)
+    WriteFile(fmt::format("{}/riivolution/{}.bin", m_temp_dir, i), MakeMemcard(1024 * 1024, 5 + i));
+  WriteFile(m_temp_dir + "/riivolution/music.brstm", MakeNoise(4 * 1024 * 1024, 20));
+
+  // Before: every save is compressed whole, sent, and decompressed before the next one
+  double lzo_time = 0;
+  for (const char* path : {"/card.raw", "/card.raw", "/riivolution"})
+  {
+    const bool is_folder = path[1] == 'r';
+    sf::Packet packet;
+    auto start = Clock::now();
+    ASSERT_TRUE(is_folder ? NetPlay::CompressFolderIntoPacket(m_temp_dir + path, packet) :
+                            NetPlay::CompressFileIntoPacket(m_temp_dir + path, packet));
+    lzo_time += Seconds(Clock::now() - start).count();
+    lzo_time += packet.getDataSize() / BYTES_PER_SECOND + RTT;
+
+    start = Clock::now();
+    ASSERT_TRUE(is_folder ? NetPlay::DecompressPacketIntoFolder(packet, m_temp_dir + "/lzo") :
+                            NetPlay::DecompressPacketIntoFile(packet, m_temp_dir + "/lzo.raw"));
+    lzo_time += Seconds(Clock::now() - start).count();
+  }
+
+  // After: batches are sent as they are compressed and decompressed as they arrive
+  SyncBlockReader reader;
+  const auto sync_start = Clock::now();
+  double link_free = 0;
+  double reader_free = 0;
+  SyncBlockWriter writer([&](sf::Packet&& batch) {
+    const double ready = Seconds(Clock::now() - sync_start).count();
+    link_free = std::max(link_free, ready) + batch.getDataSize() / BYTES_PER_SECOND;
+
+    const auto start = Clock::now();
+    ASSERT_TRUE(
+        reader.AddBatch(std::span(static_cast<const u8*>(batch.getData()), batch.getDataSize())));
+    reader_free =
+        std::max(reader_free, link_free + RTT / 2) + Seconds(Clock::now() - start).count();
+  });
+
+  std::vector<sf::Packet> saves(3);
+  ASSERT_TRUE(writer.WriteFile(m_temp_dir + "/card.raw", saves[0]));
+  ASSERT_TRUE(writer.WriteFile(m_temp_dir + "/card.raw", saves[1]));
+  ASSERT_TRUE(writer.WriteFolder(m_temp_dir + "/riivolution", saves[2]));
+  ASSERT_TRUE(writer.Finish());
+
+  double blocks_time = std::max(link_free, Seconds(Clock::now() - sync_start).count());
+  for (size_t i = 0; i < saves.size(); ++i)
+  {
+    blocks_time += saves[i].getDataSize() / BYTES_PER_SECOND + RTT;
+    const auto start = Clock::now();
+    ASSERT_TRUE(i == 2 ? reader.ReadFolder(saves[i], m_temp_dir + "/blocks") :
+                         reader.ReadFile(saves[i], m_temp_dir + "/blocks.raw"));
+    blocks_time += Seconds(Clock::now() - start).count();
+  }
+  blocks_time = std::max(blocks_time, reader_free);
+
+  EXPECT_EQ(ReadFile(m_temp_dir + "/blocks.raw"), card);
+  EXPECT_EQ(ReadFile(m_temp_dir + "/blocks/music.brstm"),
+            ReadFile(m_temp_dir + "/riivolution/music.brstm"));
+
+  const SyncBlockWriter::Stats& stats = writer.GetStats();
+  fmt::print("Syncing {} bytes at {} Mbit/s: LZO {:.2f}s, blocks {:.2f}s ({} unique bytes "
+             "compressed to {})\n",
+             stats.bytes, BYTES_PER_SECOND * 8 / 1'000'000, lzo_time, blocks_time,
+             stats.unique_bytes, stats.compressed_bytes);
+  EXPECT_LT(blocks_time, lzo_time);
+}
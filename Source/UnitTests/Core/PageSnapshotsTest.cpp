@@ -0,0 +1,213 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/MemArena.h"
+#include "Common/ScopeGuard.h"
+#include "Core/HW/DirtyPageTracker.h"
+#include "Core/HW/PageSnapshots.h"
+#include "Core/MemTools.h"
+
+namespace
+{
+// MEM1 and ARAM of a GameCube. MEM1 has a second tracked view, like fastmem, and all of memory has
+// an untracked one for restoring.
+constexpr u32 MEM1_SIZE = 0x01800000;
+constexpr u32 MEMORY_SIZE = MEM1_SIZE + 0x01000000;
+
+class PageSnapshotsTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    if (!Memory::DirtyPageTracker::IsSupported())
+      GTEST_SKIP() << "Writes to memory can not be tracked on this platform.";
+
+    EMM::InstallExceptionHandler();
+    m_arena.GrabSHMSegment(MEMORY_SIZE, "dolphin-emu-test");
+    m_view = static_cast<u8*>(m_arena.CreateView(0, MEMORY_SIZE));
+    m_alias = static_cast<u8*>(m_arena.CreateView(0, MEM1_SIZE));
+    m_untracked = static_cast<u8*>(m_arena.CreateView(0, MEMORY_SIZE));
+    ASSERT_NE(m_view, nullptr);
+    ASSERT_NE(m_alias, nullptr);
+    ASSERT_NE(m_untracked, nullptr);
+
+    std::mt19937 rng(7);
+    for (u32 i = 0; i < MEMORY_SIZE; i += sizeof(u32))
+    {
+      const u32 value = rng();
+      std::memcpy(m_view + i, &value, sizeof(value));
+    }
+
+    m_page_size = Memory::DirtyPageTracker::GetPageSize();
+    m_page_count = MEMORY_SIZE / m_page_size;
+    const u32 mem1_pages = MEM1_SIZE / m_page_size;
+    m_tracker.Start(m_page_count, {{m_view, 0, m_page_count}, {m_alias, 0, mem1_pages}});
+    m_snapshots = std::make_unique<Memory::PageSnapshots>(
+        m_tracker, m_page_count,
+        std::vector<Memory::DirtyPageTracker::View>{{m_untracked, 0, m_page_count}});
+  }
+
+  void TearDown() override
+  {
+    if (!m_view)
+      return;
+
+    m_snapshots.reset();
+    m_tracker.Stop();
+    m_arena.ReleaseView(m_untracked, MEMORY_SIZE);
+    m_arena.ReleaseView(m_alias, MEM1_SIZE);
+    m_arena.ReleaseView(m_view, MEMORY_SIZE);
+    m_arena.ReleaseSHMSegment();
+    EMM::UninstallExceptionHandler();
+  }
+
+  // Writes words to random pages through every tracked view. Games mostly write close to where
+  // they wrote before, so most writes are close to the previous one.
+  void WriteRandomPages(std::mt19937& rng, u32 count)
+  {
+    u32 offset = 0;
+    for (u32 i = 0; i < count; ++i)
+    {
+      if (rng() % 4 == 0)
+        offset = (rng() % (MEMORY_SIZE / sizeof(u32))) * sizeof(u32);
+      else
+        offset = (offset + (rng() % 64) * sizeof(u32) * 64) % MEMORY_SIZE;
+      const u32 value = rng();
+      std::memcpy((offset < MEM1_SIZE && rng() % 2 ? m_alias : m_view) + offset, &value,
+                  sizeof(value));
+    }
+  }
+
+  std::vector<u8> Copy() const { return std::vector<u8>(m_view, m_view + MEMORY_SIZE); }
+
+  bool Matches(const std::vector<u8>& copy) const
+  {
+    return std::memcmp(m_view, copy.data(), MEMORY_SIZE) == 0;
+  }
+
+  Common::MemArena m_arena;
+  u8* m_view = nullptr;
+  u8* m_alias = nullptr;
+  u8* m_untracked = nullptr;
+  u32 m_page_size = 0;
+  u32 m_page_count = 0;
+  Memory::DirtyPageTracker m_tracker;
+  std::unique_ptr<Memory::PageSnapshots> m_snapshots;
+};
+}  // namespace
+
+TEST_F(PageSnapshotsTest, TracksWritesThroughEveryView)
+{
+  m_snapshots->Take();
+  EXPECT_EQ(m_snapshots->GetStats().last_copied_pages, m_page_count);
+
+  m_view[0] = 1;
+  m_alias[5 * m_page_size] = 2;
+  m_alias[5 * m_page_size + 1] = 3;
+  m_view[(m_page_count - 1) * m_page_size] = 4;
+
+  std::vector<u32> pages;
+  m_tracker.TakeDirtyPages(&pages);
+  EXPECT_EQ(pages, (std::vector<u32>{0, 5, m_page_count - 1}));
+
+  // Taking them protects them again
+  m_view[5 * m_page_size] = 5;
+  pages.clear();
+  m_tracker.TakeDirtyPages(&pages);
+  EXPECT_EQ(pages, std::vector<u32>{5});
+}
+
+TEST_F(PageSnapshotsTest, RestoresSnapshots)
+{
+  std::mt19937 rng(11);
+  std::vector<std::vector<u8>> copies;
+  std::vector<Memory::PageSnapshots::Id> ids;
+  for (int i = 0; i < 8; ++i)
+  {
+    WriteRandomPages(rng, 200);
+    copies.push_back(Copy());
+    ids.push_back(m_snapshots->Take());
+  }
+
+  // Backwards and forwards, with writes in between that have to be undone
+  for (const int i : {5, 2, 7, 0, 0, 6})
+  {
+    WriteRandomPages(rng, 50);
+    m_snapshots->Restore(ids[i]);
+    EXPECT_TRUE(Matches(copies[i])) << "snapshot " << i;
+  }
+
+  // Released snapshots do not keep the pages of the ones still used
+  for (int i = 1; i < 7; ++i)
+    m_snapshots->Release(ids[i]);
+  WriteRandomPages(rng, 50);
+  m_snapshots->Restore(ids[7]);
+  EXPECT_TRUE(Matches(copies[7]));
+  m_snapshots->Restore(ids[0]);
+  EXPECT_TRUE(Matches(copies[0]));
+  EXPECT_GT(m_snapshots->GetStats().free_pool_pages, 0u);
+}
+
+// Compares against copying all of the memory, which is what saving a full state does with it
+TEST_F(PageSnapshotsTest, Benchmark)
+{
+  using Clock = std::chrono::steady_clock;
+  constexpr int FRAMES = 120;
+  constexpr int KEPT_SNAPSHOTS = 8;
+  constexpr u32 WRITES_PER_FRAME = 300;
+
+  std::mt19937 rng(13);
+  std::vector<u8> full_copy(MEMORY_SIZE);
+  std::vector<Memory::PageSnapshots::Id> ids;
+  ids.push_back(m_snapshots->Take());
+
+  double take_us = 0.0;
+  double restore_us = 0.0;
+  double full_us = 0.0;
+  u64 copied_pages = 0;
+  for (int frame = 0; frame < FRAMES; ++frame)
+  {
+    WriteRandomPages(rng, WRITES_PER_FRAME);
+
+    Clock::time_point start = Clock::now();
+    ids.push_back(m_snapshots->Take());
+    take_us += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    copied_pages += m_snapshots->GetStats().last_copied_pages;
+    if (ids.size() > KEPT_SNAPSHOTS)
+    {
+      m_snapshots->Release(ids.front());
+      ids.erase(ids.begin());
+    }
+
+    start = Clock::now();
+    std::memcpy(full_copy.data(), m_view, MEMORY_SIZE);
+    full_us += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    // Roll back to the oldest snapshot every few frames, and simulate forward again
+    if (frame % 4 == 3)
+    {
+      WriteRandomPages(rng, WRITES_PER_FRAME);
+      start = Clock::now();
+      m_snapshots->Restore(ids.front());
+      restore_us += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+  }
+
+  const Memory::PageSnapshots::Stats stats = m_snapshots->GetStats();
+  fmt::print("{} frames of {} writes, {} byte pages: take {:.1f}us ({:.1f} pages), "
+             "restore {:.1f}us, full copy {:.1f}us, pool {} pages\n",
+             FRAMES, WRITES_PER_FRAME, m_page_size, take_us / FRAMES,
+             double(copied_pages) / FRAMES, restore_us / (FRAMES / 4), full_us / FRAMES,
+             stats.pool_pages);
+  EXPECT_LE(stats.snapshots, u32(KEPT_SNAPSHOTS));
+}
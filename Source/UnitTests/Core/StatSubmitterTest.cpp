@@ -0,0 +1,329 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+using socklen_t = int;
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define closesocket close
+#endif
+
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Common/SocketContext.h"
+#include "Core/MSB_StatSubmitter.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+// Minimal HTTP/1.1 endpoint on loopback standing in for a slow Rio API server. Every POST is
+// held without an answer until Release() is called.
+class MockHttpServer
+{
+public:
+  MockHttpServer()
+  {
+    m_socket = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    bind(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    listen(m_socket, 8);
+
+    socklen_t len = sizeof(addr);
+    getsockname(m_socket, reinterpret_cast<sockaddr*>(&addr), &len);
+    m_port = ntohs(addr.sin_port);
+
+    m_thread = std::thread([this] { ServerLoop(); });
+  }
+
+  ~MockHttpServer()
+  {
+    Release();
+    m_stop = true;
+    // Wakes up the blocking accept()
+    shutdown(m_socket, 2);
+    closesocket(m_socket);
+    m_thread.join();
+  }
+
+  std::string GetUrl() const { return fmt::format("http://127.0.0.1:{}/populate_db/", m_port); }
+
+  std::vector<std::pair<std::string, std::string>> GetRequests()
+  {
+    std::lock_guard lk(m_lock);
+    return m_requests;
+  }
+
+  void Release()
+  {
+    std::lock_guard lk(m_lock);
+    m_released = true;
+    m_release_cv.notify_all();
+  }
+
+private:
+  void ServerLoop()
+  {
+    while (!m_stop)
+    {
+      const auto client = accept(m_socket, nullptr, nullptr);
+      if (client == static_cast<decltype(client)>(-1))
+        continue;
+
+      std::string request;
+      size_t body_start = std::string::npos;
+      size_t content_length = 0;
+      char buffer[4096];
+      while (body_start == std::string::npos || request.size() < body_start + content_length)
+      {
+        const int received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+          break;
+        request.append(buffer, received);
+
+        if (body_start == std::string::npos && request.find("\r\n\r\n") != std::string::npos)
+        {
+          body_start = request.find("\r\n\r\n") + 4;
+          const size_t header = request.find("Content-Length: ");
+          if (header != std::string::npos && header < body_start)
+            content_length = std::stoul(request.substr(header + 16));
+        }
+      }
+
+      if (body_start != std::string::npos)
+      {
+        const size_t path_start = request.find(' ') + 1;
+        std::unique_lock lk(m_lock);
+        m_release_cv.wait(lk, [this] { return m_released; });
+        m_requests.emplace_back(request.substr(path_start, request.find(' ', path_start) - path_start),
+                                request.substr(body_start));
+      }
+
+      const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+      send(client, response, sizeof(response) - 1, 0);
+      closesocket(client);
+    }
+  }
+
+  Common::SocketContext m_socket_context;
+  decltype(socket(0, 0, 0)) m_socket;
+  u16 m_port = 0;
+  std::atomic<bool> m_stop = false;
+  std::thread m_thread;
+  std::mutex m_lock;
+  std::condition_variable m_release_cv;
+  bool m_released = false;
+  std::vector<std::pair<std::string, std::string>> m_requests;
+};
+
+class StatSubmitterTest : public testing::Test
+{
+protected:
+  StatSubmitterTest() : m_temp_dir(File::CreateTempDir()), m_spool_dir(m_temp_dir + "/Spool/") {}
+  ~StatSubmitterTest() override { File::DeleteDirRecursively(m_temp_dir); }
+
+  size_t SpooledGames() const { return Common::DoFileSearch({m_spool_dir}, {".json"}).size(); }
+
+  StatSubmitter::Settings MakeSettings() const
+  {
+    StatSubmitter::Settings settings;
+    settings.spool_dir = m_spool_dir;
+    settings.initial_backoff = 1ms;
+    settings.max_backoff = 4ms;
+    return settings;
+  }
+
+  std::string m_temp_dir;
+  std::string m_spool_dir;
+};
+}  // namespace
+
+TEST_F(StatSubmitterTest, SlowServerAddsNoFrameTime)
+{
+  MockHttpServer server;
+  StatSubmitter::Settings settings = MakeSettings();
+  settings.api_url = server.GetUrl();
+  StatSubmitter submitter(settings);
+
+  // Roughly what a full game produces: one post, an update per event and the final record. The
+  // server doesn't answer anything until all of them were handed over, so none of these calls
+  // can have waited on it.
+  const std::string event_payload(512, 'e');
+  const std::string game_payload(256 * 1024, 'g');
+  submitter.PostOngoingGame(1, "post");
+  for (int i = 0; i < 300; ++i)
+    submitter.UpdateOngoingGame(1, event_payload + std::to_string(i));
+  submitter.SubmitGame(1, game_payload);
+  EXPECT_TRUE(server.GetRequests().empty());
+  server.Release();
+
+  ASSERT_TRUE(submitter.WaitForIdle(10s));
+  const auto requests = server.GetRequests();
+  ASSERT_GE(requests.size(), 3u);
+  EXPECT_EQ(requests.front().first, "/populate_db/ongoing_game/");
+  EXPECT_EQ(requests.front().second, "post");
+  EXPECT_EQ(requests.back().first, "/populate_db/");
+  EXPECT_EQ(requests.back().second, game_payload);
+  EXPECT_EQ(SpooledGames(), 0u);
+}
+
+TEST_F(StatSubmitterTest, CoalescesSupersededUpdates)
+{
+  std::mutex gate;
+  std::vector<std::string> sent;
+  std::unique_lock block(gate);
+
+  StatSubmitter submitter(MakeSettings(), [&](const std::string&, const std::string& payload) {
+    std::lock_guard lk(gate);
+    sent.push_back(payload);
+    return true;
+  });
+
+  submitter.PostOngoingGame(7, "post");
+  for (int i = 0; i < 50; ++i)
+    submitter.UpdateOngoingGame(7, std::to_string(i));
+  EXPECT_LE(submitter.GetPendingCount(), 2u);
+  block.unlock();
+
+  ASSERT_TRUE(submitter.WaitForIdle(5s));
+  ASSERT_GE(sent.size(), 2u);
+  EXPECT_LE(sent.size(), 3u);
+  EXPECT_EQ(sent.front(), "post");
+  EXPECT_EQ(sent.back(), "49");
+}
+
+TEST_F(StatSubmitterTest, RetriesWithBackoff)
+{
+  std::atomic<int> attempts = 0;
+  std::atomic<bool> accepted = false;
+  StatSubmitter submitter(
+      MakeSettings(), [&](const std::string&, const std::string&) { return ++attempts >= 3; },
+      [&](u32 game_id, bool ok) { accepted = ok && game_id == 3; });
+
+  submitter.SubmitGame(3, "game");
+  ASSERT_TRUE(submitter.WaitForIdle(5s));
+  EXPECT_EQ(attempts, 3);
+  EXPECT_TRUE(accepted);
+  EXPECT_EQ(SpooledGames(), 0u);
+}
+
+TEST_F(StatSubmitterTest, SpoolSurvivesRestart)
+{
+  {
+    StatSubmitter::Settings settings = MakeSettings();
+    settings.max_attempts = 2;
+    StatSubmitter offline(settings, [](const std::string&, const std::string&) { return false; });
+    offline.SubmitGame(42, "game");
+    ASSERT_TRUE(offline.WaitForIdle(5s));
+  }
+  EXPECT_EQ(SpooledGames(), 1u);
+
+  std::vector<std::string> sent;
+  u32 reported_game = 0;
+  {
+    StatSubmitter online(
+        MakeSettings(),
+        [&](const std::string&, const std::string& payload) {
+          sent.push_back(payload);
+          return true;
+        },
+        [&](u32 game_id, bool) { reported_game = game_id; });
+    ASSERT_TRUE(online.WaitForIdle(5s));
+  }
+
+  ASSERT_EQ(sent.size(), 1u);
+  EXPECT_EQ(sent[0], "game");
+  EXPECT_EQ(reported_game, 42u);
+  EXPECT_EQ(SpooledGames(), 0u);
+}
+
+TEST_F(StatSubmitterTest, RetryDoesNotHoldUpOtherGames)
+{
+  std::mutex lock;
+  std::condition_variable sent_cv;
+  std::vector<std::string> sent;
+  int failed_attempts = 0;
+
+  // The first game never goes through and waits an hour between attempts
+  StatSubmitter::Settings settings = MakeSettings();
+  settings.initial_backoff = std::chrono::hours{1};
+  settings.max_backoff = std::chrono::hours{1};
+  StatSubmitter submitter(settings, [&](const std::string&, const std::string& payload) {
+    std::lock_guard lk(lock);
+    if (payload == "offline")
+    {
+      ++failed_attempts;
+      return false;
+    }
+    sent.push_back(payload);
+    sent_cv.notify_all();
+    return true;
+  });
+
+  submitter.SubmitGame(1, "offline");
+  submitter.PostOngoingGame(2, "post");
+  submitter.UpdateOngoingGame(2, "update");
+  submitter.SubmitGame(2, "game");
+
+  {
+    std::unique_lock lk(lock);
+    ASSERT_TRUE(sent_cv.wait_for(lk, 10s, [&] { return sent.size() == 3; }));
+    EXPECT_EQ(sent, (std::vector<std::string>{"post", "update", "game"}));
+    EXPECT_EQ(failed_attempts, 1);
+  }
+
+  submitter.Shutdown();
+  EXPECT_EQ(SpooledGames(), 1u);
+}
+
+TEST_F(StatSubmitterTest, ShutdownSpoolsQueuedGames)
+{
+  std::mutex lock;
+  std::condition_variable cv;
+  bool sending = false;
+  bool release = false;
+
+  // The server is unreachable and the first attempt hangs until the test lets it fail
+  StatSubmitter submitter(MakeSettings(), [&](const std::string&, const std::string&) {
+    std::unique_lock lk(lock);
+    sending = true;
+    cv.notify_all();
+    cv.wait(lk, [&] { return release; });
+    return false;
+  });
+
+  submitter.SubmitGame(1, "first");
+  {
+    std::unique_lock lk(lock);
+    cv.wait(lk, [&] { return sending; });
+  }
+  submitter.SubmitGame(2, "second");
+
+  std::thread shutdown([&] { submitter.Shutdown(); });
+  {
+    std::lock_guard lk(lock);
+    release = true;
+    cv.notify_all();
+  }
+  shutdown.join();
+
+  // Whether or not the worker got to the second game, both have to be in the spool
+  EXPECT_EQ(SpooledGames(), 2u);
+}
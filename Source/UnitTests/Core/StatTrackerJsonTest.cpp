@@ -0,0 +1,396 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <picojson.h>
+
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+#include "Common/JsonWriter.h"
+#include "Core/MSB_StatFile.h"
+#include "Core/MSB_StatTracker.h"
+
+namespace
+{
+// Contact with every field set, fielded by the shortstop
+void FillContact(StatTracker::Contact& contact, u8 type_of_contact)
+{
+  contact.type_of_contact.set_value(type_of_contact);
+  contact.moon_shot.set_value(0);
+  contact.input_direction_stick.set_value(0x9);
+  contact.input_direction_push_pull.set_value(1);
+  contact.frame_of_swing.set_value(4);
+  contact.power.set_value(120);
+  contact.vert_angle.set_value(300);
+  contact.horiz_angle.set_value(1024);
+  contact.ball_x_velo.set_value(0x3E4CCCCD);
+  contact.ball_y_velo.set_value(0x3F000000);
+  contact.ball_z_velo.set_value(0xBE99999A);
+  contact.ball_contact_x_pos.set_value(0x3DCCCCCD);
+  contact.ball_contact_z_pos.set_value(0x3E4CCCCD);
+  contact.ball_x_pos.set_value(0x41A00000);
+  contact.ball_y_pos.set_value(0);
+  contact.ball_z_pos.set_value(0x42F00000);
+  contact.ball_max_height.set_value(0x41200000);
+  contact.ball_hang_time.set_value(90);
+  contact.charge_power_up.set_value(0x3F800000);
+  contact.charge_power_down.set_value(0);
+  contact.contact_absolute.set_value(0x42C80000);
+  contact.contact_quality.set_value(0x3F400000);
+  contact.rng1.set_value(1);
+  contact.rng2.set_value(2);
+  contact.rng3.set_value(3);
+  contact.primary_contact_result = 2;
+  contact.secondary_contact_result = 7;
+
+  StatTracker::Fielder& fielder = contact.first_fielder.emplace();
+  fielder.fielder_roster_loc = 6;
+  fielder.fielder_pos = 6;
+  fielder.fielder_char_id = 10;
+  fielder.fielder_swapped_for_batter = 0;
+  fielder.fielder_manual_select_arg = 0;
+  fielder.fielder_x_pos = 0x41200000;
+  fielder.fielder_y_pos = 0;
+  fielder.fielder_z_pos = 0x42C80000;
+}
+
+// Fills the tracker with a full nine inning game. Every plate appearance has a pitch, most of
+// them contact, and runners and fielders vary the way they do in a real game.
+void FillGame(StatTracker& tracker)
+{
+  StatTracker::GameInfo& game = tracker.m_game_info;
+  game.game_id = 0x12345678;
+  game.rio_version = "1.9.5";
+  game.start_unix_date_time = "1700000000";
+  game.end_unix_date_time = "1700003600";
+  game.start_local_date_time = "Tue Nov 14 22:13:20 2023";
+  game.end_local_date_time = "Tue Nov 14 23:13:20 2023";
+  game.stadium = 0;
+  game.innings_selected = 9;
+  game.innings_played = 9;
+  game.quitter_team = 0xFF;
+  game.away_score = 5;
+  game.home_score = 4;
+
+  for (int team = 0; team < cNumOfTeams; ++team)
+  {
+    for (int roster = 0; roster < cRosterSize; ++roster)
+    {
+      StatTracker::CharacterSummary& summary = game.character_summaries[team][roster];
+      summary = {};
+      summary.char_id = static_cast<u8>(team * cRosterSize + roster);
+      summary.end_game_defensive_stats.pitches_thrown = roster == 0 ? 120 : 0;
+      summary.end_game_offensive_stats.at_bats = 4;
+      summary.end_game_offensive_stats.hits = static_cast<u8>(roster % 3);
+      tracker.m_fielder_tracker[team].fielder_map[roster].batter_count_by_position[roster] = 30;
+      tracker.m_fielder_tracker[team].fielder_map[roster].out_count_by_position[roster] = 3;
+    }
+  }
+
+  for (u16 event_num = 0; event_num < 300; ++event_num)
+  {
+    StatTracker::Event event;
+    event.event_num = event_num;
+    event.inning = static_cast<u8>(1 + event_num / 34);
+    event.half_inning = (event_num / 17) % 2;
+    event.away_score = event_num / 60;
+    event.home_score = event_num / 75;
+    event.balls = event_num % 4;
+    event.strikes = event_num % 3;
+    event.outs = event_num % 3;
+    event.is_star_chance = 0;
+    event.away_stars = 2;
+    event.home_stars = 3;
+    event.chem_links_ob = 0;
+    event.pitcher_stamina = 500;
+    event.pitcher_roster_loc = 0;
+    event.batter_roster_loc = event_num % cRosterSize;
+    event.catcher_roster_loc = 1;
+    event.rbi = 0;
+    event.result_of_atbat = event_num % 8;
+
+    event.runner_batter = StatTracker::Runner{event.batter_roster_loc, 3, 0};
+    if (event_num % 3 == 1)
+      event.runner_1 = StatTracker::Runner{2, 4, 1};
+    if (event_num % 5 == 2)
+      event.runner_2 = StatTracker::Runner{5, 7, 2};
+
+    StatTracker::Pitch& pitch = event.pitch.emplace();
+    pitch.pitcher_team_id = event.half_inning;
+    pitch.pitcher_char_id = 12;
+    pitch.pitch_type = 1;
+    pitch.charge_type = 2;
+    pitch.star_pitch = 0;
+    pitch.pitch_speed = 140;
+    pitch.ball_z_strike_vs_ball = 0x3F800000;
+    pitch.ball_in_strikezone = 1;
+    pitch.bat_contact_x_pos.set_value(0x3DCCCCCD);
+    pitch.bat_contact_z_pos.set_value(0x3E4CCCCD);
+    pitch.type_of_swing = 2;
+
+    if (event_num % 4 != 0)
+      FillContact(pitch.contact.emplace(), event_num % 5);
+
+    game.events.append(event);
+  }
+}
+
+// Where the buffer of a writer is, to tell whether writing to it reallocated the buffer
+std::pair<const char*, size_t> GetBuffer(const Common::JsonWriter& writer)
+{
+  return {writer.GetString().data(), writer.GetString().capacity()};
+}
+
+class StatTrackerJsonTest : public testing::Test
+{
+protected:
+  StatTrackerJsonTest() : m_user_path(File::CreateTempDir())
+  {
+    File::SetUserPath(D_USER_IDX, m_user_path);
+    m_tracker = std::make_unique<StatTracker>();
+    FillGame(*m_tracker);
+  }
+  ~StatTrackerJsonTest() override
+  {
+    m_tracker.reset();
+    File::DeleteDirRecursively(m_user_path);
+  }
+
+  // Everything that runs at game end: the shared events array in both variants, then the
+  // decoded file, the raw file and the submission.
+  size_t SerializeGame()
+  {
+    m_tracker->writeEventsJSON(m_tracker->m_events_writer[0], false);
+    m_tracker->writeEventsJSON(m_tracker->m_events_writer[1], true);
+    size_t bytes = 0;
+    for (const auto& [decode, hide_riokey] : {std::pair{true, true}, {false, true}, {false, false}})
+    {
+      m_tracker->writeStatJSON(m_tracker->m_json_writer, decode, hide_riokey);
+      bytes += m_tracker->m_json_writer.GetSize();
+    }
+    return bytes;
+  }
+
+  // Writes the game the way the tracker does while it is played. Returns the path of the file
+  std::string WriteStatFile(bool close)
+  {
+    const std::string path = m_user_path + "/game" + StatFile::cExtension;
+    StatFile::Writer writer;
+    EXPECT_TRUE(writer.open(path));
+    writer.writeGameInfo(*m_tracker);
+    StatTracker::Event event;
+    for (u32 row = 0; row < m_tracker->m_game_info.events.size(); ++row)
+    {
+      m_tracker->m_game_info.events.load(row, event);
+      writer.writeEvent(event);
+    }
+    writer.writeGameInfo(*m_tracker);
+    if (close)
+      writer.close();
+    return path;
+  }
+
+  std::string WriteJSON(StatTracker& tracker, bool decode)
+  {
+    tracker.writeEventsJSON(tracker.m_events_writer[decode], decode);
+    tracker.writeStatJSON(tracker.m_json_writer, decode, false);
+    return std::string(tracker.m_json_writer.GetView());
+  }
+
+  std::string m_user_path;
+  std::unique_ptr<StatTracker> m_tracker;
+};
+}  // namespace
+
+TEST_F(StatTrackerJsonTest, ProducesValidDocuments)
+{
+  for (const bool decode : {false, true})
+  {
+    m_tracker->writeEventsJSON(m_tracker->m_events_writer[decode], decode);
+    m_tracker->writeStatJSON(m_tracker->m_json_writer, decode, true);
+
+    picojson::value doc;
+    const std::string error =
+        picojson::parse(doc, std::string(m_tracker->m_json_writer.GetView()));
+    ASSERT_TRUE(error.empty()) << error;
+
+    EXPECT_EQ(doc.get("GameID").get<std::string>(), std::to_string(0x12345678));
+    EXPECT_EQ(doc.get("Events").get<picojson::array>().size(), 300u);
+
+    const picojson::value& roster = doc.get("Character Game Stats").get("Home Roster 2");
+    EXPECT_EQ(roster.get("Team").get<std::string>(), "1");
+    EXPECT_EQ(roster.get("Defensive Stats").get("Outs Per Position").get<picojson::array>().size(),
+              1u);
+
+    const picojson::value& contact = doc.get("Events").get(1).get("Pitch").get("Contact");
+    EXPECT_EQ(contact.get("Ball Power").get<std::string>(), "120");
+    EXPECT_EQ(contact.get("Ball Hang Time").get<std::string>(), "90");
+    if (decode)
+      EXPECT_EQ(contact.get("Input Direction - Stick").get<std::string>(), "Left+Up");
+    else
+      EXPECT_EQ(contact.get("Input Direction - Stick").get<double>(), 9);
+  }
+
+  StatTracker::Event current;
+  m_tracker->m_game_info.events.load(10, current);
+  std::optional<StatTracker::Event> previous;
+  m_tracker->m_game_info.events.load(9, previous.emplace());
+  picojson::value hud;
+  ASSERT_TRUE(
+      picojson::parse(hud, std::string(m_tracker->getHUDJSON("10a", current, previous, true)))
+          .empty());
+  EXPECT_EQ(hud.get("Event Num").get<std::string>(), "10a");
+  EXPECT_EQ(hud.get("Previous Event").get("Pitch").get("Contact").get("Ball Hang Time").get<double>(),
+            90);
+}
+
+TEST_F(StatTrackerJsonTest, Benchmark)
+{
+  // Warm up so the buffers have grown to the size of a full game
+  SerializeGame();
+
+  const auto json_buffer = GetBuffer(m_tracker->m_json_writer);
+  const auto events_buffers = std::pair{GetBuffer(m_tracker->m_events_writer[0]),
+                                        GetBuffer(m_tracker->m_events_writer[1])};
+
+  constexpr int ITERATIONS = 50;
+  size_t bytes = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ITERATIONS; ++i)
+    bytes += SerializeGame();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  fmt::print("Serialized {} games ({} bytes) in {:.3f}s: {:.1f} MB/s\n", ITERATIONS, bytes,
+             elapsed.count(), bytes / elapsed.count() / 1e6);
+
+  // Once grown to the size of a game, the buffers are reused instead of being reallocated
+  EXPECT_EQ(GetBuffer(m_tracker->m_json_writer), json_buffer);
+  EXPECT_EQ(std::pair(GetBuffer(m_tracker->m_events_writer[0]),
+                      GetBuffer(m_tracker->m_events_writer[1])),
+            events_buffers);
+}
+
+TEST_F(StatTrackerJsonTest, EventLogRoundTrip)
+{
+  StatTracker::EventLog& log = m_tracker->m_game_info.events;
+  ASSERT_EQ(log.size(), 300u);
+
+  // Loading into an event that already holds different parts must not leave any of them behind
+  StatTracker::Event loaded;
+  log.load(5, loaded);
+  for (u32 row = 0; row < log.size(); ++row)
+  {
+    log.load(row, loaded);
+    EXPECT_EQ(log.getEventNum(row), row);
+    EXPECT_EQ(loaded.event_num, row);
+    EXPECT_EQ(loaded.runner_1.has_value(), row % 3 == 1);
+    EXPECT_EQ(loaded.runner_2.has_value(), row % 5 == 2);
+    EXPECT_FALSE(loaded.runner_3.has_value());
+    ASSERT_TRUE(loaded.pitch.has_value());
+    EXPECT_EQ(loaded.pitch->contact.has_value(), row % 4 != 0);
+  }
+
+  // Appending what was loaded must serialize exactly like the original
+  StatTracker::EventLog copy;
+  for (u32 row = 0; row < log.size(); ++row)
+  {
+    log.load(row, loaded);
+    copy.append(loaded);
+  }
+  m_tracker->writeEventsJSON(m_tracker->m_events_writer[0], true);
+  const std::string original(m_tracker->m_events_writer[0].GetView());
+  std::swap(log, copy);
+  m_tracker->writeEventsJSON(m_tracker->m_events_writer[0], true);
+  EXPECT_EQ(m_tracker->m_events_writer[0].GetView(), original);
+}
+
+TEST_F(StatTrackerJsonTest, EventLogMemory)
+{
+  const StatTracker::EventLog& log = m_tracker->m_game_info.events;
+  const size_t bytes_per_event = log.memoryUsage() / log.size();
+
+  // What keeping whole events costs: the event itself plus the std::map node around it
+  const size_t map_bytes_per_event = sizeof(StatTracker::Event) + 4 * sizeof(void*);
+  fmt::print("Event log: {} bytes per event, map of events: {} bytes per event\n", bytes_per_event,
+             map_bytes_per_event);
+
+  // Spare capacity of the columns is included, so leave some headroom
+  EXPECT_LT(bytes_per_event * 4, map_bytes_per_event);
+}
+
+TEST_F(StatTrackerJsonTest, StatFileRoundTrip)
+{
+  const std::string path = WriteStatFile(true);
+
+  const auto decoded = std::make_unique<StatTracker>(StatTracker::Mode::Offline);
+  ASSERT_EQ(StatFile::read(path, *decoded), StatFile::ReadResult::Complete);
+  ASSERT_EQ(decoded->m_game_info.events.size(), 300u);
+
+  // The converter must reproduce the files written at game end byte for byte
+  for (const bool decode : {false, true})
+    EXPECT_EQ(WriteJSON(*decoded, decode), WriteJSON(*m_tracker, decode));
+
+  const u64 binary_size = File::GetSize(path);
+  const size_t json_size = WriteJSON(*m_tracker, false).size();
+  fmt::print("Stat file: {} bytes, raw JSON: {} bytes ({:.1f}x smaller)\n", binary_size,
+             json_size, static_cast<double>(json_size) / binary_size);
+  EXPECT_LT(binary_size * 10, json_size);
+}
+
+TEST_F(StatTrackerJsonTest, StatFileTruncated)
+{
+  const std::string path = WriteStatFile(false);
+
+  // Cut into the last chunk, as a crash in the middle of a write would
+  std::string data;
+  ASSERT_TRUE(File::ReadFileToString(path, data));
+  data.resize(data.size() - 3);
+  ASSERT_TRUE(File::WriteStringToFile(path, data));
+
+  const auto decoded = std::make_unique<StatTracker>(StatTracker::Mode::Offline);
+  ASSERT_EQ(StatFile::read(path, *decoded), StatFile::ReadResult::Truncated);
+  EXPECT_EQ(decoded->m_game_info.events.size(), 300u);
+  EXPECT_EQ(decoded->m_game_info.quitter_team, 2);
+  EXPECT_EQ(decoded->m_game_info.game_id, 0x12345678u);
+
+  data.resize(3);
+  ASSERT_TRUE(File::WriteStringToFile(path, data));
+  EXPECT_EQ(StatFile::read(path, *decoded), StatFile::ReadResult::Invalid);
+}
+
+TEST_F(StatTrackerJsonTest, StatFileCorrupt)
+{
+  const std::string path = WriteStatFile(true);
+  std::string data;
+  ASSERT_TRUE(File::ReadFileToString(path, data));
+  const auto decoded = std::make_unique<StatTracker>(StatTracker::Mode::Offline);
+
+  // The field widths of every table follow the magic and the version, each one count byte long
+  size_t game_info = 5;
+  for (int table = 0; table < 5; ++table)
+  {
+    ASSERT_LT(static_cast<u8>(data[game_info]), 0x80);
+    game_info += 1 + static_cast<u8>(data[game_info]);
+  }
+
+  // Far more field widths than there are bytes in the file
+  std::string corrupt = data;
+  corrupt.replace(5, 1, "\xff\xff\xff\xff\x0f");
+  ASSERT_TRUE(File::WriteStringToFile(path, corrupt));
+  EXPECT_EQ(StatFile::read(path, *decoded), StatFile::ReadResult::Invalid);
+
+  // A GameInfo chunk that ends before its fields do
+  size_t size_end = game_info + 1;
+  while (static_cast<u8>(data[size_end]) & 0x80)
+    ++size_end;
+  corrupt = data;
+  corrupt.replace(game_info + 1, size_end - game_info, "\x04");
+  ASSERT_TRUE(File::WriteStringToFile(path, corrupt));
+  EXPECT_EQ(StatFile::read(path, *decoded), StatFile::ReadResult::Invalid);
+}
@@ -0,0 +1,150 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Common/FileUtil.h"
+#include "Core/TrackerHUDStream.h"
+
+namespace
+{
+class TrackerHUDStreamTest : public testing::Test
+{
+protected:
+  TrackerHUDStreamTest() : m_dir(File::CreateTempDir()), m_path(m_dir + "/hud.stream") {}
+  ~TrackerHUDStreamTest() override { File::DeleteDirRecursively(m_dir); }
+
+  static TrackerHUDStream::State MakeState(u16 event_num)
+  {
+    TrackerHUDStream::State state{};
+    state.game_id = 0x12345678;
+    state.event_num = event_num;
+    state.inning = 1;
+    state.batter_roster_loc = event_num % 9;
+    state.runners[0] = state.batter_roster_loc;
+    state.runners[1] = TrackerHUDStream::cNoRunner;
+    state.runners[2] = TrackerHUDStream::cNoRunner;
+    state.runners[3] = TrackerHUDStream::cNoRunner;
+    return state;
+  }
+
+  std::string m_dir;
+  std::string m_path;
+};
+}  // namespace
+
+TEST_F(TrackerHUDStreamTest, PublishAndReadLatest)
+{
+  TrackerHUDStream stream;
+  ASSERT_TRUE(stream.open(m_path));
+
+  TrackerHUDStream::Reader reader;
+  ASSERT_TRUE(reader.open(m_path));
+  EXPECT_FALSE(reader.readLatest().has_value());
+
+  const TrackerHUDStream::State first = MakeState(0);
+  stream.publish(first);
+  std::optional<TrackerHUDStream::Record> record = reader.readLatest();
+  ASSERT_TRUE(record.has_value());
+  EXPECT_EQ(record->state, first);
+  EXPECT_EQ(record->changed, ~0u);
+
+  // Same event, play is over and the score moved
+  TrackerHUDStream::State second = first;
+  second.phase = 1;
+  second.home_score = 2;
+  stream.publish(second);
+  record = reader.readLatest();
+  ASSERT_TRUE(record.has_value());
+  EXPECT_EQ(reader.getSequence(), 2u);
+  EXPECT_EQ(record->state, second);
+  EXPECT_EQ(record->changed, TrackerHUDStream::Event | TrackerHUDStream::Score);
+
+  // Nothing changed
+  stream.publish(second);
+  record = reader.readLatest();
+  ASSERT_TRUE(record.has_value());
+  EXPECT_EQ(record->changed, 0u);
+}
+
+TEST_F(TrackerHUDStreamTest, RejectsForeignFile)
+{
+  ASSERT_TRUE(File::WriteStringToFile(m_path, std::string(4096, 'x')));
+  TrackerHUDStream::Reader reader;
+  EXPECT_FALSE(reader.open(m_path));
+  EXPECT_FALSE(reader.open(m_dir + "/missing.stream"));
+}
+
+TEST_F(TrackerHUDStreamTest, OverwrittenRecordsAreUnreadable)
+{
+  TrackerHUDStream stream;
+  ASSERT_TRUE(stream.open(m_path));
+  TrackerHUDStream::Reader reader;
+  ASSERT_TRUE(reader.open(m_path));
+
+  const u16 published = TrackerHUDStream::cSlotCount + 10;
+  for (u16 event_num = 0; event_num < published; ++event_num)
+    stream.publish(MakeState(event_num));
+
+  EXPECT_EQ(reader.getSequence(), published);
+  EXPECT_FALSE(reader.read(0).has_value());
+  EXPECT_FALSE(reader.read(10).has_value());
+  EXPECT_FALSE(reader.read(published + 1).has_value());
+  for (u64 sequence = 11; sequence <= published; ++sequence)
+  {
+    const std::optional<TrackerHUDStream::Record> record = reader.read(sequence);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->state.event_num, sequence - 1);
+  }
+
+  // A new session starts the sequence over
+  TrackerHUDStream next_session;
+  ASSERT_TRUE(next_session.open(m_path));
+  EXPECT_EQ(reader.getSequence(), 0u);
+  EXPECT_FALSE(reader.readLatest().has_value());
+}
+
+TEST_F(TrackerHUDStreamTest, ConcurrentReaderSeesNoTornRecords)
+{
+  TrackerHUDStream stream;
+  ASSERT_TRUE(stream.open(m_path));
+
+  constexpr u16 published = 20000;
+  std::atomic<bool> ready = false;
+  std::atomic<bool> done = false;
+  u64 reads = 0;
+  u64 torn = 0;
+  std::thread overlay([&] {
+    TrackerHUDStream::Reader reader;
+    const bool opened = reader.open(m_path);
+    ready.store(true, std::memory_order_release);
+    if (!opened)
+      return;
+    // One last read after the writer is done, so there is always something to check
+    for (bool last = false; !last;)
+    {
+      last = done.load(std::memory_order_acquire);
+      const std::optional<TrackerHUDStream::Record> record = reader.readLatest();
+      if (!record)
+        continue;
+      ++reads;
+      if (record->state != MakeState(record->state.event_num))
+        ++torn;
+    }
+  });
+
+  while (!ready.load(std::memory_order_acquire))
+    std::this_thread::yield();
+  for (u16 event_num = 0; event_num < published; ++event_num)
+    stream.publish(MakeState(event_num));
+  done.store(true, std::memory_order_release);
+  overlay.join();
+
+  EXPECT_GT(reads, 0u);
+  EXPECT_EQ(torn, 0u);
+}
@@ -0,0 +1,296 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Common/Swap.h"
+#include "Core/Config/MainSettings.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/MSB_StatTracker.h"
+#include "Core/PowerPC/MMU.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/System.h"
+#include "Core/TrackerReadPlan.h"
+#include "UICommon/UICommon.h"
+
+TEST(TrackerReadPlan, MergesNearbyRanges)
+{
+  TrackerReadPlan plan;
+  plan.add(0x80001010, 4);
+  plan.add(0x80001000, 1);
+  plan.addTable(0x80002000, 2, 0x10, 3);
+  plan.add(0x80001000 + 0x14 + TrackerReadPlan::cMaxSpanGap, 1);
+  // Outside of MEM1, left to the MMU
+  plan.add(0x7FFFFFFF, 1);
+  plan.add(0xCC006000, 4);
+  plan.build();
+
+  const std::vector<TrackerReadPlan::Span>& spans = plan.getSpans();
+  ASSERT_EQ(spans.size(), 2u);
+  EXPECT_EQ(spans[0].adr, 0x80001000u);
+  EXPECT_EQ(spans[0].size, 0x15u + TrackerReadPlan::cMaxSpanGap);
+  EXPECT_EQ(spans[0].offset, 0u);
+  EXPECT_EQ(spans[1].adr, 0x80002000u);
+  EXPECT_EQ(spans[1].size, 0x22u);
+  EXPECT_EQ(spans[1].offset, spans[0].size);
+  EXPECT_EQ(plan.getSnapshotSize(), spans[0].size + spans[1].size);
+}
+
+TEST(TrackerReadPlan, ServesBigEndianValues)
+{
+  std::vector<u8> mem1(Memory::MEM1_SIZE_RETAIL);
+  const u8 bytes[] = {0x12, 0x34, 0x56, 0x78};
+  std::copy(std::begin(bytes), std::end(bytes), mem1.begin() + 0x1000);
+
+  TrackerReadPlan plan;
+  plan.add(0x80001000, 4);
+  plan.build();
+
+  EXPECT_FALSE(plan.tryRead<u8>(0x80001000));
+  ASSERT_TRUE(plan.capture(mem1.data(), static_cast<u32>(mem1.size())));
+
+  EXPECT_EQ(plan.tryRead<u8>(0x80001000), 0x12u);
+  EXPECT_EQ(plan.tryRead<u16>(0x80001002), 0x5678u);
+  EXPECT_EQ(plan.tryRead<u32>(0x80001000), 0x12345678u);
+
+  // Not (fully) covered by the snapshot
+  EXPECT_FALSE(plan.tryRead<u32>(0x80001002));
+  EXPECT_FALSE(plan.tryRead<u8>(0x80000FFF));
+  EXPECT_FALSE(plan.tryRead<u8>(0x80001004));
+
+  // The snapshot only reflects memory at the time of the capture
+  mem1[0x1000] = 0xAB;
+  EXPECT_EQ(plan.tryRead<u8>(0x80001000), 0x12u);
+  ASSERT_TRUE(plan.capture(mem1.data(), static_cast<u32>(mem1.size())));
+  EXPECT_EQ(plan.tryRead<u8>(0x80001000), 0xABu);
+
+  plan.invalidate();
+  EXPECT_FALSE(plan.tryRead<u8>(0x80001000));
+}
+
+TEST(TrackerReadPlan, RejectsShortMemory)
+{
+  std::vector<u8> mem1(0x1000);
+
+  TrackerReadPlan plan;
+  plan.add(0x80000FFE, 4);
+  plan.build();
+
+  EXPECT_FALSE(plan.capture(mem1.data(), static_cast<u32>(mem1.size())));
+  EXPECT_FALSE(plan.isValid());
+  EXPECT_FALSE(plan.tryRead<u16>(0x80000FFE));
+}
+
+namespace
+{
+// Sets up MEM1 and the default GameCube BATs, which is all HostRead needs to translate the
+// tracker's addresses.
+class TrackerReadPlanBenchmark : public testing::Test
+{
+protected:
+  TrackerReadPlanBenchmark()
+      : m_system(Core::System::GetInstance()), m_profile_path(File::CreateTempDir())
+  {
+    if (!UserDirectoryExists())
+      return;
+
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    m_system.GetMemory().Init();
+    m_system.GetPowerPC().Init(PowerPC::CPUCore::Interpreter);
+
+    auto& ppc_state = m_system.GetPPCState();
+    ppc_state.spr[SPR_DBAT0U] = 0x80001fff;
+    ppc_state.spr[SPR_DBAT0L] = 0x00000002;
+    ppc_state.spr[SPR_DBAT1U] = 0xc0001fff;
+    ppc_state.spr[SPR_DBAT1L] = 0x0000002a;
+    ppc_state.msr.DR = 1;
+    m_system.GetMMU().DBATUpdated();
+
+    u8* ram = m_system.GetMemory().GetRAM();
+    for (u32 i = 0; i < m_system.GetMemory().GetRamSizeReal(); ++i)
+      ram[i] = static_cast<u8>(i * 7);
+  }
+  ~TrackerReadPlanBenchmark() override
+  {
+    if (!UserDirectoryExists())
+      return;
+
+    m_system.GetPowerPC().Shutdown();
+    m_system.GetMemory().Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  bool UserDirectoryExists() const { return !m_profile_path.empty(); }
+
+  Core::System& m_system;
+  std::string m_profile_path;
+};
+
+u32 ReadField(const Core::CPUThreadGuard& guard, const TrackerReadPlan& plan, u32 adr, u32 size)
+{
+  switch (size)
+  {
+  case 1:
+    return plan.read<u8>(guard, adr);
+  case 2:
+    return plan.read<u16>(guard, adr);
+  default:
+    return plan.read<u32>(guard, adr);
+  }
+}
+}  // namespace
+
+TEST_F(TrackerReadPlanBenchmark, AgainstPerFieldReads)
+{
+  if (!UserDirectoryExists())
+    GTEST_SKIP() << "Could not create a user directory";
+
+  const Core::CPUThreadGuard guard(m_system);
+  // The plan the stat tracker builds for itself, so the benchmark covers the same fields
+  // RunRioFunctions samples every frame.
+  const auto tracker = std::make_unique<StatTracker>();
+  TrackerReadPlan& plan = tracker->m_read_plan;
+  const auto& fields = plan.getRanges();
+  ASSERT_FALSE(fields.empty());
+
+  // Without a snapshot every read goes through the MMU, which is what the tracker used to do
+  plan.invalidate();
+  u64 expected = 0;
+  for (const auto& [adr, size] : fields)
+    expected += ReadField(guard, plan, adr, size);
+
+  ASSERT_TRUE(plan.capture(guard));
+  u64 snapshot = 0;
+  for (const auto& [adr, size] : fields)
+  {
+    EXPECT_TRUE(plan.tryRead<u8>(adr)) << fmt::format("{:08x}", adr);
+    snapshot += ReadField(guard, plan, adr, size);
+  }
+  EXPECT_EQ(snapshot, expected);
+
+  constexpr int FRAMES = 2000;
+  const auto measure = [&](bool use_plan) {
+    u64 sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < FRAMES; ++frame)
+    {
+      if (use_plan)
+        plan.capture(guard);
+      else
+        plan.invalidate();
+
+      for (const auto& [adr, size] : fields)
+        sum += ReadField(guard, plan, adr, size);
+    }
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(sum, expected * FRAMES);
+    return elapsed.count() / FRAMES;
+  };
+
+  const double per_field_us = measure(false);
+  const double plan_us = measure(true);
+  fmt::print("{} fields in {} spans ({} bytes): per-field reads {:.2f}us/frame, "
+             "read plan {:.2f}us/frame ({:.1f}x)\n",
+             fields.size(), plan.getSpans().size(), plan.getSnapshotSize(), per_field_us, plan_us,
+             per_field_us / plan_us);
+}
+
+TEST_F(TrackerReadPlanBenchmark, EventDrivenIdleFrames)
+{
+  if (!UserDirectoryExists())
+    GTEST_SKIP() << "Could not create a user directory";
+
+  const Core::CPUThreadGuard guard(m_system);
+  const auto tracker = std::make_unique<StatTracker>();
+  tracker->init();
+
+  u8* ram = m_system.GetMemory().GetRAM();
+  const auto write_u8 = [&](u32 adr, u8 value) { ram[adr - Memory::MEM1_BASE_ADDR] = value; };
+  const u32 game_id = Common::swap32(0x12345678);
+  std::memcpy(&ram[aGameId - Memory::MEM1_BASE_ADDR], &game_id, sizeof(game_id));
+  for (u32 adr : {aGameControlStateCurr, aGameControlStatePrev, aEndOfGameFlag, aAB_PitchThrown,
+                  aAB_PickoffAttempt})
+  {
+    write_u8(adr, 0);
+  }
+
+  // Between two pitches, which is where most of a game is spent
+  tracker->m_game_state = GAME_STATE::INGAME;
+  tracker->m_event_state = EVENT_STATE::WAITING_FOR_EVENT;
+  tracker->m_event_state_prev = EVENT_STATE::WAITING_FOR_EVENT;
+  tracker->m_game_info.current_event.emplace();
+  tracker->m_game_info.update_ongoing_game = false;
+
+  constexpr int FRAMES = 2000;
+  const auto measure = [&](bool event_driven) {
+    Config::SetCurrent(Config::MAIN_STAT_TRACKER_EVENT_DRIVEN, event_driven);
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < FRAMES; ++frame)
+      tracker->Run(guard);
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(tracker->m_event_state, EVENT_STATE::WAITING_FOR_EVENT);
+    return elapsed.count() / FRAMES;
+  };
+
+  const double polling_us = measure(false);
+  const double event_driven_us = measure(true);
+  fmt::print("Idle frame: polling {:.3f}us, event driven {:.3f}us ({:.1f}x)\n", polling_us,
+             event_driven_us, polling_us / event_driven_us);
+
+  // Pausing is picked up on the very next frame, and the new state is waited on again after that
+  write_u8(aGameControlStateCurr, 0xb);
+  tracker->Run(guard);
+  EXPECT_EQ(tracker->m_event_state, EVENT_STATE::INIT_EVENT);
+  tracker->Run(guard);
+  EXPECT_EQ(tracker->m_waiting_states,
+            std::make_optional(std::pair{GAME_STATE::INGAME, EVENT_STATE::INIT_EVENT}));
+
+  // So is a state change from outside of Run
+  tracker->init();
+  tracker->Run(guard);
+  EXPECT_EQ(tracker->m_game_state, GAME_STATE::PREGAME);
+  EXPECT_EQ(tracker->m_waiting_states,
+            std::make_optional(std::pair{GAME_STATE::PREGAME, EVENT_STATE::INIT_EVENT}));
+
+  Config::SetCurrent(Config::MAIN_STAT_TRACKER_EVENT_DRIVEN, false);
+}
+
+// Replays record the game the same way, they only don't submit it
+TEST_F(TrackerReadPlanBenchmark, ReplayTrackerReadsInBulk)
+{
+  if (!UserDirectoryExists())
+    GTEST_SKIP() << "Could not create a user directory";
+
+  const Core::CPUThreadGuard guard(m_system);
+  const auto online = std::make_unique<StatTracker>();
+  const auto replay = std::make_unique<StatTracker>(StatTracker::Mode::NoSubmit);
+  EXPECT_EQ(replay->m_submitter, nullptr);
+
+  EXPECT_EQ(replay->m_read_plan.getRanges(), online->m_read_plan.getRanges());
+  EXPECT_EQ(replay->m_trigger_plan.getRanges(), online->m_trigger_plan.getRanges());
+  EXPECT_TRUE(replay->m_read_plan.capture(guard));
+  EXPECT_TRUE(replay->m_trigger_plan.capture(guard));
+}
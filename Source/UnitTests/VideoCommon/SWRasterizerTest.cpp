@@ -0,0 +1,369 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Core/System.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace
+{
+constexpr size_t EFB_SIZE = EFB_WIDTH * EFB_HEIGHT * 6;
+constexpr u32 NUM_THREADS = 4;
+
+// Registers that make a pixel read what the pixel drawn before it left behind
+enum class Carry
+{
+  None,
+  AddPrev,
+  MissingIndirectStage,
+  MissingColorChannel,
+  TexColorBeforeTexture,
+};
+
+struct DrawCall
+{
+  std::array<u8, sizeof(BPMemory)> bpmem;
+  std::vector<OutputVertexData> vertices;
+};
+
+// Written as raw registers like BP loads do, as the units are views of interleaved registers
+void SetTexUnit(u32 texmap, const TexMode0& mode0, const TexImage0& image0,
+                const TexImage1& image1, const TexImage2& image2, const TexTLUT& tlut)
+{
+  using Register = TexUnitAddress::Register;
+  const auto set = [texmap](Register reg, u32 value) {
+    bpmem.tex.AllRegisters[TexUnitAddress(texmap, reg).FullAddress] = value;
+  };
+  set(Register::SETMODE0, mode0.hex);
+  set(Register::SETIMAGE0, image0.hex);
+  set(Register::SETIMAGE1, image1.hex);
+  set(Register::SETIMAGE2, image2.hex);
+  set(Register::SETTLUT, tlut.hex);
+}
+
+bool IsValidRasColorChan(RasColorChan chan)
+{
+  return chan <= RasColorChan::Color1 || chan >= RasColorChan::AlphaBump;
+}
+}  // namespace
+
+class SWRasterizerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    std::memcpy(m_saved_bpmem.data(), &bpmem, sizeof(bpmem));
+    m_saved_threads = g_Config.iSWRasterizerThreads;
+    m_efb = EfbInterface::GetPixelPointer(0, 0, false);
+  }
+
+  void TearDown() override
+  {
+    Rasterizer::Shutdown();
+    g_Config.iSWRasterizerThreads = m_saved_threads;
+    std::memcpy(&bpmem, m_saved_bpmem.data(), sizeof(bpmem));
+  }
+
+  // A random state that only uses valid register values, as the scalar path alerts on the others
+  static void RandomizeState(std::mt19937& rng, Carry carry)
+  {
+    std::memset(reinterpret_cast<u8*>(&bpmem), 0, sizeof(bpmem));
+    bpmem.genMode.numtevstages = rng() % 4;
+    bpmem.genMode.numindstages = rng() % 5;
+    bpmem.genMode.numtexgens = 1 + rng() % 8;
+    bpmem.genMode.numcolchans = rng() % 3;
+
+    for (auto& combiner : bpmem.combiners)
+    {
+      combiner.colorC.hex = rng() & 0xffffff;
+      combiner.alphaC.hex = rng() & 0xffffff;
+    }
+
+    for (auto& order : bpmem.tevorders)
+    {
+      order.hex = rng() & 0xffffff;
+      if (!IsValidRasColorChan(order.colorchan_even))
+        order.colorchan_even = RasColorChan::Zero;
+      if (!IsValidRasColorChan(order.colorchan_odd))
+        order.colorchan_odd = RasColorChan::Zero;
+    }
+
+    for (auto& ksel : bpmem.tevksel.ksel)
+      ksel.hex = rng() & 0xffffff;
+
+    for (auto& indirect : bpmem.tevind)
+    {
+      indirect.hex = rng() & 0xfffff;
+      if (indirect.matrix_id == IndMtxId(3) || indirect.matrix_index == IndMtxIndex::Off)
+        indirect.matrix_id = IndMtxId::Indirect;
+      if (indirect.sw == IndTexWrap(7))
+        indirect.sw = IndTexWrap::ITW_OFF;
+      if (indirect.tw == IndTexWrap(7))
+        indirect.tw = IndTexWrap::ITW_OFF;
+    }
+
+    for (auto& matrix : bpmem.indmtx)
+    {
+      matrix.col0.hex = rng() & 0xffffff;
+      matrix.col1.hex = rng() & 0xffffff;
+      matrix.col2.hex = rng() & 0xffffff;
+    }
+    bpmem.tevindref.hex = rng() & 0xffffff;
+    bpmem.texscale[0].hex = rng() & 0xffffff;
+    bpmem.texscale[1].hex = rng() & 0xffffff;
+
+    for (u32 texmap = 0; texmap < 8; texmap++)
+    {
+      TexMode0 mode0;
+      mode0.hex = rng() & 0xffffff;
+      if (mode0.wrap_s == WrapMode(3))
+        mode0.wrap_s = WrapMode::Clamp;
+      if (mode0.wrap_t == WrapMode(3))
+        mode0.wrap_t = WrapMode::Clamp;
+      TexImage0 image0;
+      image0.hex = 0;
+      image0.width = rng() % 64;
+      image0.height = rng() % 64;
+      image0.format = rng() & 1 ? TextureFormat::RGBA8 : TextureFormat::IA8;
+      // The data of every mip level stays within TMEM
+      TexImage1 image1;
+      image1.hex = 0;
+      image1.tmem_even = rng() % 0x4000;
+      image1.cache_manually_managed = true;
+      TexImage2 image2;
+      image2.hex = 0;
+      image2.tmem_odd = rng() % 0x4000;
+      TexTLUT tlut;
+      tlut.hex = 0;
+      SetTexUnit(texmap, mode0, image0, image1, image2, tlut);
+    }
+
+    bpmem.alpha_test.hex = rng() & 0xffffff;
+    bpmem.ztex1.bias = rng() & 0xffffff;
+    bpmem.ztex2.hex = rng() & 0xf;
+    if (bpmem.ztex2.type == ZTexFormat(3))
+      bpmem.ztex2.type = ZTexFormat::U24;
+
+    bpmem.zmode.hex = rng() & 0x1f;
+    bpmem.zcontrol.pixel_format = PixelFormat(rng() % 3);
+    bpmem.zcontrol.early_ztest = rng() & 1;
+    bpmem.blendmode.hex = rng() & 0xffff;
+    bpmem.dstalpha.hex = rng() & 0x1ff;
+
+    // Every pixel is in the one scissor rectangle
+    bpmem.scissorBR.x = EFB_WIDTH - 1;
+    bpmem.scissorBR.y = EFB_HEIGHT - 1;
+
+    // Nothing reads what the pixel before left behind, unless the draw is meant to
+    for (auto& indirect : bpmem.tevind)
+    {
+      indirect.fb_addprev = false;
+      indirect.bt = rng() % 4;
+      if (indirect.bt >= bpmem.genMode.numindstages)
+      {
+        indirect.matrix_index = IndMtxIndex::Off;
+        indirect.matrix_id = IndMtxId::Indirect;
+        indirect.bs = IndTexBumpAlpha::Off;
+      }
+    }
+    const auto rasterized = [](RasColorChan chan) {
+      const bool exists = chan > RasColorChan::Color1 || u32(chan) < bpmem.genMode.numcolchans;
+      return exists ? chan : RasColorChan::Zero;
+    };
+    for (auto& order : bpmem.tevorders)
+    {
+      order.colorchan_even = rasterized(order.colorchan_even);
+      order.colorchan_odd = rasterized(order.colorchan_odd);
+    }
+    bpmem.tevorders[0].enable_tex_even = true;
+
+    if (carry == Carry::None)
+      return;
+
+    // A single stage that shows its texture color, drawn over everything
+    bpmem.genMode.numtevstages = 0;
+    bpmem.combiners[0].colorC.hex = 0;
+    bpmem.combiners[0].colorC.d = TevColorArg::TexColor;
+    bpmem.combiners[0].alphaC.hex = 0;
+    bpmem.combiners[0].alphaC.d = TevAlphaArg::TexAlpha;
+    bpmem.alpha_test.comp0 = CompareMode::Always;
+    bpmem.alpha_test.comp1 = CompareMode::Always;
+    bpmem.zmode.testenable = false;
+    bpmem.blendmode.hex = 0;
+    bpmem.blendmode.colorupdate = true;
+    bpmem.blendmode.alphaupdate = true;
+    bpmem.ztex2.op = ZTexOp::Disabled;
+
+    switch (carry)
+    {
+    case Carry::AddPrev:
+      bpmem.tevind[0].fb_addprev = true;
+      break;
+    case Carry::MissingIndirectStage:
+      bpmem.genMode.numindstages = 1;
+      bpmem.tevind[0].bt = 3;
+      bpmem.tevind[0].matrix_index = IndMtxIndex::Matrix0;
+      bpmem.tevind[0].bs = IndTexBumpAlpha::S;
+      break;
+    case Carry::MissingColorChannel:
+      bpmem.genMode.numcolchans = 1;
+      bpmem.tevorders[0].colorchan_even = RasColorChan::Color1;
+      bpmem.combiners[0].colorC.d = TevColorArg::RasColor;
+      bpmem.combiners[0].alphaC.d = TevAlphaArg::RasAlpha;
+      break;
+    case Carry::TexColorBeforeTexture:
+      bpmem.tevorders[0].enable_tex_even = false;
+      break;
+    default:
+      break;
+    }
+  }
+
+  static DrawCall MakeDraw(std::mt19937& rng, Carry carry, size_t triangles)
+  {
+    RandomizeState(rng, carry);
+
+    DrawCall draw;
+    std::memcpy(draw.bpmem.data(), &bpmem, sizeof(bpmem));
+
+    // Triangles of different sizes that overlap each other and cross tiles
+    std::uniform_real_distribution<float> position(-0.2f, 1.2f);
+    std::uniform_real_distribution<float> offset(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> z(0.0f, 16777215.0f);
+    std::uniform_real_distribution<float> w(0.5f, 2.0f);
+    std::uniform_real_distribution<float> uv(-64.0f, 64.0f);
+    for (size_t i = 0; i < triangles; i++)
+    {
+      const float x = position(rng) * EFB_WIDTH;
+      const float y = position(rng) * EFB_HEIGHT;
+      for (int j = 0; j < 3; j++)
+      {
+        OutputVertexData vertex;
+        vertex.screenPosition = {x + offset(rng), y + offset(rng), z(rng)};
+        vertex.projectedPosition.w = w(rng);
+        for (auto& color : vertex.color)
+        {
+          for (u8& component : color)
+            component = rng();
+        }
+        for (auto& coord : vertex.texCoords)
+          coord = {uv(rng), uv(rng), 1.0f};
+        draw.vertices.push_back(vertex);
+      }
+    }
+
+    EXPECT_EQ(carry != Carry::None, Tev::DependsOnPixelOrder());
+    return draw;
+  }
+
+  std::vector<u8> Render(u32 threads, const std::vector<DrawCall>& draws)
+  {
+    g_Config.iSWRasterizerThreads = threads;
+    Rasterizer::Init();
+    std::memcpy(m_efb, m_initial_efb.data(), EFB_SIZE);
+
+    for (const DrawCall& draw : draws)
+    {
+      std::memcpy(&bpmem, draw.bpmem.data(), sizeof(bpmem));
+      Rasterizer::ScissorChanged();
+      Rasterizer::SetTevKonstColors();
+      for (size_t i = 0; i < draw.vertices.size(); i += 3)
+      {
+        Rasterizer::DrawTriangleFrontFace(&draw.vertices[i], &draw.vertices[i + 1],
+                                          &draw.vertices[i + 2]);
+      }
+      Rasterizer::Flush();
+    }
+
+    return std::vector<u8>(m_efb, m_efb + EFB_SIZE);
+  }
+
+  void RandomizeMemory(std::mt19937& rng)
+  {
+    for (u8& value : texMem)
+      value = rng();
+
+    auto& constants = Core::System::GetInstance().GetPixelShaderManager().constants;
+    for (int i = 0; i < 4; i++)
+    {
+      for (int j = 0; j < 4; j++)
+      {
+        constants.colors[i][j] = static_cast<s32>(rng() % 2048) - 1024;
+        constants.kcolors[i][j] = rng() % 256;
+      }
+    }
+
+    m_initial_efb.resize(EFB_SIZE);
+    for (u8& value : m_initial_efb)
+      value = rng();
+  }
+
+  std::array<u8, sizeof(BPMemory)> m_saved_bpmem;
+  int m_saved_threads = 0;
+  u8* m_efb = nullptr;
+  std::vector<u8> m_initial_efb;
+};
+
+TEST_F(SWRasterizerTest, TilesMatchOneThread)
+{
+  for (u32 seed = 0; seed < 10; seed++)
+  {
+    std::mt19937 rng(seed);
+    RandomizeMemory(rng);
+    std::vector<DrawCall> draws;
+    for (int i = 0; i < 3; i++)
+      draws.push_back(MakeDraw(rng, Carry::None, 40));
+
+    EXPECT_TRUE(Render(1, draws) == Render(NUM_THREADS, draws)) << "seed " << seed;
+  }
+}
+
+// The draws that can't be drawn by tiles carry on from the last pixel of the draw before them
+TEST_F(SWRasterizerTest, CarriedValuesMatchOneThread)
+{
+  for (Carry carry : {Carry::AddPrev, Carry::MissingIndirectStage, Carry::MissingColorChannel,
+                      Carry::TexColorBeforeTexture})
+  {
+    for (u32 seed = 0; seed < 5; seed++)
+    {
+      std::mt19937 rng(seed);
+      RandomizeMemory(rng);
+      std::vector<DrawCall> draws;
+      for (int i = 0; i < 2; i++)
+      {
+        draws.push_back(MakeDraw(rng, Carry::None, 20));
+        draws.push_back(MakeDraw(rng, carry, 1 + rng() % 20));
+      }
+
+      EXPECT_TRUE(Render(1, draws) == Render(NUM_THREADS, draws))
+          << "carry " << static_cast<int>(carry) << ", seed " << seed;
+    }
+  }
+}
+
+// Starting the threads again doesn't wake them up before there is work
+TEST_F(SWRasterizerTest, RestartsThreads)
+{
+  std::mt19937 rng(0);
+  RandomizeMemory(rng);
+  const std::vector<DrawCall> draws = {MakeDraw(rng, Carry::None, 20)};
+
+  const std::vector<u8> expected = Render(1, draws);
+  for (int i = 0; i < 5; i++)
+    EXPECT_TRUE(expected == Render(NUM_THREADS, draws)) << "start " << i;
+}
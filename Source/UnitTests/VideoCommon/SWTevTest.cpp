@@ -0,0 +1,442 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Core/System.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoBackends/Software/TevSIMD.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace
+{
+constexpr size_t EFB_SIZE = EFB_WIDTH * EFB_HEIGHT * 6;
+
+struct PixelInput
+{
+  s32 position[3];
+  u8 color[2][4];
+  s32 uv[8][2];
+  s32 indirect_lod[4];
+  bool indirect_linear[4];
+  s32 texture_lod[16];
+  bool texture_linear[16];
+};
+
+// Written as raw registers like BP loads do, as the units are views of interleaved registers
+void SetTexUnit(u32 texmap, const TexMode0& mode0, const TexImage0& image0,
+                const TexImage1& image1, const TexImage2& image2, const TexTLUT& tlut)
+{
+  using Register = TexUnitAddress::Register;
+  const auto set = [texmap](Register reg, u32 value) {
+    bpmem.tex.AllRegisters[TexUnitAddress(texmap, reg).FullAddress] = value;
+  };
+  set(Register::SETMODE0, mode0.hex);
+  set(Register::SETIMAGE0, image0.hex);
+  set(Register::SETIMAGE1, image1.hex);
+  set(Register::SETIMAGE2, image2.hex);
+  set(Register::SETTLUT, tlut.hex);
+}
+
+bool IsValidRasColorChan(RasColorChan chan)
+{
+  return chan <= RasColorChan::Color1 || chan >= RasColorChan::AlphaBump;
+}
+
+bool IsPathSupported(TevSIMD::Path path)
+{
+  return path <= TevSIMD::GetBestPath();
+}
+
+const char* WorkloadName(int workload)
+{
+  static constexpr const char* names[] = {"combiners", "alpha test", "fog", "bilinear"};
+  return names[workload];
+}
+
+std::string PathName(TevSIMD::Path path)
+{
+  switch (path)
+  {
+  case TevSIMD::Path::SSE41:
+    return "SSE4.1";
+  case TevSIMD::Path::AVX2:
+    return "AVX2";
+  default:
+    return "scalar";
+  }
+}
+}  // namespace
+
+class SWTevTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    std::memcpy(m_saved_bpmem.data(), &bpmem, sizeof(bpmem));
+    std::memset(reinterpret_cast<u8*>(&bpmem), 0, sizeof(bpmem));
+    m_efb = EfbInterface::GetPixelPointer(0, 0, false);
+    xfmem.viewport.wd = 320;
+  }
+
+  void TearDown() override { std::memcpy(&bpmem, m_saved_bpmem.data(), sizeof(bpmem)); }
+
+  // A random state that only uses valid register values, as the scalar path alerts on the others
+  void RandomizeState(std::mt19937& rng)
+  {
+    bpmem.genMode.numtevstages = rng() % 16;
+    bpmem.genMode.numindstages = rng() % 5;
+    bpmem.genMode.numtexgens = rng() % 9;
+
+    for (auto& combiner : bpmem.combiners)
+    {
+      combiner.colorC.hex = rng() & 0xffffff;
+      combiner.alphaC.hex = rng() & 0xffffff;
+    }
+
+    for (auto& order : bpmem.tevorders)
+    {
+      order.hex = rng() & 0xffffff;
+      if (!IsValidRasColorChan(order.colorchan_even))
+        order.colorchan_even = RasColorChan::Zero;
+      if (!IsValidRasColorChan(order.colorchan_odd))
+        order.colorchan_odd = RasColorChan::Zero;
+    }
+
+    for (auto& ksel : bpmem.tevksel.ksel)
+      ksel.hex = rng() & 0xffffff;
+
+    for (auto& indirect : bpmem.tevind)
+    {
+      indirect.hex = rng() & 0x1fffff;
+      if (indirect.matrix_id == IndMtxId(3) || indirect.matrix_index == IndMtxIndex::Off)
+        indirect.matrix_id = IndMtxId::Indirect;
+      if (indirect.sw == IndTexWrap(7))
+        indirect.sw = IndTexWrap::ITW_OFF;
+      if (indirect.tw == IndTexWrap(7))
+        indirect.tw = IndTexWrap::ITW_OFF;
+    }
+
+    for (auto& matrix : bpmem.indmtx)
+    {
+      matrix.col0.hex = rng() & 0xffffff;
+      matrix.col1.hex = rng() & 0xffffff;
+      matrix.col2.hex = rng() & 0xffffff;
+    }
+    bpmem.tevindref.hex = rng() & 0xffffff;
+    bpmem.texscale[0].hex = rng() & 0xffffff;
+    bpmem.texscale[1].hex = rng() & 0xffffff;
+
+    static constexpr TextureFormat formats[] = {
+        TextureFormat::I4,     TextureFormat::I8,     TextureFormat::IA4,  TextureFormat::IA8,
+        TextureFormat::RGB565, TextureFormat::RGB5A3, TextureFormat::RGBA8, TextureFormat::C4,
+        TextureFormat::C8,     TextureFormat::C14X2,  TextureFormat::CMPR,
+    };
+    for (u32 texmap = 0; texmap < 8; texmap++)
+    {
+      TexMode0 mode0;
+      mode0.hex = rng() & 0xffffff;
+      if (mode0.wrap_s == WrapMode(3))
+        mode0.wrap_s = WrapMode::Clamp;
+      if (mode0.wrap_t == WrapMode(3))
+        mode0.wrap_t = WrapMode::Clamp;
+      TexImage0 image0;
+      image0.hex = 0;
+      image0.width = rng() % 64;
+      image0.height = rng() % 64;
+      image0.format = formats[rng() % std::size(formats)];
+      // The data of every mip level stays within TMEM
+      TexImage1 image1;
+      image1.hex = 0;
+      image1.tmem_even = rng() % 0x4000;
+      image1.cache_manually_managed = true;
+      TexImage2 image2;
+      image2.hex = 0;
+      image2.tmem_odd = rng() % 0x4000;
+      TexTLUT tlut;
+      tlut.hex = 0;
+      tlut.tmem_offset = rng() % 0x400;
+      tlut.tlut_format = TLUTFormat(rng() % 3);
+      SetTexUnit(texmap, mode0, image0, image1, image2, tlut);
+    }
+    for (u8& value : texMem)
+      value = rng();
+
+    bpmem.alpha_test.hex = rng() & 0xffffff;
+    bpmem.ztex1.bias = rng() & 0xffffff;
+    bpmem.ztex2.hex = rng() & 0xf;
+    if (bpmem.ztex2.type == ZTexFormat(3))
+      bpmem.ztex2.type = ZTexFormat::U24;
+
+    bpmem.fog.a.hex = rng() & 0x1fffff;
+    bpmem.fog.b_magnitude = rng() & 0xffffff;
+    bpmem.fog.b_shift = rng() % 24;
+    bpmem.fog.c_proj_fsel.hex = rng() & 0xffffff;
+    bpmem.fog.color.hex = rng() & 0xffffff;
+    bpmem.fogRange.Base.hex = rng() & 0x7ff;
+    for (auto& k : bpmem.fogRange.K)
+      k.HEX = rng() & 0xffffff;
+
+    bpmem.zmode.hex = rng() & 0x1f;
+    bpmem.zcontrol.pixel_format = PixelFormat(rng() % 3);
+    bpmem.zcontrol.early_ztest = rng() & 1;
+    bpmem.blendmode.hex = rng() & 0xffff;
+    bpmem.dstalpha.hex = rng() & 0x1ff;
+
+    auto& constants = Core::System::GetInstance().GetPixelShaderManager().constants;
+    for (int i = 0; i < 4; i++)
+    {
+      for (int j = 0; j < 4; j++)
+      {
+        constants.colors[i][j] = static_cast<s32>(rng() % 2048) - 1024;
+        constants.kcolors[i][j] = rng() % 256;
+      }
+    }
+
+    m_initial_efb.resize(EFB_SIZE);
+    for (u8& value : m_initial_efb)
+      value = rng();
+  }
+
+  // Every pixel once, so that the result does not depend on how they are batched
+  std::vector<PixelInput> MakePixels(std::mt19937& rng, size_t count)
+  {
+    std::vector<PixelInput> pixels(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      PixelInput& pixel = pixels[i];
+      pixel.position[0] = i % EFB_WIDTH;
+      pixel.position[1] = i / EFB_WIDTH;
+      pixel.position[2] = rng() & 0xffffff;
+      for (auto& color : pixel.color)
+      {
+        for (u8& component : color)
+          component = rng();
+      }
+      for (auto& uv : pixel.uv)
+      {
+        uv[0] = static_cast<s32>(rng() % 0x20000) - 0x10000;
+        uv[1] = static_cast<s32>(rng() % 0x20000) - 0x10000;
+      }
+      for (int j = 0; j < 4; j++)
+      {
+        pixel.indirect_lod[j] = rng() % 64;
+        pixel.indirect_linear[j] = rng() & 1;
+      }
+      for (int j = 0; j < 16; j++)
+      {
+        pixel.texture_lod[j] = rng() % 64;
+        pixel.texture_linear[j] = rng() & 1;
+      }
+    }
+    return pixels;
+  }
+
+  // Draws the pixels in batches, like the rasterizer does for its triangles
+  static void DrawPixels(Tev& tev, const std::vector<PixelInput>& pixels, size_t batch_size)
+  {
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+      const PixelInput& pixel = pixels[i];
+      std::copy_n(pixel.position, 3, tev.Position);
+      std::memcpy(tev.Color, pixel.color, sizeof(tev.Color));
+      for (int j = 0; j < 8; j++)
+      {
+        tev.Uv[j].s = pixel.uv[j][0];
+        tev.Uv[j].t = pixel.uv[j][1];
+      }
+      std::copy_n(pixel.indirect_lod, 4, tev.IndirectLod);
+      std::copy_n(pixel.indirect_linear, 4, tev.IndirectLinear);
+      std::copy_n(pixel.texture_lod, 16, tev.TextureLod);
+      std::copy_n(pixel.texture_linear, 16, tev.TextureLinear);
+      tev.Draw();
+
+      if (i % batch_size == batch_size - 1)
+        tev.Flush();
+    }
+    tev.Flush();
+  }
+
+  std::vector<u8> Render(TevSIMD::Path path, const std::vector<PixelInput>& pixels,
+                         size_t batch_size, u32* pixels_out)
+  {
+    std::memcpy(m_efb, m_initial_efb.data(), EFB_SIZE);
+    auto tev = std::make_unique<Tev>(path);
+    tev->SetKonstColors();
+    DrawPixels(*tev, pixels, batch_size);
+    *pixels_out = tev->PixelsOut;
+    return std::vector<u8>(m_efb, m_efb + EFB_SIZE);
+  }
+
+  std::array<u8, sizeof(BPMemory)> m_saved_bpmem;
+  u8* m_efb = nullptr;
+  std::vector<u8> m_initial_efb;
+};
+
+TEST_F(SWTevTest, VectorPathsMatchScalar)
+{
+  for (u32 seed = 0; seed < 200; seed++)
+  {
+    std::mt19937 rng(seed);
+    RandomizeState(rng);
+    const std::vector<PixelInput> pixels = MakePixels(rng, 256);
+    const size_t batch_size = 1 + rng() % 23;
+
+    u32 scalar_out;
+    const std::vector<u8> scalar = Render(TevSIMD::Path::Scalar, pixels, batch_size, &scalar_out);
+
+    for (TevSIMD::Path path : {TevSIMD::Path::SSE41, TevSIMD::Path::AVX2})
+    {
+      if (!IsPathSupported(path))
+        continue;
+
+      u32 vector_out;
+      const std::vector<u8> vector = Render(path, pixels, batch_size, &vector_out);
+      EXPECT_TRUE(scalar == vector) << PathName(path) << ", seed " << seed;
+      EXPECT_EQ(scalar_out, vector_out) << PathName(path) << ", seed " << seed;
+    }
+  }
+}
+
+enum class TevWorkload
+{
+  Combiners,
+  AlphaTest,
+  Fog,
+  Bilinear,
+};
+
+class SWTevSpeedTest : public SWTevTest,
+                       public testing::WithParamInterface<std::tuple<TevWorkload, TevSIMD::Path>>
+{
+protected:
+  void SetUpWorkload(TevWorkload workload)
+  {
+    bpmem.genMode.numtexgens = 1;
+    bpmem.zcontrol.pixel_format = PixelFormat::RGB8_Z24;
+    bpmem.blendmode.colorupdate = true;
+    bpmem.alpha_test.comp0 = CompareMode::Always;
+    bpmem.alpha_test.comp1 = CompareMode::Always;
+
+    // Modulates the rasterized color with a constant color in each stage
+    const u32 stages = workload == TevWorkload::Combiners ? 16 : 1;
+    bpmem.genMode.numtevstages = stages - 1;
+    for (u32 i = 0; i < stages; i++)
+    {
+      auto& cc = bpmem.combiners[i].colorC;
+      cc.a = TevColorArg::Zero;
+      cc.b = i == 0 ? TevColorArg::RasColor : TevColorArg::PrevColor;
+      cc.c = TevColorArg::Konst;
+      cc.d = TevColorArg::Zero;
+      cc.clamp = true;
+      auto& ac = bpmem.combiners[i].alphaC;
+      ac.a = TevAlphaArg::Zero;
+      ac.b = i == 0 ? TevAlphaArg::RasAlpha : TevAlphaArg::PrevAlpha;
+      ac.c = TevAlphaArg::Konst;
+      ac.d = TevAlphaArg::Zero;
+      ac.clamp = true;
+    }
+
+    switch (workload)
+    {
+    case TevWorkload::AlphaTest:
+      bpmem.alpha_test.comp0 = CompareMode::Greater;
+      bpmem.alpha_test.ref0 = 64;
+      bpmem.alpha_test.comp1 = CompareMode::Less;
+      bpmem.alpha_test.ref1 = 192;
+      bpmem.alpha_test.logic = AlphaTestOp::And;
+      break;
+    case TevWorkload::Fog:
+      bpmem.fog.c_proj_fsel.fsel = FogType::Exp;
+      bpmem.fog.c_proj_fsel.proj = FogProjection::Orthographic;
+      bpmem.fog.a.hex = 0x3f800;
+      bpmem.fog.color.hex = 0x808080;
+      break;
+    case TevWorkload::Bilinear:
+    {
+      bpmem.tevorders[0].enable_tex_even = true;
+      bpmem.combiners[0].colorC.b = TevColorArg::TexColor;
+      TexMode0 mode0;
+      mode0.hex = 0;
+      TexImage0 image0;
+      image0.hex = 0;
+      image0.width = 63;
+      image0.height = 63;
+      image0.format = TextureFormat::RGBA8;
+      TexImage1 image1;
+      image1.hex = 0;
+      image1.cache_manually_managed = true;
+      TexImage2 image2;
+      image2.hex = 0;
+      image2.tmem_odd = 0x4000;
+      TexTLUT tlut;
+      tlut.hex = 0;
+      SetTexUnit(0, mode0, image0, image1, image2, tlut);
+      break;
+    }
+    default:
+      break;
+    }
+
+    std::mt19937 rng(0);
+    auto& constants = Core::System::GetInstance().GetPixelShaderManager().constants;
+    for (auto& kcolor : constants.kcolors)
+    {
+      for (auto& component : kcolor)
+        component = 192 + rng() % 64;
+    }
+    for (u8& value : texMem)
+      value = rng();
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    AllWorkloads, SWTevSpeedTest,
+    testing::Combine(testing::Values(TevWorkload::Combiners, TevWorkload::AlphaTest,
+                                     TevWorkload::Fog, TevWorkload::Bilinear),
+                     testing::Values(TevSIMD::Path::Scalar, TevSIMD::Path::SSE41,
+                                     TevSIMD::Path::AVX2)));
+
+TEST_P(SWTevSpeedTest, PixelsPerSecond)
+{
+  const auto [workload, path] = GetParam();
+  if (!IsPathSupported(path))
+    GTEST_SKIP() << PathName(path) << " is not supported by this CPU";
+
+  SetUpWorkload(workload);
+  std::mt19937 rng(0);
+  std::vector<PixelInput> pixels = MakePixels(rng, EFB_WIDTH * EFB_HEIGHT);
+  for (PixelInput& pixel : pixels)
+  {
+    std::fill_n(pixel.texture_lod, 16, 0);
+    std::fill_n(pixel.texture_linear, 16, true);
+  }
+
+  auto tev = std::make_unique<Tev>(path);
+  tev->SetKonstColors();
+
+  constexpr int REPEATS = 4;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < REPEATS; i++)
+    DrawPixels(*tev, pixels, 64);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  fmt::print("{}, {} path: {:.1f} Mpixels/s\n", WorkloadName(static_cast<int>(workload)),
+             PathName(path), pixels.size() * REPEATS / elapsed.count() / 1e6);
+}
@@ -0,0 +1,120 @@
+// Copyright 2024 Dolphin Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "VideoCommon/StageTimings.h"
+
+using StageTimings::ScopedStage;
+using StageTimings::Stage;
+
+namespace
+{
+constexpr auto OUTER_TIME = std::chrono::milliseconds(10);
+constexpr auto INNER_TIME = std::chrono::milliseconds(40);
+constexpr u64 OUTER_TIME_NS = std::chrono::nanoseconds(OUTER_TIME).count();
+constexpr u64 INNER_TIME_NS = std::chrono::nanoseconds(INNER_TIME).count();
+
+u64 GetTime(Stage stage)
+{
+  return StageTimings::GetTotals()[static_cast<size_t>(stage)].time_ns;
+}
+
+u64 GetCalls(Stage stage)
+{
+  return StageTimings::GetTotals()[static_cast<size_t>(stage)].calls;
+}
+
+u64 NsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                              start)
+      .count();
+}
+}  // namespace
+
+class StageTimingsTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    StageTimings::Reset();
+    StageTimings::SetEnabled(true);
+  }
+  void TearDown() override
+  {
+    StageTimings::SetEnabled(false);
+    StageTimings::Reset();
+  }
+};
+
+TEST_F(StageTimingsTest, Disabled)
+{
+  StageTimings::SetEnabled(false);
+  {
+    ScopedStage timing(Stage::Decode);
+  }
+  EXPECT_EQ(GetCalls(Stage::Decode), 0u);
+  EXPECT_EQ(GetTime(Stage::Decode), 0u);
+}
+
+TEST_F(StageTimingsTest, CountsCalls)
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    ScopedStage timing(Stage::VertexLoad);
+  }
+  EXPECT_EQ(GetCalls(Stage::VertexLoad), 3u);
+  EXPECT_EQ(GetCalls(Stage::Decode), 0u);
+
+  StageTimings::Reset();
+  EXPECT_EQ(GetCalls(Stage::VertexLoad), 0u);
+}
+
+TEST_F(StageTimingsTest, NestedStagesAreExclusive)
+{
+  // Measured around the stages, so that a slow machine only makes both sides longer
+  u64 inner_ns;
+  const auto outer_start = std::chrono::steady_clock::now();
+  {
+    ScopedStage draw(Stage::DrawSubmit);
+    std::this_thread::sleep_for(OUTER_TIME);
+    const auto inner_start = std::chrono::steady_clock::now();
+    {
+      ScopedStage texture(Stage::TextureDecode);
+      std::this_thread::sleep_for(INNER_TIME);
+    }
+    inner_ns = NsSince(inner_start);
+  }
+  const u64 inclusive_ns = NsSince(outer_start);
+
+  EXPECT_EQ(GetCalls(Stage::DrawSubmit), 1u);
+  EXPECT_EQ(GetCalls(Stage::TextureDecode), 1u);
+  EXPECT_GE(GetTime(Stage::TextureDecode), INNER_TIME_NS);
+  EXPECT_LE(GetTime(Stage::TextureDecode), inner_ns);
+  EXPECT_GE(GetTime(Stage::DrawSubmit), OUTER_TIME_NS);
+  // The texture load is not counted twice, the stages add up to the time spent in both
+  EXPECT_LE(GetTime(Stage::DrawSubmit), inclusive_ns - GetTime(Stage::TextureDecode));
+}
+
+TEST_F(StageTimingsTest, SameStageNested)
+{
+  const auto start = std::chrono::steady_clock::now();
+  {
+    ScopedStage outer(Stage::Decode);
+    std::this_thread::sleep_for(OUTER_TIME);
+    {
+      ScopedStage inner(Stage::Decode);
+      std::this_thread::sleep_for(INNER_TIME);
+    }
+  }
+  const u64 inclusive_ns = NsSince(start);
+
+  EXPECT_EQ(GetCalls(Stage::Decode), 2u);
+  EXPECT_GE(GetTime(Stage::Decode), OUTER_TIME_NS + INNER_TIME_NS);
+  // Counting the inner call in the outer one as well would add INNER_TIME on top
+  EXPECT_LE(GetTime(Stage::Decode), inclusive_ns);
+}
@@ -1,11 +1,14 @@
 // Copyright 2014 Dolphin Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
 #include <limits>
 #include <memory>
+#include <random>
 #include <tuple>
 #include <type_traits>
 #include <unordered_set>
+#include <vector>
 
 #include <gtest/gtest.h>  // NOLINT
 
@@ -15,6 +18,7 @@
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/ParallelVertexLoader.h"
 #include "VideoCommon/VertexLoaderBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
 
@@ -367,6 +371,147 @@ TEST_F(VertexLoaderTest, LargeFloatVertexSpeed)
     RunVertices(100000);
 }
 
+class VertexLoaderParallelTest : public VertexLoaderTest, public ::testing::WithParamInterface<u32>
+{
+protected:
+  static constexpr u32 NUM_POSITIONS = 1024;
+  static constexpr u16 SKIPPED_POSITION = 0xFFFF;
+
+  // The vertices loaded along with the values kept for zfreeze and emboss texgens
+  struct LoadResult
+  {
+    int count = 0;
+    std::vector<u8> vertices;
+    std::vector<u8> caches;
+
+    bool operator==(const LoadResult&) const = default;
+  };
+
+  // Indexed positions, which can skip vertices, and everything that is cached by the loader
+  void CreateLoader()
+  {
+    m_vtx_desc.low.PosMatIdx = 1;
+    m_vtx_desc.low.Position = VertexComponentFormat::Index16;
+    m_vtx_desc.low.Normal = VertexComponentFormat::Direct;
+    m_vtx_desc.low.Color0 = VertexComponentFormat::Direct;
+    m_vtx_desc.high.Tex0Coord = VertexComponentFormat::Direct;
+    m_vtx_attr.g0.PosElements = CoordComponentCount::XYZ;
+    m_vtx_attr.g0.PosFormat = ComponentFormat::Float;
+    m_vtx_attr.g0.NormalElements = NormalComponentCount::NTB;
+    m_vtx_attr.g0.NormalFormat = ComponentFormat::Short;
+    m_vtx_attr.g0.Color0Elements = ColorComponentCount::RGBA;
+    m_vtx_attr.g0.Color0Comp = ColorFormat::RGBA8888;
+    m_vtx_attr.g0.Tex0CoordElements = TexComponentCount::ST;
+    m_vtx_attr.g0.Tex0CoordFormat = ComponentFormat::UShort;
+    CreateAndCheckSizes(1 + 2 + 9 * sizeof(s16) + 4 + 2 * sizeof(u16),
+                        sizeof(u32) + 3 * sizeof(float) + 9 * sizeof(float) + 4 +
+                            2 * sizeof(float));
+
+    m_positions.resize(NUM_POSITIONS * 3);
+    for (float& value : m_positions)
+      value = std::uniform_real_distribution<float>(-1000, 1000)(m_rng);
+    VertexLoaderManager::cached_arraybases[CPArray::Position] =
+        reinterpret_cast<u8*>(m_positions.data());
+    g_main_cp_state.array_strides[CPArray::Position] = 3 * sizeof(float);
+  }
+
+  // One in skip_one_in vertices is skipped, or none when it is 0
+  std::vector<u8> MakeVertices(int count, u32 skip_one_in = 0)
+  {
+    std::vector<u8> vertices(count * m_loader->m_vertex_size);
+    for (u8& byte : vertices)
+      byte = static_cast<u8>(m_rng());
+
+    for (int i = 0; i < count; i++)
+    {
+      u8* const vertex = vertices.data() + i * m_loader->m_vertex_size;
+      const bool skip = skip_one_in != 0 && m_rng() % skip_one_in == 0;
+      const u16 index = skip ? SKIPPED_POSITION : static_cast<u16>(m_rng() % NUM_POSITIONS);
+      vertex[1] = static_cast<u8>(index >> 8);
+      vertex[2] = static_cast<u8>(index);
+    }
+    return vertices;
+  }
+
+  template <typename LoadFunction>
+  LoadResult Load(int count, LoadFunction load)
+  {
+    VertexLoaderManager::position_cache = {};
+    VertexLoaderManager::position_matrix_index_cache = {};
+    VertexLoaderManager::tangent_cache = {};
+    VertexLoaderManager::binormal_cache = {};
+
+    // The loaders can write up to 4 bytes past the last vertex
+    std::vector<u8> vertices(count * m_loader->m_native_vtx_decl.stride + 4);
+    LoadResult result;
+    result.count = load(vertices.data());
+    vertices.resize(result.count * m_loader->m_native_vtx_decl.stride);
+    result.vertices = std::move(vertices);
+
+    const auto add_cache = [&result](const auto& cache) {
+      const u8* const bytes = reinterpret_cast<const u8*>(&cache);
+      result.caches.insert(result.caches.end(), bytes, bytes + sizeof(cache));
+    };
+    add_cache(VertexLoaderManager::position_cache);
+    add_cache(VertexLoaderManager::position_matrix_index_cache);
+    add_cache(VertexLoaderManager::tangent_cache);
+    add_cache(VertexLoaderManager::binormal_cache);
+    return result;
+  }
+
+  void ExpectSameAsSerial(ParallelVertexLoader& parallel_loader, const std::vector<u8>& src)
+  {
+    const int count = static_cast<int>(src.size() / m_loader->m_vertex_size);
+    const LoadResult expected = Load(
+        count, [&](u8* dst) { return m_loader->RunVertices(src.data(), dst, count); });
+    const LoadResult actual = Load(count, [&](u8* dst) {
+      return parallel_loader.RunVertices(m_loader.get(), src.data(), dst, count, nullptr);
+    });
+    EXPECT_EQ(expected.count, actual.count) << count << " vertices";
+    EXPECT_TRUE(expected == actual) << count << " vertices";
+  }
+
+  std::mt19937 m_rng;
+  std::vector<float> m_positions;
+};
+INSTANTIATE_TEST_SUITE_P(ThreadCounts, VertexLoaderParallelTest, ::testing::Values(1, 2, 3, 4));
+
+TEST_P(VertexLoaderParallelTest, SameAsSerial)
+{
+  CreateLoader();
+  ParallelVertexLoader parallel_loader(GetParam());
+  for (int count : {1, 3, 4, 5, 1000, 5001, 5002, 40000, 100000})
+    ExpectSameAsSerial(parallel_loader, MakeVertices(count));
+  EXPECT_TRUE(GetParam() == 1 || parallel_loader.ShouldSplit(m_loader.get(), 100000));
+}
+
+TEST_P(VertexLoaderParallelTest, SkippedVertices)
+{
+  CreateLoader();
+  ParallelVertexLoader parallel_loader(GetParam());
+  for (u32 skip_one_in : {2, 100, 10000, 100000})
+    ExpectSameAsSerial(parallel_loader, MakeVertices(100000, skip_one_in));
+}
+
+TEST_P(VertexLoaderParallelTest, Speed)
+{
+  constexpr int COUNT = 100000;
+  constexpr int RUNS = 200;
+
+  CreateLoader();
+  ParallelVertexLoader parallel_loader(GetParam());
+  const std::vector<u8> src = MakeVertices(COUNT);
+  std::vector<u8> dst(COUNT * m_loader->m_native_vtx_decl.stride + 4);
+  parallel_loader.RunVertices(m_loader.get(), src.data(), dst.data(), COUNT, nullptr);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < RUNS; ++i)
+    parallel_loader.RunVertices(m_loader.get(), src.data(), dst.data(), COUNT, nullptr);
+  const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+  fmt::print("threads: {}, {:.1f} million vertices per second\n", GetParam(),
+             COUNT * RUNS / time.count() / 1e6);
+}
+
 TEST_F(VertexLoaderTest, DirectAllComponents)
 {
   m_vtx_desc.low.PosMatIdx = 1;